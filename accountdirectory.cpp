@@ -0,0 +1,332 @@
+#include "accountdirectory.h"
+#include "schema.h"
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QReadLocker>
+#include <QWriteLocker>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+const int kBloomHashes = 7;           // 每个账户约 10 位，误判率约 1%
+const int kBloomBitsPerEntry = 10;
+const int kMaxDigits = 19;
+
+quint64 splitmix64(quint64 x)
+{
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+quint64 powerOfTen(int n)
+{
+    quint64 value = 1;
+    while (n-- > 0) value *= 10;
+    return value;
+}
+}
+
+AccountDirectory::AccountDirectory()
+    : bloomBits(0)
+{
+    resetBloom(0);
+}
+
+bool AccountDirectory::parseId(const QString& accountId, quint64& value)
+{
+    if (accountId.isEmpty() || accountId.size() > kMaxDigits || accountId.at(0) == QLatin1Char('0')) return false;
+    for (const QChar c : accountId) {
+        if (c < QLatin1Char('0') || c > QLatin1Char('9')) return false;
+    }
+    bool ok = false;
+    value = accountId.toULongLong(&ok);
+    return ok;
+}
+
+void AccountDirectory::bloomPositions(quint64 value, quint64 bits, quint64 positions[])
+{
+    // 双重散列：h1 + i * h2
+    const quint64 h1 = splitmix64(value);
+    const quint64 h2 = splitmix64(h1) | 1;
+    for (int i = 0; i < kBloomHashes; ++i) {
+        positions[i] = (h1 + quint64(i) * h2) % bits;
+    }
+}
+
+bool AccountDirectory::bloomContains(quint64 value) const
+{
+    quint64 positions[kBloomHashes];
+    bloomPositions(value, bloomBits, positions);
+    for (quint64 bit : positions) {
+        if (!(bloom[int(bit / 64)] & (quint64(1) << (bit % 64)))) return false;
+    }
+    return true;
+}
+
+void AccountDirectory::bloomAdd(quint64 value)
+{
+    quint64 positions[kBloomHashes];
+    bloomPositions(value, bloomBits, positions);
+    for (quint64 bit : positions) {
+        bloom[int(bit / 64)] |= quint64(1) << (bit % 64);
+    }
+}
+
+void AccountDirectory::resetBloom(int capacity)
+{
+    // 预留一倍余量给增量加入的账户，下次重建时按实际数量重新分配
+    const quint64 bits = qMax<quint64>(1024, quint64(capacity) * 2 * kBloomBitsPerEntry);
+    bloomBits = (bits + 63) / 64 * 64;
+    bloom.fill(0, int(bloomBits / 64));
+}
+
+quint32 AccountDirectory::internOwner(const QString& name)
+{
+    auto it = ownerIndex.constFind(name);
+    if (it != ownerIndex.constEnd()) return *it;
+
+    const quint32 index = quint32(ownerNames.size());
+    ownerNames.append(name);
+    ownerIndex.insert(name, index);
+    return index;
+}
+
+quint8 AccountDirectory::internStatus(const QString& status)
+{
+    int index = statusNames.indexOf(status);
+    if (index < 0) {
+        index = statusNames.size();
+        statusNames.append(status);
+    }
+    return quint8(index);
+}
+
+AccountDirectory::Entry AccountDirectory::entryAt(int index) const
+{
+    Entry entry;
+    entry.accountId = QString::number(ids.at(index));
+    entry.ownerName = ownerNames.at(int(owners.at(index)));
+    entry.status = statusNames.value(statuses.at(index));
+    return entry;
+}
+
+bool AccountDirectory::readRows(QSqlDatabase& db, const QDateTime& since, QList<Entry>& rows, QDateTime& serverNow)
+{
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+
+    // 先取数据库时间作为下次增量的起点，宁可重复读取也不漏掉
+    if (!query.exec("SELECT NOW()") || !query.next()) {
+        qDebug() << "读取数据库时间失败:" << query.lastError().text();
+        return false;
+    }
+    serverNow = query.value(0).toDateTime();
+
+    QString sql = "SELECT a.account_id, u.full_name, a.status FROM accounts a "
+                  "LEFT JOIN users u ON a.user_id = u.user_id";
+    if (since.isValid()) sql += " WHERE a.status_changed_at >= :since";
+    query.prepare(sql);
+    if (since.isValid()) query.bindValue(":since", since.addSecs(-1));   // 时间戳精度为秒
+
+    if (!query.exec()) {
+        qDebug() << "读取账户目录失败:" << query.lastError().text();
+        return false;
+    }
+
+    while (query.next()) {
+        Entry entry;
+        entry.accountId = query.value(0).toString();
+        entry.ownerName = query.value(1).toString();
+        entry.status = Schema::accountStatusName(query.value(2).toInt());
+        rows.append(entry);
+    }
+    return true;
+}
+
+bool AccountDirectory::rebuild(QSqlDatabase& db)
+{
+    QList<Entry> rows;
+    QDateTime serverNow;
+    if (!readRows(db, QDateTime(), rows, serverNow)) return false;
+
+    // 在锁外排序，锁内只做交换
+    QVector<QPair<quint64, int>> order;
+    order.reserve(rows.size());
+    QHash<QString, Entry> otherIds;
+    for (int i = 0; i < rows.size(); ++i) {
+        quint64 value = 0;
+        if (parseId(rows.at(i).accountId, value)) {
+            order.append(qMakePair(value, i));
+        } else {
+            otherIds.insert(rows.at(i).accountId, rows.at(i));
+        }
+    }
+    std::sort(order.begin(), order.end());
+
+    QWriteLocker locker(&lock);
+    ids.clear();
+    owners.clear();
+    statuses.clear();
+    ownerNames.clear();
+    ownerIndex.clear();
+    statusNames.clear();
+    ids.reserve(order.size());
+    owners.reserve(order.size());
+    statuses.reserve(order.size());
+    resetBloom(order.size());
+
+    for (const auto& item : order) {
+        const Entry& entry = rows.at(item.second);
+        ids.append(item.first);
+        owners.append(internOwner(entry.ownerName));
+        statuses.append(internStatus(entry.status));
+        bloomAdd(item.first);
+    }
+    irregular = otherIds;
+    syncedAt = serverNow;
+    sinceSync.start();
+
+    qDebug() << "账户目录已重建，账户数:" << ids.size() + irregular.size();
+    return true;
+}
+
+bool AccountDirectory::refresh(QSqlDatabase& db)
+{
+    QDateTime since;
+    {
+        QReadLocker locker(&lock);
+        since = syncedAt;
+    }
+    if (!since.isValid()) return rebuild(db);
+
+    QList<Entry> rows;
+    QDateTime serverNow;
+    if (!readRows(db, since, rows, serverNow)) return false;
+
+    QWriteLocker locker(&lock);
+    for (const Entry& entry : rows) upsertLocked(entry);
+    syncedAt = serverNow;
+    sinceSync.start();
+    return true;
+}
+
+AccountDirectory::Lookup AccountDirectory::lookup(const QString& accountId, Entry* entry) const
+{
+    quint64 value = 0;
+    QReadLocker locker(&lock);
+
+    if (!parseId(accountId, value)) {
+        auto it = irregular.constFind(accountId);
+        if (it == irregular.constEnd()) return Absent;
+        if (entry) *entry = *it;
+        return Present;
+    }
+
+    if (!bloomContains(value)) return Absent;
+
+    auto it = std::lower_bound(ids.constBegin(), ids.constEnd(), value);
+    if (it == ids.constEnd() || *it != value) return Absent;
+    if (entry) *entry = entryAt(int(it - ids.constBegin()));
+    return Present;
+}
+
+QList<AccountDirectory::Entry> AccountDirectory::search(const QString& prefix, int limit) const
+{
+    QList<Entry> results;
+    quint64 value = 0;
+    if (limit <= 0 || !parseId(prefix, value)) return results;
+
+    QReadLocker locker(&lock);
+
+    // 前缀 P 匹配的 n 位账户号是数值区间 [P·10^(n-L), (P+1)·10^(n-L))，逐个长度取出
+    const int length = prefix.size();
+    for (int digits = length; digits <= kMaxDigits; ++digits) {
+        const quint64 scale = powerOfTen(digits - length);
+        const quint64 low = value * scale;
+        const quint64 high = (value + 1) * scale;
+        auto it = std::lower_bound(ids.constBegin(), ids.constEnd(), low);
+        for (int taken = 0; it != ids.constEnd() && *it < high && taken < limit; ++it, ++taken) {
+            results.append(entryAt(int(it - ids.constBegin())));
+        }
+    }
+    for (const Entry& entry : irregular) {
+        if (entry.accountId.startsWith(prefix)) results.append(entry);
+    }
+
+    std::sort(results.begin(), results.end(), [](const Entry& a, const Entry& b) {
+        return a.accountId < b.accountId;
+    });
+    if (results.size() > limit) results.erase(results.begin() + limit, results.end());
+    return results;
+}
+
+void AccountDirectory::upsert(const Entry& entry)
+{
+    QWriteLocker locker(&lock);
+    upsertLocked(entry);
+}
+
+void AccountDirectory::upsertLocked(const Entry& entry)
+{
+    quint64 value = 0;
+    if (!parseId(entry.accountId, value)) {
+        Entry& existing = irregular[entry.accountId];
+        const QString owner = entry.ownerName.isEmpty() ? existing.ownerName : entry.ownerName;
+        existing = entry;
+        existing.ownerName = owner;
+        return;
+    }
+
+    auto it = std::lower_bound(ids.begin(), ids.end(), value);
+    const int index = int(it - ids.begin());
+    if (it != ids.end() && *it == value) {
+        // 本进程开户时还不知道户名，保留已有的
+        if (!entry.ownerName.isEmpty()) owners[index] = internOwner(entry.ownerName);
+        statuses[index] = internStatus(entry.status);
+        return;
+    }
+
+    ids.insert(index, value);
+    owners.insert(index, internOwner(entry.ownerName));
+    statuses.insert(index, internStatus(entry.status));
+    bloomAdd(value);
+}
+
+void AccountDirectory::remove(const QString& accountId)
+{
+    quint64 value = 0;
+    QWriteLocker locker(&lock);
+    if (!parseId(accountId, value)) {
+        irregular.remove(accountId);
+        return;
+    }
+
+    // 布隆过滤器不支持删除，该位置保留到下次重建，二分查找会判定为不存在
+    auto it = std::lower_bound(ids.begin(), ids.end(), value);
+    if (it == ids.end() || *it != value) return;
+    const int index = int(it - ids.begin());
+    ids.remove(index);
+    owners.remove(index);
+    statuses.remove(index);
+}
+
+bool AccountDirectory::isFresh(qint64 maxAgeMs) const
+{
+    QReadLocker locker(&lock);
+    return sinceSync.isValid() && sinceSync.elapsed() <= maxAgeMs;
+}
+
+bool AccountDirectory::isSynced() const
+{
+    QReadLocker locker(&lock);
+    return sinceSync.isValid();
+}
+
+int AccountDirectory::size() const
+{
+    QReadLocker locker(&lock);
+    return ids.size() + irregular.size();
+}
@@ -0,0 +1,83 @@
+#ifndef ACCOUNTDIRECTORY_H
+#define ACCOUNTDIRECTORY_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QList>
+#include <QHash>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QReadWriteLock>
+
+class QSqlDatabase;
+
+// 进程内账户目录：转账目标校验与账户号前缀查找
+// 账户号按数值存入有序数组（每个 8 字节），户名与状态以下标引用去重后的字符串表；
+// 前置一个布隆过滤器，不存在的账户号多数在此即被判定，无需二分查找，更无需访问数据库。
+// 连接时整体构建，之后按 accounts.status_changed_at 增量刷新；销户无法增量发现，由定期重建清除。
+// 可在多个线程中调用。
+class AccountDirectory
+{
+public:
+    struct Entry
+    {
+        QString accountId;
+        QString ownerName;
+        QString status;
+    };
+
+    enum Lookup { Absent, Present };
+
+    AccountDirectory();
+
+    // 整体重建（连接时与每小时）
+    bool rebuild(QSqlDatabase& db);
+    // 读取上次同步之后开立或状态变化的账户
+    bool refresh(QSqlDatabase& db);
+
+    Lookup lookup(const QString& accountId, Entry* entry = nullptr) const;
+    // 账户号前缀匹配，按账户号升序，最多 limit 条
+    QList<Entry> search(const QString& prefix, int limit) const;
+
+    // 本进程内的开户、冻结、销户立即反映到目录
+    void upsert(const Entry& entry);
+    void remove(const QString& accountId);
+
+    // 距上次成功同步不超过 maxAgeMs 时，目录中不存在的账户可直接判定为不存在
+    bool isFresh(qint64 maxAgeMs) const;
+    // 是否已成功同步过（整体重建完成）
+    bool isSynced() const;
+    int size() const;
+
+private:
+    // 账户号均为不含前导零的数字串（18/19 位），按数值排序；不符合的账户号单独存放
+    QVector<quint64> ids;
+    QVector<quint32> owners;
+    QVector<quint8> statuses;
+    QStringList ownerNames;
+    QHash<QString, quint32> ownerIndex;
+    QStringList statusNames;
+    QHash<QString, Entry> irregular;
+
+    QVector<quint64> bloom;
+    quint64 bloomBits;
+
+    QDateTime syncedAt;        // 数据库时间，下次增量从此开始
+    QElapsedTimer sinceSync;
+    mutable QReadWriteLock lock;
+
+    static bool parseId(const QString& accountId, quint64& value);
+    static void bloomPositions(quint64 value, quint64 bits, quint64 positions[]);
+    bool bloomContains(quint64 value) const;
+    void bloomAdd(quint64 value);
+    void resetBloom(int capacity);
+
+    quint32 internOwner(const QString& name);
+    quint8 internStatus(const QString& status);
+    Entry entryAt(int index) const;
+    void upsertLocked(const Entry& entry);
+    bool readRows(QSqlDatabase& db, const QDateTime& since, QList<Entry>& rows, QDateTime& serverNow);
+};
+
+#endif // ACCOUNTDIRECTORY_H
@@ -0,0 +1,265 @@
+#include "accountpurger.h"
+#include "journal.h"
+#include "schema.h"
+#include "dberror.h"
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QStringList>
+#include <QThread>
+#include <QTimer>
+#include <QDebug>
+
+namespace {
+const int kAccountsPerRun = 100;   // 每轮最多处理的已销户账户数
+}
+
+AccountPurger::AccountPurger(const QString& sourceConnectionName, QObject* parent)
+    : QObject(parent)
+    , sourceConnection(sourceConnectionName)
+    , workerConnection(sourceConnectionName + "_purger")
+    , timer(nullptr)
+    , batchSize(500)
+    , pauseMs(50)
+    , archivePostings(true)
+    , stopRequested(0)
+{
+}
+
+void AccountPurger::setBatchSize(int rows)
+{
+    batchSize = qBound(10, rows, 10000);
+}
+
+void AccountPurger::setPauseMs(int milliseconds)
+{
+    pauseMs = qBound(0, milliseconds, 10000);
+}
+
+void AccountPurger::setArchivePostings(bool archive)
+{
+    archivePostings = archive;
+}
+
+void AccountPurger::requestStop()
+{
+    stopRequested.storeRelaxed(1);
+}
+
+void AccountPurger::start(int intervalMs)
+{
+    stopRequested.storeRelaxed(0);
+    if (!timer) {
+        timer = new QTimer(this);
+        connect(timer, &QTimer::timeout, this, &AccountPurger::runPurge);
+    }
+    timer->start(intervalMs);
+
+    // 启动后立即继续上次未清理完的账户
+    runPurge();
+}
+
+void AccountPurger::stop()
+{
+    if (timer) {
+        timer->stop();
+    }
+
+    if (QSqlDatabase::contains(workerConnection)) {
+        {
+            QSqlDatabase db = QSqlDatabase::database(workerConnection, false);
+            db.close();
+        }
+        QSqlDatabase::removeDatabase(workerConnection);
+    }
+}
+
+bool AccountPurger::openWorkerConnection()
+{
+    if (!QSqlDatabase::contains(workerConnection)) {
+        if (!QSqlDatabase::contains(sourceConnection)) {
+            qDebug() << "销户清理线程：主连接不存在";
+            return false;
+        }
+        QSqlDatabase::cloneDatabase(sourceConnection, workerConnection);
+    }
+
+    QSqlDatabase db = QSqlDatabase::database(workerConnection, false);
+    if (!DbError::ensureOpen(db)) {
+        qDebug() << "销户清理线程连接失败:" << db.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+bool AccountPurger::runPurge()
+{
+    if (!openWorkerConnection()) return false;
+
+    QSqlDatabase db = QSqlDatabase::database(workerConnection, false);
+    QSqlQuery lockQuery(db);
+
+    // 多个客户端同时运行时只允许一个清理
+    if (!lockQuery.exec("SELECT GET_LOCK('banksystem_account_purge', 0)") || !lockQuery.next()
+        || lockQuery.value(0).toInt() != 1) {
+        return true;
+    }
+
+    QStringList accountIds;
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    query.prepare(QString("SELECT account_id FROM accounts WHERE status = %1 "
+                          "ORDER BY status_changed_at LIMIT %2").arg(Schema::Closed).arg(kAccountsPerRun));
+    bool success = query.exec();
+    if (!success) {
+        qDebug() << "读取已销户账户失败:" << query.lastError().text();
+    }
+    while (query.next()) accountIds << query.value(0).toString();
+
+    for (const QString& accountId : accountIds) {
+        if (!success || stopRequested.loadRelaxed()) break;
+        int postings = 0;
+        success = purgeAccount(db, accountId, postings);
+        if (success) {
+            qDebug() << "已销户账户清理完成:" << accountId << "交易记录:" << postings;
+            emit accountPurged(accountId, postings);
+        }
+    }
+
+    lockQuery.exec("SELECT RELEASE_LOCK('banksystem_account_purge')");
+    return success;
+}
+
+bool AccountPurger::purgeAccount(QSqlDatabase& db, const QString& accountId, int& postings)
+{
+    postings = 0;
+    // 先摘除转入的贷方分录（转出方的记录保留），再清理本账户自己的记录
+    for (const bool credits : { true, false }) {
+        for (;;) {
+            if (stopRequested.loadRelaxed()) return false;
+
+            const int rows = purgeBatch(db, accountId, credits);
+            if (rows < 0) return false;
+            if (rows == 0) break;
+            postings += rows;
+
+            // 批间暂停，避免持续占用 I/O 影响在线交易
+            if (pauseMs > 0) QThread::msleep(pauseMs);
+        }
+    }
+
+    // 交易记录清空后删除账户相关的其余数据与账户行
+    if (!db.transaction()) {
+        qDebug() << "开始事务失败:" << db.lastError().text();
+        return false;
+    }
+
+    QSqlQuery query(db);
+    const QStringList statements = {
+        "DELETE FROM balance_checkpoints WHERE account_id = :account_id",
+        "DELETE FROM archived_account_flows WHERE account_id = :account_id",
+        QString("DELETE FROM accounts WHERE account_id = :account_id AND status = %1").arg(Schema::Closed),
+    };
+    for (const QString& sql : statements) {
+        query.prepare(sql);
+        query.bindValue(":account_id", Schema::accountKey(accountId));
+        if (!query.exec()) {
+            qDebug() << "删除已销户账户失败:" << accountId << query.lastError().text();
+            db.rollback();
+            return false;
+        }
+    }
+
+    if (!db.commit()) {
+        qDebug() << "提交事务失败:" << db.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+int AccountPurger::purgeBatch(QSqlDatabase& db, const QString& accountId, bool credits)
+{
+    if (!db.transaction()) {
+        qDebug() << "开始事务失败:" << db.lastError().text();
+        return -1;
+    }
+
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+
+    // 按 idx_transactions_credit_time / idx_transactions_account_time 取最早的一批并加锁，每个事务只锁这一批行
+    const QString column = credits ? "credit_account" : "account_id";
+    query.prepare(QString("SELECT transaction_id FROM transactions WHERE %1 = :account_id "
+                          "ORDER BY transaction_time, transaction_id LIMIT %2 FOR UPDATE").arg(column).arg(batchSize));
+    query.bindValue(":account_id", Schema::accountKey(accountId));
+    if (!query.exec()) {
+        qDebug() << "读取待清理交易记录失败:" << query.lastError().text();
+        db.rollback();
+        return -1;
+    }
+
+    QStringList ids;
+    while (query.next()) ids << QString::number(query.value(0).toLongLong());
+    if (ids.isEmpty()) {
+        db.commit();
+        return 0;
+    }
+
+    // 交易号取自数据库且已转为整数，可直接拼入 IN 列表
+    const QString idList = ids.join(',');
+    auto run = [&](const QString& sql, const char* failure) {
+        query.prepare(sql);
+        query.bindValue(":account_id", Schema::accountKey(accountId));
+        if (query.exec()) return true;
+        qDebug() << failure << query.lastError().text();
+        db.rollback();
+        return false;
+    };
+
+    if (credits) {
+        // 本账户是转入方：副本按“收款”记录保存，转出方的记录只去掉贷方分录
+        if (archivePostings
+            && !run("INSERT INTO closed_account_transactions "
+                    "(transaction_id, account_id, transaction_type, amount, target_account, description, transaction_time) "
+                    "SELECT t.transaction_id, t.credit_account, " + QString::number(Schema::Credit) + ", t.amount, t.account_id, "
+                    + Journal::creditDescriptionSql("t") + ", t.transaction_time "
+                    "FROM transactions t WHERE t.credit_account = :account_id AND t.transaction_id IN (" + idList + ")",
+                    "迁移交易记录失败:")) {
+            return -1;
+        }
+        if (!run("UPDATE transactions SET credit_account = NULL "
+                 "WHERE credit_account = :account_id AND transaction_id IN (" + idList + ")",
+                 "摘除贷方分录失败:")) {
+            return -1;
+        }
+    } else {
+        // 本账户转出的转账：转入方的贷方分录改为独立的“收款”记录后再删除本行
+        if (!run("INSERT INTO transactions "
+                 "(account_id, transaction_type, amount, target_account, description, transaction_time) "
+                 "SELECT t.credit_account, " + QString::number(Schema::Credit) + ", t.amount, t.account_id, "
+                 + Journal::creditDescriptionSql("t") + ", t.transaction_time "
+                 "FROM transactions t WHERE t.account_id = :account_id AND t.credit_account IS NOT NULL "
+                 "AND t.transaction_id IN (" + idList + ")",
+                 "拆分转账记录失败:")) {
+            return -1;
+        }
+        if (archivePostings
+            && !run("INSERT INTO closed_account_transactions "
+                    "(transaction_id, account_id, transaction_type, amount, target_account, description, transaction_time) "
+                    "SELECT transaction_id, account_id, transaction_type, amount, target_account, description, transaction_time "
+                    "FROM transactions WHERE account_id = :account_id AND transaction_id IN (" + idList + ")",
+                    "迁移交易记录失败:")) {
+            return -1;
+        }
+        if (!run("DELETE FROM transactions WHERE account_id = :account_id AND transaction_id IN (" + idList + ")",
+                 "删除交易记录失败:")) {
+            return -1;
+        }
+    }
+
+    if (!db.commit()) {
+        qDebug() << "提交事务失败:" << db.lastError().text();
+        return -1;
+    }
+    return ids.size();
+}
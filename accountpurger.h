@@ -0,0 +1,56 @@
+#ifndef ACCOUNTPURGER_H
+#define ACCOUNTPURGER_H
+
+#include <QObject>
+#include <QString>
+#include <QAtomicInt>
+
+class QTimer;
+class QSqlDatabase;
+
+// 已销户账户的后台清理
+// 销户只把账户标记为“已销户”，之后不再接受任何交易；交易记录由本类按批迁移到
+// closed_account_transactions（或直接删除），每批一个短事务，批间暂停，不长时间持锁。
+// 转入的贷方分录只从转出方的记录上摘除；本账户转出的转账先为转入方补一条独立的“收款”记录再删除。
+// 交易记录清空后删除检查点、归档净额与账户行本身。中断后下次从剩余记录继续。
+class AccountPurger : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit AccountPurger(const QString& sourceConnectionName, QObject* parent = nullptr);
+
+    void setBatchSize(int rows);
+    void setPauseMs(int milliseconds);
+    // false 时交易记录直接删除，不保留副本
+    void setArchivePostings(bool archive);
+
+    // 可在任意线程调用：当前批次完成后停止清理
+    void requestStop();
+
+public slots:
+    // 以下槽函数在清理线程中执行
+    void start(int intervalMs);
+    void stop();
+    bool runPurge();
+
+signals:
+    void accountPurged(const QString& accountId, int postings);
+
+private:
+    QString sourceConnection;
+    QString workerConnection;
+    QTimer* timer;
+    int batchSize;
+    int pauseMs;
+    bool archivePostings;
+    QAtomicInt stopRequested;
+
+    bool openWorkerConnection();
+    bool purgeAccount(QSqlDatabase& db, const QString& accountId, int& postings);
+    // 迁移/删除一批交易记录，返回本批行数，失败返回 -1；
+    // credits 为 true 时处理本账户作为转入方的贷方分录
+    int purgeBatch(QSqlDatabase& db, const QString& accountId, bool credits);
+};
+
+#endif // ACCOUNTPURGER_H
@@ -0,0 +1,249 @@
+#include "authservice.h"
+#include "databasemanager.h"
+#include "passwordhasher.h"
+#include <QMessageAuthenticationCode>
+#include <QCryptographicHash>
+#include <QRandomGenerator>
+#include <QReadLocker>
+#include <QWriteLocker>
+#include <QStringList>
+#include <QThread>
+#include <QDebug>
+
+namespace {
+const int kDefaultSessionSeconds = 8 * 3600;  // 一个班次
+const int kDefaultMaxPendingLogins = 1024;
+
+// 用户不存在时也做一次同等代价的校验，避免通过响应时间枚举用户名
+const char* kDummyHash = "$scrypt$ln=14,r=8,p=1$pjUzkxf23HQtdvY8bcSJCQ$smwYyTAohQmzaUT2kr2Mq2nFUYMedCNqIF9eY1SPP6w";
+
+QByteArray base64Url(const QByteArray& data)
+{
+    return data.toBase64(QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals);
+}
+}
+
+AuthService& AuthService::instance()
+{
+    static AuthService instance;
+    return instance;
+}
+
+AuthService::AuthService(QObject* parent)
+    : QObject(parent)
+    , maxPending(kDefaultMaxPendingLogins)
+    , sessionSeconds(kDefaultSessionSeconds)
+    , pending(0)
+{
+    hashPool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() / 2));
+
+    // 多进程共享会话时可通过环境变量指定签名密钥，否则每次启动随机生成
+    signingKey = qgetenv("BANKSYSTEM_SESSION_KEY");
+    if (signingKey.isEmpty()) {
+        signingKey.resize(32);
+        QRandomGenerator::system()->fillRange(reinterpret_cast<quint32*>(signingKey.data()),
+                                              signingKey.size() / int(sizeof(quint32)));
+    }
+}
+
+void AuthService::setMaxConcurrentHashes(int count)
+{
+    hashPool.setMaxThreadCount(qMax(1, count));
+}
+
+int AuthService::maxConcurrentHashes() const
+{
+    return hashPool.maxThreadCount();
+}
+
+void AuthService::setMaxPendingLogins(int count)
+{
+    maxPending = qMax(1, count);
+}
+
+void AuthService::setSessionLifetime(int seconds)
+{
+    sessionSeconds = qMax(60, seconds);
+}
+
+int AuthService::pendingLogins() const
+{
+    return pending.loadRelaxed();
+}
+
+void AuthService::authenticate(const QString& username, const QString& password)
+{
+    // 排队过长时立即拒绝，避免登录高峰堆积内存
+    if (pending.loadRelaxed() >= maxPending) {
+        qDebug() << "登录请求排队过多，拒绝:" << username;
+        QMetaObject::invokeMethod(this, [this, username]() {
+            emit authenticationFailed(username, "登录请求过多，请稍后重试");
+        }, Qt::QueuedConnection);
+        return;
+    }
+
+    int userId = -1;
+    QString storedHash;
+    QString role;
+    const bool found = DatabaseManager::instance().getUserCredentials(username, userId, storedHash, role);
+
+    pending.ref();
+    hashPool.start([this, username, password, userId, role, storedHash, found]() {
+        const bool verified = PasswordHasher::verify(password, found ? storedHash : QString(kDummyHash))
+                              && found;
+        // 旧明文密码或参数过时：顺便重新散列，回到调用线程后写库
+        const QString upgradedHash = verified && PasswordHasher::needsRehash(storedHash)
+                                         ? PasswordHasher::hash(password)
+                                         : QString();
+
+        QMetaObject::invokeMethod(this, [=]() {
+            finishLogin(username, userId, role, storedHash, verified, upgradedHash);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void AuthService::finishLogin(const QString& username, int userId, const QString& role,
+                              const QString& storedHash, bool verified, const QString& upgradedHash)
+{
+    pending.deref();
+
+    if (!verified) {
+        qDebug() << "用户认证失败:" << username;
+        emit authenticationFailed(username, "用户名或密码错误！");
+        return;
+    }
+
+    if (!upgradedHash.isEmpty()) {
+        DatabaseManager::instance().upgradePasswordHash(userId, storedHash, upgradedHash);
+    }
+
+    UserSession session;
+    session.userId = userId;
+    session.username = username;
+    session.role = role;
+    session.expiresAt = QDateTime::currentDateTimeUtc().addSecs(sessionSeconds);
+
+    const QString token = issueToken(session);
+    qDebug() << "用户认证成功:" << username << "角色:" << role;
+    emit authenticated(username, token);
+}
+
+QString AuthService::issueToken(const UserSession& session)
+{
+    QByteArray nonce(16, Qt::Uninitialized);
+    QRandomGenerator::system()->fillRange(reinterpret_cast<quint32*>(nonce.data()),
+                                          nonce.size() / int(sizeof(quint32)));
+
+    const QStringList fields = {
+        QString::number(session.userId),
+        session.username,
+        session.role,
+        QString::number(session.expiresAt.toMSecsSinceEpoch()),
+        QString::fromLatin1(base64Url(nonce)),
+    };
+    const QByteArray payload = base64Url(fields.join('\n').toUtf8());
+    const QByteArray signature = base64Url(
+        QMessageAuthenticationCode::hash(payload, signingKey, QCryptographicHash::Sha256));
+    const QString token = QString::fromLatin1(payload + '.' + signature);
+
+    QWriteLocker locker(&sessionLock);
+    pruneExpired();
+    sessions.insert(token, session);
+    return token;
+}
+
+bool AuthService::decodeToken(const QString& token, UserSession& session) const
+{
+    const int dot = token.indexOf('.');
+    if (dot <= 0) {
+        return false;
+    }
+
+    const QByteArray payload = token.left(dot).toLatin1();
+    const QByteArray expected = base64Url(
+        QMessageAuthenticationCode::hash(payload, signingKey, QCryptographicHash::Sha256));
+    const QByteArray actual = token.mid(dot + 1).toLatin1();
+
+    // 常量时间比较签名
+    quint8 diff = quint8(expected.size() != actual.size());
+    for (int i = 0; i < expected.size() && i < actual.size(); ++i) {
+        diff |= quint8(expected[i]) ^ quint8(actual[i]);
+    }
+    if (diff != 0) {
+        return false;
+    }
+
+    const QStringList fields = QString::fromUtf8(
+        QByteArray::fromBase64(payload, QByteArray::Base64UrlEncoding)).split('\n');
+    if (fields.size() != 5) {
+        return false;
+    }
+
+    session.userId = fields[0].toInt();
+    session.username = fields[1];
+    session.role = fields[2];
+    session.expiresAt = QDateTime::fromMSecsSinceEpoch(fields[3].toLongLong(), Qt::UTC);
+    return session.isValid();
+}
+
+UserSession AuthService::validate(const QString& token)
+{
+    {
+        QReadLocker locker(&sessionLock);
+        auto it = sessions.constFind(token);
+        if (it != sessions.constEnd()) {
+            return it->isValid() ? *it : UserSession();
+        }
+        if (revoked.contains(token)) {
+            return UserSession();
+        }
+    }
+
+    // 缓存未命中（如其他进程签发的令牌）：校验签名后加入缓存
+    UserSession session;
+    if (!decodeToken(token, session)) {
+        return UserSession();
+    }
+
+    QWriteLocker locker(&sessionLock);
+    sessions.insert(token, session);
+    return session;
+}
+
+bool AuthService::hasRole(const QString& token, const QString& role)
+{
+    const UserSession session = validate(token);
+    return session.isValid() && session.role == role;
+}
+
+void AuthService::revoke(const QString& token)
+{
+    UserSession session;
+    const bool signedByUs = decodeToken(token, session);
+
+    QWriteLocker locker(&sessionLock);
+    sessions.remove(token);
+    if (signedByUs) {
+        revoked.insert(token, session.expiresAt);
+    }
+}
+
+void AuthService::pruneExpired()
+{
+    // 调用方已持有写锁
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+    for (auto it = sessions.begin(); it != sessions.end();) {
+        if (it->expiresAt <= now) {
+            it = sessions.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    for (auto it = revoked.begin(); it != revoked.end();) {
+        if (it.value() <= now) {
+            it = revoked.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef AUTHSERVICE_H
+#define AUTHSERVICE_H
+
+#include <QObject>
+#include <QString>
+#include <QHash>
+#include <QByteArray>
+#include <QDateTime>
+#include <QReadWriteLock>
+#include <QThreadPool>
+#include <QAtomicInt>
+
+// 已登录会话：角色随令牌签发，会话期间的权限判断不再访问数据库
+struct UserSession
+{
+    int userId = -1;
+    QString username;
+    QString role;
+    QDateTime expiresAt;
+
+    bool isValid() const { return userId > 0 && QDateTime::currentDateTimeUtc() < expiresAt; }
+    bool isAdmin() const { return role == QLatin1String("admin"); }
+};
+
+// 认证服务
+// 凭据查询在调用线程完成，scrypt 校验放到有界线程池执行，界面线程不被阻塞；
+// 登录成功后签发 HMAC-SHA256 签名的会话令牌并缓存。
+class AuthService : public QObject
+{
+    Q_OBJECT
+
+public:
+    static AuthService& instance();
+
+    // 同时进行的散列计算数（每个约占 16 MiB 内存），默认为 CPU 核数的一半
+    void setMaxConcurrentHashes(int count);
+    int maxConcurrentHashes() const;
+    // 排队中的登录请求超过该值时直接拒绝
+    void setMaxPendingLogins(int count);
+    void setSessionLifetime(int seconds);
+    int pendingLogins() const;
+
+    // 异步登录，结果通过 authenticated / authenticationFailed 返回
+    void authenticate(const QString& username, const QString& password);
+
+    // 以下函数只读会话缓存，可在任意线程调用
+    UserSession validate(const QString& token);
+    bool hasRole(const QString& token, const QString& role);
+    void revoke(const QString& token);
+
+signals:
+    void authenticated(const QString& username, const QString& token);
+    void authenticationFailed(const QString& username, const QString& reason);
+
+private:
+    AuthService(QObject* parent = nullptr);
+
+    AuthService(const AuthService&) = delete;
+    AuthService& operator=(const AuthService&) = delete;
+
+    QThreadPool hashPool;
+    QByteArray signingKey;
+    int maxPending;
+    int sessionSeconds;
+    QAtomicInt pending;
+
+    mutable QReadWriteLock sessionLock;
+    QHash<QString, UserSession> sessions;
+    QHash<QString, QDateTime> revoked;   // 令牌 -> 原过期时间，过期后清理
+
+    void finishLogin(const QString& username, int userId, const QString& role,
+                     const QString& storedHash, bool verified, const QString& upgradedHash);
+    QString issueToken(const UserSession& session);
+    bool decodeToken(const QString& token, UserSession& session) const;
+    void pruneExpired();
+};
+
+#endif // AUTHSERVICE_H
@@ -0,0 +1,341 @@
+#include "balancecheckpointer.h"
+#include "money.h"
+#include "journal.h"
+#include "schema.h"
+#include "dberror.h"
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QTimer>
+#include <QHash>
+#include <QVector>
+#include <QStringList>
+#include <QDebug>
+
+BalanceCheckpointer::BalanceCheckpointer(const QString& sourceConnectionName, QObject* parent)
+    : QObject(parent)
+    , sourceConnection(sourceConnectionName)
+    , workerConnection(sourceConnectionName + "_checkpoints")
+    , timer(nullptr)
+    , chunkSize(5000)
+    , maxCatchUpDays(31)
+    , maxBackfillDays(31)
+{
+}
+
+void BalanceCheckpointer::setChunkSize(int accounts)
+{
+    chunkSize = qBound(100, accounts, 50000);
+}
+
+void BalanceCheckpointer::setMaxCatchUpDays(int days)
+{
+    maxCatchUpDays = qMax(1, days);
+}
+
+void BalanceCheckpointer::setMaxBackfillDays(int days)
+{
+    maxBackfillDays = qMax(0, days);
+}
+
+void BalanceCheckpointer::start(int intervalMs)
+{
+    if (!timer) {
+        timer = new QTimer(this);
+        connect(timer, &QTimer::timeout, this, &BalanceCheckpointer::runCheckpoints);
+    }
+    timer->start(intervalMs);
+
+    // 启动后立即补写停机期间缺少的日期
+    runCheckpoints();
+}
+
+void BalanceCheckpointer::stop()
+{
+    if (timer) {
+        timer->stop();
+    }
+
+    if (QSqlDatabase::contains(workerConnection)) {
+        {
+            QSqlDatabase db = QSqlDatabase::database(workerConnection, false);
+            db.close();
+        }
+        QSqlDatabase::removeDatabase(workerConnection);
+    }
+}
+
+bool BalanceCheckpointer::openWorkerConnection()
+{
+    if (!QSqlDatabase::contains(workerConnection)) {
+        if (!QSqlDatabase::contains(sourceConnection)) {
+            qDebug() << "检查点线程：主连接不存在";
+            return false;
+        }
+        QSqlDatabase::cloneDatabase(sourceConnection, workerConnection);
+    }
+
+    QSqlDatabase db = QSqlDatabase::database(workerConnection, false);
+    if (!DbError::ensureOpen(db)) {
+        qDebug() << "检查点线程连接失败:" << db.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+bool BalanceCheckpointer::runCheckpoints()
+{
+    if (!openWorkerConnection()) {
+        emit finished(false);
+        return false;
+    }
+
+    QSqlDatabase db = QSqlDatabase::database(workerConnection, false);
+    QSqlQuery lockQuery(db);
+
+    // 多个客户端同时运行时只允许一个写检查点
+    if (!lockQuery.exec("SELECT GET_LOCK('banksystem_checkpoints', 0)") || !lockQuery.next()
+        || lockQuery.value(0).toInt() != 1) {
+        emit finished(true);
+        return true;
+    }
+
+    const QDate yesterday = QDate::currentDate().addDays(-1);
+    QDate first = yesterday;
+
+    QSqlQuery query(db);
+    bool success = query.exec("SELECT MAX(checkpoint_date) FROM balance_checkpoint_runs") && query.next();
+    if (!success) {
+        qDebug() << "读取检查点进度失败:" << query.lastError().text();
+    } else if (!query.isNull(0)) {
+        // 首次运行只写昨天；之后补写上次完成之后的日期
+        first = qMax(query.value(0).toDate().addDays(1), yesterday.addDays(1 - maxCatchUpDays));
+    }
+
+    for (QDate date = first; success && date <= yesterday; date = date.addDays(1)) {
+        int accounts = 0;
+        success = writeCheckpoint(db, date, accounts);
+        if (success) {
+            qDebug() << "余额检查点已写入:" << date.toString("yyyy-MM-dd") << "账户数:" << accounts;
+            emit checkpointWritten(date, accounts);
+        }
+    }
+    if (success) success = backfillCheckpoints(db);
+
+    lockQuery.exec("SELECT RELEASE_LOCK('banksystem_checkpoints')");
+    emit finished(success);
+    return success;
+}
+
+// 写入 date 的日终余额；每段账户的余额与其后流水在同一快照内读取，写入在快照之外进行，不锁账户行
+bool BalanceCheckpointer::writeCheckpoint(QSqlDatabase& db, const QDate& date, int& accounts)
+{
+    const QDateTime dayEnd(date.addDays(1), QTime(0, 0));
+    const QString dateText = date.toString("yyyy-MM-dd");
+
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    query.setNumericalPrecisionPolicy(QSql::HighPrecision);
+    if (!query.exec("SET SESSION TRANSACTION ISOLATION LEVEL REPEATABLE READ")) {
+        qDebug() << "设置隔离级别失败:" << query.lastError().text();
+        return false;
+    }
+
+    QString lastAccountId = "0";   // 账户号均大于 0
+    accounts = 0;
+    for (;;) {
+        if (!query.exec("START TRANSACTION WITH CONSISTENT SNAPSHOT")) {
+            qDebug() << "开启一致性快照失败:" << query.lastError().text();
+            return false;
+        }
+
+        // 日终之后开立的账户没有当天的检查点
+        query.prepare(QString("SELECT account_id, balance FROM accounts "
+                              "WHERE account_id > :after AND created_at < :day_end AND status <> %1 "
+                              "ORDER BY account_id LIMIT %2").arg(Schema::Closed).arg(chunkSize));
+        query.bindValue(":after", Schema::accountKey(lastAccountId));
+        query.bindValue(":day_end", dayEnd);
+        if (!query.exec()) {
+            qDebug() << "读取账户余额失败:" << query.lastError().text();
+            query.exec("ROLLBACK");
+            return false;
+        }
+
+        QVector<QString> ids;
+        QHash<QString, qint64> closing;
+        while (query.next()) {
+            const QString accountId = query.value(0).toString();
+            ids.append(accountId);
+            closing.insert(accountId, Money::toCents(query.value(1)));
+        }
+        if (ids.isEmpty()) {
+            query.exec("COMMIT");
+            break;
+        }
+        lastAccountId = ids.last();
+
+        // 当前余额减去日终之后的流水净额
+        query.prepare(Journal::postingTotalsSql(
+            "%1 BETWEEN :low%2 AND :high%2 AND transaction_time >= :day_end%2"));
+        Journal::bindLegs(query, ":low", Schema::accountKey(ids.first()));
+        Journal::bindLegs(query, ":high", Schema::accountKey(ids.last()));
+        Journal::bindLegs(query, ":day_end", dayEnd);
+        if (!query.exec()) {
+            qDebug() << "汇总日终后流水失败:" << query.lastError().text();
+            query.exec("ROLLBACK");
+            return false;
+        }
+        while (query.next()) {
+            auto it = closing.find(query.value(0).toString());
+            if (it == closing.end()) continue;
+            *it -= Money::postingSign(query.value(1).toString()) * Money::toCents(query.value(2));
+        }
+        query.exec("COMMIT");
+
+        // 重跑时已写入的行保持不变
+        QStringList rows;
+        rows.reserve(ids.size());
+        for (const QString& accountId : ids) {
+            rows << QString("(?, '%1', %2)").arg(dateText, Money::toDecimalString(closing.value(accountId)));
+        }
+        query.prepare("INSERT IGNORE INTO balance_checkpoints (account_id, checkpoint_date, balance) VALUES "
+                      + rows.join(", "));
+        for (int i = 0; i < ids.size(); ++i) query.bindValue(i, Schema::accountKey(ids.at(i)));
+        if (!query.exec()) {
+            qDebug() << "写入余额检查点失败:" << query.lastError().text();
+            return false;
+        }
+
+        accounts += ids.size();
+        if (ids.size() < chunkSize) break;
+    }
+
+    return recordRun(db, date, accounts);
+}
+
+bool BalanceCheckpointer::recordRun(QSqlDatabase& db, const QDate& date, int accounts)
+{
+    QSqlQuery query(db);
+    query.prepare("INSERT INTO balance_checkpoint_runs (checkpoint_date, accounts) VALUES (:date, :accounts) "
+                  "ON DUPLICATE KEY UPDATE accounts = :accounts2, completed_at = CURRENT_TIMESTAMP");
+    query.bindValue(":date", date);
+    query.bindValue(":accounts", accounts);
+    query.bindValue(":accounts2", accounts);
+    if (!query.exec()) {
+        qDebug() << "记录检查点进度失败:" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+// 向过去回填：每次取“后一天已完成、当天未完成”的最晚日期，既补停机缺口也向部署之前延伸
+bool BalanceCheckpointer::backfillCheckpoints(QSqlDatabase& db)
+{
+    if (maxBackfillDays == 0) return true;
+
+    // 回填下限：最早开户的那天；交易表中最早流水的前一天（更早的月份已归档，交易表里没有流水）
+    QSqlQuery query(db);
+    if (!query.exec("SELECT (SELECT MIN(created_at) FROM accounts), (SELECT MIN(transaction_time) FROM transactions)")
+        || !query.next()) {
+        qDebug() << "读取回填下限失败:" << query.lastError().text();
+        return false;
+    }
+    if (query.isNull(0)) return true;
+    QDate floor = query.value(0).toDate();
+    if (!query.isNull(1)) floor = qMax(floor, query.value(1).toDate().addDays(-1));
+
+    for (int day = 0; day < maxBackfillDays; ++day) {
+        if (!query.exec("SELECT MAX(r.checkpoint_date) FROM balance_checkpoint_runs r "
+                        "LEFT JOIN balance_checkpoint_runs p ON p.checkpoint_date = r.checkpoint_date - INTERVAL 1 DAY "
+                        "WHERE p.checkpoint_date IS NULL")
+            || !query.next()) {
+            qDebug() << "读取回填进度失败:" << query.lastError().text();
+            return false;
+        }
+        if (query.isNull(0)) return true;
+
+        const QDate date = query.value(0).toDate().addDays(-1);
+        if (date < floor) return true;
+
+        int accounts = 0;
+        if (!writeBackfillCheckpoint(db, date, accounts)) return false;
+        qDebug() << "余额检查点已回填:" << date.toString("yyyy-MM-dd") << "账户数:" << accounts;
+        emit checkpointWritten(date, accounts);
+    }
+    return true;
+}
+
+// 由 date+1 的检查点减去 date+1 当天的流水得到 date 的日终余额；只涉及已完成的日期，不需要快照
+bool BalanceCheckpointer::writeBackfillCheckpoint(QSqlDatabase& db, const QDate& date, int& accounts)
+{
+    const QDate next = date.addDays(1);
+    const QDateTime dayEnd(next, QTime(0, 0));
+    const QDateTime nextEnd(next.addDays(1), QTime(0, 0));
+    const QString dateText = date.toString("yyyy-MM-dd");
+
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    query.setNumericalPrecisionPolicy(QSql::HighPrecision);
+
+    QString lastAccountId = "0";   // 账户号均大于 0
+    accounts = 0;
+    for (;;) {
+        // date 日终之后开立的账户没有当天的检查点
+        query.prepare(QString("SELECT c.account_id, c.balance FROM balance_checkpoints c "
+                              "JOIN accounts a ON a.account_id = c.account_id "
+                              "WHERE c.checkpoint_date = :next AND c.account_id > :after AND a.created_at < :day_end "
+                              "ORDER BY c.account_id LIMIT %1").arg(chunkSize));
+        query.bindValue(":next", next);
+        query.bindValue(":after", Schema::accountKey(lastAccountId));
+        query.bindValue(":day_end", dayEnd);
+        if (!query.exec()) {
+            qDebug() << "读取后一天检查点失败:" << query.lastError().text();
+            return false;
+        }
+
+        QVector<QString> ids;
+        QHash<QString, qint64> closing;
+        while (query.next()) {
+            const QString accountId = query.value(0).toString();
+            ids.append(accountId);
+            closing.insert(accountId, Money::toCents(query.value(1)));
+        }
+        if (ids.isEmpty()) break;
+        lastAccountId = ids.last();
+
+        // 减去后一天的流水净额
+        query.prepare(Journal::postingTotalsSql(
+            "%1 BETWEEN :low%2 AND :high%2 AND transaction_time >= :day_end%2 AND transaction_time < :next_end%2"));
+        Journal::bindLegs(query, ":low", Schema::accountKey(ids.first()));
+        Journal::bindLegs(query, ":high", Schema::accountKey(ids.last()));
+        Journal::bindLegs(query, ":day_end", dayEnd);
+        Journal::bindLegs(query, ":next_end", nextEnd);
+        if (!query.exec()) {
+            qDebug() << "汇总后一天流水失败:" << query.lastError().text();
+            return false;
+        }
+        while (query.next()) {
+            auto it = closing.find(query.value(0).toString());
+            if (it == closing.end()) continue;
+            *it -= Money::postingSign(query.value(1).toString()) * Money::toCents(query.value(2));
+        }
+
+        QStringList rows;
+        rows.reserve(ids.size());
+        for (const QString& accountId : ids) {
+            rows << QString("(?, '%1', %2)").arg(dateText, Money::toDecimalString(closing.value(accountId)));
+        }
+        query.prepare("INSERT IGNORE INTO balance_checkpoints (account_id, checkpoint_date, balance) VALUES "
+                      + rows.join(", "));
+        for (int i = 0; i < ids.size(); ++i) query.bindValue(i, Schema::accountKey(ids.at(i)));
+        if (!query.exec()) {
+            qDebug() << "写入回填检查点失败:" << query.lastError().text();
+            return false;
+        }
+
+        accounts += ids.size();
+        if (ids.size() < chunkSize) break;
+    }
+
+    return recordRun(db, date, accounts);
+}
@@ -0,0 +1,56 @@
+#ifndef BALANCECHECKPOINTER_H
+#define BALANCECHECKPOINTER_H
+
+#include <QObject>
+#include <QString>
+#include <QDate>
+
+class QTimer;
+class QSqlDatabase;
+
+// 每日余额检查点
+// balance_checkpoints 保存每个账户每天的日终余额（checkpoint_date 当天 24:00 的余额），
+// 任意时点的余额 = 之前最近的检查点 + 其后的流水净额，查询代价与一天的流水量相当。
+// 日终余额由当前余额倒推：当前余额减去次日零点之后的流水净额，与流水在同一快照内读取；
+// 按账户号分段写入，已完成的日期记录在 balance_checkpoint_runs，中断后从未完成的日期继续。
+// 此外向过去回填：D 的日终余额 = D+1 的检查点减去 D+1 当天的流水，每天的代价也只与一天的流水量相当；
+// 每轮最多回填若干天，逐轮补齐部署之前的历史与停机造成的缺口，直到最早的开户日或仍在交易表中的最早流水。
+class BalanceCheckpointer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit BalanceCheckpointer(const QString& sourceConnectionName, QObject* parent = nullptr);
+
+    void setChunkSize(int accounts);
+    // 停机较久后最多补写的天数
+    void setMaxCatchUpDays(int days);
+    // 每轮最多向过去回填的天数
+    void setMaxBackfillDays(int days);
+
+public slots:
+    // 以下槽函数在检查点线程中执行
+    void start(int intervalMs);
+    void stop();
+    bool runCheckpoints();
+
+signals:
+    void checkpointWritten(const QDate& date, int accounts);
+    void finished(bool success);
+
+private:
+    QString sourceConnection;
+    QString workerConnection;
+    QTimer* timer;
+    int chunkSize;
+    int maxCatchUpDays;
+    int maxBackfillDays;
+
+    bool openWorkerConnection();
+    bool writeCheckpoint(QSqlDatabase& db, const QDate& date, int& accounts);
+    bool backfillCheckpoints(QSqlDatabase& db);
+    bool writeBackfillCheckpoint(QSqlDatabase& db, const QDate& date, int& accounts);
+    bool recordRun(QSqlDatabase& db, const QDate& date, int accounts);
+};
+
+#endif // BALANCECHECKPOINTER_H
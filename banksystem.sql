@@ -1,113 +1,401 @@
-/*
- Navicat MySQL Dump SQL
-
- Source Server         : mine
- Source Server Type    : MySQL
- Source Server Version : 80044 (8.0.44)
- Source Host           : localhost:3306
- Source Schema         : banksystem
-
- Target Server Type    : MySQL
- Target Server Version : 80044 (8.0.44)
- File Encoding         : 65001
-
- Date: 08/12/2025 20:28:27
-*/
-
-SET NAMES utf8mb4;
-SET FOREIGN_KEY_CHECKS = 0;
-
--- ----------------------------
--- Table structure for accounts
--- ----------------------------
-DROP TABLE IF EXISTS `accounts`;
-CREATE TABLE `accounts`  (
-  `account_id` varchar(20) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL,
-  `user_id` int NOT NULL,
-  `account_type` varchar(20) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NULL DEFAULT '储蓄账户',
-  `balance` decimal(15, 2) NULL DEFAULT 0.00,
-  `status` varchar(20) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NULL DEFAULT '正常',
-  `created_at` timestamp NULL DEFAULT CURRENT_TIMESTAMP,
-  PRIMARY KEY (`account_id`) USING BTREE,
-  INDEX `idx_accounts_user_id`(`user_id` ASC) USING BTREE,
-  CONSTRAINT `accounts_ibfk_1` FOREIGN KEY (`user_id`) REFERENCES `users` (`user_id`) ON DELETE CASCADE ON UPDATE RESTRICT
-) ENGINE = InnoDB CHARACTER SET = utf8mb4 COLLATE = utf8mb4_unicode_ci ROW_FORMAT = Dynamic;
-
--- ----------------------------
--- Records of accounts
--- ----------------------------
-INSERT INTO `accounts` VALUES ('621420230101000001', 1, '储蓄账户', 9769809.00, '正常', '2025-12-06 17:52:09');
-INSERT INTO `accounts` VALUES ('621420230101000002', 2, '储蓄账户', 244191.00, '冻结', '2025-12-06 17:52:09');
-INSERT INTO `accounts` VALUES ('621420230101000003', 3, '储蓄账户', 3000.00, '正常', '2025-12-06 17:52:09');
-INSERT INTO `accounts` VALUES ('6214202512071526506', 1, '活期账户', 1000.00, '正常', '2025-12-07 15:26:26');
-INSERT INTO `accounts` VALUES ('6214202512071526691', 1, '定期账户', 0.00, '正常', '2025-12-07 15:26:34');
-INSERT INTO `accounts` VALUES ('6214202512071606905', 6, '储蓄账户', 100000.00, '正常', '2025-12-07 16:06:43');
-INSERT INTO `accounts` VALUES ('6214202512071642726', 7, '储蓄账户', 0.00, '正常', '2025-12-07 16:42:34');
-
--- ----------------------------
--- Table structure for transactions
--- ----------------------------
-DROP TABLE IF EXISTS `transactions`;
-CREATE TABLE `transactions`  (
-  `transaction_id` int NOT NULL AUTO_INCREMENT,
-  `account_id` varchar(20) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL,
-  `transaction_type` varchar(20) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL,
-  `amount` decimal(15, 2) NOT NULL,
-  `target_account` varchar(20) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NULL DEFAULT NULL,
-  `description` varchar(200) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NULL DEFAULT NULL,
-  `transaction_time` timestamp NULL DEFAULT CURRENT_TIMESTAMP,
-  PRIMARY KEY (`transaction_id`) USING BTREE,
-  INDEX `idx_transactions_account_id`(`account_id` ASC) USING BTREE,
-  INDEX `idx_transactions_time`(`transaction_time` DESC) USING BTREE,
-  CONSTRAINT `transactions_ibfk_1` FOREIGN KEY (`account_id`) REFERENCES `accounts` (`account_id`) ON DELETE CASCADE ON UPDATE RESTRICT
-) ENGINE = InnoDB AUTO_INCREMENT = 15 CHARACTER SET = utf8mb4 COLLATE = utf8mb4_unicode_ci ROW_FORMAT = Dynamic;
-
--- ----------------------------
--- Records of transactions
--- ----------------------------
-INSERT INTO `transactions` VALUES (1, '621420230101000001', '存款', 100000.00, NULL, '存款操作', '2025-12-06 20:15:17');
-INSERT INTO `transactions` VALUES (2, '621420230101000001', '转账', 100000.00, '621420230101000002', '转账支出', '2025-12-07 00:45:18');
-INSERT INTO `transactions` VALUES (3, '621420230101000002', '收款', 100000.00, '621420230101000001', '转账收入', '2025-12-07 00:45:18');
-INSERT INTO `transactions` VALUES (4, '621420230101000001', '存款', 10000000.00, NULL, '存款操作', '2025-12-07 13:14:09');
-INSERT INTO `transactions` VALUES (5, '621420230101000001', '转账', 114514.00, '621420230101000002', '转账支出', '2025-12-07 13:15:15');
-INSERT INTO `transactions` VALUES (6, '621420230101000002', '收款', 114514.00, '621420230101000001', '转账收入', '2025-12-07 13:15:15');
-INSERT INTO `transactions` VALUES (7, '621420230101000001', '转账', 12332.00, '621420230101000002', '转账支出', '2025-12-07 15:27:45');
-INSERT INTO `transactions` VALUES (8, '621420230101000002', '收款', 12332.00, '621420230101000001', '转账收入', '2025-12-07 15:27:45');
-INSERT INTO `transactions` VALUES (9, '621420230101000001', '转账', 12345.00, '621420230101000002', '转账支出', '2025-12-07 15:27:56');
-INSERT INTO `transactions` VALUES (10, '621420230101000002', '收款', 12345.00, '621420230101000001', '转账收入', '2025-12-07 15:27:56');
-INSERT INTO `transactions` VALUES (11, '621420230101000001', '转账', 1000.00, '6214202512071526506', '转账支出', '2025-12-07 15:29:09');
-INSERT INTO `transactions` VALUES (12, '6214202512071526506', '收款', 1000.00, '621420230101000001', '转账收入', '2025-12-07 15:29:09');
-INSERT INTO `transactions` VALUES (13, '621420230101000001', '转账', 100000.00, '6214202512071606905', '转账支出', '2025-12-07 16:07:40');
-INSERT INTO `transactions` VALUES (14, '6214202512071606905', '收款', 100000.00, '621420230101000001', '转账收入', '2025-12-07 16:07:40');
-
--- ----------------------------
--- Table structure for users
--- ----------------------------
-DROP TABLE IF EXISTS `users`;
-CREATE TABLE `users`  (
-  `user_id` int NOT NULL AUTO_INCREMENT,
-  `username` varchar(50) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL,
-  `password` varchar(100) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL,
-  `full_name` varchar(100) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL,
-  `id_card` varchar(20) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL,
-  `phone` varchar(15) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NULL DEFAULT NULL,
-  `email` varchar(100) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NULL DEFAULT NULL,
-  `created_at` timestamp NULL DEFAULT CURRENT_TIMESTAMP,
-  PRIMARY KEY (`user_id`) USING BTREE,
-  UNIQUE INDEX `username`(`username` ASC) USING BTREE,
-  UNIQUE INDEX `id_card`(`id_card` ASC) USING BTREE,
-  INDEX `idx_users_username`(`username` ASC) USING BTREE
-) ENGINE = InnoDB AUTO_INCREMENT = 8 CHARACTER SET = utf8mb4 COLLATE = utf8mb4_unicode_ci ROW_FORMAT = Dynamic;
-
--- ----------------------------
--- Records of users
--- ----------------------------
-INSERT INTO `users` VALUES (1, 'admin', '123456789', '系统管理员', '110101199001011234', '13800138000', 'admin@bank.com', '2025-12-06 17:51:44');
-INSERT INTO `users` VALUES (2, 'zhangsan', '123456', '张三', '110101199001011235', '13800138001', 'zhangsan@email.com', '2025-12-06 17:51:44');
-INSERT INTO `users` VALUES (3, 'lisi', '123456', '李四', '110101199001011236', '13800138002', 'lisi@email.com', '2025-12-06 17:51:44');
-INSERT INTO `users` VALUES (4, 'lehee', '123456', 'ikun', '12345678890098', '13867462365', 'lehe@bank.com', '2025-12-07 13:17:32');
-INSERT INTO `users` VALUES (5, 'eternal', 'mimaismima', 'hope', '12323245546778964568', '17627349859095', 'imissyou@email.com', '2025-12-07 16:02:26');
-INSERT INTO `users` VALUES (6, 'jjs', '123456789', 'jjs', '12334567894141241513', '1241524642646', 'fafee@email.com', '2025-12-07 16:06:16');
-INSERT INTO `users` VALUES (7, 'jiji', '114514', 'tp', '12343243567890877656', '1223456789087', 'gggd@out.com', '2025-12-07 16:42:19');
-
-SET FOREIGN_KEY_CHECKS = 1;
+/*
+ Navicat MySQL Dump SQL
+
+ Source Server         : mine
+ Source Server Type    : MySQL
+ Source Server Version : 80044 (8.0.44)
+ Source Host           : localhost:3306
+ Source Schema         : banksystem
+
+ Target Server Type    : MySQL
+ Target Server Version : 80044 (8.0.44)
+ File Encoding         : 65001
+
+ Date: 08/12/2025 20:28:27
+*/
+
+SET NAMES utf8mb4;
+SET FOREIGN_KEY_CHECKS = 0;
+
+-- ----------------------------
+-- Table structure for account_statuses
+-- ----------------------------
+DROP TABLE IF EXISTS `account_statuses`;
+CREATE TABLE `account_statuses`  (
+  `status_code` tinyint UNSIGNED NOT NULL,
+  `status_name` varchar(20) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL,
+  PRIMARY KEY (`status_code`) USING BTREE,
+  UNIQUE INDEX `uk_account_statuses_name`(`status_name` ASC) USING BTREE
+) ENGINE = InnoDB CHARACTER SET = utf8mb4 COLLATE = utf8mb4_unicode_ci ROW_FORMAT = Dynamic;
+
+-- ----------------------------
+-- Records of account_statuses
+-- ----------------------------
+INSERT INTO `account_statuses` VALUES (1, '正常');
+INSERT INTO `account_statuses` VALUES (2, '冻结');
+INSERT INTO `account_statuses` VALUES (3, '已销户');
+
+-- ----------------------------
+-- Table structure for account_types
+-- ----------------------------
+DROP TABLE IF EXISTS `account_types`;
+CREATE TABLE `account_types`  (
+  `type_code` tinyint UNSIGNED NOT NULL AUTO_INCREMENT,
+  `type_name` varchar(20) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL,
+  PRIMARY KEY (`type_code`) USING BTREE,
+  UNIQUE INDEX `uk_account_types_name`(`type_name` ASC) USING BTREE
+) ENGINE = InnoDB AUTO_INCREMENT = 4 CHARACTER SET = utf8mb4 COLLATE = utf8mb4_unicode_ci ROW_FORMAT = Dynamic;
+
+-- ----------------------------
+-- Records of account_types
+-- ----------------------------
+INSERT INTO `account_types` VALUES (1, '储蓄账户');
+INSERT INTO `account_types` VALUES (2, '活期账户');
+INSERT INTO `account_types` VALUES (3, '定期账户');
+
+-- ----------------------------
+-- Table structure for accounts
+-- ----------------------------
+DROP TABLE IF EXISTS `accounts`;
+CREATE TABLE `accounts`  (
+  `account_id` bigint UNSIGNED NOT NULL,
+  `user_id` int NOT NULL,
+  `account_type` tinyint UNSIGNED NULL DEFAULT 1,
+  `balance` decimal(15, 2) NULL DEFAULT 0.00,
+  `status` tinyint UNSIGNED NULL DEFAULT 1,
+  `created_at` timestamp NULL DEFAULT CURRENT_TIMESTAMP,
+  `interest_carry` bigint NOT NULL DEFAULT 0,
+  `status_changed_at` timestamp NOT NULL DEFAULT CURRENT_TIMESTAMP,
+  PRIMARY KEY (`account_id`) USING BTREE,
+  INDEX `idx_accounts_user_id`(`user_id` ASC) USING BTREE,
+  INDEX `idx_accounts_created`(`created_at` DESC, `account_id` DESC) USING BTREE,
+  INDEX `idx_accounts_status_changed`(`status_changed_at` ASC) USING BTREE,
+  INDEX `idx_accounts_status_created`(`status` ASC, `created_at` DESC, `account_id` DESC) USING BTREE,
+  INDEX `idx_accounts_balance`(`balance` DESC, `account_id` DESC) USING BTREE,
+  CONSTRAINT `accounts_ibfk_1` FOREIGN KEY (`user_id`) REFERENCES `users` (`user_id`) ON DELETE CASCADE ON UPDATE RESTRICT
+) ENGINE = InnoDB CHARACTER SET = utf8mb4 COLLATE = utf8mb4_unicode_ci ROW_FORMAT = Dynamic;
+
+-- ----------------------------
+-- Records of accounts
+-- ----------------------------
+INSERT INTO `accounts` VALUES (621420230101000001, 1, 1, 9769809.00, 1, '2025-12-06 17:52:09', 0, '2025-12-06 17:52:09');
+INSERT INTO `accounts` VALUES (621420230101000002, 2, 1, 244191.00, 2, '2025-12-06 17:52:09', 0, '2025-12-06 17:52:09');
+INSERT INTO `accounts` VALUES (621420230101000003, 3, 1, 3000.00, 1, '2025-12-06 17:52:09', 0, '2025-12-06 17:52:09');
+INSERT INTO `accounts` VALUES (6214202512071526506, 1, 2, 1000.00, 1, '2025-12-07 15:26:26', 0, '2025-12-07 15:26:26');
+INSERT INTO `accounts` VALUES (6214202512071526691, 1, 3, 0.00, 1, '2025-12-07 15:26:34', 0, '2025-12-07 15:26:34');
+INSERT INTO `accounts` VALUES (6214202512071606905, 6, 1, 100000.00, 1, '2025-12-07 16:06:43', 0, '2025-12-07 16:06:43');
+INSERT INTO `accounts` VALUES (6214202512071642726, 7, 1, 0.00, 1, '2025-12-07 16:42:34', 0, '2025-12-07 16:42:34');
+
+-- ----------------------------
+-- Table structure for transaction_types
+-- ----------------------------
+DROP TABLE IF EXISTS `transaction_types`;
+CREATE TABLE `transaction_types`  (
+  `type_code` tinyint UNSIGNED NOT NULL,
+  `type_name` varchar(20) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL,
+  PRIMARY KEY (`type_code`) USING BTREE,
+  UNIQUE INDEX `uk_transaction_types_name`(`type_name` ASC) USING BTREE
+) ENGINE = InnoDB CHARACTER SET = utf8mb4 COLLATE = utf8mb4_unicode_ci ROW_FORMAT = Dynamic;
+
+-- ----------------------------
+-- Records of transaction_types
+-- ----------------------------
+INSERT INTO `transaction_types` VALUES (1, '存款');
+INSERT INTO `transaction_types` VALUES (2, '取款');
+INSERT INTO `transaction_types` VALUES (3, '转账');
+INSERT INTO `transaction_types` VALUES (4, '收款');
+INSERT INTO `transaction_types` VALUES (5, '利息');
+
+-- ----------------------------
+-- Table structure for transactions
+-- ----------------------------
+DROP TABLE IF EXISTS `transactions`;
+CREATE TABLE `transactions`  (
+  `transaction_id` int NOT NULL AUTO_INCREMENT,
+  `account_id` bigint UNSIGNED NOT NULL,
+  `transaction_type` tinyint UNSIGNED NOT NULL,
+  `amount` decimal(15, 2) NOT NULL,
+  `target_account` bigint UNSIGNED NULL DEFAULT NULL,
+  `credit_account` bigint UNSIGNED NULL DEFAULT NULL,
+  `description` varchar(200) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NULL DEFAULT NULL,
+  `transaction_time` timestamp NOT NULL DEFAULT CURRENT_TIMESTAMP,
+  PRIMARY KEY (`transaction_id`, `transaction_time`) USING BTREE,
+  INDEX `idx_transactions_account_time`(`account_id` ASC, `transaction_time` DESC, `transaction_id` DESC, `description` ASC) USING BTREE,
+  INDEX `idx_transactions_account_type_time`(`account_id` ASC, `transaction_type` ASC, `transaction_time` DESC) USING BTREE,
+  INDEX `idx_transactions_account_type_amount`(`account_id` ASC, `transaction_type` ASC, `amount` ASC) USING BTREE,
+  INDEX `idx_transactions_credit_time`(`credit_account` ASC, `transaction_time` DESC, `transaction_id` DESC, `description` ASC) USING BTREE,
+  INDEX `idx_transactions_time`(`transaction_time` DESC, `description` ASC) USING BTREE
+) ENGINE = InnoDB AUTO_INCREMENT = 15 CHARACTER SET = utf8mb4 COLLATE = utf8mb4_unicode_ci ROW_FORMAT = Dynamic
+PARTITION BY RANGE (UNIX_TIMESTAMP(`transaction_time`)) (
+  PARTITION `p202512` VALUES LESS THAN (UNIX_TIMESTAMP('2026-01-01 00:00:00')),
+  PARTITION `p202601` VALUES LESS THAN (UNIX_TIMESTAMP('2026-02-01 00:00:00')),
+  PARTITION `p202602` VALUES LESS THAN (UNIX_TIMESTAMP('2026-03-01 00:00:00')),
+  PARTITION `p202603` VALUES LESS THAN (UNIX_TIMESTAMP('2026-04-01 00:00:00')),
+  PARTITION `pmax` VALUES LESS THAN MAXVALUE
+);
+
+-- ----------------------------
+-- Table structure for archived_account_flows
+-- ----------------------------
+DROP TABLE IF EXISTS `archived_account_flows`;
+CREATE TABLE `archived_account_flows`  (
+  `account_id` bigint UNSIGNED NOT NULL,
+  `net_amount` decimal(17, 2) NOT NULL DEFAULT 0.00,
+  PRIMARY KEY (`account_id`) USING BTREE
+) ENGINE = InnoDB CHARACTER SET = utf8mb4 COLLATE = utf8mb4_unicode_ci ROW_FORMAT = Dynamic;
+
+-- ----------------------------
+-- Table structure for balance_checkpoint_runs
+-- ----------------------------
+DROP TABLE IF EXISTS `balance_checkpoint_runs`;
+CREATE TABLE `balance_checkpoint_runs`  (
+  `checkpoint_date` date NOT NULL,
+  `accounts` int NOT NULL DEFAULT 0,
+  `completed_at` timestamp NOT NULL DEFAULT CURRENT_TIMESTAMP,
+  PRIMARY KEY (`checkpoint_date`) USING BTREE
+) ENGINE = InnoDB CHARACTER SET = utf8mb4 COLLATE = utf8mb4_unicode_ci ROW_FORMAT = Dynamic;
+
+-- ----------------------------
+-- Table structure for balance_checkpoints
+-- ----------------------------
+DROP TABLE IF EXISTS `balance_checkpoints`;
+CREATE TABLE `balance_checkpoints`  (
+  `account_id` bigint UNSIGNED NOT NULL,
+  `checkpoint_date` date NOT NULL,
+  `balance` decimal(15, 2) NOT NULL,
+  PRIMARY KEY (`account_id`, `checkpoint_date`) USING BTREE
+) ENGINE = InnoDB CHARACTER SET = utf8mb4 COLLATE = utf8mb4_unicode_ci ROW_FORMAT = Dynamic;
+
+-- ----------------------------
+-- Table structure for closed_account_transactions
+-- ----------------------------
+DROP TABLE IF EXISTS `closed_account_transactions`;
+CREATE TABLE `closed_account_transactions`  (
+  `transaction_id` int NOT NULL,
+  `account_id` bigint UNSIGNED NOT NULL,
+  `transaction_type` tinyint UNSIGNED NOT NULL,
+  `amount` decimal(15, 2) NOT NULL,
+  `target_account` bigint UNSIGNED NULL DEFAULT NULL,
+  `description` varchar(200) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NULL DEFAULT NULL,
+  `transaction_time` timestamp NOT NULL,
+  `purged_at` timestamp NOT NULL DEFAULT CURRENT_TIMESTAMP,
+  PRIMARY KEY (`transaction_id`, `account_id`) USING BTREE,
+  INDEX `idx_closed_account_time`(`account_id` ASC, `transaction_time` DESC) USING BTREE
+) ENGINE = InnoDB CHARACTER SET = utf8mb4 COLLATE = utf8mb4_unicode_ci ROW_FORMAT = Dynamic;
+
+-- ----------------------------
+-- Table structure for idempotency_keys
+-- ----------------------------
+DROP TABLE IF EXISTS `idempotency_keys`;
+CREATE TABLE `idempotency_keys`  (
+  `idem_key` varchar(64) CHARACTER SET utf8mb4 COLLATE utf8mb4_bin NOT NULL,
+  `operation` varchar(32) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL,
+  `request_fingerprint` char(64) CHARACTER SET ascii COLLATE ascii_bin NOT NULL,
+  `success` tinyint(1) NOT NULL,
+  `result` varchar(64) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NULL DEFAULT NULL,
+  `created_at` timestamp NOT NULL DEFAULT CURRENT_TIMESTAMP,
+  PRIMARY KEY (`idem_key`) USING BTREE,
+  INDEX `idx_idempotency_created_at`(`created_at` ASC) USING BTREE
+) ENGINE = InnoDB CHARACTER SET = utf8mb4 COLLATE = utf8mb4_unicode_ci ROW_FORMAT = Dynamic;
+
+-- ----------------------------
+-- Table structure for interest_accrual_chunks
+-- ----------------------------
+DROP TABLE IF EXISTS `interest_accrual_chunks`;
+CREATE TABLE `interest_accrual_chunks`  (
+  `accrual_date` date NOT NULL,
+  `chunk_no` int NOT NULL,
+  `low_account` bigint UNSIGNED NULL DEFAULT NULL,
+  `high_account` bigint UNSIGNED NULL DEFAULT NULL,
+  `status` varchar(10) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL DEFAULT 'pending',
+  `accounts` int NOT NULL DEFAULT 0,
+  `interest` decimal(17, 2) NOT NULL DEFAULT 0.00,
+  `finished_at` timestamp NULL DEFAULT NULL,
+  PRIMARY KEY (`accrual_date`, `chunk_no`) USING BTREE
+) ENGINE = InnoDB CHARACTER SET = utf8mb4 COLLATE = utf8mb4_unicode_ci ROW_FORMAT = Dynamic;
+
+-- ----------------------------
+-- Table structure for interest_accrual_runs
+-- ----------------------------
+DROP TABLE IF EXISTS `interest_accrual_runs`;
+CREATE TABLE `interest_accrual_runs`  (
+  `accrual_date` date NOT NULL,
+  `status` varchar(10) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL DEFAULT 'running',
+  `chunks` int NOT NULL DEFAULT 0,
+  `accounts` bigint NOT NULL DEFAULT 0,
+  `interest` decimal(19, 2) NOT NULL DEFAULT 0.00,
+  `started_at` timestamp NOT NULL DEFAULT CURRENT_TIMESTAMP,
+  `finished_at` timestamp NULL DEFAULT NULL,
+  PRIMARY KEY (`accrual_date`) USING BTREE
+) ENGINE = InnoDB CHARACTER SET = utf8mb4 COLLATE = utf8mb4_unicode_ci ROW_FORMAT = Dynamic;
+
+-- ----------------------------
+-- Table structure for interest_rates
+-- ----------------------------
+DROP TABLE IF EXISTS `interest_rates`;
+CREATE TABLE `interest_rates`  (
+  `type_code` tinyint UNSIGNED NOT NULL,
+  `annual_rate` decimal(9, 6) NOT NULL,
+  PRIMARY KEY (`type_code`) USING BTREE,
+  CONSTRAINT `fk_interest_rates_type` FOREIGN KEY (`type_code`) REFERENCES `account_types` (`type_code`) ON DELETE RESTRICT ON UPDATE RESTRICT
+) ENGINE = InnoDB CHARACTER SET = utf8mb4 COLLATE = utf8mb4_unicode_ci ROW_FORMAT = Dynamic;
+
+-- ----------------------------
+-- Records of interest_rates
+-- ----------------------------
+INSERT INTO `interest_rates` VALUES (1, 0.003500);
+INSERT INTO `interest_rates` VALUES (2, 0.002000);
+INSERT INTO `interest_rates` VALUES (3, 0.015000);
+
+-- ----------------------------
+-- Table structure for outbox_events
+-- ----------------------------
+DROP TABLE IF EXISTS `outbox_events`;
+CREATE TABLE `outbox_events`  (
+  `event_id` bigint UNSIGNED NOT NULL AUTO_INCREMENT,
+  `event_type` varchar(16) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL,
+  `account_id` bigint UNSIGNED NOT NULL,
+  `transaction_id` int NULL DEFAULT NULL,
+  `transaction_type` tinyint UNSIGNED NULL DEFAULT NULL,
+  `amount` decimal(15, 2) NULL DEFAULT NULL,
+  `counterparty` bigint UNSIGNED NULL DEFAULT NULL,
+  `description` varchar(200) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NULL DEFAULT NULL,
+  `balance_after` decimal(15, 2) NULL DEFAULT NULL,
+  `account_status` tinyint UNSIGNED NULL DEFAULT NULL,
+  `created_at` timestamp(3) NOT NULL DEFAULT CURRENT_TIMESTAMP(3),
+  PRIMARY KEY (`event_id`) USING BTREE,
+  INDEX `idx_outbox_created_at`(`created_at` ASC) USING BTREE
+) ENGINE = InnoDB CHARACTER SET = utf8mb4 COLLATE = utf8mb4_unicode_ci ROW_FORMAT = Dynamic;
+
+-- ----------------------------
+-- Table structure for scheduled_transfer_runs
+-- ----------------------------
+DROP TABLE IF EXISTS `scheduled_transfer_runs`;
+CREATE TABLE `scheduled_transfer_runs`  (
+  `run_id` bigint UNSIGNED NOT NULL AUTO_INCREMENT,
+  `order_id` bigint UNSIGNED NOT NULL,
+  `due_at` datetime NOT NULL,
+  `executed_at` timestamp NOT NULL DEFAULT CURRENT_TIMESTAMP,
+  `outcome` varchar(24) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL,
+  `transaction_id` int NULL DEFAULT NULL,
+  `message` varchar(200) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NULL DEFAULT NULL,
+  PRIMARY KEY (`run_id`) USING BTREE,
+  UNIQUE INDEX `uk_scheduled_run`(`order_id` ASC, `due_at` ASC) USING BTREE
+) ENGINE = InnoDB CHARACTER SET = utf8mb4 COLLATE = utf8mb4_unicode_ci ROW_FORMAT = Dynamic;
+
+-- ----------------------------
+-- Table structure for scheduled_transfers
+-- ----------------------------
+DROP TABLE IF EXISTS `scheduled_transfers`;
+CREATE TABLE `scheduled_transfers`  (
+  `order_id` bigint UNSIGNED NOT NULL AUTO_INCREMENT,
+  `from_account` bigint UNSIGNED NOT NULL,
+  `to_account` bigint UNSIGNED NOT NULL,
+  `amount` decimal(15, 2) NOT NULL,
+  `description` varchar(200) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NULL DEFAULT NULL,
+  `frequency` varchar(10) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL DEFAULT 'once',
+  `interval_count` int NOT NULL DEFAULT 1,
+  `start_at` datetime NOT NULL,
+  `end_at` datetime NULL DEFAULT NULL,
+  `max_runs` int NULL DEFAULT NULL,
+  `runs_done` int NOT NULL DEFAULT 0,
+  `next_run_at` datetime NOT NULL,
+  `status` varchar(10) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL DEFAULT 'active',
+  `consecutive_failures` int NOT NULL DEFAULT 0,
+  `last_run_at` timestamp NULL DEFAULT NULL,
+  `created_at` timestamp NOT NULL DEFAULT CURRENT_TIMESTAMP,
+  `updated_at` timestamp NOT NULL DEFAULT CURRENT_TIMESTAMP ON UPDATE CURRENT_TIMESTAMP,
+  PRIMARY KEY (`order_id`) USING BTREE,
+  INDEX `idx_scheduled_due`(`status` ASC, `next_run_at` ASC, `order_id` ASC) USING BTREE,
+  INDEX `idx_scheduled_updated_at`(`updated_at` ASC) USING BTREE,
+  INDEX `idx_scheduled_from_account`(`from_account` ASC) USING BTREE
+) ENGINE = InnoDB CHARACTER SET = utf8mb4 COLLATE = utf8mb4_unicode_ci ROW_FORMAT = Dynamic;
+
+-- ----------------------------
+-- Table structure for transaction_archives
+-- ----------------------------
+DROP TABLE IF EXISTS `transaction_archives`;
+CREATE TABLE `transaction_archives`  (
+  `archive_id` int NOT NULL AUTO_INCREMENT,
+  `partition_name` varchar(16) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL,
+  `range_start` timestamp NOT NULL,
+  `range_end` timestamp NOT NULL,
+  `file_path` varchar(255) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL,
+  `row_count` int NOT NULL,
+  `checksum` char(64) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL,
+  `archived_at` timestamp NULL DEFAULT CURRENT_TIMESTAMP,
+  PRIMARY KEY (`archive_id`) USING BTREE,
+  UNIQUE INDEX `uk_archives_partition`(`partition_name` ASC) USING BTREE,
+  INDEX `idx_archives_range`(`range_start` ASC, `range_end` ASC) USING BTREE
+) ENGINE = InnoDB CHARACTER SET = utf8mb4 COLLATE = utf8mb4_unicode_ci ROW_FORMAT = Dynamic;
+
+-- ----------------------------
+-- Records of transactions
+-- ----------------------------
+INSERT INTO `transactions` VALUES (1, 621420230101000001, 1, 100000.00, NULL, NULL, '存款操作', '2025-12-06 20:15:17');
+INSERT INTO `transactions` VALUES (2, 621420230101000001, 3, 100000.00, 621420230101000002, 621420230101000002, '转账支出', '2025-12-07 00:45:18');
+INSERT INTO `transactions` VALUES (4, 621420230101000001, 1, 10000000.00, NULL, NULL, '存款操作', '2025-12-07 13:14:09');
+INSERT INTO `transactions` VALUES (5, 621420230101000001, 3, 114514.00, 621420230101000002, 621420230101000002, '转账支出', '2025-12-07 13:15:15');
+INSERT INTO `transactions` VALUES (7, 621420230101000001, 3, 12332.00, 621420230101000002, 621420230101000002, '转账支出', '2025-12-07 15:27:45');
+INSERT INTO `transactions` VALUES (9, 621420230101000001, 3, 12345.00, 621420230101000002, 621420230101000002, '转账支出', '2025-12-07 15:27:56');
+INSERT INTO `transactions` VALUES (11, 621420230101000001, 3, 1000.00, 6214202512071526506, 6214202512071526506, '转账支出', '2025-12-07 15:29:09');
+INSERT INTO `transactions` VALUES (13, 621420230101000001, 3, 100000.00, 6214202512071606905, 6214202512071606905, '转账支出', '2025-12-07 16:07:40');
+
+-- ----------------------------
+-- Table structure for users
+-- ----------------------------
+DROP TABLE IF EXISTS `users`;
+CREATE TABLE `users`  (
+  `user_id` int NOT NULL AUTO_INCREMENT,
+  `username` varchar(50) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL,
+  `password` varchar(255) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL,
+  `full_name` varchar(100) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL,
+  `id_card` varchar(20) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL,
+  `phone` varchar(15) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NULL DEFAULT NULL,
+  `email` varchar(100) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NULL DEFAULT NULL,
+  `role` varchar(16) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL DEFAULT 'customer',
+  `created_at` timestamp NULL DEFAULT CURRENT_TIMESTAMP,
+  PRIMARY KEY (`user_id`) USING BTREE,
+  UNIQUE INDEX `username`(`username` ASC) USING BTREE,
+  UNIQUE INDEX `id_card`(`id_card` ASC) USING BTREE,
+  INDEX `idx_users_phone`(`phone` ASC) USING BTREE
+) ENGINE = InnoDB AUTO_INCREMENT = 8 CHARACTER SET = utf8mb4 COLLATE = utf8mb4_unicode_ci ROW_FORMAT = Dynamic;
+
+-- ----------------------------
+-- Records of users
+-- ----------------------------
+-- 演示账号的口令不变（如 zhangsan / 123456），以 scrypt 散列存储（ln=14, r=8, p=1）
+INSERT INTO `users` VALUES (1, 'admin', '$scrypt$ln=14,r=8,p=1$95c6DM4FHsa/yfdRQ4Z1rw$f0k5ERpmLlOXGj2QEGHpF+39nzTMIUblQgtaKRcDiKQ', '系统管理员', '110101199001011234', '13800138000', 'admin@bank.com', 'admin', '2025-12-06 17:51:44');
+INSERT INTO `users` VALUES (2, 'zhangsan', '$scrypt$ln=14,r=8,p=1$1B9fPpHJaHkA1GdBKnBang$GsOzNoYfeZKUH/8eFbp8Bbr+xxGe1rlEVvrNjFMLyPM', '张三', '110101199001011235', '13800138001', 'zhangsan@email.com', 'customer', '2025-12-06 17:51:44');
+INSERT INTO `users` VALUES (3, 'lisi', '$scrypt$ln=14,r=8,p=1$HdMx67I1BpnWtzUltEJDLQ$RgU4CCM1RRaOxxjhKDSPiib0tS/6M7aDNXdxG1cgsEs', '李四', '110101199001011236', '13800138002', 'lisi@email.com', 'customer', '2025-12-06 17:51:44');
+INSERT INTO `users` VALUES (4, 'lehee', '$scrypt$ln=14,r=8,p=1$vHGuFldlDNIxTeNrHLMvyg$9m7+XIXlNkl+Yh9L+u4nyiWwrpdZva5QG37F5xYQU0g', 'ikun', '12345678890098', '13867462365', 'lehe@bank.com', 'customer', '2025-12-07 13:17:32');
+INSERT INTO `users` VALUES (5, 'eternal', '$scrypt$ln=14,r=8,p=1$exdCwD9TAafe7OoD2S/6kA$nizz73fHUcRua86VsFKjDTRN24jtjigFjHROEclbY3E', 'hope', '12323245546778964568', '17627349859095', 'imissyou@email.com', 'customer', '2025-12-07 16:02:26');
+INSERT INTO `users` VALUES (6, 'jjs', '$scrypt$ln=14,r=8,p=1$MUKoNDp0Wq/K80xsmbgPFQ$VJVUNJRgCeIdYuh07f50nJg1Fr+Xm/Tsobf1fEhETxI', 'jjs', '12334567894141241513', '1241524642646', 'fafee@email.com', 'customer', '2025-12-07 16:06:16');
+INSERT INTO `users` VALUES (7, 'jiji', '$scrypt$ln=14,r=8,p=1$EyJsvDd4mQaGuUl7QhIxRw$A1r/aLupguCfDTi0U9UyJ4Spl7tcdEFq6Js05kVCBFk', 'tp', '12343243567890877656', '1223456789087', 'gggd@out.com', 'customer', '2025-12-07 16:42:19');
+
+-- ----------------------------
+-- Table structure for velocity_limits
+-- ----------------------------
+DROP TABLE IF EXISTS `velocity_limits`;
+CREATE TABLE `velocity_limits`  (
+  `type_code` tinyint UNSIGNED NOT NULL,
+  `operation` varchar(10) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL,
+  `daily_amount` decimal(15, 2) NOT NULL DEFAULT 0.00,
+  `daily_count` int NOT NULL DEFAULT 0,
+  `hourly_amount` decimal(15, 2) NOT NULL DEFAULT 0.00,
+  `hourly_count` int NOT NULL DEFAULT 0,
+  PRIMARY KEY (`type_code`, `operation`) USING BTREE,
+  CONSTRAINT `fk_velocity_limits_type` FOREIGN KEY (`type_code`) REFERENCES `account_types` (`type_code`) ON DELETE RESTRICT ON UPDATE RESTRICT
+) ENGINE = InnoDB CHARACTER SET = utf8mb4 COLLATE = utf8mb4_unicode_ci ROW_FORMAT = Dynamic;
+
+-- ----------------------------
+-- Records of velocity_limits
+-- ----------------------------
+INSERT INTO `velocity_limits` VALUES (1, 'withdraw', 50000.00, 20, 20000.00, 10);
+INSERT INTO `velocity_limits` VALUES (1, 'transfer', 200000.00, 50, 50000.00, 20);
+INSERT INTO `velocity_limits` VALUES (2, 'withdraw', 50000.00, 20, 20000.00, 10);
+INSERT INTO `velocity_limits` VALUES (2, 'transfer', 200000.00, 50, 50000.00, 20);
+INSERT INTO `velocity_limits` VALUES (3, 'withdraw', 10000.00, 3, 0.00, 0);
+INSERT INTO `velocity_limits` VALUES (3, 'transfer', 10000.00, 3, 0.00, 0);
+
+SET FOREIGN_KEY_CHECKS = 1;
@@ -0,0 +1,134 @@
+// 报表列存扫描基准：生成合成流水写入临时列存目录，计时三种报表各查询两次。
+// 最先执行的查询包含读盘与解压，之后的查询在缓存装得下全部段时只有扫描与聚合
+//
+//   columnscan --rows 100000000 --accounts 1000000 --threads 8
+//
+// 流水按交易号递增，时间均匀分布在最近一年内；类型为存款、取款、转账、利息（转账带对方账户），
+// 账户均匀抽取。不需要数据库。--keep 保留生成的目录（配合 --store 指定位置）。
+#include "columnstore.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <QDirIterator>
+#include <QRandomGenerator>
+#include <QTextStream>
+#include <QVector>
+
+namespace {
+
+qint64 directoryBytes(const QString& path)
+{
+    qint64 total = 0;
+    QDirIterator it(path, QDir::Files);
+    while (it.hasNext()) {
+        it.next();
+        total += it.fileInfo().size();
+    }
+    return total;
+}
+
+bool generate(ColumnStore& store, qint64 rows, int accounts, QTextStream& out)
+{
+    const QStringList types = { "存款", "取款", "转账", "利息" };
+    QVector<QString> ids(accounts);
+    for (int i = 0; i < accounts; ++i) ids[i] = QString("6214999%1").arg(i, 12, 10, QChar('0'));
+
+    QRandomGenerator random(20240601);
+    const qint64 end = QDateTime::currentSecsSinceEpoch();
+    const qint64 start = end - 365LL * 86400;
+    ColumnSegmentBuilder builder;
+
+    for (qint64 i = 0; i < rows; ++i) {
+        const QString& type = types.at(random.bounded(types.size()));
+        const int account = random.bounded(accounts);
+        const QString target = type == types.at(2) ? ids.at((account + 1 + random.bounded(accounts - 1)) % accounts)
+                                                   : QString();
+        // 金额按数量级大致均匀：先取位数再取值
+        const qint64 scale = qint64(1) << random.bounded(30);
+        const qint64 amount = 1 + qint64(random.bounded(quint32(qMin<qint64>(scale, 2000000000))));
+
+        builder.add(i + 1, start + (end - start) * i / rows, type, amount, ids.at(account), target);
+        if (builder.rows() >= ColumnStore::kSegmentRows) {
+            if (!store.writeSegment(builder)) return false;
+            builder.clear();
+            out << QString("\r已生成 %1 / %2").arg(i + 1).arg(rows) << Qt::flush;
+        }
+    }
+    const bool ok = store.writeSegment(builder);
+    out << Qt::endl;
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("columnscan");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("银行账户管理系统 - 报表列存扫描基准");
+    parser.addHelpOption();
+    parser.addOptions({
+        { "rows", "流水条数", "count", "100000000" },
+        { "accounts", "账户数", "count", "1000000" },
+        { "threads", "并行线程数", "threads" },
+        { "cache-mb", "解压段缓存上限（MB）", "megabytes", "4096" },
+        { "store", "列存目录，默认使用临时目录", "path" },
+        { "keep", "保留生成的目录" },
+    });
+    parser.process(app);
+
+    QTextStream out(stdout);
+    const qint64 rows = qMax<qint64>(1, parser.value("rows").toLongLong());
+    const int accounts = qMax(2, parser.value("accounts").toInt());
+
+    QTemporaryDir temporary;
+    temporary.setAutoRemove(!parser.isSet("keep"));
+    const QString path = parser.isSet("store") ? parser.value("store") : temporary.path();
+
+    ColumnStore store(path);
+    if (parser.isSet("threads")) store.setThreadCount(parser.value("threads").toInt());
+    store.setCacheMegabytes(parser.value("cache-mb").toInt());
+
+    QElapsedTimer clock;
+    clock.start();
+    if (store.postingCount() == 0 && !generate(store, rows, accounts, out)) {
+        out << "写入列存失败" << Qt::endl;
+        return 1;
+    }
+    const qint64 postings = store.postingCount();
+    out << QString("列存 %1 条流水，%2 MB（%3 字节/条），准备耗时 %4 s")
+               .arg(postings)
+               .arg(directoryBytes(path) / (1024.0 * 1024.0), 0, 'f', 1)
+               .arg(double(directoryBytes(path)) / qMax<qint64>(1, postings), 0, 'f', 2)
+               .arg(clock.elapsed() / 1000.0, 0, 'f', 1) << Qt::endl;
+
+    PostingFilter all;
+    PostingFilter lastMonth;
+    lastMonth.from = QDateTime::currentDateTime().addDays(-30);
+    PostingFilter transfers;
+    transfers.type = "转账";
+
+    auto measure = [&out, postings](const QString& name, const std::function<int()>& query) {
+        for (int pass = 1; pass <= 2; ++pass) {
+            QElapsedTimer timer;
+            timer.start();
+            const int results = query();
+            const qint64 ms = qMax<qint64>(1, timer.elapsed());
+            out << QString("%1（第 %2 次）：%3 ms，%4 行结果，%5 百万行/秒")
+                       .arg(name)
+                       .arg(pass)
+                       .arg(ms)
+                       .arg(results)
+                       .arg(postings / 1000.0 / ms, 0, 'f', 1) << Qt::endl;
+        }
+    };
+
+    measure("按日按类型汇总", [&]() { return store.volumeByTypePerDay(all).size(); });
+    measure("近 30 天按日按类型汇总", [&]() { return store.volumeByTypePerDay(lastMonth).size(); });
+    measure("转账对方账户前 20", [&]() { return store.topCounterparties(transfers, 20).size(); });
+    measure("金额分布", [&]() { return store.amountDistribution(all).size(); });
+    return 0;
+}
@@ -0,0 +1,430 @@
+// 紧凑存储基准：同一份合成数据分别按原来的表结构（账户号 varchar(20)、类型与状态为中文名称）和
+// 紧凑表结构（账户号 BIGINT UNSIGNED、类型与状态为 TINYINT 编码）写入，比较表与各索引的大小，
+// 以及按账户读流水、按时间段联结账户表统计、按账户区间汇总三类查询的耗时
+//
+//   compactschema --host localhost --database banksystem --user root --accounts 100000 --rows 2000000
+//
+// 两种结构各建一对 bench_ 开头的表（索引与线上相同，不分区），结束后删除（--keep 保留）。
+// 索引大小取自 mysql.innodb_index_stats（需要该表的读权限，否则只报告表级的数据与索引大小）。
+// 每类查询先用同一组参数预热一遍再计时，两种结构使用相同的随机参数，结果按行比对。
+// 缓冲池小于数据量时耗时差距主要来自读盘页数，大于数据量时主要来自比较与解码的开销。
+#include "schema.h"
+#include "money.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QSqlRecord>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QDateTime>
+#include <QTextStream>
+#include <QVector>
+#include <QMap>
+#include <QStringList>
+#include <functional>
+
+namespace {
+
+const quint64 kFirstAccount = 6214990000000000000ULL;   // 19 位账户号
+const int kBatchRows = 1000;
+const int kHistoryLimit = 50;
+const int kTotalsSpan = 100;                             // 汇总查询每次覆盖的账户数
+const qint64 kSpanSecs = 90 * 24 * 3600;                 // 流水分布在最近 90 天
+const char* const kAccountTypes[] = { "储蓄账户", "活期账户", "定期账户" };
+
+struct Posting
+{
+    int account = 0;
+    int type = Schema::Deposit;
+    int target = -1;          // 转账的对方账户
+    qint64 cents = 0;
+    qint64 timeSecs = 0;
+};
+
+struct Workload
+{
+    int accounts = 0;
+    qint64 baseSecs = 0;
+    QVector<Posting> postings;
+    QVector<int> historyAccounts;
+    QVector<qint64> joinHours;
+    QVector<int> totalsStarts;
+};
+
+struct Layout
+{
+    const char* name;
+    const char* suffix;
+    bool compact;
+};
+
+struct Result
+{
+    qint64 loadMs = 0;
+    qint64 transactionData = 0;
+    qint64 transactionIndex = 0;
+    qint64 accountData = 0;
+    qint64 accountIndex = 0;
+    QMap<QString, qint64> indexBytes;    // 表名.索引名 -> 字节
+    double historyUs = 0;
+    double joinUs = 0;
+    double totalsUs = 0;
+    quint64 historyChecksum = 0;
+    quint64 joinChecksum = 0;
+    quint64 totalsChecksum = 0;
+};
+
+QString accountsTable(const Layout& layout) { return QString("bench_accounts_%1").arg(layout.suffix); }
+QString transactionsTable(const Layout& layout) { return QString("bench_transactions_%1").arg(layout.suffix); }
+
+QVariant accountValue(const Layout& layout, int index)
+{
+    const quint64 id = kFirstAccount + quint64(index);
+    return layout.compact ? QVariant(qulonglong(id)) : QVariant(QString::number(id));
+}
+
+QVariant typeValue(const Layout& layout, int type)
+{
+    return layout.compact ? QVariant(type) : QVariant(Schema::transactionTypeName(type));
+}
+
+Workload generate(int accounts, int rows, int queries)
+{
+    Workload workload;
+    workload.accounts = accounts;
+    workload.baseSecs = QDateTime::currentSecsSinceEpoch() - kSpanSecs;
+
+    QRandomGenerator random(20250301);
+    workload.postings.reserve(rows);
+    for (int i = 0; i < rows; ++i) {
+        Posting posting;
+        posting.account = random.bounded(accounts);
+        const int roll = random.bounded(100);
+        posting.type = roll < 30 ? Schema::Deposit
+                     : roll < 50 ? Schema::Withdraw
+                     : roll < 90 ? Schema::Transfer
+                                 : Schema::Interest;
+        if (posting.type == Schema::Transfer) {
+            posting.target = (posting.account + 1 + random.bounded(accounts - 1)) % accounts;
+        }
+        posting.cents = random.bounded(1, 500000);
+        posting.timeSecs = workload.baseSecs + random.bounded(int(kSpanSecs));
+        workload.postings.append(posting);
+    }
+
+    for (int i = 0; i < queries; ++i) {
+        workload.historyAccounts.append(random.bounded(accounts));
+        workload.joinHours.append(workload.baseSecs + qint64(random.bounded(int(kSpanSecs / 3600))) * 3600);
+        workload.totalsStarts.append(random.bounded(qMax(1, accounts - kTotalsSpan)));
+    }
+    return workload;
+}
+
+bool createTables(QSqlDatabase& db, const Layout& layout, QTextStream& out)
+{
+    const QString account = layout.compact
+        ? "bigint UNSIGNED" : "varchar(20) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci";
+    const QString code = layout.compact
+        ? "tinyint UNSIGNED" : "varchar(20) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci";
+
+    const QStringList statements = {
+        "DROP TABLE IF EXISTS " + accountsTable(layout),
+        "DROP TABLE IF EXISTS " + transactionsTable(layout),
+        "CREATE TABLE " + accountsTable(layout) + " ("
+        "account_id " + account + " NOT NULL, "
+        "user_id int NOT NULL, "
+        "account_type " + code + " NULL, "
+        "balance decimal(15, 2) NULL DEFAULT 0.00, "
+        "status " + code + " NULL, "
+        "created_at timestamp NULL DEFAULT CURRENT_TIMESTAMP, "
+        "PRIMARY KEY (account_id), "
+        "INDEX idx_accounts_status_created(status ASC, created_at DESC, account_id DESC)"
+        ") ENGINE = InnoDB CHARACTER SET = utf8mb4 COLLATE = utf8mb4_unicode_ci ROW_FORMAT = Dynamic",
+        "CREATE TABLE " + transactionsTable(layout) + " ("
+        "transaction_id int NOT NULL AUTO_INCREMENT, "
+        "account_id " + account + " NOT NULL, "
+        "transaction_type " + code + " NOT NULL, "
+        "amount decimal(15, 2) NOT NULL, "
+        "target_account " + account + " NULL DEFAULT NULL, "
+        "credit_account " + account + " NULL DEFAULT NULL, "
+        "description varchar(200) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NULL DEFAULT NULL, "
+        "transaction_time timestamp NOT NULL DEFAULT CURRENT_TIMESTAMP, "
+        "PRIMARY KEY (transaction_id, transaction_time), "
+        "INDEX idx_transactions_account_time(account_id ASC, transaction_time DESC, transaction_id DESC), "
+        "INDEX idx_transactions_account_type_time(account_id ASC, transaction_type ASC, transaction_time DESC), "
+        "INDEX idx_transactions_account_type_amount(account_id ASC, transaction_type ASC, amount ASC), "
+        "INDEX idx_transactions_credit_time(credit_account ASC, transaction_time DESC, transaction_id DESC), "
+        "INDEX idx_transactions_time(transaction_time DESC)"
+        ") ENGINE = InnoDB CHARACTER SET = utf8mb4 COLLATE = utf8mb4_unicode_ci ROW_FORMAT = Dynamic",
+    };
+
+    QSqlQuery query(db);
+    for (const QString& sql : statements) {
+        if (!query.exec(sql)) {
+            out << "建立临时表失败: " << query.lastError().text() << Qt::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// 多行 INSERT，每批一个事务
+bool load(QSqlDatabase& db, const Layout& layout, const Workload& workload, Result& result, QTextStream& out)
+{
+    QElapsedTimer clock;
+    clock.start();
+    QSqlQuery query(db);
+
+    auto insert = [&](const QString& head, const QString& row, int total,
+                      const std::function<void(int)>& bind) {
+        for (int offset = 0; offset < total; offset += kBatchRows) {
+            const int count = qMin(kBatchRows, total - offset);
+            QStringList rows;
+            for (int i = 0; i < count; ++i) rows << row;
+            if (!db.transaction()) return false;
+            query.prepare(head + rows.join(','));
+            for (int i = offset; i < offset + count; ++i) bind(i);
+            if (!query.exec() || !db.commit()) {
+                out << "写入失败: " << query.lastError().text() << Qt::endl;
+                db.rollback();
+                return false;
+            }
+        }
+        return true;
+    };
+
+    const bool accountsOk = insert(
+        "INSERT INTO " + accountsTable(layout) + " (account_id, user_id, account_type, balance, status) VALUES ",
+        "(?, ?, ?, ?, ?)", workload.accounts, [&](int i) {
+            const int type = i % 3;
+            const int status = i % 50 == 0 ? Schema::Frozen : Schema::Active;
+            query.addBindValue(accountValue(layout, i));
+            query.addBindValue(i + 1);
+            query.addBindValue(layout.compact ? QVariant(type + 1) : QVariant(QString(kAccountTypes[type])));
+            query.addBindValue(Money::toDecimalString(qint64(i % 1000) * 10000));
+            query.addBindValue(layout.compact ? QVariant(status) : QVariant(Schema::accountStatusName(status)));
+        });
+    if (!accountsOk) return false;
+
+    const bool postingsOk = insert(
+        "INSERT INTO " + transactionsTable(layout)
+            + " (account_id, transaction_type, amount, target_account, credit_account, description, transaction_time) VALUES ",
+        "(?, ?, ?, ?, ?, ?, ?)", int(workload.postings.size()), [&](int i) {
+            const Posting& posting = workload.postings.at(i);
+            const QVariant target = posting.target >= 0 ? accountValue(layout, posting.target) : QVariant();
+            query.addBindValue(accountValue(layout, posting.account));
+            query.addBindValue(typeValue(layout, posting.type));
+            query.addBindValue(Money::toDecimalString(posting.cents));
+            query.addBindValue(target);
+            query.addBindValue(target);
+            query.addBindValue(posting.type == Schema::Transfer ? QString("转账支出")
+                               : posting.type == Schema::Interest ? QString("利息入账")
+                                                                  : Schema::transactionTypeName(posting.type) + "操作");
+            query.addBindValue(QDateTime::fromSecsSinceEpoch(posting.timeSecs));
+        });
+    if (!postingsOk) return false;
+
+    result.loadMs = clock.elapsed();
+    return true;
+}
+
+void measureSizes(QSqlDatabase& db, const Layout& layout, Result& result)
+{
+    QSqlQuery query(db);
+    query.exec("SET SESSION information_schema_stats_expiry = 0");
+    for (const QString& table : { accountsTable(layout), transactionsTable(layout) }) {
+        query.exec("ANALYZE TABLE " + table);
+
+        query.prepare("SELECT DATA_LENGTH, INDEX_LENGTH FROM information_schema.TABLES "
+                      "WHERE TABLE_SCHEMA = DATABASE() AND TABLE_NAME = ?");
+        query.addBindValue(table);
+        if (query.exec() && query.next()) {
+            const bool accounts = table == accountsTable(layout);
+            (accounts ? result.accountData : result.transactionData) = query.value(0).toLongLong();
+            (accounts ? result.accountIndex : result.transactionIndex) = query.value(1).toLongLong();
+        }
+
+        query.prepare("SELECT index_name, stat_value * @@innodb_page_size FROM mysql.innodb_index_stats "
+                      "WHERE database_name = DATABASE() AND table_name = ? AND stat_name = 'size'");
+        query.addBindValue(table);
+        if (query.exec()) {
+            const QString prefix = table == accountsTable(layout) ? "accounts." : "transactions.";
+            while (query.next()) result.indexBytes.insert(prefix + query.value(0).toString(), query.value(1).toLongLong());
+        }
+    }
+}
+
+// 执行一组查询，返回平均耗时（微秒）；checksum 为全部结果行的摘要，两种结构应相同
+double timeQueries(QSqlQuery& query, int count, const std::function<void(int)>& bind, quint64& checksum,
+                   QTextStream& out)
+{
+    auto run = [&](bool timed) {
+        QElapsedTimer clock;
+        clock.start();
+        quint64 sum = 0;
+        for (int i = 0; i < count; ++i) {
+            bind(i);
+            if (!query.exec()) {
+                out << "查询失败: " << query.lastError().text() << Qt::endl;
+                return -1.0;
+            }
+            const int columns = query.record().count();
+            while (query.next()) {
+                QStringList values;
+                // 整数列的 NULL 直接 toString() 为 "0"，按空串比对
+                for (int c = 0; c < columns; ++c) values << (query.isNull(c) ? QString() : query.value(c).toString());
+                sum += qHash(values.join('|'));
+            }
+        }
+        if (timed) checksum = sum;
+        return clock.nsecsElapsed() / 1000.0 / qMax(1, count);
+    };
+
+    if (run(false) < 0) return -1.0;   // 预热
+    return run(true);
+}
+
+bool runQueries(QSqlDatabase& db, const Layout& layout, const Workload& workload, Result& result, QTextStream& out)
+{
+    const QString transactions = transactionsTable(layout);
+    const QString accounts = accountsTable(layout);
+    const QString type = layout.compact ? Schema::transactionTypeSql("transaction_type") : QString("transaction_type");
+    const QString status = layout.compact ? Schema::accountStatusSql("a.status") : QString("a.status");
+    const int count = workload.historyAccounts.size();
+
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+
+    // 按账户读流水：借方、贷方两段各取一页再合并，与 searchTransactionHistory 相同
+    query.prepare(QString("(SELECT transaction_id, %1 AS transaction_type, amount, target_account, transaction_time "
+                          "FROM %2 WHERE account_id = ? ORDER BY transaction_time DESC, transaction_id DESC LIMIT %3) "
+                          "UNION ALL "
+                          "(SELECT transaction_id, '收款', amount, account_id, transaction_time "
+                          "FROM %2 WHERE credit_account = ? ORDER BY transaction_time DESC, transaction_id DESC LIMIT %3) "
+                          "ORDER BY transaction_time DESC, transaction_id DESC LIMIT %3")
+                      .arg(type, transactions).arg(kHistoryLimit));
+    result.historyUs = timeQueries(query, count, [&](int i) {
+        const QVariant account = accountValue(layout, workload.historyAccounts.at(i));
+        query.bindValue(0, account);
+        query.bindValue(1, account);
+    }, result.historyChecksum, out);
+
+    // 一小时内的流水按账户状态统计：每行按账户号联结 accounts 主键
+    query.prepare(QString("SELECT %1, COUNT(*), SUM(t.amount) FROM %2 t JOIN %3 a ON a.account_id = t.account_id "
+                          "WHERE t.transaction_time >= ? AND t.transaction_time < ? GROUP BY a.status ORDER BY 1")
+                      .arg(status, transactions, accounts));
+    result.joinUs = timeQueries(query, count, [&](int i) {
+        query.bindValue(0, QDateTime::fromSecsSinceEpoch(workload.joinHours.at(i)));
+        query.bindValue(1, QDateTime::fromSecsSinceEpoch(workload.joinHours.at(i) + 3600));
+    }, result.joinChecksum, out);
+
+    // 按账户区间汇总 (账户, 类型)，走 idx_transactions_account_type_amount，与对账、对账单相同
+    query.prepare(QString("SELECT account_id, %1, SUM(amount) FROM %2 WHERE account_id BETWEEN ? AND ? "
+                          "GROUP BY account_id, transaction_type ORDER BY account_id, transaction_type")
+                      .arg(type, transactions));
+    result.totalsUs = timeQueries(query, count, [&](int i) {
+        query.bindValue(0, accountValue(layout, workload.totalsStarts.at(i)));
+        query.bindValue(1, accountValue(layout, workload.totalsStarts.at(i) + kTotalsSpan - 1));
+    }, result.totalsChecksum, out);
+
+    return result.historyUs >= 0 && result.joinUs >= 0 && result.totalsUs >= 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("compactschema");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("银行账户管理系统 - 紧凑存储基准");
+    parser.addHelpOption();
+    parser.addOptions({
+        { "accounts", "账户数", "count", "100000" },
+        { "rows", "交易记录行数", "count", "2000000" },
+        { "queries", "每类查询的次数", "count", "2000" },
+        { "keep", "保留临时表" },
+        { "host", "数据库服务器", "host", "localhost" },
+        { "database", "数据库名", "database", "banksystem" },
+        { "user", "数据库用户名", "user", "root" },
+        { "password", "数据库密码（也可通过环境变量 BANKSYSTEM_DB_PASSWORD 提供）", "password" },
+    });
+    parser.process(app);
+
+    QTextStream out(stdout);
+    const int accounts = qMax(kTotalsSpan + 1, parser.value("accounts").toInt());
+    const int rows = qMax(1, parser.value("rows").toInt());
+    const int queries = qMax(1, parser.value("queries").toInt());
+
+    QString password = parser.value("password");
+    if (password.isEmpty()) {
+        password = qEnvironmentVariable("BANKSYSTEM_DB_PASSWORD");
+    }
+
+    QSqlDatabase db = QSqlDatabase::addDatabase("QMYSQL", "compactschema");
+    db.setHostName(parser.value("host"));
+    db.setDatabaseName(parser.value("database"));
+    db.setUserName(parser.value("user"));
+    db.setPassword(password);
+    if (!db.open()) {
+        out << "数据库连接失败: " << db.lastError().text() << Qt::endl;
+        return 2;
+    }
+
+    const Workload workload = generate(accounts, rows, queries);
+    const Layout layouts[2] = { { "原结构", "varchar", false }, { "紧凑结构", "compact", true } };
+    Result results[2];
+    for (int i = 0; i < 2; ++i) {
+        out << layouts[i].name << "：写入 " << accounts << " 个账户、" << rows << " 行流水…" << Qt::endl;
+        if (!createTables(db, layouts[i], out) || !load(db, layouts[i], workload, results[i], out)) return 1;
+        measureSizes(db, layouts[i], results[i]);
+        if (!runQueries(db, layouts[i], workload, results[i], out)) return 1;
+    }
+
+    auto ratio = [](double after, double before) { return before > 0 ? 100.0 * (before - after) / before : 0.0; };
+    auto compare = [&](const QString& what, double before, double after, const char* unit) {
+        out << QString("%1：%2 → %3 %4（减少 %5%）")
+                   .arg(what)
+                   .arg(before, 0, 'f', 1)
+                   .arg(after, 0, 'f', 1)
+                   .arg(unit)
+                   .arg(ratio(after, before), 0, 'f', 1) << Qt::endl;
+    };
+    const Result& before = results[0];
+    const Result& after = results[1];
+
+    out << Qt::endl << "存储（每行字节）" << Qt::endl;
+    compare("transactions 数据", double(before.transactionData) / rows, double(after.transactionData) / rows, "B");
+    compare("transactions 索引", double(before.transactionIndex) / rows, double(after.transactionIndex) / rows, "B");
+    compare("accounts 数据", double(before.accountData) / accounts, double(after.accountData) / accounts, "B");
+    compare("accounts 索引", double(before.accountIndex) / accounts, double(after.accountIndex) / accounts, "B");
+    if (before.indexBytes.isEmpty()) {
+        out << "（无法读取 mysql.innodb_index_stats，未列出各索引大小）" << Qt::endl;
+    }
+    for (auto it = before.indexBytes.constBegin(); it != before.indexBytes.constEnd(); ++it) {
+        compare(it.key(), it.value() / 1024.0, after.indexBytes.value(it.key()) / 1024.0, "KB");
+    }
+
+    out << Qt::endl << "查询（每次微秒）" << Qt::endl;
+    compare("按账户读流水", before.historyUs, after.historyUs, "us");
+    compare("按时间段联结账户表", before.joinUs, after.joinUs, "us");
+    compare("按账户区间汇总", before.totalsUs, after.totalsUs, "us");
+    compare("装载（秒）", before.loadMs / 1000.0, after.loadMs / 1000.0, "s");
+
+    const bool same = before.historyChecksum == after.historyChecksum
+                      && before.joinChecksum == after.joinChecksum
+                      && before.totalsChecksum == after.totalsChecksum;
+    out << (same ? QString("结果核对：一致") : QString("结果核对：不一致")) << Qt::endl;
+
+    if (!parser.isSet("keep")) {
+        QSqlQuery query(db);
+        for (const Layout& layout : layouts) {
+            query.exec("DROP TABLE IF EXISTS " + accountsTable(layout));
+            query.exec("DROP TABLE IF EXISTS " + transactionsTable(layout));
+        }
+    }
+    return same ? 0 : 1;
+}
@@ -0,0 +1,116 @@
+// 合并提交基准：多个柜员线程同时存取小额款项，每个柜员等上一笔完成后再提交下一笔
+//
+//   groupcommit --host localhost --database banksystem --user root \
+//               --account 6222021234567890123 --tellers 32 --operations 200
+//   groupcommit ... --window-us 0 --max-batch 1     # 逐笔提交，作为对比
+//
+// 存款与取款交替进行，账户余额在结束后不变；取款次数可能受该账户类型的限额约束。
+#include "databasemanager.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QThread>
+#include <QMutex>
+#include <QVector>
+#include <algorithm>
+
+namespace {
+
+qint64 percentile(QVector<qint64> values, double p)
+{
+    if (values.isEmpty()) return 0;
+    std::sort(values.begin(), values.end());
+    const int index = qBound(0, int(p * (values.size() - 1) + 0.5), values.size() - 1);
+    return values[index];
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("groupcommit");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("银行账户管理系统 - 合并提交基准");
+    parser.addHelpOption();
+    parser.addOptions({
+        { "tellers", "并发柜员线程数", "count", "32" },
+        { "operations", "每个柜员的存取款笔数", "count", "200" },
+        { "window-us", "合并窗口（微秒）", "us", "500" },
+        { "max-batch", "每批最多笔数", "count", "64" },
+        { "account", "存取款账户", "account", "6222021234567890123" },
+        { "host", "数据库服务器", "host", "localhost" },
+        { "database", "数据库名", "database", "banksystem" },
+        { "user", "数据库用户名", "user", "root" },
+        { "password", "数据库密码（也可通过环境变量 BANKSYSTEM_DB_PASSWORD 提供）", "password" },
+    });
+    parser.process(app);
+
+    QTextStream out(stdout);
+    const int tellers = qMax(1, parser.value("tellers").toInt());
+    const int operations = qMax(1, parser.value("operations").toInt());
+    const QString account = parser.value("account");
+
+    QString password = parser.value("password");
+    if (password.isEmpty()) {
+        password = qEnvironmentVariable("BANKSYSTEM_DB_PASSWORD");
+    }
+
+    DatabaseManager& manager = DatabaseManager::instance();
+    if (!manager.connectToDatabase(parser.value("host"), parser.value("database"),
+                                   parser.value("user"), password)) {
+        out << "数据库连接失败" << Qt::endl;
+        return 2;
+    }
+    manager.setWriteCoalescing(true, parser.value("window-us").toInt(), parser.value("max-batch").toInt());
+
+    QMutex mutex;
+    QVector<qint64> latenciesUs;
+    int succeeded = 0;
+    int failed = 0;
+
+    QElapsedTimer clock;
+    clock.start();
+
+    QList<QThread*> threads;
+    for (int t = 0; t < tellers; ++t) {
+        threads.append(QThread::create([&]() {
+            QVector<qint64> local;
+            int ok = 0;
+            for (int i = 0; i < operations; ++i) {
+                QElapsedTimer timer;
+                timer.start();
+                const QFuture<PostingResult> future = (i % 2 == 0)
+                    ? manager.depositAsync(account, 0.01)
+                    : manager.withdrawAsync(account, 0.01);
+                if (future.result().success) ++ok;
+                local.append(timer.nsecsElapsed() / 1000);
+            }
+            QMutexLocker locker(&mutex);
+            latenciesUs += local;
+            succeeded += ok;
+            failed += operations - ok;
+        }));
+        threads.last()->start();
+    }
+    for (QThread* thread : threads) {
+        thread->wait();
+        delete thread;
+    }
+
+    const double seconds = qMax<qint64>(1, clock.elapsed()) / 1000.0;
+    out << QString("窗口 %1 us，每批最多 %2 笔，柜员 %3")
+               .arg(parser.value("window-us"), parser.value("max-batch")).arg(tellers) << Qt::endl;
+    out << QString("存取款 %1 笔（成功 %2，失败 %3），耗时 %4 s，吞吐 %5 笔/秒")
+               .arg(succeeded + failed).arg(succeeded).arg(failed)
+               .arg(seconds, 0, 'f', 2).arg((succeeded + failed) / seconds, 0, 'f', 1) << Qt::endl;
+    out << QString("延迟：p50 %1 ms，p95 %2 ms，p99 %3 ms")
+               .arg(percentile(latenciesUs, 0.50) / 1000.0, 0, 'f', 2)
+               .arg(percentile(latenciesUs, 0.95) / 1000.0, 0, 'f', 2)
+               .arg(percentile(latenciesUs, 0.99) / 1000.0, 0, 'f', 2) << Qt::endl;
+
+    manager.disconnect();   // 合并统计写入日志
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,159 @@
+// 交易记录筛选基准：对一组账户逐个执行各类筛选的第一页查询，统计首页耗时的分位数，
+// 并与 50 ms 的目标比较
+//
+//   historyfilter --host localhost --database banksystem --user root --accounts 200 --rounds 3
+//
+// 账户取账户列表的第一页（默认按开户时间倒序）。每类筛选先对全部账户预热一遍再计时，
+// 调用的是界面使用的 DatabaseManager::searchTransactionHistory，耗时包含结果解码。
+// 描述关键字分两种：--keyword 命中常见描述，--miss 不命中任何记录，后者要扫完该账户的全部在线流水，是最坏情况。
+// 结果取决于缓冲池是否容纳得下索引，冷启动与预热后的数字应分开报告。
+#include "databasemanager.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QVector>
+#include <algorithm>
+#include <functional>
+
+namespace {
+
+const int kPageSize = 50;       // 与界面的 kHistoryPageSize 相同
+const double kTargetMs = 50.0;
+
+struct Scenario
+{
+    QString name;
+    std::function<TransactionFilter()> filter;
+};
+
+double percentile(QVector<double> samples, double p)
+{
+    if (samples.isEmpty()) return 0.0;
+    std::sort(samples.begin(), samples.end());
+    const int index = qBound(0, int(p * (samples.size() - 1) + 0.5), samples.size() - 1);
+    return samples.at(index);
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("historyfilter");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("银行账户管理系统 - 交易记录筛选首页耗时基准");
+    parser.addHelpOption();
+    parser.addOptions({
+        { "accounts", "参与测试的账户数", "count", "200" },
+        { "rounds", "每个账户每类筛选的计时次数", "count", "3" },
+        { "days", "时间段筛选覆盖最近的天数", "days", "30" },
+        { "keyword", "命中的描述关键字", "text", "收入" },
+        { "miss", "不命中的描述关键字", "text", "不存在的描述关键字" },
+        { "host", "数据库服务器", "host", "localhost" },
+        { "database", "数据库名", "database", "banksystem" },
+        { "user", "数据库用户名", "user", "root" },
+        { "password", "数据库密码（也可通过环境变量 BANKSYSTEM_DB_PASSWORD 提供）", "password" },
+    });
+    parser.process(app);
+
+    QTextStream out(stdout);
+    const int accountCount = qBound(1, parser.value("accounts").toInt(), 1000);
+    const int rounds = qMax(1, parser.value("rounds").toInt());
+    const int days = qMax(1, parser.value("days").toInt());
+    const QString keyword = parser.value("keyword");
+    const QString miss = parser.value("miss");
+
+    QString password = parser.value("password");
+    if (password.isEmpty()) {
+        password = qEnvironmentVariable("BANKSYSTEM_DB_PASSWORD");
+    }
+
+    DatabaseManager& manager = DatabaseManager::instance();
+    if (!manager.connectToDatabase(parser.value("host"), parser.value("database"),
+                                   parser.value("user"), password)) {
+        out << "数据库连接失败" << Qt::endl;
+        return 2;
+    }
+
+    QStringList accounts;
+    for (const QVariantMap& row : manager.searchAccounts(AdminListFilter(), accountCount)) {
+        accounts << row.value("account_id").toString();
+    }
+    if (accounts.isEmpty()) {
+        out << "没有可用的账户" << Qt::endl;
+        manager.disconnect();
+        return 2;
+    }
+
+    const QDateTime now = QDateTime::currentDateTime();
+    const QVector<Scenario> scenarios = {
+        { "无筛选", []() { return TransactionFilter(); } },
+        { QString("最近 %1 天").arg(days), [&]() {
+              TransactionFilter filter;
+              filter.from = now.addDays(-days);
+              return filter;
+          } },
+        { "类型=转账", []() {
+              TransactionFilter filter;
+              filter.type = "转账";
+              return filter;
+          } },
+        { "金额 100~1000", []() {
+              TransactionFilter filter;
+              filter.minAmount = 100.0;
+              filter.maxAmount = 1000.0;
+              return filter;
+          } },
+        { "描述含“" + keyword + "”", [&]() {
+              TransactionFilter filter;
+              filter.descriptionContains = keyword;
+              return filter;
+          } },
+        { "描述含“" + miss + "”", [&]() {
+              TransactionFilter filter;
+              filter.descriptionContains = miss;
+              return filter;
+          } },
+    };
+
+    out << QString("账户 %1 个，每类筛选每个账户计时 %2 次，每页 %3 条").arg(accounts.size()).arg(rounds).arg(kPageSize)
+        << Qt::endl;
+
+    bool allWithinTarget = true;
+    for (const Scenario& scenario : scenarios) {
+        for (const QString& account : accounts) {
+            manager.searchTransactionHistory(account, scenario.filter(), kPageSize);
+        }
+
+        QVector<double> samples;
+        qint64 rows = 0;
+        QElapsedTimer clock;
+        for (int round = 0; round < rounds; ++round) {
+            for (const QString& account : accounts) {
+                const TransactionFilter filter = scenario.filter();
+                clock.start();
+                rows += manager.searchTransactionHistory(account, filter, kPageSize).size();
+                samples << clock.nsecsElapsed() / 1e6;
+            }
+        }
+
+        const double p95 = percentile(samples, 0.95);
+        allWithinTarget = allWithinTarget && p95 < kTargetMs;
+        out << QString("%1：p50 %2 ms，p95 %3 ms，p99 %4 ms，最大 %5 ms，平均每页 %6 条%7")
+                   .arg(scenario.name)
+                   .arg(percentile(samples, 0.50), 0, 'f', 2)
+                   .arg(p95, 0, 'f', 2)
+                   .arg(percentile(samples, 0.99), 0, 'f', 2)
+                   .arg(percentile(samples, 1.0), 0, 'f', 2)
+                   .arg(double(rows) / samples.size(), 0, 'f', 1)
+                   .arg(p95 < kTargetMs ? "" : "（超过目标）") << Qt::endl;
+    }
+
+    out << (allWithinTarget ? QString("全部筛选的 p95 低于 %1 ms").arg(kTargetMs)
+                            : QString("部分筛选的 p95 超过 %1 ms").arg(kTargetMs)) << Qt::endl;
+
+    manager.disconnect();
+    return allWithinTarget ? 0 : 1;
+}
@@ -0,0 +1,225 @@
+// 转账流水写放大基准：同样的转账分别按原来的两行（转账 + 收款）和单行复式分录写入，
+// 比较每笔转账的写入行数、redo 日志量、刷盘页数与表空间增长
+//
+//   journalwrites --host localhost --database banksystem --user root --transfers 20000
+//
+// 两种写法各写入一张用 CREATE TABLE ... LIKE transactions 建立的临时表（索引、分区与线上相同），
+// 结束后删除（--keep 保留）。redo 与刷盘页数取自全局状态，测量期间服务器上不应有其他写入。
+#include "journal.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QTextStream>
+#include <QHash>
+
+namespace {
+
+struct PhaseResult
+{
+    qint64 rows = 0;          // Innodb_rows_inserted 增量
+    qint64 redoBytes = 0;     // Innodb_os_log_written 增量
+    qint64 pagesWritten = 0;  // Innodb_pages_written 增量
+    qint64 tableBytes = 0;    // DATA_LENGTH + INDEX_LENGTH
+    qint64 elapsedMs = 0;
+};
+
+QHash<QString, qint64> globalStatus(QSqlDatabase& db)
+{
+    QHash<QString, qint64> status;
+    QSqlQuery query(db);
+    if (query.exec("SHOW GLOBAL STATUS WHERE Variable_name IN "
+                   "('Innodb_rows_inserted', 'Innodb_os_log_written', 'Innodb_pages_written')")) {
+        while (query.next()) status.insert(query.value(0).toString(), query.value(1).toLongLong());
+    }
+    return status;
+}
+
+qint64 tableBytes(QSqlDatabase& db, const QString& table)
+{
+    QSqlQuery query(db);
+    query.exec("ANALYZE TABLE " + table);
+    query.prepare("SELECT DATA_LENGTH + INDEX_LENGTH FROM information_schema.TABLES "
+                  "WHERE TABLE_SCHEMA = DATABASE() AND TABLE_NAME = ?");
+    query.addBindValue(table);
+    return query.exec() && query.next() ? query.value(0).toLongLong() : 0;
+}
+
+QVariant accountId(int index)
+{
+    return Schema::accountKey(QString("6214999%1").arg(index, 12, 10, QChar('0')));
+}
+
+// 写入 transfers 笔转账，每笔一个事务；legacy 为 true 时按原来的转账 + 收款两行写入
+bool runPhase(QSqlDatabase& db, const QString& table, bool legacy, int transfers, int accounts,
+              PhaseResult& result, QTextStream& out)
+{
+    QSqlQuery query(db);
+    if (!query.exec("DROP TABLE IF EXISTS " + table) || !query.exec("CREATE TABLE " + table + " LIKE transactions")) {
+        out << "建立临时表失败: " << query.lastError().text() << Qt::endl;
+        return false;
+    }
+
+    QSqlQuery debit(db);
+    debit.prepare("INSERT INTO " + table + " (account_id, transaction_type, amount, target_account, credit_account, "
+                  "description) VALUES (?, " + QString::number(Schema::Transfer) + ", ?, ?, ?, '转账支出')");
+    QSqlQuery credit(db);
+    credit.prepare("INSERT INTO " + table + " (account_id, transaction_type, amount, target_account, description) "
+                   "VALUES (?, " + QString::number(Schema::Credit) + ", ?, ?, '转账收入')");
+
+    QRandomGenerator random(20240601);   // 两种写法使用相同的转账序列
+    const QHash<QString, qint64> before = globalStatus(db);
+    QElapsedTimer clock;
+    clock.start();
+
+    for (int i = 0; i < transfers; ++i) {
+        const int from = random.bounded(accounts);
+        const int to = (from + 1 + random.bounded(accounts - 1)) % accounts;
+        const QString amount = QString("%1.%2").arg(random.bounded(1, 5000)).arg(random.bounded(100), 2, 10, QChar('0'));
+
+        if (!db.transaction()) return false;
+        debit.bindValue(0, accountId(from));
+        debit.bindValue(1, amount);
+        debit.bindValue(2, accountId(to));
+        debit.bindValue(3, legacy ? QVariant() : accountId(to));
+        bool ok = debit.exec();
+        if (ok && legacy) {
+            credit.bindValue(0, accountId(to));
+            credit.bindValue(1, amount);
+            credit.bindValue(2, accountId(from));
+            ok = credit.exec();
+        }
+        if (!ok) {
+            out << "写入失败: " << (legacy ? credit : debit).lastError().text() << Qt::endl;
+            db.rollback();
+            return false;
+        }
+        if (!db.commit()) return false;
+    }
+
+    result.elapsedMs = clock.elapsed();
+    const QHash<QString, qint64> after = globalStatus(db);
+    result.rows = after.value("Innodb_rows_inserted") - before.value("Innodb_rows_inserted");
+    result.redoBytes = after.value("Innodb_os_log_written") - before.value("Innodb_os_log_written");
+    result.pagesWritten = after.value("Innodb_pages_written") - before.value("Innodb_pages_written");
+    result.tableBytes = tableBytes(db, table);
+    return true;
+}
+
+// 两种写法读出的某账户流水应完全一致
+bool sameHistory(QSqlDatabase& db, const QString& legacyTable, const QString& journalTable, const QVariant& account)
+{
+    QSqlQuery legacy(db);
+    legacy.prepare("SELECT transaction_type, amount, target_account, description FROM " + legacyTable
+                   + " WHERE account_id = ? ORDER BY transaction_id");
+    legacy.addBindValue(account);
+
+    QSqlQuery journal(db);
+    journal.prepare("SELECT transaction_type, amount, target_account, description FROM ("
+                    "SELECT transaction_id, 0 AS leg, transaction_type, amount, target_account, description FROM "
+                    + journalTable + " t WHERE t.account_id = ? "
+                    "UNION ALL "
+                    "SELECT transaction_id, 1, " + QString::number(Schema::Credit) + ", amount, account_id, "
+                    + Journal::creditDescriptionSql("t")
+                    + " FROM " + journalTable + " t WHERE t.credit_account = ?) legs "
+                    "ORDER BY transaction_id, leg");
+    journal.addBindValue(account);
+    journal.addBindValue(account);
+
+    if (!legacy.exec() || !journal.exec()) return false;
+    for (;;) {
+        const bool a = legacy.next();
+        const bool b = journal.next();
+        if (a != b) return false;
+        if (!a) return true;
+        for (int i = 0; i < 4; ++i) {
+            if (legacy.value(i).toString() != journal.value(i).toString()) return false;
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("journalwrites");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("银行账户管理系统 - 转账流水写放大基准");
+    parser.addHelpOption();
+    parser.addOptions({
+        { "transfers", "转账笔数", "count", "20000" },
+        { "accounts", "参与转账的账户数", "count", "1000" },
+        { "keep", "保留临时表" },
+        { "host", "数据库服务器", "host", "localhost" },
+        { "database", "数据库名", "database", "banksystem" },
+        { "user", "数据库用户名", "user", "root" },
+        { "password", "数据库密码（也可通过环境变量 BANKSYSTEM_DB_PASSWORD 提供）", "password" },
+    });
+    parser.process(app);
+
+    QTextStream out(stdout);
+    const int transfers = qMax(1, parser.value("transfers").toInt());
+    const int accounts = qMax(2, parser.value("accounts").toInt());
+
+    QString password = parser.value("password");
+    if (password.isEmpty()) {
+        password = qEnvironmentVariable("BANKSYSTEM_DB_PASSWORD");
+    }
+
+    QSqlDatabase db = QSqlDatabase::addDatabase("QMYSQL", "journalwrites");
+    db.setHostName(parser.value("host"));
+    db.setDatabaseName(parser.value("database"));
+    db.setUserName(parser.value("user"));
+    db.setPassword(password);
+    if (!db.open()) {
+        out << "数据库连接失败: " << db.lastError().text() << Qt::endl;
+        return 2;
+    }
+
+    const QString legacyTable = "bench_transactions_legacy";
+    const QString journalTable = "bench_transactions_journal";
+
+    PhaseResult legacy;
+    PhaseResult journal;
+    if (!runPhase(db, legacyTable, true, transfers, accounts, legacy, out)
+        || !runPhase(db, journalTable, false, transfers, accounts, journal, out)) {
+        return 1;
+    }
+
+    auto report = [&out, transfers](const char* name, const PhaseResult& result) {
+        out << QString("%1：%2 行/笔，redo %3 B/笔，刷盘 %4 页，表空间 %5 B/笔，%6 笔/秒")
+                   .arg(name)
+                   .arg(double(result.rows) / transfers, 0, 'f', 2)
+                   .arg(double(result.redoBytes) / transfers, 0, 'f', 0)
+                   .arg(result.pagesWritten)
+                   .arg(double(result.tableBytes) / transfers, 0, 'f', 0)
+                   .arg(transfers * 1000.0 / qMax<qint64>(1, result.elapsedMs), 0, 'f', 0) << Qt::endl;
+    };
+    report("两行写法", legacy);
+    report("单行分录", journal);
+
+    auto ratio = [](qint64 after, qint64 before) { return before > 0 ? 100.0 * (before - after) / before : 0.0; };
+    out << QString("减少：行数 %1%，redo %2%，表空间 %3%")
+               .arg(ratio(journal.rows, legacy.rows), 0, 'f', 1)
+               .arg(ratio(journal.redoBytes, legacy.redoBytes), 0, 'f', 1)
+               .arg(ratio(journal.tableBytes, legacy.tableBytes), 0, 'f', 1) << Qt::endl;
+
+    int mismatched = 0;
+    for (int i = 0; i < qMin(accounts, 20); ++i) {
+        if (!sameHistory(db, legacyTable, journalTable, accountId(i))) ++mismatched;
+    }
+    out << (mismatched == 0 ? QString("流水核对：一致") : QString("流水核对：%1 个账户不一致").arg(mismatched))
+        << Qt::endl;
+
+    if (!parser.isSet("keep")) {
+        QSqlQuery query(db);
+        query.exec("DROP TABLE IF EXISTS " + legacyTable);
+        query.exec("DROP TABLE IF EXISTS " + journalTable);
+    }
+    return mismatched == 0 ? 0 : 1;
+}
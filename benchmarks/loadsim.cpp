@@ -0,0 +1,708 @@
+// 闭环负载模拟：大量虚拟客户各自“操作—思考—操作”，观察高峰时段的吞吐、延迟与错误构成
+//
+//   loadsim --host localhost --database banksystem --user root --customers 2000 --duration 120 \
+//           --ramp 0:100,60:2000 --mix login=5,balance=40,deposit=15,withdraw=15,transfer=15,history=10
+//   loadsim --backend sqlite --accounts 20000 --customers 5000 --think-ms 500
+//
+// 操作的账户按 Zipf 分布抽取（--zipf 为指数，0 表示均匀），少数热点账户承担大部分操作。
+// 所有请求经由同一条主连接依次执行（与界面相同），虚拟客户在思考结束时进入队列；
+// 延迟从客户准备好发起操作时算起，包含排队时间，因此负载超过容量时延迟随之上升而不会被低估。
+// --backend sqlite 使用内存中的 SQLite 替身（最小表结构，同样的六种操作），不需要 MySQL，
+// 用于检验模拟器本身与对比客户端开销；它不经过 DatabaseManager。
+#include "databasemanager.h"
+#include "passwordhasher.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QFile>
+#include <QThread>
+#include <QRandomGenerator>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QVector>
+#include <QHash>
+#include <QMap>
+#include <QPair>
+#include <QStringList>
+#include <QtMath>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <queue>
+#include <random>
+
+namespace {
+
+enum Operation { Login, Balance, Deposit, Withdraw, Transfer, History, OperationCount };
+
+const char* const kOperationNames[OperationCount] = {
+    "login", "balance", "deposit", "withdraw", "transfer", "history"
+};
+
+enum Outcome { Ok, Rejected, LimitExceeded, DatabaseError, OutcomeCount };
+
+const char* const kOutcomeNames[OutcomeCount] = { "成功", "业务拒绝", "超出限额", "数据库错误" };
+
+struct Account
+{
+    QString accountId;
+    QString username;
+};
+
+// 被测后端：六种操作，返回结果分类
+class Backend
+{
+public:
+    virtual ~Backend() = default;
+    virtual bool open(QTextStream& out) = 0;
+    virtual QVector<Account> accounts() = 0;
+    virtual Outcome login(const QString& username, const QString& password) = 0;
+    virtual Outcome balance(const QString& accountId) = 0;
+    virtual Outcome deposit(const QString& accountId, double amount) = 0;
+    virtual Outcome withdraw(const QString& accountId, double amount) = 0;
+    virtual Outcome transfer(const QString& from, const QString& to, double amount) = 0;
+    virtual Outcome history(const QString& accountId) = 0;
+    virtual void close() {}
+};
+
+// 经由 DatabaseManager 访问 MySQL
+class MySqlBackend : public Backend
+{
+public:
+    MySqlBackend(const QString& host, const QString& database, const QString& user, const QString& password)
+        : host(host), database(database), user(user), password(password), manager(DatabaseManager::instance())
+    {
+    }
+
+    bool open(QTextStream& out) override
+    {
+        if (!manager.connectToDatabase(host, database, user, password)) {
+            out << "数据库连接失败" << Qt::endl;
+            return false;
+        }
+        return true;
+    }
+
+    QVector<Account> accounts() override
+    {
+        // 按键集分页读取正常账户，避免一次性把整张 accounts 表读进内存
+        const int pageSize = 1000;
+        QVector<Account> result;
+        AdminListFilter filter;
+        filter.status = "正常";
+        for (;;) {
+            const QList<QVariantMap> page = manager.searchAccounts(filter, pageSize);
+            for (const QVariantMap& row : page)
+                result.append({ row.value("account_id").toString(), row.value("username").toString() });
+            if (page.size() < pageSize) break;
+            filter.cursorValue = page.last().value("created_at");
+            filter.cursorId = page.last().value("account_key");
+        }
+        return result;
+    }
+
+    Outcome login(const QString& username, const QString& loginPassword) override
+    {
+        return manager.authenticateUser(username, loginPassword) ? Ok : Rejected;
+    }
+
+    Outcome balance(const QString& accountId) override
+    {
+        manager.getBalance(accountId);
+        return Ok;
+    }
+
+    Outcome deposit(const QString& accountId, double amount) override
+    {
+        return writeOutcome(manager.deposit(accountId, amount));
+    }
+
+    Outcome withdraw(const QString& accountId, double amount) override
+    {
+        return writeOutcome(manager.withdraw(accountId, amount));
+    }
+
+    Outcome transfer(const QString& from, const QString& to, double amount) override
+    {
+        return writeOutcome(manager.transfer(from, to, amount));
+    }
+
+    Outcome history(const QString& accountId) override
+    {
+        TransactionFilter filter;
+        manager.searchTransactionHistory(accountId, filter, 50);
+        return Ok;
+    }
+
+    void close() override
+    {
+        manager.disconnect();
+    }
+
+private:
+    QString host, database, user, password;
+    DatabaseManager& manager;
+
+    Outcome writeOutcome(bool ok) const
+    {
+        if (ok) return Ok;
+        if (!manager.lastWriteError().isEmpty()) return DatabaseError;
+        if (!manager.lastLimitViolation().isEmpty()) return LimitExceeded;
+        return Rejected;
+    }
+};
+
+// 内存 SQLite 替身
+class SqliteBackend : public Backend
+{
+public:
+    SqliteBackend(int accountCount, const QString& loginPassword)
+        : accountCount(accountCount), loginPassword(loginPassword)
+    {
+    }
+
+    ~SqliteBackend() override
+    {
+        close();
+    }
+
+    bool open(QTextStream& out) override
+    {
+        db = QSqlDatabase::addDatabase("QSQLITE", "loadsim_sqlite");
+        db.setDatabaseName(":memory:");
+        if (!db.open()) {
+            out << "SQLite 打开失败: " << db.lastError().text() << Qt::endl;
+            return false;
+        }
+
+        QSqlQuery query(db);
+        const QStringList schema = {
+            "CREATE TABLE users (user_id INTEGER PRIMARY KEY, username TEXT UNIQUE, password TEXT)",
+            "CREATE TABLE accounts (account_id TEXT PRIMARY KEY, user_id INTEGER, "
+            "balance INTEGER NOT NULL, status TEXT NOT NULL DEFAULT '正常')",
+            "CREATE TABLE transactions (transaction_id INTEGER PRIMARY KEY AUTOINCREMENT, account_id TEXT, "
+            "transaction_type TEXT, amount INTEGER, target_account TEXT, credit_account TEXT, "
+            "transaction_time TEXT DEFAULT CURRENT_TIMESTAMP)",
+            "CREATE INDEX idx_transactions_account ON transactions (account_id, transaction_time)",
+            "CREATE INDEX idx_transactions_credit ON transactions (credit_account, transaction_time)",
+        };
+        for (const QString& sql : schema) {
+            if (!query.exec(sql)) {
+                out << "SQLite 建表失败: " << query.lastError().text() << Qt::endl;
+                return false;
+            }
+        }
+
+        // 所有用户共用一个口令散列，登录仍完整执行一次 scrypt 校验
+        const QString hash = PasswordHasher::hash(loginPassword);
+        const int userCount = qMax(1, accountCount / 2);
+        db.transaction();
+        query.prepare("INSERT INTO users (user_id, username, password) VALUES (?, ?, ?)");
+        for (int i = 0; i < userCount; ++i) {
+            query.bindValue(0, i + 1);
+            query.bindValue(1, QString("sim%1").arg(i + 1));
+            query.bindValue(2, hash);
+            query.exec();
+        }
+        query.prepare("INSERT INTO accounts (account_id, user_id, balance) VALUES (?, ?, ?)");
+        for (int i = 0; i < accountCount; ++i) {
+            query.bindValue(0, QString::number(622202000000000000LL + i));
+            query.bindValue(1, i % userCount + 1);
+            query.bindValue(2, qint64(100000) * 100);   // 每户 10 万元，以分为单位
+            query.exec();
+        }
+        db.commit();
+        out << QString("SQLite 替身：%1 个用户，%2 个账户").arg(userCount).arg(accountCount) << Qt::endl;
+        return true;
+    }
+
+    QVector<Account> accounts() override
+    {
+        QVector<Account> result;
+        QSqlQuery query(db);
+        query.exec("SELECT a.account_id, u.username FROM accounts a JOIN users u ON a.user_id = u.user_id");
+        while (query.next()) result.append({ query.value(0).toString(), query.value(1).toString() });
+        return result;
+    }
+
+    Outcome login(const QString& username, const QString& password) override
+    {
+        QSqlQuery query(db);
+        query.prepare("SELECT password FROM users WHERE username = ?");
+        query.addBindValue(username);
+        if (!query.exec()) return DatabaseError;
+        if (!query.next()) return Rejected;
+        return PasswordHasher::verify(password, query.value(0).toString()) ? Ok : Rejected;
+    }
+
+    Outcome balance(const QString& accountId) override
+    {
+        QSqlQuery query(db);
+        query.prepare("SELECT balance FROM accounts WHERE account_id = ?");
+        query.addBindValue(accountId);
+        if (!query.exec()) return DatabaseError;
+        return query.next() ? Ok : Rejected;
+    }
+
+    Outcome deposit(const QString& accountId, double amount) override
+    {
+        return post(accountId, QString(), qRound64(amount * 100), "存款");
+    }
+
+    Outcome withdraw(const QString& accountId, double amount) override
+    {
+        return post(accountId, QString(), qRound64(amount * 100), "取款");
+    }
+
+    Outcome transfer(const QString& from, const QString& to, double amount) override
+    {
+        return post(from, to, qRound64(amount * 100), "转账");
+    }
+
+    Outcome history(const QString& accountId) override
+    {
+        QSqlQuery query(db);
+        query.prepare("SELECT transaction_id, transaction_type, amount, transaction_time FROM transactions "
+                      "WHERE account_id = ? "
+                      "UNION ALL "
+                      "SELECT transaction_id, '收款', amount, transaction_time FROM transactions "
+                      "WHERE credit_account = ? "
+                      "ORDER BY transaction_time DESC, transaction_id DESC LIMIT 50");
+        query.addBindValue(accountId);
+        query.addBindValue(accountId);
+        if (!query.exec()) return DatabaseError;
+        while (query.next()) {}
+        return Ok;
+    }
+
+    void close() override
+    {
+        if (!db.isValid()) return;
+        db.close();
+        db = QSqlDatabase();
+        QSqlDatabase::removeDatabase("loadsim_sqlite");
+    }
+
+private:
+    int accountCount;
+    QString loginPassword;
+    QSqlDatabase db;
+
+    // 与 DatabaseManager 相同的步骤：扣减（带余额条件）、入账、写流水，一个事务
+    Outcome post(const QString& accountId, const QString& target, qint64 cents, const QString& type)
+    {
+        if (!db.transaction()) return DatabaseError;
+        QSqlQuery query(db);
+
+        const bool debit = type != "存款";
+        query.prepare(debit ? "UPDATE accounts SET balance = balance - ? WHERE account_id = ? AND balance >= ?"
+                            : "UPDATE accounts SET balance = balance + ? WHERE account_id = ?");
+        query.addBindValue(cents);
+        query.addBindValue(accountId);
+        if (debit) query.addBindValue(cents);
+        if (!query.exec()) {
+            db.rollback();
+            return DatabaseError;
+        }
+        if (query.numRowsAffected() != 1) {
+            db.rollback();
+            return Rejected;
+        }
+
+        if (!target.isEmpty()) {
+            query.prepare("UPDATE accounts SET balance = balance + ? WHERE account_id = ?");
+            query.addBindValue(cents);
+            query.addBindValue(target);
+            if (!query.exec()) {
+                db.rollback();
+                return DatabaseError;
+            }
+            if (query.numRowsAffected() != 1) {
+                db.rollback();
+                return Rejected;
+            }
+        }
+
+        // 转账只写一行，转入方的分录记在 credit_account
+        query.prepare("INSERT INTO transactions (account_id, transaction_type, amount, target_account, credit_account) "
+                      "VALUES (?, ?, ?, ?, ?)");
+        query.bindValue(0, accountId);
+        query.bindValue(1, type);
+        query.bindValue(2, cents);
+        query.bindValue(3, target.isEmpty() ? QVariant() : QVariant(target));
+        query.bindValue(4, target.isEmpty() ? QVariant() : QVariant(target));
+        if (!query.exec()) {
+            db.rollback();
+            return DatabaseError;
+        }
+        return db.commit() ? Ok : DatabaseError;
+    }
+};
+
+// Zipf 抽样：第 k 个（从 1 开始）被抽中的概率正比于 1 / k^s，按累积分布二分查找
+class ZipfSampler
+{
+public:
+    ZipfSampler(int n, double s)
+    {
+        cdf.resize(qMax(1, n));
+        double sum = 0.0;
+        for (int k = 0; k < cdf.size(); ++k) {
+            sum += s > 0.0 ? 1.0 / qPow(k + 1, s) : 1.0;
+            cdf[k] = sum;
+        }
+        for (double& value : cdf) value /= sum;
+    }
+
+    int sample(QRandomGenerator& random) const
+    {
+        const double u = random.generateDouble();
+        return int(std::lower_bound(cdf.constBegin(), cdf.constEnd(), u) - cdf.constBegin());
+    }
+
+    // 排名前 count 的账户占全部操作的比例
+    double share(int count) const
+    {
+        return count <= 0 ? 0.0 : cdf.at(qMin(count, cdf.size()) - 1);
+    }
+
+private:
+    QVector<double> cdf;
+};
+
+// 分段线性的活跃客户数，例如 0:100,60:2000 表示 60 秒内从 100 增加到 2000，之后保持
+class RampProfile
+{
+public:
+    bool parse(const QString& text, int customers)
+    {
+        points.clear();
+        if (text.isEmpty()) {
+            points.append(qMakePair(0.0, customers));
+            return true;
+        }
+        for (const QString& part : text.split(',', Qt::SkipEmptyParts)) {
+            const QStringList pair = part.split(':');
+            bool okTime = false, okCount = false;
+            if (pair.size() != 2) return false;
+            const double seconds = pair.at(0).toDouble(&okTime);
+            const int count = pair.at(1).toInt(&okCount);
+            if (!okTime || !okCount || seconds < 0 || count < 0) return false;
+            points.append(qMakePair(seconds, qMin(count, customers)));
+        }
+        std::sort(points.begin(), points.end());
+        return !points.isEmpty();
+    }
+
+    int target(double seconds) const
+    {
+        if (seconds <= points.first().first) return points.first().second;
+        for (int i = 1; i < points.size(); ++i) {
+            if (seconds < points.at(i).first) {
+                const auto& a = points.at(i - 1);
+                const auto& b = points.at(i);
+                const double t = (seconds - a.first) / (b.first - a.first);
+                return qRound(a.second + t * (b.second - a.second));
+            }
+        }
+        return points.last().second;
+    }
+
+private:
+    QVector<QPair<double, int>> points;
+};
+
+struct OperationStats
+{
+    QVector<qint64> latenciesUs;
+    qint64 outcomes[OutcomeCount] = {};
+
+    qint64 count() const { return latenciesUs.size(); }
+};
+
+qint64 percentile(QVector<qint64>& values, double p)
+{
+    if (values.isEmpty()) return 0;
+    std::sort(values.begin(), values.end());
+    const int index = qBound(0, int(p * (values.size() - 1) + 0.5), values.size() - 1);
+    return values[index];
+}
+
+QString formatMs(qint64 us)
+{
+    return QString::number(us / 1000.0, 'f', 1);
+}
+
+struct Mix
+{
+    double weights[OperationCount] = {};
+
+    bool parse(const QString& text)
+    {
+        double total = 0.0;
+        for (const QString& part : text.split(',', Qt::SkipEmptyParts)) {
+            const QStringList pair = part.split('=');
+            if (pair.size() != 2) return false;
+            int op = -1;
+            for (int i = 0; i < OperationCount; ++i) {
+                if (pair.at(0).trimmed() == kOperationNames[i]) op = i;
+            }
+            bool ok = false;
+            const double weight = pair.at(1).toDouble(&ok);
+            if (op < 0 || !ok || weight < 0) return false;
+            weights[op] = weight;
+            total += weight;
+        }
+        if (total <= 0.0) return false;
+        for (double& weight : weights) weight /= total;
+        return true;
+    }
+
+    Operation pick(QRandomGenerator& random) const
+    {
+        double u = random.generateDouble();
+        for (int i = 0; i < OperationCount; ++i) {
+            if (u < weights[i]) return Operation(i);
+            u -= weights[i];
+        }
+        return Balance;
+    }
+};
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("loadsim");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("银行账户管理系统 - 闭环负载模拟");
+    parser.addHelpOption();
+    parser.addOptions({
+        { "backend", "mysql 或 sqlite", "backend", "mysql" },
+        { "customers", "虚拟客户数", "count", "1000" },
+        { "duration", "运行秒数", "seconds", "60" },
+        { "ramp", "活跃客户数变化，秒:人数,...（默认一开始全部活跃）", "profile" },
+        { "mix", "操作比例", "mix", "login=5,balance=40,deposit=15,withdraw=15,transfer=15,history=10" },
+        { "zipf", "热点账户的 Zipf 指数，0 为均匀", "s", "1.1" },
+        { "think-ms", "平均思考时间（指数分布）", "ms", "1000" },
+        { "interval", "报告间隔秒数", "seconds", "5" },
+        { "csv", "按报告间隔写出时间序列", "file" },
+        { "seed", "随机数种子", "seed", "1" },
+        { "accounts", "SQLite 替身的账户数", "count", "10000" },
+        { "login-password", "虚拟客户的登录密码", "password", "123456" },
+        { "host", "数据库服务器", "host", "localhost" },
+        { "database", "数据库名", "database", "banksystem" },
+        { "user", "数据库用户名", "user", "root" },
+        { "password", "数据库密码（也可通过环境变量 BANKSYSTEM_DB_PASSWORD 提供）", "password" },
+    });
+    parser.process(app);
+
+    QTextStream out(stdout);
+    const int customers = qMax(1, parser.value("customers").toInt());
+    const double duration = qMax(1.0, parser.value("duration").toDouble());
+    const double thinkMs = qMax(0.0, parser.value("think-ms").toDouble());
+    const double interval = qMax(1.0, parser.value("interval").toDouble());
+    const QString loginPassword = parser.value("login-password");
+
+    Mix mix;
+    if (!mix.parse(parser.value("mix"))) {
+        out << "无法解析 --mix" << Qt::endl;
+        return 2;
+    }
+    RampProfile ramp;
+    if (!ramp.parse(parser.value("ramp"), customers)) {
+        out << "无法解析 --ramp" << Qt::endl;
+        return 2;
+    }
+
+    std::unique_ptr<Backend> backend;
+    if (parser.value("backend") == "sqlite") {
+        backend.reset(new SqliteBackend(qMax(2, parser.value("accounts").toInt()), loginPassword));
+    } else {
+        QString password = parser.value("password");
+        if (password.isEmpty()) password = qEnvironmentVariable("BANKSYSTEM_DB_PASSWORD");
+        backend.reset(new MySqlBackend(parser.value("host"), parser.value("database"),
+                                       parser.value("user"), password));
+    }
+    if (!backend->open(out)) return 2;
+
+    QRandomGenerator random(parser.value("seed").toUInt());
+    QVector<Account> accounts = backend->accounts();
+    if (accounts.size() < 2) {
+        out << "可用账户不足 2 个" << Qt::endl;
+        return 2;
+    }
+    // 热点随机分布在账户号空间中，而不是集中在最早开立的账户
+    std::shuffle(accounts.begin(), accounts.end(), std::mt19937(parser.value("seed").toUInt()));
+    const ZipfSampler zipf(accounts.size(), parser.value("zipf").toDouble());
+    out << QString("账户 %1 个，最热 1% 的账户承担 %2% 的操作")
+               .arg(accounts.size())
+               .arg(zipf.share(qMax(1, accounts.size() / 100)) * 100.0, 0, 'f', 1) << Qt::endl;
+
+    std::unique_ptr<QFile> csvFile;
+    std::unique_ptr<QTextStream> csv;
+    if (parser.isSet("csv")) {
+        csvFile.reset(new QFile(parser.value("csv")));
+        if (csvFile->open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+            csv.reset(new QTextStream(csvFile.get()));
+            *csv << "seconds,active,throughput";
+            for (int op = 0; op < OperationCount; ++op) {
+                *csv << ',' << kOperationNames[op] << "_p50_ms," << kOperationNames[op] << "_p99_ms";
+            }
+            *csv << ",errors\n";
+        }
+    }
+
+    // 每个虚拟客户下次准备好的时刻（微秒），最早的先执行
+    using Ready = QPair<qint64, int>;
+    std::priority_queue<Ready, std::vector<Ready>, std::greater<Ready>> ready;
+    QVector<bool> parked(customers, true);
+    int active = 0;
+
+    auto thinkUs = [&random, thinkMs]() {
+        return qint64(-thinkMs * 1000.0 * std::log(1.0 - random.generateDouble()));
+    };
+
+    OperationStats totals[OperationCount];
+    OperationStats window[OperationCount];
+
+    QElapsedTimer clock;
+    clock.start();
+    double nextReport = interval;
+
+    auto report = [&](double seconds) {
+        qint64 windowOps = 0, windowErrors = 0;
+        QStringList parts;
+        QStringList csvParts;
+        for (int op = 0; op < OperationCount; ++op) {
+            OperationStats& stats = window[op];
+            windowOps += stats.count();
+            windowErrors += stats.outcomes[DatabaseError];
+            const qint64 p50 = percentile(stats.latenciesUs, 0.50);
+            const qint64 p99 = percentile(stats.latenciesUs, 0.99);
+            if (stats.count() > 0) {
+                parts << QString("%1 p50 %2 p99 %3").arg(kOperationNames[op], formatMs(p50), formatMs(p99));
+            }
+            csvParts << formatMs(p50) << formatMs(p99);
+            stats = OperationStats();
+        }
+        const double throughput = windowOps / interval;
+        out << QString("[%1 s] 活跃 %2，%3 次/秒，数据库错误 %4 | %5")
+                   .arg(seconds, 0, 'f', 0).arg(active).arg(throughput, 0, 'f', 1)
+                   .arg(windowErrors).arg(parts.join("，")) << Qt::endl;
+        if (csv) {
+            *csv << QString::number(seconds, 'f', 0) << ',' << active << ','
+                 << QString::number(throughput, 'f', 1) << ',' << csvParts.join(',') << ',' << windowErrors << '\n';
+        }
+    };
+
+    for (;;) {
+        const qint64 nowUs = clock.nsecsElapsed() / 1000;
+        const double seconds = nowUs / 1e6;
+        if (seconds >= duration) break;
+
+        if (seconds >= nextReport) {
+            report(nextReport);
+            nextReport += interval;
+        }
+
+        // 按爬坡曲线唤醒客户；人数下降时，超出的客户在下次准备好时停下
+        const int target = ramp.target(seconds);
+        for (int i = 0; i < customers && active < target; ++i) {
+            if (!parked[i]) continue;
+            parked[i] = false;
+            ++active;
+            ready.push(qMakePair(nowUs + (thinkMs > 0 ? thinkUs() : 0), i));
+        }
+
+        if (ready.empty() || ready.top().first > nowUs) {
+            // 没有到期的客户：处理后台线程投递的事件后短暂等待
+            QCoreApplication::processEvents();
+            const qint64 waitUs = ready.empty() ? 1000 : qMin<qint64>(ready.top().first - nowUs, 1000);
+            QThread::usleep(quint64(qMax<qint64>(waitUs, 50)));
+            continue;
+        }
+
+        const Ready next = ready.top();
+        ready.pop();
+        const int customer = next.second;
+        if (active > target) {
+            parked[customer] = true;
+            --active;
+            continue;
+        }
+
+        const Operation op = mix.pick(random);
+        const Account& account = accounts.at(zipf.sample(random));
+        const double amount = 1 + random.bounded(200);
+
+        Outcome outcome = Ok;
+        switch (op) {
+        case Login:
+            outcome = backend->login(account.username, loginPassword);
+            break;
+        case Balance:
+            outcome = backend->balance(account.accountId);
+            break;
+        case Deposit:
+            outcome = backend->deposit(account.accountId, amount);
+            break;
+        case Withdraw:
+            outcome = backend->withdraw(account.accountId, amount);
+            break;
+        case Transfer: {
+            const Account* target = &accounts.at(zipf.sample(random));
+            if (target->accountId == account.accountId) target = &accounts.at(random.bounded(accounts.size()));
+            outcome = target->accountId == account.accountId
+                          ? Rejected
+                          : backend->transfer(account.accountId, target->accountId, amount);
+            break;
+        }
+        default:
+            outcome = backend->history(account.accountId);
+            break;
+        }
+
+        // 延迟从客户准备好时算起，包含排队时间
+        const qint64 doneUs = clock.nsecsElapsed() / 1000;
+        const qint64 latencyUs = doneUs - next.first;
+        for (OperationStats* stats : { &window[op], &totals[op] }) {
+            stats->latenciesUs.append(latencyUs);
+            ++stats->outcomes[outcome];
+        }
+        ready.push(qMakePair(doneUs + thinkUs(), customer));
+    }
+
+    const double elapsed = clock.nsecsElapsed() / 1e9;
+    out << Qt::endl << QString("总计（%1 s，最终活跃 %2）").arg(elapsed, 0, 'f', 1).arg(active) << Qt::endl;
+    qint64 allOps = 0;
+    qint64 allOutcomes[OutcomeCount] = {};
+    for (int op = 0; op < OperationCount; ++op) {
+        OperationStats& stats = totals[op];
+        if (stats.count() == 0) continue;
+        allOps += stats.count();
+        QStringList outcomes;
+        for (int o = 0; o < OutcomeCount; ++o) {
+            allOutcomes[o] += stats.outcomes[o];
+            if (stats.outcomes[o] > 0) outcomes << QString("%1 %2").arg(kOutcomeNames[o]).arg(stats.outcomes[o]);
+        }
+        out << QString("  %1：%2 次，p50 %3 ms，p95 %4 ms，p99 %5 ms，max %6 ms（%7）")
+                   .arg(kOperationNames[op]).arg(stats.count())
+                   .arg(formatMs(percentile(stats.latenciesUs, 0.50)))
+                   .arg(formatMs(percentile(stats.latenciesUs, 0.95)))
+                   .arg(formatMs(percentile(stats.latenciesUs, 0.99)))
+                   .arg(formatMs(percentile(stats.latenciesUs, 1.0)))
+                   .arg(outcomes.join("，")) << Qt::endl;
+    }
+    out << QString("  吞吐 %1 次/秒，数据库错误 %2，业务拒绝 %3，超出限额 %4")
+               .arg(allOps / elapsed, 0, 'f', 1)
+               .arg(allOutcomes[DatabaseError]).arg(allOutcomes[Rejected]).arg(allOutcomes[LimitExceeded])
+           << Qt::endl;
+
+    backend->close();
+    return allOutcomes[DatabaseError] == 0 ? 0 : 1;
+}
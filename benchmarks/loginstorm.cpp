@@ -0,0 +1,211 @@
+// 登录风暴基准：模拟换班时大量登录同时到达，测量持续登录吞吐与排队延迟
+//
+//   loginstorm --offline --logins 500 --workers 4
+//   loginstorm --host localhost --database banksystem --user root \
+//              --login-user zhangsan --login-password 123456 --logins 500 --rate 100
+//
+// --offline 只测散列线程池（不连数据库）；否则走 AuthService 完整登录流程。
+// --rate 为每秒提交的登录数，0 表示一次性全部提交。
+#include "authservice.h"
+#include "databasemanager.h"
+#include "passwordhasher.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QThreadPool>
+#include <QTimer>
+#include <QQueue>
+#include <QVector>
+#include <QMutex>
+#include <QThread>
+#include <algorithm>
+#include <functional>
+#include <memory>
+
+namespace {
+
+struct StormResult
+{
+    int succeeded = 0;
+    int failed = 0;
+    int peakPending = 0;
+    qint64 elapsedMs = 0;
+    QVector<qint64> latenciesMs;
+};
+
+qint64 percentile(QVector<qint64> values, double p)
+{
+    if (values.isEmpty()) return 0;
+    std::sort(values.begin(), values.end());
+    const int index = qBound(0, int(p * (values.size() - 1) + 0.5), values.size() - 1);
+    return values[index];
+}
+
+void printResult(QTextStream& out, const StormResult& result)
+{
+    const int total = result.succeeded + result.failed;
+    const double seconds = qMax<qint64>(1, result.elapsedMs) / 1000.0;
+    out << QString("登录 %1 次（成功 %2，失败 %3），耗时 %4 s")
+               .arg(total).arg(result.succeeded).arg(result.failed).arg(seconds, 0, 'f', 2) << Qt::endl;
+    out << QString("吞吐：%1 次/秒，最大排队 %2")
+               .arg(total / seconds, 0, 'f', 1).arg(result.peakPending) << Qt::endl;
+    out << QString("延迟：p50 %1 ms，p95 %2 ms，p99 %3 ms，max %4 ms")
+               .arg(percentile(result.latenciesMs, 0.50))
+               .arg(percentile(result.latenciesMs, 0.95))
+               .arg(percentile(result.latenciesMs, 0.99))
+               .arg(percentile(result.latenciesMs, 1.0)) << Qt::endl;
+}
+
+// 按速率调度提交，rate 为 0 时一次性提交
+void schedule(int logins, int rate, const std::function<void()>& submit)
+{
+    if (rate <= 0) {
+        for (int i = 0; i < logins; ++i) submit();
+        return;
+    }
+
+    QTimer* timer = new QTimer(QCoreApplication::instance());
+    timer->setInterval(qMax(1, 1000 / rate));
+    const int perTick = qMax(1, rate / 1000);
+    auto submitted = std::make_shared<int>(0);
+    QObject::connect(timer, &QTimer::timeout, [timer, logins, perTick, submit, submitted]() {
+        for (int i = 0; i < perTick && *submitted < logins; ++i, ++*submitted) submit();
+        if (*submitted >= logins) timer->deleteLater();
+    });
+    timer->start();
+}
+
+StormResult runOffline(QCoreApplication& app, int logins, int rate, int workers)
+{
+    const QString password = "storm-password";
+    const QString stored = PasswordHasher::hash(password);
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(workers);
+
+    StormResult result;
+    QMutex mutex;
+    QElapsedTimer clock;
+    clock.start();
+    int pending = 0;
+
+    schedule(logins, rate, [&]() {
+        const qint64 submittedAt = clock.elapsed();
+        {
+            QMutexLocker locker(&mutex);
+            result.peakPending = qMax(result.peakPending, ++pending);
+        }
+        pool.start([&, submittedAt]() {
+            const bool ok = PasswordHasher::verify(password, stored);
+            QMutexLocker locker(&mutex);
+            --pending;
+            ok ? ++result.succeeded : ++result.failed;
+            result.latenciesMs.append(clock.elapsed() - submittedAt);
+            if (result.succeeded + result.failed == logins) {
+                result.elapsedMs = clock.elapsed();
+                QMetaObject::invokeMethod(&app, &QCoreApplication::quit, Qt::QueuedConnection);
+            }
+        });
+    });
+
+    app.exec();
+    pool.waitForDone();
+    return result;
+}
+
+StormResult runAuthService(QCoreApplication& app, int logins, int rate,
+                           const QString& loginUser, const QString& loginPassword)
+{
+    AuthService& auth = AuthService::instance();
+
+    StormResult result;
+    QElapsedTimer clock;
+    clock.start();
+    // 同一用户的结果按提交顺序近似匹配
+    QQueue<qint64> submitted;
+
+    auto complete = [&](bool ok) {
+        ok ? ++result.succeeded : ++result.failed;
+        if (!submitted.isEmpty()) result.latenciesMs.append(clock.elapsed() - submitted.dequeue());
+        if (result.succeeded + result.failed == logins) {
+            result.elapsedMs = clock.elapsed();
+            app.quit();
+        }
+    };
+    QObject::connect(&auth, &AuthService::authenticated, [&](const QString&, const QString& token) {
+        auth.revoke(token);
+        complete(true);
+    });
+    QObject::connect(&auth, &AuthService::authenticationFailed, [&](const QString&, const QString&) {
+        complete(false);
+    });
+
+    schedule(logins, rate, [&]() {
+        submitted.enqueue(clock.elapsed());
+        auth.authenticate(loginUser, loginPassword);
+        result.peakPending = qMax(result.peakPending, auth.pendingLogins());
+    });
+
+    app.exec();
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("loginstorm");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("银行账户管理系统 - 登录风暴基准");
+    parser.addHelpOption();
+    parser.addOptions({
+        { "offline", "只测口令散列线程池，不连接数据库" },
+        { "logins", "登录次数", "count", "200" },
+        { "rate", "每秒提交的登录数，0 表示同时提交", "rate", "0" },
+        { "workers", "散列线程数", "count", QString::number(qMax(1, QThread::idealThreadCount() / 2)) },
+        { "host", "数据库服务器", "host", "localhost" },
+        { "database", "数据库名", "database", "banksystem" },
+        { "user", "数据库用户名", "user", "root" },
+        { "password", "数据库密码（也可通过环境变量 BANKSYSTEM_DB_PASSWORD 提供）", "password" },
+        { "login-user", "登录用户名", "name", "zhangsan" },
+        { "login-password", "登录密码", "password", "123456" },
+    });
+    parser.process(app);
+
+    QTextStream out(stdout);
+    const int logins = qMax(1, parser.value("logins").toInt());
+    const int rate = qMax(0, parser.value("rate").toInt());
+    const int workers = qMax(1, parser.value("workers").toInt());
+
+    out << QString("scrypt 参数：ln=%1 r=%2 p=%3，散列线程 %4")
+               .arg(PasswordHasher::defaultParameters().logN)
+               .arg(PasswordHasher::defaultParameters().r)
+               .arg(PasswordHasher::defaultParameters().p)
+               .arg(workers) << Qt::endl;
+
+    StormResult result;
+    if (parser.isSet("offline")) {
+        result = runOffline(app, logins, rate, workers);
+    } else {
+        QString password = parser.value("password");
+        if (password.isEmpty()) {
+            password = qEnvironmentVariable("BANKSYSTEM_DB_PASSWORD");
+        }
+        if (!DatabaseManager::instance().connectToDatabase(parser.value("host"), parser.value("database"),
+                                                           parser.value("user"), password)) {
+            out << "数据库连接失败" << Qt::endl;
+            return 2;
+        }
+        AuthService::instance().setMaxConcurrentHashes(workers);
+        AuthService::instance().setMaxPendingLogins(logins);
+        result = runAuthService(app, logins, rate,
+                                parser.value("login-user"), parser.value("login-password"));
+        DatabaseManager::instance().disconnect();
+    }
+
+    printResult(out, result);
+    return result.failed == 0 ? 0 : 1;
+}
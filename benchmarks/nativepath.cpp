@@ -0,0 +1,147 @@
+// 原生快速通道基准：同一账户上依次用 QtSql 与原生 MySQL 预编译语句执行查余额、存取款与转账，
+// 比较每次调用的耗时与调用线程（主线程）消耗的 CPU 时间
+//
+//   nativepath --host localhost --database banksystem --user root \
+//              --account 6222021234567890123 --target 6222029876543210987 --calls 5000
+//
+// 需要以 -DBANKSYSTEM_NATIVE_MYSQL=ON 构建，否则只测 QtSql。存取款交替、转账来回进行，两个账户的余额结束后不变；
+// 取款与转账次数可能受账户类型的限额约束（被拒绝的调用单独计数）。
+// CPU 时间只统计调用线程，等待服务器的时间不计入，差值即客户端绑定、编码与结果解码的开销。
+#include "databasemanager.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <functional>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+namespace {
+
+// 当前线程的 CPU 时间（用户态 + 内核态）
+qint64 threadCpuNs()
+{
+#ifdef Q_OS_WIN
+    FILETIME created, exited, kernel, user;
+    if (!GetThreadTimes(GetCurrentThread(), &created, &exited, &kernel, &user)) return 0;
+    auto ticks = [](const FILETIME& time) {
+        return (qint64(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+    };
+    return (ticks(kernel) + ticks(user)) * 100;
+#else
+    timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return qint64(now.tv_sec) * 1000000000 + now.tv_nsec;
+#endif
+}
+
+struct Measurement
+{
+    double wallUs = 0;
+    double cpuUs = 0;
+    int failed = 0;
+};
+
+Measurement measure(int calls, const std::function<bool(int)>& call)
+{
+    Measurement result;
+    QElapsedTimer clock;
+    clock.start();
+    const qint64 cpuBefore = threadCpuNs();
+    for (int i = 0; i < calls; ++i) {
+        if (!call(i)) ++result.failed;
+    }
+    result.cpuUs = (threadCpuNs() - cpuBefore) / 1000.0 / calls;
+    result.wallUs = clock.nsecsElapsed() / 1000.0 / calls;
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("nativepath");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("银行账户管理系统 - 原生快速通道基准");
+    parser.addHelpOption();
+    parser.addOptions({
+        { "calls", "每种操作的调用次数", "count", "5000" },
+        { "account", "测试账户", "account", "6222021234567890123" },
+        { "target", "转账对方账户", "account", "6222029876543210987" },
+        { "host", "数据库服务器", "host", "localhost" },
+        { "database", "数据库名", "database", "banksystem" },
+        { "user", "数据库用户名", "user", "root" },
+        { "password", "数据库密码（也可通过环境变量 BANKSYSTEM_DB_PASSWORD 提供）", "password" },
+    });
+    parser.process(app);
+
+    QTextStream out(stdout);
+    const int calls = qMax(2, parser.value("calls").toInt()) / 2 * 2;
+    const QString account = parser.value("account");
+    const QString target = parser.value("target");
+
+    QString password = parser.value("password");
+    if (password.isEmpty()) {
+        password = qEnvironmentVariable("BANKSYSTEM_DB_PASSWORD");
+    }
+
+    DatabaseManager& manager = DatabaseManager::instance();
+    if (!manager.connectToDatabase(parser.value("host"), parser.value("database"),
+                                   parser.value("user"), password)) {
+        out << "数据库连接失败" << Qt::endl;
+        return 2;
+    }
+
+    QList<bool> modes = { false };
+    manager.setNativeFastPath(true);
+    if (manager.nativeFastPathActive()) {
+        modes << true;
+    } else {
+        out << "原生快速通道不可用（未以 BANKSYSTEM_NATIVE_MYSQL 构建或连接不是 QMYSQL），只测 QtSql" << Qt::endl;
+    }
+
+    QHash<QString, Measurement> results[2];
+    const QStringList operations = { "查余额", "存取款", "转账" };
+    for (bool native : modes) {
+        manager.setNativeFastPath(native);
+
+        // 预热：语句预编译、缓冲分配与服务器端缓存
+        for (int i = 0; i < 50; ++i) manager.getBalance(account);
+
+        results[native].insert("查余额", measure(calls, [&](int) {
+            return manager.getBalance(account) > 0.0;
+        }));
+        results[native].insert("存取款", measure(calls, [&](int i) {
+            return i % 2 == 0 ? manager.deposit(account, 0.01) : manager.withdraw(account, 0.01);
+        }));
+        results[native].insert("转账", measure(calls, [&](int i) {
+            return i % 2 == 0 ? manager.transfer(account, target, 0.01) : manager.transfer(target, account, 0.01);
+        }));
+    }
+
+    for (const QString& operation : operations) {
+        for (bool native : modes) {
+            const Measurement& m = results[native].value(operation);
+            out << QString("%1（%2）：%3 us/次，调用线程 CPU %4 us/次，失败 %5")
+                       .arg(operation, native ? "原生" : "QtSql")
+                       .arg(m.wallUs, 0, 'f', 1)
+                       .arg(m.cpuUs, 0, 'f', 1)
+                       .arg(m.failed) << Qt::endl;
+        }
+        if (modes.size() == 2) {
+            const double before = results[0].value(operation).cpuUs;
+            const double after = results[1].value(operation).cpuUs;
+            out << QString("  客户端 CPU 减少 %1%").arg(before > 0 ? 100.0 * (before - after) / before : 0.0, 0, 'f', 1)
+                << Qt::endl;
+        }
+    }
+
+    manager.disconnect();
+    return 0;
+}
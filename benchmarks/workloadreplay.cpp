@@ -0,0 +1,472 @@
+// 负载重放：把 WorkloadTrace 抓取的调用在恢复出的数据库上重新执行，比较重放与抓取时的延迟和结果
+//
+//   workloadreplay --host localhost --database banksystem_restore --user root --speed 1 trace_*.bkwl
+//   workloadreplay --speed 4 --native off trace_4121_20261019_090000.bkwl
+//   workloadreplay --speed 0 trace_*.bkwl
+//
+// --speed 1 按原节奏，N 表示调用间隔缩短为 1/N，0 表示不等待、一个接一个尽快执行。
+// 每个抓取文件对应一个客户端进程：多个文件时为每个文件各启动一个子进程，按各自的开始时间对齐，
+// 保持原来的并发；同一文件内主线程的调用依次执行，异步筛选查询提交后不等待结果，与抓取时一致。
+// 数据库应恢复到抓取开始时的状态，否则余额与行数对不上（报告中的“结果不符”）；
+// 幂等键照原样重放，恢复点晚于抓取开始时会直接返回首次执行的结果。
+// --native、--coalesce 切换原生快速通道与写合并，用同一份抓取比较改动前后的表现。
+#include "databasemanager.h"
+#include "workloadtrace.h"
+#include "money.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QTimer>
+#include <QThread>
+#include <QProcess>
+#include <QProcessEnvironment>
+#include <QLoggingCategory>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QMap>
+#include <QVector>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+namespace {
+
+// 延迟直方图：每个 2 的幂分 8 档（约 9% 的精度），可跨进程合并
+struct Histogram
+{
+    QMap<int, qint64> buckets;
+    qint64 count = 0;
+
+    void add(qint64 us)
+    {
+        buckets[int(std::lround(8.0 * std::log2(double(qMax<qint64>(1, us)))))] += 1;
+        ++count;
+    }
+
+    void merge(const Histogram& other)
+    {
+        for (auto it = other.buckets.cbegin(); it != other.buckets.cend(); ++it) buckets[it.key()] += it.value();
+        count += other.count;
+    }
+
+    double percentile(double p) const
+    {
+        if (count == 0) return 0.0;
+        const qint64 rank = qMax<qint64>(1, qint64(std::ceil(p * count)));
+        qint64 seen = 0;
+        for (auto it = buckets.cbegin(); it != buckets.cend(); ++it) {
+            seen += it.value();
+            if (seen >= rank) return std::exp2(it.key() / 8.0);
+        }
+        return std::exp2(buckets.lastKey() / 8.0);
+    }
+
+    QJsonObject toJson() const
+    {
+        QJsonObject object;
+        for (auto it = buckets.cbegin(); it != buckets.cend(); ++it) {
+            object.insert(QString::number(it.key()), it.value());
+        }
+        return object;
+    }
+
+    static Histogram fromJson(const QJsonObject& object)
+    {
+        Histogram histogram;
+        for (auto it = object.begin(); it != object.end(); ++it) {
+            const qint64 n = it.value().toVariant().toLongLong();
+            histogram.buckets[it.key().toInt()] += n;
+            histogram.count += n;
+        }
+        return histogram;
+    }
+};
+
+struct OperationStats
+{
+    Histogram captured;
+    Histogram replayed;
+    qint64 mismatches = 0;
+};
+
+struct Report
+{
+    QMap<QString, OperationStats> operations;
+    qint64 events = 0;
+    qint64 lagTotalUs = 0;     // 实际开始晚于计划开始的累计时间
+    qint64 lagMaxUs = 0;
+    qint64 elapsedMs = 0;
+    qint64 capturedSpanMs = 0;
+
+    QJsonObject toJson() const
+    {
+        QJsonObject ops;
+        for (auto it = operations.cbegin(); it != operations.cend(); ++it) {
+            ops.insert(it.key(), QJsonObject{ { "captured", it.value().captured.toJson() },
+                                              { "replayed", it.value().replayed.toJson() },
+                                              { "mismatches", it.value().mismatches } });
+        }
+        return { { "operations", ops }, { "events", events }, { "lagTotalUs", lagTotalUs },
+                 { "lagMaxUs", lagMaxUs }, { "elapsedMs", elapsedMs }, { "capturedSpanMs", capturedSpanMs } };
+    }
+
+    void merge(const QJsonObject& object)
+    {
+        const QJsonObject ops = object.value("operations").toObject();
+        for (auto it = ops.begin(); it != ops.end(); ++it) {
+            const QJsonObject op = it.value().toObject();
+            OperationStats& stats = operations[it.key()];
+            stats.captured.merge(Histogram::fromJson(op.value("captured").toObject()));
+            stats.replayed.merge(Histogram::fromJson(op.value("replayed").toObject()));
+            stats.mismatches += op.value("mismatches").toVariant().toLongLong();
+        }
+        events += object.value("events").toVariant().toLongLong();
+        lagTotalUs += object.value("lagTotalUs").toVariant().toLongLong();
+        lagMaxUs = qMax(lagMaxUs, object.value("lagMaxUs").toVariant().toLongLong());
+        elapsedMs = qMax(elapsedMs, object.value("elapsedMs").toVariant().toLongLong());
+        capturedSpanMs = qMax(capturedSpanMs, object.value("capturedSpanMs").toVariant().toLongLong());
+    }
+
+    void print(QTextStream& out) const
+    {
+        out << QString("重放 %1 次调用，耗时 %2 s（抓取时跨度 %3 s），平均滞后 %4 ms，最大滞后 %5 ms")
+                   .arg(events)
+                   .arg(elapsedMs / 1000.0, 0, 'f', 1)
+                   .arg(capturedSpanMs / 1000.0, 0, 'f', 1)
+                   .arg(events > 0 ? lagTotalUs / 1000.0 / events : 0.0, 0, 'f', 2)
+                   .arg(lagMaxUs / 1000.0, 0, 'f', 1) << Qt::endl;
+        out << QString("%1 %2 %3 %4 %5 %6 %7")
+                   .arg("操作", -14).arg("次数", 8).arg("抓取 p50", 10).arg("重放 p50", 10)
+                   .arg("抓取 p99", 10).arg("重放 p99", 10).arg("结果不符", 8) << Qt::endl;
+        for (auto it = operations.cbegin(); it != operations.cend(); ++it) {
+            const OperationStats& stats = it.value();
+            out << QString("%1 %2 %3 %4 %5 %6 %7")
+                       .arg(it.key(), -14)
+                       .arg(stats.replayed.count, 8)
+                       .arg(stats.captured.percentile(0.50) / 1000.0, 10, 'f', 2)
+                       .arg(stats.replayed.percentile(0.50) / 1000.0, 10, 'f', 2)
+                       .arg(stats.captured.percentile(0.99) / 1000.0, 10, 'f', 2)
+                       .arg(stats.replayed.percentile(0.99) / 1000.0, 10, 'f', 2)
+                       .arg(stats.mismatches, 8) << Qt::endl;
+        }
+        out << "（延迟单位 ms）" << Qt::endl;
+    }
+};
+
+// 与抓取时的结果比较：写操作与凭据查询比较成败，余额比较金额，查询比较行数
+bool sameResult(WorkloadTrace::Operation operation, qint64 captured, qint64 replayed)
+{
+    switch (operation) {
+    case WorkloadTrace::Credentials:
+    case WorkloadTrace::BalanceAndType:
+    case WorkloadTrace::Deposit:
+    case WorkloadTrace::Withdraw:
+    case WorkloadTrace::Transfer:
+        return (captured > 0) == (replayed > 0);
+    default:
+        return captured == replayed;
+    }
+}
+
+// 在本进程中按计划时间依次发起一个抓取文件中的调用
+class Replayer : public QObject
+{
+public:
+    Replayer(const QVector<WorkloadTrace::Event>& events, double speed, qint64 delayMs)
+        : events(events), speed(speed), delayMs(delayMs), manager(DatabaseManager::instance())
+    {
+    }
+
+    void start()
+    {
+        clock.start();
+        if (!events.isEmpty()) {
+            report.capturedSpanMs = (events.last().startUs + events.last().durationUs - events.first().startUs) / 1000;
+        }
+        scheduleNext();
+    }
+
+    const Report& result() const { return report; }
+
+private:
+    QVector<WorkloadTrace::Event> events;
+    double speed;
+    qint64 delayMs;
+    DatabaseManager& manager;
+    QElapsedTimer clock;
+    Report report;
+    int next = 0;
+    int outstanding = 0;
+
+    // 相对第一条调用的计划开始时间
+    qint64 plannedUs(const WorkloadTrace::Event& event) const
+    {
+        if (speed <= 0) return delayMs * 1000;
+        return delayMs * 1000 + qint64((event.startUs - events.first().startUs) / speed);
+    }
+
+    void scheduleNext()
+    {
+        if (next >= events.size()) {
+            if (outstanding == 0) finish();
+            return;
+        }
+        const qint64 waitUs = plannedUs(events.at(next)) - clock.nsecsElapsed() / 1000;
+        QTimer::singleShot(int(qMax<qint64>(0, waitUs / 1000)), Qt::PreciseTimer, this, [this]() {
+            dispatch(events.at(next++));
+            scheduleNext();
+        });
+    }
+
+    void dispatch(const WorkloadTrace::Event& event)
+    {
+        const qint64 startedUs = clock.nsecsElapsed() / 1000;
+        const qint64 lagUs = qMax<qint64>(0, startedUs - plannedUs(event));
+        report.lagTotalUs += lagUs;
+        report.lagMaxUs = qMax(report.lagMaxUs, lagUs);
+        ++report.events;
+
+        const QString name = WorkloadTrace::operationName(event.operation);
+        OperationStats& stats = report.operations[name];
+        stats.captured.add(event.durationUs);
+
+        if (event.operation == WorkloadTrace::SearchAsync) {
+            QString accountId;
+            TransactionFilter filter;
+            int limit = 0;
+            WorkloadTrace::parseFilterArguments(event.arguments, accountId, filter, limit);
+            ++outstanding;
+            const qint64 captured = event.result;
+            manager.searchTransactionHistoryAsync(accountId, filter, limit, this,
+                [this, name, captured, startedUs](const QList<QVariantMap>& rows) {
+                    OperationStats& stats = report.operations[name];
+                    stats.replayed.add(clock.nsecsElapsed() / 1000 - startedUs);
+                    if (captured != rows.size()) ++stats.mismatches;
+                    if (--outstanding == 0 && next >= events.size()) finish();
+                });
+            return;
+        }
+
+        const qint64 result = execute(event);
+        stats.replayed.add(clock.nsecsElapsed() / 1000 - startedUs);
+        if (!sameResult(event.operation, event.result, result)) ++stats.mismatches;
+    }
+
+    qint64 execute(const WorkloadTrace::Event& event)
+    {
+        const QStringList& args = event.arguments;
+        auto arg = [&args](int i) { return i < args.size() ? args.at(i) : QString(); };
+
+        switch (event.operation) {
+        case WorkloadTrace::Credentials: {
+            int userId = -1;
+            QString hash, role;
+            return manager.getUserCredentials(arg(0), userId, hash, role) ? 1 : 0;
+        }
+        case WorkloadTrace::Balance:
+            return Money::toCents(manager.getBalance(arg(0)));
+        case WorkloadTrace::BalanceAndType: {
+            double balance = 0.0;
+            QString type;
+            return manager.getBalanceAndType(arg(0), balance, type) ? 1 : 0;
+        }
+        case WorkloadTrace::Deposit:
+            return manager.deposit(arg(0), arg(1).toDouble(), arg(2)) ? 1 : 0;
+        case WorkloadTrace::Withdraw:
+            return manager.withdraw(arg(0), arg(1).toDouble(), arg(2)) ? 1 : 0;
+        case WorkloadTrace::Transfer:
+            return manager.transfer(arg(0), arg(1), arg(2).toDouble(), arg(3)) ? 1 : 0;
+        case WorkloadTrace::History:
+            return manager.getTransactionHistory(arg(0), WorkloadTrace::parseTime(arg(1)),
+                                                 WorkloadTrace::parseTime(arg(2))).size();
+        case WorkloadTrace::Search: {
+            QString accountId;
+            TransactionFilter filter;
+            int limit = 0;
+            WorkloadTrace::parseFilterArguments(args, accountId, filter, limit);
+            return manager.searchTransactionHistory(accountId, filter, limit).size();
+        }
+        case WorkloadTrace::UserAccounts:
+            return manager.getUserAccounts(arg(0)).size();
+        default:
+            return 0;
+        }
+    }
+
+    void finish()
+    {
+        report.elapsedMs = clock.elapsed();
+        QCoreApplication::quit();
+    }
+};
+
+// 单个文件在本进程重放；startAt 为各进程共同的起点（自纪元起的毫秒数）
+int replayFile(QCoreApplication& app, const QCommandLineParser& parser, const QString& path, bool json)
+{
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    WorkloadTrace::Header header;
+    QVector<WorkloadTrace::Event> events;
+    if (!WorkloadTrace::read(path, header, events)) {
+        err << "读取抓取文件失败: " << path << Qt::endl;
+        return 1;
+    }
+
+    QString password = parser.value("password");
+    if (password.isEmpty()) {
+        password = qEnvironmentVariable("BANKSYSTEM_DB_PASSWORD");
+    }
+
+    DatabaseManager& manager = DatabaseManager::instance();
+    if (parser.value("coalesce") == "on") manager.setWriteCoalescing(true);
+    if (!manager.connectToDatabase(parser.value("host"), parser.value("database"),
+                                   parser.value("user"), password)) {
+        err << "数据库连接失败" << Qt::endl;
+        return 2;
+    }
+    manager.setNativeFastPath(parser.value("native") != "off");
+
+    if (!json) {
+        out << QString("%1：%2 次调用，抓取于 %3（%4，进程 %5）")
+                   .arg(path)
+                   .arg(events.size())
+                   .arg(header.startedAt.toString("yyyy-MM-dd HH:mm:ss"), header.host)
+                   .arg(header.processId) << Qt::endl;
+    }
+
+    // 连接建好后等到共同起点，各进程的计划时间以此为零点
+    const qint64 startAt = parser.value("start-at").toLongLong();
+    if (startAt > 0) {
+        QThread::msleep(qMax<qint64>(0, startAt - QDateTime::currentMSecsSinceEpoch()));
+    }
+
+    Replayer replayer(events, parser.value("speed").toDouble(), parser.value("delay-ms").toLongLong());
+    QTimer::singleShot(0, &replayer, [&replayer]() { replayer.start(); });
+    app.exec();
+    manager.disconnect();
+
+    if (json) {
+        out << QJsonDocument(replayer.result().toJson()).toJson(QJsonDocument::Compact) << Qt::endl;
+    } else {
+        replayer.result().print(out);
+    }
+    return 0;
+}
+
+// 多个文件：每个文件一个子进程，按抓取开始时间的先后错开
+int replayProcesses(const QCommandLineParser& parser, const QStringList& paths)
+{
+    QTextStream out(stdout);
+
+    QVector<QDateTime> firstCall;
+    QDateTime earliest;
+    for (const QString& path : paths) {
+        WorkloadTrace::Header header;
+        QVector<WorkloadTrace::Event> events;
+        if (!WorkloadTrace::read(path, header, events)) {
+            out << "读取抓取文件失败: " << path << Qt::endl;
+            return 1;
+        }
+        out << QString("%1：%2 次调用，抓取于 %3（%4，进程 %5）")
+                   .arg(path)
+                   .arg(events.size())
+                   .arg(header.startedAt.toString("yyyy-MM-dd HH:mm:ss"), header.host)
+                   .arg(header.processId) << Qt::endl;
+        // 以第一次调用的时间对齐，抓取开始后空闲的时间不重放
+        const QDateTime first = header.startedAt.addMSecs(events.isEmpty() ? 0 : events.first().startUs / 1000);
+        firstCall.append(first);
+        if (!earliest.isValid() || first < earliest) earliest = first;
+    }
+
+    const double speed = parser.value("speed").toDouble();
+    const qint64 startAt = QDateTime::currentMSecsSinceEpoch() + parser.value("connect-ms").toLongLong();
+    QStringList common = { "--child", "--start-at", QString::number(startAt), "--speed", parser.value("speed"),
+                           "--native", parser.value("native"), "--coalesce", parser.value("coalesce"),
+                           "--host", parser.value("host"), "--database", parser.value("database"),
+                           "--user", parser.value("user") };
+    if (parser.isSet("verbose")) common << "--verbose";
+    // 口令经环境变量传给子进程，不出现在命令行里
+    QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+    if (parser.isSet("password")) environment.insert("BANKSYSTEM_DB_PASSWORD", parser.value("password"));
+
+    std::vector<std::unique_ptr<QProcess>> children;
+    for (int i = 0; i < paths.size(); ++i) {
+        const qint64 offsetMs = speed > 0 ? qint64(earliest.msecsTo(firstCall.at(i)) / speed) : 0;
+        auto child = std::make_unique<QProcess>();
+        child->setProcessChannelMode(QProcess::ForwardedErrorChannel);
+        child->setProcessEnvironment(environment);
+        child->start(QCoreApplication::applicationFilePath(),
+                     QStringList(common) << "--delay-ms" << QString::number(offsetMs) << paths.at(i));
+        children.push_back(std::move(child));
+    }
+
+    Report report;
+    int failures = 0;
+    for (auto& child : children) {
+        child->waitForFinished(-1);
+        const QList<QByteArray> lines = child->readAllStandardOutput().trimmed().split('\n');
+        const QJsonDocument document = QJsonDocument::fromJson(lines.last());
+        if (child->exitCode() != 0 || !document.isObject()) {
+            ++failures;
+            continue;
+        }
+        report.merge(document.object());
+    }
+
+    report.print(out);
+    if (failures > 0) {
+        out << QString("%1 个子进程失败").arg(failures) << Qt::endl;
+        return 1;
+    }
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("workloadreplay");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("银行账户管理系统 - 负载重放");
+    parser.addHelpOption();
+    parser.addPositionalArgument("traces", "WorkloadTrace 抓取文件（.bkwl），每个文件一个客户端进程");
+    parser.addOptions({
+        { "speed", "重放倍速，1 为原节奏，0 为不等待尽快执行", "factor", "1" },
+        { "native", "原生快速通道 on/off", "on|off", "on" },
+        { "coalesce", "写合并 on/off", "on|off", "off" },
+        { "connect-ms", "多进程重放时留给子进程建立连接的时间", "milliseconds", "3000" },
+        { "verbose", "保留 DatabaseManager 的调试输出" },
+        { "host", "数据库服务器", "host", "localhost" },
+        { "database", "数据库名", "database", "banksystem" },
+        { "user", "数据库用户名", "user", "root" },
+        { "password", "数据库密码（也可通过环境变量 BANKSYSTEM_DB_PASSWORD 提供）", "password" },
+    });
+    // 多进程重放时父进程传给子进程的内部选项
+    QCommandLineOption child("child");
+    QCommandLineOption startAt("start-at", QString(), "epochMs", "0");
+    QCommandLineOption delay("delay-ms", QString(), "milliseconds", "0");
+    for (QCommandLineOption* option : { &child, &startAt, &delay }) {
+        option->setFlags(QCommandLineOption::HiddenFromHelp);
+        parser.addOption(*option);
+    }
+    parser.process(app);
+
+    // 每次调用都有调试输出，重放大文件时会淹没报告
+    if (!parser.isSet("verbose")) {
+        QLoggingCategory::setFilterRules("default.debug=false");
+    }
+
+    const QStringList paths = parser.positionalArguments();
+    if (paths.isEmpty()) {
+        parser.showHelp(1);
+    }
+    if (paths.size() == 1 || parser.isSet(child)) {
+        return replayFile(app, parser, paths.first(), parser.isSet(child));
+    }
+    return replayProcesses(parser, paths);
+}
@@ -0,0 +1,621 @@
+#include "columnstore.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QStandardPaths>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QThread>
+#include <QMap>
+#include <QPair>
+#include <QMutexLocker>
+#include <QtEndian>
+#include <QDebug>
+#include <algorithm>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define COLUMNSTORE_SSE2
+#endif
+
+namespace {
+const quint32 kSegmentMagic = 0x424B434C;   // "BKCL"
+const quint32 kSegmentVersion = 1;
+const quint32 kNoAccount = 0xFFFFFFFFu;
+const qint64 kSecsPerDay = 86400;
+
+// 金额分档的下界（分）：1 元、10 元……1000 万元
+const qint64 kBucketBounds[] = { 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000 };
+const int kBucketCount = int(sizeof(kBucketBounds) / sizeof(kBucketBounds[0])) + 1;
+
+// 每个段一个扫描任务
+class ScanTask : public QRunnable
+{
+public:
+    ScanTask(std::function<void()> work) : work(std::move(work)) {}
+    void run() override { work(); }
+
+private:
+    std::function<void()> work;
+};
+
+template <typename T>
+QByteArray packColumn(const QVector<T>& values)
+{
+    QByteArray raw(values.size() * int(sizeof(T)), Qt::Uninitialized);
+    qToLittleEndian<T>(values.constData(), values.size(), raw.data());
+    return qCompress(raw);
+}
+
+template <typename T>
+bool unpackColumn(const QByteArray& compressed, int rows, QVector<T>& values)
+{
+    const QByteArray raw = qUncompress(compressed);
+    if (raw.size() != rows * int(sizeof(T))) return false;
+    values.resize(rows);
+    qFromLittleEndian<T>(raw.constData(), rows, values.data());
+    return true;
+}
+
+qint64 floorDiv(qint64 value, qint64 divisor)
+{
+    return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+}
+
+QString segmentFileName(qint64 firstId)
+{
+    return QString("postings_%1.bkcol").arg(firstId, 12, 10, QChar('0'));
+}
+
+// lo <= t < hi 的行掩码置 1，其余置 0
+void maskTimeRange(const qint32* t, int n, qint32 lo, qint32 hi, quint8* mask)
+{
+    int i = 0;
+#ifdef COLUMNSTORE_SSE2
+    const __m128i low = _mm_set1_epi32(lo - 1);   // lo >= 0，减一不会溢出
+    const __m128i high = _mm_set1_epi32(hi);
+    const __m128i one = _mm_set1_epi8(1);
+    for (; i + 16 <= n; i += 16) {
+        __m128i m[4];
+        for (int k = 0; k < 4; ++k) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(t + i + 4 * k));
+            m[k] = _mm_and_si128(_mm_cmpgt_epi32(v, low), _mm_cmplt_epi32(v, high));
+        }
+        // 四组 32 位比较结果（0 / -1）饱和压缩为 16 个字节
+        const __m128i packed = _mm_packs_epi16(_mm_packs_epi32(m[0], m[1]), _mm_packs_epi32(m[2], m[3]));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(mask + i), _mm_and_si128(packed, one));
+    }
+#endif
+    for (; i < n; ++i) mask[i] = quint8((t[i] >= lo) & (t[i] < hi));
+}
+
+// 掩码与 codes[i] == code 相与
+void maskEquals(const quint8* codes, int n, quint8 code, quint8* mask)
+{
+    int i = 0;
+#ifdef COLUMNSTORE_SSE2
+    const __m128i want = _mm_set1_epi8(char(code));
+    for (; i + 16 <= n; i += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(codes + i));
+        const __m128i m = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(mask + i), _mm_and_si128(m, _mm_cmpeq_epi8(v, want)));
+    }
+#endif
+    for (; i < n; ++i) mask[i] &= quint8(codes[i] == code);
+}
+
+// SSE2 没有 64 位比较，保持无分支写法由编译器向量化
+void maskAmountRange(const qint64* amounts, int n, qint64 lo, qint64 hi, quint8* mask)
+{
+    for (int i = 0; i < n; ++i) mask[i] &= quint8((amounts[i] >= lo) & (amounts[i] <= hi));
+}
+}
+
+bool ColumnSegmentBuilder::add(qint64 transactionId, qint64 timeSecs, const QString& type, qint64 amountCents,
+                               const QString& accountId, const QString& targetAccount)
+{
+    if (!ids.isEmpty() && transactionId <= ids.last()) return false;
+
+    auto typeIt = typeIndex.find(type);
+    if (typeIt == typeIndex.end()) {
+        if (types.size() > 255) return false;
+        typeIt = typeIndex.insert(type, quint8(types.size()));
+        types.append(type);
+    }
+
+    auto code = [this](const QString& account) {
+        if (account.isEmpty()) return kNoAccount;
+        auto it = accountIndex.find(account);
+        if (it == accountIndex.end()) {
+            it = accountIndex.insert(account, quint32(accounts.size()));
+            accounts.append(account);
+        }
+        return it.value();
+    };
+
+    ids.append(transactionId);
+    times.append(timeSecs);
+    typeCodes.append(typeIt.value());
+    amounts.append(amountCents);
+    accountCodes.append(code(accountId));
+    targetCodes.append(code(targetAccount));
+    return true;
+}
+
+void ColumnSegmentBuilder::clear()
+{
+    ids.clear();
+    times.clear();
+    typeCodes.clear();
+    amounts.clear();
+    accountCodes.clear();
+    targetCodes.clear();
+    types.clear();
+    accounts.clear();
+    typeIndex.clear();
+    accountIndex.clear();
+}
+
+ColumnStore::ColumnStore(const QString& directory)
+    : dir(directory.isEmpty() ? QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/analytics"
+                              : directory)
+    , threads(QThread::idealThreadCount())
+    , cache(512 * 1024)
+{
+}
+
+QString ColumnStore::directory() const
+{
+    return dir;
+}
+
+void ColumnStore::setThreadCount(int count)
+{
+    threads = qMax(1, count);
+}
+
+void ColumnStore::setCacheMegabytes(int megabytes)
+{
+    QMutexLocker locker(&mutex);
+    cache.setMaxCost(qMax(0, megabytes) * 1024);   // 缓存代价以 KB 计
+}
+
+qint64 ColumnStore::lastTransactionId()
+{
+    QMutexLocker locker(&mutex);
+    refresh();
+    return segments.isEmpty() ? 0 : segments.last().lastId;
+}
+
+qint64 ColumnStore::postingCount()
+{
+    QMutexLocker locker(&mutex);
+    refresh();
+    qint64 total = 0;
+    for (const SegmentInfo& info : segments) total += info.rows;
+    return total;
+}
+
+bool ColumnStore::loadTail(ColumnSegmentBuilder& builder)
+{
+    builder.clear();
+    QString path;
+    {
+        QMutexLocker locker(&mutex);
+        refresh();
+        if (segments.isEmpty() || segments.last().rows >= kSegmentRows) return true;
+        path = segments.last().path;
+    }
+    return readSegment(path, nullptr, &builder);
+}
+
+bool ColumnStore::writeSegment(const ColumnSegmentBuilder& builder)
+{
+    const int n = builder.rows();
+    if (n == 0) return true;
+    if (!QDir().mkpath(dir)) {
+        qDebug() << "无法创建列存目录:" << dir;
+        return false;
+    }
+
+    const auto range = std::minmax_element(builder.times.constBegin(), builder.times.constEnd());
+    const qint64 minTime = *range.first;
+    const qint64 maxTime = *range.second;
+
+    QVector<quint32> idDeltas(n);
+    QVector<qint32> timeDeltas(n);
+    qint64 previousTime = minTime;
+    for (int i = 0; i < n; ++i) {
+        idDeltas[i] = i == 0 ? 0 : quint32(builder.ids[i] - builder.ids[i - 1]);
+        timeDeltas[i] = qint32(builder.times[i] - previousTime);
+        previousTime = builder.times[i];
+    }
+
+    QByteArray dictionary;
+    {
+        QDataStream stream(&dictionary, QIODevice::WriteOnly);
+        stream.setVersion(QDataStream::Qt_5_15);
+        stream << builder.types << builder.accounts;
+    }
+
+    SegmentInfo info;
+    info.path = QDir(dir).filePath(segmentFileName(builder.firstTransactionId()));
+    info.rows = n;
+    info.firstId = builder.firstTransactionId();
+    info.lastId = builder.lastTransactionId();
+    info.minTime = minTime;
+    info.maxTime = maxTime;
+
+    QSaveFile file(info.path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "无法写入列存段:" << info.path << file.errorString();
+        return false;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_15);
+    stream << kSegmentMagic << kSegmentVersion << quint32(n) << info.firstId << info.lastId << minTime << maxTime
+           << qCompress(dictionary)
+           << packColumn(idDeltas)
+           << packColumn(timeDeltas)
+           << packColumn(builder.typeCodes)
+           << packColumn(builder.amounts)
+           << packColumn(builder.accountCodes)
+           << packColumn(builder.targetCodes);
+    if (stream.status() != QDataStream::Ok || !file.commit()) {
+        qDebug() << "写入列存段失败:" << info.path << file.errorString();
+        return false;
+    }
+
+    const QFileInfo written(info.path);
+    info.modified = written.lastModified().toMSecsSinceEpoch();
+    info.size = written.size();
+
+    QMutexLocker locker(&mutex);
+    auto it = std::find_if(segments.begin(), segments.end(),
+                           [&info](const SegmentInfo& s) { return s.path == info.path; });
+    if (it != segments.end()) {
+        *it = info;
+    } else {
+        segments.append(info);
+    }
+    return true;
+}
+
+void ColumnStore::refresh()
+{
+    QHash<QString, SegmentInfo> known;
+    for (const SegmentInfo& info : segments) known.insert(info.path, info);
+
+    QList<SegmentInfo> updated;
+    const QFileInfoList files = QDir(dir).entryInfoList({ "postings_*.bkcol" }, QDir::Files, QDir::Name);
+    for (const QFileInfo& file : files) {
+        const qint64 modified = file.lastModified().toMSecsSinceEpoch();
+        const auto it = known.constFind(file.filePath());
+        if (it != known.constEnd() && it->modified == modified && it->size == file.size()) {
+            updated.append(it.value());
+            continue;
+        }
+        SegmentInfo info;
+        if (!readHeader(file.filePath(), info)) continue;
+        info.modified = modified;
+        info.size = file.size();
+        updated.append(info);
+    }
+    std::sort(updated.begin(), updated.end(),
+              [](const SegmentInfo& a, const SegmentInfo& b) { return a.firstId < b.firstId; });
+    segments = updated;
+}
+
+QList<ColumnStore::SegmentInfo> ColumnStore::candidates(const PostingFilter& filter)
+{
+    QMutexLocker locker(&mutex);
+    refresh();
+
+    QList<SegmentInfo> result;
+    for (const SegmentInfo& info : segments) {
+        if (filter.from.isValid() && info.maxTime < filter.from.toSecsSinceEpoch()) continue;
+        if (filter.to.isValid() && info.minTime >= filter.to.toSecsSinceEpoch()) continue;
+        result.append(info);
+    }
+    return result;
+}
+
+QSharedPointer<const ColumnStore::Segment> ColumnStore::segment(const SegmentInfo& info)
+{
+    // 末段会被覆盖，键中带上最大交易号
+    const QString key = info.path + QLatin1Char('#') + QString::number(info.lastId);
+    {
+        QMutexLocker locker(&mutex);
+        if (QSharedPointer<const Segment>* cached = cache.object(key)) return *cached;
+    }
+
+    QSharedPointer<Segment> loaded = QSharedPointer<Segment>::create();
+    if (!readSegment(info.path, loaded.data(), nullptr)) return QSharedPointer<const Segment>();
+
+    // 时间 4 + 类型 1 + 金额 8 + 对方账户 4 字节/行
+    const int cost = int(qMax<qint64>(1, qint64(loaded->info.rows) * 17 / 1024));
+    QMutexLocker locker(&mutex);
+    cache.insert(key, new QSharedPointer<const Segment>(loaded), cost);
+    return loaded;
+}
+
+void ColumnStore::scan(const PostingFilter& filter,
+                       const std::function<void(const Segment&, const quint8* mask)>& visit)
+{
+    const QList<SegmentInfo> list = candidates(filter);
+    if (list.isEmpty()) return;
+
+    const bool amountFiltered = filter.minCents > 0 || filter.maxCents > 0;
+    const qint64 minCents = filter.minCents > 0 ? filter.minCents : std::numeric_limits<qint64>::min();
+    const qint64 maxCents = filter.maxCents > 0 ? filter.maxCents : std::numeric_limits<qint64>::max();
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(threads);
+    for (const SegmentInfo& info : list) {
+        pool.start(new ScanTask([this, info, &filter, &visit, amountFiltered, minCents, maxCents]() {
+            const QSharedPointer<const Segment> data = segment(info);
+            if (!data) return;
+            const Segment& seg = *data;
+            const int n = seg.info.rows;
+
+            int typeCode = -1;
+            if (!filter.type.isEmpty()) {
+                typeCode = seg.types.indexOf(filter.type);
+                if (typeCode < 0) return;   // 本段没有该类型
+            }
+
+            // 时间以段内相对秒数比较，区间先裁剪到 [0, span + 1]
+            const qint64 span = seg.info.maxTime - seg.info.minTime + 1;
+            const qint32 lo = filter.from.isValid()
+                ? qint32(qBound<qint64>(0, filter.from.toSecsSinceEpoch() - seg.info.minTime, span)) : 0;
+            const qint32 hi = filter.to.isValid()
+                ? qint32(qBound<qint64>(0, filter.to.toSecsSinceEpoch() - seg.info.minTime, span)) : qint32(span);
+
+            QVector<quint8> mask(n, 1);
+            if (lo > 0 || hi < span) maskTimeRange(seg.times.constData(), n, lo, hi, mask.data());
+            if (typeCode >= 0) maskEquals(seg.typeCodes.constData(), n, quint8(typeCode), mask.data());
+            if (amountFiltered) maskAmountRange(seg.amounts.constData(), n, minCents, maxCents, mask.data());
+
+            visit(seg, mask.constData());
+        }));
+    }
+    pool.waitForDone();
+}
+
+QList<DailyTypeVolume> ColumnStore::volumeByTypePerDay(const PostingFilter& filter)
+{
+    // 按本地日期分组，与交易记录界面显示的日期一致
+    const qint64 utcOffset = QDateTime::currentDateTime().offsetFromUtc();
+    const QDate epoch(1970, 1, 1);
+
+    QMutex mergeMutex;
+    QMap<QPair<QDate, QString>, DailyTypeVolume> totals;
+
+    scan(filter, [&](const Segment& seg, const quint8* mask) {
+        const qint64 base = seg.info.minTime + utcOffset;
+        const qint64 firstDay = floorDiv(base, kSecsPerDay);
+        const int days = int(floorDiv(seg.info.maxTime + utcOffset, kSecsPerDay) - firstDay + 1);
+        const int typeCount = seg.types.size();
+        const qint32 dayOffset = qint32(base - firstDay * kSecsPerDay);   // 段起点在当天已过的秒数
+
+        // 段内 (日, 类型) 平铺成数组，按掩码累加而不分支
+        QVector<qint64> counts(days * typeCount);
+        QVector<qint64> sums(days * typeCount);
+        const qint32* times = seg.times.constData();
+        const quint8* codes = seg.typeCodes.constData();
+        const qint64* amounts = seg.amounts.constData();
+        for (int i = 0; i < seg.info.rows; ++i) {
+            const int slot = int((times[i] + dayOffset) / kSecsPerDay) * typeCount + codes[i];
+            counts[slot] += mask[i];
+            sums[slot] += amounts[i] & -qint64(mask[i]);
+        }
+
+        QMutexLocker locker(&mergeMutex);
+        for (int slot = 0; slot < counts.size(); ++slot) {
+            if (counts[slot] == 0) continue;
+            const QDate day = epoch.addDays(firstDay + slot / typeCount);
+            const QString& type = seg.types.at(slot % typeCount);
+            DailyTypeVolume& total = totals[qMakePair(day, type)];
+            total.day = day;
+            total.type = type;
+            total.count += counts[slot];
+            total.amountCents += sums[slot];
+        }
+    });
+
+    return totals.values();
+}
+
+QList<CounterpartyVolume> ColumnStore::topCounterparties(const PostingFilter& filter, int limit)
+{
+    QMutex mergeMutex;
+    QHash<QString, CounterpartyVolume> totals;
+
+    scan(filter, [&](const Segment& seg, const quint8* mask) {
+        QVector<qint64> counts(seg.accounts.size());
+        QVector<qint64> sums(seg.accounts.size());
+        const quint32* targets = seg.targetCodes.constData();
+        const qint64* amounts = seg.amounts.constData();
+        for (int i = 0; i < seg.info.rows; ++i) {
+            if (targets[i] == kNoAccount || !mask[i]) continue;
+            counts[targets[i]] += 1;
+            sums[targets[i]] += amounts[i];
+        }
+
+        QMutexLocker locker(&mergeMutex);
+        for (int code = 0; code < counts.size(); ++code) {
+            if (counts[code] == 0) continue;
+            CounterpartyVolume& total = totals[seg.accounts.at(code)];
+            total.accountId = seg.accounts.at(code);
+            total.count += counts[code];
+            total.amountCents += sums[code];
+        }
+    });
+
+    QList<CounterpartyVolume> result = totals.values();
+    const int top = qBound(0, limit, result.size());
+    std::partial_sort(result.begin(), result.begin() + top, result.end(),
+                      [](const CounterpartyVolume& a, const CounterpartyVolume& b) {
+                          if (a.amountCents != b.amountCents) return a.amountCents > b.amountCents;
+                          return a.count > b.count;
+                      });
+    return result.mid(0, top);
+}
+
+QList<AmountBucket> ColumnStore::amountDistribution(const PostingFilter& filter)
+{
+    QMutex mergeMutex;
+    qint64 counts[kBucketCount] = {};
+    qint64 sums[kBucketCount] = {};
+
+    scan(filter, [&](const Segment& seg, const quint8* mask) {
+        qint64 localCounts[kBucketCount] = {};
+        qint64 localSums[kBucketCount] = {};
+        const qint64* amounts = seg.amounts.constData();
+        for (int i = 0; i < seg.info.rows; ++i) {
+            int bucket = 0;
+            for (qint64 bound : kBucketBounds) bucket += amounts[i] >= bound;
+            localCounts[bucket] += mask[i];
+            localSums[bucket] += amounts[i] & -qint64(mask[i]);
+        }
+
+        QMutexLocker locker(&mergeMutex);
+        for (int b = 0; b < kBucketCount; ++b) {
+            counts[b] += localCounts[b];
+            sums[b] += localSums[b];
+        }
+    });
+
+    QList<AmountBucket> result;
+    for (int b = 0; b < kBucketCount; ++b) {
+        AmountBucket bucket;
+        bucket.lowerCents = b == 0 ? 0 : kBucketBounds[b - 1];
+        bucket.count = counts[b];
+        bucket.amountCents = sums[b];
+        result.append(bucket);
+    }
+    return result;
+}
+
+bool ColumnStore::readHeader(const QString& path, SegmentInfo& info)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_15);
+    quint32 magic = 0;
+    quint32 version = 0;
+    quint32 rows = 0;
+    stream >> magic >> version >> rows >> info.firstId >> info.lastId >> info.minTime >> info.maxTime;
+    if (stream.status() != QDataStream::Ok || magic != kSegmentMagic || version != kSegmentVersion
+        || rows == 0 || rows > quint32(kSegmentRows)) {
+        qDebug() << "列存段文件头无效:" << path;
+        return false;
+    }
+    info.path = path;
+    info.rows = int(rows);
+    return true;
+}
+
+bool ColumnStore::readSegment(const QString& path, Segment* segment, ColumnSegmentBuilder* rows)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qDebug() << "无法读取列存段:" << path << file.errorString();
+        return false;
+    }
+    const QByteArray content = file.readAll();
+
+    QDataStream stream(content);
+    stream.setVersion(QDataStream::Qt_5_15);
+    quint32 magic = 0;
+    quint32 version = 0;
+    quint32 count = 0;
+    SegmentInfo info;
+    QByteArray dictionary, idBlock, timeBlock, typeBlock, amountBlock, accountBlock, targetBlock;
+    stream >> magic >> version >> count >> info.firstId >> info.lastId >> info.minTime >> info.maxTime
+           >> dictionary >> idBlock >> timeBlock >> typeBlock >> amountBlock >> accountBlock >> targetBlock;
+    if (stream.status() != QDataStream::Ok || magic != kSegmentMagic || version != kSegmentVersion
+        || count == 0 || count > quint32(kSegmentRows)) {
+        qDebug() << "列存段文件格式错误:" << path;
+        return false;
+    }
+    info.path = path;
+    info.rows = int(count);
+    const int n = info.rows;
+
+    QStringList types;
+    QStringList accounts;
+    {
+        QDataStream dict(qUncompress(dictionary));
+        dict.setVersion(QDataStream::Qt_5_15);
+        dict >> types >> accounts;
+        if (dict.status() != QDataStream::Ok) {
+            qDebug() << "列存段字典损坏:" << path;
+            return false;
+        }
+    }
+
+    QVector<qint32> timeDeltas;
+    QVector<quint8> typeCodes;
+    QVector<qint64> amounts;
+    QVector<quint32> targetCodes;
+    if (!unpackColumn(timeBlock, n, timeDeltas) || !unpackColumn(typeBlock, n, typeCodes)
+        || !unpackColumn(amountBlock, n, amounts) || !unpackColumn(targetBlock, n, targetCodes)) {
+        qDebug() << "列存段数据损坏:" << path;
+        return false;
+    }
+
+    // 编码越界的段不使用，避免聚合时越界写入
+    const bool typesValid = std::all_of(typeCodes.constBegin(), typeCodes.constEnd(),
+                                        [&types](quint8 code) { return code < types.size(); });
+    const bool targetsValid = std::all_of(targetCodes.constBegin(), targetCodes.constEnd(),
+                                          [&accounts](quint32 code) {
+                                              return code == kNoAccount || code < quint32(accounts.size());
+                                          });
+    if (!typesValid || !targetsValid) {
+        qDebug() << "列存段字典编码越界:" << path;
+        return false;
+    }
+
+    // 时间差值还原为相对 minTime 的秒数
+    qint32 elapsed = 0;
+    for (int i = 0; i < n; ++i) {
+        elapsed += timeDeltas[i];
+        timeDeltas[i] = elapsed;
+    }
+
+    if (rows) {
+        QVector<quint32> idDeltas;
+        QVector<quint32> accountCodes;
+        if (!unpackColumn(idBlock, n, idDeltas) || !unpackColumn(accountBlock, n, accountCodes)) {
+            qDebug() << "列存段数据损坏:" << path;
+            return false;
+        }
+        rows->clear();
+        qint64 id = info.firstId;
+        for (int i = 0; i < n; ++i) {
+            id += idDeltas[i];
+            const quint32 account = accountCodes[i];
+            const quint32 target = targetCodes[i];
+            rows->add(id, info.minTime + timeDeltas[i], types.at(typeCodes[i]), amounts[i],
+                      account < quint32(accounts.size()) ? accounts.at(int(account)) : QString(),
+                      target == kNoAccount ? QString() : accounts.at(int(target)));
+        }
+    }
+
+    if (segment) {
+        segment->info = info;
+        segment->types = types;
+        segment->accounts = accounts;
+        segment->times = timeDeltas;
+        segment->typeCodes = typeCodes;
+        segment->amounts = amounts;
+        segment->targetCodes = targetCodes;
+    }
+    return true;
+}
@@ -0,0 +1,151 @@
+#ifndef COLUMNSTORE_H
+#define COLUMNSTORE_H
+
+#include <QString>
+#include <QStringList>
+#include <QDate>
+#include <QDateTime>
+#include <QVector>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QCache>
+#include <QSharedPointer>
+#include <functional>
+
+// 报表查询的筛选条件，空值表示不限
+struct PostingFilter
+{
+    QDateTime from;
+    QDateTime to;
+    QString type;
+    qint64 minCents = 0;
+    qint64 maxCents = 0;
+};
+
+struct DailyTypeVolume
+{
+    QDate day;
+    QString type;
+    qint64 count = 0;
+    qint64 amountCents = 0;
+};
+
+struct CounterpartyVolume
+{
+    QString accountId;
+    qint64 count = 0;
+    qint64 amountCents = 0;
+};
+
+// 金额分布的一档：[lowerCents, 下一档的 lowerCents)
+struct AmountBucket
+{
+    qint64 lowerCents = 0;
+    qint64 count = 0;
+    qint64 amountCents = 0;
+};
+
+// 一个段的写入缓冲，账户与交易类型在追加时做字典编码
+class ColumnSegmentBuilder
+{
+public:
+    // 交易号须递增；类型超过 255 种时返回 false
+    bool add(qint64 transactionId, qint64 timeSecs, const QString& type, qint64 amountCents,
+             const QString& accountId, const QString& targetAccount);
+    int rows() const { return ids.size(); }
+    qint64 firstTransactionId() const { return ids.isEmpty() ? 0 : ids.first(); }
+    qint64 lastTransactionId() const { return ids.isEmpty() ? 0 : ids.last(); }
+    void clear();
+
+private:
+    friend class ColumnStore;
+
+    QVector<qint64> ids;
+    QVector<qint64> times;
+    QVector<quint8> typeCodes;
+    QVector<qint64> amounts;
+    QVector<quint32> accountCodes;
+    QVector<quint32> targetCodes;
+    QStringList types;
+    QStringList accounts;
+    QHash<QString, quint8> typeIndex;
+    QHash<QString, quint32> accountIndex;
+};
+
+// 交易流水的本地列式存储与报表查询
+// 流水按交易号顺序切成段（每段最多 kSegmentRows 行），每段一个 .bkcol 文件，文件头记录行数与交易号、时间范围，
+// 各列分别压缩：交易类型与账户为字典编码，交易号与时间为差值编码，金额为以分为单位的定点整数。
+// 查询按时间范围跳过无关的段，其余段在线程池中并行扫描：只解压用到的列，
+// 过滤条件先算成逐行掩码（SSE2 可用时向量化），再按掩码聚合，各段的部分结果最后合并。
+// 解压后的段按内存上限缓存；查询可在任意线程调用，写入只由导出线程进行。
+class ColumnStore
+{
+public:
+    static const int kSegmentRows = 1 << 20;
+
+    explicit ColumnStore(const QString& directory = QString());
+
+    QString directory() const;
+    void setThreadCount(int count);
+    void setCacheMegabytes(int megabytes);
+
+    // 已导出的最大交易号，没有数据时为 0
+    qint64 lastTransactionId();
+    qint64 postingCount();
+
+    // 最后一段未满时读入 builder 继续追加，写回时覆盖原文件
+    bool loadTail(ColumnSegmentBuilder& builder);
+    bool writeSegment(const ColumnSegmentBuilder& builder);
+
+    QList<DailyTypeVolume> volumeByTypePerDay(const PostingFilter& filter);
+    QList<CounterpartyVolume> topCounterparties(const PostingFilter& filter, int limit);
+    // 按金额数量级分档：1 元以下、1~10 元、10~100 元……1000 万元以上
+    QList<AmountBucket> amountDistribution(const PostingFilter& filter);
+
+private:
+    // 文件头，打开目录时读取，用于按时间裁剪
+    struct SegmentInfo
+    {
+        QString path;
+        int rows = 0;
+        qint64 firstId = 0;
+        qint64 lastId = 0;
+        qint64 minTime = 0;
+        qint64 maxTime = 0;
+        qint64 modified = 0;         // 文件修改时间与大小，末段被覆盖后重新读取
+        qint64 size = 0;
+    };
+
+    // 解压后的查询列
+    struct Segment
+    {
+        SegmentInfo info;
+        QStringList types;
+        QStringList accounts;
+        QVector<qint32> times;       // 相对 info.minTime 的秒数
+        QVector<quint8> typeCodes;
+        QVector<qint64> amounts;
+        QVector<quint32> targetCodes;
+    };
+
+    QString dir;
+    int threads;
+
+    QMutex mutex;
+    QList<SegmentInfo> segments;     // 按交易号排序
+    QCache<QString, QSharedPointer<const Segment>> cache;
+
+    void refresh();
+    QSharedPointer<const Segment> segment(const SegmentInfo& info);
+    QList<SegmentInfo> candidates(const PostingFilter& filter);
+
+    // 逐段计算过滤掩码后调用 visit，visit 可能在多个线程中同时执行
+    void scan(const PostingFilter& filter,
+              const std::function<void(const Segment&, const quint8* mask)>& visit);
+
+    static bool readHeader(const QString& path, SegmentInfo& info);
+    static bool readSegment(const QString& path, Segment* segment, ColumnSegmentBuilder* rows);
+};
+
+#endif // COLUMNSTORE_H
@@ -0,0 +1,189 @@
+#include "columnstoreexporter.h"
+#include "money.h"
+#include "schema.h"
+#include "dberror.h"
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QTimer>
+#include <QDir>
+#include <QLockFile>
+#include <QDateTime>
+#include <QDebug>
+
+ColumnStoreExporter::ColumnStoreExporter(const QString& sourceConnectionName, const QString& directory,
+                                         QObject* parent)
+    : QObject(parent)
+    , sourceConnection(sourceConnectionName)
+    , workerConnection(sourceConnectionName + "_analytics")
+    , timer(nullptr)
+    , store(directory)
+    , batchSize(20000)
+    , settleSeconds(300)
+    , stopRequested(0)
+{
+}
+
+QString ColumnStoreExporter::directory() const
+{
+    return store.directory();
+}
+
+void ColumnStoreExporter::setBatchSize(int rows)
+{
+    batchSize = qBound(1000, rows, 200000);
+}
+
+void ColumnStoreExporter::setSettleSeconds(int seconds)
+{
+    settleSeconds = qMax(0, seconds);
+}
+
+void ColumnStoreExporter::requestStop()
+{
+    stopRequested.storeRelaxed(1);
+}
+
+void ColumnStoreExporter::start(int intervalMs)
+{
+    stopRequested.storeRelaxed(0);
+    if (!timer) {
+        timer = new QTimer(this);
+        connect(timer, &QTimer::timeout, this, &ColumnStoreExporter::runExport);
+    }
+    timer->start(intervalMs);
+
+    // 启动后立即补齐停机期间的流水
+    runExport();
+}
+
+void ColumnStoreExporter::stop()
+{
+    if (timer) {
+        timer->stop();
+    }
+
+    if (QSqlDatabase::contains(workerConnection)) {
+        {
+            QSqlDatabase db = QSqlDatabase::database(workerConnection, false);
+            db.close();
+        }
+        QSqlDatabase::removeDatabase(workerConnection);
+    }
+}
+
+bool ColumnStoreExporter::openWorkerConnection()
+{
+    if (!QSqlDatabase::contains(workerConnection)) {
+        if (!QSqlDatabase::contains(sourceConnection)) {
+            qDebug() << "列存导出线程：主连接不存在";
+            return false;
+        }
+        QSqlDatabase::cloneDatabase(sourceConnection, workerConnection);
+    }
+
+    QSqlDatabase db = QSqlDatabase::database(workerConnection, false);
+    if (!DbError::ensureOpen(db)) {
+        qDebug() << "列存导出线程连接失败:" << db.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+bool ColumnStoreExporter::runExport()
+{
+    if (!openWorkerConnection()) {
+        emit finished(false);
+        return false;
+    }
+
+    if (!QDir().mkpath(store.directory())) {
+        qDebug() << "无法创建列存目录:" << store.directory();
+        emit finished(false);
+        return false;
+    }
+
+    // 其他客户端正在导出同一目录时跳过；持锁进程退出后锁自动失效
+    QLockFile lock(QDir(store.directory()).filePath("export.lock"));
+    lock.setStaleLockTime(0);
+    if (!lock.tryLock(0)) {
+        emit finished(true);
+        return true;
+    }
+
+    QSqlDatabase db = QSqlDatabase::database(workerConnection, false);
+    QSqlQuery query(db);
+    if (!query.exec("SELECT NOW()") || !query.next()) {
+        qDebug() << "列存导出：读取数据库时间失败:" << query.lastError().text();
+        emit finished(false);
+        return false;
+    }
+    const qint64 cutoff = query.value(0).toDateTime().toSecsSinceEpoch() - settleSeconds;
+
+    // 未满的最后一段读回继续追加
+    ColumnSegmentBuilder builder;
+    if (!store.loadTail(builder)) {
+        emit finished(false);
+        return false;
+    }
+    qint64 after = qMax(store.lastTransactionId(), builder.lastTransactionId());
+
+    query.prepare(QString("SELECT transaction_id, transaction_time, transaction_type, amount, account_id, "
+                          "target_account FROM transactions WHERE transaction_id > :after "
+                          "ORDER BY transaction_id LIMIT %1").arg(batchSize));
+
+    bool success = true;
+    bool settled = false;      // 读到了尚在等待期内的流水
+    bool pending = false;      // builder 中有未写入的行
+    qint64 rows = 0;
+
+    while (success && !settled && !stopRequested.loadRelaxed()) {
+        query.bindValue(":after", after);
+        if (!query.exec()) {
+            qDebug() << "列存导出：读取流水失败:" << query.lastError().text();
+            success = false;
+            break;
+        }
+
+        int fetched = 0;
+        while (query.next()) {
+            ++fetched;
+            const qint64 time = query.value(1).toDateTime().toSecsSinceEpoch();
+            if (time >= cutoff) {
+                settled = true;
+                break;
+            }
+
+            const qint64 id = query.value(0).toLongLong();
+            if (!builder.add(id, time, Schema::transactionTypeName(query.value(2).toInt()), Money::toCents(query.value(3)),
+                             query.value(4).toString(), Schema::accountId(query.value(5)))) {
+                qDebug() << "列存导出：无法追加交易" << id << "（交易类型超过 255 种）";
+                success = false;
+                break;
+            }
+            after = id;
+            ++rows;
+            pending = true;
+
+            if (builder.rows() >= ColumnStore::kSegmentRows) {
+                success = store.writeSegment(builder);
+                builder.clear();
+                pending = false;
+                if (!success) break;
+            }
+        }
+        query.finish();
+        if (fetched < batchSize) break;
+    }
+
+    if (success && pending) {
+        success = store.writeSegment(builder);
+    }
+
+    if (success && rows > 0) {
+        qDebug() << "列存导出完成: 新增" << rows << "条，导出至交易号" << after;
+        emit exported(rows, after);
+    }
+    emit finished(success);
+    return success;
+}
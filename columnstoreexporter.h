@@ -0,0 +1,53 @@
+#ifndef COLUMNSTOREEXPORTER_H
+#define COLUMNSTOREEXPORTER_H
+
+#include <QObject>
+#include <QString>
+#include <QAtomicInt>
+#include "columnstore.h"
+
+class QTimer;
+
+// 报表列存的增量导出
+// 按交易号顺序读取上次导出之后的流水，追加到本地列存（见 ColumnStore），已导出的最大交易号即导出进度，
+// 保存在列存文件中，中断后从最后写成的段继续。只导出早于数据库当前时间 settleSeconds 秒的流水：
+// 交易号在插入时分配、提交较晚的事务可能让较小的交易号晚出现，留出这段时间后再按交易号推进。
+// 同一目录只允许一个进程导出（目录中的锁文件），查询不受影响。
+class ColumnStoreExporter : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ColumnStoreExporter(const QString& sourceConnectionName, const QString& directory = QString(),
+                                 QObject* parent = nullptr);
+
+    QString directory() const;
+    void setBatchSize(int rows);
+    void setSettleSeconds(int seconds);
+
+    // 可在任意线程调用：当前批次完成后停止导出，已读入的行写入列存
+    void requestStop();
+
+public slots:
+    // 以下槽函数在导出线程中执行
+    void start(int intervalMs);
+    void stop();
+    bool runExport();
+
+signals:
+    void exported(qint64 rows, qint64 lastTransactionId);
+    void finished(bool success);
+
+private:
+    QString sourceConnection;
+    QString workerConnection;
+    QTimer* timer;
+    ColumnStore store;
+    int batchSize;
+    int settleSeconds;
+    QAtomicInt stopRequested;
+
+    bool openWorkerConnection();
+};
+
+#endif // COLUMNSTOREEXPORTER_H
@@ -1,21 +1,148 @@
 #include "databasemanager.h"
+#include "transactionarchiver.h"
+#include "passwordhasher.h"
+#include "outboxpublisher.h"
+#include "transferscheduler.h"
+#include "velocitylimiter.h"
+#include "dbworkscheduler.h"
+#include "balancecheckpointer.h"
+#include "accountpurger.h"
+#include "slowquerylog.h"
+#include "journal.h"
+#include "schema.h"
+#include "accountdirectory.h"
+#include "writecoalescer.h"
+#include "columnstoreexporter.h"
+#include "mysqlfastpath.h"
+#include "workloadtrace.h"
+#include "money.h"
+#include "dberror.h"
 #include <QSqlDatabase>
 #include <QSqlQuery>
 #include <QSqlError>
+#include <QSqlDriver>
 #include <QDebug>
 #include <QDateTime>
 #include <QRandomGenerator>
 #include <QVariant>
+#include <QThread>
+#include <QTimer>
+#include <QCryptographicHash>
+#include <QMessageAuthenticationCode>
+#include <QThreadPool>
+#include <QElapsedTimer>
+#include <QFutureInterface>
+#include <QFutureWatcher>
+#include <QPointer>
+#include <QVector>
+#include <numeric>
+#include <algorithm>
+
+namespace {
+const int kArchiveIntervalMs = 6 * 60 * 60 * 1000; // 每 6 小时检查一次分区归档
+const int kIdempotencyTtlHours = 24;                // 幂等键保留 24 小时
+const int kIdempotencyPurgeIntervalMs = 60 * 60 * 1000;
+const int kOutboxPollIntervalMs = 200;             // 变更事件跟踪间隔
+const int kDbWorkThreads = 3;                      // 数据库工作线程数，批量任务最多占一个
+const int kCheckpointIntervalMs = 60 * 60 * 1000;  // 每小时检查是否有未写的日终余额
+const int kPurgeIntervalMs = 10 * 60 * 1000;       // 每 10 分钟检查是否有待清理的已销户账户
+const int kAnalyticsExportIntervalMs = 5 * 60 * 1000;  // 每 5 分钟向报表列存导出新流水
+const int kDirectoryRefreshIntervalMs = 5000;       // 账户目录增量刷新间隔
+const int kDirectoryTrustMs = kDirectoryRefreshIntervalMs + 1000;  // 目录在此时间内同步过才直接判定账户不存在：
+                                                                  // 一个刷新间隔加上刷新本身的耗时
+const int kConnectionProbeIntervalMs = 60 * 1000;  // 主连接探测间隔，远小于服务器的 wait_timeout
+const int kWriteMaxAttempts = 5;                   // 存取款/转账遇死锁等可重试错误时的最多尝试次数
+const int kWriteRetryBaseDelayMs = 5;
+const int kWriteRetryMaxDelayMs = 200;
+const int kWriteRetryBudgetMs = 1000;              // 重试累计耗时上限，超出后返回失败
+
+// 登录与首屏使用的语句，连接后预编译
+// 账户号按 Schema::accountKey() 绑定，类型与状态为编码（3 = 已销户）
+const char* const kSqlUserCredentials = "SELECT user_id, password, role FROM users WHERE username = ?";
+const char* const kSqlUserRole = "SELECT role FROM users WHERE username = ?";
+const char* const kSqlUserAccounts = "SELECT a.account_id, t.type_name, a.balance, a.created_at "
+                                     "FROM accounts a JOIN users u ON a.user_id = u.user_id "
+                                     "LEFT JOIN account_types t ON t.type_code = a.account_type "
+                                     "WHERE u.username = ? AND a.status <> 3 "
+                                     "ORDER BY a.created_at DESC";
+const char* const kSqlBalance = "SELECT balance FROM accounts WHERE account_id = ?";
+const char* const kSqlBalanceAndType = "SELECT a.balance, t.type_name FROM accounts a "
+                                       "LEFT JOIN account_types t ON t.type_code = a.account_type "
+                                       "WHERE a.account_id = ?";
+
+// IN 列表的命名占位符 :prefix0, :prefix1, ...，由 bindAccountList 按同样的名称绑定
+QString listPlaceholders(const QString& prefix, int count)
+{
+    QStringList names;
+    for (int i = 0; i < count; ++i) names << QString(":%1%2").arg(prefix).arg(i);
+    return names.join(", ");
+}
+
+void bindAccountList(QSqlQuery& query, const QString& prefix, const QStringList& accountIds)
+{
+    for (int i = 0; i < accountIds.size(); ++i) {
+        query.bindValue(QString(":%1%2").arg(prefix).arg(i), Schema::accountKey(accountIds.at(i)));
+    }
+}
+
+// LIKE 前缀匹配：转义用户输入中的通配符
+QString likePrefix(const QString& text)
+{
+    QString escaped = text;
+    escaped.replace("\\", "\\\\").replace("%", "\\%").replace("_", "\\_");
+    return escaped + "%";
+}
+
+// 键集分页条件：排序列取值相同时按主键区分，与 ORDER BY column, id 方向一致
+QString keysetCondition(const QString& column, const QString& idColumn, bool descending)
+{
+    const QString op = descending ? "<" : ">";
+    return QString("(%1 %3 :cursor_value OR (%1 = :cursor_value2 AND %2 %3 :cursor_id))")
+        .arg(column, idColumn, op);
+}
+}
 
 DatabaseManager::DatabaseManager(QObject* parent)
     : QObject(parent)
     , db(nullptr)
+    , archiver(nullptr)
+    , archiverThread(nullptr)
+    , idempotencyPurgeTimer(nullptr)
+    , directoryRefreshTimer(nullptr)
+    , connectionProbeTimer(nullptr)
+    , outboxPublisher(nullptr)
+    , outboxThread(nullptr)
+    , scheduler(nullptr)
+    , schedulerThread(nullptr)
+    , limiter(new VelocityLimiter)
+    , directory(new AccountDirectory)
+    , dbWork(nullptr)
+    , checkpointer(nullptr)
+    , checkpointThread(nullptr)
+    , purger(nullptr)
+    , purgeThread(nullptr)
+    , coalescer(nullptr)
+    , analyticsExporter(nullptr)
+    , fastPath(new MysqlFastPath)
+    , fastPathEnabled(MysqlFastPath::compiledIn())
+    , analyticsThread(nullptr)
+    , analyticsEnabled(false)
+    , coalescingEnabled(false)
+    , coalesceWindowMicros(500)
+    , coalesceMaxBatch(64)
+    , attemptError(DbError::None)
+    , attemptCommitSent(false)
+    , connectGeneration(0)
+    , connecting(false)
 {
 }
 
 DatabaseManager::~DatabaseManager()
 {
     disconnect();
+    delete limiter;
+    delete directory;
+    delete fastPath;
 }
 
 DatabaseManager& DatabaseManager::instance()
@@ -28,53 +155,147 @@ bool DatabaseManager::connectToDatabase(const QString& host, // 数据库连接
                                         const QString& database,
                                         const QString& username,
                                         const QString& password)
+{
+    if (!connectCore(host, database, username, password)) {
+        return false;
+    }
+
+    // 限额计数常驻内存，检查时不再汇总交易表
+    limiter->loadLimits(*db);
+    limiter->rebuild(*db);
+    loadAccountTypes(*db, accountTypeList);
+
+    startServices(host, database);
+    return true;
+}
+
+// 只打开主连接并预编译常用语句，不加载限额、不启动任何后台服务与定时器
+bool DatabaseManager::connectCore(const QString& host,
+                                  const QString& database,
+                                  const QString& username,
+                                  const QString& password)
 {
     disconnect(); // 先断开现有连接
 
+    const QString connectionName = QString("BankSystemConnection_%1").arg(QDateTime::currentMSecsSinceEpoch());
+    if (!openMainConnection(connectionName, host, database, username, password)) {
+        return false;
+    }
+    attachMainConnection(connectionName);
+
+    // 测试连接
+    if (!testConnection()) {
+        return false;
+    }
+    return true;
+}
+
+// 在调用线程中创建并打开连接，失败时移除。可在工作线程中调用
+bool DatabaseManager::openMainConnection(const QString& connectionName,
+                                         const QString& host,
+                                         const QString& database,
+                                         const QString& username,
+                                         const QString& password)
+{
     qDebug() << "========== 开始连接数据库 ==========";
     qDebug() << "主机:" << host;
     qDebug() << "数据库:" << database;
     qDebug() << "用户名:" << username;
 
-    // 检查可用驱动
-    qDebug() << "可用数据库驱动:";
-    QStringList drivers = QSqlDatabase::drivers();
-    for (const QString& driver : drivers) {
-        qDebug() << "  " << driver;
+    bool opened = false;
+    {
+        // 创建数据库连接
+        QSqlDatabase connection = QSqlDatabase::addDatabase("QMYSQL", connectionName);
+
+        // 设置连接参数
+        connection.setHostName(host);
+        connection.setDatabaseName(database);
+        connection.setUserName(username);
+        connection.setPassword(password);
+        // 不开启 MYSQL_OPT_RECONNECT：静默重连会让事务中剩余的语句在新会话上自动提交。
+        // 连接中断由 runWithRetry / execCached 与定时探测显式 reopenConnection()，克隆出的后台连接同样不会自动重连
+
+        qDebug() << "尝试打开数据库连接...";
+
+        opened = connection.open();
+        if (!opened) {
+            qDebug() << "数据库连接错误:" << connection.lastError().text();
+            qDebug() << "错误类型:" << connection.lastError().type();
+            qDebug() << "数据库文本:" << connection.lastError().databaseText();
+            qDebug() << "驱动文本:" << connection.lastError().driverText();
+            // 枚举驱动需扫描插件目录，只在失败时输出
+            qDebug() << "可用数据库驱动:" << QSqlDatabase::drivers();
+        }
     }
 
-    // 创建数据库连接
-    QString connectionName = QString("BankSystemConnection_%1").arg(QDateTime::currentMSecsSinceEpoch());
-    db = new QSqlDatabase(QSqlDatabase::addDatabase("QMYSQL", connectionName));
-
-    // 设置连接参数
-    db->setHostName(host);
-    db->setDatabaseName(database);
-    db->setUserName(username);
-    db->setPassword(password);
-    db->setConnectOptions("MYSQL_OPT_RECONNECT=1");
-
-    qDebug() << "尝试打开数据库连接...";
-
-    if (!db->open()) {
-        QString error = db->lastError().text();
-        qDebug() << "数据库连接错误:" << error;
-        qDebug() << "错误类型:" << db->lastError().type();
-        qDebug() << "数据库文本:" << db->lastError().databaseText();
-        qDebug() << "驱动文本:" << db->lastError().driverText();
-
-        delete db;
-        db = nullptr;
+    if (!opened) {
         QSqlDatabase::removeDatabase(connectionName);
-
         return false;
     }
 
     qDebug() << "数据库连接成功！";
     qDebug() << "========== 数据库连接完成 ==========";
+    return true;
+}
 
-    // 测试连接
-    return testConnection();
+// 把已打开的连接作为主连接，预编译常用语句。连接须属于当前线程
+void DatabaseManager::attachMainConnection(const QString& connectionName)
+{
+    db = new QSqlDatabase(QSqlDatabase::database(connectionName, false));
+    prepareCommonStatements();
+    if (fastPathEnabled) fastPath->attach(*db);
+}
+
+// 主连接就绪后启动后台服务与定时器
+void DatabaseManager::startServices(const QString& host, const QString& database)
+{
+    // 同一数据库的会话共用一个本地推送通道
+    feedServerName = QString("banksystem-outbox-%1-%2")
+                         .arg(QString(QCryptographicHash::hash((host + '/' + database).toUtf8(),
+                                                               QCryptographicHash::Sha1).toHex().left(12)))
+                         .arg(database);
+
+    // 慢语句的执行计划在日志线程中用克隆的连接采集
+    SlowQueryLog::instance().setExplainSource(db->connectionName());
+    startArchiver();
+    startOutboxPublisher();
+    startScheduler();
+    startWorkScheduler();
+    startCheckpointer();
+    startPurger();
+    if (coalescingEnabled) startWriteCoalescer();
+    if (analyticsEnabled) startAnalyticsExporter();
+
+    if (!idempotencyPurgeTimer) {
+        idempotencyPurgeTimer = new QTimer(this);
+        connect(idempotencyPurgeTimer, &QTimer::timeout, this, [this]() {
+            purgeExpiredIdempotencyKeys(kIdempotencyTtlHours);
+            limiter->prune();
+            refreshAccountDirectory(true);   // 清除其他客户端销户的账户
+        });
+    }
+    idempotencyPurgeTimer->start(kIdempotencyPurgeIntervalMs);
+
+    // 账户目录在后台构建，之后增量刷新；构建完成前转账目标仍查询数据库
+    refreshAccountDirectory(true);
+    if (!directoryRefreshTimer) {
+        directoryRefreshTimer = new QTimer(this);
+        connect(directoryRefreshTimer, &QTimer::timeout, this, [this]() { refreshAccountDirectory(false); });
+    }
+    directoryRefreshTimer->start(kDirectoryRefreshIntervalMs);
+
+    // 空闲的主连接定时探测：保持会话不因 wait_timeout 被服务器断开，已断开时及早重建
+    if (!connectionProbeTimer) {
+        connectionProbeTimer = new QTimer(this);
+        connect(connectionProbeTimer, &QTimer::timeout, this, [this]() {
+            if (!isConnected()) return;
+            QSqlQuery probe(*db);
+            if (!probe.exec("DO 1") && DbError::classify(probe.lastError()) == DbError::ConnectionLost) {
+                reopenConnection();
+            }
+        });
+    }
+    connectionProbeTimer->start(kConnectionProbeIntervalMs);
 }
 
 bool DatabaseManager::testConnection() //测试连接用，调试专用
@@ -85,7 +306,7 @@ bool DatabaseManager::testConnection() //测试连接用，调试专用
     }
 
     QSqlQuery query(*db);
-    if (query.exec("SELECT 1")) {
+    if (SlowQueryLog::exec(query, "SELECT 1")) {
         qDebug() << "数据库连接测试成功";
         return true;
     } else {
@@ -96,6 +317,29 @@ bool DatabaseManager::testConnection() //测试连接用，调试专用
 
 void DatabaseManager::disconnect()
 {
+    // 归档与推送线程克隆自主连接，需先停止；待合并的存取款先执行完
+    stopWriteCoalescer();
+    stopArchiver();
+    stopOutboxPublisher();
+    stopScheduler();
+    stopWorkScheduler();
+    stopCheckpointer();
+    stopPurger();
+    stopAnalyticsExporter();
+    SlowQueryLog::instance().stop();
+    if (idempotencyPurgeTimer) idempotencyPurgeTimer->stop();
+    if (directoryRefreshTimer) directoryRefreshTimer->stop();
+    if (connectionProbeTimer) connectionProbeTimer->stop();
+    clearStatementCache();
+    fastPath->detach();
+
+    if (retryStats.attempts > 0) {
+        qDebug() << "写事务重试统计: 尝试" << retryStats.attempts << "重试" << retryStats.retries
+                 << "死锁" << retryStats.deadlocks << "锁等待超时" << retryStats.lockWaitTimeouts
+                 << "连接中断" << retryStats.connectionLosses << "用尽" << retryStats.exhausted
+                 << "退避" << retryStats.backoffMs << "ms";
+    }
+
     if (db && db->isOpen()) {
         QString connectionName = db->connectionName();
         db->close();
@@ -106,11 +350,451 @@ void DatabaseManager::disconnect()
     }
 }
 
+void DatabaseManager::connectToDatabaseAsync(const QString& host,
+                                             const QString& database,
+                                             const QString& username,
+                                             const QString& password)
+{
+    disconnect();
+
+    const int generation = ++connectGeneration;
+    connecting = true;
+    VelocityLimiter* limits = limiter;
+    QThread* owner = thread();
+
+    QThreadPool::globalInstance()->start([this, generation, limits, owner, host, database, username, password]() {
+        QElapsedTimer timer;
+        timer.start();
+
+        // 主连接在线程池中打开（加载 QMYSQL 插件、DNS、握手与认证），限额与账户类型也从这条连接读取，
+        // 之后把连接移交给主线程，主线程只需预编译常用语句
+        const QString connectionName = QString("BankSystemConnection_%1_%2")
+                                           .arg(QDateTime::currentMSecsSinceEpoch()).arg(generation);
+        const bool opened = openMainConnection(connectionName, host, database, username, password);
+        QStringList types;
+        if (opened) {
+            QSqlDatabase connection = QSqlDatabase::database(connectionName, false);
+            limits->loadLimits(connection);
+            limits->rebuild(connection);
+            loadAccountTypes(connection, types);
+            // 连接归属于创建它的线程；移交前不能留有其他引用（Qt 6.8 起由 QSqlDatabase::moveToThread 检查）
+            QSqlDriver* driver = connection.driver();
+            connection = QSqlDatabase();
+            driver->moveToThread(owner);
+        }
+        qDebug() << "后台连接完成，耗时" << timer.elapsed() << "ms";
+
+        QMetaObject::invokeMethod(this, [this, generation, opened, connectionName, types, host, database]() {
+            if (generation != connectGeneration) {   // 已被新的连接请求取代
+                if (opened) {
+                    QSqlDatabase::database(connectionName, false).close();
+                    QSqlDatabase::removeDatabase(connectionName);
+                }
+                return;
+            }
+
+            if (opened) {
+                attachMainConnection(connectionName);
+                accountTypeList = types;
+                startServices(host, database);
+            }
+            connecting = false;
+            emit connectionReady(opened);
+        }, Qt::QueuedConnection);
+    });
+}
+
+bool DatabaseManager::isConnecting() const
+{
+    return connecting;
+}
+
+QStringList DatabaseManager::accountTypes() const
+{
+    return accountTypeList;
+}
+
+bool DatabaseManager::loadAccountTypes(QSqlDatabase& connection, QStringList& types)
+{
+    QSqlQuery query(connection);
+    // 按编码排列，与开户时的默认类型（编码 1）和界面未连接时的候选顺序一致
+    if (!SlowQueryLog::exec(query, "SELECT type_name FROM account_types ORDER BY type_code")) {
+        qDebug() << "读取账户类型失败:" << query.lastError().text();
+        return false;
+    }
+
+    types.clear();
+    while (query.next()) types << query.value(0).toString();
+    return true;
+}
+
+QSqlQuery* DatabaseManager::execCached(const QString& sql, const QVariantList& values)
+{
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        QSqlQuery* query = statementCache.value(sql);
+        if (!query) {
+            query = new QSqlQuery(*db);
+            query->setForwardOnly(true);
+            if (!query->prepare(sql)) {
+                qDebug() << "预编译语句失败:" << query->lastError().text();
+                delete query;
+                return nullptr;
+            }
+            statementCache.insert(sql, query);
+        }
+
+        for (int i = 0; i < values.size(); ++i) query->bindValue(i, values.at(i));
+        if (SlowQueryLog::exec(*query)) return query;
+
+        // 连接重建后服务端语句失效，丢弃后重新预编译；连接中断时先重建连接
+        qDebug() << "执行预编译语句失败:" << query->lastError().text();
+        const bool lost = DbError::classify(query->lastError()) == DbError::ConnectionLost;
+        statementCache.remove(sql);
+        delete query;
+        if (lost && (attempt > 0 || !reopenConnection())) return nullptr;
+    }
+    return nullptr;
+}
+
+void DatabaseManager::prepareCommonStatements()
+{
+    for (const char* sql : { kSqlUserCredentials, kSqlUserRole, kSqlUserAccounts, kSqlBalance, kSqlBalanceAndType }) {
+        if (statementCache.contains(sql)) continue;
+
+        QSqlQuery* query = new QSqlQuery(*db);
+        query->setForwardOnly(true);
+        if (query->prepare(sql)) {
+            statementCache.insert(sql, query);
+        } else {
+            qDebug() << "预编译语句失败:" << query->lastError().text();
+            delete query;
+        }
+    }
+}
+
+void DatabaseManager::clearStatementCache()
+{
+    qDeleteAll(statementCache);
+    statementCache.clear();
+}
+
 bool DatabaseManager::isConnected() const
 {
     return db && db->isOpen();
 }
 
+QString DatabaseManager::connectionName() const
+{
+    return db ? db->connectionName() : QString();
+}
+
+TransactionArchiver* DatabaseManager::transactionArchiver() const
+{
+    return archiver;
+}
+
+QString DatabaseManager::changeFeedServerName() const
+{
+    return feedServerName;
+}
+
+void DatabaseManager::startOutboxPublisher()
+{
+    stopOutboxPublisher();
+
+    outboxThread = new QThread(this);
+    outboxPublisher = new OutboxPublisher(db->connectionName(), feedServerName);
+    outboxPublisher->moveToThread(outboxThread);
+    connect(outboxThread, &QThread::finished, outboxPublisher, &QObject::deleteLater);
+    outboxThread->start();
+
+    QMetaObject::invokeMethod(outboxPublisher, "start", Qt::QueuedConnection, Q_ARG(int, kOutboxPollIntervalMs));
+}
+
+void DatabaseManager::stopOutboxPublisher()
+{
+    if (!outboxThread) return;
+
+    QMetaObject::invokeMethod(outboxPublisher, "stop", Qt::BlockingQueuedConnection);
+    outboxThread->quit();
+    outboxThread->wait();
+    delete outboxThread;
+    outboxThread = nullptr;
+    outboxPublisher = nullptr;
+}
+
+TransferScheduler* DatabaseManager::transferScheduler() const
+{
+    return scheduler;
+}
+
+void DatabaseManager::startScheduler()
+{
+    stopScheduler();
+
+    schedulerThread = new QThread(this);
+    scheduler = new TransferScheduler(db->connectionName(), limiter);
+    scheduler->moveToThread(schedulerThread);
+    connect(schedulerThread, &QThread::finished, scheduler, &QObject::deleteLater);
+    connect(this, &DatabaseManager::scheduledTransferChanged, scheduler, &TransferScheduler::reloadOrder);
+    schedulerThread->start();
+
+    QMetaObject::invokeMethod(scheduler, "start", Qt::QueuedConnection);
+}
+
+void DatabaseManager::stopScheduler()
+{
+    if (!schedulerThread) return;
+
+    QMetaObject::invokeMethod(scheduler, "stop", Qt::BlockingQueuedConnection);
+    schedulerThread->quit();
+    schedulerThread->wait();
+    delete schedulerThread;
+    schedulerThread = nullptr;
+    scheduler = nullptr;
+}
+
+DbWorkScheduler* DatabaseManager::workScheduler() const
+{
+    return dbWork;
+}
+
+void DatabaseManager::startWorkScheduler()
+{
+    stopWorkScheduler();
+    dbWork = new DbWorkScheduler(db->connectionName(), kDbWorkThreads);
+}
+
+void DatabaseManager::stopWorkScheduler()
+{
+    if (!dbWork) return;
+
+    qDebug() << "数据库任务统计:" << dbWork->summary();
+    delete dbWork;   // 等待执行中的任务结束
+    dbWork = nullptr;
+}
+
+AccountDirectory* DatabaseManager::accountDirectory() const
+{
+    return directory;
+}
+
+void DatabaseManager::refreshAccountDirectory(bool full)
+{
+    if (!dbWork) return;
+
+    // 整体重建读全部账户，走批量；增量刷新只读几行，走交互读，不因交互操作繁忙而被推迟
+    // （否则目录过期期间转账目标要逐笔查询，过期判断也依赖刷新按时完成）。尚未建好时增量刷新等重建
+    if (!full && !directory->isSynced()) return;
+
+    AccountDirectory* target = directory;
+    const DbWorkScheduler::Priority priority = full ? DbWorkScheduler::Bulk : DbWorkScheduler::InteractiveRead;
+    dbWork->submit(priority, [target, full](QSqlDatabase& connection) {
+        if (full) {
+            target->rebuild(connection);
+        } else {
+            target->refresh(connection);
+        }
+    });
+}
+
+void DatabaseManager::startCheckpointer()
+{
+    stopCheckpointer();
+
+    checkpointThread = new QThread(this);
+    checkpointer = new BalanceCheckpointer(db->connectionName());
+    checkpointer->moveToThread(checkpointThread);
+    connect(checkpointThread, &QThread::finished, checkpointer, &QObject::deleteLater);
+    checkpointThread->start();
+
+    QMetaObject::invokeMethod(checkpointer, "start", Qt::QueuedConnection, Q_ARG(int, kCheckpointIntervalMs));
+}
+
+void DatabaseManager::stopCheckpointer()
+{
+    if (!checkpointThread) return;
+
+    QMetaObject::invokeMethod(checkpointer, "stop", Qt::BlockingQueuedConnection);
+    checkpointThread->quit();
+    checkpointThread->wait();
+    delete checkpointThread;
+    checkpointThread = nullptr;
+    checkpointer = nullptr;
+}
+
+void DatabaseManager::startPurger()
+{
+    stopPurger();
+
+    purgeThread = new QThread(this);
+    purger = new AccountPurger(db->connectionName());
+    purger->moveToThread(purgeThread);
+    connect(purgeThread, &QThread::finished, purger, &QObject::deleteLater);
+    // 账户行删除后才从目录移除，清理期间目录中保留“已销户”状态
+    connect(purger, &AccountPurger::accountPurged, this, [this](const QString& accountId) {
+        directory->remove(accountId);
+    });
+    purgeThread->start();
+
+    QMetaObject::invokeMethod(purger, "start", Qt::QueuedConnection, Q_ARG(int, kPurgeIntervalMs));
+}
+
+void DatabaseManager::stopPurger()
+{
+    if (!purgeThread) return;
+
+    // 正在清理的账户做完当前批次即返回，不等整个账户清理完
+    purger->requestStop();
+    QMetaObject::invokeMethod(purger, "stop", Qt::BlockingQueuedConnection);
+    purgeThread->quit();
+    purgeThread->wait();
+    delete purgeThread;
+    purgeThread = nullptr;
+    purger = nullptr;
+}
+
+void DatabaseManager::setAnalyticsExport(bool enabled, const QString& directory)
+{
+    const bool moved = directory != analyticsDirectory;
+    analyticsEnabled = enabled;
+    analyticsDirectory = directory;
+
+    if (!isConnected()) return;
+    if (!enabled) {
+        stopAnalyticsExporter();
+    } else if (!analyticsExporter || moved) {
+        startAnalyticsExporter();
+    }
+}
+
+bool DatabaseManager::analyticsExportEnabled() const
+{
+    return analyticsExporter != nullptr;
+}
+
+void DatabaseManager::startAnalyticsExporter()
+{
+    stopAnalyticsExporter();
+
+    analyticsThread = new QThread(this);
+    analyticsExporter = new ColumnStoreExporter(db->connectionName(), analyticsDirectory);
+    analyticsExporter->moveToThread(analyticsThread);
+    connect(analyticsThread, &QThread::finished, analyticsExporter, &QObject::deleteLater);
+    analyticsThread->start();
+
+    QMetaObject::invokeMethod(analyticsExporter, "start", Qt::QueuedConnection,
+                              Q_ARG(int, kAnalyticsExportIntervalMs));
+}
+
+void DatabaseManager::stopAnalyticsExporter()
+{
+    if (!analyticsThread) return;
+
+    // 首次导出可能很长，做完当前批次并写入已读的行即返回
+    analyticsExporter->requestStop();
+    QMetaObject::invokeMethod(analyticsExporter, "stop", Qt::BlockingQueuedConnection);
+    analyticsThread->quit();
+    analyticsThread->wait();
+    delete analyticsThread;
+    analyticsThread = nullptr;
+    analyticsExporter = nullptr;
+}
+
+void DatabaseManager::setWriteCoalescing(bool enabled, int windowMicros, int maxBatch)
+{
+    coalescingEnabled = enabled;
+    coalesceWindowMicros = qMax(0, windowMicros);
+    coalesceMaxBatch = qMax(1, maxBatch);
+
+    if (!isConnected()) return;
+    if (!enabled) {
+        stopWriteCoalescer();
+    } else if (coalescer) {
+        coalescer->setWindow(coalesceWindowMicros);
+        coalescer->setMaxBatch(coalesceMaxBatch);
+    } else {
+        startWriteCoalescer();
+    }
+}
+
+bool DatabaseManager::writeCoalescingEnabled() const
+{
+    return coalescer != nullptr;
+}
+
+void DatabaseManager::startWriteCoalescer()
+{
+    stopWriteCoalescer();
+
+    coalescer = new WriteCoalescer(db->connectionName(), limiter);
+    coalescer->setWindow(coalesceWindowMicros);
+    coalescer->setMaxBatch(coalesceMaxBatch);
+}
+
+void DatabaseManager::stopWriteCoalescer()
+{
+    if (!coalescer) return;
+
+    coalescer->stop();
+    qDebug() << "合并提交统计:" << coalescer->summary();
+    delete coalescer;
+    coalescer = nullptr;
+}
+
+bool DatabaseManager::appendOutboxEvent(QSqlDatabase& connection,
+                                        const QString& eventType, const QString& accountId,
+                                        const QVariant& transactionId, const QString& transactionType,
+                                        double amount, const QString& counterparty,
+                                        const QString& description)
+{
+    QSqlQuery query(connection);
+    query.prepare("INSERT INTO outbox_events (event_type, account_id, transaction_id, transaction_type, "
+                  "amount, counterparty, description, balance_after, account_status) "
+                  "SELECT :event_type, account_id, :transaction_id, :transaction_type, :amount, "
+                  ":counterparty, :description, balance, status "
+                  "FROM accounts WHERE account_id = :account_id");
+    query.bindValue(":event_type", eventType);
+    query.bindValue(":transaction_id", transactionId);
+    query.bindValue(":transaction_type",
+                    transactionType.isEmpty() ? QVariant() : QVariant(Schema::transactionType(transactionType)));
+    query.bindValue(":amount", amount > 0 ? QVariant(amount) : QVariant());
+    query.bindValue(":counterparty", Schema::accountKey(counterparty));
+    query.bindValue(":description", description.isEmpty() ? QVariant() : QVariant(description));
+    query.bindValue(":account_id", Schema::accountKey(accountId));
+
+    if (!SlowQueryLog::exec(query)) {
+        qDebug() << "写入变更事件失败:" << query.lastError().text();
+        return false;
+    }
+    return query.numRowsAffected() == 1;
+}
+
+void DatabaseManager::startArchiver()
+{
+    stopArchiver();
+
+    archiverThread = new QThread(this);
+    archiver = new TransactionArchiver(db->connectionName());
+    archiver->moveToThread(archiverThread);
+    connect(archiverThread, &QThread::finished, archiver, &QObject::deleteLater);
+    archiverThread->start();
+
+    QMetaObject::invokeMethod(archiver, "start", Qt::QueuedConnection, Q_ARG(int, kArchiveIntervalMs));
+}
+
+void DatabaseManager::stopArchiver()
+{
+    if (!archiverThread) return;
+
+    QMetaObject::invokeMethod(archiver, "stop", Qt::BlockingQueuedConnection);
+    archiverThread->quit();
+    archiverThread->wait();
+    delete archiverThread;
+    archiverThread = nullptr;
+    archiver = nullptr;
+}
+
 QString DatabaseManager::generateAccountId()
 {
     QDateTime now = QDateTime::currentDateTime();
@@ -120,472 +804,2395 @@ QString DatabaseManager::generateAccountId()
     return QString("6214%1%2").arg(timestamp).arg(randomNum, 3, 10, QChar('0'));
 }
 
-bool DatabaseManager::authenticateUser(const QString& username, const QString& password)
+QString DatabaseManager::requestFingerprint(const QString& operation, const QStringList& arguments)
 {
-    if (!isConnected()) {
-        qDebug() << "用户认证失败：数据库未连接";
-        return false;
-    }
+    const QByteArray data = (operation + QChar(0x1f) + arguments.join(QChar(0x1f))).toUtf8();
+    return QString::fromLatin1(QCryptographicHash::hash(data, QCryptographicHash::Sha256).toHex());
+}
 
-    QSqlQuery query(*db);
-    query.prepare("SELECT user_id FROM users WHERE username = :username AND password = :password");
-    query.bindValue(":username", username);
-    query.bindValue(":password", password);
+// 查找幂等键的首次执行结果；key 为空或尚未登记时返回 false
+bool DatabaseManager::findIdempotentResult(const QString& key, const QString& fingerprint,
+                                           bool& success, QString* result)
+{
+    return findIdempotentResult(*db, key, fingerprint, success, result);
+}
 
-    if (!query.exec()) {
-        qDebug() << "查询执行失败:" << query.lastError().text();
+bool DatabaseManager::findIdempotentResult(QSqlDatabase& connection, const QString& key,
+                                           const QString& fingerprint, bool& success, QString* result)
+{
+    if (key.isEmpty()) return false;
+
+    QSqlQuery query(connection);
+    query.prepare("SELECT request_fingerprint, success, result FROM idempotency_keys "
+                  "WHERE idem_key = :key");
+    query.bindValue(":key", key);
+
+    if (!SlowQueryLog::exec(query) || !query.next()) {
         return false;
     }
 
-    if (query.next()) {
-        qDebug() << "用户认证成功:" << username;
+    // 同一个键被用于不同的请求，拒绝执行
+    if (query.value(0).toString() != fingerprint) {
+        qDebug() << "幂等键被不同请求复用:" << key;
+        success = false;
         return true;
     }
 
-    qDebug() << "用户认证失败:" << username;
+    success = query.value(1).toBool();
+    if (result) *result = query.value(2).toString();
+    qDebug() << "幂等重放:" << key << "原结果:" << success;
+    return true;
+}
+
+// 在当前事务中登记幂等键；返回 false 时调用方需回滚，duplicate 表示键已被并发请求占用
+bool DatabaseManager::claimIdempotencyKey(const QString& key, const QString& operation,
+                                          const QString& fingerprint, const QString& result,
+                                          bool& duplicate)
+{
+    return claimIdempotencyKey(*db, key, operation, fingerprint, result, duplicate);
+}
+
+bool DatabaseManager::claimIdempotencyKey(QSqlDatabase& connection, const QString& key,
+                                          const QString& operation, const QString& fingerprint,
+                                          const QString& result, bool& duplicate)
+{
+    duplicate = false;
+    if (key.isEmpty()) return true;
+
+    QSqlQuery query(connection);
+    query.prepare("INSERT INTO idempotency_keys (idem_key, operation, request_fingerprint, success, result) "
+                  "VALUES (:key, :operation, :fingerprint, 1, :result)");
+    query.bindValue(":key", key);
+    query.bindValue(":operation", operation);
+    query.bindValue(":fingerprint", fingerprint);
+    query.bindValue(":result", result);
+
+    if (SlowQueryLog::exec(query)) return true;
+
+    duplicate = query.lastError().nativeErrorCode() == "1062";
+    qDebug() << "登记幂等键失败:" << key << query.lastError().text();
     return false;
 }
 
-int DatabaseManager::getUserId(const QString& username)
+// 业务拒绝（余额不足、账户不存在等）也需登记，重放时返回同样的失败
+void DatabaseManager::recordRejectedRequest(const QString& key, const QString& operation,
+                                            const QString& fingerprint)
 {
-    if (!isConnected()) return -1;
+    recordRejectedRequest(*db, key, operation, fingerprint);
+}
+
+void DatabaseManager::recordRejectedRequest(QSqlDatabase& connection, const QString& key,
+                                            const QString& operation, const QString& fingerprint)
+{
+    if (key.isEmpty()) return;
+
+    QSqlQuery query(connection);
+    query.prepare("INSERT IGNORE INTO idempotency_keys (idem_key, operation, request_fingerprint, success) "
+                  "VALUES (:key, :operation, :fingerprint, 0)");
+    query.bindValue(":key", key);
+    query.bindValue(":operation", operation);
+    query.bindValue(":fingerprint", fingerprint);
+
+    if (!SlowQueryLog::exec(query)) {
+        qDebug() << "登记被拒绝请求失败:" << query.lastError().text();
+    }
+}
+
+// 分批删除过期幂等键，避免长时间持锁
+int DatabaseManager::purgeExpiredIdempotencyKeys(int ttlHours)
+{
+    if (!isConnected()) return 0;
 
     QSqlQuery query(*db);
-    query.prepare("SELECT user_id FROM users WHERE username = :username");
-    query.bindValue(":username", username);
+    query.prepare("DELETE FROM idempotency_keys "
+                  "WHERE created_at < DATE_SUB(NOW(), INTERVAL :ttl HOUR) LIMIT 5000");
+    query.bindValue(":ttl", ttlHours);
+
+    int purged = 0;
+    while (SlowQueryLog::exec(query)) {
+        const int affected = query.numRowsAffected();
+        purged += affected;
+        if (affected < 5000) break;
+    }
 
-    if (query.exec() && query.next()) {
-        return query.value(0).toInt();
+    if (query.lastError().isValid()) {
+        qDebug() << "清理幂等键失败:" << query.lastError().text();
+    } else if (purged > 0) {
+        qDebug() << "已清理过期幂等键:" << purged;
     }
+    return purged;
+}
 
-    return -1;
+bool DatabaseManager::authenticateUser(const QString& username, const QString& password)
+{
+    if (!isConnected()) {
+        qDebug() << "用户认证失败：数据库未连接";
+        return false;
+    }
+
+    int userId = -1;
+    QString storedHash;
+    QString role;
+    if (!getUserCredentials(username, userId, storedHash, role)
+        || !PasswordHasher::verify(password, storedHash)) {
+        qDebug() << "用户认证失败:" << username;
+        return false;
+    }
+
+    if (PasswordHasher::needsRehash(storedHash)) {
+        upgradePasswordHash(userId, storedHash, PasswordHasher::hash(password));
+    }
+
+    qDebug() << "用户认证成功:" << username;
+    return true;
 }
 
-bool DatabaseManager::createUser(const QString& username, const QString& password,
-                                 const QString& fullName, const QString& idCard,
-                                 const QString& phone , const QString& email )
+bool DatabaseManager::getUserCredentials(const QString& username, int& userId,
+                                         QString& passwordHash, QString& role)
 {
+    WorkloadTrace::Scope trace(WorkloadTrace::Credentials, [&]() { return QStringList{ username }; });
     if (!isConnected()) return false;
 
+    QSqlQuery* query = execCached(kSqlUserCredentials, { username });
+    if (!query) {
+        return false;
+    }
+
+    const bool found = query->next();
+    if (found) {
+        userId = query->value(0).toInt();
+        passwordHash = query->value(1).toString();
+        role = query->value(2).toString();
+    }
+    query->finish();
+    return trace.done(found);
+}
+
+bool DatabaseManager::upgradePasswordHash(int userId, const QString& previousHash, const QString& newHash)
+{
+    if (!isConnected() || newHash.isEmpty()) return false;
+
+    // 比较旧值，避免覆盖登录期间被修改的新密码
     QSqlQuery query(*db);
-    query.prepare("INSERT INTO users (username, password, full_name, id_card, phone, email) "
-                  "VALUES (:username, :password, :full_name, :id_card,:phone, :email)");
-    query.bindValue(":username", username);
-    query.bindValue(":password", password);
-    query.bindValue(":full_name", fullName);
-    query.bindValue(":id_card", idCard);
+    query.prepare("UPDATE users SET password = :new_hash "
+                  "WHERE user_id = :user_id AND password = :previous_hash");
+    query.bindValue(":new_hash", newHash);
+    query.bindValue(":user_id", userId);
+    query.bindValue(":previous_hash", previousHash);
+
+    if (!SlowQueryLog::exec(query)) {
+        qDebug() << "升级密码散列失败:" << query.lastError().text();
+        return false;
+    }
+
+    return query.numRowsAffected() == 1;
+}
+
+QString DatabaseManager::getUserRole(const QString& username)
+{
+    if (!isConnected()) return QString();
+
+    QString role;
+    if (QSqlQuery* query = execCached(kSqlUserRole, { username })) {
+        if (query->next()) role = query->value(0).toString();
+        query->finish();
+    }
+    return role;
+}
+
+int DatabaseManager::getUserId(const QString& username)
+{
+    if (!isConnected()) return -1;
+
+    QSqlQuery query(*db);
+    query.prepare("SELECT user_id FROM users WHERE username = :username");
+    query.bindValue(":username", username);
+
+    if (SlowQueryLog::exec(query) && query.next()) {
+        return query.value(0).toInt();
+    }
+
+    return -1;
+}
+
+bool DatabaseManager::createUser(const QString& username, const QString& password,
+                                 const QString& fullName, const QString& idCard,
+                                 const QString& phone , const QString& email,
+                                 const QString& idempotencyKey)
+{
+    if (!isConnected()) return false;
+
+    // 重放请求直接返回首次执行的结果
+    const QString fingerprint = requestFingerprint("createUser", { username, idCard });
+    bool replayed = false;
+    if (findIdempotentResult(idempotencyKey, fingerprint, replayed)) {
+        return replayed;
+    }
+
+    // 散列在事务外计算，不延长持锁时间
+    const QString passwordHash = PasswordHasher::hash(password);
+    if (passwordHash.isEmpty()) {
+        qDebug() << "密码散列失败";
+        return false;
+    }
+
+    if (!db->transaction()) {
+        qDebug() << "开始事务失败";
+        return false;
+    }
+
+    QSqlQuery query(*db);
+    query.prepare("INSERT INTO users (username, password, full_name, id_card, phone, email, role) "
+                  "VALUES (:username, :password, :full_name, :id_card,:phone, :email, 'customer')");
+    query.bindValue(":username", username);
+    query.bindValue(":password", passwordHash);
+    query.bindValue(":full_name", fullName);
+    query.bindValue(":id_card", idCard);
     query.bindValue(":phone", phone);
     query.bindValue(":email", email);
 
-    if (query.exec()) {
-        qDebug() << "用户创建成功:" << username;
-        return true;
+    if (!SlowQueryLog::exec(query)) {
+        db->rollback();
+        qDebug() << "用户创建失败:" << query.lastError().text();
+        return false;
+    }
+
+    // 幂等键与业务数据在同一事务中提交
+    bool duplicate = false;
+    if (!claimIdempotencyKey(idempotencyKey, "createUser", fingerprint, QString(), duplicate)) {
+        db->rollback();
+        return duplicate && findIdempotentResult(idempotencyKey, fingerprint, replayed) && replayed;
+    }
+
+    if (!db->commit()) {
+        qDebug() << "提交事务失败";
+        return false;
+    }
+
+    qDebug() << "用户创建成功:" << username;
+    return true;
+}
+
+QString DatabaseManager::createAccount(int userId, const QString& accountType,
+                                       const QString& idempotencyKey)
+{
+    if (!isConnected()) return QString();
+
+    // 重放请求返回首次创建的账户号
+    const QString fingerprint = requestFingerprint("createAccount", { QString::number(userId), accountType });
+    bool replayed = false;
+    QString replayedAccountId;
+    if (findIdempotentResult(idempotencyKey, fingerprint, replayed, &replayedAccountId)) {
+        return replayed ? replayedAccountId : QString();
+    }
+
+    QString accountId = generateAccountId();
+
+    if (!db->transaction()) {
+        qDebug() << "开始事务失败";
+        return QString();
+    }
+
+    QSqlQuery query(*db);
+    query.prepare("INSERT INTO accounts (account_id, user_id, account_type, balance) "
+                  "VALUES (:account_id, :user_id, " + Schema::accountTypeCodeSql(":account_type") + ", 0.00)");
+    query.bindValue(":account_id", Schema::accountKey(accountId));
+    query.bindValue(":user_id", userId);
+    query.bindValue(":account_type", accountType);
+
+    if (!SlowQueryLog::exec(query)) {
+        db->rollback();
+        qDebug() << "账户创建失败:" << query.lastError().text();
+        return QString();
+    }
+
+    bool duplicate = false;
+    if (!claimIdempotencyKey(idempotencyKey, "createAccount", fingerprint, accountId, duplicate)) {
+        db->rollback();
+        if (duplicate && findIdempotentResult(idempotencyKey, fingerprint, replayed, &replayedAccountId) && replayed) {
+            return replayedAccountId;
+        }
+        return QString();
+    }
+
+    if (!db->commit()) {
+        qDebug() << "提交事务失败";
+        return QString();
+    }
+
+    directory->upsert({ accountId, QString(), "正常" });
+    qDebug() << "账户创建成功:" << accountId << "用户ID:" << userId;
+    return accountId;
+}
+
+double DatabaseManager::getBalance(const QString& accountId)
+{
+    WorkloadTrace::Scope trace(WorkloadTrace::Balance, [&]() { return QStringList{ accountId }; });
+    if (!isConnected()) return 0.0;
+
+    AccountBalanceRow row;
+    if (fastPath->isAttached()) {
+        if (fastPath->readBalance(accountId, row)) {
+            if (row.found) return trace.done(Money::toYuan(row.balanceCents));
+            qDebug() << "获取余额失败，账户:" << accountId;
+            return 0.0;
+        }
+        reattachFastPath();
+    }
+
+    QSqlQuery* query = execCached(kSqlBalance, { Schema::accountKey(accountId) });
+    if (query && query->next()) {
+        const double balance = query->value(0).toDouble();
+        query->finish();
+        return trace.done(balance);
+    }
+
+    if (query) query->finish();
+    qDebug() << "获取余额失败，账户:" << accountId;
+    return 0.0;
+}
+
+bool DatabaseManager::getBalanceAsOf(const QString& accountId, const QDateTime& at, double& balance)
+{
+    if (!isConnected() || !at.isValid()) return false;
+
+    // 余额与流水在同一快照内读取
+    if (!db->transaction()) {
+        qDebug() << "开始事务失败";
+        return false;
+    }
+
+    QSqlQuery query(*db);
+    query.setForwardOnly(true);
+    query.setNumericalPrecisionPolicy(QSql::HighPrecision);
+
+    // checkpoint_date 为 D 的检查点是 D+1 零点的余额，取 at 之前最近的一个（走主键）
+    query.prepare("SELECT checkpoint_date, balance FROM balance_checkpoints "
+                  "WHERE account_id = :account_id AND checkpoint_date < :date "
+                  "ORDER BY checkpoint_date DESC LIMIT 1");
+    query.bindValue(":account_id", Schema::accountKey(accountId));
+    query.bindValue(":date", at.date());
+
+    qint64 cents = 0;
+    int sign = 1;
+    QDateTime from;
+    QDateTime to;
+    if (SlowQueryLog::exec(query) && query.next()) {
+        // 向后累加检查点之后、at 之前的流水
+        from = QDateTime(query.value(0).toDate().addDays(1), QTime(0, 0));
+        to = at;
+        cents = Money::toCents(query.value(1));
+    } else {
+        // at 之前没有检查点（at 在开户当天、回填尚未到达或早于回填下限）：从其后最近的检查点倒推
+        query.prepare("SELECT checkpoint_date, balance FROM balance_checkpoints "
+                      "WHERE account_id = :account_id AND checkpoint_date >= :date "
+                      "ORDER BY checkpoint_date LIMIT 1");
+        query.bindValue(":account_id", Schema::accountKey(accountId));
+        query.bindValue(":date", at.date());
+        if (SlowQueryLog::exec(query) && query.next()) {
+            to = QDateTime(query.value(0).toDate().addDays(1), QTime(0, 0));
+            cents = Money::toCents(query.value(1));
+        } else {
+            // 账户在最近一次检查点之后开立：当前余额减去 at 之后的流水，最多一两天
+            query.prepare("SELECT balance FROM accounts WHERE account_id = :account_id");
+            query.bindValue(":account_id", Schema::accountKey(accountId));
+            if (!SlowQueryLog::exec(query) || !query.next()) {
+                db->rollback();
+                return false;
+            }
+            cents = Money::toCents(query.value(0));
+        }
+        from = at;
+        sign = -1;
+    }
+
+    QString condition = "%1 = :account_id%2 AND transaction_time >= :from%2";
+    if (to.isValid()) condition += " AND transaction_time < :to%2";
+    query.prepare(Journal::postingTotalsSql(condition));
+    Journal::bindLegs(query, ":account_id", Schema::accountKey(accountId));
+    Journal::bindLegs(query, ":from", from);
+    if (to.isValid()) Journal::bindLegs(query, ":to", to);
+    if (!SlowQueryLog::exec(query)) {
+        qDebug() << "汇总流水失败:" << query.lastError().text();
+        db->rollback();
+        return false;
+    }
+    while (query.next()) {
+        cents += sign * Money::postingSign(query.value(1).toString()) * Money::toCents(query.value(2));
+    }
+
+    // 区间落在已归档的月份时补上归档文件中的流水
+    if (archiver) {
+        const QList<QVariantMap> archived = archiver->readArchivedHistory(*db, accountId, from, to);
+        for (const QVariantMap& record : archived) {
+            cents += sign * Money::postingSign(record["type"].toString()) * Money::toCents(record["amount"]);
+        }
+    }
+
+    db->commit();
+    balance = Money::toYuan(cents);
+    return true;
+}
+
+bool DatabaseManager::getBalanceAndType(const QString& accountId, double& balance, QString& accountType)
+{
+    WorkloadTrace::Scope trace(WorkloadTrace::BalanceAndType, [&]() { return QStringList{ accountId }; });
+    AccountBalanceRow row;
+    if (fastPath->isAttached()) {
+        if (fastPath->readBalance(accountId, row)) {
+            if (row.found) {
+                balance = Money::toYuan(row.balanceCents);
+                accountType = row.accountType;
+            }
+            return trace.done(row.found);
+        }
+        reattachFastPath();
+    }
+
+    QSqlQuery* query = execCached(kSqlBalanceAndType, { Schema::accountKey(accountId) });
+    if (!query) return false;
+
+    const bool found = query->next();
+    if (found) {
+        balance = query->value(0).toDouble();
+        accountType = query->value(1).toString();
+    }
+    query->finish();
+    return trace.done(found);
+}
+
+QString DatabaseManager::lastLimitViolation() const
+{
+    return limitViolation;
+}
+
+QString DatabaseManager::lastWriteError() const
+{
+    return writeError;
+}
+
+WriteRetryMetrics DatabaseManager::writeRetryMetrics() const
+{
+    return retryStats;
+}
+
+DatabaseManager::WriteAttempt DatabaseManager::runWithRetry(const char* operation, bool replayable,
+                                                            const std::function<WriteAttempt()>& attempt)
+{
+    writeError.clear();
+    QElapsedTimer budget;
+    budget.start();
+
+    for (int attemptNo = 1;; ++attemptNo) {
+        attemptError = DbError::None;
+        attemptCommitSent = false;
+        ++retryStats.attempts;
+
+        const WriteAttempt result = attempt();
+        if (result != WriteAttempt::Failed) return result;
+
+        const DbError::Kind kind = attemptError;
+        int delay = 0;
+        if (!retryAfterFailure(operation, replayable, attemptNo, budget.elapsed(), delay)) {
+            return WriteAttempt::Failed;
+        }
+        QThread::msleep(delay);
+
+        if (kind == DbError::ConnectionLost && !reopenConnection()) {
+            writeError = DbError::describe(kind);
+            return WriteAttempt::Failed;
+        }
+    }
+}
+
+void DatabaseManager::runWithRetryAsync(const char* operation, bool replayable,
+                                        const std::function<WriteAttempt()>& attempt,
+                                        std::function<void(WriteAttempt)> done)
+{
+    writeError.clear();
+    QElapsedTimer budget;
+    budget.start();
+    retryAsyncStep(operation, replayable, attempt, std::move(done), 1, budget);
+}
+
+void DatabaseManager::retryAsyncStep(const char* operation, bool replayable,
+                                     const std::function<WriteAttempt()>& attempt,
+                                     std::function<void(WriteAttempt)> done, int attemptNo, QElapsedTimer budget)
+{
+    WriteAttempt result;
+    {
+        DbWorkScheduler::Scope scope(dbWork, DbWorkScheduler::InteractiveWrite);
+        attemptError = DbError::None;
+        attemptCommitSent = false;
+        ++retryStats.attempts;
+        result = attempt();
+    }
+
+    const DbError::Kind kind = attemptError;
+    const bool commitSent = attemptCommitSent;
+    int delay = 0;
+    if (result != WriteAttempt::Failed || !retryAfterFailure(operation, replayable, attemptNo, budget.elapsed(), delay)) {
+        done(result);
+        return;
+    }
+
+    // 上一次尝试已回滚，退避期间主连接可以处理其他请求
+    QTimer::singleShot(delay, this, [=]() {
+        if (!isConnected() || (kind == DbError::ConnectionLost && !reopenConnection())) {
+            writeError = DbError::describe(kind);
+            attemptCommitSent = commitSent;   // 供 done 判断结果是否未知
+            done(WriteAttempt::Failed);
+            return;
+        }
+        retryAsyncStep(operation, replayable, attempt, done, attemptNo + 1, budget);
+    });
+}
+
+bool DatabaseManager::retryAfterFailure(const char* operation, bool replayable, int attemptNo, qint64 elapsedMs,
+                                        int& delay)
+{
+    const DbError::Kind kind = attemptError;
+    switch (kind) {
+    case DbError::Deadlock: ++retryStats.deadlocks; break;
+    case DbError::LockWaitTimeout: ++retryStats.lockWaitTimeouts; break;
+    case DbError::ConnectionLost: ++retryStats.connectionLosses; break;
+    case DbError::ConstraintViolation: ++retryStats.constraintViolations; break;
+    default: break;
+    }
+
+    // 提交已发出后连接中断：无法确定是否已提交，没有幂等键时不能重做
+    const bool ambiguous = kind == DbError::ConnectionLost && attemptCommitSent && !replayable;
+    if (!DbError::isRetryable(kind) || ambiguous) {
+        writeError = ambiguous ? QString("数据库连接中断，交易结果未知，请查询余额确认")
+                               : DbError::describe(kind);
+        return false;
+    }
+
+    delay = DbError::backoffMs(attemptNo, kWriteRetryBaseDelayMs, kWriteRetryMaxDelayMs);
+    if (attemptNo >= kWriteMaxAttempts || elapsedMs + delay > kWriteRetryBudgetMs) {
+        ++retryStats.exhausted;
+        writeError = DbError::describe(kind);
+        qDebug() << operation << "重试已用尽，共尝试" << attemptNo << "次";
+        return false;
+    }
+
+    ++retryStats.retries;
+    retryStats.backoffMs += delay;
+    qDebug() << operation << "第" << attemptNo << "次尝试失败，" << delay << "ms 后重试";
+    return true;
+}
+
+DatabaseManager::WriteAttempt DatabaseManager::failAttempt(const QSqlQuery& query, const char* what)
+{
+    attemptError = DbError::classify(query.lastError());
+    qDebug() << what << query.lastError().text();
+    db->rollback();
+    return WriteAttempt::Failed;
+}
+
+DatabaseManager::WriteAttempt DatabaseManager::failAttempt(const char* what)
+{
+    attemptError = DbError::classify(db->lastError());
+    qDebug() << what << db->lastError().text();
+    db->rollback();
+    return WriteAttempt::Failed;
+}
+
+DatabaseManager::WriteAttempt DatabaseManager::claimFailed(bool duplicate, const QString& key,
+                                                           const QString& fingerprint)
+{
+    db->rollback();
+    bool replayed = false;
+    if (!duplicate || !findIdempotentResult(key, fingerprint, replayed)) return WriteAttempt::Failed;
+    return replayed ? WriteAttempt::Replayed : WriteAttempt::Rejected;
+}
+
+DatabaseManager::WriteAttempt DatabaseManager::rollbackAttempt()
+{
+    db->rollback();
+    return WriteAttempt::Failed;
+}
+
+int DatabaseManager::execBalanceChange(const QString& accountId, qint64 cents, bool debit, const char* what)
+{
+    if (fastPath->isAttached()) {
+        const int affected = debit ? fastPath->debit(accountId, cents) : fastPath->credit(accountId, cents);
+        if (affected >= 0) return affected;
+        if (!reattachFastPath()) {
+            attemptError = DbError::classify(fastPath->lastErrorCode());
+            qDebug() << what << fastPath->lastErrorText();
+            return affected;
+        }
+    }
+
+    QSqlQuery query(*db);
+    if (debit) {
+        // 余额条件在行锁下判断，并发取款不会透支
+        query.prepare(QString("UPDATE accounts SET balance = balance - :amount "
+                              "WHERE account_id = :account_id AND balance >= :required AND status <> %1")
+                          .arg(Schema::Closed));
+        query.bindValue(":required", Money::toYuan(cents));
+    } else {
+        query.prepare(QString("UPDATE accounts SET balance = balance + :amount "
+                              "WHERE account_id = :account_id AND status <> %1").arg(Schema::Closed));
+    }
+    query.bindValue(":amount", Money::toYuan(cents));
+    query.bindValue(":account_id", Schema::accountKey(accountId));
+
+    if (!SlowQueryLog::exec(query)) {
+        attemptError = DbError::classify(query.lastError());
+        qDebug() << what << query.lastError().text();
+        return -1;
+    }
+    return query.numRowsAffected();
+}
+
+bool DatabaseManager::execLockTransferAccounts(const QString& fromAccount, const QString& toAccount,
+                                               bool& fromFound, bool& toFound, qint64& fromBalanceCents,
+                                               const char* what)
+{
+    fromFound = false;
+    toFound = false;
+    fromBalanceCents = 0;
+
+    if (fastPath->isAttached()) {
+        TransferLockRow row;
+        if (fastPath->lockTransferAccounts(fromAccount, toAccount, row)) {
+            fromFound = row.fromFound;
+            toFound = row.toFound;
+            fromBalanceCents = row.fromBalanceCents;
+            return true;
+        }
+        if (!reattachFastPath()) {
+            attemptError = DbError::classify(fastPath->lastErrorCode());
+            qDebug() << what << fastPath->lastErrorText();
+            return false;
+        }
+    }
+
+    // 按账户号顺序锁定双方账户行：相向的两笔转账按同一顺序加锁，排队而不是死锁
+    QSqlQuery query(*db);
+    query.prepare(QString("SELECT account_id, balance FROM accounts "
+                          "WHERE account_id IN (:from_account, :to_account) AND status <> %1 "
+                          "ORDER BY account_id FOR UPDATE").arg(Schema::Closed));
+    query.bindValue(":from_account", Schema::accountKey(fromAccount));
+    query.bindValue(":to_account", Schema::accountKey(toAccount));
+
+    if (!SlowQueryLog::exec(query)) {
+        attemptError = DbError::classify(query.lastError());
+        qDebug() << what << query.lastError().text();
+        return false;
+    }
+
+    while (query.next()) {
+        if (query.value(0).toString() == fromAccount) {
+            fromFound = true;
+            fromBalanceCents = Money::toCents(query.value(1));
+        } else {
+            toFound = true;
+        }
+    }
+    return true;
+}
+
+qint64 DatabaseManager::execInsertPosting(const QString& accountId, const QString& type, qint64 cents,
+                                          const QString& description, const char* what)
+{
+    if (fastPath->isAttached()) {
+        const qint64 transactionId = fastPath->insertPosting(accountId, type, cents, description);
+        if (transactionId > 0) return transactionId;
+        if (!reattachFastPath()) {
+            attemptError = DbError::classify(fastPath->lastErrorCode());
+            qDebug() << what << fastPath->lastErrorText();
+            return transactionId;
+        }
+    }
+
+    QSqlQuery query(*db);
+    query.prepare("INSERT INTO transactions (account_id, transaction_type, amount, description) "
+                  "VALUES (:account_id, :type, :amount, :description)");
+    query.bindValue(":account_id", Schema::accountKey(accountId));
+    query.bindValue(":type", Schema::transactionType(type));
+    query.bindValue(":amount", Money::toYuan(cents));
+    query.bindValue(":description", description);
+
+    if (!SlowQueryLog::exec(query)) {
+        attemptError = DbError::classify(query.lastError());
+        qDebug() << what << query.lastError().text();
+        return 0;
+    }
+    return query.lastInsertId().toLongLong();
+}
+
+qint64 DatabaseManager::execInsertTransfer(const QString& fromAccount, const QString& toAccount, qint64 cents,
+                                           const char* what)
+{
+    if (fastPath->isAttached()) {
+        const qint64 transactionId = fastPath->insertTransfer(fromAccount, toAccount, cents);
+        if (transactionId > 0) return transactionId;
+        if (!reattachFastPath()) {
+            attemptError = DbError::classify(fastPath->lastErrorCode());
+            qDebug() << what << fastPath->lastErrorText();
+            return transactionId;
+        }
+    }
+
+    // 一行记录转账的借贷两方，转入方的“收款”记录由 credit_account 读出
+    QSqlQuery query(*db);
+    query.prepare(QString("INSERT INTO transactions "
+                          "(account_id, transaction_type, amount, target_account, credit_account, description) "
+                          "VALUES (:from_account, %1, :amount, :to_account, :credit_account, '转账支出')")
+                      .arg(Schema::Transfer));
+    query.bindValue(":from_account", Schema::accountKey(fromAccount));
+    query.bindValue(":amount", Money::toYuan(cents));
+    query.bindValue(":to_account", Schema::accountKey(toAccount));
+    query.bindValue(":credit_account", Schema::accountKey(toAccount));
+
+    if (!SlowQueryLog::exec(query)) {
+        attemptError = DbError::classify(query.lastError());
+        qDebug() << what << query.lastError().text();
+        return 0;
+    }
+    return query.lastInsertId().toLongLong();
+}
+
+void DatabaseManager::setNativeFastPath(bool enabled)
+{
+    fastPathEnabled = enabled;
+    if (!enabled) {
+        fastPath->detach();
+    } else if (isConnected() && !fastPath->isAttached()) {
+        fastPath->attach(*db);
+    }
+}
+
+bool DatabaseManager::nativeFastPathActive() const
+{
+    return fastPath->isAttached();
+}
+
+// 语句被关闭（客户端库重连、服务器清理语句句柄）时执行并未发生，会话与事务仍然有效：
+// 在同一连接上重新预编译，本次调用改走 QSqlQuery；重新预编译失败则保持断开，等连接重建时再挂上
+bool DatabaseManager::reattachFastPath()
+{
+    if (DbError::classify(fastPath->lastErrorCode()) != DbError::StatementInvalidated) return false;
+
+    qDebug() << "原生快速通道语句已失效，重新预编译:" << fastPath->lastErrorText();
+    fastPath->detach();
+    if (fastPathEnabled) fastPath->attach(*db);
+    return true;
+}
+
+// 主连接中断后重新打开；预编译语句随连接失效，一并重建
+bool DatabaseManager::reopenConnection()
+{
+    clearStatementCache();
+    fastPath->detach();
+    db->close();
+    if (!db->open()) {
+        qDebug() << "重新连接数据库失败:" << db->lastError().text();
+        return false;
+    }
+    qDebug() << "数据库连接已重建";
+    prepareCommonStatements();
+    if (fastPathEnabled) fastPath->attach(*db);
+    return true;
+}
+
+QFuture<PostingResult> DatabaseManager::depositAsync(const QString& accountId, double amount,
+                                                    const QString& idempotencyKey)
+{
+    PostingRequest request;
+    request.kind = PostingRequest::Deposit;
+    request.accountId = accountId;
+    request.amount = amount;
+    request.idempotencyKey = idempotencyKey;
+    return submitPosting(request);
+}
+
+QFuture<PostingResult> DatabaseManager::withdrawAsync(const QString& accountId, double amount,
+                                                     const QString& idempotencyKey)
+{
+    PostingRequest request;
+    request.kind = PostingRequest::Withdraw;
+    request.accountId = accountId;
+    request.amount = amount;
+    request.idempotencyKey = idempotencyKey;
+    return submitPosting(request);
+}
+
+void DatabaseManager::depositAsync(const QString& accountId, double amount, QObject* context,
+                                   std::function<void(const PostingResult&)> done, const QString& idempotencyKey)
+{
+    if (coalescer || !isConnected() || amount <= 0) {
+        watchPosting(depositAsync(accountId, amount, idempotencyKey), context, std::move(done));
+        return;
+    }
+
+    // 未启用合并：在主连接上执行，重试的退避由定时器等待，不阻塞界面线程
+    writeError.clear();
+    const QStringList traced = { accountId, QString::number(amount, 'f', 2), idempotencyKey };
+    DbWorkScheduler::Scope scope(dbWork, DbWorkScheduler::InteractiveWrite);
+    runPlanAsync(WorkloadTrace::Deposit, traced, planDeposit(accountId, amount, idempotencyKey), context,
+                 [this, done](bool ok) {
+                     PostingResult result;
+                     result.success = ok;
+                     if (!ok) result.message = writeError;
+                     done(result);
+                 });
+}
+
+void DatabaseManager::withdrawAsync(const QString& accountId, double amount, QObject* context,
+                                    std::function<void(const PostingResult&)> done, const QString& idempotencyKey)
+{
+    if (coalescer || !isConnected() || amount <= 0) {
+        watchPosting(withdrawAsync(accountId, amount, idempotencyKey), context, std::move(done));
+        return;
+    }
+
+    writeError.clear();
+    const QStringList traced = { accountId, QString::number(amount, 'f', 2), idempotencyKey };
+    DbWorkScheduler::Scope scope(dbWork, DbWorkScheduler::InteractiveWrite);
+    WritePlan plan = planWithdraw(accountId, amount, idempotencyKey);
+    // 超限只在规划阶段判定，等待重试期间其他请求可能改写 limitViolation
+    const QString violation = limitViolation;
+    runPlanAsync(WorkloadTrace::Withdraw, traced, plan, context, [this, done, violation](bool ok) {
+        PostingResult result;
+        result.success = ok;
+        result.limitExceeded = !ok && !violation.isEmpty();
+        if (!ok) result.message = result.limitExceeded ? violation : writeError;
+        done(result);
+    });
+}
+
+void DatabaseManager::transferAsync(const QString& fromAccount, const QString& toAccount, double amount,
+                                    QObject* context, std::function<void(const PostingResult&)> done,
+                                    const QString& idempotencyKey)
+{
+    writeError.clear();
+    if (!isConnected() || amount <= 0 || fromAccount == toAccount) {
+        done(PostingResult());
+        return;
+    }
+
+    const QStringList traced = { fromAccount, toAccount, QString::number(amount, 'f', 2), idempotencyKey };
+    DbWorkScheduler::Scope scope(dbWork, DbWorkScheduler::InteractiveWrite);
+    WritePlan plan = planTransfer(fromAccount, toAccount, amount, idempotencyKey);
+    const QString violation = limitViolation;
+    runPlanAsync(WorkloadTrace::Transfer, traced, plan, context, [this, done, violation](bool ok) {
+        PostingResult result;
+        result.success = ok;
+        result.limitExceeded = !ok && !violation.isEmpty();
+        if (!ok) result.message = result.limitExceeded ? violation : writeError;
+        done(result);
+    });
+}
+
+void DatabaseManager::watchPosting(const QFuture<PostingResult>& future, QObject* context,
+                                   std::function<void(const PostingResult&)> done)
+{
+    // 结果在 context 所在线程回调，context 先销毁则不再回调
+    auto* watcher = new QFutureWatcher<PostingResult>(context);
+    connect(watcher, &QFutureWatcherBase::finished, context, [watcher, done]() {
+        done(watcher->result());
+        watcher->deleteLater();
+    });
+    watcher->setFuture(future);
+}
+
+QFuture<PostingResult> DatabaseManager::submitPosting(const PostingRequest& request)
+{
+    if (coalescer && request.amount > 0) {
+        return coalescer->submit(request);
+    }
+
+    PostingResult result;
+    if (request.amount <= 0) {
+        result.message = "金额无效";
+    } else if (!coalescer) {
+        // 未启用合并：在主连接上同步执行
+        if (request.kind == PostingRequest::Deposit) {
+            result.success = deposit(request.accountId, request.amount, request.idempotencyKey);
+        } else {
+            result.success = withdraw(request.accountId, request.amount, request.idempotencyKey);
+            result.limitExceeded = !limitViolation.isEmpty();
+            result.message = limitViolation;
+        }
+        if (!result.success && result.message.isEmpty()) result.message = writeError;
+    }
+
+    QFutureInterface<PostingResult> promise;
+    promise.reportStarted();
+    promise.reportResult(result);
+    promise.reportFinished();
+    return promise.future();
+}
+
+bool DatabaseManager::runPlan(const WritePlan& plan)
+{
+    if (plan.decided) return plan.success;
+    return plan.finish(runWithRetry(plan.operation, plan.replayable, plan.attempt));
+}
+
+void DatabaseManager::runPlanAsync(WorkloadTrace::Operation operation, const QStringList& arguments,
+                                   const WritePlan& plan, QObject* context, std::function<void(bool)> done)
+{
+    // 抓取负载时从提交计时到完成；context 先销毁时限额计数照常退回，只是不再回调
+    const qint64 tracedAt = WorkloadTrace::instance().elapsedUs();
+    QPointer<QObject> guard(context);
+    auto complete = [operation, arguments, tracedAt, guard, done](bool ok) {
+        WorkloadTrace::instance().record(operation, tracedAt, ok ? 1 : 0, arguments);
+        if (guard) done(ok);
+    };
+
+    if (plan.decided) {
+        complete(plan.success);
+        return;
+    }
+
+    const std::function<bool(WriteAttempt)> finish = plan.finish;
+    runWithRetryAsync(plan.operation, plan.replayable, plan.attempt, [finish, complete](WriteAttempt outcome) {
+        complete(finish(outcome));
+    });
+}
+
+bool DatabaseManager::deposit(const QString& accountId, double amount, const QString& idempotencyKey)
+{
+    WorkloadTrace::Scope trace(WorkloadTrace::Deposit, [&]() {
+        return QStringList{ accountId, QString::number(amount, 'f', 2), idempotencyKey };
+    });
+    // 只有后台线程的调用方等待合并提交的结果；主线程不能阻塞，直接在主连接上执行（界面走 depositAsync）
+    if (coalescer && QThread::currentThread() != thread()) {
+        if (amount <= 0) return false;
+        DbWorkScheduler::Scope scope(dbWork, DbWorkScheduler::InteractiveWrite);
+        return trace.done(depositAsync(accountId, amount, idempotencyKey).result().success);
+    }
+
+    writeError.clear();
+    if (!isConnected() || amount <= 0) return false;
+    DbWorkScheduler::Scope scope(dbWork, DbWorkScheduler::InteractiveWrite);
+    return trace.done(runPlan(planDeposit(accountId, amount, idempotencyKey)));
+}
+
+DatabaseManager::WritePlan DatabaseManager::planDeposit(const QString& accountId, double amount,
+                                                        const QString& idempotencyKey)
+{
+    WritePlan plan;
+    plan.operation = "存款";
+    plan.replayable = !idempotencyKey.isEmpty();
+
+    // 重放请求直接返回首次执行的结果
+    const QString fingerprint = requestFingerprint("deposit", { accountId, QString::number(amount, 'f', 2) });
+    bool replayed = false;
+    if (findIdempotentResult(idempotencyKey, fingerprint, replayed)) {
+        plan.decided = true;
+        plan.success = replayed;
+        return plan;
+    }
+
+    plan.attempt = [this, accountId, amount, idempotencyKey, fingerprint]() {
+        // 开始事务
+        if (!db->transaction()) {
+            return failAttempt("开始事务失败:");
+        }
+
+        // 更新余额
+        const int updated = execBalanceChange(accountId, Money::toCents(amount), false, "存款更新失败:");
+        if (updated < 0) {
+            return rollbackAttempt();
+        }
+
+        // transactions 为分区表无法使用外键，需自行确认账户存在
+        if (updated != 1) {
+            db->rollback();
+            qDebug() << "存款失败，账户不存在或已销户:" << accountId;
+            recordRejectedRequest(idempotencyKey, "deposit", fingerprint);
+            return WriteAttempt::Rejected;
+        }
+
+        // 记录交易
+        const qint64 transactionId = execInsertPosting(accountId, "存款", Money::toCents(amount), "存款操作",
+                                                       "存款交易记录失败:");
+        if (transactionId <= 0) {
+            return rollbackAttempt();
+        }
+
+        if (!appendOutboxEvent(*db, "posting", accountId, transactionId, "存款", amount, QString(), "存款操作")) {
+            return failAttempt("写入变更事件失败:");
+        }
+
+        // 幂等键与业务数据在同一事务中提交
+        bool duplicate = false;
+        if (!claimIdempotencyKey(idempotencyKey, "deposit", fingerprint, QString(), duplicate)) {
+            return claimFailed(duplicate, idempotencyKey, fingerprint);
+        }
+
+        attemptCommitSent = true;
+        if (!db->commit()) {
+            return failAttempt("提交事务失败:");
+        }
+        return WriteAttempt::Committed;
+    };
+
+    plan.finish = [accountId, amount](WriteAttempt outcome) {
+        if (outcome != WriteAttempt::Committed) return outcome == WriteAttempt::Replayed;
+        qDebug() << "存款成功，账户:" << accountId << "金额:" << amount;
+        return true;
+    };
+    return plan;
+}
+
+bool DatabaseManager::withdraw(const QString& accountId, double amount, const QString& idempotencyKey)
+{
+    WorkloadTrace::Scope trace(WorkloadTrace::Withdraw, [&]() {
+        return QStringList{ accountId, QString::number(amount, 'f', 2), idempotencyKey };
+    });
+    // 同 deposit：主线程的调用不等待合并提交
+    if (coalescer && QThread::currentThread() != thread()) {
+        if (amount <= 0) return false;
+        DbWorkScheduler::Scope scope(dbWork, DbWorkScheduler::InteractiveWrite);
+        return trace.done(withdrawAsync(accountId, amount, idempotencyKey).result().success);
+    }
+
+    writeError.clear();
+    if (!isConnected() || amount <= 0) return false;
+    DbWorkScheduler::Scope scope(dbWork, DbWorkScheduler::InteractiveWrite);
+    return trace.done(runPlan(planWithdraw(accountId, amount, idempotencyKey)));
+}
+
+DatabaseManager::WritePlan DatabaseManager::planWithdraw(const QString& accountId, double amount,
+                                                         const QString& idempotencyKey)
+{
+    WritePlan plan;
+    plan.operation = "取款";
+    plan.replayable = !idempotencyKey.isEmpty();
+    plan.decided = true;
+
+    // 重放请求直接返回首次执行的结果
+    const QString fingerprint = requestFingerprint("withdraw", { accountId, QString::number(amount, 'f', 2) });
+    bool replayed = false;
+    if (findIdempotentResult(idempotencyKey, fingerprint, replayed)) {
+        plan.success = replayed;
+        return plan;
+    }
+
+    // 检查余额是否充足
+    limitViolation.clear();
+    double balance = 0.0;
+    QString accountType;
+    getBalanceAndType(accountId, balance, accountType);
+    if (balance < amount) {
+        qDebug() << "余额不足，当前余额:" << balance << "需要:" << amount;
+        recordRejectedRequest(idempotencyKey, "withdraw", fingerprint);
+        return plan;
+    }
+
+    // 限额只读内存计数，检查的同时计入本次取款，未提交时退回
+    VelocityLimiter::Reservation reservation;
+    if (!limiter->reserve(accountId, accountType, VelocityLimiter::Withdraw, Money::toCents(amount), reservation,
+                          &limitViolation)) {
+        qDebug() << "取款超出限额:" << accountId << limitViolation;
+        recordRejectedRequest(idempotencyKey, "withdraw", fingerprint);
+        return plan;
+    }
+    plan.decided = false;
+
+    plan.attempt = [this, accountId, amount, idempotencyKey, fingerprint]() {
+        // 开始事务
+        if (!db->transaction()) {
+            return failAttempt("开始事务失败:");
+        }
+
+        // 更新余额；余额条件在行锁下判断，并发取款不会透支
+        const int updated = execBalanceChange(accountId, Money::toCents(amount), true, "取款更新失败:");
+        if (updated < 0) {
+            return rollbackAttempt();
+        }
+
+        if (updated != 1) {
+            db->rollback();
+            qDebug() << "取款失败，账户不存在、已销户或余额不足:" << accountId;
+            recordRejectedRequest(idempotencyKey, "withdraw", fingerprint);
+            return WriteAttempt::Rejected;
+        }
+
+        // 记录交易
+        const qint64 transactionId = execInsertPosting(accountId, "取款", Money::toCents(amount), "取款操作",
+                                                       "取款交易记录失败:");
+        if (transactionId <= 0) {
+            return rollbackAttempt();
+        }
+
+        if (!appendOutboxEvent(*db, "posting", accountId, transactionId, "取款", amount, QString(), "取款操作")) {
+            return failAttempt("写入变更事件失败:");
+        }
+
+        // 幂等键与业务数据在同一事务中提交
+        bool duplicate = false;
+        if (!claimIdempotencyKey(idempotencyKey, "withdraw", fingerprint, QString(), duplicate)) {
+            return claimFailed(duplicate, idempotencyKey, fingerprint);
+        }
+
+        attemptCommitSent = true;
+        if (!db->commit()) {
+            return failAttempt("提交事务失败:");
+        }
+        return WriteAttempt::Committed;
+    };
+
+    plan.finish = [this, accountId, amount, reservation](WriteAttempt outcome) {
+        if (outcome != WriteAttempt::Committed) {
+            // 提交已发出后连接中断时结果未知，保留计数
+            if (!(outcome == WriteAttempt::Failed && attemptCommitSent)) limiter->release(reservation);
+            return outcome == WriteAttempt::Replayed;
+        }
+        qDebug() << "取款成功，账户:" << accountId << "金额:" << amount;
+        return true;
+    };
+    return plan;
+}
+
+bool DatabaseManager::transfer(const QString& fromAccount, const QString& toAccount, double amount,
+                               const QString& idempotencyKey)
+{
+    WorkloadTrace::Scope trace(WorkloadTrace::Transfer, [&]() {
+        return QStringList{ fromAccount, toAccount, QString::number(amount, 'f', 2), idempotencyKey };
+    });
+    writeError.clear();
+    if (!isConnected() || amount <= 0 || fromAccount == toAccount) return false;
+    DbWorkScheduler::Scope scope(dbWork, DbWorkScheduler::InteractiveWrite);
+    return trace.done(runPlan(planTransfer(fromAccount, toAccount, amount, idempotencyKey)));
+}
+
+DatabaseManager::WritePlan DatabaseManager::planTransfer(const QString& fromAccount, const QString& toAccount,
+                                                         double amount, const QString& idempotencyKey)
+{
+    WritePlan plan;
+    plan.operation = "转账";
+    plan.replayable = !idempotencyKey.isEmpty();
+    plan.decided = true;
+
+    // 重放请求直接返回首次执行的结果
+    const QString fingerprint = requestFingerprint("transfer", { fromAccount, toAccount, QString::number(amount, 'f', 2) });
+    bool replayed = false;
+    if (findIdempotentResult(idempotencyKey, fingerprint, replayed)) {
+        plan.success = replayed;
+        return plan;
+    }
+
+    // 检查转出账户余额
+    limitViolation.clear();
+    double fromBalance = 0.0;
+    QString fromType;
+    getBalanceAndType(fromAccount, fromBalance, fromType);
+    if (fromBalance < amount) {
+        qDebug() << "转账余额不足，当前余额:" << fromBalance << "需要:" << amount;
+        recordRejectedRequest(idempotencyKey, "transfer", fingerprint);
+        return plan;
+    }
+
+    // 转入账户：目录近期同步过且没有该账户时直接拒绝，不访问数据库；
+    // 目录中存在时不再单独查询，由事务内锁定账户行时确认
+    if (directory->lookup(toAccount) == AccountDirectory::Absent) {
+        bool exists = false;
+        if (!directory->isFresh(kDirectoryTrustMs)) {
+            QSqlQuery checkQuery(*db);
+            checkQuery.prepare("SELECT COUNT(*) FROM accounts WHERE account_id = :to_account");
+            checkQuery.bindValue(":to_account", Schema::accountKey(toAccount));
+            exists = SlowQueryLog::exec(checkQuery) && checkQuery.next() && checkQuery.value(0).toInt() > 0;
+        }
+        if (!exists) {
+            qDebug() << "目标账户不存在:" << toAccount;
+            recordRejectedRequest(idempotencyKey, "transfer", fingerprint);
+            return plan;
+        }
+    }
+
+    // 限额检查的同时计入本次转账，未提交时退回
+    VelocityLimiter::Reservation reservation;
+    if (!limiter->reserve(fromAccount, fromType, VelocityLimiter::Transfer, Money::toCents(amount), reservation,
+                          &limitViolation)) {
+        qDebug() << "转账超出限额:" << fromAccount << limitViolation;
+        recordRejectedRequest(idempotencyKey, "transfer", fingerprint);
+        return plan;
+    }
+    plan.decided = false;
+
+    plan.attempt = [this, fromAccount, toAccount, amount, idempotencyKey, fingerprint]() {
+        // 开始事务
+        if (!db->transaction()) {
+            return failAttempt("开始事务失败:");
+        }
+
+        const qint64 cents = Money::toCents(amount);
+
+        // 按账户号顺序锁定双方账户行：相向的两笔转账按同一顺序加锁，排队而不是死锁
+        bool fromFound = false, toFound = false;
+        qint64 lockedBalance = 0;
+        if (!execLockTransferAccounts(fromAccount, toAccount, fromFound, toFound, lockedBalance,
+                                      "锁定转账账户失败:")) {
+            return rollbackAttempt();
+        }
+        if (!fromFound || !toFound || lockedBalance < cents) {
+            db->rollback();
+            qDebug() << "转账失败，账户不存在或余额不足:" << fromAccount << "->" << toAccount;
+            recordRejectedRequest(idempotencyKey, "transfer", fingerprint);
+            return WriteAttempt::Rejected;
+        }
+
+        // 双方账户行已锁定，余额与状态不会再变，两条更新都应恰好影响一行
+        if (execBalanceChange(fromAccount, cents, true, "转账支出更新失败:") != 1
+            || execBalanceChange(toAccount, cents, false, "转账收入更新失败:") != 1) {
+            return rollbackAttempt();
+        }
+
+        // 一行记录转账的借贷两方，转入方的“收款”记录由 credit_account 读出
+        const qint64 transactionId = execInsertTransfer(fromAccount, toAccount, cents, "转账记录失败:");
+        if (transactionId <= 0) {
+            return rollbackAttempt();
+        }
+
+        // 双方会话都会收到推送
+        if (!appendOutboxEvent(*db, "posting", fromAccount, transactionId, "转账", amount, toAccount, "转账支出")
+            || !appendOutboxEvent(*db, "posting", toAccount, transactionId, "收款", amount, fromAccount, "转账收入")) {
+            return failAttempt("写入变更事件失败:");
+        }
+
+        // 幂等键与业务数据在同一事务中提交
+        bool duplicate = false;
+        if (!claimIdempotencyKey(idempotencyKey, "transfer", fingerprint, QString(), duplicate)) {
+            return claimFailed(duplicate, idempotencyKey, fingerprint);
+        }
+
+        attemptCommitSent = true;
+        if (!db->commit()) {
+            return failAttempt("提交事务失败:");
+        }
+        return WriteAttempt::Committed;
+    };
+
+    plan.finish = [this, fromAccount, toAccount, amount, reservation](WriteAttempt outcome) {
+        if (outcome != WriteAttempt::Committed) {
+            if (!(outcome == WriteAttempt::Failed && attemptCommitSent)) limiter->release(reservation);
+            return outcome == WriteAttempt::Replayed;
+        }
+        qDebug() << "转账成功:" << fromAccount << "->" << toAccount << "金额:" << amount;
+        return true;
+    };
+    return plan;
+}
+
+QDateTime ScheduledTransfer::occurrence(int index) const
+{
+    const int step = index * qMax(1, intervalCount);
+    if (frequency == "daily") return startAt.addDays(step);
+    if (frequency == "weekly") return startAt.addDays(7 * step);
+    if (frequency == "monthly") return startAt.addMonths(step);
+    return index == 0 ? startAt : QDateTime();  // once
+}
+
+qint64 DatabaseManager::createScheduledTransfer(const ScheduledTransfer& order, const QString& idempotencyKey)
+{
+    if (!isConnected() || order.amountCents <= 0 || order.fromAccount == order.toAccount
+        || !order.startAt.isValid()) return 0;
+
+    static const QStringList frequencies = { "once", "daily", "weekly", "monthly" };
+    if (!frequencies.contains(order.frequency)) return 0;
+
+    // 重放请求返回首次创建的指令号
+    const QString fingerprint = requestFingerprint("createScheduledTransfer",
+                                                   { order.fromAccount, order.toAccount,
+                                                     Money::toDecimalString(order.amountCents), order.frequency,
+                                                     QString::number(order.intervalCount),
+                                                     order.startAt.toString(Qt::ISODate) });
+    bool replayed = false;
+    QString replayedOrderId;
+    if (findIdempotentResult(idempotencyKey, fingerprint, replayed, &replayedOrderId)) {
+        return replayed ? replayedOrderId.toLongLong() : 0;
+    }
+
+    if (!db->transaction()) {
+        qDebug() << "开始事务失败";
+        return 0;
+    }
+
+    QSqlQuery query(*db);
+    query.prepare("INSERT INTO scheduled_transfers (from_account, to_account, amount, description, frequency, "
+                  "interval_count, start_at, end_at, max_runs, next_run_at) "
+                  "SELECT :from_account, :to_account, :amount, :description, :frequency, "
+                  ":interval_count, :start_at, :end_at, :max_runs, :next_run_at "
+                  "FROM accounts WHERE account_id = :check_account");
+    query.bindValue(":from_account", Schema::accountKey(order.fromAccount));
+    query.bindValue(":to_account", Schema::accountKey(order.toAccount));
+    query.bindValue(":amount", Money::toDecimalString(order.amountCents));
+    query.bindValue(":description", order.description.isEmpty() ? QVariant() : QVariant(order.description));
+    query.bindValue(":frequency", order.frequency);
+    query.bindValue(":interval_count", qMax(1, order.intervalCount));
+    query.bindValue(":start_at", order.startAt);
+    query.bindValue(":end_at", order.endAt.isValid() ? QVariant(order.endAt) : QVariant());
+    query.bindValue(":max_runs", order.maxRuns > 0 ? QVariant(order.maxRuns) : QVariant());
+    query.bindValue(":next_run_at", order.startAt);
+    query.bindValue(":check_account", Schema::accountKey(order.toAccount));
+
+    if (!SlowQueryLog::exec(query)) {
+        db->rollback();
+        qDebug() << "定期转账创建失败:" << query.lastError().text();
+        return 0;
+    }
+
+    // 目标账户不存在时不插入
+    if (query.numRowsAffected() != 1) {
+        db->rollback();
+        qDebug() << "定期转账创建失败，目标账户不存在:" << order.toAccount;
+        recordRejectedRequest(idempotencyKey, "createScheduledTransfer", fingerprint);
+        return 0;
+    }
+
+    const qint64 orderId = query.lastInsertId().toLongLong();
+
+    bool duplicate = false;
+    if (!claimIdempotencyKey(idempotencyKey, "createScheduledTransfer", fingerprint,
+                             QString::number(orderId), duplicate)) {
+        db->rollback();
+        if (duplicate && findIdempotentResult(idempotencyKey, fingerprint, replayed, &replayedOrderId) && replayed) {
+            return replayedOrderId.toLongLong();
+        }
+        return 0;
+    }
+
+    if (!db->commit()) {
+        qDebug() << "提交事务失败";
+        return 0;
+    }
+
+    qDebug() << "定期转账创建成功:" << orderId << order.fromAccount << "->" << order.toAccount;
+    emit scheduledTransferChanged(orderId);
+    return orderId;
+}
+
+bool DatabaseManager::cancelScheduledTransfer(qint64 orderId, const QString& idempotencyKey)
+{
+    if (!isConnected()) return false;
+
+    const QString fingerprint = requestFingerprint("cancelScheduledTransfer", { QString::number(orderId) });
+    bool replayed = false;
+    if (findIdempotentResult(idempotencyKey, fingerprint, replayed)) {
+        return replayed;
+    }
+
+    if (!db->transaction()) {
+        qDebug() << "开始事务失败";
+        return false;
+    }
+
+    QSqlQuery query(*db);
+    query.prepare("UPDATE scheduled_transfers SET status = 'cancelled' "
+                  "WHERE order_id = :order_id AND status IN ('active', 'paused')");
+    query.bindValue(":order_id", orderId);
+
+    if (!SlowQueryLog::exec(query)) {
+        db->rollback();
+        qDebug() << "定期转账取消失败:" << query.lastError().text();
+        return false;
+    }
+
+    if (query.numRowsAffected() != 1) {
+        db->rollback();
+        qDebug() << "定期转账取消失败，指令不存在或已结束:" << orderId;
+        recordRejectedRequest(idempotencyKey, "cancelScheduledTransfer", fingerprint);
+        return false;
+    }
+
+    bool duplicate = false;
+    if (!claimIdempotencyKey(idempotencyKey, "cancelScheduledTransfer", fingerprint, QString(), duplicate)) {
+        db->rollback();
+        return duplicate && findIdempotentResult(idempotencyKey, fingerprint, replayed) && replayed;
+    }
+
+    if (!db->commit()) {
+        qDebug() << "提交事务失败";
+        return false;
+    }
+
+    qDebug() << "定期转账已取消:" << orderId;
+    emit scheduledTransferChanged(orderId);
+    return true;
+}
+
+QList<QVariantMap> DatabaseManager::getScheduledTransfers(const QString& accountId)
+{
+    QList<QVariantMap> orders;
+
+    if (!isConnected()) return orders;
+
+    QSqlQuery query(*db);
+    query.prepare("SELECT order_id, to_account, amount, frequency, interval_count, next_run_at, "
+                  "runs_done, status, description "
+                  "FROM scheduled_transfers WHERE from_account = :account_id "
+                  "ORDER BY status = 'active' DESC, next_run_at");
+    query.bindValue(":account_id", Schema::accountKey(accountId));
+
+    if (SlowQueryLog::exec(query)) {
+        while (query.next()) {
+            QVariantMap order;
+            order["order_id"] = query.value(0);
+            order["to_account"] = query.value(1).toString();
+            order["amount"] = query.value(2);
+            order["frequency"] = query.value(3);
+            order["interval_count"] = query.value(4);
+            order["next_run_at"] = query.value(5);
+            order["runs_done"] = query.value(6);
+            order["status"] = query.value(7);
+            order["description"] = query.value(8);
+            orders.append(order);
+        }
+    } else {
+        qDebug() << "获取定期转账失败:" << query.lastError().text();
+    }
+
+    return orders;
+}
+
+QList<QVariantMap> DatabaseManager::getScheduledTransferRuns(qint64 orderId, int limit)
+{
+    QList<QVariantMap> runs;
+
+    if (!isConnected()) return runs;
+
+    QSqlQuery query(*db);
+    query.prepare(QString("SELECT due_at, executed_at, outcome, transaction_id, message "
+                          "FROM scheduled_transfer_runs WHERE order_id = :order_id "
+                          "ORDER BY due_at DESC LIMIT %1").arg(qBound(1, limit, 1000)));
+    query.bindValue(":order_id", orderId);
+
+    if (SlowQueryLog::exec(query)) {
+        while (query.next()) {
+            QVariantMap run;
+            run["due_at"] = query.value(0);
+            run["executed_at"] = query.value(1);
+            run["outcome"] = query.value(2);
+            run["transaction_id"] = query.value(3);
+            run["message"] = query.value(4);
+            runs.append(run);
+        }
+    } else {
+        qDebug() << "获取定期转账执行记录失败:" << query.lastError().text();
+    }
+
+    return runs;
+}
+
+bool DatabaseManager::postScheduledTransfer(QSqlDatabase& connection, const ScheduledTransfer& order,
+                                            VelocityLimiter* limiter, VelocityLimiter::Reservation& reservation,
+                                            ScheduledRunResult& result, QString& error)
+{
+    QSqlQuery query(connection);
+
+    // 按账户号顺序加锁，与其他批次保持一致的加锁顺序
+    query.prepare("SELECT a.account_id, a.balance, a.status, t.type_name FROM accounts a "
+                  "LEFT JOIN account_types t ON t.type_code = a.account_type "
+                  "WHERE a.account_id IN (:from_account, :to_account) ORDER BY a.account_id FOR UPDATE OF a");
+    query.bindValue(":from_account", Schema::accountKey(order.fromAccount));
+    query.bindValue(":to_account", Schema::accountKey(order.toAccount));
+    if (!SlowQueryLog::exec(query)) {
+        error = query.lastError().nativeErrorCode();
+        result.message = query.lastError().text();
+        return false;
+    }
+
+    qint64 fromBalance = 0;
+    QString fromType;
+    bool fromFound = false, toFound = false, frozen = false, closed = false;
+    while (query.next()) {
+        const QString accountId = query.value(0).toString();
+        const int status = query.value(2).toInt();
+        if (status == Schema::Closed) closed = true;
+        else if (status != Schema::Active) frozen = true;
+        if (accountId == order.fromAccount) {
+            fromFound = true;
+            fromBalance = Money::toCents(query.value(1));
+            fromType = query.value(3).toString();
+        } else {
+            toFound = true;
+        }
+    }
+
+    if (!fromFound || !toFound) {
+        result.outcome = "account_missing";
+        result.message = !fromFound ? "转出账户不存在" : "目标账户不存在";
+        return true;
+    }
+    // 销户不可恢复，由调用方取消指令；冻结可能解除，按失败计数
+    if (closed) {
+        result.outcome = "account_closed";
+        result.message = "账户已销户";
+        return true;
+    }
+    if (frozen) {
+        result.outcome = "account_frozen";
+        result.message = "账户已冻结";
+        return true;
+    }
+    if (fromBalance < order.amountCents) {
+        result.outcome = "insufficient_funds";
+        result.message = QString("余额不足，当前余额 %1").arg(Money::toDecimalString(fromBalance));
+        return true;
+    }
+    // 与界面发起的转账共用限额计数；超限按失败计，下一期再试
+    if (limiter && !limiter->reserve(order.fromAccount, fromType, VelocityLimiter::Transfer, order.amountCents,
+                                     reservation, &result.message)) {
+        result.outcome = "limit_exceeded";
+        return true;
+    }
+
+    const QString description = order.description.isEmpty()
+                                    ? QString("定期转账 #%1").arg(order.orderId)
+                                    : order.description;
+
+    const QString amount = Money::toDecimalString(order.amountCents);
+    query.prepare("UPDATE accounts SET balance = balance - :amount WHERE account_id = :account_id");
+    query.bindValue(":amount", amount);
+    query.bindValue(":account_id", Schema::accountKey(order.fromAccount));
+    if (!SlowQueryLog::exec(query)) {
+        error = query.lastError().nativeErrorCode();
+        result.message = query.lastError().text();
+        return false;
+    }
+
+    query.prepare("UPDATE accounts SET balance = balance + :amount WHERE account_id = :account_id");
+    query.bindValue(":amount", amount);
+    query.bindValue(":account_id", Schema::accountKey(order.toAccount));
+    if (!SlowQueryLog::exec(query)) {
+        error = query.lastError().nativeErrorCode();
+        result.message = query.lastError().text();
+        return false;
+    }
+
+    query.prepare(QString("INSERT INTO transactions "
+                          "(account_id, transaction_type, amount, target_account, credit_account, description) "
+                          "VALUES (:account_id, %1, :amount, :target, :credit_account, :description)")
+                      .arg(Schema::Transfer));
+    query.bindValue(":account_id", Schema::accountKey(order.fromAccount));
+    query.bindValue(":amount", amount);
+    query.bindValue(":target", Schema::accountKey(order.toAccount));
+    query.bindValue(":credit_account", Schema::accountKey(order.toAccount));
+    query.bindValue(":description", description);
+    if (!SlowQueryLog::exec(query)) {
+        error = query.lastError().nativeErrorCode();
+        result.message = query.lastError().text();
+        return false;
+    }
+    const QVariant transactionId = query.lastInsertId();
+
+    if (!appendOutboxEvent(connection, "posting", order.fromAccount, transactionId, "转账",
+                           Money::toYuan(order.amountCents), order.toAccount, description)
+        || !appendOutboxEvent(connection, "posting", order.toAccount, transactionId, "收款",
+                              Money::toYuan(order.amountCents), order.fromAccount, description)) {
+        result.message = "写入变更事件失败";
+        return false;
+    }
+
+    result.outcome = "success";
+    result.transactionId = transactionId.toLongLong();
+    return true;
+}
+
+bool DatabaseManager::executeScheduledTransfers(QSqlDatabase& connection,
+                                                const QList<ScheduledTransfer>& orders,
+                                                VelocityLimiter* limiter,
+                                                QList<ScheduledRunResult>& results)
+{
+    const int kMaxConsecutiveFailures = 3;  // 连续失败后暂停指令，等待人工处理
+
+    if (!connection.transaction()) {
+        qDebug() << "开始事务失败:" << connection.lastError().text();
+        return false;
+    }
+
+    QList<ScheduledRunResult> executed;
+    // 已计入限额的转出：整个事务回滚时全部退回
+    QVector<VelocityLimiter::Reservation> reservations;
+    auto rollbackBatch = [&]() {
+        connection.rollback();
+        if (limiter) {
+            for (const VelocityLimiter::Reservation& reservation : reservations) limiter->release(reservation);
+        }
+    };
+    QSqlQuery query(connection);
+
+    for (const ScheduledTransfer& order : orders) {
+        // 锁定指令行并确认本期仍待执行：可能已被取消，或已由其他调度进程执行
+        query.prepare("SELECT status, next_run_at, runs_done, consecutive_failures "
+                      "FROM scheduled_transfers WHERE order_id = :order_id FOR UPDATE");
+        query.bindValue(":order_id", order.orderId);
+        if (!SlowQueryLog::exec(query)) {
+            qDebug() << "读取定期转账失败:" << query.lastError().text();
+            rollbackBatch();
+            return false;
+        }
+        if (!query.next() || query.value(0).toString() != "active"
+            || query.value(1).toDateTime() != order.dueAt) {
+            continue;
+        }
+        const int runsDone = query.value(2).toInt();
+        int failures = query.value(3).toInt();
+
+        if (!SlowQueryLog::exec(query, "SAVEPOINT scheduled_order")) {
+            rollbackBatch();
+            return false;
+        }
+
+        ScheduledRunResult result;
+        result.orderId = order.orderId;
+        result.dueAt = order.dueAt;
+
+        QString error;
+        VelocityLimiter::Reservation reservation;
+        if (!postScheduledTransfer(connection, order, limiter, reservation, result, error)) {
+            if (limiter) limiter->release(reservation);
+            // 死锁或锁等待超时：整个事务已失效，交给调用方拆批重试
+            if (DbError::isLockConflict(error)) {
+                qDebug() << "定期转账批次冲突，回滚:" << result.message;
+                rollbackBatch();
+                return false;
+            }
+            SlowQueryLog::exec(query, "ROLLBACK TO SAVEPOINT scheduled_order");
+            result.outcome = "error";
+        } else if (result.outcome == "success") {
+            reservations.append(reservation);
+        }
+
+        // 转出或转入账户已销户（或已清理）：以后各期都不可能成功，取消指令而不是反复重试
+        const bool cancelled = result.outcome == "account_closed" || result.outcome == "account_missing";
+        failures = result.outcome == "success" ? 0 : failures + 1;
+
+        // 推进到下一期；单次指令、达到次数或超过截止时间即结束
+        ScheduledTransfer next = order;
+        const QDateTime nextRunAt = next.occurrence(runsDone + 1);
+        const bool finished = cancelled
+                              || !nextRunAt.isValid()
+                              || (order.maxRuns > 0 && runsDone + 1 >= order.maxRuns)
+                              || (order.endAt.isValid() && nextRunAt > order.endAt);
+        result.orderStatus = cancelled ? "cancelled"
+                                       : finished ? "completed"
+                                                  : (failures >= kMaxConsecutiveFailures ? "paused" : "active");
+        result.nextRunAt = finished ? QDateTime() : nextRunAt;
+
+        query.prepare("INSERT INTO scheduled_transfer_runs (order_id, due_at, outcome, transaction_id, message) "
+                      "VALUES (:order_id, :due_at, :outcome, :transaction_id, :message)");
+        query.bindValue(":order_id", order.orderId);
+        query.bindValue(":due_at", order.dueAt);
+        query.bindValue(":outcome", result.outcome);
+        query.bindValue(":transaction_id", result.transactionId > 0 ? QVariant(result.transactionId) : QVariant());
+        query.bindValue(":message", result.message.isEmpty() ? QVariant() : QVariant(result.message.left(200)));
+        const bool logged = SlowQueryLog::exec(query);
+
+        query.prepare("UPDATE scheduled_transfers SET runs_done = runs_done + 1, last_run_at = NOW(), "
+                      "next_run_at = :next_run_at, status = :status, consecutive_failures = :failures "
+                      "WHERE order_id = :order_id");
+        query.bindValue(":next_run_at", finished ? QVariant(order.dueAt) : QVariant(nextRunAt));
+        query.bindValue(":status", result.orderStatus);
+        query.bindValue(":failures", failures);
+        query.bindValue(":order_id", order.orderId);
+
+        if (!logged || !SlowQueryLog::exec(query) || !SlowQueryLog::exec(query, "RELEASE SAVEPOINT scheduled_order")) {
+            qDebug() << "记录定期转账结果失败:" << query.lastError().text();
+            rollbackBatch();
+            return false;
+        }
+
+        executed.append(result);
+    }
+
+    if (!connection.commit()) {
+        qDebug() << "提交定期转账批次失败:" << connection.lastError().text();
+        rollbackBatch();
+        return false;
+    }
+
+    results.append(executed);
+    return true;
+}
+
+bool DatabaseManager::postPosting(QSqlDatabase& connection, const PostingRequest& request,
+                                  VelocityLimiter* limiter, VelocityLimiter::Reservation& reservation,
+                                  PostingResult& result, QString& error)
+{
+    const bool isDeposit = request.kind == PostingRequest::Deposit;
+    const qint64 cents = Money::toCents(request.amount);
+    QSqlQuery query(connection);
+
+    if (!isDeposit) {
+        // 锁定账户行后检查余额与限额；同批中更早的取款已计入余额，也已计入限额
+        query.prepare(QString("SELECT a.balance, t.type_name FROM accounts a "
+                              "LEFT JOIN account_types t ON t.type_code = a.account_type "
+                              "WHERE a.account_id = :account_id AND a.status <> %1 FOR UPDATE OF a")
+                          .arg(Schema::Closed));
+        query.bindValue(":account_id", Schema::accountKey(request.accountId));
+        if (!SlowQueryLog::exec(query)) {
+            error = query.lastError().nativeErrorCode();
+            result.message = query.lastError().text();
+            return false;
+        }
+        if (!query.next()) {
+            result.message = "账户不存在";
+            return true;
+        }
+        const qint64 balance = Money::toCents(query.value(0));
+        if (balance < cents) {
+            result.message = QString("余额不足，当前余额 %1").arg(Money::toDecimalString(balance));
+            return true;
+        }
+        if (limiter && !limiter->reserve(request.accountId, query.value(1).toString(), VelocityLimiter::Withdraw,
+                                         cents, reservation, &result.message)) {
+            result.limitExceeded = true;
+            return true;
+        }
+    }
+
+    // 已销户的账户交易记录正在清理，不再入账
+    query.prepare(QString("UPDATE accounts SET balance = balance %1 :amount "
+                          "WHERE account_id = :account_id AND status <> %2")
+                      .arg(isDeposit ? "+" : "-")
+                      .arg(Schema::Closed));
+    query.bindValue(":amount", request.amount);
+    query.bindValue(":account_id", Schema::accountKey(request.accountId));
+    if (!SlowQueryLog::exec(query)) {
+        error = query.lastError().nativeErrorCode();
+        result.message = query.lastError().text();
+        return false;
+    }
+    if (query.numRowsAffected() != 1) {
+        result.message = "账户不存在";
+        return true;
+    }
+
+    const QString type = isDeposit ? "存款" : "取款";
+    const QString description = isDeposit ? "存款操作" : "取款操作";
+    query.prepare("INSERT INTO transactions (account_id, transaction_type, amount, description) "
+                  "VALUES (:account_id, :type, :amount, :description)");
+    query.bindValue(":account_id", Schema::accountKey(request.accountId));
+    query.bindValue(":type", Schema::transactionType(type));
+    query.bindValue(":amount", request.amount);
+    query.bindValue(":description", description);
+    if (!SlowQueryLog::exec(query)) {
+        error = query.lastError().nativeErrorCode();
+        result.message = query.lastError().text();
+        return false;
+    }
+    const QVariant transactionId = query.lastInsertId();
+
+    if (!appendOutboxEvent(connection, "posting", request.accountId, transactionId, type,
+                           request.amount, QString(), description)) {
+        result.message = "写入变更事件失败";
+        return false;
     }
 
-    qDebug() << "用户创建失败:" << query.lastError().text();
-    return false;
+    result.success = true;
+    result.transactionId = transactionId.toLongLong();
+    return true;
 }
 
-QString DatabaseManager::createAccount(int userId, const QString& accountType)
+bool DatabaseManager::executePostingBatch(QSqlDatabase& connection, const QList<PostingRequest>& requests,
+                                          VelocityLimiter* limiter, QList<PostingResult>& results,
+                                          DbError::Kind& error, bool& commitSent)
 {
-    if (!isConnected()) return QString();
+    error = DbError::None;
+    commitSent = false;
+
+    // 按账户号顺序加锁，与其他批次保持一致的加锁顺序；同一账户的请求保持提交顺序
+    QVector<int> order(requests.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&requests](int a, int b) {
+        return requests.at(a).accountId < requests.at(b).accountId;
+    });
+
+    if (!connection.transaction()) {
+        error = DbError::classify(connection.lastError());
+        qDebug() << "开始事务失败:" << connection.lastError().text();
+        return false;
+    }
 
-    QString accountId = generateAccountId();
+    QVector<PostingResult> executed(requests.size());
+    // 本批已计入限额的取款：整个事务回滚时全部退回，结果未知（提交后连接中断）时保留
+    QVector<VelocityLimiter::Reservation> reservations;
+    auto rollbackBatch = [&]() {
+        connection.rollback();
+        if (limiter) {
+            for (const VelocityLimiter::Reservation& reservation : reservations) limiter->release(reservation);
+        }
+    };
+    QSqlQuery query(connection);
+
+    for (int index : order) {
+        const PostingRequest& request = requests.at(index);
+        PostingResult& result = executed[index];
+        const QString operation = request.kind == PostingRequest::Deposit ? "deposit" : "withdraw";
+        const QString fingerprint = requestFingerprint(operation, { request.accountId,
+                                                                    QString::number(request.amount, 'f', 2) });
+
+        // 重放请求（含本批中更早的同键请求）直接返回首次执行的结果
+        bool replayed = false;
+        if (findIdempotentResult(connection, request.idempotencyKey, fingerprint, replayed)) {
+            result.success = replayed;
+            result.replayed = true;
+            continue;
+        }
 
-    QSqlQuery query(*db);
-    query.prepare("INSERT INTO accounts (account_id, user_id, account_type, balance) "
-                  "VALUES (:account_id, :user_id, :account_type, 0.00)");
-    query.bindValue(":account_id", accountId);
-    query.bindValue(":user_id", userId);
-    query.bindValue(":account_type", accountType);
+        if (!SlowQueryLog::exec(query, "SAVEPOINT posting")) {
+            error = DbError::classify(query.lastError());
+            rollbackBatch();
+            return false;
+        }
 
-    if (query.exec()) {
-        qDebug() << "账户创建成功:" << accountId << "用户ID:" << userId;
-        return accountId;
+        QString errorCode;
+        VelocityLimiter::Reservation reservation;
+        bool posted = postPosting(connection, request, limiter, reservation, result, errorCode);
+        if (!posted && DbError::isLockConflict(errorCode)) {
+            // 死锁或锁等待超时：整个事务已失效，交给调用方拆批重试
+            error = DbError::classify(errorCode);
+            qDebug() << "合并提交批次冲突，回滚:" << result.message;
+            if (limiter) limiter->release(reservation);
+            rollbackBatch();
+            return false;
+        }
+
+        // 幂等键与业务数据在同一保存点内登记
+        bool duplicate = false;
+        if (posted && result.success
+            && !claimIdempotencyKey(connection, request.idempotencyKey, operation, fingerprint, QString(), duplicate)) {
+            posted = false;
+            result = PostingResult();
+        }
+
+        if (!posted || !result.success) {
+            SlowQueryLog::exec(query, "ROLLBACK TO SAVEPOINT posting");
+            if (limiter) limiter->release(reservation);
+            if (duplicate) {
+                // 键已被其他客户端并发占用，返回其结果
+                result.replayed = findIdempotentResult(connection, request.idempotencyKey, fingerprint, replayed);
+                result.success = result.replayed && replayed;
+            } else if (posted) {
+                qDebug() << "合并提交被拒绝:" << request.accountId << result.message;
+                recordRejectedRequest(connection, request.idempotencyKey, operation, fingerprint);
+            } else {
+                qDebug() << "合并提交失败:" << request.accountId << result.message;
+            }
+        } else {
+            reservations.append(reservation);
+        }
+
+        if (!SlowQueryLog::exec(query, "RELEASE SAVEPOINT posting")) {
+            error = DbError::classify(query.lastError());
+            qDebug() << "释放保存点失败:" << query.lastError().text();
+            rollbackBatch();
+            return false;
+        }
+    }
+
+    if (!connection.commit()) {
+        error = DbError::classify(connection.lastError());
+        commitSent = error == DbError::ConnectionLost;
+        qDebug() << "提交合并批次失败:" << connection.lastError().text();
+        if (commitSent) {
+            connection.rollback();
+        } else {
+            rollbackBatch();
+        }
+        return false;
     }
 
-    qDebug() << "账户创建失败:" << query.lastError().text();
-    return QString();
+    for (const PostingResult& result : executed) results.append(result);
+    return true;
 }
 
-double DatabaseManager::getBalance(const QString& accountId)
+// 冻结账户
+bool DatabaseManager::freezeAccount(const QString& accountId, const QString& idempotencyKey)
 {
-    if (!isConnected()) return 0.0;
+    return changeAccountsStatus("freezeAccount", { accountId }, "正常", "冻结", idempotencyKey) == 1;
+}
 
-    QSqlQuery query(*db);
-    query.prepare("SELECT balance FROM accounts WHERE account_id = :account_id");
-    query.bindValue(":account_id", accountId);
+// 解冻账户
+bool DatabaseManager::unfreezeAccount(const QString& accountId, const QString& idempotencyKey)
+{
+    return changeAccountsStatus("unfreezeAccount", { accountId }, "冻结", "正常", idempotencyKey) == 1;
+}
 
-    if (query.exec() && query.next()) {
-        return query.value(0).toDouble();
-    }
+int DatabaseManager::freezeAccounts(const QStringList& accountIds, const QString& idempotencyKey)
+{
+    return changeAccountsStatus("freezeAccounts", accountIds, "正常", "冻结", idempotencyKey);
+}
 
-    qDebug() << "获取余额失败，账户:" << accountId << "错误:" << query.lastError().text();
-    return 0.0;
+int DatabaseManager::unfreezeAccounts(const QStringList& accountIds, const QString& idempotencyKey)
+{
+    return changeAccountsStatus("unfreezeAccounts", accountIds, "冻结", "正常", idempotencyKey);
 }
 
-bool DatabaseManager::deposit(const QString& accountId, double amount)
+int DatabaseManager::changeAccountsStatus(const QString& operation, const QStringList& accountIds,
+                                          const QString& fromStatus, const QString& toStatus,
+                                          const QString& idempotencyKey)
 {
-    if (!isConnected() || amount <= 0) return false;
+    if (!isConnected()) return -1;
+
+    // 去重并排序：指纹与选择顺序无关，加锁顺序与转账一致
+    QStringList ids = accountIds;
+    ids.removeAll(QString());
+    ids.removeDuplicates();
+    std::sort(ids.begin(), ids.end());
+    if (ids.isEmpty()) return 0;
+
+    // 重放请求直接返回首次执行的结果
+    const QString fingerprint = requestFingerprint(operation, ids);
+    bool replayed = false;
+    QString previousCount;
+    if (findIdempotentResult(idempotencyKey, fingerprint, replayed, &previousCount)) {
+        return replayed ? previousCount.toInt() : -1;
+    }
 
-    // 开始事务
     if (!db->transaction()) {
         qDebug() << "开始事务失败";
-        return false;
+        return -1;
     }
 
     QSqlQuery query(*db);
 
-    // 更新余额
-    query.prepare("UPDATE accounts SET balance = balance + :amount "
-                  "WHERE account_id = :account_id");
-    query.bindValue(":amount", amount);
-    query.bindValue(":account_id", accountId);
+    // 只锁定仍处于原状态的账户；已是目标状态或已销户的跳过
+    query.prepare("SELECT account_id FROM accounts WHERE account_id IN (" + listPlaceholders("id", ids.size())
+                  + ") AND status = :from_status ORDER BY account_id FOR UPDATE");
+    bindAccountList(query, "id", ids);
+    query.bindValue(":from_status", Schema::accountStatus(fromStatus));
 
-    if (!query.exec()) {
+    if (!SlowQueryLog::exec(query)) {
         db->rollback();
-        qDebug() << "存款更新失败:" << query.lastError().text();
-        return false;
+        qDebug() << "锁定账户失败:" << query.lastError().text();
+        return -1;
     }
 
-    // 记录交易
-    query.prepare("INSERT INTO transactions (account_id, transaction_type, amount, description) "
-                  "VALUES (:account_id, '存款', :amount, '存款操作')");
-    query.bindValue(":account_id", accountId);
-    query.bindValue(":amount", amount);
+    QStringList changed;
+    while (query.next()) changed << query.value(0).toString();
+
+    if (!changed.isEmpty()) {
+        const QString inList = listPlaceholders("id", changed.size());
+        query.prepare("UPDATE accounts SET status = :to_status, status_changed_at = CURRENT_TIMESTAMP "
+                      "WHERE account_id IN (" + inList + ")");
+        query.bindValue(":to_status", Schema::accountStatus(toStatus));
+        bindAccountList(query, "id", changed);
+
+        if (!SlowQueryLog::exec(query)) {
+            db->rollback();
+            qDebug() << "账户状态更新失败:" << query.lastError().text();
+            return -1;
+        }
+
+        // 每个账户一条状态事件，同样由一条语句写入
+        query.prepare("INSERT INTO outbox_events (event_type, account_id, balance_after, account_status) "
+                      "SELECT 'status', account_id, balance, status FROM accounts "
+                      "WHERE account_id IN (" + inList + ")");
+        bindAccountList(query, "id", changed);
+
+        if (!SlowQueryLog::exec(query) || query.numRowsAffected() != changed.size()) {
+            db->rollback();
+            qDebug() << "写入变更事件失败:" << query.lastError().text();
+            return -1;
+        }
+    }
 
-    if (!query.exec()) {
+    // 幂等键与业务数据在同一事务中提交，结果记录实际变更的账户数
+    bool duplicate = false;
+    if (!claimIdempotencyKey(idempotencyKey, operation, fingerprint, QString::number(changed.size()), duplicate)) {
         db->rollback();
-        qDebug() << "存款交易记录失败:" << query.lastError().text();
-        return false;
+        if (duplicate && findIdempotentResult(idempotencyKey, fingerprint, replayed, &previousCount) && replayed) {
+            return previousCount.toInt();
+        }
+        return -1;
     }
 
     if (!db->commit()) {
         qDebug() << "提交事务失败";
-        return false;
+        return -1;
     }
 
-    qDebug() << "存款成功，账户:" << accountId << "金额:" << amount;
-    return true;
+    for (const QString& accountId : changed) {
+        directory->upsert({ accountId, QString(), toStatus });
+    }
+    qDebug() << "账户状态已改为" << toStatus << "：" << changed.size() << "/" << ids.size();
+    return changed.size();
 }
 
-bool DatabaseManager::withdraw(const QString& accountId, double amount)
+// 销户：只在事务内改状态、取消该账户的定期转账，交易记录由 AccountPurger 分批清理，
+// 不在一个事务里删除全部流水
+bool DatabaseManager::deleteAccount(const QString& accountId, const QString& idempotencyKey)
 {
-    if (!isConnected() || amount <= 0) return false;
+    if (!isConnected()) return false;
 
-    // 检查余额是否充足
-    double balance = getBalance(accountId);
-    if (balance < amount) {
-        qDebug() << "余额不足，当前余额:" << balance << "需要:" << amount;
-        return false;
+    // 重放请求直接返回首次执行的结果
+    const QString fingerprint = requestFingerprint("deleteAccount", { accountId });
+    bool replayed = false;
+    if (findIdempotentResult(idempotencyKey, fingerprint, replayed)) {
+        return replayed;
     }
 
-    // 开始事务
     if (!db->transaction()) {
         qDebug() << "开始事务失败";
         return false;
     }
 
     QSqlQuery query(*db);
+    query.prepare(QString("UPDATE accounts SET status = %1, status_changed_at = CURRENT_TIMESTAMP "
+                          "WHERE account_id = :account_id AND status <> %1").arg(Schema::Closed));
+    query.bindValue(":account_id", Schema::accountKey(accountId));
 
-    // 更新余额
-    query.prepare("UPDATE accounts SET balance = balance - :amount "
-                  "WHERE account_id = :account_id");
-    query.bindValue(":amount", amount);
-    query.bindValue(":account_id", accountId);
+    if (!SlowQueryLog::exec(query)) {
+        db->rollback();
+        qDebug() << "账户销户失败:" << query.lastError().text();
+        return false;
+    }
 
-    if (!query.exec()) {
+    if (query.numRowsAffected() != 1) {
         db->rollback();
-        qDebug() << "取款更新失败:" << query.lastError().text();
+        qDebug() << "销户失败，账户不存在或已销户:" << accountId;
+        recordRejectedRequest(idempotencyKey, "deleteAccount", fingerprint);
         return false;
     }
 
-    // 记录交易
-    query.prepare("INSERT INTO transactions (account_id, transaction_type, amount, description) "
-                  "VALUES (:account_id, '取款', :amount, '取款操作')");
-    query.bindValue(":account_id", accountId);
-    query.bindValue(":amount", amount);
+    query.prepare("UPDATE scheduled_transfers SET status = 'cancelled' "
+                  "WHERE (from_account = :from_account OR to_account = :to_account) "
+                  "AND status IN ('active', 'paused')");
+    query.bindValue(":from_account", Schema::accountKey(accountId));
+    query.bindValue(":to_account", Schema::accountKey(accountId));
+
+    if (!SlowQueryLog::exec(query)) {
+        db->rollback();
+        qDebug() << "取消定期转账失败:" << query.lastError().text();
+        return false;
+    }
 
-    if (!query.exec()) {
+    if (!appendOutboxEvent(*db, "status", accountId)) {
         db->rollback();
-        qDebug() << "取款交易记录失败:" << query.lastError().text();
         return false;
     }
 
+    // 幂等键与业务数据在同一事务中提交
+    bool duplicate = false;
+    if (!claimIdempotencyKey(idempotencyKey, "deleteAccount", fingerprint, QString(), duplicate)) {
+        db->rollback();
+        return duplicate && findIdempotentResult(idempotencyKey, fingerprint, replayed) && replayed;
+    }
+
     if (!db->commit()) {
         qDebug() << "提交事务失败";
         return false;
     }
 
-    qDebug() << "取款成功，账户:" << accountId << "金额:" << amount;
+    directory->upsert({ accountId, QString(), "已销户" });
+    if (purger) QMetaObject::invokeMethod(purger, "runPurge", Qt::QueuedConnection);
+    qDebug() << "账户已销户，交易记录等待后台清理:" << accountId;
     return true;
 }
 
-bool DatabaseManager::transfer(const QString& fromAccount, const QString& toAccount, double amount)
+// 删除用户
+bool DatabaseManager::deleteUser(int userId, const QString& idempotencyKey)
 {
-    if (!isConnected() || amount <= 0 || fromAccount == toAccount) return false;
+    if (!isConnected()) return false;
 
-    // 检查转出账户余额
-    double fromBalance = getBalance(fromAccount);
-    if (fromBalance < amount) {
-        qDebug() << "转账余额不足，当前余额:" << fromBalance << "需要:" << amount;
-        return false;
+    // 重放请求直接返回首次执行的结果
+    const QString fingerprint = requestFingerprint("deleteUser", { QString::number(userId) });
+    bool replayed = false;
+    if (findIdempotentResult(idempotencyKey, fingerprint, replayed)) {
+        return replayed;
     }
 
-    // 检查转入账户是否存在
+    // 先检查是否有账户
     QSqlQuery checkQuery(*db);
-    checkQuery.prepare("SELECT COUNT(*) FROM accounts WHERE account_id = :to_account");
-    checkQuery.bindValue(":to_account", toAccount);
-    if (!checkQuery.exec() || !checkQuery.next() || checkQuery.value(0).toInt() == 0) {
-        qDebug() << "目标账户不存在:" << toAccount;
+    checkQuery.prepare("SELECT COUNT(*) FROM accounts WHERE user_id = :user_id");
+    checkQuery.bindValue(":user_id", userId);
+
+    if (SlowQueryLog::exec(checkQuery) && checkQuery.next() && checkQuery.value(0).toInt() > 0) {
+        qDebug() << "用户有账户，不能删除";
+        recordRejectedRequest(idempotencyKey, "deleteUser", fingerprint);
         return false;
     }
 
-    // 开始事务
     if (!db->transaction()) {
         qDebug() << "开始事务失败";
         return false;
     }
 
     QSqlQuery query(*db);
+    query.prepare("DELETE FROM users WHERE user_id = :user_id");
+    query.bindValue(":user_id", userId);
 
-    // 减少转出账户余额
-    query.prepare("UPDATE accounts SET balance = balance - :amount "
-                  "WHERE account_id = :from_account");
-    query.bindValue(":amount", amount);
-    query.bindValue(":from_account", fromAccount);
-
-    if (!query.exec()) {
+    if (!SlowQueryLog::exec(query)) {
         db->rollback();
-        qDebug() << "转账支出更新失败:" << query.lastError().text();
+        qDebug() << "用户删除失败:" << query.lastError().text();
         return false;
     }
 
-    // 增加转入账户余额
-    query.prepare("UPDATE accounts SET balance = balance + :amount "
-                  "WHERE account_id = :to_account");
-    query.bindValue(":amount", amount);
-    query.bindValue(":to_account", toAccount);
-
-    if (!query.exec()) {
+    // 幂等键与业务数据在同一事务中提交
+    bool duplicate = false;
+    if (!claimIdempotencyKey(idempotencyKey, "deleteUser", fingerprint, QString(), duplicate)) {
         db->rollback();
-        qDebug() << "转账收入更新失败:" << query.lastError().text();
+        return duplicate && findIdempotentResult(idempotencyKey, fingerprint, replayed) && replayed;
+    }
+
+    if (!db->commit()) {
+        qDebug() << "提交事务失败";
         return false;
     }
 
-    // 记录转出交易
-    query.prepare("INSERT INTO transactions (account_id, transaction_type, amount, target_account, description) "
-                  "VALUES (:from_account, '转账', :amount, :to_account, '转账支出')");
-    query.bindValue(":from_account", fromAccount);
-    query.bindValue(":amount", amount);
-    query.bindValue(":to_account", toAccount);
+    qDebug() << "用户删除成功:" << userId;
+    return true;
+}
 
-    if (!query.exec()) {
-        db->rollback();
-        qDebug() << "转账支出记录失败:" << query.lastError().text();
+// 修改密码
+bool DatabaseManager::updateUserPassword(const QString& username, const QString& newPassword,
+                                         const QString& idempotencyKey)
+{
+    if (!isConnected()) return false;
+
+    // 同一幂等键换了新密码重放时须判为冲突，所以指纹包含新密码；幂等表只存以幂等键为密钥的 HMAC-SHA256 摘要，
+    // 每个键的摘要各不相同，不能用一张预先算好的表反查，且随幂等键一起过期清理
+    const QByteArray passwordDigest = QMessageAuthenticationCode::hash(newPassword.toUtf8(), idempotencyKey.toUtf8(),
+                                                                        QCryptographicHash::Sha256);
+    const QString fingerprint = requestFingerprint("updateUserPassword",
+                                                   { username, QString::fromLatin1(passwordDigest.toHex()) });
+    bool replayed = false;
+    if (findIdempotentResult(idempotencyKey, fingerprint, replayed)) {
+        return replayed;
+    }
+
+    const QString passwordHash = PasswordHasher::hash(newPassword);
+    if (passwordHash.isEmpty()) {
+        qDebug() << "密码散列失败";
         return false;
     }
 
-    // 记录转入交易
-    query.prepare("INSERT INTO transactions (account_id, transaction_type, amount, target_account, description) "
-                  "VALUES (:to_account, '收款', :amount, :from_account, '转账收入')");
-    query.bindValue(":to_account", toAccount);
-    query.bindValue(":amount", amount);
-    query.bindValue(":from_account", fromAccount);
+    if (!db->transaction()) {
+        qDebug() << "开始事务失败";
+        return false;
+    }
+
+    QSqlQuery query(*db);
+    query.prepare("UPDATE users SET password = :password WHERE username = :username");
+    query.bindValue(":password", passwordHash);
+    query.bindValue(":username", username);
 
-    if (!query.exec()) {
+    if (!SlowQueryLog::exec(query)) {
         db->rollback();
-        qDebug() << "转账收入记录失败:" << query.lastError().text();
+        qDebug() << "密码修改失败:" << query.lastError().text();
         return false;
     }
 
+    // 幂等键与业务数据在同一事务中提交
+    bool duplicate = false;
+    if (!claimIdempotencyKey(idempotencyKey, "updateUserPassword", fingerprint, QString(), duplicate)) {
+        db->rollback();
+        return duplicate && findIdempotentResult(idempotencyKey, fingerprint, replayed) && replayed;
+    }
+
     if (!db->commit()) {
         qDebug() << "提交事务失败";
         return false;
     }
 
-    qDebug() << "转账成功:" << fromAccount << "->" << toAccount << "金额:" << amount;
+    qDebug() << "密码修改成功:" << username;
     return true;
 }
 
-// 冻结账户
-bool DatabaseManager::freezeAccount(const QString& accountId)
+QList<QVariantMap> DatabaseManager::searchUsers(const AdminListFilter& filter, int limit)
 {
-    if (!isConnected()) return false;
-
-    QSqlQuery query(*db);
-    query.prepare("UPDATE accounts SET status = '冻结' WHERE account_id = :account_id");
-    query.bindValue(":account_id", accountId);
-
-    if (query.exec()) {
-        qDebug() << "账户冻结成功:" << accountId;
-        return true;
-    }
+    if (!isConnected()) return QList<QVariantMap>();
 
-    qDebug() << "账户冻结失败:" << query.lastError().text();
-    return false;
+    DbWorkScheduler::Scope scope(dbWork, DbWorkScheduler::InteractiveRead);
+    return readUsersPage(*db, filter, limit);
 }
 
-// 解冻账户
-bool DatabaseManager::unfreezeAccount(const QString& accountId)
+void DatabaseManager::searchUsersAsync(const AdminListFilter& filter, int limit, QObject* context,
+                                       std::function<void(const QList<QVariantMap>&)> done)
 {
-    if (!isConnected()) return false;
-
-    QSqlQuery query(*db);
-    query.prepare("UPDATE accounts SET status = '正常' WHERE account_id = :account_id");
-    query.bindValue(":account_id", accountId);
-
-    if (query.exec()) {
-        qDebug() << "账户解冻成功:" << accountId;
-        return true;
+    if (!dbWork) {
+        done(QList<QVariantMap>());
+        return;
     }
 
-    qDebug() << "账户解冻失败:" << query.lastError().text();
-    return false;
+    // 每页都是索引范围扫描，按交互读取排队
+    dbWork->submit<QList<QVariantMap>>(
+        DbWorkScheduler::InteractiveRead, context,
+        [filter, limit](QSqlDatabase& connection) { return readUsersPage(connection, filter, limit); },
+        done);
 }
 
-// 删除账户
-bool DatabaseManager::deleteAccount(const QString& accountId)
+QList<QVariantMap> DatabaseManager::searchAccounts(const AdminListFilter& filter, int limit)
 {
-    if (!isConnected()) return false;
+    if (!isConnected()) return QList<QVariantMap>();
 
-    QSqlQuery query(*db);
-    query.prepare("DELETE FROM accounts WHERE account_id = :account_id");
-    query.bindValue(":account_id", accountId);
+    DbWorkScheduler::Scope scope(dbWork, DbWorkScheduler::InteractiveRead);
+    return readAccountsPage(*db, filter, limit);
+}
 
-    if (query.exec()) {
-        qDebug() << "账户删除成功:" << accountId;
-        return true;
+void DatabaseManager::searchAccountsAsync(const AdminListFilter& filter, int limit, QObject* context,
+                                          std::function<void(const QList<QVariantMap>&)> done)
+{
+    if (!dbWork) {
+        done(QList<QVariantMap>());
+        return;
     }
 
-    qDebug() << "账户删除失败:" << query.lastError().text();
-    return false;
+    dbWork->submit<QList<QVariantMap>>(
+        DbWorkScheduler::InteractiveRead, context,
+        [filter, limit](QSqlDatabase& connection) { return readAccountsPage(connection, filter, limit); },
+        done);
 }
 
-// 获取所有用户（管理员用）
-QList<QVariantMap> DatabaseManager::getAllUsers()
+QList<QVariantMap> DatabaseManager::readUsersPage(QSqlDatabase& connection, const AdminListFilter& filter, int limit)
 {
     QList<QVariantMap> users;
 
-    if (!isConnected()) return users;
+    // 注册时间可为空且不唯一，按自增的 user_id 排序即为注册顺序，直接走主键
+    const QString column = filter.sortColumn == "username" ? "username" : "user_id";
+    const QString direction = filter.descending ? "DESC" : "ASC";
 
-    QSqlQuery query(*db);
-    query.prepare("SELECT user_id, username, full_name, id_card, phone, email, created_at "
-                  "FROM users ORDER BY created_at DESC");
+    QStringList conditions;
+    if (!filter.search.isEmpty()) {
+        // 三个前缀条件各自走 username、id_card、idx_users_phone 索引（index merge）
+        conditions << "(username LIKE :search1 OR id_card LIKE :search2 OR phone LIKE :search3)";
+    }
+    const bool paged = filter.cursorId.isValid();
+    if (paged) conditions << keysetCondition(column, "user_id", filter.descending);
+
+    QString sql = "SELECT user_id, username, full_name, id_card, phone, email, created_at, role FROM users ";
+    if (!conditions.isEmpty()) sql += "WHERE " + conditions.join(" AND ") + " ";
+    sql += QString("ORDER BY %1 %2, user_id %2 LIMIT %3").arg(column, direction).arg(limit);
+
+    QSqlQuery query(connection);
+    query.setForwardOnly(true);
+    query.prepare(sql);
+    if (!filter.search.isEmpty()) {
+        const QString pattern = likePrefix(filter.search);
+        query.bindValue(":search1", pattern);
+        query.bindValue(":search2", pattern);
+        query.bindValue(":search3", pattern);
+    }
+    if (paged) {
+        query.bindValue(":cursor_value", filter.cursorValue);
+        query.bindValue(":cursor_value2", filter.cursorValue);
+        query.bindValue(":cursor_id", filter.cursorId);
+    }
 
-    if (query.exec()) {
-        while (query.next()) {
-            QVariantMap user;
-            user["user_id"] = query.value(0);
-            user["username"] = query.value(1);
-            user["full_name"] = query.value(2);
-            user["id_card"] = query.value(3);
-            user["phone"] = query.value(4);
-            user["email"] = query.value(5);
-            user["created_at"] = query.value(6);
-            users.append(user);
-        }
-        qDebug() << "获取到" << users.size() << "个用户";
-    } else {
+    if (!SlowQueryLog::exec(query)) {
         qDebug() << "获取用户列表失败:" << query.lastError().text();
+        return users;
     }
 
+    while (query.next()) {
+        QVariantMap user;
+        user["user_id"] = query.value(0);
+        user["username"] = query.value(1);
+        user["full_name"] = query.value(2);
+        user["id_card"] = query.value(3);
+        user["phone"] = query.value(4);
+        user["email"] = query.value(5);
+        user["created_at"] = query.value(6);
+        user["role"] = query.value(7);
+        users.append(user);
+    }
     return users;
 }
 
-// 删除用户
-bool DatabaseManager::deleteUser(int userId)
+QList<QVariantMap> DatabaseManager::readAccountsPage(QSqlDatabase& connection, const AdminListFilter& filter, int limit)
 {
-    if (!isConnected()) return false;
-
-    // 先检查是否有账户
-    QSqlQuery checkQuery(*db);
-    checkQuery.prepare("SELECT COUNT(*) FROM accounts WHERE user_id = :user_id");
-    checkQuery.bindValue(":user_id", userId);
-
-    if (checkQuery.exec() && checkQuery.next() && checkQuery.value(0).toInt() > 0) {
-        qDebug() << "用户有账户，不能删除";
-        return false;
-    }
-
-    QSqlQuery query(*db);
-    query.prepare("DELETE FROM users WHERE user_id = :user_id");
-    query.bindValue(":user_id", userId);
+    QList<QVariantMap> accounts;
 
-    if (query.exec()) {
-        qDebug() << "用户删除成功:" << userId;
-        return true;
+    // 排序列固定取白名单，不拼接调用方传入的列名
+    QString column = "a.created_at";
+    if (filter.sortColumn == "account_id") column = "a.account_id";
+    else if (filter.sortColumn == "balance") column = "a.balance";
+    const QString direction = filter.descending ? "DESC" : "ASC";
+
+    // 全数字按账户号前缀（主键上 18、19 位两段范围扫描），否则按用户名前缀（users.username → idx_accounts_user_id）
+    bool byAccountId = !filter.search.isEmpty();
+    for (const QChar c : filter.search) {
+        if (!c.isDigit()) {
+            byAccountId = false;
+            break;
+        }
     }
+    const QVariantList prefixBounds = byAccountId ? Schema::accountPrefixBounds(filter.search) : QVariantList();
 
-    qDebug() << "用户删除失败:" << query.lastError().text();
-    return false;
-}
-
-// 修改密码
-bool DatabaseManager::updateUserPassword(const QString& username, const QString& newPassword)
-{
-    if (!isConnected()) return false;
-
-    QSqlQuery query(*db);
-    query.prepare("UPDATE users SET password = :password WHERE username = :username");
-    query.bindValue(":password", newPassword);
-    query.bindValue(":username", username);
-
-    if (query.exec()) {
-        qDebug() << "密码修改成功:" << username;
-        return true;
+    QStringList conditions;
+    if (!filter.status.isEmpty()) conditions << "a.status = :status";
+    if (!filter.search.isEmpty()) {
+        conditions << (byAccountId ? Schema::accountPrefixSql("a.account_id", ":search", prefixBounds.size() / 2)
+                                   : QString("u.username LIKE :search"));
     }
+    const bool paged = filter.cursorId.isValid();
+    if (paged) conditions << keysetCondition(column, "a.account_id", filter.descending);
 
-    qDebug() << "密码修改失败:" << query.lastError().text();
-    return false;
-}
-
-// 获取所有账户（管理员用）
-QList<QVariantMap> DatabaseManager::getAllAccounts()
-{
-    QList<QVariantMap> accounts;
-
-    if (!isConnected()) return accounts;
-
-    QSqlQuery query(*db);
-    query.prepare("SELECT a.account_id, u.username, a.account_type, a.balance, a.status, a.created_at "
+    QString sql = "SELECT a.account_id, u.username, t.type_name, a.balance, "
+                  + Schema::accountStatusSql("a.status") + ", a.created_at "
                   "FROM accounts a "
                   "JOIN users u ON a.user_id = u.user_id "
-                  "ORDER BY a.created_at DESC");
+                  "LEFT JOIN account_types t ON t.type_code = a.account_type ";
+    if (!conditions.isEmpty()) sql += "WHERE " + conditions.join(" AND ") + " ";
+    if (column == "a.account_id") {
+        sql += QString("ORDER BY a.account_id %1 LIMIT %2").arg(direction).arg(limit);
+    } else {
+        sql += QString("ORDER BY %1 %2, a.account_id %2 LIMIT %3").arg(column, direction).arg(limit);
+    }
 
-    if (query.exec()) {
-        while (query.next()) {
-            QVariantMap account;
-            account["account_id"] = query.value(0);
-            account["username"] = query.value(1);
-            account["account_type"] = query.value(2);
-            account["balance"] = query.value(3);
-            account["status"] = query.value(4);
-            account["created_at"] = query.value(5);
-            accounts.append(account);
+    QSqlQuery query(connection);
+    query.setForwardOnly(true);
+    query.prepare(sql);
+    if (!filter.status.isEmpty()) query.bindValue(":status", Schema::accountStatus(filter.status));
+    if (byAccountId) {
+        for (int i = 0; i < prefixBounds.size() / 2; ++i) {
+            query.bindValue(QString(":search_lo%1").arg(i), prefixBounds.at(2 * i));
+            query.bindValue(QString(":search_hi%1").arg(i), prefixBounds.at(2 * i + 1));
         }
-        qDebug() << "获取到" << accounts.size() << "个账户";
-    } else {
+    } else if (!filter.search.isEmpty()) {
+        query.bindValue(":search", likePrefix(filter.search));
+    }
+    if (paged) {
+        // 按账户号排序时游标值就是主键
+        const QVariant cursorValue = column == "a.account_id" ? filter.cursorId : filter.cursorValue;
+        query.bindValue(":cursor_value", cursorValue);
+        query.bindValue(":cursor_value2", cursorValue);
+        query.bindValue(":cursor_id", filter.cursorId);
+    }
+
+    if (!SlowQueryLog::exec(query)) {
         qDebug() << "获取账户列表失败:" << query.lastError().text();
+        return accounts;
     }
 
+    while (query.next()) {
+        QVariantMap account;
+        account["account_id"] = query.value(0).toString();
+        account["account_key"] = query.value(0);   // 分页游标，保持整数类型
+        account["username"] = query.value(1);
+        account["account_type"] = query.value(2);
+        account["balance"] = query.value(3);
+        account["status"] = query.value(4);
+        account["created_at"] = query.value(5);
+        accounts.append(account);
+    }
     return accounts;
 }
 
-QList<QVariantMap> DatabaseManager::getTransactionHistory(const QString& accountId, const QString& username)
+// 普通用户版本（只查看自己账户的记录）
+QList<QVariantMap> DatabaseManager::getTransactionHistory(const QString& accountId)
 {
-    // 如果用户是admin，调用管理员版本
-    if (username == "admin") {
-        return getTransactionHistoryForAdmin();
-    }
-
-    // 否则调用普通版本
-    return getTransactionHistory(accountId);
+    return getTransactionHistory(accountId, QDateTime(), QDateTime());
 }
 
-// 普通用户版本（只查看自己账户的记录）
-QList<QVariantMap> DatabaseManager::getTransactionHistory(const QString& accountId)
+// 带时间范围的版本：在线分区 + 冷归档
+QList<QVariantMap> DatabaseManager::getTransactionHistory(const QString& accountId,
+                                                          const QDateTime& from,
+                                                          const QDateTime& to)
 {
+    WorkloadTrace::Scope trace(WorkloadTrace::History, [&]() {
+        return QStringList{ accountId, WorkloadTrace::timeArgument(from), WorkloadTrace::timeArgument(to) };
+    });
     QList<QVariantMap> history;
 
     if (!isConnected()) {
@@ -593,67 +3200,242 @@ QList<QVariantMap> DatabaseManager::getTransactionHistory(const QString& account
         return history;
     }
 
+    // transaction_time 上的范围条件使 MySQL 只访问相关月份分区
+    auto range = [&from, &to](const QString& suffix) {
+        QString condition;
+        if (from.isValid()) condition += "AND t.transaction_time >= :from" + suffix + " ";
+        if (to.isValid()) condition += "AND t.transaction_time < :to" + suffix + " ";
+        return condition;
+    };
+
+    // 本账户转出的记录与转入的贷方分录
+    const QString sql = "SELECT t.transaction_id, " + Schema::transactionTypeSql("t.transaction_type") + ", t.amount, "
+                        "t.target_account, t.description, t.transaction_time "
+                        "FROM transactions t WHERE t.account_id = :account_id " + range(QString())
+                        + "UNION ALL "
+                        "SELECT t.transaction_id, '收款', t.amount, t.account_id, "
+                        + Journal::creditDescriptionSql("t") + ", t.transaction_time "
+                        "FROM transactions t WHERE t.credit_account = :account_id_credit "
+                        + range("_credit")
+                        + "ORDER BY transaction_time DESC, transaction_id DESC";
+
     QSqlQuery query(*db);
-    query.prepare("SELECT transaction_id, transaction_type, amount, "
-                  "target_account, description, transaction_time "
-                  "FROM transactions WHERE account_id = :account_id "
-                  "ORDER BY transaction_time DESC");
-    query.bindValue(":account_id", accountId);
+    query.prepare(sql);
+    Journal::bindLegs(query, ":account_id", Schema::accountKey(accountId));
+    if (from.isValid()) Journal::bindLegs(query, ":from", from);
+    if (to.isValid()) Journal::bindLegs(query, ":to", to);
 
-    if (query.exec()) {
+    if (SlowQueryLog::exec(query)) {
         while (query.next()) {
             QVariantMap record;
             record["id"] = query.value(0);
             record["type"] = query.value(1);
             record["amount"] = query.value(2);
-            record["target"] = query.value(3);
+            record["target"] = Schema::accountId(query.value(3));
             record["description"] = query.value(4);
             record["time"] = query.value(5);
             history.append(record);
         }
-        qDebug() << "获取到" << history.size() << "条交易记录，账户:" << accountId;
     } else {
         qDebug() << "获取交易记录失败:" << query.lastError().text();
+        return history;
+    }
+
+    // 归档数据均早于在线分区，直接追加即可保持倒序
+    if (archiver) {
+        history.append(archiver->readArchivedHistory(*db, accountId, from, to));
+    }
+
+    qDebug() << "获取到" << history.size() << "条交易记录，账户:" << accountId;
+    trace.setResult(history.size());
+    return history;
+}
+
+// 筛选查询：条件全部下推到 SQL，按 (transaction_time, transaction_id) 倒序键集分页
+QList<QVariantMap> DatabaseManager::searchTransactionHistory(const QString& accountId,
+                                                             const TransactionFilter& filter,
+                                                             int limit)
+{
+    WorkloadTrace::Scope trace(WorkloadTrace::Search, [&]() {
+        return WorkloadTrace::filterArguments(accountId, filter, limit);
+    });
+    if (!isConnected()) {
+        qDebug() << "筛选交易记录失败：数据库未连接";
+        return QList<QVariantMap>();
     }
 
+    DbWorkScheduler::Scope scope(dbWork, DbWorkScheduler::InteractiveRead);
+    const QList<QVariantMap> history = searchTransactionHistory(*db, archiver, accountId, filter, limit);
+    trace.setResult(history.size());
     return history;
 }
 
-// 管理员版本：查看所有记录
-QList<QVariantMap> DatabaseManager::getTransactionHistoryForAdmin()
+void DatabaseManager::searchTransactionHistoryAsync(const QString& accountId,
+                                                    const TransactionFilter& filter, int limit,
+                                                    QObject* context,
+                                                    std::function<void(const QList<QVariantMap>&)> done)
+{
+    if (!dbWork) {
+        done(QList<QVariantMap>());
+        return;
+    }
+
+    // 全部账户的筛选可能扫描大量分区，按批量任务排队
+    const DbWorkScheduler::Priority priority =
+        accountId.isEmpty() ? DbWorkScheduler::Bulk : DbWorkScheduler::InteractiveRead;
+    TransactionArchiver* archive = archiver;
+    // 抓取负载时从提交计时到回调
+    const qint64 tracedAt = WorkloadTrace::instance().elapsedUs();
+    const QStringList traced = tracedAt >= 0 ? WorkloadTrace::filterArguments(accountId, filter, limit) : QStringList();
+    dbWork->submit<QList<QVariantMap>>(
+        priority, context,
+        [archive, accountId, filter, limit](QSqlDatabase& connection) {
+            return searchTransactionHistory(connection, archive, accountId, filter, limit);
+        },
+        [tracedAt, traced, done](const QList<QVariantMap>& history) {
+            WorkloadTrace::instance().record(WorkloadTrace::SearchAsync, tracedAt, history.size(), traced);
+            done(history);
+        });
+}
+
+QList<QVariantMap> DatabaseManager::searchTransactionHistory(QSqlDatabase& connection,
+                                                             TransactionArchiver* archiver,
+                                                             const QString& accountId,
+                                                             const TransactionFilter& filter,
+                                                             int limit)
 {
     QList<QVariantMap> history;
 
-    if (!isConnected()) {
-        qDebug() << "获取交易记录失败：数据库未连接";
+    limit = qBound(1, limit, 1000);
+    const bool allAccounts = accountId.isEmpty();
+
+    // 每笔转账只有一行：转出方的记录即该行，转入方的“收款”记录是它的贷方分录
+    // （迁移前无法配对、或转出方销户后拆出的“收款”仍是独立的行）。
+    // 两段各自按索引取前 limit 行再合并，贷方一段走 idx_transactions_credit_time。
+    // 全部账户的列表同样展开两段，一笔转账列出转出、收款两条；两条交易号相同，
+    // 排序与键集游标在 (时间, 交易号) 之后再按分录区分：借方在前、贷方在后
+    const bool creditLeg = filter.type == "收款" || filter.type.isEmpty();
+
+    auto legSql = [&](bool credit) {
+        const QString p = credit ? "_credit" : "";
+        const QString account = credit ? "t.credit_account" : "t.account_id";
+        const QString counterparty = credit ? "t.account_id" : "t.target_account";
+        const QString description = credit ? Journal::creditDescriptionSql("t") : "t.description";
+
+        QStringList conditions;
+        if (credit) conditions << "t.credit_account IS NOT NULL";
+        if (!allAccounts) conditions << account + " = :account_id" + p;
+        if (filter.from.isValid()) conditions << "t.transaction_time >= :from" + p;
+        if (filter.to.isValid()) conditions << "t.transaction_time < :to" + p;
+        if (!credit && !filter.type.isEmpty()) conditions << "t.transaction_type = :type";
+        if (filter.minAmount > 0) conditions << "t.amount >= :min_amount" + p;
+        if (filter.maxAmount > 0) conditions << "t.amount <= :max_amount" + p;
+        if (!filter.targetAccount.isEmpty()) conditions << counterparty + " = :target" + p;
+        if (!filter.descriptionContains.isEmpty()) {
+            conditions << (credit ? Journal::creditDescriptionFilterSql("t", ":description_credit", filter.descriptionContains)
+                                  : QString("t.description LIKE :description"));
+        }
+        if (filter.beforeTime.isValid()) {
+            // 游标停在借方分录上时，同一交易号的贷方分录还没有返回
+            const QString idCompare = credit && !filter.beforeCredit ? " <= " : " < ";
+            conditions << "(t.transaction_time < :before_time" + p + " "
+                          "OR (t.transaction_time = :before_time2" + p + " AND t.transaction_id" + idCompare + ":before_id" + p + "))";
+        }
+
+        QString sql = "SELECT t.transaction_id, " + (credit ? QString("'收款'") : Schema::transactionTypeSql("t.transaction_type"))
+                      + ", t.amount, " + counterparty + ", " + description + ", t.transaction_time, " + account
+                      + (credit ? ", 1 AS leg" : ", 0 AS leg");
+        if (allAccounts) {
+            sql += ", u.username FROM transactions t "
+                   "LEFT JOIN accounts a ON " + account + " = a.account_id "
+                   "LEFT JOIN users u ON a.user_id = u.user_id ";
+        } else {
+            sql += " FROM transactions t ";
+        }
+        if (!conditions.isEmpty()) {
+            sql += "WHERE " + conditions.join(" AND ") + " ";
+        }
+        sql += QString("ORDER BY t.transaction_time DESC, t.transaction_id DESC LIMIT %1").arg(limit);
+        return sql;
+    };
+
+    QString sql = legSql(false);
+    if (creditLeg) {
+        sql = "(" + sql + ") UNION ALL (" + legSql(true) + ") "
+              + QString("ORDER BY transaction_time DESC, transaction_id DESC, leg LIMIT %1").arg(limit);
+    }
+
+    QString likePattern = filter.descriptionContains;
+    likePattern.replace("\\", "\\\\").replace("%", "\\%").replace("_", "\\_");
+
+    QSqlQuery query(connection);
+    query.prepare(sql);
+    auto bind = [&](const QString& placeholder, const QVariant& value) {
+        query.bindValue(placeholder, value);
+        if (creditLeg) query.bindValue(placeholder + "_credit", value);
+    };
+    if (!allAccounts) bind(":account_id", Schema::accountKey(accountId));
+    if (filter.from.isValid()) bind(":from", filter.from);
+    if (filter.to.isValid()) bind(":to", filter.to);
+    if (!filter.type.isEmpty()) query.bindValue(":type", Schema::transactionType(filter.type));
+    if (filter.minAmount > 0) bind(":min_amount", filter.minAmount);
+    if (filter.maxAmount > 0) bind(":max_amount", filter.maxAmount);
+    if (!filter.targetAccount.isEmpty()) bind(":target", Schema::accountKey(filter.targetAccount));
+    if (!filter.descriptionContains.isEmpty()) bind(":description", "%" + likePattern + "%");
+    if (filter.beforeTime.isValid()) {
+        bind(":before_time", filter.beforeTime);
+        bind(":before_time2", filter.beforeTime);
+        bind(":before_id", filter.beforeId);
+    }
+
+    if (!SlowQueryLog::exec(query)) {
+        qDebug() << "筛选交易记录失败:" << query.lastError().text();
         return history;
     }
 
-    QSqlQuery query(*db);
-    query.prepare("SELECT t.transaction_id, t.transaction_type, t.amount, "
-                  "t.target_account, t.description, t.transaction_time, "
-                  "a.account_id, u.username "
-                  "FROM transactions t "
-                  "JOIN accounts a ON t.account_id = a.account_id "
-                  "JOIN users u ON a.user_id = u.user_id "
-                  "ORDER BY t.transaction_time DESC");
+    while (query.next()) {
+        QVariantMap record;
+        record["id"] = query.value(0);
+        record["type"] = query.value(1);
+        record["amount"] = query.value(2);
+        record["target"] = Schema::accountId(query.value(3));
+        record["description"] = query.value(4);
+        record["time"] = query.value(5);
+        record["account_id"] = query.value(6).toString();
+        record["credit"] = query.value(7).toInt() == 1;
+        if (allAccounts) record["username"] = query.value(8);
+        history.append(record);
+    }
 
-    if (query.exec()) {
-        while (query.next()) {
-            QVariantMap record;
-            record["id"] = query.value(0);
-            record["type"] = query.value(1);
-            record["amount"] = query.value(2);
-            record["target"] = query.value(3);
-            record["description"] = query.value(4);
-            record["time"] = query.value(5);
-            record["account_id"] = query.value(6);
-            record["username"] = query.value(7);
-            history.append(record);
+    // 在线分区不足一页时用归档记录补齐（归档均早于在线数据）
+    if (!allAccounts && archiver && history.size() < limit) {
+        QDateTime archiveTo = filter.to;
+        if (filter.beforeTime.isValid() && (!archiveTo.isValid() || filter.beforeTime < archiveTo)) {
+            archiveTo = filter.beforeTime.addMSecs(1);
+        }
+
+        const QList<QVariantMap> archived =
+            archiver->readArchivedHistory(connection, accountId, filter.from, archiveTo);
+        for (const QVariantMap& record : archived) {
+            if (history.size() >= limit) break;
+
+            const QDateTime time = record["time"].toDateTime();
+            const qint64 id = record["id"].toLongLong();
+            const double amount = record["amount"].toDouble();
+
+            if (filter.beforeTime.isValid()
+                && (time > filter.beforeTime || (time == filter.beforeTime && id >= filter.beforeId))) continue;
+            if (!filter.type.isEmpty() && record["type"].toString() != filter.type) continue;
+            if (filter.minAmount > 0 && amount < filter.minAmount) continue;
+            if (filter.maxAmount > 0 && amount > filter.maxAmount) continue;
+            if (!filter.targetAccount.isEmpty() && record["target"].toString() != filter.targetAccount) continue;
+            if (!filter.descriptionContains.isEmpty()
+                && !record["description"].toString().contains(filter.descriptionContains, Qt::CaseInsensitive)) continue;
+
+            QVariantMap row = record;
+            row["account_id"] = accountId;
+            history.append(row);
         }
-        qDebug() << "管理员获取到" << history.size() << "条交易记录";
-    } else {
-        qDebug() << "获取交易记录失败:" << query.lastError().text();
     }
 
     return history;
@@ -661,6 +3443,7 @@ QList<QVariantMap> DatabaseManager::getTransactionHistoryForAdmin()
 
 QList<QVariantMap> DatabaseManager::getUserAccounts(const QString& username)
 {
+    WorkloadTrace::Scope trace(WorkloadTrace::UserAccounts, [&]() { return QStringList{ username }; });
     QList<QVariantMap> accounts;
 
     if (!isConnected()) {
@@ -668,26 +3451,20 @@ QList<QVariantMap> DatabaseManager::getUserAccounts(const QString& username)
         return accounts;
     }
 
-    QSqlQuery query(*db);
-    query.prepare("SELECT a.account_id, a.account_type, a.balance, a.created_at "
-                  "FROM accounts a "
-                  "JOIN users u ON a.user_id = u.user_id "
-                  "WHERE u.username = :username "
-                  "ORDER BY a.created_at DESC");
-    query.bindValue(":username", username);
-
-    if (query.exec()) {
-        while (query.next()) {
+    if (QSqlQuery* query = execCached(kSqlUserAccounts, { username })) {
+        while (query->next()) {
             QVariantMap account;
-            account["account_id"] = query.value(0).toString();
-            account["account_type"] = query.value(1).toString();
-            account["balance"] = query.value(2).toDouble();
-            account["created_at"] = query.value(3);
+            account["account_id"] = query->value(0).toString();
+            account["account_type"] = query->value(1).toString();
+            account["balance"] = query->value(2).toDouble();
+            account["created_at"] = query->value(3);
             accounts.append(account);
         }
+        query->finish();
+        trace.setResult(accounts.size());
         qDebug() << "获取到" << accounts.size() << "个账户，用户:" << username;
     } else {
-        qDebug() << "获取用户账户失败:" << query.lastError().text();
+        qDebug() << "获取用户账户失败";
     }
 
     return accounts;
@@ -3,12 +3,130 @@
 
 #include <QObject>
 #include <QString>
+#include <QStringList>
 #include <QList>
 #include <QVariantMap>
+#include <QHash>
+#include <QDateTime>
+#include <QFuture>
+#include <QElapsedTimer>
+#include <functional>
+#include "dberror.h"
+#include "velocitylimiter.h"
+#include "workloadtrace.h"
 
 // 前向声明
 class QSqlDatabase;
 class QSqlQuery;
+class QThread;
+class QTimer;
+class TransactionArchiver;
+class OutboxPublisher;
+class DbWorkScheduler;
+class BalanceCheckpointer;
+class AccountDirectory;
+class WriteCoalescer;
+class AccountPurger;
+class ColumnStoreExporter;
+class MysqlFastPath;
+
+// 交易记录筛选条件，空值/0 表示不限
+struct TransactionFilter
+{
+    QDateTime from;               // 起始时间（含）
+    QDateTime to;                 // 结束时间（不含）
+    QString type;                 // transaction_type
+    double minAmount = 0.0;
+    double maxAmount = 0.0;
+    QString targetAccount;
+    QString descriptionContains;
+
+    // 键集分页游标：上一页最后一条记录的时间与ID，以及它是否为贷方分录（记录的 "credit" 字段）
+    QDateTime beforeTime;
+    qint64 beforeId = 0;
+    bool beforeCredit = false;
+};
+
+// 管理员用户/账户列表的服务端筛选、排序与键集分页
+struct AdminListFilter
+{
+    QString search;               // 用户：用户名/身份证号/手机号前缀；账户：账户号前缀（全数字）或用户名前缀
+    QString status;               // 账户状态，空表示不限（用户列表忽略）
+    QString sortColumn;           // 用户：user_id / username；账户：created_at / account_id / balance
+    bool descending = true;
+
+    // 键集分页游标：上一页最后一行的排序列值与主键，cursorId 无效表示第一页。
+    // 主键保持列的整数类型：用户取 user_id，账户取 account_key（账户号的整数值），按账户号排序时不使用 cursorValue
+    QVariant cursorValue;
+    QVariant cursorId;
+};
+
+// 定期/预约转账指令（scheduled_transfers 一行）
+struct ScheduledTransfer
+{
+    qint64 orderId = 0;
+    QString fromAccount;
+    QString toAccount;
+    qint64 amountCents = 0;   // 每期金额（分）
+    QString description;
+    QString frequency;        // once / daily / weekly / monthly
+    int intervalCount = 1;
+    QDateTime startAt;        // 首次执行时间，各期由此推算，避免月末日期漂移
+    QDateTime endAt;          // 无效表示不限
+    int maxRuns = 0;          // 0 表示不限
+    int runsDone = 0;
+    QDateTime dueAt;          // 本期应执行时间（next_run_at）
+
+    // 第 index 期（从 0 开始）的执行时间
+    QDateTime occurrence(int index) const;
+};
+
+// 一期指令的执行结果，同时记录在 scheduled_transfer_runs
+struct ScheduledRunResult
+{
+    qint64 orderId = 0;
+    QDateTime dueAt;
+    QString outcome;          // success / insufficient_funds / limit_exceeded / account_missing / account_frozen / account_closed / error
+    QString message;
+    qint64 transactionId = 0;
+    QString orderStatus;      // 执行后指令状态：active / completed / paused / cancelled
+    QDateTime nextRunAt;
+};
+
+// 合并提交的一笔存款或取款
+struct PostingRequest
+{
+    enum Kind { Deposit, Withdraw };
+
+    Kind kind = Deposit;
+    QString accountId;
+    double amount = 0.0;
+    QString idempotencyKey;
+};
+
+struct PostingResult
+{
+    bool success = false;
+    bool replayed = false;        // 幂等键已执行过，返回首次结果
+    bool limitExceeded = false;   // 取款超出限额，原因见 message
+    QString message;              // 失败原因
+    qint64 transactionId = 0;
+};
+
+// 存款/取款/转账事务的重试统计
+struct WriteRetryMetrics
+{
+    qint64 attempts = 0;             // 事务尝试次数（含重试）
+    qint64 retries = 0;
+    qint64 deadlocks = 0;
+    qint64 lockWaitTimeouts = 0;
+    qint64 connectionLosses = 0;
+    qint64 constraintViolations = 0;
+    qint64 exhausted = 0;            // 重试次数或时间预算用尽仍失败
+    qint64 backoffMs = 0;            // 累计退避等待
+};
+
+class TransferScheduler;
 
 class DatabaseManager : public QObject
 {
@@ -23,16 +141,44 @@ public:
                            const QString& database,
                            const QString& username,
                            const QString& password);
+    // 只打开主连接、预编译常用语句，不启动调度、归档、推送、检查点等后台服务，也不加载限额。
+    // 供无界面批处理使用：对账、计息、对账单与报表导出只需 connectionName() 克隆各自的连接
+    bool connectCore(const QString& host,
+                     const QString& database,
+                     const QString& username,
+                     const QString& password);
+    // 后台连接：在线程池中打开主连接（加载驱动、DNS、握手与认证）并从这条连接读取限额与账户类型，
+    // 再把连接移交给主线程；主线程只预编译常用语句并启动后台服务，结果由 connectionReady 通知。
+    // 再次调用会作废尚未完成的上一次
+    void connectToDatabaseAsync(const QString& host,
+                                const QString& database,
+                                const QString& username,
+                                const QString& password);
+    bool isConnecting() const;
+    // 账户类型（来自 account_types 字典表，按编码排列），连接前为空
+    QStringList accountTypes() const;
+
+    // 所有写操作都可携带客户端生成的幂等键：同一键重复提交时不会重复执行，
+    // 直接返回首次执行的结果，调用方可在超时后放心重试
 
     // 账户管理
-    bool freezeAccount(const QString& accountId);
-    bool unfreezeAccount(const QString& accountId);
-    bool deleteAccount(const QString& accountId);
-    QList<QVariantMap> getAllUsers();  // 管理员获取所有用户
-    bool deleteUser(int userId);
-    bool updateUserPassword(const QString& username, const QString& newPassword);
-    QList<QVariantMap> getAllAccounts();  // 获取所有账户
-    QList<QVariantMap> getTransactionHistory(const QString& accountId, const QString& username);
+    bool freezeAccount(const QString& accountId, const QString& idempotencyKey = QString());
+    bool unfreezeAccount(const QString& accountId, const QString& idempotencyKey = QString());
+    // 批量冻结/解冻：一个事务、一条 UPDATE 处理全部选中账户，返回状态实际改变的账户数，失败返回 -1
+    int freezeAccounts(const QStringList& accountIds, const QString& idempotencyKey = QString());
+    int unfreezeAccounts(const QStringList& accountIds, const QString& idempotencyKey = QString());
+    // 销户：立即标记为“已销户”并停止接受交易，交易记录由后台分批清理
+    bool deleteAccount(const QString& accountId, const QString& idempotencyKey = QString());
+    // 管理员列表按页读取：筛选与排序在服务端完成，每页走索引，不随总行数变慢
+    QList<QVariantMap> searchUsers(const AdminListFilter& filter, int limit);
+    void searchUsersAsync(const AdminListFilter& filter, int limit, QObject* context,
+                          std::function<void(const QList<QVariantMap>&)> done);
+    QList<QVariantMap> searchAccounts(const AdminListFilter& filter, int limit);
+    void searchAccountsAsync(const AdminListFilter& filter, int limit, QObject* context,
+                             std::function<void(const QList<QVariantMap>&)> done);
+    bool deleteUser(int userId, const QString& idempotencyKey = QString());
+    bool updateUserPassword(const QString& username, const QString& newPassword,
+                            const QString& idempotencyKey = QString());
 
     void disconnect();
     bool isConnected() const;
@@ -40,25 +186,134 @@ public:
     // 用户操作
     bool createUser(const QString& username, const QString& password,
                     const QString& fullName, const QString& idCard,
-                    const QString& phone, const QString& email);
+                    const QString& phone, const QString& email,
+                    const QString& idempotencyKey = QString());
 
+    // 同步校验口令（scrypt，单次约数十毫秒），界面登录请使用 AuthService 异步接口
     bool authenticateUser(const QString& username, const QString& password);
+    // 读取口令散列与角色，用户不存在返回 false
+    bool getUserCredentials(const QString& username, int& userId,
+                            QString& passwordHash, QString& role);
+    // 登录时升级旧明文/旧参数散列；仅当库中仍为 previousHash 时更新
+    bool upgradePasswordHash(int userId, const QString& previousHash, const QString& newHash);
+    QString getUserRole(const QString& username);
 
     // 账户操作
-    QString createAccount(int userId, const QString& accountType = "储蓄账户");
-    bool deposit(const QString& accountId, double amount);
-    bool withdraw(const QString& accountId, double amount);
-    bool transfer(const QString& fromAccount, const QString& toAccount, double amount);
+    QString createAccount(int userId, const QString& accountType = "储蓄账户",
+                          const QString& idempotencyKey = QString());
+    bool deposit(const QString& accountId, double amount, const QString& idempotencyKey = QString());
+    bool withdraw(const QString& accountId, double amount, const QString& idempotencyKey = QString());
+    bool transfer(const QString& fromAccount, const QString& toAccount, double amount,
+                  const QString& idempotencyKey = QString());
+    // 最近一次取款/转账因超出限额被拒绝的原因，未超限时为空
+    QString lastLimitViolation() const;
+    // 最近一次存款/取款/转账因数据库错误（而非业务原因）失败的说明，否则为空
+    QString lastWriteError() const;
+    // 死锁、锁等待超时与连接中断会在预算内自动重试，统计断开连接时写入日志
+    WriteRetryMetrics writeRetryMetrics() const;
+
+    // 合并提交：短时间内到达的存取款在后台线程中合并为一个事务，每笔以保存点隔离，
+    // 一次提交（一次刷盘）完成整批。第一笔到达后最多等待 windowMicros 微秒或凑满 maxBatch 笔。
+    // 启用后 deposit()/withdraw() 及下面的异步接口可在任意线程调用；默认关闭，在主线程中设置
+    void setWriteCoalescing(bool enabled, int windowMicros = 500, int maxBatch = 64);
+    bool writeCoalescingEnabled() const;
+    // 原生快速通道：查余额、存款、取款、转账的语句直接走 MySQL C 客户端的预编译语句（见 MysqlFastPath），
+    // 以 BANKSYSTEM_NATIVE_MYSQL=ON 构建时默认开启；关闭或句柄不可用时走 QtSql。在主线程中设置
+    void setNativeFastPath(bool enabled);
+    bool nativeFastPathActive() const;
+
+    // 报表列存：在后台线程中把流水增量导出到本地列存（见 ColumnStoreExporter），
+    // 供 --analytics 报表查询。directory 为空时使用应用数据目录下的 analytics；默认关闭，在主线程中设置
+    void setAnalyticsExport(bool enabled, const QString& directory = QString());
+    bool analyticsExportEnabled() const;
+
+    // 每笔单独完成；未启用合并时在调用线程同步执行（只能在主线程调用）
+    QFuture<PostingResult> depositAsync(const QString& accountId, double amount,
+                                        const QString& idempotencyKey = QString());
+    QFuture<PostingResult> withdrawAsync(const QString& accountId, double amount,
+                                         const QString& idempotencyKey = QString());
+    // 界面使用：完成后在 context 所在线程回调 done。启用合并时主线程不等待批次提交，
+    // 未启用时在主连接上执行，重试退避由定时器等待
+    void depositAsync(const QString& accountId, double amount, QObject* context,
+                      std::function<void(const PostingResult&)> done, const QString& idempotencyKey = QString());
+    void withdrawAsync(const QString& accountId, double amount, QObject* context,
+                       std::function<void(const PostingResult&)> done, const QString& idempotencyKey = QString());
+    // 转账不经合并；在主连接上执行，重试退避期间不阻塞界面线程
+    void transferAsync(const QString& fromAccount, const QString& toAccount, double amount, QObject* context,
+                       std::function<void(const PostingResult&)> done, const QString& idempotencyKey = QString());
+    // 一个事务执行一批存取款，results 与 requests 一一对应；按账户号顺序加锁，同一账户保持提交顺序。
+    // 只使用传入的连接；返回 false 表示整个事务未提交，error 为原因，只有死锁/锁等待超时应拆小重试。
+    // commitSent 为 true 时失败发生在 COMMIT 发出之后（连接中断），批次可能已提交，不能重做
+    static bool executePostingBatch(QSqlDatabase& connection, const QList<PostingRequest>& requests,
+                                    VelocityLimiter* limiter, QList<PostingResult>& results,
+                                    DbError::Kind& error, bool& commitSent);
+
+    // 定期/预约转账，返回指令号，失败返回 0
+    qint64 createScheduledTransfer(const ScheduledTransfer& order, const QString& idempotencyKey = QString());
+    bool cancelScheduledTransfer(qint64 orderId, const QString& idempotencyKey = QString());
+    QList<QVariantMap> getScheduledTransfers(const QString& accountId);
+    QList<QVariantMap> getScheduledTransferRuns(qint64 orderId, int limit = 50);
+
+    // 在一个事务中执行一批到期指令，每条指令以保存点隔离，业务失败只影响自身。转出受转账限额约束，
+    // 与界面发起的转账共用 limiter 的计数（为空时不检查）。
+    // 只使用传入的连接，可在调度线程中调用；返回 false 表示整个事务被回滚（如死锁），调用方应拆小重试
+    static bool executeScheduledTransfers(QSqlDatabase& connection,
+                                          const QList<ScheduledTransfer>& orders,
+                                          VelocityLimiter* limiter,
+                                          QList<ScheduledRunResult>& results);
+
+    // 清理超过 ttlHours 的幂等键，返回删除条数（连接后每小时自动执行）
+    int purgeExpiredIdempotencyKeys(int ttlHours);
 
     // 查询操作
     double getBalance(const QString& accountId);
+    // at 时刻（不含）之前全部流水入账后的余额：最近的日终检查点加上其后的流水净额，
+    // 之前没有检查点时由其后最近的检查点倒推，都没有（最近一次检查点之后开户）时由当前余额倒推。账户不存在返回 false
+    bool getBalanceAsOf(const QString& accountId, const QDateTime& at, double& balance);
     QList<QVariantMap> getTransactionHistory(const QString& accountId);
+    // 按时间范围查询（含归档数据），[from, to) 区间用于分区裁剪，无效时间表示不限
+    QList<QVariantMap> getTransactionHistory(const QString& accountId,
+                                             const QDateTime& from,
+                                             const QDateTime& to);
+    // 服务端筛选 + 键集分页，accountId 为空时查询全部账户（管理员）
+    QList<QVariantMap> searchTransactionHistory(const QString& accountId,
+                                                const TransactionFilter& filter,
+                                                int limit = 100);
+    // 异步版本，在数据库工作线程执行；全部账户（管理员）按批量优先级排队
+    void searchTransactionHistoryAsync(const QString& accountId,
+                                       const TransactionFilter& filter, int limit,
+                                       QObject* context,
+                                       std::function<void(const QList<QVariantMap>&)> done);
     QList<QVariantMap> getUserAccounts(const QString& username);
     int getUserId(const QString& username);
 
     // 测试数据库连接
     bool testConnection();
 
+    // 当前主连接名，供后台线程克隆连接使用
+    QString connectionName() const;
+
+    // 冷数据归档（在后台线程运行）
+    TransactionArchiver* transactionArchiver() const;
+
+    // 变更推送的本地套接字名（按数据库区分），供 OutboxSubscriber 连接
+    QString changeFeedServerName() const;
+
+    // 定期转账调度（在后台线程运行）
+    TransferScheduler* transferScheduler() const;
+
+    // 账户目录：转账目标校验与账户号前缀查找，不访问数据库
+    AccountDirectory* accountDirectory() const;
+
+    // 数据库任务调度（交互写 > 交互读 > 批量），排队与耗时统计见 summary()
+    DbWorkScheduler* workScheduler() const;
+
+signals:
+    // connectToDatabaseAsync 的结果
+    void connectionReady(bool success);
+    // 指令新建或取消后通知调度线程重新加载
+    void scheduledTransferChanged(qint64 orderId);
+
 private:
     DatabaseManager(QObject* parent = nullptr);
     ~DatabaseManager();
@@ -67,9 +322,182 @@ private:
     DatabaseManager& operator=(const DatabaseManager&) = delete;
 
     QSqlDatabase* db;
+    TransactionArchiver* archiver;
+    QThread* archiverThread;
+    QTimer* idempotencyPurgeTimer;
+    QTimer* directoryRefreshTimer;
+    QTimer* connectionProbeTimer;
+    OutboxPublisher* outboxPublisher;
+    QThread* outboxThread;
+    TransferScheduler* scheduler;
+    QThread* schedulerThread;
+    QString feedServerName;
+    VelocityLimiter* limiter;
+    AccountDirectory* directory;
+    DbWorkScheduler* dbWork;
+    BalanceCheckpointer* checkpointer;
+    QThread* checkpointThread;
+    AccountPurger* purger;
+    QThread* purgeThread;
+    WriteCoalescer* coalescer;
+    ColumnStoreExporter* analyticsExporter;
+    MysqlFastPath* fastPath;
+    bool fastPathEnabled;
+    QThread* analyticsThread;
+    bool analyticsEnabled;
+    QString analyticsDirectory;
+    bool coalescingEnabled;
+    int coalesceWindowMicros;
+    int coalesceMaxBatch;
+    QString limitViolation;
+    QString writeError;
+    DbError::Kind attemptError;     // 本次事务尝试的失败类型
+    bool attemptCommitSent;         // 已发出 COMMIT，连接中断时结果未知
+    WriteRetryMetrics retryStats;
+    QStringList accountTypeList;
+    int connectGeneration;     // 异步连接序号，过期的后台连接被关闭丢弃
+    bool connecting;
+    QHash<QString, QSqlQuery*> statementCache;
     QString generateAccountId();
 
-    QList<QVariantMap> getTransactionHistoryForAdmin();
+    void startArchiver();
+    void stopArchiver();
+    void startOutboxPublisher();
+    void stopOutboxPublisher();
+    void startScheduler();
+    void stopScheduler();
+    void startWorkScheduler();
+    void stopWorkScheduler();
+    void startCheckpointer();
+    void stopCheckpointer();
+    void startPurger();
+    void stopPurger();
+    void startWriteCoalescer();
+    void stopWriteCoalescer();
+    void startAnalyticsExporter();
+    void stopAnalyticsExporter();
+    QFuture<PostingResult> submitPosting(const PostingRequest& request);
+    void watchPosting(const QFuture<PostingResult>& future, QObject* context,
+                      std::function<void(const PostingResult&)> done);
+    // 在数据库工作线程中刷新账户目录，full 为整体重建
+    void refreshAccountDirectory(bool full);
+
+    // 主连接上的预编译语句，同一 SQL 复用；执行失败（如重连后语句失效）时重新预编译一次。
+    // 参数按 ? 顺序绑定，成功返回已执行的查询，用完后调用 finish()
+    QSqlQuery* execCached(const QString& sql, const QVariantList& values);
+    void prepareCommonStatements();
+    static bool openMainConnection(const QString& connectionName, const QString& host, const QString& database,
+                                   const QString& username, const QString& password);
+    void attachMainConnection(const QString& connectionName);
+    void startServices(const QString& host, const QString& database);
+    void clearStatementCache();
+    static bool loadAccountTypes(QSqlDatabase& connection, QStringList& types);
+
+    // 一次事务尝试的结果；Failed 时 attemptError 给出原因
+    enum class WriteAttempt { Committed, Replayed, Rejected, Failed };
+    // 执行 attempt，死锁、锁等待超时与连接中断时按抖动退避重试，受次数与时间预算限制。
+    // 提交已发出后连接中断的请求只有带幂等键时才重试（重试时由幂等键识别已提交的结果）。
+    // 退避时调用线程休眠，界面线程使用 runWithRetryAsync
+    WriteAttempt runWithRetry(const char* operation, bool replayable,
+                              const std::function<WriteAttempt()>& attempt);
+    // 同上，退避由定时器等待，不阻塞事件循环；结束后在主线程回调 done
+    void runWithRetryAsync(const char* operation, bool replayable, const std::function<WriteAttempt()>& attempt,
+                           std::function<void(WriteAttempt)> done);
+    void retryAsyncStep(const char* operation, bool replayable, const std::function<WriteAttempt()>& attempt,
+                        std::function<void(WriteAttempt)> done, int attemptNo, QElapsedTimer budget);
+    // 统计失败原因；可以重试时返回 true 并给出退避毫秒数，否则设置 writeError
+    bool retryAfterFailure(const char* operation, bool replayable, int attemptNo, qint64 elapsedMs, int& delay);
+
+    // 存款、取款、转账拆成两步：plan* 在调用线程完成幂等查询、余额与限额检查，
+    // 能直接得出结果时 decided 为 true；否则 attempt 为可重复执行的一次事务尝试，
+    // finish 按最终结果退回限额计数并返回是否成功。同步与异步接口共用
+    struct WritePlan
+    {
+        const char* operation = "";
+        bool replayable = false;
+        bool decided = false;
+        bool success = false;
+        std::function<WriteAttempt()> attempt;
+        std::function<bool(WriteAttempt)> finish;
+    };
+    WritePlan planDeposit(const QString& accountId, double amount, const QString& idempotencyKey);
+    WritePlan planWithdraw(const QString& accountId, double amount, const QString& idempotencyKey);
+    WritePlan planTransfer(const QString& fromAccount, const QString& toAccount, double amount,
+                           const QString& idempotencyKey);
+    bool runPlan(const WritePlan& plan);
+    void runPlanAsync(WorkloadTrace::Operation operation, const QStringList& arguments, const WritePlan& plan,
+                      QObject* context, std::function<void(bool)> done);
+    // 记录失败原因并回滚
+    WriteAttempt failAttempt(const QSqlQuery& query, const char* what);
+    WriteAttempt failAttempt(const char* what);
+    // 幂等键登记失败：键被并发请求占用时返回其结果
+    WriteAttempt claimFailed(bool duplicate, const QString& key, const QString& fingerprint);
+    // 失败原因已由下面的 exec* 记录，只回滚
+    WriteAttempt rollbackAttempt();
+
+    // 存款、取款、转账事务内的热点语句：原生快速通道可用时走 MysqlFastPath，否则用 QSqlQuery。
+    // 失败时记录 attemptError 并返回 -1（交易号返回 0、锁定返回 false），由调用方 rollbackAttempt()
+    int execBalanceChange(const QString& accountId, qint64 cents, bool debit, const char* what);
+    bool execLockTransferAccounts(const QString& fromAccount, const QString& toAccount,
+                                  bool& fromFound, bool& toFound, qint64& fromBalanceCents, const char* what);
+    qint64 execInsertPosting(const QString& accountId, const QString& type, qint64 cents,
+                             const QString& description, const char* what);
+    qint64 execInsertTransfer(const QString& fromAccount, const QString& toAccount, qint64 cents, const char* what);
+    // 快速通道失败是因为语句已被关闭时重新预编译并返回 true，调用方本次改走 QSqlQuery
+    bool reattachFastPath();
+    bool reopenConnection();
+
+    // 一次读取余额与账户类型，账户不存在返回 false
+    bool getBalanceAndType(const QString& accountId, double& balance, QString& accountType);
+
+    // 在保存点内执行一笔存取款；业务拒绝返回 true 且 result.success 为 false，数据库错误返回 false。
+    // 取款通过限额检查后计入 reservation，没有成功入账时由调用方退回
+    static bool postPosting(QSqlDatabase& connection, const PostingRequest& request,
+                            VelocityLimiter* limiter, VelocityLimiter::Reservation& reservation,
+                            PostingResult& result, QString& error);
+    static bool postScheduledTransfer(QSqlDatabase& connection, const ScheduledTransfer& order,
+                                      VelocityLimiter* limiter, VelocityLimiter::Reservation& reservation,
+                                      ScheduledRunResult& result, QString& error);
+
+    // 在当前事务中写入变更事件，余额与状态取自刚更新过的账户行
+    static bool appendOutboxEvent(QSqlDatabase& connection,
+                                  const QString& eventType, const QString& accountId,
+                                  const QVariant& transactionId = QVariant(),
+                                  const QString& transactionType = QString(), double amount = 0.0,
+                                  const QString& counterparty = QString(),
+                                  const QString& description = QString());
+
+    // 把 accountIds 中状态为 fromStatus 的账户改为 toStatus，写入状态变更事件
+    int changeAccountsStatus(const QString& operation, const QStringList& accountIds,
+                             const QString& fromStatus, const QString& toStatus,
+                             const QString& idempotencyKey);
+
+    // 幂等键
+    static QString requestFingerprint(const QString& operation, const QStringList& arguments);
+    bool findIdempotentResult(const QString& key, const QString& fingerprint,
+                              bool& success, QString* result = nullptr);
+    bool claimIdempotencyKey(const QString& key, const QString& operation,
+                             const QString& fingerprint, const QString& result, bool& duplicate);
+    void recordRejectedRequest(const QString& key, const QString& operation,
+                               const QString& fingerprint);
+    // 同上，使用指定连接
+    static bool findIdempotentResult(QSqlDatabase& connection, const QString& key,
+                                     const QString& fingerprint, bool& success, QString* result = nullptr);
+    static bool claimIdempotencyKey(QSqlDatabase& connection, const QString& key,
+                                    const QString& operation, const QString& fingerprint,
+                                    const QString& result, bool& duplicate);
+    static void recordRejectedRequest(QSqlDatabase& connection, const QString& key,
+                                      const QString& operation, const QString& fingerprint);
+
+    // 只使用传入的连接，可在数据库工作线程中调用
+    static QList<QVariantMap> searchTransactionHistory(QSqlDatabase& connection,
+                                                       TransactionArchiver* archiver,
+                                                       const QString& accountId,
+                                                       const TransactionFilter& filter,
+                                                       int limit);
+    // 按筛选条件读取游标之后的一页用户/账户
+    static QList<QVariantMap> readUsersPage(QSqlDatabase& connection, const AdminListFilter& filter, int limit);
+    static QList<QVariantMap> readAccountsPage(QSqlDatabase& connection, const AdminListFilter& filter, int limit);
 
     void createTables();
     void insertTestData();
@@ -0,0 +1,133 @@
+#ifndef DBERROR_H
+#define DBERROR_H
+
+#include <QString>
+#include <QSqlError>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QDebug>
+
+// MySQL 错误分类与重试退避
+namespace DbError {
+
+enum Kind {
+    None,
+    Deadlock,              // 1213，事务已被服务器整体回滚
+    LockWaitTimeout,       // 1205
+    ConnectionLost,        // 2006/2013 等，连接需重建
+    ConstraintViolation,   // 唯一键、外键、非空、CHECK 约束
+    StatementInvalidated,  // 2056/2030/1243，预编译语句已被关闭，需重新预编译
+    Other
+};
+
+inline Kind classify(const QString& nativeCode)
+{
+    if (nativeCode.isEmpty()) return None;
+
+    switch (nativeCode.toInt()) {
+    case 1213:
+        return Deadlock;
+    case 1205:
+        return LockWaitTimeout;
+    case 2006:   // MySQL server has gone away
+    case 2013:   // Lost connection to MySQL server during query
+    case 2055:   // Lost connection ... system error
+    case 4031:   // 空闲超时被服务器断开
+        return ConnectionLost;
+    case 1048:   // Column cannot be null
+    case 1062:   // Duplicate entry
+    case 1451:   // 外键：被引用的行不能删除
+    case 1452:   // 外键：引用的行不存在
+    case 3819:   // CHECK 约束
+        return ConstraintViolation;
+    case 2030:   // Statement not prepared
+    case 2056:   // Statement closed indirectly because of a preceding call
+    case 1243:   // Unknown prepared statement handler
+        return StatementInvalidated;
+    default:
+        return Other;
+    }
+}
+
+inline Kind classify(const QSqlError& error)
+{
+    if (error.type() == QSqlError::NoError) return None;
+
+    const Kind kind = classify(error.nativeErrorCode());
+    if (kind == Other && error.type() == QSqlError::ConnectionError) return ConnectionLost;
+    return kind;
+}
+
+// 死锁与锁等待超时：整个事务应放弃并从头重试
+inline bool isLockConflict(Kind kind)
+{
+    return kind == Deadlock || kind == LockWaitTimeout;
+}
+
+inline bool isLockConflict(const QString& nativeCode)
+{
+    return isLockConflict(classify(nativeCode));
+}
+
+inline bool isRetryable(Kind kind)
+{
+    return isLockConflict(kind) || kind == ConnectionLost;
+}
+
+inline QString describe(Kind kind)
+{
+    switch (kind) {
+    case Deadlock:
+    case LockWaitTimeout:
+        return QString("账户正被其他操作占用，请稍后重试");
+    case ConnectionLost:
+        return QString("数据库连接中断，请稍后重试");
+    case ConstraintViolation:
+        return QString("数据校验失败");
+    default:
+        return QString("数据库错误");
+    }
+}
+
+// 第 attempt 次重试前的等待（毫秒）：上限按指数增长，在 [上限/2, 上限] 内随机，
+// 避免互相冲突的请求同时醒来再次冲突
+inline int backoffMs(int attempt, int baseMs, int maxMs)
+{
+    const int ceiling = qMin(maxMs, baseMs << qBound(0, attempt - 1, 16));
+    return ceiling / 2 + int(QRandomGenerator::global()->bounded(ceiling / 2 + 1));
+}
+
+// 连接探测间隔：长连接至少每隔这么久确认一次服务器仍在
+const int kProbeIntervalMs = 5000;
+
+// 连接不开启 MYSQL_OPT_RECONNECT：客户端库静默重连会丢掉事务与会话状态，之后的语句在新会话上自动提交。
+// 长连接改为在开始工作前探测，服务器已断开（wait_timeout、网络中断）时显式关闭重开。
+// lastProbe 记录上次探测时间，间隔内不再探测；无效的计时器总是探测。
+// reopened 报告连接是否重建过（会话级的锁与变量已丢失）
+inline bool ensureOpen(QSqlDatabase& db, QElapsedTimer& lastProbe, bool* reopened = nullptr)
+{
+    if (reopened) *reopened = false;
+    if (db.isOpen() && (!lastProbe.isValid() || lastProbe.elapsed() >= kProbeIntervalMs)) {
+        QSqlQuery probe(db);
+        if (!probe.exec("DO 1") && classify(probe.lastError()) == ConnectionLost) {
+            qDebug() << "数据库连接已断开，重新连接:" << db.connectionName();
+            db.close();
+        }
+        lastProbe.start();
+    }
+    if (db.isOpen()) return true;
+    if (reopened) *reopened = true;
+    return db.open();
+}
+
+inline bool ensureOpen(QSqlDatabase& db)
+{
+    QElapsedTimer lastProbe;
+    return ensureOpen(db, lastProbe);
+}
+
+} // namespace DbError
+
+#endif // DBERROR_H
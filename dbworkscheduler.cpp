@@ -0,0 +1,204 @@
+#include "dbworkscheduler.h"
+#include "dberror.h"
+#include <QThread>
+#include <QSqlError>
+#include <QStringList>
+#include <QMutexLocker>
+#include <QDebug>
+
+namespace {
+// 工作线程各自的连接名
+thread_local QString workerConnection;
+
+const char* priorityName(int priority)
+{
+    switch (priority) {
+    case DbWorkScheduler::InteractiveWrite: return "交互写";
+    case DbWorkScheduler::InteractiveRead: return "交互读";
+    default: return "批量";
+    }
+}
+}
+
+DbWorkScheduler::DbWorkScheduler(const QString& sourceConnectionName, int workers, QObject* parent)
+    : QObject(parent)
+    , sourceConnection(sourceConnectionName)
+    , interactiveScopes(0)
+    , stopping(false)
+{
+    workers = qMax(1, workers);
+    for (int i = 0; i < PriorityCount; ++i) {
+        limits[i] = workers;
+        running[i] = 0;
+    }
+    // 批量任务最多占用一个线程，其余线程始终留给交互操作
+    limits[Bulk] = 1;
+
+    for (int i = 0; i < workers; ++i) {
+        QThread* thread = QThread::create([this, i]() { workerLoop(i); });
+        thread->setObjectName(QString("dbwork_%1").arg(i));
+        threads.append(thread);
+        thread->start();
+    }
+}
+
+DbWorkScheduler::~DbWorkScheduler()
+{
+    stop();
+}
+
+void DbWorkScheduler::setConcurrencyLimit(Priority priority, int limit)
+{
+    QMutexLocker locker(&mutex);
+    limits[priority] = qBound(1, limit, qMax(1, int(threads.size())));
+    wake.wakeAll();
+}
+
+void DbWorkScheduler::submit(Priority priority, Work work)
+{
+    QMutexLocker locker(&mutex);
+    if (stopping) return;
+
+    Job job;
+    job.priority = priority;
+    job.work = std::move(work);
+    job.queuedAt.start();
+    queues[priority].enqueue(std::move(job));
+    ++stats[priority].submitted;
+    wake.wakeOne();
+}
+
+void DbWorkScheduler::stop()
+{
+    {
+        QMutexLocker locker(&mutex);
+        if (stopping) return;
+        stopping = true;
+        for (QQueue<Job>& queue : queues) queue.clear();
+        wake.wakeAll();
+    }
+
+    for (QThread* thread : threads) {
+        thread->wait();
+        delete thread;
+    }
+    threads.clear();
+}
+
+DbWorkScheduler::Metrics DbWorkScheduler::metrics(Priority priority) const
+{
+    QMutexLocker locker(&mutex);
+    Metrics result = stats[priority];
+    result.queued = queues[priority].size();
+    result.running = running[priority];
+    return result;
+}
+
+QString DbWorkScheduler::summary() const
+{
+    QStringList parts;
+    for (int i = 0; i < PriorityCount; ++i) {
+        const Metrics m = metrics(Priority(i));
+        parts << QString("%1 排队%2 执行中%3 平均等待%4ms 最长等待%5ms 平均耗时%6ms")
+                     .arg(priorityName(i))
+                     .arg(m.queued)
+                     .arg(m.running)
+                     .arg(m.averageWaitMs(), 0, 'f', 1)
+                     .arg(m.maxWaitUs / 1000.0, 0, 'f', 1)
+                     .arg(m.averageRunMs(), 0, 'f', 1);
+    }
+    return parts.join("；");
+}
+
+QSqlDatabase DbWorkScheduler::database()
+{
+    return QSqlDatabase::database(workerConnection, false);
+}
+
+// 按优先级取任务：高优先级队列非空且未到并发上限时先取；
+// 有交互操作在执行或排队时，不开始新的批量任务
+bool DbWorkScheduler::takeJob(Job& job)
+{
+    const bool interactiveBusy = interactiveScopes > 0
+        || !queues[InteractiveWrite].isEmpty() || !queues[InteractiveRead].isEmpty();
+
+    for (int i = 0; i < PriorityCount; ++i) {
+        if (queues[i].isEmpty() || running[i] >= limits[i]) continue;
+        if (i == Bulk && interactiveBusy) continue;
+
+        job = queues[i].dequeue();
+        ++running[i];
+        return true;
+    }
+    return false;
+}
+
+void DbWorkScheduler::workerLoop(int index)
+{
+    workerConnection = QString("%1_dbwork_%2").arg(sourceConnection).arg(index);
+    {
+        QSqlDatabase db = QSqlDatabase::cloneDatabase(sourceConnection, workerConnection);
+        if (!db.open()) {
+            qDebug() << "数据库工作线程连接失败:" << db.lastError().text();
+        }
+
+        QElapsedTimer lastProbe;
+        lastProbe.start();
+
+        QMutexLocker locker(&mutex);
+        for (;;) {
+            Job job;
+            while (!stopping && !takeJob(job)) wake.wait(&mutex);
+            if (stopping) break;
+
+            const qint64 waitUs = job.queuedAt.nsecsElapsed() / 1000;
+            locker.unlock();
+
+            // 连接断开时重连一次，失败的任务仍交给 work 处理（查询会返回错误）
+            if (!DbError::ensureOpen(db, lastProbe)) {
+                qDebug() << "数据库工作线程重连失败:" << db.lastError().text();
+            }
+
+            QElapsedTimer timer;
+            timer.start();
+            job.work(db);
+            const qint64 runUs = timer.nsecsElapsed() / 1000;
+
+            locker.relock();
+            Metrics& m = stats[job.priority];
+            --running[job.priority];
+            ++m.completed;
+            m.totalWaitUs += waitUs;
+            m.maxWaitUs = qMax(m.maxWaitUs, waitUs);
+            m.totalRunUs += runUs;
+            // 释放的名额可能让其他线程取到任务
+            wake.wakeAll();
+        }
+        locker.unlock();
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(workerConnection);
+}
+
+DbWorkScheduler::Scope::Scope(DbWorkScheduler* scheduler, Priority priority)
+    : scheduler(scheduler)
+    , priority(priority)
+{
+    if (!scheduler) return;
+    QMutexLocker locker(&scheduler->mutex);
+    ++scheduler->interactiveScopes;
+    ++scheduler->stats[priority].submitted;
+    timer.start();
+}
+
+DbWorkScheduler::Scope::~Scope()
+{
+    if (!scheduler) return;
+    const qint64 runUs = timer.nsecsElapsed() / 1000;
+    QMutexLocker locker(&scheduler->mutex);
+    --scheduler->interactiveScopes;
+    Metrics& m = scheduler->stats[priority];
+    ++m.completed;
+    m.totalRunUs += runUs;
+    scheduler->wake.wakeAll();
+}
@@ -0,0 +1,108 @@
+#ifndef DBWORKSCHEDULER_H
+#define DBWORKSCHEDULER_H
+
+#include <QObject>
+#include <QString>
+#include <QQueue>
+#include <QList>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QElapsedTimer>
+#include <QSqlDatabase>
+#include <QPointer>
+#include <functional>
+
+class QThread;
+
+// 数据库任务调度：固定数量的工作线程，每个线程持有自己的连接（线程局部）
+// 任务按优先级分类排队，空闲线程总是先取高优先级的任务，每类有独立的并发上限；
+// 批量/管理查询应拆成短小的分页任务，页与页之间让出给交互操作。
+// 主连接上同步执行的交互操作通过 Scope 登记，期间不派发新的批量任务。
+class DbWorkScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Priority { InteractiveWrite = 0, InteractiveRead = 1, Bulk = 2, PriorityCount = 3 };
+
+    struct Metrics
+    {
+        qint64 submitted = 0;
+        qint64 completed = 0;
+        int queued = 0;
+        int running = 0;
+        qint64 totalWaitUs = 0;   // 排队时间
+        qint64 maxWaitUs = 0;
+        qint64 totalRunUs = 0;    // 执行时间
+
+        double averageWaitMs() const { return completed ? totalWaitUs / 1000.0 / completed : 0.0; }
+        double averageRunMs() const { return completed ? totalRunUs / 1000.0 / completed : 0.0; }
+    };
+
+    using Work = std::function<void(QSqlDatabase&)>;
+
+    explicit DbWorkScheduler(const QString& sourceConnectionName, int workers = 3, QObject* parent = nullptr);
+    ~DbWorkScheduler();
+
+    void setConcurrencyLimit(Priority priority, int limit);
+    void submit(Priority priority, Work work);
+
+    // 在工作线程执行 work，结果投递回 context 所在线程；context 已销毁时丢弃
+    template <typename T>
+    void submit(Priority priority, QObject* context,
+                std::function<T(QSqlDatabase&)> work, std::function<void(const T&)> done)
+    {
+        QPointer<QObject> guard(context);
+        submit(priority, [guard, work, done](QSqlDatabase& db) {
+            const T result = work(db);
+            if (guard) QMetaObject::invokeMethod(guard, [done, result]() { done(result); }, Qt::QueuedConnection);
+        });
+    }
+
+    // 停止派发，等待正在执行的任务结束，未开始的任务被丢弃
+    void stop();
+
+    Metrics metrics(Priority priority) const;
+    QString summary() const;
+
+    // 当前工作线程的连接，仅在任务内部使用
+    static QSqlDatabase database();
+
+    // 登记在主连接上同步执行的交互操作，并计入该类的执行时间
+    class Scope
+    {
+    public:
+        Scope(DbWorkScheduler* scheduler, Priority priority);
+        ~Scope();
+
+    private:
+        DbWorkScheduler* scheduler;
+        Priority priority;
+        QElapsedTimer timer;
+    };
+
+private:
+    struct Job
+    {
+        Priority priority;
+        Work work;
+        QElapsedTimer queuedAt;
+    };
+
+    QString sourceConnection;
+    QList<QThread*> threads;
+
+    mutable QMutex mutex;
+    QWaitCondition wake;
+    QQueue<Job> queues[PriorityCount];
+    int limits[PriorityCount];
+    int running[PriorityCount];
+    Metrics stats[PriorityCount];
+    int interactiveScopes;
+    bool stopping;
+
+    void workerLoop(int index);
+    bool takeJob(Job& job);
+};
+
+#endif // DBWORKSCHEDULER_H
@@ -0,0 +1,416 @@
+#include "interestaccrual.h"
+#include "money.h"
+#include "dberror.h"
+#include "schema.h"
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QThread>
+#include <QStringList>
+#include <QDebug>
+#include <functional>
+
+namespace {
+const qint64 kMicrosPerCent = 1000000;
+const qint64 kDayCountBasis = 360;      // 日利率 = 年利率 / 360
+const int kWriteBatchSize = 1000;       // 每条多行 UPDATE / INSERT 的行数
+const int kMaxAttempts = 3;             // 死锁或锁等待超时时的重试次数
+
+class ChunkTask : public QRunnable
+{
+public:
+    ChunkTask(std::function<void()> work) : work(std::move(work)) {}
+    void run() override { work(); }
+
+private:
+    std::function<void()> work;
+};
+}
+
+InterestAccrual::InterestAccrual(const QString& sourceConnectionName, QObject* parent)
+    : QObject(parent)
+    , sourceConnection(sourceConnectionName)
+    , threads(QThread::idealThreadCount())
+    , chunkSize(5000)
+    , accrued(0)
+    , interestTotal(0)
+    , completedChunks(0)
+    , cancelled(0)
+{
+}
+
+void InterestAccrual::setThreadCount(int count)
+{
+    threads = qMax(1, count);
+}
+
+void InterestAccrual::setChunkSize(int accounts)
+{
+    chunkSize = qBound(100, accounts, 50000);
+}
+
+void InterestAccrual::cancel()
+{
+    cancelled.storeRelaxed(1);
+}
+
+qint64 InterestAccrual::accountsAccrued() const
+{
+    return accrued.loadRelaxed();
+}
+
+qint64 InterestAccrual::interestCents() const
+{
+    return interestTotal.loadRelaxed();
+}
+
+void InterestAccrual::accrueDaily(const qint64* balances, const qint64* annualRatesPpm,
+                                  qint64* carries, qint64* interest, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        // 负余额不计息：max(balance, 0) 的无分支写法
+        const qint64 positive = balances[i] & ~(balances[i] >> 63);
+        const qint64 micros = positive * annualRatesPpm[i] / kDayCountBasis + carries[i];
+        interest[i] = micros / kMicrosPerCent;
+        carries[i] = micros % kMicrosPerCent;
+    }
+}
+
+bool InterestAccrual::run(const QDate& accrualDate)
+{
+    date = accrualDate;
+    cancelled.storeRelaxed(0);
+    accrued.storeRelaxed(0);
+    interestTotal.storeRelaxed(0);
+    completedChunks.storeRelaxed(0);
+
+    const QString connectionName = QString("%1_interest").arg(sourceConnection);
+    bool success = false;
+    {
+        QSqlDatabase db = QSqlDatabase::cloneDatabase(sourceConnection, connectionName);
+        if (!db.open()) {
+            qDebug() << "计息连接失败:" << db.lastError().text();
+        }
+
+        // 多个客户端同时运行时只允许一个执行计息
+        QSqlQuery lockQuery(db);
+        if (db.isOpen() && (!lockQuery.exec("SELECT GET_LOCK('banksystem_interest', 0)") || !lockQuery.next()
+                            || lockQuery.value(0).toInt() != 1)) {
+            qDebug() << "计息任务已由其他实例执行";
+        } else if (db.isOpen()) {
+            QVector<Chunk> pending;
+            int total = 0;
+
+            if (loadRates(db) && prepareRun(db, pending, total)) {
+                completedChunks.storeRelaxed(total - pending.size());
+                qDebug() << "开始计息:" << date.toString(Qt::ISODate) << "区间数:" << total
+                         << "待处理:" << pending.size() << "线程数:" << threads;
+
+                QThreadPool pool;
+                pool.setMaxThreadCount(threads);
+                QAtomicInteger<int> failures(0);
+
+                for (const Chunk& chunk : pending) {
+                    pool.start(new ChunkTask([this, chunk, total, &failures]() {
+                        if (cancelled.loadRelaxed()) return;
+                        if (!accrueChunk(chunk)) {
+                            failures.fetchAndAddRelaxed(1);
+                            return;
+                        }
+                        emit progress(completedChunks.fetchAndAddRelaxed(1) + 1, total);
+                    }));
+                }
+                pool.waitForDone();
+
+                // total 为 0 表示该日此前已完成
+                success = failures.loadRelaxed() == 0 && !cancelled.loadRelaxed()
+                          && (total == 0 || finishRun(db));
+            }
+
+            lockQuery.exec("SELECT RELEASE_LOCK('banksystem_interest')");
+            db.close();
+        }
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+
+    qDebug() << "计息结束，入账账户:" << accountsAccrued()
+             << "利息:" << Money::toDecimalString(interestCents()) << "成功:" << success;
+    emit finished(success);
+    return success;
+}
+
+bool InterestAccrual::loadRates(QSqlDatabase& db)
+{
+    ratesPpm.clear();
+
+    QSqlQuery query(db);
+    query.setNumericalPrecisionPolicy(QSql::HighPrecision);
+    if (!query.exec("SELECT type_code, annual_rate FROM interest_rates")) {
+        qDebug() << "读取利率失败:" << query.lastError().text();
+        return false;
+    }
+
+    // annual_rate 为 DECIMAL(9,6)，按字符串换算成百万分之一，避免浮点误差
+    while (query.next()) {
+        const QString text = query.value(1).toString();
+        const int dot = text.indexOf('.');
+        const QString fraction = dot < 0 ? QString() : text.mid(dot + 1);
+        const qint64 ppm = (dot < 0 ? text : text.left(dot)).toLongLong() * 1000000
+                           + (fraction + "000000").left(6).toLongLong();
+        ratesPpm.insert(query.value(0).toInt(), ppm);
+    }
+    return true;
+}
+
+// 读取该日的计息进度；首次运行时切分区间并登记
+bool InterestAccrual::prepareRun(QSqlDatabase& db, QVector<Chunk>& pending, int& totalChunks)
+{
+    QSqlQuery query(db);
+    query.prepare("SELECT status FROM interest_accrual_runs WHERE accrual_date = :date");
+    query.bindValue(":date", date);
+    if (!query.exec()) {
+        qDebug() << "读取计息进度失败:" << query.lastError().text();
+        return false;
+    }
+
+    if (!query.next()) {
+        if (!buildChunks(db)) return false;
+    } else if (query.value(0).toString() == "done") {
+        qDebug() << "该日已完成计息:" << date.toString(Qt::ISODate);
+        return true;
+    }
+
+    query.prepare("SELECT chunk_no, low_account, high_account, status FROM interest_accrual_chunks "
+                  "WHERE accrual_date = :date ORDER BY chunk_no");
+    query.bindValue(":date", date);
+    if (!query.exec()) {
+        qDebug() << "读取计息区间失败:" << query.lastError().text();
+        return false;
+    }
+
+    totalChunks = 0;
+    while (query.next()) {
+        ++totalChunks;
+        if (query.value(3).toString() == "done") continue;
+
+        Chunk chunk;
+        chunk.number = query.value(0).toInt();
+        chunk.low = Schema::accountId(query.value(1));
+        chunk.high = Schema::accountId(query.value(2));
+        pending.append(chunk);
+    }
+    return true;
+}
+
+// 按账户号切分区间，与运行记录在同一事务中写入
+bool InterestAccrual::buildChunks(QSqlDatabase& db)
+{
+    QVector<Chunk> chunks;
+    {
+        QSqlQuery query(db);
+        query.setForwardOnly(true);
+        if (!query.exec("SELECT account_id FROM accounts ORDER BY account_id")) {
+            qDebug() << "读取账户列表失败:" << query.lastError().text();
+            return false;
+        }
+
+        QString low;
+        int count = 0;
+        while (query.next()) {
+            if (++count > chunkSize) {
+                const QString high = query.value(0).toString();
+                chunks.append({ int(chunks.size()), low, high });
+                low = high;
+                count = 1;
+            }
+        }
+        chunks.append({ int(chunks.size()), low, QString() });
+    }
+
+    if (!db.transaction()) return false;
+
+    QSqlQuery query(db);
+    query.prepare("INSERT INTO interest_accrual_runs (accrual_date, chunks) VALUES (:date, :chunks)");
+    query.bindValue(":date", date);
+    query.bindValue(":chunks", chunks.size());
+    bool ok = query.exec();
+
+    for (int offset = 0; ok && offset < chunks.size(); offset += kWriteBatchSize) {
+        const int count = qMin(kWriteBatchSize, int(chunks.size()) - offset);
+        QStringList rows;
+        for (int i = 0; i < count; ++i) rows.append("(?, ?, ?, ?)");
+
+        query.prepare("INSERT INTO interest_accrual_chunks (accrual_date, chunk_no, low_account, high_account) "
+                      "VALUES " + rows.join(','));
+        for (int i = offset; i < offset + count; ++i) {
+            query.addBindValue(date);
+            query.addBindValue(chunks.at(i).number);
+            query.addBindValue(Schema::accountKey(chunks.at(i).low));
+            query.addBindValue(Schema::accountKey(chunks.at(i).high));
+        }
+        ok = query.exec();
+    }
+
+    if (!ok || !db.commit()) {
+        qDebug() << "登记计息区间失败:" << query.lastError().text();
+        db.rollback();
+        return false;
+    }
+    return true;
+}
+
+bool InterestAccrual::finishRun(QSqlDatabase& db)
+{
+    QSqlQuery query(db);
+    query.prepare("UPDATE interest_accrual_runs r "
+                  "JOIN (SELECT SUM(accounts) AS accounts, SUM(interest) AS interest "
+                  "      FROM interest_accrual_chunks WHERE accrual_date = :chunk_date) c "
+                  "SET r.status = 'done', r.accounts = COALESCE(c.accounts, 0), "
+                  "    r.interest = COALESCE(c.interest, 0), r.finished_at = NOW() "
+                  "WHERE r.accrual_date = :date");
+    query.bindValue(":chunk_date", date);
+    query.bindValue(":date", date);
+
+    if (!query.exec()) {
+        qDebug() << "更新计息运行记录失败:" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+bool InterestAccrual::accrueChunk(const Chunk& chunk)
+{
+    const QString connectionName = QString("%1_interest_%2")
+                                       .arg(sourceConnection)
+                                       .arg(quintptr(QThread::currentThreadId()));
+    bool ok = false;
+    {
+        QSqlDatabase db = QSqlDatabase::contains(connectionName)
+                              ? QSqlDatabase::database(connectionName, false)
+                              : QSqlDatabase::cloneDatabase(sourceConnection, connectionName);
+        if (!DbError::ensureOpen(db)) {
+            qDebug() << "计息连接失败:" << db.lastError().text();
+        } else {
+            for (int attempt = 1; attempt <= kMaxAttempts && !ok; ++attempt) {
+                QString errorCode;
+                ok = accrueChunk(db, chunk, errorCode);
+                if (!ok && !DbError::isLockConflict(errorCode)) break;
+                if (!ok && attempt < kMaxAttempts) QThread::msleep(DbError::backoffMs(attempt, 20, 500));
+            }
+            db.close();
+        }
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+    return ok;
+}
+
+// 一个区间一个事务：锁定区间内账户，计算后批量写回
+bool InterestAccrual::accrueChunk(QSqlDatabase& db, const Chunk& chunk, QString& errorCode)
+{
+    auto fail = [&db, &errorCode](const QSqlQuery& query, const char* what) {
+        errorCode = query.lastError().nativeErrorCode();
+        qDebug() << what << query.lastError().text();
+        db.rollback();
+        return false;
+    };
+
+    if (!db.transaction()) return false;
+
+    QString bounds;
+    if (!chunk.low.isEmpty()) bounds += " AND account_id >= :low";
+    if (!chunk.high.isEmpty()) bounds += " AND account_id < :high";
+
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    query.setNumericalPrecisionPolicy(QSql::HighPrecision);
+    query.prepare(QString("SELECT account_id, account_type, balance, interest_carry FROM accounts "
+                          "WHERE balance > 0 AND status <> %1").arg(Schema::Closed)
+                  + bounds + " ORDER BY account_id FOR UPDATE");
+    if (!chunk.low.isEmpty()) query.bindValue(":low", Schema::accountKey(chunk.low));
+    if (!chunk.high.isEmpty()) query.bindValue(":high", Schema::accountKey(chunk.high));
+    if (!query.exec()) return fail(query, "读取账户余额失败:");
+
+    // 按列连续存放，计算阶段不再访问 QVariant
+    QStringList accountIds;
+    QVector<qint64> balances, rates, carries;
+    accountIds.reserve(chunkSize);
+    balances.reserve(chunkSize);
+    rates.reserve(chunkSize);
+    carries.reserve(chunkSize);
+    while (query.next()) {
+        accountIds.append(query.value(0).toString());
+        rates.append(ratesPpm.value(query.value(1).toInt(), 0));
+        balances.append(Money::toCents(query.value(2)));
+        carries.append(query.value(3).toLongLong());
+    }
+
+    const int count = accountIds.size();
+    QVector<qint64> interest(count);
+    accrueDaily(balances.constData(), rates.constData(), carries.data(), interest.data(), count);
+
+    // 多行 UPDATE：JOIN 一个 VALUES 派生表，一条语句写回一批账户
+    for (int offset = 0; offset < count; offset += kWriteBatchSize) {
+        const int batch = qMin(kWriteBatchSize, count - offset);
+        QStringList rows;
+        for (int i = 0; i < batch; ++i) rows.append("ROW(?, ?, ?)");
+
+        query.prepare("UPDATE accounts a JOIN (VALUES " + rows.join(',') + ") AS v (account_id, interest, carry) "
+                      "ON a.account_id = v.account_id "
+                      "SET a.balance = a.balance + v.interest, a.interest_carry = v.carry");
+        for (int i = offset; i < offset + batch; ++i) {
+            query.addBindValue(Schema::accountKey(accountIds.at(i)));
+            query.addBindValue(Money::toDecimalString(interest.at(i)));
+            query.addBindValue(carries.at(i));
+        }
+        if (!query.exec()) return fail(query, "写回利息失败:");
+    }
+
+    // 每个账户当日一条利息流水；批量计息不写变更事件，会话重新加载时可见
+    const QString description = QString("利息入账 %1").arg(date.toString(Qt::ISODate));
+    qint64 chunkInterest = 0;
+    int posted = 0;
+    QStringList rows;
+    QVariantList values;
+    for (int i = 0; i <= count; ++i) {
+        if (i < count && interest.at(i) > 0) {
+            rows.append(QString("(?, %1, ?, ?)").arg(Schema::Interest));
+            values << Schema::accountKey(accountIds.at(i)) << Money::toDecimalString(interest.at(i)) << description;
+            chunkInterest += interest.at(i);
+            ++posted;
+        }
+        if (rows.size() == kWriteBatchSize || (i == count && !rows.isEmpty())) {
+            query.prepare("INSERT INTO transactions (account_id, transaction_type, amount, description) VALUES "
+                          + rows.join(','));
+            for (const QVariant& value : values) query.addBindValue(value);
+            if (!query.exec()) return fail(query, "写入利息流水失败:");
+            rows.clear();
+            values.clear();
+        }
+    }
+
+    // 完成标记与入账在同一事务，重跑时跳过该区间
+    query.prepare("UPDATE interest_accrual_chunks SET status = 'done', accounts = :accounts, "
+                  "interest = :interest, finished_at = NOW() "
+                  "WHERE accrual_date = :date AND chunk_no = :chunk_no AND status = 'pending'");
+    query.bindValue(":accounts", posted);
+    query.bindValue(":interest", Money::toDecimalString(chunkInterest));
+    query.bindValue(":date", date);
+    query.bindValue(":chunk_no", chunk.number);
+    if (!query.exec()) return fail(query, "更新计息区间失败:");
+    if (query.numRowsAffected() != 1) {
+        db.rollback();
+        return true;
+    }
+
+    if (!db.commit()) {
+        errorCode = db.lastError().nativeErrorCode();
+        db.rollback();
+        return false;
+    }
+
+    accrued.fetchAndAddRelaxed(posted);
+    interestTotal.fetchAndAddRelaxed(chunkInterest);
+    return true;
+}
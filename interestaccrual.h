@@ -0,0 +1,70 @@
+#ifndef INTERESTACCRUAL_H
+#define INTERESTACCRUAL_H
+
+#include <QObject>
+#include <QString>
+#include <QDate>
+#include <QHash>
+#include <QVector>
+#include <QAtomicInteger>
+
+class QSqlDatabase;
+
+// 每日计息：按账户号区间并行读取余额，按账户类型的年利率计算当日利息并入账
+// 区间边界登记在 interest_accrual_chunks，每个区间在一个事务内完成余额更新、利息流水与完成标记，
+// 中断后以同一计息日重新运行即可从未完成的区间继续，已完成的区间不会重复入账。
+// 不足 1 分的利息以微分（1e-6 分）累计在 accounts.interest_carry，凑满 1 分后入账。
+class InterestAccrual : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit InterestAccrual(const QString& sourceConnectionName, QObject* parent = nullptr);
+
+    void setThreadCount(int count);
+    void setChunkSize(int accounts);
+
+    // 阻塞执行，可在工作线程或无界面模式下调用；该日已完成时直接返回 true
+    bool run(const QDate& accrualDate);
+    void cancel();
+
+    qint64 accountsAccrued() const;
+    qint64 interestCents() const;
+
+    // 日息计算（按 360 天计息基准）：余额为分，年利率为百万分之一，结余为微分；
+    // 各数组连续存放且循环体无分支，便于编译器向量化
+    static void accrueDaily(const qint64* balances, const qint64* annualRatesPpm,
+                            qint64* carries, qint64* interest, int count);
+
+signals:
+    void progress(int completedChunks, int totalChunks);
+    void finished(bool success);
+
+private:
+    struct Chunk
+    {
+        int number = 0;
+        QString low;   // 含，空表示不限
+        QString high;  // 不含，空表示不限
+    };
+
+    QString sourceConnection;
+    int threads;
+    int chunkSize;
+    QDate date;
+    QHash<int, qint64> ratesPpm;   // account_types.type_code -> 年利率（百万分之一）
+
+    QAtomicInteger<qint64> accrued;
+    QAtomicInteger<qint64> interestTotal;
+    QAtomicInteger<int> completedChunks;
+    QAtomicInteger<int> cancelled;
+
+    bool loadRates(QSqlDatabase& db);
+    bool prepareRun(QSqlDatabase& db, QVector<Chunk>& pending, int& totalChunks);
+    bool buildChunks(QSqlDatabase& db);
+    bool finishRun(QSqlDatabase& db);
+    bool accrueChunk(const Chunk& chunk);
+    bool accrueChunk(QSqlDatabase& db, const Chunk& chunk, QString& errorCode);
+};
+
+#endif // INTERESTACCRUAL_H
@@ -0,0 +1,64 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <QString>
+#include <QVariant>
+#include <QSqlQuery>
+#include "schema.h"
+
+// 转账的单行复式分录
+// 一笔转账在 transactions 中只有一行：account_id 为转出方（借方分录），credit_account 为转入方（贷方分录），
+// target_account 仍是显示给转出方的对方账户。按账户读取流水时两条分录都要取：借方走 account_id 上的索引，
+// 贷方走 idx_transactions_credit_time，还原为原来的“收款”行：对调双方账户，描述“转账支出”改为“转账收入”，
+// 交易号与借方相同。credit_account 为空的行只有借方分录（存取款、利息，或转入方已销户清理）。
+namespace Journal {
+
+inline QString creditDescription(const QString& description)
+{
+    return description == QStringLiteral("转账支出") ? QStringLiteral("转账收入") : description;
+}
+
+// 贷方分录描述的 SQL 表达式，alias 为 transactions 的表别名
+inline QString creditDescriptionSql(const QString& alias)
+{
+    return QString("CASE WHEN %1.description = '转账支出' THEN '转账收入' ELSE %1.description END").arg(alias);
+}
+
+// 贷方分录按描述关键字筛选的条件：直接比较 description 列，可由索引条件下推判断。
+// 显示为“转账收入”的行（原描述“转账支出”）是否匹配由 needle 在程序中决定；
+// placeholder 绑定已转义的 LIKE 模式，两边的比较都不区分大小写（列的排序规则为 _ci）
+inline QString creditDescriptionFilterSql(const QString& alias, const QString& placeholder, const QString& needle)
+{
+    if (QStringLiteral("转账收入").contains(needle, Qt::CaseInsensitive)) {
+        return QString("(%1.description = '转账支出' OR %1.description LIKE %2)").arg(alias, placeholder);
+    }
+    return QString("(%1.description <> '转账支出' AND %1.description LIKE %2)").arg(alias, placeholder);
+}
+
+// 按 (分录账户, 类型) 汇总流水，结果列与原来的
+// SELECT account_id, transaction_type, SUM(amount) ... GROUP BY account_id, transaction_type 相同（类型为名称）。
+// condition 中 %1 为分录账户列、%2 为占位符后缀：借方、贷方两段各用一组占位符，用 bindLegs() 绑定；
+// 账户号的边界须以 Schema::accountKey() 换算后绑定
+inline QString postingTotalsSql(const QString& condition)
+{
+    QString debit = condition;
+    debit.replace("%1", "account_id").replace("%2", QString());
+    QString credit = condition;
+    credit.replace("%1", "credit_account").replace("%2", "_credit");
+
+    return "SELECT account_id, " + Schema::transactionTypeSql("transaction_type") + ", SUM(amount) FROM transactions "
+           "WHERE " + debit + " GROUP BY account_id, transaction_type "
+           "UNION ALL "
+           "SELECT credit_account, '收款', SUM(amount) FROM transactions "
+           "WHERE " + credit + " GROUP BY credit_account";
+}
+
+inline void bindLegs(QSqlQuery& query, const QString& placeholder, const QVariant& value)
+{
+    query.bindValue(placeholder, value);
+    query.bindValue(placeholder + "_credit", value);
+}
+
+} // namespace Journal
+
+#endif // JOURNAL_H
@@ -0,0 +1,402 @@
+#include "ledgerreconciler.h"
+#include "money.h"
+#include "journal.h"
+#include "schema.h"
+#include "dberror.h"
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QThread>
+#include <QHash>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QSaveFile>
+#include <QTextStream>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QStandardPaths>
+#include <QDateTime>
+#include <QMutexLocker>
+#include <QDebug>
+#include <algorithm>
+#include <functional>
+
+namespace {
+// 每个区间一个任务，任务内使用独立的数据库连接
+class RangeTask : public QRunnable
+{
+public:
+    RangeTask(std::function<void()> work) : work(std::move(work)) {}
+    void run() override { work(); }
+
+private:
+    std::function<void()> work;
+};
+}
+
+LedgerReconciler::LedgerReconciler(const QString& sourceConnectionName, QObject* parent)
+    : QObject(parent)
+    , sourceConnection(sourceConnectionName)
+    , checkpointPath(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)
+                     + "/reconciliation_checkpoint.json")
+    , threads(QThread::idealThreadCount())
+    , rangeSize(20000)
+    , checkedAccounts(0)
+    , scannedGroups(0)
+    , cancelled(0)
+{
+}
+
+void LedgerReconciler::setThreadCount(int count)
+{
+    threads = qMax(1, count);
+}
+
+void LedgerReconciler::setRangeSize(int accounts)
+{
+    rangeSize = qMax(100, accounts);
+}
+
+void LedgerReconciler::setCheckpointFile(const QString& path)
+{
+    checkpointPath = path;
+}
+
+QString LedgerReconciler::checkpointFile() const
+{
+    return checkpointPath;
+}
+
+void LedgerReconciler::cancel()
+{
+    cancelled.storeRelaxed(1);
+}
+
+QList<ReconciliationDiscrepancy> LedgerReconciler::discrepancies() const
+{
+    QMutexLocker locker(&stateMutex);
+    return found;
+}
+
+qint64 LedgerReconciler::accountsChecked() const
+{
+    return checkedAccounts.loadRelaxed();
+}
+
+qint64 LedgerReconciler::postingGroupsScanned() const
+{
+    return scannedGroups.loadRelaxed();
+}
+
+bool LedgerReconciler::run(bool resume)
+{
+    cancelled.storeRelaxed(0);
+    checkedAccounts.storeRelaxed(0);
+    scannedGroups.storeRelaxed(0);
+
+    {
+        QMutexLocker locker(&stateMutex);
+        ranges.clear();
+        completed.clear();
+        found.clear();
+    }
+
+    if (!(resume && loadCheckpoint()) && !buildRanges()) {
+        emit finished(false);
+        return false;
+    }
+
+    const int total = ranges.size();
+    qDebug() << "开始对账，区间数:" << total << "已完成:" << completed.size() << "线程数:" << threads;
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(threads);
+    QAtomicInteger<int> failures(0);
+
+    for (int i = 0; i < total; ++i) {
+        if (completed.contains(i)) continue;
+
+        pool.start(new RangeTask([this, i, total, &failures]() {
+            if (cancelled.loadRelaxed()) return;
+            if (!reconcileRange(i)) {
+                failures.fetchAndAddRelaxed(1);
+                return;
+            }
+
+            int done = 0;
+            {
+                QMutexLocker locker(&stateMutex);
+                done = completed.size();
+            }
+            emit progress(done, total);
+        }));
+    }
+    pool.waitForDone();
+
+    const bool success = failures.loadRelaxed() == 0 && !cancelled.loadRelaxed();
+    if (success) {
+        QFile::remove(checkpointPath);
+    }
+
+    qDebug() << "对账结束，检查账户:" << accountsChecked()
+             << "差异:" << discrepancies().size() << "成功:" << success;
+    emit finished(success);
+    return success;
+}
+
+// 按账户号切分区间，边界写入检查点，续跑时区间保持不变
+bool LedgerReconciler::buildRanges()
+{
+    const QString connectionName = QString("%1_reconcile_ranges").arg(sourceConnection);
+    bool ok = true;
+    {
+        QSqlDatabase db = QSqlDatabase::cloneDatabase(sourceConnection, connectionName);
+        if (!db.open()) {
+            qDebug() << "对账连接失败:" << db.lastError().text();
+            ok = false;
+        } else {
+            QSqlQuery query(db);
+            query.setForwardOnly(true);
+            if (!query.exec("SELECT account_id FROM accounts ORDER BY account_id")) {
+                qDebug() << "读取账户列表失败:" << query.lastError().text();
+                ok = false;
+            } else {
+                QString low;
+                int count = 0;
+                while (query.next()) {
+                    if (++count > rangeSize) {
+                        const QString high = query.value(0).toString();
+                        ranges.append({ low, high });
+                        low = high;
+                        count = 1;
+                    }
+                }
+                ranges.append({ low, QString() });
+            }
+        }
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+
+    return ok && saveCheckpoint();
+}
+
+bool LedgerReconciler::reconcileRange(int index)
+{
+    const QString connectionName = QString("%1_reconcile_%2")
+                                       .arg(sourceConnection)
+                                       .arg(quintptr(QThread::currentThreadId()));
+    QList<ReconciliationDiscrepancy> result;
+    bool ok = false;
+    {
+        QSqlDatabase db = QSqlDatabase::contains(connectionName)
+                              ? QSqlDatabase::database(connectionName, false)
+                              : QSqlDatabase::cloneDatabase(sourceConnection, connectionName);
+        if (!DbError::ensureOpen(db)) {
+            qDebug() << "对账连接失败:" << db.lastError().text();
+        } else {
+            ok = reconcileRange(db, ranges.at(index), result);
+            db.close();
+        }
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+
+    if (!ok) return false;
+
+    QMutexLocker locker(&stateMutex);
+    found.append(result);
+    completed.insert(index);
+    saveCheckpoint();
+    return true;
+}
+
+bool LedgerReconciler::reconcileRange(QSqlDatabase& db, const Range& range,
+                                      QList<ReconciliationDiscrepancy>& result)
+{
+    QString bounds;
+    if (!range.low.isEmpty()) bounds += " AND account_id >= :low";
+    if (!range.high.isEmpty()) bounds += " AND account_id < :high";
+
+    auto bindRange = [&range](QSqlQuery& query) {
+        if (!range.low.isEmpty()) query.bindValue(":low", Schema::accountKey(range.low));
+        if (!range.high.isEmpty()) query.bindValue(":high", Schema::accountKey(range.high));
+    };
+
+    // 同一快照内读取余额与流水，避免并发交易造成误报
+    QSqlQuery query(db);
+    if (!query.exec("SET SESSION TRANSACTION ISOLATION LEVEL REPEATABLE READ")
+        || !query.exec("START TRANSACTION WITH CONSISTENT SNAPSHOT")) {
+        qDebug() << "开启一致性快照失败:" << query.lastError().text();
+        return false;
+    }
+
+    QHash<QString, qint64> ledger;
+    query.setForwardOnly(true);
+    query.setNumericalPrecisionPolicy(QSql::HighPrecision);
+
+    // 按 (账户, 类型) 聚合，借方走 idx_transactions_account_type_amount 覆盖索引，
+    // 转入的贷方分录按 credit_account 聚合
+    QString legBounds = "1 = 1";
+    if (!range.low.isEmpty()) legBounds += " AND %1 >= :low%2";
+    if (!range.high.isEmpty()) legBounds += " AND %1 < :high%2";
+    query.prepare(Journal::postingTotalsSql(legBounds));
+    if (!range.low.isEmpty()) Journal::bindLegs(query, ":low", Schema::accountKey(range.low));
+    if (!range.high.isEmpty()) Journal::bindLegs(query, ":high", Schema::accountKey(range.high));
+    if (!query.exec()) {
+        qDebug() << "汇总交易流水失败:" << query.lastError().text();
+        query.exec("ROLLBACK");
+        return false;
+    }
+    while (query.next()) {
+        ledger[query.value(0).toString()] +=
+            Money::postingSign(query.value(1).toString()) * Money::toCents(query.value(2));
+        scannedGroups.fetchAndAddRelaxed(1);
+    }
+
+    query.prepare("SELECT account_id, net_amount FROM archived_account_flows WHERE 1 = 1" + bounds);
+    bindRange(query);
+    if (!query.exec()) {
+        qDebug() << "读取归档净额失败:" << query.lastError().text();
+        query.exec("ROLLBACK");
+        return false;
+    }
+    while (query.next()) {
+        ledger[query.value(0).toString()] += Money::toCents(query.value(1));
+    }
+
+    query.prepare("SELECT account_id, balance, status FROM accounts WHERE 1 = 1" + bounds);
+    bindRange(query);
+    if (!query.exec()) {
+        qDebug() << "读取账户余额失败:" << query.lastError().text();
+        query.exec("ROLLBACK");
+        return false;
+    }
+    while (query.next()) {
+        const QString accountId = query.value(0).toString();
+        const qint64 balance = Money::toCents(query.value(1));
+        const qint64 net = ledger.take(accountId);
+        // 已销户账户的流水正在分批清理，余额与剩余流水不再对应
+        if (query.value(2).toInt() == Schema::Closed) continue;
+        checkedAccounts.fetchAndAddRelaxed(1);
+
+        if (balance != net) {
+            ReconciliationDiscrepancy item;
+            item.accountId = accountId;
+            item.balanceCents = balance;
+            item.ledgerCents = net;
+            result.append(item);
+        }
+    }
+
+    // 剩余的是没有对应账户的孤立流水
+    for (auto it = ledger.constBegin(); it != ledger.constEnd(); ++it) {
+        if (it.value() == 0) continue;
+        ReconciliationDiscrepancy item;
+        item.accountId = it.key();
+        item.ledgerCents = it.value();
+        item.accountMissing = true;
+        result.append(item);
+    }
+
+    query.exec("COMMIT");
+    return true;
+}
+
+bool LedgerReconciler::loadCheckpoint()
+{
+    QFile file(checkpointPath);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+
+    const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    const QJsonArray rangeArray = root["ranges"].toArray();
+    if (rangeArray.isEmpty()) return false;
+
+    QMutexLocker locker(&stateMutex);
+    for (const QJsonValue& value : rangeArray) {
+        const QJsonObject object = value.toObject();
+        ranges.append({ object["low"].toString(), object["high"].toString() });
+    }
+    for (const QJsonValue& value : root["completed"].toArray()) {
+        completed.insert(value.toInt());
+    }
+    for (const QJsonValue& value : root["discrepancies"].toArray()) {
+        const QJsonObject object = value.toObject();
+        ReconciliationDiscrepancy item;
+        item.accountId = object["account_id"].toString();
+        item.balanceCents = object["balance_cents"].toString().toLongLong();
+        item.ledgerCents = object["ledger_cents"].toString().toLongLong();
+        item.accountMissing = object["account_missing"].toBool();
+        found.append(item);
+    }
+
+    qDebug() << "从检查点恢复对账:" << checkpointPath;
+    return true;
+}
+
+// 调用方需持有 stateMutex（run 开始前单线程调用时除外）
+bool LedgerReconciler::saveCheckpoint() const
+{
+    QJsonArray rangeArray;
+    for (const Range& range : ranges) {
+        rangeArray.append(QJsonObject{ { "low", range.low }, { "high", range.high } });
+    }
+
+    QJsonArray completedArray;
+    for (int index : completed) {
+        completedArray.append(index);
+    }
+
+    // 金额以字符串保存，避免 JSON 数字精度丢失
+    QJsonArray discrepancyArray;
+    for (const ReconciliationDiscrepancy& item : found) {
+        discrepancyArray.append(QJsonObject{
+            { "account_id", item.accountId },
+            { "balance_cents", QString::number(item.balanceCents) },
+            { "ledger_cents", QString::number(item.ledgerCents) },
+            { "account_missing", item.accountMissing } });
+    }
+
+    QJsonObject root;
+    root["ranges"] = rangeArray;
+    root["completed"] = completedArray;
+    root["discrepancies"] = discrepancyArray;
+    root["updated_at"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+
+    QDir().mkpath(QFileInfo(checkpointPath).absolutePath());
+    QSaveFile file(checkpointPath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "无法写入对账检查点:" << checkpointPath;
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    return file.commit();
+}
+
+bool LedgerReconciler::writeReport(const QString& path) const
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qDebug() << "无法写入对账报告:" << path;
+        return false;
+    }
+
+    QList<ReconciliationDiscrepancy> items = discrepancies();
+    std::sort(items.begin(), items.end(),
+              [](const ReconciliationDiscrepancy& a, const ReconciliationDiscrepancy& b) {
+                  return a.accountId < b.accountId;
+              });
+
+    QTextStream out(&file);
+    out << "account_id,balance,ledger,difference,note\n";
+    for (const ReconciliationDiscrepancy& item : items) {
+        out << item.accountId << ','
+            << Money::toDecimalString(item.balanceCents) << ','
+            << Money::toDecimalString(item.ledgerCents) << ','
+            << Money::toDecimalString(item.balanceCents - item.ledgerCents) << ','
+            << (item.accountMissing ? "账户不存在" : "余额不符") << '\n';
+    }
+    return true;
+}
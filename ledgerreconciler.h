@@ -0,0 +1,78 @@
+#ifndef LEDGERRECONCILER_H
+#define LEDGERRECONCILER_H
+
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QVector>
+#include <QSet>
+#include <QMutex>
+#include <QAtomicInteger>
+
+class QSqlDatabase;
+
+// 一条对账差异：accounts.balance 与交易流水净额不一致
+struct ReconciliationDiscrepancy
+{
+    QString accountId;
+    qint64 balanceCents = 0;   // accounts.balance
+    qint64 ledgerCents = 0;    // 在线流水 + 已归档流水净额
+    bool accountMissing = false; // 流水存在但账户已不存在
+};
+
+// 账务核对：按账户号区间并行扫描 transactions，校验每个账户余额
+// 每个区间在独立连接的一致性快照内完成，完成后写入检查点文件，可中断后续跑。
+class LedgerReconciler : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit LedgerReconciler(const QString& sourceConnectionName, QObject* parent = nullptr);
+
+    void setThreadCount(int count);
+    void setRangeSize(int accounts);
+    void setCheckpointFile(const QString& path);
+    QString checkpointFile() const;
+
+    // 阻塞执行，可在工作线程或无界面模式下调用；resume 为 true 时从检查点继续
+    bool run(bool resume);
+    void cancel();
+
+    QList<ReconciliationDiscrepancy> discrepancies() const;
+    qint64 accountsChecked() const;
+    qint64 postingGroupsScanned() const;
+    bool writeReport(const QString& path) const;
+
+signals:
+    void progress(int completedRanges, int totalRanges);
+    void finished(bool success);
+
+private:
+    struct Range
+    {
+        QString low;   // 含，空表示不限
+        QString high;  // 不含，空表示不限
+    };
+
+    QString sourceConnection;
+    QString checkpointPath;
+    int threads;
+    int rangeSize;
+
+    QVector<Range> ranges;
+    QSet<int> completed;
+    QList<ReconciliationDiscrepancy> found;
+    mutable QMutex stateMutex;
+    QAtomicInteger<qint64> checkedAccounts;
+    QAtomicInteger<qint64> scannedGroups;
+    QAtomicInteger<int> cancelled;
+
+    bool buildRanges();
+    bool loadCheckpoint();
+    bool saveCheckpoint() const;
+    bool reconcileRange(int index);
+    bool reconcileRange(QSqlDatabase& db, const Range& range,
+                        QList<ReconciliationDiscrepancy>& result);
+};
+
+#endif // LEDGERRECONCILER_H
@@ -1,7 +1,14 @@
 #include "loginwindow.h"
 #include "ui_loginwindow.h"
 #include "mainwindow.h"
+#include "authservice.h"
+#include "startupmetrics.h"
+#include <QSettings>
+#include <QStatusBar>
 #include <QMessageBox>
+#include <QInputDialog>
+#include <QLineEdit>
+#include <QTimer>
 #include <QDebug>
 
 LoginWindow::LoginWindow(QWidget *parent)
@@ -9,6 +16,8 @@ LoginWindow::LoginWindow(QWidget *parent)
     , ui(new Ui::LoginWindow)
     , dbManager(DatabaseManager::instance())
     , mainWindow(nullptr)
+    , loginQueued(false)
+    , manualConnect(false)
 {
     ui->setupUi(this);
     setWindowTitle("银行账户管理系统 - 登录");
@@ -19,6 +28,12 @@ LoginWindow::LoginWindow(QWidget *parent)
     connect(ui->btnRegister, &QPushButton::clicked, this, &LoginWindow::onRegisterClicked);
     connect(ui->btnConnectDB, &QPushButton::clicked, this, &LoginWindow::onConnectDBClicked);
 
+    // 口令校验在后台线程池完成，结果异步返回
+    AuthService& auth = AuthService::instance();
+    connect(&auth, &AuthService::authenticated, this, &LoginWindow::onAuthenticated);
+    connect(&auth, &AuthService::authenticationFailed, this, &LoginWindow::onAuthenticationFailed);
+    connect(&dbManager, &DatabaseManager::connectionReady, this, &LoginWindow::onConnectionReady);
+
     // 连接页面切换按钮
     connect(ui->btnShowRegister, &QPushButton::clicked, [this]() {
         ui->stackedWidget->setCurrentIndex(1); // 切换到注册页面
@@ -36,6 +51,11 @@ LoginWindow::LoginWindow(QWidget *parent)
     ui->txtDatabase->setText("BankSystem");
     ui->txtDbUser->setText("root");
     ui->txtDbPassword->setText("password");
+
+    // 记住了上次的连接设置时，窗口显示后询问数据库口令并在后台连接，用户输入账号密码期间完成预热
+    if (loadConnectionSettings()) {
+        QTimer::singleShot(0, this, &LoginWindow::promptAndConnect);
+    }
 }
 
 LoginWindow::~LoginWindow()
@@ -74,17 +94,100 @@ void LoginWindow::onConnectClicked()
     qDebug() << "数据库:" << database;
     qDebug() << "用户名:" << username;
 
-    if (dbManager.connectToDatabase(server, database, username, password)) {
+    startConnecting(true);
+}
+
+void LoginWindow::startConnecting(bool manual)
+{
+    manualConnect = manual;
+    ui->btnConnect->setEnabled(false);
+    statusBar()->showMessage("正在连接数据库…");
+    dbManager.connectToDatabaseAsync(ui->txtServer->text(), ui->txtDatabase->text(),
+                                     ui->txtDbUser->text(), ui->txtDbPassword->text());
+}
+
+void LoginWindow::onConnectionReady(bool success)
+{
+    ui->btnConnect->setEnabled(true);
+
+    if (!success) {
+        statusBar()->showMessage("数据库连接失败", 5000);
+        if (loginQueued) {
+            loginQueued = false;
+            queuedPassword.clear();
+            pendingUsername.clear();
+            ui->btnLogin->setEnabled(true);
+        }
+        if (manualConnect) {
+            showMessage("错误", "数据库连接失败！请检查连接信息。");
+        } else {
+            // 记住的设置已失效，转到连接页面修改
+            ui->stackedWidget->setCurrentIndex(2);
+        }
+        return;
+    }
+
+    saveConnectionSettings();
+    StartupMetrics::mark("数据库就绪");
+    statusBar()->showMessage("数据库已连接", 3000);
+
+    if (manualConnect) {
         showMessage("成功", "数据库连接成功！");
         switchToLoginPage(); // 连接成功后切换到登录页面
-    } else {
-        showMessage("错误", "数据库连接失败！请检查连接信息。");
     }
+
+    if (loginQueued) {
+        loginQueued = false;
+        const QString password = queuedPassword;
+        queuedPassword.clear();
+        AuthService::instance().authenticate(pendingUsername, password);
+    }
+}
+
+bool LoginWindow::loadConnectionSettings()
+{
+    QSettings settings;
+    // 早期版本把数据库口令明文写在配置里，读取时一并清除
+    settings.remove("database/password");
+    if (!settings.contains("database/host")) return false;
+
+    ui->txtServer->setText(settings.value("database/host").toString());
+    ui->txtDatabase->setText(settings.value("database/name").toString());
+    ui->txtDbUser->setText(settings.value("database/user").toString());
+    ui->txtDbPassword->clear();
+    return !ui->txtServer->text().isEmpty() && !ui->txtDatabase->text().isEmpty();
+}
+
+void LoginWindow::saveConnectionSettings()
+{
+    // 只保存主机、库名与用户名；口令不落盘（注册表或用户目录下的 ini 文件没有任何保护）
+    QSettings settings;
+    settings.setValue("database/host", ui->txtServer->text());
+    settings.setValue("database/name", ui->txtDatabase->text());
+    settings.setValue("database/user", ui->txtDbUser->text());
+    settings.remove("database/password");
+}
+
+void LoginWindow::promptAndConnect()
+{
+    bool ok = false;
+    const QString password = QInputDialog::getText(this, "连接数据库",
+                                                   QString("%1@%2 的数据库口令：")
+                                                       .arg(ui->txtDbUser->text(), ui->txtServer->text()),
+                                                   QLineEdit::Password, QString(), &ok);
+    if (!ok || password.isEmpty()) {
+        // 不输入口令则不自动连接，转到连接页面
+        ui->stackedWidget->setCurrentIndex(2);
+        return;
+    }
+
+    ui->txtDbPassword->setText(password);
+    startConnecting(false);
 }
 
 void LoginWindow::onLoginClicked()
 {
-    if (!dbManager.isConnected()) {
+    if (!dbManager.isConnected() && !dbManager.isConnecting()) {
         showMessage("错误", "请先连接数据库！");
         return;
     }
@@ -97,26 +200,60 @@ void LoginWindow::onLoginClicked()
         return;
     }
 
+    if (!pendingUsername.isEmpty()) {
+        return;  // 上一次登录仍在校验中
+    }
+
     qDebug() << "尝试登录用户:" << username;
 
-    if (dbManager.authenticateUser(username, password)) {
-        // 隐藏登录窗口
-        this->hide();
+    pendingUsername = username;
+    ui->btnLogin->setEnabled(false);
 
-        // 每次都创建新的MainWindow实例
-        if (mainWindow) {
-            delete mainWindow;  // 删除旧的实例
-        }
+    // 连接仍在预热，完成后自动继续登录
+    if (!dbManager.isConnected()) {
+        loginQueued = true;
+        queuedPassword = password;
+        statusBar()->showMessage("正在连接数据库，连接后自动登录…");
+        return;
+    }
+
+    AuthService::instance().authenticate(username, password);
+}
+
+void LoginWindow::onAuthenticated(const QString& username, const QString& token)
+{
+    if (username != pendingUsername) {
+        return;
+    }
+    pendingUsername.clear();
+    ui->btnLogin->setEnabled(true);
+    StartupMetrics::mark("登录成功");
 
-        mainWindow = new MainWindow(username);
+    // 隐藏登录窗口
+    this->hide();
 
-        // 连接退出登录信号
-        connect(mainWindow, &MainWindow::loggedOut, this, &LoginWindow::showLoginWindow);
+    // 每次都创建新的MainWindow实例
+    if (mainWindow) {
+        delete mainWindow;  // 删除旧的实例
+    }
 
-        mainWindow->show();
-    } else {
-        showMessage("错误", "用户名或密码错误！");
+    mainWindow = new MainWindow(username, token);
+
+    // 连接退出登录信号
+    connect(mainWindow, &MainWindow::loggedOut, this, &LoginWindow::showLoginWindow);
+
+    mainWindow->show();
+}
+
+void LoginWindow::onAuthenticationFailed(const QString& username, const QString& reason)
+{
+    if (username != pendingUsername) {
+        return;
     }
+    pendingUsername.clear();
+    ui->btnLogin->setEnabled(true);
+
+    showMessage("错误", reason);
 }
 
 void LoginWindow::showLoginWindow()
@@ -26,11 +26,25 @@ private slots:
     void onConnectClicked();
     void onRegisterClicked();
     void onConnectDBClicked();  // 新增：连接数据库按钮点击
+    void onAuthenticated(const QString& username, const QString& token);
+    void onAuthenticationFailed(const QString& username, const QString& reason);
+    void onConnectionReady(bool success);
 
 private:
     Ui::LoginWindow *ui;
     DatabaseManager& dbManager;
     MainWindow* mainWindow;
+    QString pendingUsername;  // 正在异步校验的用户
+    QString queuedPassword;   // 连接尚未就绪时提交的登录，连接完成后再校验
+    bool loginQueued;
+    bool manualConnect;       // 由“连接”按钮发起（而非启动时自动连接）
+
+    // 上次成功连接的主机、库名与用户名保存在 QSettings（口令不保存），
+    // 启动时询问口令后据此在后台预热连接
+    bool loadConnectionSettings();
+    void saveConnectionSettings();
+    void promptAndConnect();
+    void startConnecting(bool manual);
 
     void showMessage(const QString& title, const QString& message);
     void switchToLoginPage();
@@ -1,9 +1,336 @@
 #include "loginwindow.h"
+#include "ledgerreconciler.h"
+#include "interestaccrual.h"
+#include "statementgenerator.h"
+#include "columnstore.h"
+#include "columnstoreexporter.h"
+#include "workloadtrace.h"
+#include "money.h"
+#include "startupmetrics.h"
 #include <QApplication>
 #include <QStyleFactory>
+#include <QCommandLineParser>
+#include <QTextStream>
+#include <QMutex>
+#include <QTimer>
+#include <QSettings>
+#include <QElapsedTimer>
+
+// 无界面批处理共用的数据库连接选项
+static void addDatabaseOptions(QCommandLineParser& parser)
+{
+    parser.addOptions({
+        { "host", "数据库服务器", "host", "localhost" },
+        { "database", "数据库名", "database", "banksystem" },
+        { "user", "数据库用户名", "user", "root" },
+        { "password", "数据库密码（也可通过环境变量 BANKSYSTEM_DB_PASSWORD 提供）", "password" },
+    });
+}
+
+// 按命令行选项打开主连接。批处理引擎各自克隆连接，只需要主连接，
+// 不启动调度、归档、推送、检查点等后台服务（它们会与批处理争用连接和锁，且在进程退出前做无用功）
+static bool connectHeadless(const QCommandLineParser& parser, QTextStream& out)
+{
+    QString password = parser.value("password");
+    if (password.isEmpty()) {
+        password = qEnvironmentVariable("BANKSYSTEM_DB_PASSWORD");
+    }
+
+    if (!DatabaseManager::instance().connectCore(parser.value("host"), parser.value("database"),
+                                                 parser.value("user"), password)) {
+        out << "数据库连接失败" << Qt::endl;
+        return false;
+    }
+    return true;
+}
+
+// 无界面对账：BankSystem --reconcile --host localhost --database banksystem --user root
+// 退出码：0 无差异，1 存在差异，2 执行失败
+static int runHeadlessReconciliation(QCoreApplication& app)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("银行账户管理系统 - 账务核对");
+    parser.addHelpOption();
+    parser.addOptions({
+        { "reconcile", "运行账务核对后退出" },
+        { "threads", "并行线程数", "threads" },
+        { "range-size", "每个区间的账户数", "count" },
+        { "checkpoint", "检查点文件", "path" },
+        { "resume", "从检查点继续" },
+        { "report", "差异报告输出路径（CSV）", "path", "reconciliation_report.csv" },
+    });
+    addDatabaseOptions(parser);
+    parser.process(app);
+
+    QTextStream out(stdout);
+    DatabaseManager& dbManager = DatabaseManager::instance();
+    if (!connectHeadless(parser, out)) {
+        return 2;
+    }
+
+    LedgerReconciler reconciler(dbManager.connectionName());
+    if (parser.isSet("threads")) reconciler.setThreadCount(parser.value("threads").toInt());
+    if (parser.isSet("range-size")) reconciler.setRangeSize(parser.value("range-size").toInt());
+    if (parser.isSet("checkpoint")) reconciler.setCheckpointFile(parser.value("checkpoint"));
+
+    // 进度信号来自工作线程，直接输出需加锁
+    QMutex outputMutex;
+    QObject::connect(&reconciler, &LedgerReconciler::progress, [&out, &outputMutex](int completed, int total) {
+        QMutexLocker locker(&outputMutex);
+        out << QString("\r对账进度 %1 / %2").arg(completed).arg(total) << Qt::flush;
+    });
+
+    const bool success = reconciler.run(parser.isSet("resume"));
+    out << Qt::endl;
+
+    if (!success) {
+        out << "对账未完成，可使用 --resume 从检查点继续" << Qt::endl;
+        return 2;
+    }
+
+    reconciler.writeReport(parser.value("report"));
+    const int count = reconciler.discrepancies().size();
+    out << QString("检查账户 %1 个，差异 %2 处，报告：%3")
+               .arg(reconciler.accountsChecked())
+               .arg(count)
+               .arg(parser.value("report"))
+        << Qt::endl;
+
+    return count == 0 ? 0 : 1;
+}
+
+// 无界面计息（每日由计划任务调用）：BankSystem --accrue-interest [--date 2026-01-31]
+// 中断后以相同日期重新运行即可续跑；退出码：0 完成，2 执行失败
+static int runHeadlessInterestAccrual(QCoreApplication& app)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("银行账户管理系统 - 每日计息");
+    parser.addHelpOption();
+    parser.addOptions({
+        { "accrue-interest", "运行每日计息后退出" },
+        { "date", "计息日（yyyy-MM-dd），默认为昨天", "date" },
+        { "threads", "并行线程数", "threads" },
+        { "chunk-size", "每个区间的账户数", "count" },
+    });
+    addDatabaseOptions(parser);
+    parser.process(app);
+
+    QTextStream out(stdout);
+    const QDate date = parser.isSet("date") ? QDate::fromString(parser.value("date"), Qt::ISODate)
+                                            : QDate::currentDate().addDays(-1);
+    if (!date.isValid()) {
+        out << "计息日格式错误" << Qt::endl;
+        return 2;
+    }
+
+    DatabaseManager& dbManager = DatabaseManager::instance();
+    if (!connectHeadless(parser, out)) {
+        return 2;
+    }
+
+    InterestAccrual accrual(dbManager.connectionName());
+    if (parser.isSet("threads")) accrual.setThreadCount(parser.value("threads").toInt());
+    if (parser.isSet("chunk-size")) accrual.setChunkSize(parser.value("chunk-size").toInt());
+
+    QMutex outputMutex;
+    QObject::connect(&accrual, &InterestAccrual::progress, [&out, &outputMutex](int completed, int total) {
+        QMutexLocker locker(&outputMutex);
+        out << QString("\r计息进度 %1 / %2").arg(completed).arg(total) << Qt::flush;
+    });
+
+    const bool success = accrual.run(date);
+    out << Qt::endl;
+
+    if (!success) {
+        out << "计息未完成，可重新运行同一日期继续" << Qt::endl;
+        return 2;
+    }
+
+    out << QString("计息日 %1：入账账户 %2 个，利息合计 %3")
+               .arg(date.toString(Qt::ISODate))
+               .arg(accrual.accountsAccrued())
+               .arg(Money::toDecimalString(accrual.interestCents()))
+        << Qt::endl;
+    return 0;
+}
+
+// 无界面生成月度对账单：BankSystem --statements --month 2026-01 --output /data/statements
+// 退出码：0 完成，2 执行失败
+static int runHeadlessStatements(QCoreApplication& app)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("银行账户管理系统 - 月度对账单");
+    parser.addHelpOption();
+    parser.addOptions({
+        { "statements", "生成月度对账单后退出" },
+        { "month", "对账单月份（yyyy-MM），默认为上个月", "month" },
+        { "output", "输出目录", "path" },
+        { "threads", "并行线程数", "threads" },
+        { "page-size", "每页读取的账户数", "count" },
+    });
+    addDatabaseOptions(parser);
+    parser.process(app);
+
+    QTextStream out(stdout);
+    const QDate month = parser.isSet("month") ? QDate::fromString(parser.value("month") + "-01", Qt::ISODate)
+                                              : QDate::currentDate().addMonths(-1);
+    if (!month.isValid()) {
+        out << "月份格式错误" << Qt::endl;
+        return 2;
+    }
+
+    DatabaseManager& dbManager = DatabaseManager::instance();
+    if (!connectHeadless(parser, out)) {
+        return 2;
+    }
+
+    StatementGenerator generator(dbManager.connectionName());
+    if (parser.isSet("output")) generator.setOutputDirectory(parser.value("output"));
+    if (parser.isSet("threads")) generator.setThreadCount(parser.value("threads").toInt());
+    if (parser.isSet("page-size")) generator.setPageSize(parser.value("page-size").toInt());
+
+    QMutex outputMutex;
+    QObject::connect(&generator, &StatementGenerator::progress, [&out, &outputMutex](qint64 done, qint64 total) {
+        QMutexLocker locker(&outputMutex);
+        out << QString("\r对账单进度 %1 / %2").arg(done).arg(total) << Qt::flush;
+    });
+
+    const bool success = generator.run(month);
+    out << Qt::endl;
+
+    if (!success) {
+        out << "对账单生成失败" << Qt::endl;
+        return 2;
+    }
+
+    out << QString("已生成 %1 份对账单（流水 %2 条），目录：%3")
+               .arg(generator.statementsWritten())
+               .arg(generator.postingsScanned())
+               .arg(generator.outputDirectory())
+        << Qt::endl;
+    return 0;
+}
+
+// 无界面报表：BankSystem --analytics --report volume --from 2026-01-01 --to 2026-02-01
+// 先把新流水导出到本地列存（--no-export 时只查询已导出的数据，不连接数据库），再按列存计算报表。
+// 退出码：0 完成，2 执行失败
+static int runHeadlessAnalytics(QCoreApplication& app)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("银行账户管理系统 - 交易报表");
+    parser.addHelpOption();
+    parser.addOptions({
+        { "analytics", "导出流水并输出报表后退出" },
+        { "store", "列存目录", "path" },
+        { "no-export", "不导出新流水，只查询列存" },
+        { "report", "报表：volume（按日按类型汇总）、counterparties（对方账户排行）、amounts（金额分布）",
+          "report", "volume" },
+        { "from", "起始日期（含，yyyy-MM-dd）", "date" },
+        { "to", "结束日期（不含，yyyy-MM-dd）", "date" },
+        { "type", "交易类型", "type" },
+        { "top", "对方账户排行的条数", "count", "20" },
+        { "threads", "并行线程数", "threads" },
+    });
+    addDatabaseOptions(parser);
+    parser.process(app);
+
+    QTextStream out(stdout);
+    const QString report = parser.value("report");
+    if (report != "volume" && report != "counterparties" && report != "amounts") {
+        out << "未知的报表: " << report << Qt::endl;
+        return 2;
+    }
+
+    PostingFilter filter;
+    filter.type = parser.value("type");
+    if (parser.isSet("from")) {
+        filter.from = QDate::fromString(parser.value("from"), Qt::ISODate).startOfDay();
+    }
+    if (parser.isSet("to")) {
+        filter.to = QDate::fromString(parser.value("to"), Qt::ISODate).startOfDay();
+    }
+    if ((parser.isSet("from") && !filter.from.isValid()) || (parser.isSet("to") && !filter.to.isValid())) {
+        out << "日期格式错误" << Qt::endl;
+        return 2;
+    }
+
+    QString storeDirectory = parser.value("store");
+    if (storeDirectory.isEmpty()) {
+        storeDirectory = QSettings().value("analytics/directory").toString();
+    }
+
+    if (!parser.isSet("no-export")) {
+        DatabaseManager& dbManager = DatabaseManager::instance();
+        if (!connectHeadless(parser, out)) {
+            return 2;
+        }
+
+        ColumnStoreExporter exporter(dbManager.connectionName(), storeDirectory);
+        QObject::connect(&exporter, &ColumnStoreExporter::exported, [&out](qint64 rows, qint64 lastId) {
+            out << QString("已导出 %1 条流水，至交易号 %2").arg(rows).arg(lastId) << Qt::endl;
+        });
+        const bool exported = exporter.runExport();
+        exporter.stop();
+        if (!exported) {
+            out << "导出流水失败" << Qt::endl;
+            return 2;
+        }
+    }
+
+    ColumnStore store(storeDirectory);
+    if (parser.isSet("threads")) store.setThreadCount(parser.value("threads").toInt());
+
+    QElapsedTimer clock;
+    clock.start();
+    if (report == "volume") {
+        for (const DailyTypeVolume& row : store.volumeByTypePerDay(filter)) {
+            out << row.day.toString("yyyy-MM-dd") << '\t' << row.type << '\t' << row.count << '\t'
+                << Money::toDecimalString(row.amountCents) << Qt::endl;
+        }
+    } else if (report == "counterparties") {
+        for (const CounterpartyVolume& row : store.topCounterparties(filter, parser.value("top").toInt())) {
+            out << row.accountId << '\t' << row.count << '\t' << Money::toDecimalString(row.amountCents) << Qt::endl;
+        }
+    } else {
+        for (const AmountBucket& row : store.amountDistribution(filter)) {
+            out << Money::toDecimalString(row.lowerCents) << '\t' << row.count << '\t'
+                << Money::toDecimalString(row.amountCents) << Qt::endl;
+        }
+    }
+
+    out << QString("列存共 %1 条流水，查询耗时 %2 ms，目录：%3")
+               .arg(store.postingCount())
+               .arg(clock.elapsed())
+               .arg(store.directory())
+        << Qt::endl;
+    return 0;
+}
 
 int main(int argc, char *argv[])
 {
+    StartupMetrics::start();
+
+    // 无界面批处理：命令行中出现对应选项时不创建界面
+    static const struct {
+        const char* option;
+        int (*run)(QCoreApplication&);
+    } headlessModes[] = {
+        { "--reconcile", runHeadlessReconciliation },
+        { "--accrue-interest", runHeadlessInterestAccrual },
+        { "--statements", runHeadlessStatements },
+        { "--analytics", runHeadlessAnalytics },
+    };
+    for (int i = 1; i < argc; ++i) {
+        for (const auto& mode : headlessModes) {
+            if (qstrcmp(argv[i], mode.option) == 0) {
+                QCoreApplication app(argc, argv);
+                QCoreApplication::setApplicationName("BankSystem");
+                QCoreApplication::setOrganizationName("BankCorp");
+                return mode.run(app);
+            }
+        }
+    }
+
     QApplication a(argc, argv);
 
     // 设置应用程序样式
@@ -13,8 +340,21 @@ int main(int argc, char *argv[])
     QApplication::setApplicationName("BankSystem");
     QApplication::setOrganizationName("BankCorp");
 
+    // 报表列存导出默认关闭，由 analytics/export 开启
+    QSettings settings;
+    DatabaseManager::instance().setAnalyticsExport(settings.value("analytics/export", false).toBool(),
+                                                   settings.value("analytics/directory").toString());
+
+    // 负载抓取默认关闭，由 trace/enabled 开启，文件写入 trace/directory（默认应用数据目录下的 trace）
+    if (settings.value("trace/enabled", false).toBool()) {
+        WorkloadTrace::instance().start(settings.value("trace/directory").toString());
+        QObject::connect(&a, &QCoreApplication::aboutToQuit, []() { WorkloadTrace::instance().stop(); });
+    }
+
     LoginWindow w;
     w.show();
+    // 事件循环开始处理第一个事件时界面即可操作
+    QTimer::singleShot(0, []() { StartupMetrics::mark("界面可交互"); });
 
     return a.exec();
 }
@@ -1,20 +1,70 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
 #include "loginwindow.h"
+#include "ledgerreconciler.h"
+#include "authservice.h"
+#include "outboxsubscriber.h"
+#include "transferscheduler.h"
+#include "accountdirectory.h"
+#include "money.h"
+#include "startupmetrics.h"
+#include "slowquerylog.h"
 #include <QDateTime>
+#include <QHash>
+#include <QThread>
+#include <QFileDialog>
 #include <QHeaderView>
+#include <QScrollBar>
+#include <QSignalBlocker>
 #include <QInputDialog>
+#include <QStatusBar>
+#include <QSettings>
+#include <algorithm>
+
+namespace {
+const int kHistoryPageSize = 100;       // 每页交易记录条数
+const int kHistoryFilterDebounceMs = 300; // 筛选输入防抖
+const int kAdminPageSize = 200;          // 管理员用户/账户列表每页行数
+const int kSlowQueryRows = 500;          // 慢语句页签最多显示的记录数
+}
 
-MainWindow::MainWindow(const QString& username, QWidget *parent)
+MainWindow::MainWindow(const QString& username, const QString& sessionToken, QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
     , currentUsername(username)
+    , sessionToken(sessionToken)
     , dbManager(DatabaseManager::instance())
     , currentAccountId()
+    , historyFilterTimer(nullptr)
+    , historyCursorId(0)
+    , historyCursorCredit(false)
+    , historyRequestSeq(0)
+    , accountsRequestSeq(0)
+    , userSearchTimer(nullptr)
+    , accountSearchTimer(nullptr)
+    , usersRequestSeq(0)
+    , usersHasMore(false)
+    , usersLoading(false)
+    , accountsHasMore(false)
+    , accountsLoading(false)
+    , reconciler(nullptr)
+    , reconcileThread(nullptr)
+    , targetCompleter(nullptr)
+    , targetCompletions(nullptr)
+    , changeFeed(nullptr)
 {
     ui->setupUi(this);
     setupUI();
 
+    changeFeed = new OutboxSubscriber(dbManager.changeFeedServerName(), this);
+    connect(changeFeed, &OutboxSubscriber::eventReceived, this, &MainWindow::onChangeFeedEvent);
+    connect(changeFeed, &OutboxSubscriber::connectionChanged, this, &MainWindow::onChangeFeedConnectionChanged);
+
+    // 定期转账在调度线程中执行，完成后刷新指令列表
+    if (TransferScheduler* scheduler = dbManager.transferScheduler()) {
+        connect(scheduler, &TransferScheduler::orderExecuted, this, &MainWindow::onScheduledTransferExecuted);
+    }
+
     // 如果是管理员，初始化管理员UI
     if (isAdmin()) {
         setupAdminUI();
@@ -28,7 +78,7 @@ MainWindow::MainWindow(const QString& username, QWidget *parent)
 
 bool MainWindow::isAdmin() const
 {
-    return currentUsername == "admin";
+    return AuthService::instance().hasRole(sessionToken, "admin");
 }
 
 void MainWindow::setupAdminUI()
@@ -51,6 +101,38 @@ void MainWindow::setupAdminUI()
     ui->tableAllAccounts->setAlternatingRowColors(true);
     ui->tableAllAccounts->horizontalHeader()->setStretchLastSection(true);
     ui->tableAllAccounts->setSelectionBehavior(QAbstractItemView::SelectRows);
+    ui->tableAllAccounts->setSelectionMode(QAbstractItemView::ExtendedSelection);  // 批量冻结/解冻
+
+    // 排序、搜索在服务端执行，表格只显示已读取的页，滚动到底部附近时读取下一页
+    for (QTableWidget* table : { ui->tableUsers, ui->tableAllAccounts }) {
+        table->setSortingEnabled(false);
+        table->horizontalHeader()->setSectionsClickable(true);
+        table->horizontalHeader()->setSortIndicatorShown(true);
+    }
+    ui->tableUsers->horizontalHeader()->setSortIndicator(0, Qt::DescendingOrder);
+    ui->tableAllAccounts->horizontalHeader()->setSortIndicator(5, Qt::DescendingOrder);
+    connect(ui->tableUsers->horizontalHeader(), &QHeaderView::sortIndicatorChanged,
+            this, &MainWindow::loadAllUsers);
+    connect(ui->tableAllAccounts->horizontalHeader(), &QHeaderView::sortIndicatorChanged,
+            this, &MainWindow::loadAllAccounts);
+    connect(ui->tableUsers->verticalScrollBar(), &QScrollBar::valueChanged,
+            this, &MainWindow::fetchMoreUsers);
+    connect(ui->tableAllAccounts->verticalScrollBar(), &QScrollBar::valueChanged,
+            this, &MainWindow::fetchMoreAccounts);
+
+    userSearchTimer = new QTimer(this);
+    userSearchTimer->setSingleShot(true);
+    userSearchTimer->setInterval(kHistoryFilterDebounceMs);
+    connect(userSearchTimer, &QTimer::timeout, this, &MainWindow::loadAllUsers);
+    connect(ui->txtUserSearch, &QLineEdit::textChanged, userSearchTimer, QOverload<>::of(&QTimer::start));
+
+    accountSearchTimer = new QTimer(this);
+    accountSearchTimer->setSingleShot(true);
+    accountSearchTimer->setInterval(kHistoryFilterDebounceMs);
+    connect(accountSearchTimer, &QTimer::timeout, this, &MainWindow::loadAllAccounts);
+    connect(ui->txtAccountSearch, &QLineEdit::textChanged, accountSearchTimer, QOverload<>::of(&QTimer::start));
+    connect(ui->comboAccountStatus, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &MainWindow::loadAllAccounts);
 
     // 连接管理员功能信号槽
     connect(ui->btnRefreshUsers, &QPushButton::clicked, this, &MainWindow::onRefreshUsers);
@@ -60,10 +142,36 @@ void MainWindow::setupAdminUI()
     connect(ui->btnUnfreezeAccount, &QPushButton::clicked, this, &MainWindow::onUnfreezeAccount);
     connect(ui->btnDeleteAccount, &QPushButton::clicked, this, &MainWindow::onDeleteAdminAccount);
 
+    // 账务核对
+    ui->tableDiscrepancies->setColumnCount(5);
+    ui->tableDiscrepancies->setHorizontalHeaderLabels(
+        QStringList() << "账户号" << "账户余额" << "流水净额" << "差额" << "说明");
+    ui->tableDiscrepancies->horizontalHeader()->setStretchLastSection(true);
+    ui->tableDiscrepancies->setSelectionBehavior(QAbstractItemView::SelectRows);
+    ui->btnExportReconciliation->setEnabled(false);
+    connect(ui->btnRunReconciliation, &QPushButton::clicked, this, &MainWindow::onRunReconciliation);
+    connect(ui->btnExportReconciliation, &QPushButton::clicked, this, &MainWindow::onExportReconciliation);
+
+    // 慢语句日志
+    ui->tableSlowQueries->setColumnCount(6);
+    ui->tableSlowQueries->setHorizontalHeaderLabels(
+        QStringList() << "时间" << "耗时(ms)" << "行数" << "SQL ID" << "参数" << "语句");
+    ui->tableSlowQueries->horizontalHeader()->setStretchLastSection(true);
+    ui->tableSlowQueries->setSelectionBehavior(QAbstractItemView::SelectRows);
+    ui->tableSlowQueries->setSelectionMode(QAbstractItemView::SingleSelection);
+    ui->tableSlowQueries->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    ui->spinSlowQueryThreshold->setValue(SlowQueryLog::instance().thresholdMs());
+    ui->labelSlowLogPath->setText(SlowQueryLog::instance().logFilePath());
+    connect(ui->spinSlowQueryThreshold, QOverload<int>::of(&QSpinBox::valueChanged),
+            this, &MainWindow::onSlowQueryThresholdChanged);
+    connect(ui->btnRefreshSlowLog, &QPushButton::clicked, this, &MainWindow::loadSlowQueries);
+    connect(ui->tableSlowQueries, &QTableWidget::currentCellChanged, this, &MainWindow::onSlowQuerySelected);
+
     // 初始化加载数据
     if (isAdmin()) {
         loadAllUsers();
         loadAllAccounts();
+        loadSlowQueries();
     }
 }
 
@@ -76,15 +184,63 @@ void MainWindow::loadAllUsers()
 {
     if (!isAdmin()) return;
 
+    // 注册时间列与用户ID列同序（user_id 自增），其余列不支持服务端排序，回到默认
+    QHeaderView* header = ui->tableUsers->horizontalHeader();
+    int column = header->sortIndicatorSection();
+    if (column != 0 && column != 1 && column != 6) {
+        QSignalBlocker blocker(header);
+        header->setSortIndicator(0, Qt::DescendingOrder);
+        column = 0;
+    }
+
+    usersFilter = AdminListFilter();
+    usersFilter.search = ui->txtUserSearch->text().trimmed();
+    usersFilter.sortColumn = column == 1 ? "username" : "user_id";
+    usersFilter.descending = header->sortIndicatorOrder() == Qt::DescendingOrder;
+
     ui->tableUsers->setRowCount(0);
+    ++usersRequestSeq;   // 丢弃旧条件下还未返回的页
+    usersLoading = false;
+    usersHasMore = true;
+    fetchMoreUsers();
+}
+
+void MainWindow::fetchMoreUsers()
+{
+    QScrollBar* scrollBar = ui->tableUsers->verticalScrollBar();
+    if (usersLoading || !usersHasMore) return;
+    // 距底部不足一屏时读取下一页
+    if (ui->tableUsers->rowCount() > 0 && scrollBar->value() < scrollBar->maximum() - scrollBar->pageStep()) return;
+
+    usersLoading = true;
+    const int seq = ++usersRequestSeq;
+    dbManager.searchUsersAsync(usersFilter, kAdminPageSize, this, [this, seq](const QList<QVariantMap>& users) {
+        if (seq != usersRequestSeq) return;
+        usersLoading = false;
+        usersHasMore = users.size() == kAdminPageSize;
+        if (!users.isEmpty()) {
+            usersFilter.cursorValue = users.last()[usersFilter.sortColumn];
+            usersFilter.cursorId = users.last()["user_id"];
+        }
+        appendUserRows(users);
+        // 已读的行还没填满可视区域时继续读取；填满（出现滚动条）后停止，之后的页由滚动触发。
+        // 行高之和随插入立即更新，不依赖滚动条范围的延迟布局
+        if (usersHasMore && ui->tableUsers->verticalHeader()->length() <= ui->tableUsers->viewport()->height()) {
+            QTimer::singleShot(0, this, &MainWindow::fetchMoreUsers);
+        }
+    });
+}
 
-    QList<QVariantMap> users = dbManager.getAllUsers();
+void MainWindow::appendUserRows(const QList<QVariantMap>& users)
+{
     for (const auto& user : users) {
         int row = ui->tableUsers->rowCount();
         ui->tableUsers->insertRow(row);
 
         ui->tableUsers->setItem(row, 0, new QTableWidgetItem(user["user_id"].toString()));
-        ui->tableUsers->setItem(row, 1, new QTableWidgetItem(user["username"].toString()));
+        QTableWidgetItem* usernameItem = new QTableWidgetItem(user["username"].toString());
+        usernameItem->setData(Qt::UserRole, user["role"]);
+        ui->tableUsers->setItem(row, 1, usernameItem);
         ui->tableUsers->setItem(row, 2, new QTableWidgetItem(user["full_name"].toString()));
         ui->tableUsers->setItem(row, 3, new QTableWidgetItem(user["id_card"].toString()));
         ui->tableUsers->setItem(row, 4, new QTableWidgetItem(user["phone"].toString()));
@@ -123,7 +279,7 @@ void MainWindow::onChangePasswordClicked()
     }
 
     // 如果是管理员修改其他用户密码
-    if (isAdmin() && currentUsername != "admin") {
+    if (isAdmin()) {
         QString targetUser = QInputDialog::getText(this, "修改密码",
                                                    "请输入要修改密码的用户名（留空则修改当前用户）:", QLineEdit::Normal, currentUsername, &ok);
 
@@ -159,7 +315,7 @@ void MainWindow::onDeleteUser()
     QString userIdStr = ui->tableUsers->item(row, 0)->text();
     int userId = userIdStr.toInt();
 
-    if (username == "admin") {
+    if (ui->tableUsers->item(row, 1)->data(Qt::UserRole).toString() == "admin") {
         showMessage("错误", "不能删除管理员账户！");
         return;
     }
@@ -186,9 +342,59 @@ void MainWindow::loadAllAccounts()
 {
     if (!isAdmin()) return;
 
+    // 账户号、余额、开户时间可在服务端排序，其余列回到默认
+    QHeaderView* header = ui->tableAllAccounts->horizontalHeader();
+    int column = header->sortIndicatorSection();
+    if (column != 0 && column != 3 && column != 5) {
+        QSignalBlocker blocker(header);
+        header->setSortIndicator(5, Qt::DescendingOrder);
+        column = 5;
+    }
+
+    accountsFilter = AdminListFilter();
+    accountsFilter.search = ui->txtAccountSearch->text().trimmed();
+    if (ui->comboAccountStatus->currentIndex() > 0) {
+        accountsFilter.status = ui->comboAccountStatus->currentText();
+    }
+    accountsFilter.sortColumn = column == 0 ? "account_id" : column == 3 ? "balance" : "created_at";
+    accountsFilter.descending = header->sortIndicatorOrder() == Qt::DescendingOrder;
+
     ui->tableAllAccounts->setRowCount(0);
+    ++accountsRequestSeq;
+    accountsLoading = false;
+    accountsHasMore = true;
+    fetchMoreAccounts();
+}
 
-    QList<QVariantMap> accounts = dbManager.getAllAccounts();
+void MainWindow::fetchMoreAccounts()
+{
+    QScrollBar* scrollBar = ui->tableAllAccounts->verticalScrollBar();
+    if (accountsLoading || !accountsHasMore) return;
+    // 距底部不足一屏时读取下一页
+    if (ui->tableAllAccounts->rowCount() > 0 && scrollBar->value() < scrollBar->maximum() - scrollBar->pageStep()) return;
+
+    accountsLoading = true;
+    const int seq = ++accountsRequestSeq;
+    dbManager.searchAccountsAsync(accountsFilter, kAdminPageSize, this, [this, seq](const QList<QVariantMap>& accounts) {
+        if (seq != accountsRequestSeq) return;
+        accountsLoading = false;
+        accountsHasMore = accounts.size() == kAdminPageSize;
+        if (!accounts.isEmpty()) {
+            accountsFilter.cursorValue = accounts.last()[accountsFilter.sortColumn];
+            accountsFilter.cursorId = accounts.last()["account_key"];
+        }
+        appendAccountRows(accounts);
+        if (!accountsHasMore) {
+            statusBar()->showMessage(QString("共 %1 个账户").arg(ui->tableAllAccounts->rowCount()), 5000);
+        } else if (ui->tableAllAccounts->verticalHeader()->length() <= ui->tableAllAccounts->viewport()->height()) {
+            // 同用户列表：只在可视区域未填满时继续读取
+            QTimer::singleShot(0, this, &MainWindow::fetchMoreAccounts);
+        }
+    });
+}
+
+void MainWindow::appendAccountRows(const QList<QVariantMap>& accounts)
+{
     for (const auto& account : accounts) {
         int row = ui->tableAllAccounts->rowCount();
         ui->tableAllAccounts->insertRow(row);
@@ -202,70 +408,75 @@ void MainWindow::loadAllAccounts()
     }
 }
 
+QList<int> MainWindow::selectedAccountRows() const
+{
+    QList<int> rows;
+    for (const QModelIndex& index : ui->tableAllAccounts->selectionModel()->selectedRows()) {
+        rows.append(index.row());
+    }
+    std::sort(rows.begin(), rows.end());
+    return rows;
+}
+
 void MainWindow::onFreezeAccount()
 {
-    if (!isAdmin()) return;
+    changeSelectedAccountsStatus(true);
+}
 
-    int row = ui->tableAllAccounts->currentRow();
-    if (row < 0) {
-        showMessage("提示", "请先选择要冻结的账户！");
-        return;
-    }
+void MainWindow::onUnfreezeAccount()
+{
+    changeSelectedAccountsStatus(false);
+}
 
-    QString accountId = ui->tableAllAccounts->item(row, 0)->text();
-    QString username = ui->tableAllAccounts->item(row, 1)->text();
-    QString status = ui->tableAllAccounts->item(row, 4)->text();
+void MainWindow::changeSelectedAccountsStatus(bool freeze)
+{
+    if (!isAdmin()) return;
 
-    // 检查账户状态
-    if (status == "冻结") {
-        showMessage("提示", QString("账户 %1 已经是冻结状态！").arg(accountId));
+    const QString action = freeze ? "冻结" : "解冻";
+    const QList<int> rows = selectedAccountRows();
+    if (rows.isEmpty()) {
+        showMessage("提示", QString("请先选择要%1的账户！").arg(action));
         return;
     }
 
-    if (QMessageBox::question(this, "确认冻结",
-                              QString("确定要冻结账户 %1 (用户: %2) 吗？\n冻结后该账户将无法进行任何交易。").arg(accountId, username),
-                              QMessageBox::Yes | QMessageBox::No) == QMessageBox::Yes) {
-
-        if (dbManager.freezeAccount(accountId)) {
-            showMessage("成功", "账户冻结成功！");
-            loadAllAccounts();
-        } else {
-            showMessage("错误", "冻结失败！");
+    // 只提交状态需要改变的账户
+    const QString fromStatus = freeze ? "正常" : "冻结";
+    QStringList accountIds;
+    for (int row : rows) {
+        if (ui->tableAllAccounts->item(row, 4)->text() == fromStatus) {
+            accountIds << ui->tableAllAccounts->item(row, 0)->text();
         }
     }
-}
-
-void MainWindow::onUnfreezeAccount()
-{
-    if (!isAdmin()) return;
-
-    int row = ui->tableAllAccounts->currentRow();
-    if (row < 0) {
-        showMessage("提示", "请先选择要解冻的账户！");
+    if (accountIds.isEmpty()) {
+        showMessage("提示", QString("选中的账户都不是“%1”状态，无需%2！").arg(fromStatus, action));
         return;
     }
 
-    QString accountId = ui->tableAllAccounts->item(row, 0)->text();
-    QString username = ui->tableAllAccounts->item(row, 1)->text();
-    QString status = ui->tableAllAccounts->item(row, 4)->text();
+    QString question;
+    if (accountIds.size() == 1) {
+        question = QString("确定要%1账户 %2 吗？").arg(action, accountIds.first());
+    } else {
+        question = QString("确定要%1选中的 %2 个账户吗？").arg(action).arg(accountIds.size());
+    }
+    if (freeze) question += "\n冻结后账户将无法进行任何交易。";
 
-    // 检查账户状态
-    if (status != "冻结") {
-        showMessage("提示", QString("账户 %1 当前状态为 '%2'，无需解冻！").arg(accountId).arg(status));
+    if (QMessageBox::question(this, "确认" + action, question,
+                              QMessageBox::Yes | QMessageBox::No) != QMessageBox::Yes) {
         return;
     }
 
-    if (QMessageBox::question(this, "确认解冻",
-                              QString("确定要解冻账户 %1 (用户: %2) 吗？").arg(accountId, username),
-                              QMessageBox::Yes | QMessageBox::No) == QMessageBox::Yes) {
-
-        if (dbManager.unfreezeAccount(accountId)) {
-            showMessage("成功", "账户解冻成功！");
-            loadAllAccounts();  // 刷新账户列表
-        } else {
-            showMessage("错误", "解冻失败！");
-        }
+    const int changed = freeze ? dbManager.freezeAccounts(accountIds) : dbManager.unfreezeAccounts(accountIds);
+    if (changed < 0) {
+        showMessage("错误", action + "失败！");
+        return;
+    }
+    if (changed < accountIds.size()) {
+        showMessage("成功", QString("已%1 %2 个账户，其余 %3 个账户状态已被其他操作改变。")
+                                .arg(action).arg(changed).arg(accountIds.size() - changed));
+    } else {
+        showMessage("成功", QString("已%1 %2 个账户！").arg(action).arg(changed));
     }
+    loadAllAccounts();  // 刷新账户列表
 }
 
 void MainWindow::onDeleteAdminAccount()
@@ -274,7 +485,7 @@ void MainWindow::onDeleteAdminAccount()
 
     int row = ui->tableAllAccounts->currentRow();
     if (row < 0) {
-        showMessage("提示", "请先选择要删除的账户！");
+        showMessage("提示", "请先选择要销户的账户！");
         return;
     }
 
@@ -306,18 +517,18 @@ void MainWindow::onDeleteAdminAccount()
         }
     }
 
-    if (QMessageBox::question(this, "确认删除",
-                              QString("确定要删除账户 %1 (用户: %2) 吗？\n此操作将永久删除该账户的所有交易记录！")
+    if (QMessageBox::question(this, "确认销户",
+                              QString("确定要销户账户 %1 (用户: %2) 吗？\n销户后该账户立即停止交易，交易记录将在后台迁出！")
                                   .arg(accountId, username),
                               QMessageBox::Yes | QMessageBox::No) == QMessageBox::Yes) {
 
         // 二次确认
         if (QMessageBox::warning(this, "最后确认",
-                                 "这是不可逆操作！确定要删除吗？",
+                                 "这是不可逆操作！确定要销户吗？",
                                  QMessageBox::Yes | QMessageBox::No) == QMessageBox::Yes) {
 
             if (dbManager.deleteAccount(accountId)) {
-                showMessage("成功", "账户删除成功！");
+                showMessage("成功", "账户已销户，交易记录将在后台清理。");
                 loadAllAccounts();  // 刷新账户列表
 
                 // 如果删除的是当前用户的账户，刷新用户界面
@@ -325,7 +536,7 @@ void MainWindow::onDeleteAdminAccount()
                     loadAccountInfo();
                 }
             } else {
-                showMessage("错误", "删除失败！账户可能不存在或有其他关联数据。");
+                showMessage("错误", "销户失败！账户可能不存在或已销户。");
             }
         }
     }
@@ -349,9 +560,124 @@ void MainWindow::onChangePassword()
 
 MainWindow::~MainWindow()
 {
+    if (reconcileThread) {
+        reconciler->cancel();
+        reconcileThread->wait();
+    }
     delete ui;
 }
 
+void MainWindow::onRunReconciliation()
+{
+    if (!isAdmin() || reconcileThread) return;
+
+    if (!reconciler) {
+        reconciler = new LedgerReconciler(dbManager.connectionName(), this);
+        connect(reconciler, &LedgerReconciler::progress, this, &MainWindow::onReconciliationProgress);
+        connect(reconciler, &LedgerReconciler::finished, this, &MainWindow::onReconciliationFinished);
+    }
+
+    const bool resume = ui->chkResumeReconciliation->isChecked();
+    ui->btnRunReconciliation->setEnabled(false);
+    ui->btnExportReconciliation->setEnabled(false);
+    ui->tableDiscrepancies->setRowCount(0);
+    ui->labelReconciliationStatus->setText("正在划分账户区间...");
+
+    LedgerReconciler* job = reconciler;
+    reconcileThread = QThread::create([job, resume]() { job->run(resume); });
+    connect(reconcileThread, &QThread::finished, reconcileThread, &QObject::deleteLater);
+    connect(reconcileThread, &QThread::finished, this, [this]() { reconcileThread = nullptr; });
+    reconcileThread->start();
+}
+
+void MainWindow::onReconciliationProgress(int completedRanges, int totalRanges)
+{
+    ui->labelReconciliationStatus->setText(QString("对账中：%1 / %2 个区间").arg(completedRanges).arg(totalRanges));
+}
+
+void MainWindow::onReconciliationFinished(bool success)
+{
+    ui->btnRunReconciliation->setEnabled(true);
+
+    const QList<ReconciliationDiscrepancy> items = reconciler->discrepancies();
+    for (const auto& item : items) {
+        int row = ui->tableDiscrepancies->rowCount();
+        ui->tableDiscrepancies->insertRow(row);
+
+        ui->tableDiscrepancies->setItem(row, 0, new QTableWidgetItem(item.accountId));
+        ui->tableDiscrepancies->setItem(row, 1, new QTableWidgetItem(QString("¥%1").arg(Money::toDecimalString(item.balanceCents))));
+        ui->tableDiscrepancies->setItem(row, 2, new QTableWidgetItem(QString("¥%1").arg(Money::toDecimalString(item.ledgerCents))));
+        ui->tableDiscrepancies->setItem(row, 3, new QTableWidgetItem(QString("¥%1").arg(Money::toDecimalString(item.balanceCents - item.ledgerCents))));
+        ui->tableDiscrepancies->setItem(row, 4, new QTableWidgetItem(item.accountMissing ? "账户不存在" : "余额不符"));
+    }
+
+    ui->btnExportReconciliation->setEnabled(success);
+    if (success) {
+        ui->labelReconciliationStatus->setText(QString("对账完成：检查 %1 个账户，发现 %2 处差异")
+                                                   .arg(reconciler->accountsChecked())
+                                                   .arg(items.size()));
+    } else {
+        ui->labelReconciliationStatus->setText("对账未完成，可勾选“从检查点继续”重新执行");
+    }
+}
+
+void MainWindow::onExportReconciliation()
+{
+    if (!reconciler) return;
+
+    QString path = QFileDialog::getSaveFileName(this, "导出对账报告",
+                                                QString("reconciliation_%1.csv")
+                                                    .arg(QDate::currentDate().toString("yyyyMMdd")),
+                                                "CSV 文件 (*.csv)");
+    if (path.isEmpty()) return;
+
+    if (reconciler->writeReport(path)) {
+        showMessage("成功", "对账报告已导出！");
+    } else {
+        showMessage("错误", "对账报告导出失败！");
+    }
+}
+
+void MainWindow::loadSlowQueries()
+{
+    ui->tableSlowQueries->setRowCount(0);
+    ui->textSlowQueryPlan->clear();
+    if (!isAdmin()) return;
+
+    const QList<SlowQueryLog::Entry> entries = SlowQueryLog::instance().recentEntries(kSlowQueryRows);
+    for (const auto& entry : entries) {
+        int row = ui->tableSlowQueries->rowCount();
+        ui->tableSlowQueries->insertRow(row);
+
+        QTableWidgetItem* timeItem = new QTableWidgetItem(entry.loggedAt.toString("yyyy-MM-dd hh:mm:ss.zzz"));
+        // 语句全文、错误码与执行计划在下方文本框中显示
+        QStringList details;
+        details << entry.sql;
+        if (!entry.error.isEmpty()) details << QString("错误码: %1").arg(entry.error);
+        details << (entry.plan.isEmpty() ? QString("（本条未采样执行计划）") : entry.plan);
+        timeItem->setData(Qt::UserRole, details.join("\n\n"));
+
+        ui->tableSlowQueries->setItem(row, 0, timeItem);
+        ui->tableSlowQueries->setItem(row, 1, new QTableWidgetItem(QString::number(entry.elapsedUs / 1000.0, 'f', 1)));
+        ui->tableSlowQueries->setItem(row, 2, new QTableWidgetItem(entry.rows < 0 ? QString("-") : QString::number(entry.rows)));
+        ui->tableSlowQueries->setItem(row, 3, new QTableWidgetItem(entry.sqlId));
+        ui->tableSlowQueries->setItem(row, 4, new QTableWidgetItem(entry.parameterShapes.join(", ")));
+        ui->tableSlowQueries->setItem(row, 5, new QTableWidgetItem(entry.sql));
+    }
+}
+
+void MainWindow::onSlowQuerySelected(int row)
+{
+    QTableWidgetItem* item = row >= 0 ? ui->tableSlowQueries->item(row, 0) : nullptr;
+    ui->textSlowQueryPlan->setPlainText(item ? item->data(Qt::UserRole).toString() : QString());
+}
+
+void MainWindow::onSlowQueryThresholdChanged(int milliseconds)
+{
+    SlowQueryLog::instance().setThresholdMs(milliseconds);
+    QSettings().setValue("slowLog/thresholdMs", milliseconds);
+}
+
 void MainWindow::setupUI()
 {
     setWindowTitle(QString("银行账户管理系统 - 欢迎 %1").arg(currentUsername));
@@ -366,6 +692,12 @@ void MainWindow::setupUI()
     ui->tableHistory->horizontalHeader()->setStretchLastSection(true);
     ui->tableHistory->setSelectionBehavior(QAbstractItemView::SelectRows);
 
+    ui->tableScheduledTransfers->setColumnCount(6);
+    ui->tableScheduledTransfers->setHorizontalHeaderLabels(
+        QStringList() << "指令号" << "目标账户" << "金额" << "频率" << "下次执行" << "状态");
+    ui->tableScheduledTransfers->horizontalHeader()->setStretchLastSection(true);
+    ui->dateTimeTransferStart->setDateTime(QDateTime::currentDateTime().addSecs(3600));
+
     // 设置按钮样式
     ui->btnDeposit->setStyleSheet("background-color: #4CAF50; color: white; font-weight: bold;");
     ui->btnWithdraw->setStyleSheet("background-color: #F44336; color: white; font-weight: bold;");
@@ -376,16 +708,36 @@ void MainWindow::setupUI()
     ui->labelBalance->setStyleSheet("color: #2E8B57;");
 
     // 设置账户类型下拉框
+    // 账户类型在连接时随利率表读取，读取失败时使用内置列表
     ui->comboAccountType->clear();
-    ui->comboAccountType->addItem("储蓄账户");
-    ui->comboAccountType->addItem("活期账户");
-    ui->comboAccountType->addItem("定期账户");
+    const QStringList accountTypes = dbManager.accountTypes();
+    if (accountTypes.isEmpty()) {
+        ui->comboAccountType->addItem("储蓄账户");
+        ui->comboAccountType->addItem("活期账户");
+        ui->comboAccountType->addItem("定期账户");
+    } else {
+        ui->comboAccountType->addItems(accountTypes);
+    }
+
+    // 转账目标账户号补全：输入满 6 位后从本地目录按前缀查找，弹出框显示户名（脱敏）
+    targetCompletions = new QStandardItemModel(this);
+    targetCompleter = new QCompleter(targetCompletions, this);
+    targetCompleter->setCompletionRole(Qt::UserRole);
+    targetCompleter->setWidget(ui->txtTargetAccount);
+    connect(ui->txtTargetAccount, &QLineEdit::textEdited, this, &MainWindow::onTargetAccountEdited);
+    connect(targetCompleter, QOverload<const QString&>::of(&QCompleter::activated),
+            ui->txtTargetAccount, &QLineEdit::setText);
 
     // 连接信号槽
     connect(ui->btnDeposit, &QPushButton::clicked, this, &MainWindow::onDepositClicked);
     connect(ui->btnWithdraw, &QPushButton::clicked, this, &MainWindow::onWithdrawClicked);
     connect(ui->btnTransfer, &QPushButton::clicked, this, &MainWindow::onTransferClicked);
     connect(ui->btnCheckBalance, &QPushButton::clicked, this, &MainWindow::onCheckBalanceClicked);
+    connect(ui->comboTransferSchedule, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this](int index) {
+        ui->dateTimeTransferStart->setEnabled(index > 0);
+    });
+    connect(ui->btnRefreshScheduledTransfers, &QPushButton::clicked, this, &MainWindow::loadScheduledTransfers);
+    connect(ui->btnCancelScheduledTransfer, &QPushButton::clicked, this, &MainWindow::onCancelScheduledTransfer);
     connect(ui->btnRefreshHistory, &QPushButton::clicked, this, &MainWindow::onRefreshHistory);
     connect(ui->btnCreateAccount, &QPushButton::clicked, this, &MainWindow::onCreateAccountClicked);
     connect(ui->btnCreateAccount_2, &QPushButton::clicked, this, &MainWindow::onCreateAccountClicked);
@@ -394,6 +746,28 @@ void MainWindow::setupUI()
     connect(ui->comboAccounts, QOverload<int>::of(&QComboBox::currentIndexChanged),
             this, &MainWindow::onAccountSelected);
 
+    // 交易记录筛选栏：输入变化后防抖再查询
+    historyFilterTimer = new QTimer(this);
+    historyFilterTimer->setSingleShot(true);
+    historyFilterTimer->setInterval(kHistoryFilterDebounceMs);
+    connect(historyFilterTimer, &QTimer::timeout, this, &MainWindow::loadTransactionHistory);
+
+    ui->dateFilterFrom->setDate(QDate::currentDate().addMonths(-1));
+    ui->dateFilterTo->setDate(QDate::currentDate());
+    connect(ui->chkFilterDate, &QCheckBox::toggled, ui->dateFilterFrom, &QWidget::setEnabled);
+    connect(ui->chkFilterDate, &QCheckBox::toggled, ui->dateFilterTo, &QWidget::setEnabled);
+    connect(ui->chkFilterDate, &QCheckBox::toggled, this, &MainWindow::onHistoryFilterChanged);
+    connect(ui->dateFilterFrom, &QDateEdit::dateChanged, this, &MainWindow::onHistoryFilterChanged);
+    connect(ui->dateFilterTo, &QDateEdit::dateChanged, this, &MainWindow::onHistoryFilterChanged);
+    connect(ui->comboFilterType, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &MainWindow::onHistoryFilterChanged);
+    connect(ui->txtFilterMinAmount, &QLineEdit::textChanged, this, &MainWindow::onHistoryFilterChanged);
+    connect(ui->txtFilterMaxAmount, &QLineEdit::textChanged, this, &MainWindow::onHistoryFilterChanged);
+    connect(ui->txtFilterTarget, &QLineEdit::textChanged, this, &MainWindow::onHistoryFilterChanged);
+    connect(ui->txtFilterDescription, &QLineEdit::textChanged, this, &MainWindow::onHistoryFilterChanged);
+    connect(ui->btnClearFilter, &QPushButton::clicked, this, &MainWindow::onClearHistoryFilter);
+    connect(ui->btnLoadMoreHistory, &QPushButton::clicked, this, &MainWindow::onLoadMoreHistory);
+
     // 设置标签页
     ui->tabWidget->setCurrentIndex(0);
 }
@@ -404,6 +778,12 @@ void MainWindow::loadAccountInfo()
 
     QList<QVariantMap> accounts = dbManager.getUserAccounts(currentUsername);
 
+    // 管理员查看全部交易记录，订阅所有账户
+    QStringList subscriptions;
+    if (isAdmin()) subscriptions << "*";
+    for (const auto& account : accounts) subscriptions << account["account_id"].toString();
+    changeFeed->setSubscriptions(subscriptions);
+
     if (accounts.isEmpty()) {
         // 新用户没有账户
         showMessage("提示", "欢迎新用户！您还没有账户，请先开户。");
@@ -421,6 +801,7 @@ void MainWindow::loadAccountInfo()
                                   .arg(balance, 0, 'f', 2);
 
         ui->comboAccounts->addItem(displayText, accountId);
+        ui->comboAccounts->setItemData(ui->comboAccounts->count() - 1, accountType, Qt::UserRole + 1);
     }
 
     if (ui->comboAccounts->count() > 0) {
@@ -439,22 +820,22 @@ void MainWindow::updateBalanceDisplay()
 
     double balance = dbManager.getBalance(currentAccountId);
     ui->labelBalance->setText(QString("¥%1").arg(balance, 0, 'f', 2));
+
+    if (StartupMetrics::mark("首次显示余额")) {
+        statusBar()->showMessage("启动耗时：" + StartupMetrics::summary(), 10000);
+    }
 }
 
 void MainWindow::loadTransactionHistory()
 {
-    if (currentAccountId.isEmpty()) return;
+    if (currentAccountId.isEmpty() && !isAdmin()) return;
 
+    historyFilterTimer->stop();
     ui->tableHistory->setRowCount(0);
-
-    QList<QVariantMap> history;
-    if (isAdmin()) {
-        // 管理员查看所有记录
-        history = dbManager.getTransactionHistory("", currentUsername);
-    } else {
-        // 普通用户查看自己账户记录
-        history = dbManager.getTransactionHistory(currentAccountId, currentUsername);
-    }
+    historyCursorTime = QDateTime();
+    historyCursorId = 0;
+    historyCursorCredit = false;
+    ++historyRequestSeq;
 
     // 根据是否是管理员设置表格列数
     if (isAdmin()) {
@@ -467,42 +848,213 @@ void MainWindow::loadTransactionHistory()
             QStringList() << "交易ID" << "类型" << "金额" << "对方账户" << "描述" << "时间");
     }
 
+    fetchHistoryPage();
+}
+
+void MainWindow::fetchHistoryPage()
+{
+    TransactionFilter filter = buildHistoryFilter();
+    filter.beforeTime = historyCursorTime;
+    filter.beforeId = historyCursorId;
+    filter.beforeCredit = historyCursorCredit;
+
+    // 管理员查看所有账户记录，按批量任务在后台执行；普通用户只查看当前账户
+    if (isAdmin()) {
+        ui->btnLoadMoreHistory->setEnabled(false);
+        const int seq = ++historyRequestSeq;
+        dbManager.searchTransactionHistoryAsync(QString(), filter, kHistoryPageSize, this,
+                                                [this, seq](const QList<QVariantMap>& history) {
+            if (seq != historyRequestSeq) return;
+            showHistoryPage(history);
+        });
+        return;
+    }
+
+    showHistoryPage(dbManager.searchTransactionHistory(currentAccountId, filter, kHistoryPageSize));
+}
+
+void MainWindow::showHistoryPage(const QList<QVariantMap>& history)
+{
+    appendHistoryRows(history);
+
+    if (!history.isEmpty()) {
+        historyCursorTime = history.last()["time"].toDateTime();
+        historyCursorId = history.last()["id"].toLongLong();
+        historyCursorCredit = history.last()["credit"].toBool();
+    }
+    ui->btnLoadMoreHistory->setEnabled(history.size() == kHistoryPageSize);
+}
+
+TransactionFilter MainWindow::buildHistoryFilter() const
+{
+    TransactionFilter filter;
+
+    if (ui->chkFilterDate->isChecked()) {
+        filter.from = QDateTime(ui->dateFilterFrom->date(), QTime(0, 0));
+        filter.to = QDateTime(ui->dateFilterTo->date().addDays(1), QTime(0, 0));
+    }
+
+    // 第 0 项为“全部类型”
+    if (ui->comboFilterType->currentIndex() > 0) {
+        filter.type = ui->comboFilterType->currentText();
+    }
+
+    filter.minAmount = ui->txtFilterMinAmount->text().toDouble();
+    filter.maxAmount = ui->txtFilterMaxAmount->text().toDouble();
+    filter.targetAccount = ui->txtFilterTarget->text().trimmed();
+    filter.descriptionContains = ui->txtFilterDescription->text().trimmed();
+    return filter;
+}
+
+void MainWindow::appendHistoryRows(const QList<QVariantMap>& history)
+{
     for (const auto& record : history) {
         int row = ui->tableHistory->rowCount();
         ui->tableHistory->insertRow(row);
+        setHistoryRow(row, record);
+    }
+}
 
-        if (isAdmin()) {
-            // 管理员视图
-            ui->tableHistory->setItem(row, 0, new QTableWidgetItem(record["id"].toString()));
-            ui->tableHistory->setItem(row, 1, new QTableWidgetItem(record["account_id"].toString()));
-            ui->tableHistory->setItem(row, 2, new QTableWidgetItem(record["username"].toString()));
-            ui->tableHistory->setItem(row, 3, new QTableWidgetItem(record["type"].toString()));
+void MainWindow::setHistoryRow(int row, const QVariantMap& record)
+{
+    if (isAdmin()) {
+        // 管理员视图
+        ui->tableHistory->setItem(row, 0, new QTableWidgetItem(record["id"].toString()));
+        ui->tableHistory->setItem(row, 1, new QTableWidgetItem(record["account_id"].toString()));
+        ui->tableHistory->setItem(row, 2, new QTableWidgetItem(record["username"].toString()));
+        ui->tableHistory->setItem(row, 3, new QTableWidgetItem(record["type"].toString()));
 
-            double amount = record["amount"].toDouble();
-            QString amountText = QString("¥%1").arg(amount, 0, 'f', 2);
-            ui->tableHistory->setItem(row, 4, new QTableWidgetItem(amountText));
+        double amount = record["amount"].toDouble();
+        QString amountText = QString("¥%1").arg(amount, 0, 'f', 2);
+        ui->tableHistory->setItem(row, 4, new QTableWidgetItem(amountText));
 
-            ui->tableHistory->setItem(row, 5, new QTableWidgetItem(record["target"].toString()));
-            ui->tableHistory->setItem(row, 6, new QTableWidgetItem(record["description"].toString()));
+        ui->tableHistory->setItem(row, 5, new QTableWidgetItem(record["target"].toString()));
+        ui->tableHistory->setItem(row, 6, new QTableWidgetItem(record["description"].toString()));
 
-            QDateTime time = record["time"].toDateTime();
-            ui->tableHistory->setItem(row, 7, new QTableWidgetItem(time.toString("yyyy-MM-dd HH:mm:ss")));
-        } else {
-            // 普通用户视图
-            ui->tableHistory->setItem(row, 0, new QTableWidgetItem(record["id"].toString()));
-            ui->tableHistory->setItem(row, 1, new QTableWidgetItem(record["type"].toString()));
+        QDateTime time = record["time"].toDateTime();
+        ui->tableHistory->setItem(row, 7, new QTableWidgetItem(time.toString("yyyy-MM-dd HH:mm:ss")));
+    } else {
+        // 普通用户视图
+        ui->tableHistory->setItem(row, 0, new QTableWidgetItem(record["id"].toString()));
+        ui->tableHistory->setItem(row, 1, new QTableWidgetItem(record["type"].toString()));
 
-            double amount = record["amount"].toDouble();
-            QString amountText = QString("¥%1").arg(amount, 0, 'f', 2);
-            ui->tableHistory->setItem(row, 2, new QTableWidgetItem(amountText));
+        double amount = record["amount"].toDouble();
+        QString amountText = QString("¥%1").arg(amount, 0, 'f', 2);
+        ui->tableHistory->setItem(row, 2, new QTableWidgetItem(amountText));
 
-            ui->tableHistory->setItem(row, 3, new QTableWidgetItem(record["target"].toString()));
-            ui->tableHistory->setItem(row, 4, new QTableWidgetItem(record["description"].toString()));
+        ui->tableHistory->setItem(row, 3, new QTableWidgetItem(record["target"].toString()));
+        ui->tableHistory->setItem(row, 4, new QTableWidgetItem(record["description"].toString()));
 
-            QDateTime time = record["time"].toDateTime();
-            ui->tableHistory->setItem(row, 5, new QTableWidgetItem(time.toString("yyyy-MM-dd HH:mm:ss")));
+        QDateTime time = record["time"].toDateTime();
+        ui->tableHistory->setItem(row, 5, new QTableWidgetItem(time.toString("yyyy-MM-dd HH:mm:ss")));
+    }
+}
+
+// 与 searchTransactionHistory 的 SQL 条件一致，用于判断推送的记录是否应出现在当前视图
+bool MainWindow::historyFilterAccepts(const QVariantMap& record) const
+{
+    const TransactionFilter filter = buildHistoryFilter();
+    const QDateTime time = record["time"].toDateTime();
+    const double amount = record["amount"].toDouble();
+
+    if (filter.from.isValid() && time < filter.from) return false;
+    if (filter.to.isValid() && time >= filter.to) return false;
+    if (!filter.type.isEmpty() && record["type"].toString() != filter.type) return false;
+    if (filter.minAmount > 0 && amount < filter.minAmount) return false;
+    if (filter.maxAmount > 0 && amount > filter.maxAmount) return false;
+    if (!filter.targetAccount.isEmpty() && record["target"].toString() != filter.targetAccount) return false;
+    if (!filter.descriptionContains.isEmpty()
+        && !record["description"].toString().contains(filter.descriptionContains, Qt::CaseInsensitive)) return false;
+    return true;
+}
+
+void MainWindow::onChangeFeedEvent(const OutboxEvent& event)
+{
+    const QString balanceText = Money::toDecimalString(event.balanceCents);
+
+    // 账户下拉框中的余额
+    const int index = ui->comboAccounts->findData(event.accountId);
+    if (index >= 0) {
+        ui->comboAccounts->setItemText(index, QString("%1 (%2) - 余额: ¥%3")
+                                                  .arg(event.accountId)
+                                                  .arg(ui->comboAccounts->itemData(index, Qt::UserRole + 1).toString())
+                                                  .arg(balanceText));
+    }
+
+    if (event.accountId == currentAccountId) {
+        ui->labelBalance->setText(QString("¥%1").arg(balanceText));
+        if (event.eventType == "status") {
+            statusBar()->showMessage(QString("账户 %1 状态已变更为：%2").arg(event.accountId, event.accountStatus), 5000);
         }
     }
+
+    if (event.eventType != "posting") return;
+    if (!isAdmin() && event.accountId != currentAccountId) return;
+
+    QVariantMap record;
+    record["id"] = event.transactionId;
+    record["type"] = event.transactionType;
+    record["amount"] = Money::toYuan(event.amountCents);
+    record["target"] = event.counterparty;
+    record["description"] = event.description;
+    record["time"] = QDateTime::fromMSecsSinceEpoch(event.timeMSecs);
+    record["account_id"] = event.accountId;
+    record["username"] = event.username;
+
+    if (!historyFilterAccepts(record)) return;
+
+    // 新记录总是最新的，插到首行；分页游标指向末行，不受影响
+    ui->tableHistory->insertRow(0);
+    setHistoryRow(0, record);
+}
+
+void MainWindow::onChangeFeedConnectionChanged(bool connected)
+{
+    // 断线期间可能漏掉事件，重连后整体刷新一次
+    if (connected) {
+        updateBalanceDisplay();
+        loadTransactionHistory();
+    }
+}
+
+void MainWindow::refreshAfterOperation()
+{
+    // 推送通道可用时等待事件就地更新，否则整体刷新
+    if (changeFeed->isConnected()) return;
+
+    updateBalanceDisplay();
+    loadTransactionHistory();
+}
+
+void MainWindow::onHistoryFilterChanged()
+{
+    historyFilterTimer->start();
+}
+
+void MainWindow::onClearHistoryFilter()
+{
+    // 批量重置时屏蔽信号，只触发一次查询
+    const QList<QWidget*> inputs = { ui->chkFilterDate, ui->comboFilterType, ui->txtFilterMinAmount,
+                                     ui->txtFilterMaxAmount, ui->txtFilterTarget, ui->txtFilterDescription };
+    for (QWidget* input : inputs) input->blockSignals(true);
+
+    ui->chkFilterDate->setChecked(false);
+    ui->dateFilterFrom->setEnabled(false);
+    ui->dateFilterTo->setEnabled(false);
+    ui->comboFilterType->setCurrentIndex(0);
+    ui->txtFilterMinAmount->clear();
+    ui->txtFilterMaxAmount->clear();
+    ui->txtFilterTarget->clear();
+    ui->txtFilterDescription->clear();
+
+    for (QWidget* input : inputs) input->blockSignals(false);
+
+    loadTransactionHistory();
+}
+
+void MainWindow::onLoadMoreHistory()
+{
+    fetchHistoryPage();
 }
 
 void MainWindow::onDepositClicked()
@@ -520,14 +1072,19 @@ void MainWindow::onDepositClicked()
         return;
     }
 
-    if (dbManager.deposit(currentAccountId, amount)) {
-        showMessage("成功", QString("存款成功！存入金额: ¥%1").arg(amount, 0, 'f', 2));
-        updateBalanceDisplay();
-        loadTransactionHistory();
-        ui->txtDepositAmount->clear();
-    } else {
-        showMessage("错误", "存款失败！");
-    }
+    // 结果在合并批次提交或重试结束后回调，期间界面保持响应
+    ui->btnDeposit->setEnabled(false);
+    dbManager.depositAsync(currentAccountId, amount, this, [this, amount](const PostingResult& result) {
+        ui->btnDeposit->setEnabled(true);
+        if (result.success) {
+            showMessage("成功", QString("存款成功！存入金额: ¥%1").arg(amount, 0, 'f', 2));
+            refreshAfterOperation();
+            ui->txtDepositAmount->clear();
+        } else {
+            showMessage("错误", result.message.isEmpty() ? QString("存款失败！")
+                                                         : QString("存款失败！%1").arg(result.message));
+        }
+    });
 }
 
 void MainWindow::onWithdrawClicked()
@@ -545,14 +1102,18 @@ void MainWindow::onWithdrawClicked()
         return;
     }
 
-    if (dbManager.withdraw(currentAccountId, amount)) {
-        showMessage("成功", QString("取款成功！取出金额: ¥%1").arg(amount, 0, 'f', 2));
-        updateBalanceDisplay();
-        loadTransactionHistory();
-        ui->txtWithdrawAmount->clear();
-    } else {
-        showMessage("错误", "取款失败！余额不足或账户异常！");
-    }
+    ui->btnWithdraw->setEnabled(false);
+    dbManager.withdrawAsync(currentAccountId, amount, this, [this, amount](const PostingResult& result) {
+        ui->btnWithdraw->setEnabled(true);
+        if (result.success) {
+            showMessage("成功", QString("取款成功！取出金额: ¥%1").arg(amount, 0, 'f', 2));
+            refreshAfterOperation();
+            ui->txtWithdrawAmount->clear();
+        } else {
+            showMessage("错误", result.message.isEmpty() ? QString("取款失败！余额不足或账户异常！")
+                                                         : QString("取款失败！%1").arg(result.message));
+        }
+    });
 }
 
 void MainWindow::onTransferClicked()
@@ -581,15 +1142,47 @@ void MainWindow::onTransferClicked()
         return;
     }
 
-    if (dbManager.transfer(currentAccountId, targetAccount, amount)) {
-        showMessage("成功", QString("转账成功！转账金额: ¥%1").arg(amount, 0, 'f', 2));
-        updateBalanceDisplay();
-        loadTransactionHistory();
-        ui->txtTargetAccount->clear();
-        ui->txtTransferAmount->clear();
-    } else {
-        showMessage("错误", "转账失败！余额不足或目标账户不存在！");
+    if (ui->comboTransferSchedule->currentIndex() > 0) {
+        static const QStringList frequencies = { "once", "daily", "weekly", "monthly" };
+
+        ScheduledTransfer order;
+        order.fromAccount = currentAccountId;
+        order.toAccount = targetAccount;
+        order.amountCents = Money::toCents(amount);
+        order.frequency = frequencies.value(ui->comboTransferSchedule->currentIndex() - 1);
+        order.startAt = ui->dateTimeTransferStart->dateTime();
+
+        if (order.startAt < QDateTime::currentDateTime()) {
+            showMessage("错误", "首次执行时间不能早于当前时间！");
+            return;
+        }
+
+        const qint64 orderId = dbManager.createScheduledTransfer(order);
+        if (orderId > 0) {
+            showMessage("成功", QString("定期转账已创建，指令号: %1").arg(orderId));
+            ui->txtTargetAccount->clear();
+            ui->txtTransferAmount->clear();
+            loadScheduledTransfers();
+        } else {
+            showMessage("错误", "定期转账创建失败！请检查目标账户。");
+        }
+        return;
     }
+
+    // 死锁等重试的退避期间界面保持响应
+    ui->btnTransfer->setEnabled(false);
+    dbManager.transferAsync(currentAccountId, targetAccount, amount, this, [this, amount](const PostingResult& result) {
+        ui->btnTransfer->setEnabled(true);
+        if (result.success) {
+            showMessage("成功", QString("转账成功！转账金额: ¥%1").arg(amount, 0, 'f', 2));
+            refreshAfterOperation();
+            ui->txtTargetAccount->clear();
+            ui->txtTransferAmount->clear();
+        } else {
+            showMessage("错误", result.message.isEmpty() ? QString("转账失败！余额不足或目标账户不存在！")
+                                                         : QString("转账失败！%1").arg(result.message));
+        }
+    });
 }
 
 void MainWindow::onCheckBalanceClicked()
@@ -649,11 +1242,80 @@ void MainWindow::onAccountSelected(int index)
         currentAccountId = ui->comboAccounts->itemData(index).toString();
         updateBalanceDisplay();
         loadTransactionHistory();
+        loadScheduledTransfers();
+    }
+}
+
+void MainWindow::loadScheduledTransfers()
+{
+    static const QHash<QString, QString> frequencyNames = {
+        { "once", "一次" }, { "daily", "每天" }, { "weekly", "每周" }, { "monthly", "每月" }
+    };
+    static const QHash<QString, QString> statusNames = {
+        { "active", "执行中" }, { "paused", "已暂停" }, { "completed", "已完成" }, { "cancelled", "已取消" }
+    };
+
+    ui->tableScheduledTransfers->setRowCount(0);
+    if (currentAccountId.isEmpty()) return;
+
+    const QList<QVariantMap> orders = dbManager.getScheduledTransfers(currentAccountId);
+    for (const auto& order : orders) {
+        int row = ui->tableScheduledTransfers->rowCount();
+        ui->tableScheduledTransfers->insertRow(row);
+
+        const QString status = order["status"].toString();
+        const bool finished = status == "completed" || status == "cancelled";
+
+        ui->tableScheduledTransfers->setItem(row, 0, new QTableWidgetItem(order["order_id"].toString()));
+        ui->tableScheduledTransfers->setItem(row, 1, new QTableWidgetItem(order["to_account"].toString()));
+        ui->tableScheduledTransfers->setItem(row, 2, new QTableWidgetItem(
+            QString("¥%1").arg(order["amount"].toDouble(), 0, 'f', 2)));
+        ui->tableScheduledTransfers->setItem(row, 3, new QTableWidgetItem(
+            frequencyNames.value(order["frequency"].toString(), order["frequency"].toString())));
+        ui->tableScheduledTransfers->setItem(row, 4, new QTableWidgetItem(
+            finished ? QString("-") : order["next_run_at"].toDateTime().toString("yyyy-MM-dd HH:mm")));
+        ui->tableScheduledTransfers->setItem(row, 5, new QTableWidgetItem(statusNames.value(status, status)));
+    }
+}
+
+void MainWindow::onCancelScheduledTransfer()
+{
+    int row = ui->tableScheduledTransfers->currentRow();
+    if (row < 0) {
+        showMessage("错误", "请先选择要取消的指令！");
+        return;
+    }
+
+    const qint64 orderId = ui->tableScheduledTransfers->item(row, 0)->text().toLongLong();
+    if (QMessageBox::question(this, "确认取消",
+                              QString("确定要取消定期转账指令 %1 吗？").arg(orderId),
+                              QMessageBox::Yes | QMessageBox::No) != QMessageBox::Yes) {
+        return;
+    }
+
+    if (dbManager.cancelScheduledTransfer(orderId)) {
+        showMessage("成功", "定期转账指令已取消！");
+        loadScheduledTransfers();
+    } else {
+        showMessage("错误", "取消失败！指令不存在或已结束。");
+    }
+}
+
+void MainWindow::onScheduledTransferExecuted(qint64 orderId, const QString& outcome, const QString& message)
+{
+    if (outcome != "success") {
+        statusBar()->showMessage(QString("定期转账 %1 未执行：%2").arg(orderId).arg(message), 10000);
+    }
+    // 余额与交易记录由变更推送更新，这里只刷新指令列表
+    loadScheduledTransfers();
+    if (!changeFeed->isConnected()) {
+        updateBalanceDisplay();
     }
 }
 
 void MainWindow::onLogoutClicked()
 {
+    AuthService::instance().revoke(sessionToken);
     this->close();
     emit loggedOut();
 }
@@ -662,3 +1324,31 @@ void MainWindow::showMessage(const QString& title, const QString& message)
 {
     QMessageBox::information(this, title, message);
 }
+
+void MainWindow::onTargetAccountEdited(const QString& text)
+{
+    const QString prefix = text.trimmed();
+    targetCompletions->clear();
+    if (prefix.size() < 6) return;
+
+    const QList<AccountDirectory::Entry> matches = dbManager.accountDirectory()->search(prefix, 10);
+    for (const AccountDirectory::Entry& entry : matches) {
+        if (entry.accountId == currentAccountId) continue;
+
+        // 只显示姓氏，避免借补全枚举他人姓名
+        const QString owner = entry.ownerName.isEmpty()
+            ? QString() : entry.ownerName.left(1) + QString(entry.ownerName.size() - 1, QChar('*'));
+        QString label = entry.accountId;
+        if (!owner.isEmpty()) label += "  " + owner;
+        if (entry.status != "正常") label += QString("（%1）").arg(entry.status);
+
+        QStandardItem* item = new QStandardItem(label);
+        item->setData(entry.accountId, Qt::UserRole);
+        targetCompletions->appendRow(item);
+    }
+
+    if (targetCompletions->rowCount() > 0) {
+        targetCompleter->setCompletionPrefix(prefix);
+        targetCompleter->complete();
+    }
+}
@@ -10,8 +10,16 @@
 #include <QComboBox>
 #include <QMessageBox>
 #include <QVariantMap>
+#include <QTimer>
+#include <QCompleter>
+#include <QStandardItemModel>
 #include "databasemanager.h"
 
+class LedgerReconciler;
+class OutboxSubscriber;
+struct OutboxEvent;
+class QThread;
+
 QT_BEGIN_NAMESPACE
 namespace Ui {
 class MainWindow;
@@ -23,7 +31,7 @@ class MainWindow : public QMainWindow
     Q_OBJECT
 
 public:
-    explicit MainWindow(const QString& username, QWidget *parent = nullptr);
+    explicit MainWindow(const QString& username, const QString& sessionToken, QWidget *parent = nullptr);
     ~MainWindow();
 
 private slots:
@@ -44,24 +52,91 @@ private slots:
     void onUnfreezeAccount();
     void onDeleteAdminAccount();
     void onChangePasswordClicked();  // 修改密码按钮
+    // 交易记录筛选
+    void onHistoryFilterChanged();
+    void onClearHistoryFilter();
+    void onLoadMoreHistory();
+    // 账务核对
+    void onRunReconciliation();
+    void onExportReconciliation();
+    void onReconciliationProgress(int completedRanges, int totalRanges);
+    void onReconciliationFinished(bool success);
+    // 慢语句日志
+    void loadSlowQueries();
+    void onSlowQuerySelected(int row);
+    void onSlowQueryThresholdChanged(int milliseconds);
+    // 变更推送
+    void onChangeFeedEvent(const OutboxEvent& event);
+    void onChangeFeedConnectionChanged(bool connected);
+    // 定期转账
+    void loadScheduledTransfers();
+    void onCancelScheduledTransfer();
+    void onScheduledTransferExecuted(qint64 orderId, const QString& outcome, const QString& message);
+    // 转账目标账户号补全
+    void onTargetAccountEdited(const QString& text);
 
 private:
     Ui::MainWindow *ui;
     QString currentUsername;
+    QString sessionToken;     // 登录签发的会话令牌，权限判断只查会话缓存
     QString currentAccountId;
     DatabaseManager& dbManager;
 
+    // 交易记录分页状态
+    QTimer* historyFilterTimer;
+    QDateTime historyCursorTime;
+    qint64 historyCursorId;
+    bool historyCursorCredit;
+    // 管理员查询异步执行，序号不符的结果已过期（筛选条件已变化），直接丢弃
+    int historyRequestSeq;
+    int accountsRequestSeq;
+
+    // 管理员用户/账户列表：筛选条件连同下一页游标，滚动到底部附近时按游标续读
+    QTimer* userSearchTimer;
+    QTimer* accountSearchTimer;
+    AdminListFilter usersFilter;
+    AdminListFilter accountsFilter;
+    int usersRequestSeq;
+    bool usersHasMore;
+    bool usersLoading;
+    bool accountsHasMore;
+    bool accountsLoading;
+
+    // 账务核对在后台线程运行
+    LedgerReconciler* reconciler;
+    QThread* reconcileThread;
+
+    // 转账目标补全，候选来自本地账户目录
+    QCompleter* targetCompleter;
+    QStandardItemModel* targetCompletions;
+
+    // 推送到达时就地更新余额与交易记录；未连接时操作后整体刷新
+    OutboxSubscriber* changeFeed;
+
     void setupUI();
     void loadAccountInfo();
     void updateBalanceDisplay();
     void loadTransactionHistory();
+    void fetchHistoryPage();
+    void showHistoryPage(const QList<QVariantMap>& history);
+    void appendHistoryRows(const QList<QVariantMap>& history);
+    void setHistoryRow(int row, const QVariantMap& record);
+    bool historyFilterAccepts(const QVariantMap& record) const;
+    void refreshAfterOperation();
+    TransactionFilter buildHistoryFilter() const;
     void showMessage(const QString& title, const QString& message);
 
     // 管理员功能
     void setupAdminUI();
     void loadAllUsers();
+    void fetchMoreUsers();
+    void appendUserRows(const QList<QVariantMap>& users);
     void loadAllAccounts();
-    bool isAdmin() const;
+    void fetchMoreAccounts();
+    void appendAccountRows(const QList<QVariantMap>& accounts);
+    QList<int> selectedAccountRows() const;
+    void changeSelectedAccountsStatus(bool freeze);  // 批量冻结/解冻选中账户
+    bool isAdmin() const;  // 会话缓存命中，不访问数据库
 
 signals:
     void loggedOut();  // 退出登录信号
@@ -0,0 +1,149 @@
+/*
+ 将已有的未分区 transactions 表在线迁移为按月分区表
+
+ 步骤：
+   1. 创建分区结构的影子表 transactions_new
+   2. 在旧表上创建触发器，把迁移期间的新增/修改/删除同步到影子表
+   3. 按主键分批复制历史数据（每批独立提交，不长时间锁表）
+   4. RENAME TABLE 原子切换，旧表保留为 transactions_old 以便回滚
+
+ 用法：
+   mysql -u root -p banksystem < migrations/001_partition_transactions.sql
+
+ 注意：分区表不支持外键，transactions_ibfk_1 会被去掉，
+ 账户删除时由 DatabaseManager::deleteAccount 显式删除交易记录。
+ 初始分区从最早交易所在月份开始，未来分区由 TransactionArchiver 自动补齐。
+*/
+
+SET NAMES utf8mb4;
+
+-- ----------------------------
+-- 1. 影子表
+-- ----------------------------
+DROP TABLE IF EXISTS `transactions_new`;
+CREATE TABLE `transactions_new`  (
+  `transaction_id` int NOT NULL AUTO_INCREMENT,
+  `account_id` varchar(20) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL,
+  `transaction_type` varchar(20) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL,
+  `amount` decimal(15, 2) NOT NULL,
+  `target_account` varchar(20) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NULL DEFAULT NULL,
+  `description` varchar(200) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NULL DEFAULT NULL,
+  `transaction_time` timestamp NOT NULL DEFAULT CURRENT_TIMESTAMP,
+  PRIMARY KEY (`transaction_id`, `transaction_time`) USING BTREE,
+  INDEX `idx_transactions_account_id`(`account_id` ASC) USING BTREE,
+  INDEX `idx_transactions_time`(`transaction_time` DESC) USING BTREE
+) ENGINE = InnoDB CHARACTER SET = utf8mb4 COLLATE = utf8mb4_unicode_ci ROW_FORMAT = Dynamic
+PARTITION BY RANGE (UNIX_TIMESTAMP(`transaction_time`)) (
+  PARTITION `pmax` VALUES LESS THAN MAXVALUE
+);
+
+-- 按旧表的时间跨度拆分出月份分区
+DROP PROCEDURE IF EXISTS `bank_split_month_partitions`;
+DELIMITER //
+CREATE PROCEDURE `bank_split_month_partitions`()
+BEGIN
+  DECLARE v_month DATE;
+  DECLARE v_last DATE;
+
+  SELECT DATE_FORMAT(COALESCE(MIN(transaction_time), NOW()), '%Y-%m-01'),
+         DATE_FORMAT(DATE_ADD(NOW(), INTERVAL 3 MONTH), '%Y-%m-01')
+    INTO v_month, v_last
+    FROM transactions;
+
+  WHILE v_month <= v_last DO
+    SET @ddl = CONCAT('ALTER TABLE transactions_new REORGANIZE PARTITION pmax INTO (',
+                      'PARTITION p', DATE_FORMAT(v_month, '%Y%m'),
+                      ' VALUES LESS THAN (UNIX_TIMESTAMP(''',
+                      DATE_FORMAT(DATE_ADD(v_month, INTERVAL 1 MONTH), '%Y-%m-%d'), ' 00:00:00'')), ',
+                      'PARTITION pmax VALUES LESS THAN MAXVALUE)');
+    PREPARE stmt FROM @ddl;
+    EXECUTE stmt;
+    DEALLOCATE PREPARE stmt;
+    SET v_month = DATE_ADD(v_month, INTERVAL 1 MONTH);
+  END WHILE;
+END //
+DELIMITER ;
+
+CALL `bank_split_month_partitions`();
+DROP PROCEDURE `bank_split_month_partitions`;
+
+-- ----------------------------
+-- 2. 同步触发器
+-- ----------------------------
+DROP TRIGGER IF EXISTS `trg_transactions_migrate_ins`;
+DROP TRIGGER IF EXISTS `trg_transactions_migrate_upd`;
+DROP TRIGGER IF EXISTS `trg_transactions_migrate_del`;
+
+CREATE TRIGGER `trg_transactions_migrate_ins` AFTER INSERT ON `transactions` FOR EACH ROW
+  REPLACE INTO `transactions_new` VALUES (NEW.transaction_id, NEW.account_id, NEW.transaction_type,
+                                          NEW.amount, NEW.target_account, NEW.description,
+                                          COALESCE(NEW.transaction_time, CURRENT_TIMESTAMP));
+
+CREATE TRIGGER `trg_transactions_migrate_upd` AFTER UPDATE ON `transactions` FOR EACH ROW
+  REPLACE INTO `transactions_new` VALUES (NEW.transaction_id, NEW.account_id, NEW.transaction_type,
+                                          NEW.amount, NEW.target_account, NEW.description,
+                                          COALESCE(NEW.transaction_time, CURRENT_TIMESTAMP));
+
+CREATE TRIGGER `trg_transactions_migrate_del` AFTER DELETE ON `transactions` FOR EACH ROW
+  DELETE FROM `transactions_new` WHERE transaction_id = OLD.transaction_id;
+
+-- ----------------------------
+-- 3. 分批复制
+-- ----------------------------
+DROP PROCEDURE IF EXISTS `bank_copy_transactions`;
+DELIMITER //
+CREATE PROCEDURE `bank_copy_transactions`(IN p_batch INT)
+BEGIN
+  DECLARE v_next INT DEFAULT 0;
+  DECLARE v_max INT;
+
+  SELECT COALESCE(MAX(transaction_id), 0) INTO v_max FROM transactions;
+
+  WHILE v_next <= v_max DO
+    -- INSERT IGNORE：已由触发器同步过的行以触发器版本为准
+    INSERT IGNORE INTO transactions_new
+      SELECT transaction_id, account_id, transaction_type, amount, target_account, description,
+             COALESCE(transaction_time, CURRENT_TIMESTAMP)
+        FROM transactions
+       WHERE transaction_id > v_next AND transaction_id <= v_next + p_batch;
+    COMMIT;
+    SET v_next = v_next + p_batch;
+    DO SLEEP(0.01);  -- 让出 IO，降低对在线业务的影响
+  END WHILE;
+END //
+DELIMITER ;
+
+CALL `bank_copy_transactions`(10000);
+DROP PROCEDURE `bank_copy_transactions`;
+
+-- 自增值至少与旧表一致
+SET @next_id = (SELECT COALESCE(MAX(transaction_id), 0) + 1 FROM transactions);
+SET @ddl = CONCAT('ALTER TABLE transactions_new AUTO_INCREMENT = ', @next_id);
+PREPARE stmt FROM @ddl;
+EXECUTE stmt;
+DEALLOCATE PREPARE stmt;
+
+-- ----------------------------
+-- 4. 原子切换
+-- ----------------------------
+RENAME TABLE `transactions` TO `transactions_old`, `transactions_new` TO `transactions`;
+
+DROP TRIGGER IF EXISTS `trg_transactions_migrate_ins`;
+DROP TRIGGER IF EXISTS `trg_transactions_migrate_upd`;
+DROP TRIGGER IF EXISTS `trg_transactions_migrate_del`;
+
+CREATE TABLE IF NOT EXISTS `transaction_archives`  (
+  `archive_id` int NOT NULL AUTO_INCREMENT,
+  `partition_name` varchar(16) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL,
+  `range_start` timestamp NOT NULL,
+  `range_end` timestamp NOT NULL,
+  `file_path` varchar(255) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL,
+  `row_count` int NOT NULL,
+  `checksum` char(64) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL,
+  `archived_at` timestamp NULL DEFAULT CURRENT_TIMESTAMP,
+  PRIMARY KEY (`archive_id`) USING BTREE,
+  UNIQUE INDEX `uk_archives_partition`(`partition_name` ASC) USING BTREE,
+  INDEX `idx_archives_range`(`range_start` ASC, `range_end` ASC) USING BTREE
+) ENGINE = InnoDB CHARACTER SET = utf8mb4 COLLATE = utf8mb4_unicode_ci ROW_FORMAT = Dynamic;
+
+-- 校验无误后手动执行：DROP TABLE `transactions_old`;
@@ -0,0 +1,21 @@
+/*
+ 交易记录筛选所需的复合索引
+
+ - idx_transactions_account_time       账户 + 时间倒序，覆盖默认列表与键集分页
+ - idx_transactions_account_type_time  账户 + 类型筛选后仍按时间有序
+ - idx_transactions_account_amount     账户内金额区间（003 中改为 account_type_amount）
+ - idx_transactions_target_time        按对方账户查找转账
+
+ 原 idx_transactions_account_id 是 idx_transactions_account_time 的前缀，一并删除。
+ 描述关键字使用 LIKE '%x%'，分区表不支持 FULLTEXT，依赖账户前缀索引缩小扫描范围。
+ ALGORITHM=INPLACE, LOCK=NONE 在线执行，不阻塞读写。
+*/
+
+ALTER TABLE `transactions`
+  ADD INDEX `idx_transactions_account_time`(`account_id` ASC, `transaction_time` DESC, `transaction_id` DESC),
+  ADD INDEX `idx_transactions_account_type_time`(`account_id` ASC, `transaction_type` ASC, `transaction_time` DESC),
+  ADD INDEX `idx_transactions_account_amount`(`account_id` ASC, `amount` ASC),
+  ADD INDEX `idx_transactions_target_time`(`target_account` ASC, `transaction_time` DESC),
+  ALGORITHM = INPLACE, LOCK = NONE;
+
+ALTER TABLE `transactions` DROP INDEX `idx_transactions_account_id`, ALGORITHM = INPLACE, LOCK = NONE;
@@ -0,0 +1,19 @@
+/*
+ 账务核对支持
+
+ - archived_account_flows：已归档分区的账户净额结转，对账时与在线流水合并
+ - idx_transactions_account_type_amount：替换 idx_transactions_account_amount，
+   按 (account_id, transaction_type) 汇总金额时为覆盖索引，无需回表；
+   账户内金额区间筛选仍可使用该索引前缀
+*/
+
+CREATE TABLE IF NOT EXISTS `archived_account_flows`  (
+  `account_id` varchar(20) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL,
+  `net_amount` decimal(17, 2) NOT NULL DEFAULT 0.00,
+  PRIMARY KEY (`account_id`) USING BTREE
+) ENGINE = InnoDB CHARACTER SET = utf8mb4 COLLATE = utf8mb4_unicode_ci ROW_FORMAT = Dynamic;
+
+ALTER TABLE `transactions`
+  ADD INDEX `idx_transactions_account_type_amount`(`account_id` ASC, `transaction_type` ASC, `amount` ASC),
+  DROP INDEX `idx_transactions_account_amount`,
+  ALGORITHM = INPLACE, LOCK = NONE;
@@ -0,0 +1,18 @@
+/*
+ 写操作幂等键
+
+ 客户端为每个写请求生成唯一键（如 UUID），DatabaseManager 在业务事务内登记该键，
+ 重复提交时直接返回首次结果。request_fingerprint 为操作名与参数的 SHA-256，
+ 用于发现同一键被不同请求复用。过期键按 created_at 分批清理（默认保留 24 小时）。
+*/
+
+CREATE TABLE IF NOT EXISTS `idempotency_keys`  (
+  `idem_key` varchar(64) CHARACTER SET utf8mb4 COLLATE utf8mb4_bin NOT NULL,
+  `operation` varchar(32) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL,
+  `request_fingerprint` char(64) CHARACTER SET ascii COLLATE ascii_bin NOT NULL,
+  `success` tinyint(1) NOT NULL,
+  `result` varchar(64) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NULL DEFAULT NULL,
+  `created_at` timestamp NOT NULL DEFAULT CURRENT_TIMESTAMP,
+  PRIMARY KEY (`idem_key`) USING BTREE,
+  INDEX `idx_idempotency_created_at`(`created_at` ASC) USING BTREE
+) ENGINE = InnoDB CHARACTER SET = utf8mb4 COLLATE = utf8mb4_unicode_ci ROW_FORMAT = Dynamic;
@@ -0,0 +1,13 @@
+/*
+ 用户角色与口令散列
+
+ - role：权限来自库中角色而非用户名，登录时随会话令牌签发
+ - password 扩展到 255 以容纳 scrypt 散列（$scrypt$ln=..,r=..,p=..$盐$散列）；
+   现有明文密码无需离线转换，用户下次登录成功时自动升级为散列
+*/
+
+ALTER TABLE `users`
+  MODIFY COLUMN `password` varchar(255) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL,
+  ADD COLUMN `role` varchar(16) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL DEFAULT 'customer' AFTER `email`;
+
+UPDATE `users` SET `role` = 'admin' WHERE `username` = 'admin';
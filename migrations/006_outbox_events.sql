@@ -0,0 +1,23 @@
+/*
+ 变更事件发件箱
+
+ 存款、取款、转账、冻结/解冻在业务事务内写入一行事件（含事件后余额），
+ OutboxPublisher 按 event_id 跟踪新增行并经本地套接字推送给已打开的会话，
+ 界面据此就地更新余额与交易记录，无需整表重新查询。事件保留 24 小时后分批清理。
+*/
+
+CREATE TABLE IF NOT EXISTS `outbox_events`  (
+  `event_id` bigint UNSIGNED NOT NULL AUTO_INCREMENT,
+  `event_type` varchar(16) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL,
+  `account_id` varchar(20) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL,
+  `transaction_id` int NULL DEFAULT NULL,
+  `transaction_type` varchar(20) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NULL DEFAULT NULL,
+  `amount` decimal(15, 2) NULL DEFAULT NULL,
+  `counterparty` varchar(20) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NULL DEFAULT NULL,
+  `description` varchar(200) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NULL DEFAULT NULL,
+  `balance_after` decimal(15, 2) NULL DEFAULT NULL,
+  `account_status` varchar(20) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NULL DEFAULT NULL,
+  `created_at` timestamp(3) NOT NULL DEFAULT CURRENT_TIMESTAMP(3),
+  PRIMARY KEY (`event_id`) USING BTREE,
+  INDEX `idx_outbox_created_at`(`created_at` ASC) USING BTREE
+) ENGINE = InnoDB CHARACTER SET = utf8mb4 COLLATE = utf8mb4_unicode_ci ROW_FORMAT = Dynamic;
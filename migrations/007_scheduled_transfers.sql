@@ -0,0 +1,43 @@
+/*
+ 定期/预约转账
+
+ scheduled_transfers 保存指令，next_run_at 为下一期应执行时间；调度线程按
+ (status, next_run_at) 索引把一天内到期的指令放入时间轮，停机后启动时按同一索引补执行逾期指令。
+ scheduled_transfer_runs 记录每一期的执行结果，(order_id, due_at) 唯一，同一期不会重复扣款。
+*/
+
+CREATE TABLE IF NOT EXISTS `scheduled_transfers`  (
+  `order_id` bigint UNSIGNED NOT NULL AUTO_INCREMENT,
+  `from_account` varchar(20) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL,
+  `to_account` varchar(20) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL,
+  `amount` decimal(15, 2) NOT NULL,
+  `description` varchar(200) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NULL DEFAULT NULL,
+  `frequency` varchar(10) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL DEFAULT 'once',
+  `interval_count` int NOT NULL DEFAULT 1,
+  `start_at` datetime NOT NULL,
+  `end_at` datetime NULL DEFAULT NULL,
+  `max_runs` int NULL DEFAULT NULL,
+  `runs_done` int NOT NULL DEFAULT 0,
+  `next_run_at` datetime NOT NULL,
+  `status` varchar(10) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL DEFAULT 'active',
+  `consecutive_failures` int NOT NULL DEFAULT 0,
+  `last_run_at` timestamp NULL DEFAULT NULL,
+  `created_at` timestamp NOT NULL DEFAULT CURRENT_TIMESTAMP,
+  `updated_at` timestamp NOT NULL DEFAULT CURRENT_TIMESTAMP ON UPDATE CURRENT_TIMESTAMP,
+  PRIMARY KEY (`order_id`) USING BTREE,
+  INDEX `idx_scheduled_due`(`status` ASC, `next_run_at` ASC, `order_id` ASC) USING BTREE,
+  INDEX `idx_scheduled_updated_at`(`updated_at` ASC) USING BTREE,
+  INDEX `idx_scheduled_from_account`(`from_account` ASC) USING BTREE
+) ENGINE = InnoDB CHARACTER SET = utf8mb4 COLLATE = utf8mb4_unicode_ci ROW_FORMAT = Dynamic;
+
+CREATE TABLE IF NOT EXISTS `scheduled_transfer_runs`  (
+  `run_id` bigint UNSIGNED NOT NULL AUTO_INCREMENT,
+  `order_id` bigint UNSIGNED NOT NULL,
+  `due_at` datetime NOT NULL,
+  `executed_at` timestamp NOT NULL DEFAULT CURRENT_TIMESTAMP,
+  `outcome` varchar(24) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL,
+  `transaction_id` int NULL DEFAULT NULL,
+  `message` varchar(200) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NULL DEFAULT NULL,
+  PRIMARY KEY (`run_id`) USING BTREE,
+  UNIQUE INDEX `uk_scheduled_run`(`order_id` ASC, `due_at` ASC) USING BTREE
+) ENGINE = InnoDB CHARACTER SET = utf8mb4 COLLATE = utf8mb4_unicode_ci ROW_FORMAT = Dynamic;
@@ -0,0 +1,42 @@
+/*
+ 每日计息
+
+ - accounts.interest_carry：不足 1 分的利息累计（单位 1e-6 分），凑满 1 分后入账
+ - interest_rates：各账户类型的年利率，日利率按 360 天计
+ - interest_accrual_runs / interest_accrual_chunks：计息日与账户号区间的完成进度，
+   区间的完成标记与入账在同一事务中写入，中断后重跑同一日期只处理未完成的区间
+*/
+
+ALTER TABLE `accounts`
+  ADD COLUMN `interest_carry` bigint NOT NULL DEFAULT 0 AFTER `created_at`;
+
+CREATE TABLE IF NOT EXISTS `interest_accrual_chunks`  (
+  `accrual_date` date NOT NULL,
+  `chunk_no` int NOT NULL,
+  `low_account` varchar(20) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL,
+  `high_account` varchar(20) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NULL DEFAULT NULL,
+  `status` varchar(10) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL DEFAULT 'pending',
+  `accounts` int NOT NULL DEFAULT 0,
+  `interest` decimal(17, 2) NOT NULL DEFAULT 0.00,
+  `finished_at` timestamp NULL DEFAULT NULL,
+  PRIMARY KEY (`accrual_date`, `chunk_no`) USING BTREE
+) ENGINE = InnoDB CHARACTER SET = utf8mb4 COLLATE = utf8mb4_unicode_ci ROW_FORMAT = Dynamic;
+
+CREATE TABLE IF NOT EXISTS `interest_accrual_runs`  (
+  `accrual_date` date NOT NULL,
+  `status` varchar(10) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL DEFAULT 'running',
+  `chunks` int NOT NULL DEFAULT 0,
+  `accounts` bigint NOT NULL DEFAULT 0,
+  `interest` decimal(19, 2) NOT NULL DEFAULT 0.00,
+  `started_at` timestamp NOT NULL DEFAULT CURRENT_TIMESTAMP,
+  `finished_at` timestamp NULL DEFAULT NULL,
+  PRIMARY KEY (`accrual_date`) USING BTREE
+) ENGINE = InnoDB CHARACTER SET = utf8mb4 COLLATE = utf8mb4_unicode_ci ROW_FORMAT = Dynamic;
+
+CREATE TABLE IF NOT EXISTS `interest_rates`  (
+  `account_type` varchar(20) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL,
+  `annual_rate` decimal(9, 6) NOT NULL,
+  PRIMARY KEY (`account_type`) USING BTREE
+) ENGINE = InnoDB CHARACTER SET = utf8mb4 COLLATE = utf8mb4_unicode_ci ROW_FORMAT = Dynamic;
+
+INSERT IGNORE INTO `interest_rates` VALUES ('储蓄账户', 0.003500), ('活期账户', 0.002000), ('定期账户', 0.015000);
@@ -0,0 +1,24 @@
+/*
+ 取款/转账限额
+
+ velocity_limits 按账户类型与操作（withdraw / transfer）配置日累计金额、日次数、
+ 每小时金额与次数，0 表示不限。限额计数常驻内存，程序连接数据库时按最近 24 小时的交易重建，
+ 修改本表后重新连接生效。预约/定期转账为事先授权的指令，不受限额约束。
+*/
+
+CREATE TABLE IF NOT EXISTS `velocity_limits`  (
+  `account_type` varchar(20) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL,
+  `operation` varchar(10) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL,
+  `daily_amount` decimal(15, 2) NOT NULL DEFAULT 0.00,
+  `daily_count` int NOT NULL DEFAULT 0,
+  `hourly_amount` decimal(15, 2) NOT NULL DEFAULT 0.00,
+  `hourly_count` int NOT NULL DEFAULT 0,
+  PRIMARY KEY (`account_type`, `operation`) USING BTREE
+) ENGINE = InnoDB CHARACTER SET = utf8mb4 COLLATE = utf8mb4_unicode_ci ROW_FORMAT = Dynamic;
+
+INSERT IGNORE INTO `velocity_limits` VALUES ('储蓄账户', 'withdraw', 50000.00, 20, 20000.00, 10);
+INSERT IGNORE INTO `velocity_limits` VALUES ('储蓄账户', 'transfer', 200000.00, 50, 50000.00, 20);
+INSERT IGNORE INTO `velocity_limits` VALUES ('活期账户', 'withdraw', 50000.00, 20, 20000.00, 10);
+INSERT IGNORE INTO `velocity_limits` VALUES ('活期账户', 'transfer', 200000.00, 50, 50000.00, 20);
+INSERT IGNORE INTO `velocity_limits` VALUES ('定期账户', 'withdraw', 10000.00, 3, 0.00, 0);
+INSERT IGNORE INTO `velocity_limits` VALUES ('定期账户', 'transfer', 10000.00, 3, 0.00, 0);
@@ -0,0 +1,11 @@
+/*
+ 管理员账户列表的分页索引
+
+ 账户列表按 (created_at, account_id) 倒序键集分页，每页作为一个批量任务执行，
+ 页与页之间让出数据库工作线程给客户操作。没有该索引时每页都要对 accounts 全表排序。
+ ALGORITHM=INPLACE, LOCK=NONE 在线执行，不阻塞读写。
+*/
+
+ALTER TABLE `accounts`
+  ADD INDEX `idx_accounts_created`(`created_at` DESC, `account_id` DESC),
+  ALGORITHM = INPLACE, LOCK = NONE;
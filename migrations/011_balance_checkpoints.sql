@@ -0,0 +1,22 @@
+/*
+ 每日余额检查点
+
+ balance_checkpoints 保存每个账户每天的日终余额（checkpoint_date 当天 24:00），
+ 主键 (account_id, checkpoint_date) 使“某时点之前最近的检查点”只需一次索引查找；
+ balance_checkpoint_runs 记录已完整写入的日期，后台任务中断后从未完成的日期继续。
+ 程序连接后自动写入昨天的检查点，此前的日期在没有检查点时由当前余额倒推。
+*/
+
+CREATE TABLE IF NOT EXISTS `balance_checkpoints`  (
+  `account_id` varchar(20) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL,
+  `checkpoint_date` date NOT NULL,
+  `balance` decimal(15, 2) NOT NULL,
+  PRIMARY KEY (`account_id`, `checkpoint_date`) USING BTREE
+) ENGINE = InnoDB CHARACTER SET = utf8mb4 COLLATE = utf8mb4_unicode_ci ROW_FORMAT = Dynamic;
+
+CREATE TABLE IF NOT EXISTS `balance_checkpoint_runs`  (
+  `checkpoint_date` date NOT NULL,
+  `accounts` int NOT NULL DEFAULT 0,
+  `completed_at` timestamp NOT NULL DEFAULT CURRENT_TIMESTAMP,
+  PRIMARY KEY (`checkpoint_date`) USING BTREE
+) ENGINE = InnoDB CHARACTER SET = utf8mb4 COLLATE = utf8mb4_unicode_ci ROW_FORMAT = Dynamic;
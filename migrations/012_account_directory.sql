@@ -0,0 +1,12 @@
+/*
+ 账户目录增量刷新
+
+ 客户端在内存中保存账户号、户名与状态，用于转账目标校验和账户号自动补全。
+ status_changed_at 在开户时取默认值，冻结/解冻时更新（余额变化不更新），
+ 客户端每 5 秒读取此后变化的账户；销户由每小时的整体重建清除。
+*/
+
+ALTER TABLE `accounts`
+  ADD COLUMN `status_changed_at` timestamp NOT NULL DEFAULT CURRENT_TIMESTAMP,
+  ADD INDEX `idx_accounts_status_changed`(`status_changed_at` ASC),
+  ALGORITHM = INPLACE, LOCK = NONE;
@@ -0,0 +1,22 @@
+/*
+ 管理员用户/账户列表的筛选与排序索引
+
+ 管理员列表改为服务端筛选、排序和键集分页，界面滚动到底部时才读取下一页。
+ - idx_users_phone               手机号前缀搜索（用户名、身份证号已有唯一索引）
+ - idx_accounts_status_created   按状态筛选后仍按开户时间倒序分页
+ - idx_accounts_balance          按余额排序分页
+ 用户列表按 user_id（注册顺序）或用户名排序，分别走主键和 username 唯一索引；
+ 账户号排序走主键，开户时间排序沿用 010 的 idx_accounts_created。
+ 原 idx_users_username 与唯一索引 username 完全重复，一并删除。
+ ALGORITHM=INPLACE, LOCK=NONE 在线执行，不阻塞读写。
+*/
+
+ALTER TABLE `users`
+  ADD INDEX `idx_users_phone`(`phone` ASC),
+  DROP INDEX `idx_users_username`,
+  ALGORITHM = INPLACE, LOCK = NONE;
+
+ALTER TABLE `accounts`
+  ADD INDEX `idx_accounts_status_created`(`status` ASC, `created_at` DESC, `account_id` DESC),
+  ADD INDEX `idx_accounts_balance`(`balance` DESC, `account_id` DESC),
+  ALGORITHM = INPLACE, LOCK = NONE;
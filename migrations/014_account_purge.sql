@@ -0,0 +1,22 @@
+/*
+ 销户后台清理
+
+ 销户不再在一个事务里删除账户的全部交易记录：账户先标记为“已销户”，不再接受存取款和转账，
+ AccountPurger 每次把最早的 500 条交易记录迁入 closed_account_transactions 并从 transactions 删除，
+ 每批一个短事务；记录清空后删除检查点、归档净额与账户行。
+ - idx_accounts_status_created（013）用于查找待清理的已销户账户
+ - closed_account_transactions 保留已销户账户的交易记录副本，列与 transactions 相同
+*/
+
+CREATE TABLE IF NOT EXISTS `closed_account_transactions`  (
+  `transaction_id` int NOT NULL,
+  `account_id` varchar(20) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL,
+  `transaction_type` varchar(20) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL,
+  `amount` decimal(15, 2) NOT NULL,
+  `target_account` varchar(20) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NULL DEFAULT NULL,
+  `description` varchar(200) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NULL DEFAULT NULL,
+  `transaction_time` timestamp NOT NULL,
+  `purged_at` timestamp NOT NULL DEFAULT CURRENT_TIMESTAMP,
+  PRIMARY KEY (`transaction_id`, `transaction_time`),
+  INDEX `idx_closed_account_time`(`account_id` ASC, `transaction_time` DESC)
+) ENGINE = InnoDB CHARACTER SET = utf8mb4 COLLATE = utf8mb4_unicode_ci ROW_FORMAT = Dynamic;
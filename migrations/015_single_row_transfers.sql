@@ -0,0 +1,62 @@
+/*
+ 转账单行复式分录
+
+ 转账原来写两行：转出方的“转账”行和转入方的“收款”行，两行只是对调了 account_id/target_account，
+ 每笔转账的行数、索引维护和存储都翻倍。现在一笔转账只写一行：
+ - credit_account                  转入方（贷方分录），只有转账行非空
+ - idx_transactions_credit_time    按贷方账户读取流水与汇总，取代 idx_transactions_target_time
+ 按账户读取流水时，贷方分录还原为原来的“收款”行，交易记录界面、对账单与对账结果不变。
+
+ 已有数据：能配对的“收款”行（与某“转账”行账户对调、金额与时间相同、交易号在其后）删除，
+ 对应“转账”行补上 credit_account；无法唯一配对的“收款”行保留为独立记录，余额与流水仍然一致。
+ 新程序可以先于本脚本上线：credit_account 为空的转账行只计借方，“收款”行照常计入转入方。
+ 配对与删除在一个事务中完成，表较大时请在低峰时段执行。
+
+ closed_account_transactions 中同一交易号可能同时有转出、转入两个已销户账户的记录，主键改为 (transaction_id, account_id)。
+*/
+
+ALTER TABLE `transactions`
+  ADD COLUMN `credit_account` varchar(20) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NULL DEFAULT NULL AFTER `target_account`,
+  ADD INDEX `idx_transactions_credit_time`(`credit_account` ASC, `transaction_time` DESC, `transaction_id` DESC),
+  ALGORITHM = INPLACE, LOCK = NONE;
+
+CREATE TEMPORARY TABLE `transfer_pairs` (
+  `debit_id` int NOT NULL,
+  `credit_id` int NOT NULL,
+  `transaction_time` timestamp NOT NULL,
+  PRIMARY KEY (`debit_id`),
+  UNIQUE INDEX `uk_transfer_pairs_credit`(`credit_id`)
+) ENGINE = InnoDB;
+
+-- 每个“转账”行取其后最近的一条匹配“收款”行；两笔同时发生的相同转账争同一行时只配对一笔
+INSERT IGNORE INTO `transfer_pairs` (`debit_id`, `credit_id`, `transaction_time`)
+SELECT d.`transaction_id`, MIN(c.`transaction_id`), d.`transaction_time`
+FROM `transactions` d
+JOIN `transactions` c
+  ON c.`account_id` = d.`target_account`
+ AND c.`target_account` = d.`account_id`
+ AND c.`transaction_time` = d.`transaction_time`
+ AND c.`amount` = d.`amount`
+ AND c.`transaction_type` = '收款'
+ AND c.`transaction_id` > d.`transaction_id`
+WHERE d.`transaction_type` = '转账' AND d.`credit_account` IS NULL
+GROUP BY d.`transaction_id`, d.`transaction_time`;
+
+START TRANSACTION;
+
+UPDATE `transactions` d
+JOIN `transfer_pairs` p ON d.`transaction_id` = p.`debit_id` AND d.`transaction_time` = p.`transaction_time`
+SET d.`credit_account` = d.`target_account`;
+
+DELETE c FROM `transactions` c
+JOIN `transfer_pairs` p ON c.`transaction_id` = p.`credit_id` AND c.`transaction_time` = p.`transaction_time`;
+
+COMMIT;
+
+DROP TEMPORARY TABLE `transfer_pairs`;
+
+ALTER TABLE `transactions` DROP INDEX `idx_transactions_target_time`, ALGORITHM = INPLACE, LOCK = NONE;
+
+ALTER TABLE `closed_account_transactions`
+  DROP PRIMARY KEY,
+  ADD PRIMARY KEY (`transaction_id`, `account_id`);
@@ -0,0 +1,132 @@
+/*
+ 紧凑存储：账户号改为整数列，交易类型、账户状态与账户类型改为小整数编码
+
+ 账户号原为 varchar(20) + utf8mb4_unicode_ci：每个值 19 字节左右再加长度前缀，比较要走排序规则，
+ 而它出现在 transactions 的主键以外的每个二级索引里。账户号全为数字（18~19 位，小于 2^64），
+ 现在直接以 BIGINT UNSIGNED 存储（8 字节定长、按整数比较），账户号本身即为内部键，不另设代理键，
+ 请求仍按账户号查找，不需要多一次号码到键的换算。
+ - accounts.account_id 及各表引用账户号的列（transactions.account_id/target_account/credit_account、
+   closed_account_transactions、balance_checkpoints、archived_account_flows、outbox_events、
+   scheduled_transfers、interest_accrual_chunks）改为 BIGINT UNSIGNED
+ - transaction_type 改为 TINYINT UNSIGNED：1 存款、2 取款、3 转账、4 收款、5 利息（对照表 transaction_types）
+ - accounts.status 改为 TINYINT UNSIGNED：1 正常、2 冻结、3 已销户（对照表 account_statuses）
+ - accounts.account_type 改为 account_types.type_code；interest_rates、velocity_limits 仍按类型名称配置
+ 编码与程序中的 schema.h 一致，界面、对账单、归档文件与变更事件中仍是名称。
+ 前后对比可用 benchmarks/compactschema 在同一台服务器上生成两种表结构的数据并测量。
+
+ 本脚本与新程序须一起上线：旧程序按名称写入的类型、状态无法写入整数列，新程序也读不了旧表。
+ 请在维护窗口停止应用后执行。transactions 采用复制后换名：先建好新结构的空表再按主键顺序灌入，
+ 比原地 ALTER 少一次全表回写，旧表保留为 transactions_varchar，核对无误后再删除。
+ 执行前确认账户号都是数字（下面的查询应无结果），否则 MODIFY 会在严格模式下报错中止：
+   SELECT account_id FROM accounts WHERE account_id NOT REGEXP '^[1-9][0-9]{0,19}$';
+*/
+
+CREATE TABLE IF NOT EXISTS `transaction_types`  (
+  `type_code` tinyint UNSIGNED NOT NULL,
+  `type_name` varchar(20) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL,
+  PRIMARY KEY (`type_code`),
+  UNIQUE INDEX `uk_transaction_types_name`(`type_name` ASC)
+) ENGINE = InnoDB CHARACTER SET = utf8mb4 COLLATE = utf8mb4_unicode_ci ROW_FORMAT = Dynamic;
+
+INSERT IGNORE INTO `transaction_types` VALUES (1, '存款'), (2, '取款'), (3, '转账'), (4, '收款'), (5, '利息');
+
+CREATE TABLE IF NOT EXISTS `account_statuses`  (
+  `status_code` tinyint UNSIGNED NOT NULL,
+  `status_name` varchar(20) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL,
+  PRIMARY KEY (`status_code`),
+  UNIQUE INDEX `uk_account_statuses_name`(`status_name` ASC)
+) ENGINE = InnoDB CHARACTER SET = utf8mb4 COLLATE = utf8mb4_unicode_ci ROW_FORMAT = Dynamic;
+
+INSERT IGNORE INTO `account_statuses` VALUES (1, '正常'), (2, '冻结'), (3, '已销户');
+
+CREATE TABLE IF NOT EXISTS `account_types`  (
+  `type_code` tinyint UNSIGNED NOT NULL AUTO_INCREMENT,
+  `type_name` varchar(20) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NOT NULL,
+  PRIMARY KEY (`type_code`),
+  UNIQUE INDEX `uk_account_types_name`(`type_name` ASC)
+) ENGINE = InnoDB CHARACTER SET = utf8mb4 COLLATE = utf8mb4_unicode_ci ROW_FORMAT = Dynamic;
+
+-- 已配置利率的类型与账户中实际出现的类型都要登记
+INSERT IGNORE INTO `account_types` (`type_code`, `type_name`) VALUES (1, '储蓄账户'), (2, '活期账户'), (3, '定期账户');
+INSERT IGNORE INTO `account_types` (`type_name`) SELECT `account_type` FROM `interest_rates`;
+INSERT IGNORE INTO `account_types` (`type_name`)
+SELECT DISTINCT `account_type` FROM `accounts` WHERE `account_type` IS NOT NULL;
+
+-- ----------------------------
+-- accounts：先把名称换成编码文本，再改列类型
+-- ----------------------------
+UPDATE `accounts` a
+LEFT JOIN `account_types` t ON t.`type_name` = a.`account_type`
+SET a.`account_type` = t.`type_code`,
+    a.`status` = NULLIF(FIELD(a.`status`, '正常', '冻结', '已销户'), 0);
+
+ALTER TABLE `accounts`
+  MODIFY COLUMN `account_id` bigint UNSIGNED NOT NULL,
+  MODIFY COLUMN `account_type` tinyint UNSIGNED NULL DEFAULT 1,
+  MODIFY COLUMN `status` tinyint UNSIGNED NULL DEFAULT 1;
+
+-- ----------------------------
+-- transactions：建新结构的空表，按主键顺序灌入后换名
+-- ----------------------------
+DROP TABLE IF EXISTS `transactions_compact`;
+CREATE TABLE `transactions_compact` LIKE `transactions`;
+
+ALTER TABLE `transactions_compact`
+  MODIFY COLUMN `account_id` bigint UNSIGNED NOT NULL,
+  MODIFY COLUMN `transaction_type` tinyint UNSIGNED NOT NULL,
+  MODIFY COLUMN `target_account` bigint UNSIGNED NULL DEFAULT NULL,
+  MODIFY COLUMN `credit_account` bigint UNSIGNED NULL DEFAULT NULL;
+
+INSERT INTO `transactions_compact`
+  (`transaction_id`, `account_id`, `transaction_type`, `amount`, `target_account`, `credit_account`,
+   `description`, `transaction_time`)
+SELECT `transaction_id`, CAST(`account_id` AS UNSIGNED),
+       FIELD(`transaction_type`, '存款', '取款', '转账', '收款', '利息'), `amount`,
+       CAST(`target_account` AS UNSIGNED), CAST(`credit_account` AS UNSIGNED),
+       `description`, `transaction_time`
+FROM `transactions`
+ORDER BY `transaction_id`, `transaction_time`;
+
+RENAME TABLE `transactions` TO `transactions_varchar`, `transactions_compact` TO `transactions`;
+
+-- ----------------------------
+-- 其余引用账户号或编码的表：行数较少，原地修改
+-- ----------------------------
+UPDATE `closed_account_transactions`
+SET `transaction_type` = FIELD(`transaction_type`, '存款', '取款', '转账', '收款', '利息');
+
+ALTER TABLE `closed_account_transactions`
+  MODIFY COLUMN `account_id` bigint UNSIGNED NOT NULL,
+  MODIFY COLUMN `transaction_type` tinyint UNSIGNED NOT NULL,
+  MODIFY COLUMN `target_account` bigint UNSIGNED NULL DEFAULT NULL;
+
+UPDATE `outbox_events`
+SET `transaction_type` = NULLIF(FIELD(`transaction_type`, '存款', '取款', '转账', '收款', '利息'), 0),
+    `account_status` = NULLIF(FIELD(`account_status`, '正常', '冻结', '已销户'), 0);
+
+ALTER TABLE `outbox_events`
+  MODIFY COLUMN `account_id` bigint UNSIGNED NOT NULL,
+  MODIFY COLUMN `transaction_type` tinyint UNSIGNED NULL DEFAULT NULL,
+  MODIFY COLUMN `counterparty` bigint UNSIGNED NULL DEFAULT NULL,
+  MODIFY COLUMN `account_status` tinyint UNSIGNED NULL DEFAULT NULL;
+
+ALTER TABLE `balance_checkpoints` MODIFY COLUMN `account_id` bigint UNSIGNED NOT NULL;
+
+ALTER TABLE `archived_account_flows` MODIFY COLUMN `account_id` bigint UNSIGNED NOT NULL;
+
+ALTER TABLE `scheduled_transfers`
+  MODIFY COLUMN `from_account` bigint UNSIGNED NOT NULL,
+  MODIFY COLUMN `to_account` bigint UNSIGNED NOT NULL;
+
+-- 第一个区间的下界原为空串，改为 NULL
+ALTER TABLE `interest_accrual_chunks` MODIFY COLUMN `low_account` varchar(20) CHARACTER SET utf8mb4 COLLATE utf8mb4_unicode_ci NULL DEFAULT NULL;
+UPDATE `interest_accrual_chunks` SET `low_account` = NULL WHERE `low_account` = '';
+ALTER TABLE `interest_accrual_chunks`
+  MODIFY COLUMN `low_account` bigint UNSIGNED NULL DEFAULT NULL,
+  MODIFY COLUMN `high_account` bigint UNSIGNED NULL DEFAULT NULL;
+
+-- 账户号改按数值排序：18 位与 19 位账户号的先后与原来的字符串顺序不同。
+-- 未完成的计息区间与对账检查点（应用数据目录下的 reconciliation_checkpoint.json）按旧顺序切分，
+-- 请在计息与对账都已完成时执行，并删除对账检查点文件
+
+-- 核对无误后：DROP TABLE `transactions_varchar`;
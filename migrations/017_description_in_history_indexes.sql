@@ -0,0 +1,24 @@
+/*
+ 交易记录描述筛选走索引
+
+ 描述关键字是 LIKE '%x%'，B 树无法按它定位；分区表又不支持 FULLTEXT。原来只能靠账户前缀缩小范围，
+ 然后对范围内的每一行回表读出 description 再比较，命中率低的关键字几乎要把该账户的流水全部回表一遍。
+ 现在把 description 追加到按时间分页的三条索引末尾：
+ - idx_transactions_account_time   (account_id, transaction_time DESC, transaction_id DESC, description)
+ - idx_transactions_credit_time    (credit_account, transaction_time DESC, transaction_id DESC, description)
+ - idx_transactions_time           (transaction_time DESC, description)，管理员查看全部账户时使用
+ 扫描仍按时间倒序走原来的范围，LIKE 由索引条件下推（EXPLAIN 中为 Using index condition）在索引记录上判断，
+ 只有匹配的行才回表。程序中的条件直接比较 description 列（贷方分录的“转账支出”显示为“转账收入”，
+ 在程序中换算，不再对 CASE 表达式做 LIKE），否则无法下推。
+ 前缀不变，原有查询的执行计划不受影响；代价是每条索引记录多存一份描述（多为十几个字节）。
+ ALGORITHM=INPLACE, LOCK=NONE 在线执行，表较大时重建索引耗时较长，请在低峰时段执行。
+*/
+
+ALTER TABLE `transactions`
+  DROP INDEX `idx_transactions_account_time`,
+  ADD INDEX `idx_transactions_account_time`(`account_id` ASC, `transaction_time` DESC, `transaction_id` DESC, `description` ASC),
+  DROP INDEX `idx_transactions_credit_time`,
+  ADD INDEX `idx_transactions_credit_time`(`credit_account` ASC, `transaction_time` DESC, `transaction_id` DESC, `description` ASC),
+  DROP INDEX `idx_transactions_time`,
+  ADD INDEX `idx_transactions_time`(`transaction_time` DESC, `description` ASC),
+  ALGORITHM = INPLACE, LOCK = NONE;
@@ -0,0 +1,49 @@
+/*
+ 利率与交易限额按账户类型编码配置
+
+ 016 把 accounts.account_type 改为 account_types.type_code 后，interest_rates 与 velocity_limits 仍以
+ varchar(20) utf8mb4 的类型名称为主键：计息加载利率、连接时加载限额都要按名称联结 account_types，
+ 改名或删除类型时两张配置表也不会同步或报错。现在两张表改用 type_code（TINYINT UNSIGNED）并加外键：
+ - interest_rates   主键 (type_code)
+ - velocity_limits  主键 (type_code, operation)
+ 两者都引用 account_types.type_code，账户类型改名只需改字典表，仍被配置引用的类型不能删除。
+ 表只有每种类型几行，在线执行即可；新程序按编码读取，须与本脚本一起上线。
+ 配置中出现而字典中没有的类型先登记到 account_types，不会丢失。
+*/
+
+INSERT IGNORE INTO `account_types` (`type_name`) SELECT `account_type` FROM `interest_rates`;
+INSERT IGNORE INTO `account_types` (`type_name`) SELECT DISTINCT `account_type` FROM `velocity_limits`;
+
+-- ----------------------------
+-- interest_rates
+-- ----------------------------
+ALTER TABLE `interest_rates` ADD COLUMN `type_code` tinyint UNSIGNED NULL FIRST;
+
+UPDATE `interest_rates` r
+JOIN `account_types` t ON t.`type_name` = r.`account_type`
+SET r.`type_code` = t.`type_code`;
+
+ALTER TABLE `interest_rates`
+  DROP PRIMARY KEY,
+  DROP COLUMN `account_type`,
+  MODIFY COLUMN `type_code` tinyint UNSIGNED NOT NULL,
+  ADD PRIMARY KEY (`type_code`),
+  ADD CONSTRAINT `fk_interest_rates_type` FOREIGN KEY (`type_code`) REFERENCES `account_types` (`type_code`)
+    ON DELETE RESTRICT ON UPDATE RESTRICT;
+
+-- ----------------------------
+-- velocity_limits
+-- ----------------------------
+ALTER TABLE `velocity_limits` ADD COLUMN `type_code` tinyint UNSIGNED NULL FIRST;
+
+UPDATE `velocity_limits` v
+JOIN `account_types` t ON t.`type_name` = v.`account_type`
+SET v.`type_code` = t.`type_code`;
+
+ALTER TABLE `velocity_limits`
+  DROP PRIMARY KEY,
+  DROP COLUMN `account_type`,
+  MODIFY COLUMN `type_code` tinyint UNSIGNED NOT NULL,
+  ADD PRIMARY KEY (`type_code`, `operation`),
+  ADD CONSTRAINT `fk_velocity_limits_type` FOREIGN KEY (`type_code`) REFERENCES `account_types` (`type_code`)
+    ON DELETE RESTRICT ON UPDATE RESTRICT;
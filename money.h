@@ -0,0 +1,63 @@
+#ifndef MONEY_H
+#define MONEY_H
+
+#include <QString>
+#include <QVariant>
+#include <QtMath>
+
+// 金额统一使用“分”为单位的定点整数，避免 double 累加误差
+namespace Money {
+
+// 将数据库返回的 DECIMAL 值（字符串或浮点）转换为分
+inline qint64 toCents(const QVariant& value)
+{
+    if (value.userType() == QMetaType::QString || value.userType() == QMetaType::QByteArray) {
+        QString text = value.toString().trimmed();
+        bool negative = text.startsWith('-');
+        if (negative || text.startsWith('+')) {
+            text.remove(0, 1);
+        }
+
+        const int dot = text.indexOf('.');
+        const QString integerPart = dot < 0 ? text : text.left(dot);
+        QString fractionPart = dot < 0 ? QString() : text.mid(dot + 1);
+        fractionPart = (fractionPart + "00").left(2);
+
+        const qint64 cents = integerPart.toLongLong() * 100 + fractionPart.toLongLong();
+        return negative ? -cents : cents;
+    }
+
+    return qRound64(value.toDouble() * 100.0);
+}
+
+inline qint64 toCents(double amount)
+{
+    return qRound64(amount * 100.0);
+}
+
+inline double toYuan(qint64 cents)
+{
+    return static_cast<double>(cents) / 100.0;
+}
+
+// 转换为 DECIMAL 字面量字符串，如 -123.45
+inline QString toDecimalString(qint64 cents)
+{
+    const bool negative = cents < 0;
+    const qint64 absolute = negative ? -cents : cents;
+    return QString("%1%2.%3")
+        .arg(negative ? "-" : "")
+        .arg(absolute / 100)
+        .arg(absolute % 100, 2, 10, QChar('0'));
+}
+
+// 交易类型对本账户余额的方向：存款、收款、利息为入账，取款、转账为出账
+inline int postingSign(const QString& transactionType)
+{
+    return (transactionType == QStringLiteral("存款") || transactionType == QStringLiteral("收款")
+            || transactionType == QStringLiteral("利息")) ? 1 : -1;
+}
+
+} // namespace Money
+
+#endif // MONEY_H
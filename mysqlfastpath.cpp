@@ -0,0 +1,484 @@
+#include "mysqlfastpath.h"
+#include "slowquerylog.h"
+#include "schema.h"
+#include <QSqlDatabase>
+#include <QSqlDriver>
+#include <QVariant>
+#include <QVariantList>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <cstring>
+#include <type_traits>
+
+#ifdef BANKSYSTEM_NATIVE_MYSQL
+#include <mysql.h>
+#endif
+
+MysqlFastPath::MysqlFastPath()
+    : native(nullptr)
+{
+}
+
+MysqlFastPath::~MysqlFastPath()
+{
+    detach();
+}
+
+bool MysqlFastPath::isAttached() const
+{
+    return native != nullptr;
+}
+
+QString MysqlFastPath::lastErrorCode() const
+{
+    return errorCode;
+}
+
+QString MysqlFastPath::lastErrorText() const
+{
+    return errorText;
+}
+
+#ifdef BANKSYSTEM_NATIVE_MYSQL
+
+namespace {
+enum Statement { SelectBalance, LockTransfer, Credit, Debit, InsertPosting, InsertTransfer, StatementCount };
+
+// 与 DatabaseManager 的 QtSql 写法逐条对应；状态 3 为 Schema::Closed，类型 3 为 Schema::Transfer
+const char* const kStatementSql[StatementCount] = {
+    "SELECT a.balance, t.type_name FROM accounts a "
+    "LEFT JOIN account_types t ON t.type_code = a.account_type WHERE a.account_id = ?",
+    "SELECT account_id, balance FROM accounts WHERE account_id IN (?, ?) AND status <> 3 "
+    "ORDER BY account_id FOR UPDATE",
+    "UPDATE accounts SET balance = balance + ? WHERE account_id = ? AND status <> 3",
+    "UPDATE accounts SET balance = balance - ? WHERE account_id = ? AND balance >= ? AND status <> 3",
+    "INSERT INTO transactions (account_id, transaction_type, amount, description) VALUES (?, ?, ?, ?)",
+    "INSERT INTO transactions (account_id, transaction_type, amount, target_account, credit_account, description) "
+    "VALUES (?, 3, ?, ?, ?, '转账支出')",
+};
+static_assert(Schema::Closed == 3 && Schema::Transfer == 3, "kStatementSql 中的编码需与 Schema 一致");
+
+const int kMaxParams = 4;
+
+// 分 -> DECIMAL 文本，如 -123.45；返回长度
+int formatCents(qint64 cents, char* out)
+{
+    char digits[24];
+    quint64 value = cents < 0 ? quint64(0) - quint64(cents) : quint64(cents);
+    int n = 0;
+    do {
+        digits[n++] = char('0' + value % 10);
+        value /= 10;
+    } while (value > 0 || n < 3);
+
+    int length = 0;
+    if (cents < 0) out[length++] = '-';
+    for (int i = n - 1; i >= 2; --i) out[length++] = digits[i];
+    out[length++] = '.';
+    out[length++] = digits[1];
+    out[length++] = digits[0];
+    return length;
+}
+
+// DECIMAL 文本 -> 分；balance 为 DECIMAL(15,2)，多余的小数位不会出现
+bool parseCents(const char* text, unsigned long length, qint64& cents)
+{
+    unsigned long i = 0;
+    bool negative = false;
+    if (i < length && (text[i] == '-' || text[i] == '+')) negative = text[i++] == '-';
+
+    qint64 whole = 0;
+    int fraction = 0;
+    int places = 0;
+    bool digits = false;
+    for (; i < length && text[i] >= '0' && text[i] <= '9'; ++i) {
+        whole = whole * 10 + (text[i] - '0');
+        digits = true;
+    }
+    if (i < length && text[i] == '.') {
+        for (++i; i < length && text[i] >= '0' && text[i] <= '9'; ++i) {
+            if (places < 2) {
+                fraction = fraction * 10 + (text[i] - '0');
+                ++places;
+            }
+            digits = true;
+        }
+    }
+    if (!digits || i != length) return false;
+
+    if (places == 1) fraction *= 10;
+    cents = whole * 100 + fraction;
+    if (negative) cents = -cents;
+    return true;
+}
+}
+
+// MySQL 8 的 is_null 为 bool*，MariaDB 与旧版本为 my_bool*
+using NullFlag = std::remove_pointer<decltype(MYSQL_BIND::is_null)>::type;
+
+struct MysqlFastPath::Native
+{
+    MYSQL* mysql = nullptr;
+    MYSQL_STMT* statements[StatementCount] = {};
+};
+
+// 一个输入参数：文本按 UTF-8，金额按定点十进制文本，账户号与类型编码按 8 字节无符号整数，
+// 缓冲在执行期间保持有效
+struct MysqlFastPath::Param
+{
+    enum Kind { Text, Amount, Integer };
+
+    explicit Param(const QString& value)
+        : text(value.toUtf8())
+        , number(0)
+        , length(static_cast<unsigned long>(text.size()))
+        , kind(Text)
+    {
+    }
+
+    explicit Param(qint64 cents)
+        : number(0)
+        , length(static_cast<unsigned long>(formatCents(cents, decimal)))
+        , kind(Amount)
+    {
+    }
+
+    // 非数字的账户号换算为 0，与 Schema::accountKey() 一致
+    static Param account(const QString& accountId)
+    {
+        bool ok = false;
+        const quint64 key = accountId.toULongLong(&ok);
+        return integer(ok ? key : 0);
+    }
+
+    static Param integer(quint64 value)
+    {
+        Param param{ QString() };
+        param.number = value;
+        param.length = sizeof(param.number);
+        param.kind = Integer;
+        return param;
+    }
+
+    // 慢语句日志只记录参数的类型与长度，与 QtSql 路径的绑定类型一致
+    QVariant value() const
+    {
+        if (kind == Integer) return QVariant(qulonglong(number));
+        return kind == Amount ? QVariant(QByteArray(decimal, int(length)).toDouble()) : QVariant(QString::fromUtf8(text));
+    }
+
+    QByteArray text;
+    char decimal[32];
+    quint64 number;
+    unsigned long length;
+    Kind kind;
+};
+
+bool MysqlFastPath::compiledIn()
+{
+    return true;
+}
+
+bool MysqlFastPath::attach(QSqlDatabase& db)
+{
+    detach();
+
+    // QMYSQL 驱动的句柄类型名为 "MYSQL*"
+    const QVariant handle = db.isOpen() ? db.driver()->handle() : QVariant();
+    if (!handle.isValid() || qstrcmp(handle.typeName(), "MYSQL*") != 0) {
+        qDebug() << "原生快速通道不可用：连接不是 QMYSQL";
+        return false;
+    }
+    MYSQL* mysql = *static_cast<MYSQL* const*>(handle.constData());
+    if (!mysql) return false;
+
+    native = new Native;
+    native->mysql = mysql;
+    for (int id = 0; id < StatementCount; ++id) {
+        MYSQL_STMT* stmt = mysql_stmt_init(mysql);
+        if (!stmt || mysql_stmt_prepare(stmt, kStatementSql[id], static_cast<unsigned long>(std::strlen(kStatementSql[id])))) {
+            errorCode = QString::number(stmt ? mysql_stmt_errno(stmt) : mysql_errno(mysql));
+            errorText = QString::fromUtf8(stmt ? mysql_stmt_error(stmt) : mysql_error(mysql));
+            qDebug() << "原生快速通道预编译失败:" << errorText;
+            if (stmt) mysql_stmt_close(stmt);
+            detach();
+            return false;
+        }
+        native->statements[id] = stmt;
+    }
+    return true;
+}
+
+void MysqlFastPath::detach()
+{
+    if (!native) return;
+
+    for (MYSQL_STMT* stmt : native->statements) {
+        if (stmt) mysql_stmt_close(stmt);
+    }
+    delete native;
+    native = nullptr;
+}
+
+void MysqlFastPath::setError(int statement)
+{
+    MYSQL_STMT* stmt = native->statements[statement];
+    const unsigned int code = mysql_stmt_errno(stmt);
+    errorCode = code ? QString::number(code) : QString();
+    errorText = code ? QString::fromUtf8(mysql_stmt_error(stmt)) : QString("结果解码失败");
+}
+
+bool MysqlFastPath::execute(int statement, Param* params, int count, qint64* rows)
+{
+    MYSQL_STMT* stmt = native->statements[statement];
+    MYSQL_BIND bind[kMaxParams];
+    std::memset(bind, 0, sizeof(bind));
+    for (int i = 0; i < count; ++i) {
+        Param& param = params[i];
+        if (param.kind == Param::Integer) {
+            bind[i].buffer_type = MYSQL_TYPE_LONGLONG;
+            bind[i].buffer = &param.number;
+            bind[i].is_unsigned = true;
+            continue;
+        }
+        bind[i].buffer_type = param.kind == Param::Amount ? MYSQL_TYPE_NEWDECIMAL : MYSQL_TYPE_STRING;
+        bind[i].buffer = param.kind == Param::Amount ? static_cast<void*>(param.decimal)
+                                                     : static_cast<void*>(param.text.data());
+        bind[i].buffer_length = param.length;
+        bind[i].length = &param.length;
+    }
+
+    const bool timed = SlowQueryLog::instance().thresholdMs() > 0;
+    QElapsedTimer timer;
+    if (timed) timer.start();
+
+    // 结果集一次取回客户端，之后在同一句柄上执行的语句不会因结果未读完而失序
+    const bool hasResult = mysql_stmt_field_count(stmt) > 0;
+    const bool ok = !mysql_stmt_bind_param(stmt, bind) && !mysql_stmt_execute(stmt)
+                    && (!hasResult || !mysql_stmt_store_result(stmt));
+    if (!ok) setError(statement);
+
+    qint64 affected = -1;
+    if (ok) affected = hasResult ? qint64(mysql_stmt_num_rows(stmt)) : qint64(mysql_stmt_affected_rows(stmt));
+    if (rows) *rows = affected;
+
+    if (timed) {
+        const qint64 elapsedUs = timer.nsecsElapsed() / 1000;
+        if (elapsedUs >= qint64(SlowQueryLog::instance().thresholdMs()) * 1000) {
+            QVariantList values;
+            for (int i = 0; i < count; ++i) values << params[i].value();
+            SlowQueryLog::report(kStatementSql[statement], values, elapsedUs, int(affected), errorCode);
+        }
+    }
+    return ok;
+}
+
+bool MysqlFastPath::readBalance(const QString& accountId, AccountBalanceRow& row)
+{
+    row = AccountBalanceRow();
+    if (!native) return false;
+
+    errorCode.clear();
+    Param params[] = { Param::account(accountId) };
+    if (!execute(SelectBalance, params, 1)) return false;
+
+    MYSQL_STMT* stmt = native->statements[SelectBalance];
+    char balance[72];
+    unsigned long balanceLength = 0;
+    char type[128];
+    unsigned long typeLength = 0;
+    NullFlag typeNull = 0;
+
+    MYSQL_BIND result[2];
+    std::memset(result, 0, sizeof(result));
+    result[0].buffer_type = MYSQL_TYPE_NEWDECIMAL;
+    result[0].buffer = balance;
+    result[0].buffer_length = sizeof(balance);
+    result[0].length = &balanceLength;
+    result[1].buffer_type = MYSQL_TYPE_STRING;
+    result[1].buffer = type;
+    result[1].buffer_length = sizeof(type);
+    result[1].length = &typeLength;
+    result[1].is_null = &typeNull;
+
+    bool ok = !mysql_stmt_bind_result(stmt, result);
+    const int status = ok ? mysql_stmt_fetch(stmt) : 1;
+    if (status == 0) {
+        ok = parseCents(balance, balanceLength, row.balanceCents);
+        row.found = ok;
+        if (!typeNull) row.accountType = QString::fromUtf8(type, int(typeLength));
+    } else if (status != MYSQL_NO_DATA) {
+        ok = false;
+    }
+    if (!ok) setError(SelectBalance);
+    mysql_stmt_free_result(stmt);
+    return ok;
+}
+
+bool MysqlFastPath::lockTransferAccounts(const QString& fromAccount, const QString& toAccount, TransferLockRow& row)
+{
+    row = TransferLockRow();
+    if (!native) return false;
+
+    errorCode.clear();
+    Param params[] = { Param::account(fromAccount), Param::account(toAccount) };
+    if (!execute(LockTransfer, params, 2)) return false;
+
+    MYSQL_STMT* stmt = native->statements[LockTransfer];
+    quint64 id = 0;
+    char balance[72];
+    unsigned long balanceLength = 0;
+
+    MYSQL_BIND result[2];
+    std::memset(result, 0, sizeof(result));
+    result[0].buffer_type = MYSQL_TYPE_LONGLONG;
+    result[0].buffer = &id;
+    result[0].is_unsigned = true;
+    result[1].buffer_type = MYSQL_TYPE_NEWDECIMAL;
+    result[1].buffer = balance;
+    result[1].buffer_length = sizeof(balance);
+    result[1].length = &balanceLength;
+
+    const quint64 from = params[0].number;
+    bool ok = !mysql_stmt_bind_result(stmt, result);
+    int status = 1;
+    while (ok && (status = mysql_stmt_fetch(stmt)) == 0) {
+        if (id == from) {
+            row.fromFound = true;
+            ok = parseCents(balance, balanceLength, row.fromBalanceCents);
+        } else {
+            row.toFound = true;
+        }
+    }
+    if (ok && status != MYSQL_NO_DATA) ok = false;
+    if (!ok) setError(LockTransfer);
+    mysql_stmt_free_result(stmt);
+    return ok;
+}
+
+int MysqlFastPath::credit(const QString& accountId, qint64 cents)
+{
+    if (!native) return -1;
+    errorCode.clear();
+    Param params[] = { Param(cents), Param::account(accountId) };
+    qint64 rows = -1;
+    return execute(Credit, params, 2, &rows) ? int(rows) : -1;
+}
+
+int MysqlFastPath::debit(const QString& accountId, qint64 cents)
+{
+    if (!native) return -1;
+    errorCode.clear();
+    Param params[] = { Param(cents), Param::account(accountId), Param(cents) };
+    qint64 rows = -1;
+    return execute(Debit, params, 3, &rows) ? int(rows) : -1;
+}
+
+qint64 MysqlFastPath::insertPosting(const QString& accountId, const QString& type, qint64 cents,
+                                    const QString& description)
+{
+    if (!native) return 0;
+    errorCode.clear();
+    Param params[] = { Param::account(accountId), Param::integer(quint64(Schema::transactionType(type))),
+                       Param(cents), Param(description) };
+    if (!execute(InsertPosting, params, 4)) return 0;
+    return qint64(mysql_stmt_insert_id(native->statements[InsertPosting]));
+}
+
+qint64 MysqlFastPath::insertTransfer(const QString& fromAccount, const QString& toAccount, qint64 cents)
+{
+    if (!native) return 0;
+    errorCode.clear();
+    Param params[] = { Param::account(fromAccount), Param(cents), Param::account(toAccount),
+                       Param::account(toAccount) };
+    if (!execute(InsertTransfer, params, 4)) return 0;
+    return qint64(mysql_stmt_insert_id(native->statements[InsertTransfer]));
+}
+
+#else
+
+// 未链接 MySQL 客户端库：attach() 总是失败，调用方走 QtSql
+struct MysqlFastPath::Native
+{
+};
+
+bool MysqlFastPath::compiledIn()
+{
+    return false;
+}
+
+bool MysqlFastPath::attach(QSqlDatabase& db)
+{
+    Q_UNUSED(db);
+    return false;
+}
+
+void MysqlFastPath::detach()
+{
+    delete native;
+    native = nullptr;
+}
+
+void MysqlFastPath::setError(int statement)
+{
+    Q_UNUSED(statement);
+}
+
+bool MysqlFastPath::execute(int statement, Param* params, int count, qint64* rows)
+{
+    Q_UNUSED(statement);
+    Q_UNUSED(params);
+    Q_UNUSED(count);
+    if (rows) *rows = -1;
+    return false;
+}
+
+bool MysqlFastPath::readBalance(const QString& accountId, AccountBalanceRow& row)
+{
+    Q_UNUSED(accountId);
+    row = AccountBalanceRow();
+    return false;
+}
+
+bool MysqlFastPath::lockTransferAccounts(const QString& fromAccount, const QString& toAccount, TransferLockRow& row)
+{
+    Q_UNUSED(fromAccount);
+    Q_UNUSED(toAccount);
+    row = TransferLockRow();
+    return false;
+}
+
+int MysqlFastPath::credit(const QString& accountId, qint64 cents)
+{
+    Q_UNUSED(accountId);
+    Q_UNUSED(cents);
+    return -1;
+}
+
+int MysqlFastPath::debit(const QString& accountId, qint64 cents)
+{
+    Q_UNUSED(accountId);
+    Q_UNUSED(cents);
+    return -1;
+}
+
+qint64 MysqlFastPath::insertPosting(const QString& accountId, const QString& type, qint64 cents,
+                                    const QString& description)
+{
+    Q_UNUSED(accountId);
+    Q_UNUSED(type);
+    Q_UNUSED(cents);
+    Q_UNUSED(description);
+    return 0;
+}
+
+qint64 MysqlFastPath::insertTransfer(const QString& fromAccount, const QString& toAccount, qint64 cents)
+{
+    Q_UNUSED(fromAccount);
+    Q_UNUSED(toAccount);
+    Q_UNUSED(cents);
+    return 0;
+}
+
+#endif
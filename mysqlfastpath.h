@@ -0,0 +1,75 @@
+#ifndef MYSQLFASTPATH_H
+#define MYSQLFASTPATH_H
+
+#include <QString>
+#include <QtGlobal>
+
+class QSqlDatabase;
+
+// 账户余额与类型名称
+struct AccountBalanceRow
+{
+    bool found = false;
+    qint64 balanceCents = 0;
+    QString accountType;
+};
+
+// 转账时锁定的双方账户
+struct TransferLockRow
+{
+    bool fromFound = false;
+    bool toFound = false;
+    qint64 fromBalanceCents = 0;
+};
+
+// 热点语句的原生 MySQL 快速通道
+// 查余额、存款、取款、转账的语句直接使用 MySQL C 客户端的预编译语句（二进制协议）：账户号与类型编码按
+// 8 字节整数、金额按分换算成定点十进制缓冲绑定，结果直接解码到上面的结构体，不经过 QSqlQuery 的占位符改写、
+// QVariant 绑定与逐列转换。语句在 QtSql 主连接的同一个 MYSQL 句柄（QSqlDriver::handle()）上预编译执行，
+// 与其余语句共用事务。需要以 BANKSYSTEM_NATIVE_MYSQL=ON 构建，且链接的客户端库与 QMYSQL 插件所用的一致；
+// 未启用或句柄不可用时 attach() 返回 false，调用方照常走 QtSql。只能在主连接所在线程使用。
+class MysqlFastPath
+{
+public:
+    MysqlFastPath();
+    ~MysqlFastPath();
+
+    // 构建时是否链接了 MySQL 客户端库
+    static bool compiledIn();
+
+    // 在连接的句柄上预编译全部语句；连接重建后重新调用，关闭连接前先 detach()
+    bool attach(QSqlDatabase& db);
+    void detach();
+    bool isAttached() const;
+
+    // 执行失败返回 false，账户不存在时 row.found 为 false
+    bool readBalance(const QString& accountId, AccountBalanceRow& row);
+    // 按账户号顺序 FOR UPDATE 锁定双方未销户的账户行
+    bool lockTransferAccounts(const QString& fromAccount, const QString& toAccount, TransferLockRow& row);
+    // 返回影响行数，失败返回 -1；debit 要求余额充足，两者都跳过已销户账户
+    int credit(const QString& accountId, qint64 cents);
+    int debit(const QString& accountId, qint64 cents);
+    // 返回新交易号，失败返回 0
+    qint64 insertPosting(const QString& accountId, const QString& type, qint64 cents, const QString& description);
+    qint64 insertTransfer(const QString& fromAccount, const QString& toAccount, qint64 cents);
+
+    // 最近一次失败的 MySQL 错误码（如 1213）与说明
+    QString lastErrorCode() const;
+    QString lastErrorText() const;
+
+private:
+    struct Native;
+
+    Native* native;
+    QString errorCode;
+    QString errorText;
+
+    MysqlFastPath(const MysqlFastPath&) = delete;
+    MysqlFastPath& operator=(const MysqlFastPath&) = delete;
+
+    struct Param;
+    bool execute(int statement, Param* params, int count, qint64* rows = nullptr);
+    void setError(int statement);
+};
+
+#endif // MYSQLFASTPATH_H
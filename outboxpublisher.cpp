@@ -0,0 +1,330 @@
+#include "outboxpublisher.h"
+#include "money.h"
+#include "schema.h"
+#include "dberror.h"
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QDateTime>
+#include <QTimer>
+#include <QDebug>
+
+namespace {
+const int kBatchSize = 500;                           // 每次最多读取的事件数
+const qint64 kGapTimeoutMs = 5000;                    // 空洞超过该时间视为回滚，跳过
+const int kListenRetryTicks = 25;                     // 未取得监听权时的重试间隔（轮询次数）
+const int kPurgeIntervalMs = 60 * 60 * 1000;
+const int kRetentionHours = 24;
+}
+
+QByteArray OutboxEvent::toJson() const
+{
+    QJsonObject object;
+    object["id"] = QString::number(eventId);
+    object["event"] = eventType;
+    object["account"] = accountId;
+    if (!username.isEmpty()) object["user"] = username;
+    if (transactionId > 0) object["txn"] = QString::number(transactionId);
+    if (!transactionType.isEmpty()) object["type"] = transactionType;
+    if (amountCents != 0) object["amount"] = QString::number(amountCents);
+    if (!counterparty.isEmpty()) object["counterparty"] = counterparty;
+    if (!description.isEmpty()) object["description"] = description;
+    object["balance"] = QString::number(balanceCents);
+    object["status"] = accountStatus;
+    object["time"] = QString::number(timeMSecs);
+    return QJsonDocument(object).toJson(QJsonDocument::Compact) + '\n';
+}
+
+bool OutboxEvent::fromJson(const QByteArray& line, OutboxEvent& event)
+{
+    const QJsonObject object = QJsonDocument::fromJson(line).object();
+    if (object.isEmpty()) {
+        return false;
+    }
+
+    event.eventId = object["id"].toString().toLongLong();
+    event.eventType = object["event"].toString();
+    event.accountId = object["account"].toString();
+    event.username = object["user"].toString();
+    event.transactionId = object["txn"].toString().toLongLong();
+    event.transactionType = object["type"].toString();
+    event.amountCents = object["amount"].toString().toLongLong();
+    event.counterparty = object["counterparty"].toString();
+    event.description = object["description"].toString();
+    event.balanceCents = object["balance"].toString().toLongLong();
+    event.accountStatus = object["status"].toString();
+    event.timeMSecs = object["time"].toString().toLongLong();
+    return event.eventId > 0 && !event.accountId.isEmpty();
+}
+
+OutboxPublisher::OutboxPublisher(const QString& sourceConnectionName, const QString& serverName,
+                                 QObject* parent)
+    : QObject(parent)
+    , sourceConnection(sourceConnectionName)
+    , workerConnection(sourceConnectionName + "_outbox")
+    , name(serverName)
+    , pollTimer(nullptr)
+    , purgeTimer(nullptr)
+    , server(nullptr)
+    , lastEventId(-1)
+    , gapSinceMSecs(0)
+    , listenRetryTicks(0)
+{
+}
+
+OutboxPublisher::~OutboxPublisher()
+{
+}
+
+void OutboxPublisher::start(int pollIntervalMs)
+{
+    if (!pollTimer) {
+        pollTimer = new QTimer(this);
+        connect(pollTimer, &QTimer::timeout, this, &OutboxPublisher::poll);
+    }
+    if (!purgeTimer) {
+        purgeTimer = new QTimer(this);
+        connect(purgeTimer, &QTimer::timeout, this, [this]() { purgeExpired(kRetentionHours); });
+    }
+
+    listen();
+    pollTimer->start(pollIntervalMs);
+    purgeTimer->start(kPurgeIntervalMs);
+}
+
+void OutboxPublisher::stop()
+{
+    if (pollTimer) pollTimer->stop();
+    if (purgeTimer) purgeTimer->stop();
+
+    // 订阅方套接字归 server 所有，随 server 一起释放
+    for (auto it = subscribers.begin(); it != subscribers.end(); ++it) {
+        it.key()->disconnect(this);
+        it.key()->abort();
+    }
+    subscribers.clear();
+
+    if (server) {
+        server->close();
+        delete server;
+        server = nullptr;
+    }
+
+    if (QSqlDatabase::contains(workerConnection)) {
+        {
+            QSqlDatabase db = QSqlDatabase::database(workerConnection, false);
+            db.close();
+        }
+        QSqlDatabase::removeDatabase(workerConnection);
+    }
+}
+
+bool OutboxPublisher::openWorkerConnection()
+{
+    if (!QSqlDatabase::contains(workerConnection)) {
+        if (!QSqlDatabase::contains(sourceConnection)) {
+            qDebug() << "推送线程：主连接不存在";
+            return false;
+        }
+        QSqlDatabase::cloneDatabase(sourceConnection, workerConnection);
+    }
+
+    QSqlDatabase db = QSqlDatabase::database(workerConnection, false);
+    if (!DbError::ensureOpen(db, connectionProbe)) {
+        qDebug() << "推送线程连接失败:" << db.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+bool OutboxPublisher::listen()
+{
+    if (server && server->isListening()) {
+        return true;
+    }
+
+    if (!server) {
+        server = new QLocalServer(this);
+        connect(server, &QLocalServer::newConnection, this, &OutboxPublisher::onNewConnection);
+    }
+
+    if (!server->listen(name)) {
+        // 名字被占用：能连上说明另一进程正在推送，否则是崩溃残留，清理后重试
+        QLocalSocket probe;
+        probe.connectToServer(name);
+        if (probe.waitForConnected(200)) {
+            probe.abort();
+            return false;
+        }
+        QLocalServer::removeServer(name);
+        if (!server->listen(name)) {
+            qDebug() << "变更推送监听失败:" << server->errorString();
+            return false;
+        }
+    }
+
+    qDebug() << "变更推送已启动:" << name;
+    return true;
+}
+
+bool OutboxPublisher::resetCursor()
+{
+    // 订阅方连接时自行加载当前状态，推送只需从最新事件之后开始
+    if (!openWorkerConnection()) return false;
+
+    QSqlQuery query(QSqlDatabase::database(workerConnection, false));
+    if (!query.exec("SELECT COALESCE(MAX(event_id), 0) FROM outbox_events") || !query.next()) {
+        qDebug() << "读取事件位置失败:" << query.lastError().text();
+        return false;
+    }
+
+    lastEventId = query.value(0).toLongLong();
+    gapSinceMSecs = 0;
+    return true;
+}
+
+void OutboxPublisher::onNewConnection()
+{
+    while (QLocalSocket* socket = server->nextPendingConnection()) {
+        if (subscribers.isEmpty()) {
+            resetCursor();
+        }
+        subscribers.insert(socket, Subscriber());
+
+        connect(socket, &QLocalSocket::readyRead, this, [this, socket]() { onReadyRead(socket); });
+        connect(socket, &QLocalSocket::disconnected, this, [this, socket]() {
+            subscribers.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void OutboxPublisher::onReadyRead(QLocalSocket* socket)
+{
+    auto it = subscribers.find(socket);
+    if (it == subscribers.end()) return;
+
+    it->buffer.append(socket->readAll());
+    int newline;
+    while ((newline = it->buffer.indexOf('\n')) >= 0) {
+        const QByteArray line = it->buffer.left(newline).trimmed();
+        it->buffer.remove(0, newline + 1);
+
+        const QString command = QString::fromUtf8(line);
+        if (command == "SUB *") {
+            it->all = true;
+        } else if (command == "UNSUB *") {
+            it->all = false;
+            it->accounts.clear();
+        } else if (command.startsWith("SUB ")) {
+            it->accounts.insert(command.mid(4));
+        } else if (command.startsWith("UNSUB ")) {
+            it->accounts.remove(command.mid(6));
+        }
+    }
+}
+
+void OutboxPublisher::poll()
+{
+    if (!server || !server->isListening()) {
+        if (++listenRetryTicks < kListenRetryTicks) return;
+        listenRetryTicks = 0;
+        if (!listen()) return;
+    }
+
+    // 没有订阅方时不查询数据库
+    if (subscribers.isEmpty()) {
+        lastEventId = -1;
+        return;
+    }
+    if (lastEventId < 0 && !resetCursor()) return;
+    if (!openWorkerConnection()) return;
+
+    QSqlQuery query(QSqlDatabase::database(workerConnection, false));
+    query.prepare("SELECT o.event_id, o.event_type, o.account_id, o.transaction_id, o.transaction_type, "
+                  "o.amount, o.counterparty, o.description, o.balance_after, o.account_status, "
+                  "o.created_at, u.username "
+                  "FROM outbox_events o "
+                  "LEFT JOIN accounts a ON o.account_id = a.account_id "
+                  "LEFT JOIN users u ON a.user_id = u.user_id "
+                  "WHERE o.event_id > :last_id ORDER BY o.event_id LIMIT " + QString::number(kBatchSize));
+    query.bindValue(":last_id", lastEventId);
+
+    if (!query.exec()) {
+        qDebug() << "读取变更事件失败:" << query.lastError().text();
+        return;
+    }
+
+    int published = 0;
+    while (query.next()) {
+        const qint64 eventId = query.value(0).toLongLong();
+
+        // 自增号按分配顺序而非提交顺序可见：出现空洞时先等待较早的事务提交，
+        // 超时仍未出现的号视为已回滚
+        if (eventId != lastEventId + 1) {
+            const qint64 now = QDateTime::currentMSecsSinceEpoch();
+            if (gapSinceMSecs == 0) gapSinceMSecs = now;
+            if (now - gapSinceMSecs < kGapTimeoutMs) break;
+        }
+        gapSinceMSecs = 0;
+
+        OutboxEvent event;
+        event.eventId = eventId;
+        event.eventType = query.value(1).toString();
+        event.accountId = query.value(2).toString();
+        event.transactionId = query.value(3).toLongLong();
+        event.transactionType = Schema::transactionTypeName(query.value(4).toInt());
+        event.amountCents = Money::toCents(query.value(5));
+        event.counterparty = Schema::accountId(query.value(6));
+        event.description = query.value(7).toString();
+        event.balanceCents = Money::toCents(query.value(8));
+        event.accountStatus = Schema::accountStatusName(query.value(9).toInt());
+        event.timeMSecs = query.value(10).toDateTime().toMSecsSinceEpoch();
+        event.username = query.value(11).toString();
+
+        publish(event);
+        lastEventId = eventId;
+        ++published;
+    }
+
+    if (published > 0) {
+        emit eventsPublished(published);
+    }
+}
+
+void OutboxPublisher::publish(const OutboxEvent& event)
+{
+    QByteArray line;
+    for (auto it = subscribers.begin(); it != subscribers.end(); ++it) {
+        if (!it->all && !it->accounts.contains(event.accountId)) continue;
+        if (line.isEmpty()) line = event.toJson();
+        it.key()->write(line);
+    }
+}
+
+int OutboxPublisher::purgeExpired(int retentionHours)
+{
+    if (!server || !server->isListening() || !openWorkerConnection()) return 0;
+
+    // 分批删除，避免长时间持锁
+    QSqlQuery query(QSqlDatabase::database(workerConnection, false));
+    query.prepare("DELETE FROM outbox_events "
+                  "WHERE created_at < NOW() - INTERVAL :hours HOUR LIMIT 5000");
+    query.bindValue(":hours", retentionHours);
+
+    int purged = 0;
+    while (query.exec() && query.numRowsAffected() > 0) {
+        purged += query.numRowsAffected();
+    }
+
+    if (query.lastError().isValid()) {
+        qDebug() << "清理变更事件失败:" << query.lastError().text();
+    } else if (purged > 0) {
+        qDebug() << "已清理过期变更事件:" << purged;
+    }
+    return purged;
+}
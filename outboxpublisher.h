@@ -0,0 +1,87 @@
+#ifndef OUTBOXPUBLISHER_H
+#define OUTBOXPUBLISHER_H
+
+#include <QObject>
+#include <QString>
+#include <QByteArray>
+#include <QHash>
+#include <QSet>
+#include <QElapsedTimer>
+
+class QTimer;
+class QLocalServer;
+class QLocalSocket;
+
+// 变更事件：与业务数据在同一事务中写入 outbox_events
+struct OutboxEvent
+{
+    qint64 eventId = 0;
+    QString eventType;         // posting：记账；status：账户状态变化
+    QString accountId;
+    QString username;
+    qint64 transactionId = 0;
+    QString transactionType;
+    qint64 amountCents = 0;
+    QString counterparty;
+    QString description;
+    qint64 balanceCents = 0;   // 事件发生后的账户余额
+    QString accountStatus;
+    qint64 timeMSecs = 0;
+
+    // 本地套接字上按行传输的紧凑 JSON
+    QByteArray toJson() const;
+    static bool fromJson(const QByteArray& line, OutboxEvent& event);
+};
+
+// 变更推送：在后台线程中跟踪 outbox_events 新增行，经本地套接字推送给各会话
+// 同一台机器上只有一个进程监听，其余进程的会话作为订阅方连接；监听进程退出后由其他进程接管。
+// 协议（按行）：订阅方发送 "SUB <账户号>" / "SUB *" / "UNSUB <账户号>"，服务端推送事件 JSON。
+class OutboxPublisher : public QObject
+{
+    Q_OBJECT
+
+public:
+    OutboxPublisher(const QString& sourceConnectionName, const QString& serverName,
+                    QObject* parent = nullptr);
+    ~OutboxPublisher();
+
+public slots:
+    // 以下槽函数在推送线程中执行
+    void start(int pollIntervalMs);
+    void stop();
+    void poll();
+    int purgeExpired(int retentionHours);
+
+signals:
+    void eventsPublished(int count);
+
+private:
+    struct Subscriber
+    {
+        QSet<QString> accounts;
+        bool all = false;
+        QByteArray buffer;
+    };
+
+    QString sourceConnection;
+    QString workerConnection;
+    QElapsedTimer connectionProbe;   // 每 200ms 跟踪一次，连接探测按 DbError::kProbeIntervalMs 限频
+    QString name;
+    QTimer* pollTimer;
+    QTimer* purgeTimer;
+    QLocalServer* server;
+    QHash<QLocalSocket*, Subscriber> subscribers;
+
+    qint64 lastEventId;
+    qint64 gapSinceMSecs;   // 发现事件号空洞的时间，0 表示没有空洞
+    int listenRetryTicks;
+
+    bool openWorkerConnection();
+    bool listen();
+    bool resetCursor();
+    void onNewConnection();
+    void onReadyRead(QLocalSocket* socket);
+    void publish(const OutboxEvent& event);
+};
+
+#endif // OUTBOXPUBLISHER_H
@@ -0,0 +1,98 @@
+#include "outboxsubscriber.h"
+#include <QLocalSocket>
+#include <QTimer>
+#include <QDebug>
+
+namespace {
+const int kReconnectIntervalMs = 2000;
+}
+
+OutboxSubscriber::OutboxSubscriber(const QString& serverName, QObject* parent)
+    : QObject(parent)
+    , name(serverName)
+    , socket(new QLocalSocket(this))
+    , reconnectTimer(new QTimer(this))
+    , lastEventId(0)
+{
+    reconnectTimer->setSingleShot(true);
+    reconnectTimer->setInterval(kReconnectIntervalMs);
+    connect(reconnectTimer, &QTimer::timeout, this, &OutboxSubscriber::connectToPublisher);
+
+    connect(socket, &QLocalSocket::connected, this, [this]() {
+        buffer.clear();
+        sendSubscriptions();
+        emit connectionChanged(true);
+    });
+    connect(socket, &QLocalSocket::disconnected, this, [this]() {
+        emit connectionChanged(false);
+        reconnectTimer->start();
+    });
+    connect(socket, &QLocalSocket::errorOccurred, this, [this](QLocalSocket::LocalSocketError) {
+        if (socket->state() == QLocalSocket::UnconnectedState && !reconnectTimer->isActive()) {
+            reconnectTimer->start();
+        }
+    });
+    connect(socket, &QLocalSocket::readyRead, this, &OutboxSubscriber::onReadyRead);
+
+    connectToPublisher();
+}
+
+OutboxSubscriber::~OutboxSubscriber()
+{
+    socket->disconnect(this);
+    socket->abort();
+}
+
+void OutboxSubscriber::setSubscriptions(const QStringList& accountIds)
+{
+    if (isConnected()) {
+        socket->write("UNSUB *\n");
+    }
+    subscriptions = accountIds;
+    sendSubscriptions();
+}
+
+bool OutboxSubscriber::isConnected() const
+{
+    return socket->state() == QLocalSocket::ConnectedState;
+}
+
+void OutboxSubscriber::connectToPublisher()
+{
+    if (socket->state() != QLocalSocket::UnconnectedState) return;
+    socket->connectToServer(name);
+}
+
+void OutboxSubscriber::sendSubscriptions()
+{
+    if (!isConnected()) return;
+
+    QByteArray commands;
+    for (const QString& accountId : subscriptions) {
+        commands += "SUB " + accountId.toUtf8() + '\n';
+    }
+    socket->write(commands);
+}
+
+void OutboxSubscriber::onReadyRead()
+{
+    buffer.append(socket->readAll());
+
+    int newline;
+    while ((newline = buffer.indexOf('\n')) >= 0) {
+        const QByteArray line = buffer.left(newline);
+        buffer.remove(0, newline + 1);
+
+        OutboxEvent event;
+        if (!OutboxEvent::fromJson(line, event)) {
+            qDebug() << "无法解析变更事件:" << line;
+            continue;
+        }
+
+        // 推送方切换时可能重发，按事件号去重
+        if (event.eventId <= lastEventId) continue;
+        lastEventId = event.eventId;
+
+        emit eventReceived(event);
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef OUTBOXSUBSCRIBER_H
+#define OUTBOXSUBSCRIBER_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include "outboxpublisher.h"
+
+class QLocalSocket;
+class QTimer;
+
+// 变更订阅：连接本机的 OutboxPublisher，按账户接收推送事件（界面线程使用）
+// 断线后自动重连；重连成功时发出 connectionChanged(true)，调用方应重新加载一次以补齐断线期间的变化。
+class OutboxSubscriber : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit OutboxSubscriber(const QString& serverName, QObject* parent = nullptr);
+    ~OutboxSubscriber();
+
+    // 替换订阅列表，"*" 表示全部账户
+    void setSubscriptions(const QStringList& accountIds);
+    bool isConnected() const;
+
+signals:
+    void eventReceived(const OutboxEvent& event);
+    void connectionChanged(bool connected);
+
+private:
+    QString name;
+    QLocalSocket* socket;
+    QTimer* reconnectTimer;
+    QStringList subscriptions;
+    QByteArray buffer;
+    qint64 lastEventId;
+
+    void connectToPublisher();
+    void sendSubscriptions();
+    void onReadyRead();
+};
+
+#endif // OUTBOXSUBSCRIBER_H
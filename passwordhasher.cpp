@@ -0,0 +1,232 @@
+#include "passwordhasher.h"
+#include <QPasswordDigestor>
+#include <QCryptographicHash>
+#include <QRandomGenerator>
+#include <QStringList>
+#include <QVector>
+#include <cstring>
+
+namespace {
+
+const char* kScryptPrefix = "$scrypt$";
+const int kSaltLength = 16;
+const int kKeyLength = 32;
+
+inline quint32 rotl(quint32 value, int bits)
+{
+    return (value << bits) | (value >> (32 - bits));
+}
+
+// Salsa20/8 核心（RFC 7914 第 3 节）
+void salsa20_8(quint32 block[16])
+{
+    quint32 x[16];
+    std::memcpy(x, block, sizeof(x));
+
+    for (int i = 0; i < 8; i += 2) {
+        // 列
+        x[ 4] ^= rotl(x[ 0] + x[12],  7);  x[ 8] ^= rotl(x[ 4] + x[ 0],  9);
+        x[12] ^= rotl(x[ 8] + x[ 4], 13);  x[ 0] ^= rotl(x[12] + x[ 8], 18);
+        x[ 9] ^= rotl(x[ 5] + x[ 1],  7);  x[13] ^= rotl(x[ 9] + x[ 5],  9);
+        x[ 1] ^= rotl(x[13] + x[ 9], 13);  x[ 5] ^= rotl(x[ 1] + x[13], 18);
+        x[14] ^= rotl(x[10] + x[ 6],  7);  x[ 2] ^= rotl(x[14] + x[10],  9);
+        x[ 6] ^= rotl(x[ 2] + x[14], 13);  x[10] ^= rotl(x[ 6] + x[ 2], 18);
+        x[ 3] ^= rotl(x[15] + x[11],  7);  x[ 7] ^= rotl(x[ 3] + x[15],  9);
+        x[11] ^= rotl(x[ 7] + x[ 3], 13);  x[15] ^= rotl(x[11] + x[ 7], 18);
+        // 行
+        x[ 1] ^= rotl(x[ 0] + x[ 3],  7);  x[ 2] ^= rotl(x[ 1] + x[ 0],  9);
+        x[ 3] ^= rotl(x[ 2] + x[ 1], 13);  x[ 0] ^= rotl(x[ 3] + x[ 2], 18);
+        x[ 6] ^= rotl(x[ 5] + x[ 4],  7);  x[ 7] ^= rotl(x[ 6] + x[ 5],  9);
+        x[ 4] ^= rotl(x[ 7] + x[ 6], 13);  x[ 5] ^= rotl(x[ 4] + x[ 7], 18);
+        x[11] ^= rotl(x[10] + x[ 9],  7);  x[ 8] ^= rotl(x[11] + x[10],  9);
+        x[ 9] ^= rotl(x[ 8] + x[11], 13);  x[10] ^= rotl(x[ 9] + x[ 8], 18);
+        x[12] ^= rotl(x[15] + x[14],  7);  x[13] ^= rotl(x[12] + x[15],  9);
+        x[14] ^= rotl(x[13] + x[12], 13);  x[15] ^= rotl(x[14] + x[13], 18);
+    }
+
+    for (int i = 0; i < 16; ++i) {
+        block[i] += x[i];
+    }
+}
+
+// scryptBlockMix：in 与 out 均为 2r 个 16 字的块
+void blockMix(const quint32* in, quint32* out, int r)
+{
+    quint32 x[16];
+    std::memcpy(x, in + (2 * r - 1) * 16, sizeof(x));
+
+    for (int i = 0; i < 2 * r; ++i) {
+        for (int k = 0; k < 16; ++k) {
+            x[k] ^= in[i * 16 + k];
+        }
+        salsa20_8(x);
+        // 偶数块放前半部分，奇数块放后半部分
+        const int target = (i / 2) + (i % 2) * r;
+        std::memcpy(out + target * 16, x, sizeof(x));
+    }
+}
+
+// scryptROMix：对 128 * r 字节的块就地运算，V 占用 N 倍块大小
+void roMix(quint8* block, int r, quint64 n)
+{
+    const int words = 32 * r;
+    QVector<quint32> x(words);
+    QVector<quint32> y(words);
+    QVector<quint32> v(static_cast<int>(n) * words);
+
+    for (int k = 0; k < words; ++k) {
+        const quint8* p = block + k * 4;
+        x[k] = quint32(p[0]) | (quint32(p[1]) << 8) | (quint32(p[2]) << 16) | (quint32(p[3]) << 24);
+    }
+
+    for (quint64 i = 0; i < n; ++i) {
+        std::memcpy(v.data() + i * words, x.constData(), words * sizeof(quint32));
+        blockMix(x.constData(), y.data(), r);
+        x.swap(y);
+    }
+
+    for (quint64 i = 0; i < n; ++i) {
+        const quint64 j = x[(2 * r - 1) * 16] & (n - 1);
+        const quint32* vj = v.constData() + j * words;
+        for (int k = 0; k < words; ++k) {
+            x[k] ^= vj[k];
+        }
+        blockMix(x.constData(), y.data(), r);
+        x.swap(y);
+    }
+
+    for (int k = 0; k < words; ++k) {
+        quint8* p = block + k * 4;
+        p[0] = quint8(x[k]);
+        p[1] = quint8(x[k] >> 8);
+        p[2] = quint8(x[k] >> 16);
+        p[3] = quint8(x[k] >> 24);
+    }
+}
+
+QString encodeParameters(const PasswordHasher::Parameters& parameters)
+{
+    return QString("ln=%1,r=%2,p=%3").arg(parameters.logN).arg(parameters.r).arg(parameters.p);
+}
+
+} // namespace
+
+PasswordHasher::Parameters PasswordHasher::defaultParameters()
+{
+    return Parameters();
+}
+
+QByteArray PasswordHasher::scrypt(const QByteArray& password, const QByteArray& salt,
+                                  int logN, int r, int p, int keyLength)
+{
+    if (logN < 1 || logN > 20 || r < 1 || r > 32 || p < 1 || p > 16 || keyLength < 1) {
+        return QByteArray();
+    }
+
+    const quint64 n = quint64(1) << logN;
+    const int blockSize = 128 * r;
+    if (quint64(blockSize) * n > (quint64(1) << 30)) {
+        return QByteArray();
+    }
+
+    QByteArray b = QPasswordDigestor::deriveKeyPbkdf2(QCryptographicHash::Sha256,
+                                                      password, salt, 1, quint64(blockSize) * p);
+    if (b.size() != blockSize * p) {
+        return QByteArray();
+    }
+
+    for (int i = 0; i < p; ++i) {
+        roMix(reinterpret_cast<quint8*>(b.data()) + i * blockSize, r, n);
+    }
+
+    return QPasswordDigestor::deriveKeyPbkdf2(QCryptographicHash::Sha256,
+                                              password, b, 1, keyLength);
+}
+
+QString PasswordHasher::hash(const QString& password, const Parameters& parameters)
+{
+    QByteArray salt(kSaltLength, Qt::Uninitialized);
+    QRandomGenerator::system()->fillRange(reinterpret_cast<quint32*>(salt.data()),
+                                          kSaltLength / int(sizeof(quint32)));
+
+    const QByteArray digest = scrypt(password.toUtf8(), salt,
+                                     parameters.logN, parameters.r, parameters.p, kKeyLength);
+    if (digest.isEmpty()) {
+        return QString();
+    }
+
+    return QString(kScryptPrefix) + encodeParameters(parameters)
+           + '$' + QString::fromLatin1(salt.toBase64(QByteArray::OmitTrailingEquals))
+           + '$' + QString::fromLatin1(digest.toBase64(QByteArray::OmitTrailingEquals));
+}
+
+bool PasswordHasher::verify(const QString& password, const QString& stored)
+{
+    if (!isHashed(stored)) {
+        // 旧版明文密码，登录成功后由调用方升级为散列
+        return !stored.isEmpty() && constantTimeEquals(password.toUtf8(), stored.toUtf8());
+    }
+
+    Parameters parameters;
+    QByteArray salt;
+    QByteArray digest;
+    if (!parse(stored, parameters, salt, digest)) {
+        return false;
+    }
+
+    const QByteArray computed = scrypt(password.toUtf8(), salt,
+                                       parameters.logN, parameters.r, parameters.p, digest.size());
+    return !computed.isEmpty() && constantTimeEquals(computed, digest);
+}
+
+bool PasswordHasher::needsRehash(const QString& stored)
+{
+    Parameters parameters;
+    QByteArray salt;
+    QByteArray digest;
+    if (!isHashed(stored) || !parse(stored, parameters, salt, digest)) {
+        return true;
+    }
+
+    const Parameters current = defaultParameters();
+    return parameters.logN < current.logN || parameters.r < current.r || parameters.p < current.p;
+}
+
+bool PasswordHasher::isHashed(const QString& stored)
+{
+    return stored.startsWith(QLatin1String(kScryptPrefix));
+}
+
+bool PasswordHasher::parse(const QString& stored, Parameters& parameters,
+                           QByteArray& salt, QByteArray& digest)
+{
+    // "", "scrypt", "ln=..,r=..,p=..", salt, digest
+    const QStringList parts = stored.split('$');
+    if (parts.size() != 5 || parts[1] != "scrypt") {
+        return false;
+    }
+
+    bool okN = false, okR = false, okP = false;
+    for (const QString& field : parts[2].split(',')) {
+        if (field.startsWith("ln=")) parameters.logN = field.mid(3).toInt(&okN);
+        else if (field.startsWith("r=")) parameters.r = field.mid(2).toInt(&okR);
+        else if (field.startsWith("p=")) parameters.p = field.mid(2).toInt(&okP);
+    }
+    if (!okN || !okR || !okP) {
+        return false;
+    }
+
+    salt = QByteArray::fromBase64(parts[3].toLatin1());
+    digest = QByteArray::fromBase64(parts[4].toLatin1());
+    return !salt.isEmpty() && !digest.isEmpty();
+}
+
+bool PasswordHasher::constantTimeEquals(const QByteArray& a, const QByteArray& b)
+{
+    // 长度不同也比较完整个 a，避免通过耗时推断前缀
+    quint8 diff = quint8(a.size() != b.size());
+    for (int i = 0; i < a.size(); ++i) {
+        diff |= quint8(a[i]) ^ quint8(b.isEmpty() ? 0 : b[i % b.size()]);
+    }
+    return diff == 0;
+}
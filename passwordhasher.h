@@ -0,0 +1,40 @@
+#ifndef PASSWORDHASHER_H
+#define PASSWORDHASHER_H
+
+#include <QString>
+#include <QByteArray>
+
+// 口令散列：scrypt（内存困难型 KDF，RFC 7914）+ 随机盐
+// 存储格式：$scrypt$ln=14,r=8,p=1$<盐 base64>$<散列 base64>
+// 每次计算约占用 128 * r * 2^ln 字节内存，默认 16 MiB，应在工作线程池中执行。
+class PasswordHasher
+{
+public:
+    struct Parameters
+    {
+        int logN = 14;
+        int r = 8;
+        int p = 1;
+    };
+
+    static Parameters defaultParameters();
+
+    static QString hash(const QString& password, const Parameters& parameters = defaultParameters());
+
+    // 校验口令；兼容旧版明文存储的密码（常量时间比较）
+    static bool verify(const QString& password, const QString& stored);
+
+    // 旧明文或参数低于当前默认值时需要在登录成功后重新散列
+    static bool needsRehash(const QString& stored);
+    static bool isHashed(const QString& stored);
+
+    static QByteArray scrypt(const QByteArray& password, const QByteArray& salt,
+                             int logN, int r, int p, int keyLength);
+
+private:
+    static bool parse(const QString& stored, Parameters& parameters,
+                      QByteArray& salt, QByteArray& digest);
+    static bool constantTimeEquals(const QByteArray& a, const QByteArray& b);
+};
+
+#endif // PASSWORDHASHER_H
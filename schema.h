@@ -0,0 +1,125 @@
+#ifndef SCHEMA_H
+#define SCHEMA_H
+
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+
+// 紧凑存储的列编码
+// 账户号全为数字（18~19 位，小于 2^64），accounts 主键与各表引用账户号的列都以 BIGINT UNSIGNED 存储：
+// 8 字节定长、按整数比较，取代 varchar(20) + utf8mb4_unicode_ci 的排序规则比较。账户号本身即为内部键，
+// 无需另设代理键，也就不必在每次请求时先查一次号码到键的映射。
+// 交易类型与账户状态以 TINYINT UNSIGNED 编码（对照表 transaction_types / account_statuses），
+// 账户类型以 account_types.type_code 引用（读取时联结 account_types 取名称）。程序接口仍使用账户号字符串与中文名称：
+// - 绑定参数：accountKey() 把账户号换算为整数，transactionType() / accountStatus() 把名称换算为编码；
+//   账户号列与字符串比较会按浮点数进行，19 位账户号失去精度且用不上索引，所以必须换算后再绑定
+// - 读取：整数列 toString() 即为账户号；类型与状态在 SQL 中用 transactionTypeSql() / accountStatusSql()
+//   （ELT 表达式）还原为名称，不需要联结对照表
+namespace Schema {
+
+enum TransactionType { Deposit = 1, Withdraw = 2, Transfer = 3, Credit = 4, Interest = 5 };
+enum AccountStatus { Active = 1, Frozen = 2, Closed = 3 };
+
+// 编码减一即下标，与 migrations/016 中对照表的内容一致
+inline const QStringList& transactionTypeNames()
+{
+    static const QStringList names = { "存款", "取款", "转账", "收款", "利息" };
+    return names;
+}
+
+inline const QStringList& accountStatusNames()
+{
+    static const QStringList names = { "正常", "冻结", "已销户" };
+    return names;
+}
+
+// 非数字或超出范围的账户号换算为 0（不对应任何账户），空串为 NULL
+inline QVariant accountKey(const QString& accountId)
+{
+    if (accountId.isEmpty()) return QVariant();
+    bool ok = false;
+    const qulonglong key = accountId.toULongLong(&ok);
+    return QVariant(ok ? key : qulonglong(0));
+}
+
+// 读取账户号列：NULL 为空串（整数列的 NULL 直接 toString() 会得到 "0"）
+inline QString accountId(const QVariant& value)
+{
+    return value.isNull() ? QString() : value.toString();
+}
+
+// 未知名称为 0
+inline int transactionType(const QString& name)
+{
+    return transactionTypeNames().indexOf(name) + 1;
+}
+
+inline QString transactionTypeName(int code)
+{
+    return transactionTypeNames().value(code - 1);
+}
+
+inline int accountStatus(const QString& name)
+{
+    return accountStatusNames().indexOf(name) + 1;
+}
+
+inline QString accountStatusName(int code)
+{
+    return accountStatusNames().value(code - 1);
+}
+
+namespace Detail {
+inline QString eltSql(const QString& column, const QStringList& names)
+{
+    return QString("ELT(%1, '%2')").arg(column, names.join("', '"));
+}
+}
+
+// 编码列还原为名称的 SQL 表达式
+inline QString transactionTypeSql(const QString& column)
+{
+    return Detail::eltSql(column, transactionTypeNames());
+}
+
+inline QString accountStatusSql(const QString& column)
+{
+    return Detail::eltSql(column, accountStatusNames());
+}
+
+// 账户类型名称换算为编码的子查询，name 为占位符
+inline QString accountTypeCodeSql(const QString& name)
+{
+    return QString("(SELECT type_code FROM account_types WHERE type_name = %1)").arg(name);
+}
+
+// 账户号前缀匹配：账户号为整数，前缀 LIKE 用不上主键，改为 18、19 位两个整数区间。
+// 返回条件表达式，占位符为 <placeholder>_lo<i> / <placeholder>_hi<i>，值由 accountPrefixBounds() 给出
+inline QString accountPrefixSql(const QString& column, const QString& placeholder, int ranges)
+{
+    QStringList parts;
+    for (int i = 0; i < ranges; ++i) {
+        parts << QString("%1 BETWEEN %2_lo%3 AND %2_hi%3").arg(column, placeholder).arg(i);
+    }
+    return parts.isEmpty() ? QString("FALSE") : "(" + parts.join(" OR ") + ")";
+}
+
+// 前缀的各区间 [lo, hi]，每个区间两项依次排列；前缀不是数字或超过 19 位时为空
+inline QVariantList accountPrefixBounds(const QString& prefix)
+{
+    QVariantList bounds;
+    bool ok = false;
+    const qulonglong value = prefix.toULongLong(&ok);
+    if (!ok || prefix.size() > 19) return bounds;
+
+    for (int digits = qMax(18, prefix.size()); digits <= 19; ++digits) {
+        qulonglong scale = 1;
+        for (int i = prefix.size(); i < digits; ++i) scale *= 10;
+        bounds << QVariant(value * scale) << QVariant(value * scale + (scale - 1));
+    }
+    return bounds;
+}
+
+} // namespace Schema
+
+#endif // SCHEMA_H
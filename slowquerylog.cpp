@@ -0,0 +1,378 @@
+#include "slowquerylog.h"
+#include "dberror.h"
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QSqlError>
+#include <QThread>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QCryptographicHash>
+#include <QRegularExpression>
+#include <QStandardPaths>
+#include <QSettings>
+#include <QMutexLocker>
+#include <QDebug>
+
+namespace {
+const int kDefaultThresholdMs = 200;
+const int kRotatedFiles = 3;               // 保留 slow.log.1 ~ slow.log.3
+const int kMaxQueuedEntries = 1000;        // 日志线程跟不上时丢弃新记录，不阻塞调用方
+const char* const kLogFileName = "slow.log";
+
+// 只记录参数的类型与长度，不记录值（可能是身份证号、口令散列等）
+QString parameterShape(const QVariant& value)
+{
+    if (!value.isValid() || value.isNull()) return "NULL";
+    switch (value.userType()) {
+    case QMetaType::QString:
+        return QString("QString(%1)").arg(value.toString().size());
+    case QMetaType::QByteArray:
+        return QString("QByteArray(%1)").arg(value.toByteArray().size());
+    default:
+        return QString::fromLatin1(value.typeName());
+    }
+}
+
+bool explainable(const QString& sql)
+{
+    static const QRegularExpression pattern("^\\s*(SELECT|INSERT|UPDATE|DELETE|REPLACE|WITH)\\b",
+                                            QRegularExpression::CaseInsensitiveOption);
+    return pattern.match(sql).hasMatch();
+}
+}
+
+SlowQueryLog& SlowQueryLog::instance()
+{
+    static SlowQueryLog instance;
+    return instance;
+}
+
+SlowQueryLog::SlowQueryLog()
+    : threshold(QSettings().value("slowLog/thresholdMs", kDefaultThresholdMs).toInt())
+    , thread(nullptr)
+    , stopping(false)
+    , directory(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/slowlog")
+    , maxFileBytes(1024 * 1024)
+    , explainIntervalMs(10 * 60 * 1000)
+{
+}
+
+SlowQueryLog::~SlowQueryLog()
+{
+    stop();
+}
+
+bool SlowQueryLog::exec(QSqlQuery& query)
+{
+    SlowQueryLog& log = instance();
+    const int limitMs = log.threshold.loadRelaxed();
+    if (limitMs <= 0) return query.exec();
+
+    QElapsedTimer timer;
+    timer.start();
+    const bool ok = query.exec();
+    const qint64 elapsedUs = timer.nsecsElapsed() / 1000;
+    if (elapsedUs >= qint64(limitMs) * 1000) log.record(query, elapsedUs);
+    return ok;
+}
+
+bool SlowQueryLog::exec(QSqlQuery& query, const QString& sql)
+{
+    SlowQueryLog& log = instance();
+    const int limitMs = log.threshold.loadRelaxed();
+    if (limitMs <= 0) return query.exec(sql);
+
+    QElapsedTimer timer;
+    timer.start();
+    const bool ok = query.exec(sql);
+    const qint64 elapsedUs = timer.nsecsElapsed() / 1000;
+    if (elapsedUs >= qint64(limitMs) * 1000) log.record(query, elapsedUs);
+    return ok;
+}
+
+void SlowQueryLog::setThresholdMs(int milliseconds)
+{
+    threshold.storeRelaxed(qMax(0, milliseconds));
+}
+
+int SlowQueryLog::thresholdMs() const
+{
+    return threshold.loadRelaxed();
+}
+
+void SlowQueryLog::setExplainIntervalSecs(int seconds)
+{
+    QMutexLocker locker(&mutex);
+    explainIntervalMs = qMax(0, seconds) * 1000;
+}
+
+void SlowQueryLog::setExplainSource(const QString& connectionName)
+{
+    QMutexLocker locker(&mutex);
+    explainSource = connectionName;
+}
+
+void SlowQueryLog::setLogDirectory(const QString& path)
+{
+    QMutexLocker locker(&mutex);
+    directory = path;
+}
+
+QString SlowQueryLog::logFilePath() const
+{
+    QMutexLocker locker(&mutex);
+    return QDir(directory).filePath(kLogFileName);
+}
+
+void SlowQueryLog::setMaxFileBytes(qint64 bytes)
+{
+    QMutexLocker locker(&mutex);
+    maxFileBytes = qMax<qint64>(64 * 1024, bytes);
+}
+
+QString SlowQueryLog::sqlId(const QString& sql)
+{
+    // IN 列表长度与内联的数字（LIMIT、分页大小）不同的语句视为同一条
+    static const QRegularExpression inList("\\bIN\\s*\\([^()]*\\)", QRegularExpression::CaseInsensitiveOption);
+    static const QRegularExpression number("\\b\\d+\\b");
+
+    QString normalized = sql.simplified();
+    normalized.replace(inList, "IN (...)");
+    normalized.replace(number, "N");
+    return QCryptographicHash::hash(normalized.toUtf8(), QCryptographicHash::Sha1).toHex().left(16);
+}
+
+void SlowQueryLog::report(const QString& sql, const QVariantList& values, qint64 elapsedUs, int rows,
+                          const QString& errorCode)
+{
+    SlowQueryLog& log = instance();
+    const int limitMs = log.threshold.loadRelaxed();
+    if (limitMs <= 0 || elapsedUs < qint64(limitMs) * 1000) return;
+
+    Pending pending;
+    Entry& entry = pending.entry;
+    entry.loggedAt = QDateTime::currentDateTime();
+    entry.sql = sql.simplified();
+    entry.sqlId = sqlId(entry.sql);
+    entry.elapsedUs = elapsedUs;
+    entry.error = errorCode;
+    entry.rows = errorCode.isEmpty() ? rows : -1;
+    for (const QVariant& value : values) entry.parameterShapes << parameterShape(value);
+    pending.values = values;
+    log.enqueue(pending);
+}
+
+void SlowQueryLog::record(const QSqlQuery& query, qint64 elapsedUs)
+{
+    Pending pending;
+    Entry& entry = pending.entry;
+    entry.loggedAt = QDateTime::currentDateTime();
+    entry.sql = query.lastQuery().simplified();
+    entry.sqlId = sqlId(entry.sql);
+    entry.elapsedUs = elapsedUs;
+    if (query.lastError().type() != QSqlError::NoError) {
+        entry.error = query.lastError().nativeErrorCode();
+    } else {
+        entry.rows = query.isSelect() ? query.size() : query.numRowsAffected();
+    }
+
+    const int count = query.boundValues().size();
+    for (int i = 0; i < count; ++i) {
+        const QVariant value = query.boundValue(i);
+        entry.parameterShapes << parameterShape(value);
+        pending.values << value;
+    }
+    enqueue(pending);
+}
+
+void SlowQueryLog::enqueue(Pending& pending)
+{
+    const Entry& entry = pending.entry;
+
+    QMutexLocker locker(&mutex);
+    if (queue.size() >= kMaxQueuedEntries) return;
+
+    // 每个 SQL ID 按间隔采样一次执行计划
+    if (!explainSource.isEmpty() && explainable(entry.sql)) {
+        QElapsedTimer& last = lastExplained[entry.sqlId];
+        if (!last.isValid() || last.elapsed() >= explainIntervalMs) {
+            pending.explain = true;
+            last.start();
+        }
+    }
+    queue.enqueue(pending);
+
+    if (!thread) {
+        stopping = false;
+        thread = QThread::create([this]() { run(); });
+        thread->setObjectName("slowlog");
+        thread->start();
+    }
+    wake.wakeOne();
+}
+
+void SlowQueryLog::stop()
+{
+    QThread* worker = nullptr;
+    {
+        QMutexLocker locker(&mutex);
+        if (!thread) return;
+        stopping = true;
+        worker = thread;
+        wake.wakeAll();
+    }
+
+    worker->wait();
+    delete worker;
+
+    QMutexLocker locker(&mutex);
+    thread = nullptr;
+    stopping = false;
+}
+
+void SlowQueryLog::run()
+{
+    QString connectionName;
+
+    QMutexLocker locker(&mutex);
+    for (;;) {
+        while (!stopping && queue.isEmpty()) wake.wait(&mutex);
+        if (queue.isEmpty()) break;   // 停止且已写完
+
+        Pending pending = queue.dequeue();
+        const QString source = explainSource;
+        const QString path = QDir(directory).filePath(kLogFileName);
+        const qint64 limit = maxFileBytes;
+        locker.unlock();
+
+        if (pending.explain) {
+            if (connectionName.isEmpty() && QSqlDatabase::contains(source)) {
+                connectionName = source + "_slowlog";
+                QSqlDatabase::cloneDatabase(source, connectionName);
+            }
+            if (!connectionName.isEmpty()) {
+                QSqlDatabase db = QSqlDatabase::database(connectionName, false);
+                if (DbError::ensureOpen(db)) {
+                    pending.entry.plan = explain(db, pending);
+                } else {
+                    qDebug() << "慢语句日志连接失败:" << db.lastError().text();
+                }
+            }
+        }
+        append(pending.entry, path, limit);
+
+        locker.relock();
+    }
+    locker.unlock();
+
+    if (!connectionName.isEmpty()) {
+        {
+            QSqlDatabase db = QSqlDatabase::database(connectionName, false);
+            db.close();
+        }
+        QSqlDatabase::removeDatabase(connectionName);
+    }
+}
+
+QString SlowQueryLog::explain(QSqlDatabase& db, const Pending& pending)
+{
+    // 用原参数重新绑定，执行计划与慢执行时的取值一致
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    if (!query.prepare("EXPLAIN " + pending.entry.sql)) {
+        return "EXPLAIN 失败: " + query.lastError().text();
+    }
+    for (int i = 0; i < pending.values.size(); ++i) {
+        query.bindValue(i, pending.values.at(i));
+    }
+    if (!query.exec()) {
+        return "EXPLAIN 失败: " + query.lastError().text();
+    }
+
+    static const char* const columns[] = { "table", "partitions", "type", "key", "rows", "filtered", "Extra" };
+    QStringList lines;
+    while (query.next()) {
+        const QSqlRecord record = query.record();
+        QStringList fields;
+        for (const char* column : columns) {
+            const int index = record.indexOf(column);
+            if (index < 0 || query.isNull(index)) continue;
+            fields << QString("%1=%2").arg(column, query.value(index).toString());
+        }
+        lines << fields.join(' ');
+    }
+    return lines.join('\n');
+}
+
+void SlowQueryLog::append(const Entry& entry, const QString& path, qint64 limit)
+{
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    if (QFileInfo(path).size() >= limit) rotate(path);
+
+    QFile file(path);
+    if (!file.open(QIODevice::Append)) {
+        qDebug() << "写入慢语句日志失败:" << path << file.errorString();
+        return;
+    }
+
+    QJsonObject object;
+    object["time"] = entry.loggedAt.toString(Qt::ISODateWithMs);
+    object["sql_id"] = entry.sqlId;
+    object["elapsed_us"] = entry.elapsedUs;
+    object["rows"] = entry.rows;
+    object["params"] = QJsonArray::fromStringList(entry.parameterShapes);
+    object["sql"] = entry.sql;
+    if (!entry.error.isEmpty()) object["error"] = entry.error;
+    if (!entry.plan.isEmpty()) object["plan"] = entry.plan;
+    file.write(QJsonDocument(object).toJson(QJsonDocument::Compact) + '\n');
+}
+
+void SlowQueryLog::rotate(const QString& path)
+{
+    QFile::remove(QString("%1.%2").arg(path).arg(kRotatedFiles));
+    for (int i = kRotatedFiles - 1; i >= 1; --i) {
+        QFile::rename(QString("%1.%2").arg(path).arg(i), QString("%1.%2").arg(path).arg(i + 1));
+    }
+    QFile::rename(path, path + ".1");
+}
+
+QList<SlowQueryLog::Entry> SlowQueryLog::recentEntries(int limit) const
+{
+    const QString path = logFilePath();
+    QStringList files = { path };
+    for (int i = 1; i <= kRotatedFiles; ++i) files << QString("%1.%2").arg(path).arg(i);
+
+    QList<Entry> entries;
+    for (const QString& filePath : files) {
+        if (entries.size() >= limit) break;
+
+        QFile file(filePath);
+        if (!file.open(QIODevice::ReadOnly)) continue;
+        const QList<QByteArray> lines = file.readAll().split('\n');
+
+        // 文件内越靠后越新
+        for (int i = lines.size() - 1; i >= 0 && entries.size() < limit; --i) {
+            const QJsonObject object = QJsonDocument::fromJson(lines.at(i)).object();
+            if (object.isEmpty()) continue;
+
+            Entry entry;
+            entry.loggedAt = QDateTime::fromString(object["time"].toString(), Qt::ISODateWithMs);
+            entry.sqlId = object["sql_id"].toString();
+            entry.elapsedUs = qint64(object["elapsed_us"].toDouble());
+            entry.rows = object["rows"].toInt(-1);
+            for (const QJsonValue& shape : object["params"].toArray()) {
+                entry.parameterShapes << shape.toString();
+            }
+            entry.sql = object["sql"].toString();
+            entry.error = object["error"].toString();
+            entry.plan = object["plan"].toString();
+            entries.append(entry);
+        }
+    }
+    return entries;
+}
@@ -0,0 +1,102 @@
+#ifndef SLOWQUERYLOG_H
+#define SLOWQUERYLOG_H
+
+#include <QString>
+#include <QStringList>
+#include <QDateTime>
+#include <QVariantList>
+#include <QHash>
+#include <QQueue>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QElapsedTimer>
+#include <QAtomicInt>
+
+class QSqlQuery;
+class QSqlDatabase;
+class QThread;
+
+// 慢语句日志
+// DatabaseManager 的语句都经 SlowQueryLog::exec 执行并计时，超过阈值的记录 SQL ID（归一化语句的摘要）、
+// 参数的类型与长度（不记录参数值）、行数与耗时；同一 SQL ID 隔一段时间采样一次 EXPLAIN。
+// EXPLAIN 与写文件在日志线程中进行，使用单独克隆的连接，不占用调用方的连接和事务。
+// 日志按 JSON 行写入，超过大小上限时滚动，保留最近几个文件。
+class SlowQueryLog
+{
+public:
+    struct Entry
+    {
+        QDateTime loggedAt;
+        QString sqlId;
+        QString sql;
+        QStringList parameterShapes;   // 如 QString(19)、double、NULL
+        qint64 elapsedUs = 0;
+        int rows = -1;                 // 查询返回行数或写入影响行数，未知为 -1
+        QString error;                 // 执行失败时的 MySQL 错误码，如锁等待超时 1205
+        QString plan;                  // EXPLAIN 结果，未采样时为空
+    };
+
+    static SlowQueryLog& instance();
+
+    // 执行并计时，与 query.exec() / query.exec(sql) 相同
+    static bool exec(QSqlQuery& query);
+    static bool exec(QSqlQuery& query, const QString& sql);
+    // 不经 QSqlQuery 执行的语句（如 MysqlFastPath）执行后上报，未超过阈值时直接返回；rows 未知时为 -1
+    static void report(const QString& sql, const QVariantList& values, qint64 elapsedUs, int rows,
+                       const QString& errorCode = QString());
+
+    // 阈值为 0 时不记录；默认取 QSettings 中的 slowLog/thresholdMs（200 ms）
+    void setThresholdMs(int milliseconds);
+    int thresholdMs() const;
+    // 同一 SQL ID 两次 EXPLAIN 的最短间隔
+    void setExplainIntervalSecs(int seconds);
+    // EXPLAIN 使用从该连接克隆的连接，为空时不采集执行计划
+    void setExplainSource(const QString& connectionName);
+    void setLogDirectory(const QString& path);
+    QString logFilePath() const;
+    void setMaxFileBytes(qint64 bytes);
+
+    // 最近的记录，最新的在前；依次读取当前文件与滚动出的旧文件
+    QList<Entry> recentEntries(int limit) const;
+
+    // 写完已排队的记录后停止日志线程并关闭 EXPLAIN 连接，之后有新记录时重新启动
+    void stop();
+
+    // 语句文本归一化（数字、IN 列表折叠）后的摘要
+    static QString sqlId(const QString& sql);
+
+private:
+    SlowQueryLog();
+    ~SlowQueryLog();
+
+    SlowQueryLog(const SlowQueryLog&) = delete;
+    SlowQueryLog& operator=(const SlowQueryLog&) = delete;
+
+    struct Pending
+    {
+        Entry entry;
+        QVariantList values;   // 只用于 EXPLAIN，不写入日志
+        bool explain = false;
+    };
+
+    QAtomicInt threshold;
+    mutable QMutex mutex;
+    QWaitCondition wake;
+    QQueue<Pending> queue;
+    QThread* thread;
+    bool stopping;
+    QString explainSource;
+    QString directory;
+    qint64 maxFileBytes;
+    int explainIntervalMs;
+    QHash<QString, QElapsedTimer> lastExplained;
+
+    void record(const QSqlQuery& query, qint64 elapsedUs);
+    void enqueue(Pending& pending);
+    void run();
+    static QString explain(QSqlDatabase& db, const Pending& pending);
+    void append(const Entry& entry, const QString& path, qint64 limit);
+    static void rotate(const QString& path);
+};
+
+#endif // SLOWQUERYLOG_H
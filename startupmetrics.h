@@ -0,0 +1,63 @@
+#ifndef STARTUPMETRICS_H
+#define STARTUPMETRICS_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QPair>
+#include <QElapsedTimer>
+#include <QDebug>
+
+// 启动耗时打点：进程启动时 start()，各里程碑第一次到达时 mark()，均在主线程调用
+namespace StartupMetrics {
+
+inline QElapsedTimer& clock()
+{
+    static QElapsedTimer timer;
+    return timer;
+}
+
+inline QList<QPair<QString, qint64>>& marks()
+{
+    static QList<QPair<QString, qint64>> recorded;
+    return recorded;
+}
+
+inline void start()
+{
+    clock().start();
+}
+
+// 距启动的毫秒数，未记录返回 -1
+inline qint64 elapsed(const QString& name)
+{
+    for (const auto& mark : marks()) {
+        if (mark.first == name) return mark.second;
+    }
+    return -1;
+}
+
+// 只记录第一次到达，返回是否为首次
+inline bool mark(const QString& name)
+{
+    if (!clock().isValid() || elapsed(name) >= 0) return false;
+
+    const qint64 ms = clock().elapsed();
+    marks().append(qMakePair(name, ms));
+    qDebug() << "启动耗时:" << name << ms << "ms";
+    return true;
+}
+
+// 例如 "界面可交互 120 ms，数据库就绪 480 ms"
+inline QString summary()
+{
+    QStringList parts;
+    for (const auto& mark : marks()) {
+        parts << QString("%1 %2 ms").arg(mark.first).arg(mark.second);
+    }
+    return parts.join("，");
+}
+
+} // namespace StartupMetrics
+
+#endif // STARTUPMETRICS_H
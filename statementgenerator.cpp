@@ -0,0 +1,335 @@
+#include "statementgenerator.h"
+#include "transactionarchiver.h"
+#include "money.h"
+#include "journal.h"
+#include "schema.h"
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThread>
+#include <QHash>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QTextStream>
+#include <QStandardPaths>
+#include <QDebug>
+#include <algorithm>
+#include <functional>
+
+namespace {
+class RenderTask : public QRunnable
+{
+public:
+    RenderTask(std::function<void()> work) : work(std::move(work)) {}
+    void run() override { work(); }
+
+private:
+    std::function<void()> work;
+};
+
+// CSV 字段转义
+QString csvField(const QString& value)
+{
+    if (!value.contains(',') && !value.contains('"') && !value.contains('\n')) return value;
+    return '"' + QString(value).replace("\"", "\"\"") + '"';
+}
+}
+
+StatementGenerator::StatementGenerator(const QString& sourceConnectionName, QObject* parent)
+    : QObject(parent)
+    , sourceConnection(sourceConnectionName)
+    , directory(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/statements")
+    , threads(QThread::idealThreadCount())
+    , pageSize(5000)
+    , written(0)
+    , scanned(0)
+    , cancelled(0)
+{
+}
+
+void StatementGenerator::setThreadCount(int count)
+{
+    threads = qMax(1, count);
+}
+
+void StatementGenerator::setPageSize(int accounts)
+{
+    pageSize = qBound(100, accounts, 50000);
+}
+
+void StatementGenerator::setOutputDirectory(const QString& path)
+{
+    directory = path;
+}
+
+QString StatementGenerator::outputDirectory() const
+{
+    return directory;
+}
+
+void StatementGenerator::cancel()
+{
+    cancelled.storeRelaxed(1);
+}
+
+qint64 StatementGenerator::statementsWritten() const
+{
+    return written.loadRelaxed();
+}
+
+qint64 StatementGenerator::postingsScanned() const
+{
+    return scanned.loadRelaxed();
+}
+
+QString StatementGenerator::statementPath(const QString& directory, const QDate& month, const QString& accountId)
+{
+    // 按账户号末两位分目录，避免单个目录下文件过多
+    return QString("%1/%2/%3/%4.csv")
+        .arg(directory, month.toString("yyyyMM"), accountId.right(2), accountId);
+}
+
+bool StatementGenerator::run(const QDate& month)
+{
+    cancelled.storeRelaxed(0);
+    written.storeRelaxed(0);
+    scanned.storeRelaxed(0);
+
+    const QDate firstDay(month.year(), month.month(), 1);
+    const QDateTime from(firstDay, QTime(0, 0));
+    const QDateTime to(firstDay.addMonths(1), QTime(0, 0));
+
+    const QString connectionName = QString("%1_statements").arg(sourceConnection);
+    bool success = false;
+    {
+        QSqlDatabase db = QSqlDatabase::cloneDatabase(sourceConnection, connectionName);
+        if (!db.open()) {
+            qDebug() << "对账单连接失败:" << db.lastError().text();
+        } else {
+            QSqlQuery query(db);
+            qint64 total = 0;
+
+            // 已归档的月份流水不在线上分区中
+            query.prepare("SELECT COUNT(*) FROM transaction_archives WHERE partition_name = :name");
+            query.bindValue(":name", TransactionArchiver::partitionName(firstDay));
+            if (query.exec() && query.next() && query.value(0).toInt() > 0) {
+                qDebug() << "该月份流水已归档，无法生成对账单:" << firstDay.toString("yyyy-MM");
+            } else if (query.exec("SELECT COUNT(*) FROM accounts") && query.next()) {
+                total = query.value(0).toLongLong();
+                success = true;
+            } else {
+                qDebug() << "读取账户数量失败:" << query.lastError().text();
+            }
+
+            if (success) {
+                qDebug() << "开始生成对账单:" << firstDay.toString("yyyy-MM") << "账户数:" << total
+                         << "线程数:" << threads;
+
+                // 读取在当前线程顺序进行，渲染交给线程池；在途页数有上限，读取过快时在此等待
+                QThreadPool pool;
+                pool.setMaxThreadCount(threads);
+                QSemaphore inFlight(threads * 2);
+                QAtomicInteger<int> failures(0);
+                QAtomicInteger<qint64> done(0);
+
+                QString lastAccountId = "0";   // 账户号均大于 0
+                for (;;) {
+                    if (cancelled.loadRelaxed()) break;
+
+                    QVector<AccountStatement> page;
+                    if (!readPage(db, from, to, lastAccountId, page)) {
+                        success = false;
+                        break;
+                    }
+                    if (page.isEmpty()) break;
+
+                    inFlight.acquire();
+                    const QString dir = directory;
+                    pool.start(new RenderTask([this, page, dir, firstDay, total, &inFlight, &failures, &done]() {
+                        for (const AccountStatement& statement : page) {
+                            if (writeStatement(statementPath(dir, firstDay, statement.accountId), firstDay, statement)) {
+                                written.fetchAndAddRelaxed(1);
+                            } else {
+                                failures.fetchAndAddRelaxed(1);
+                            }
+                        }
+                        emit progress(done.fetchAndAddRelaxed(page.size()) + page.size(), total);
+                        inFlight.release();
+                    }));
+                }
+                pool.waitForDone();
+
+                success = success && failures.loadRelaxed() == 0 && !cancelled.loadRelaxed();
+            }
+            db.close();
+        }
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+
+    qDebug() << "对账单生成结束，文件:" << statementsWritten() << "流水:" << postingsScanned()
+             << "成功:" << success;
+    emit finished(success);
+    return success;
+}
+
+// 读取 lastAccountId 之后的一页账户；三条查询在同一快照内，余额与流水一致
+bool StatementGenerator::readPage(QSqlDatabase& db, const QDateTime& from, const QDateTime& to,
+                                  QString& lastAccountId, QVector<AccountStatement>& page)
+{
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    query.setNumericalPrecisionPolicy(QSql::HighPrecision);
+
+    if (!query.exec("SET SESSION TRANSACTION ISOLATION LEVEL REPEATABLE READ")
+        || !query.exec("START TRANSACTION WITH CONSISTENT SNAPSHOT")) {
+        qDebug() << "开启一致性快照失败:" << query.lastError().text();
+        return false;
+    }
+
+    auto fail = [&query](const char* what) {
+        qDebug() << what << query.lastError().text();
+        query.exec("ROLLBACK");
+        return false;
+    };
+
+    // 月末之后开立的账户没有该月对账单
+    query.prepare(QString("SELECT a.account_id, t.type_name, a.balance, u.full_name FROM accounts a "
+                          "LEFT JOIN account_types t ON t.type_code = a.account_type "
+                          "LEFT JOIN users u ON a.user_id = u.user_id "
+                          "WHERE a.account_id > :after AND a.created_at < :to AND a.status <> %1 "
+                          "ORDER BY a.account_id LIMIT %2").arg(Schema::Closed).arg(pageSize));
+    query.bindValue(":after", Schema::accountKey(lastAccountId));
+    query.bindValue(":to", to);
+    if (!query.exec()) return fail("读取账户失败:");
+
+    QHash<QString, int> index;
+    while (query.next()) {
+        AccountStatement statement;
+        statement.accountId = query.value(0).toString();
+        statement.accountType = query.value(1).toString();
+        statement.closingCents = Money::toCents(query.value(2));   // 暂存当前余额
+        statement.holderName = query.value(3).toString();
+        index.insert(statement.accountId, page.size());
+        page.append(statement);
+    }
+    if (page.isEmpty()) {
+        query.exec("COMMIT");
+        return true;
+    }
+
+    const QString low = page.first().accountId;
+    const QString high = page.last().accountId;
+    lastAccountId = high;
+
+    // 月末之后的净额：当前余额减去它即为期末余额
+    query.prepare(Journal::postingTotalsSql("%1 BETWEEN :low%2 AND :high%2 AND transaction_time >= :to%2"));
+    Journal::bindLegs(query, ":low", Schema::accountKey(low));
+    Journal::bindLegs(query, ":high", Schema::accountKey(high));
+    Journal::bindLegs(query, ":to", to);
+    if (!query.exec()) return fail("汇总月末后流水失败:");
+    while (query.next()) {
+        const int i = index.value(query.value(0).toString(), -1);
+        if (i < 0) continue;
+        page[i].closingCents -= Money::postingSign(query.value(1).toString()) * Money::toCents(query.value(2));
+    }
+
+    // 当月流水：借方走 idx_transactions_account_time，转入的贷方分录走 idx_transactions_credit_time，
+    // 合并后按账户有序，账户内时间倒序
+    query.prepare("SELECT t.account_id, t.transaction_id, " + Schema::transactionTypeSql("t.transaction_type")
+                  + ", t.amount, t.target_account, "
+                  "t.description, t.transaction_time FROM transactions t "
+                  "WHERE t.account_id BETWEEN :low AND :high "
+                  "AND t.transaction_time >= :from AND t.transaction_time < :to "
+                  "UNION ALL "
+                  "SELECT t.credit_account, t.transaction_id, '收款', t.amount, t.account_id, "
+                  + Journal::creditDescriptionSql("t") + ", t.transaction_time FROM transactions t "
+                  "WHERE t.credit_account BETWEEN :low_credit AND :high_credit "
+                  "AND t.transaction_time >= :from_credit AND t.transaction_time < :to_credit "
+                  "ORDER BY account_id, transaction_time DESC, transaction_id DESC");
+    Journal::bindLegs(query, ":low", Schema::accountKey(low));
+    Journal::bindLegs(query, ":high", Schema::accountKey(high));
+    Journal::bindLegs(query, ":from", from);
+    Journal::bindLegs(query, ":to", to);
+    if (!query.exec()) return fail("读取当月流水失败:");
+
+    int current = -1;
+    QString currentId;
+    while (query.next()) {
+        const QString accountId = query.value(0).toString();
+        if (accountId != currentId) {
+            currentId = accountId;
+            current = index.value(accountId, -1);
+        }
+        scanned.fetchAndAddRelaxed(1);
+        if (current < 0) continue;
+
+        StatementPosting posting;
+        posting.transactionId = query.value(1).toLongLong();
+        posting.type = query.value(2).toString();
+        posting.amountCents = Money::postingSign(posting.type) * Money::toCents(query.value(3));
+        posting.targetAccount = Schema::accountId(query.value(4));
+        posting.description = query.value(5).toString();
+        posting.time = query.value(6).toDateTime();
+        page[current].postings.append(posting);
+    }
+    query.exec("COMMIT");
+
+    for (AccountStatement& statement : page) {
+        std::reverse(statement.postings.begin(), statement.postings.end());
+        qint64 net = 0;
+        for (const StatementPosting& posting : statement.postings) net += posting.amountCents;
+        statement.openingCents = statement.closingCents - net;
+    }
+    return true;
+}
+
+bool StatementGenerator::writeStatement(const QString& path, const QDate& month, const AccountStatement& statement)
+{
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qDebug() << "无法写入对账单:" << path;
+        return false;
+    }
+
+    qint64 credits = 0;
+    qint64 debits = 0;
+    for (const StatementPosting& posting : statement.postings) {
+        if (posting.amountCents >= 0) {
+            credits += posting.amountCents;
+        } else {
+            debits -= posting.amountCents;
+        }
+    }
+
+    QTextStream out(&file);
+    out << "账户," << statement.accountId << '\n'
+        << "户名," << csvField(statement.holderName) << '\n'
+        << "账户类型," << statement.accountType << '\n'
+        << "期间," << month.toString("yyyy-MM") << '\n'
+        << "期初余额," << Money::toDecimalString(statement.openingCents) << '\n'
+        << "收入合计," << Money::toDecimalString(credits) << '\n'
+        << "支出合计," << Money::toDecimalString(debits) << '\n'
+        << "期末余额," << Money::toDecimalString(statement.closingCents) << '\n'
+        << '\n'
+        << "time,transaction_id,type,amount,target_account,description,balance\n";
+
+    qint64 balance = statement.openingCents;
+    for (const StatementPosting& posting : statement.postings) {
+        balance += posting.amountCents;
+        out << posting.time.toString("yyyy-MM-dd HH:mm:ss") << ','
+            << posting.transactionId << ','
+            << posting.type << ','
+            << Money::toDecimalString(posting.amountCents) << ','
+            << posting.targetAccount << ','
+            << csvField(posting.description) << ','
+            << Money::toDecimalString(balance) << '\n';
+    }
+
+    out.flush();
+    return file.commit();
+}
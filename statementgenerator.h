@@ -0,0 +1,78 @@
+#ifndef STATEMENTGENERATOR_H
+#define STATEMENTGENERATOR_H
+
+#include <QObject>
+#include <QString>
+#include <QDate>
+#include <QDateTime>
+#include <QVector>
+#include <QAtomicInteger>
+
+class QSqlDatabase;
+
+// 对账单中的一条流水，amountCents 带方向（入账为正）
+struct StatementPosting
+{
+    qint64 transactionId = 0;
+    QString type;
+    qint64 amountCents = 0;
+    QString targetAccount;
+    QString description;
+    QDateTime time;
+};
+
+struct AccountStatement
+{
+    QString accountId;
+    QString accountType;
+    QString holderName;
+    qint64 openingCents = 0;
+    qint64 closingCents = 0;
+    QVector<StatementPosting> postings;   // 按时间正序
+};
+
+// 月度对账单批量生成
+// 按账户号分页顺序扫描：每页一次读取账户、当月流水（按账户有序）与月末之后的净额，
+// 流式归并出各账户的期初/期末余额后交给线程池渲染文件；在途页数受信号量限制，内存占用与账户总数无关。
+class StatementGenerator : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit StatementGenerator(const QString& sourceConnectionName, QObject* parent = nullptr);
+
+    void setThreadCount(int count);
+    void setPageSize(int accounts);
+    void setOutputDirectory(const QString& directory);
+    QString outputDirectory() const;
+
+    // 阻塞执行，month 取其所在月份
+    bool run(const QDate& month);
+    void cancel();
+
+    qint64 statementsWritten() const;
+    qint64 postingsScanned() const;
+
+    // 对账单文件路径：<目录>/<yyyyMM>/<账户号末两位>/<账户号>.csv
+    static QString statementPath(const QString& directory, const QDate& month, const QString& accountId);
+    static bool writeStatement(const QString& path, const QDate& month, const AccountStatement& statement);
+
+signals:
+    void progress(qint64 accountsDone, qint64 accountsTotal);
+    void finished(bool success);
+
+private:
+    QString sourceConnection;
+    QString directory;
+    int threads;
+    int pageSize;
+
+    QAtomicInteger<qint64> written;
+    QAtomicInteger<qint64> scanned;
+    QAtomicInteger<int> cancelled;
+
+    bool readPage(QSqlDatabase& db, const QDateTime& from, const QDateTime& to,
+                  QString& lastAccountId, QVector<AccountStatement>& page);
+};
+
+#endif // STATEMENTGENERATOR_H
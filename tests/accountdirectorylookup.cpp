@@ -0,0 +1,177 @@
+// AccountDirectory 测试：不连接数据库，只经 upsert/remove 维护目录。加入的账户号一定查得到
+// （包括超过布隆过滤器初始容量之后），未加入与已删除的查不到，户名与状态的更新，不规则账户号，
+// 前缀查找与逐个比对字符串前缀的结果一致，以及未同步时不视为新鲜。全部通过返回 0。
+#include "accountdirectory.h"
+#include <QRandomGenerator>
+#include <QSet>
+#include <QTextStream>
+#include <algorithm>
+#include <functional>
+
+namespace {
+
+AccountDirectory::Entry entry(const QString& accountId, const QString& ownerName, const QString& status = "正常")
+{
+    AccountDirectory::Entry result;
+    result.accountId = accountId;
+    result.ownerName = ownerName;
+    result.status = status;
+    return result;
+}
+
+// 18、19 位各半的随机账户号，首位非零
+QString randomAccountId(QRandomGenerator& random)
+{
+    QString id = QString::number(1 + random.bounded(9));
+    const int length = random.bounded(2) ? 19 : 18;
+    while (id.size() < length) id += QString::number(random.bounded(10));
+    return id;
+}
+
+bool presentAndAbsent()
+{
+    // 初始过滤器为 1024 位，加入 5000 个账户后远超容量：只会多误判，不能漏判
+    QRandomGenerator random(39);
+    AccountDirectory directory;
+    QSet<QString> added;
+    while (added.size() < 5000) {
+        const QString id = randomAccountId(random);
+        directory.upsert(entry(id, "户名" + QString::number(added.size() % 97)));
+        added.insert(id);
+    }
+    if (directory.size() != added.size()) return false;
+
+    for (const QString& id : added) {
+        AccountDirectory::Entry found;
+        if (directory.lookup(id, &found) != AccountDirectory::Present || found.accountId != id) return false;
+    }
+    for (int i = 0; i < 20000; ++i) {
+        const QString id = randomAccountId(random);
+        if (added.contains(id)) continue;
+        if (directory.lookup(id) != AccountDirectory::Absent) return false;
+    }
+    // 前导零、非数字、超过 19 位都不是已有的账户号
+    return directory.lookup(QString()) == AccountDirectory::Absent
+           && directory.lookup("0622202123456789012") == AccountDirectory::Absent
+           && directory.lookup("62220212345678901234") == AccountDirectory::Absent;
+}
+
+bool updateAndRemove()
+{
+    AccountDirectory directory;
+    directory.upsert(entry("622202123456789012", "张三"));
+    directory.upsert(entry("6222021234567890123", "李四"));
+
+    // 本进程开户时还不知道户名：空户名不覆盖已有的，状态照常更新
+    directory.upsert(entry("622202123456789012", QString(), "冻结"));
+    AccountDirectory::Entry found;
+    if (directory.lookup("622202123456789012", &found) != AccountDirectory::Present) return false;
+    if (found.ownerName != "张三" || found.status != "冻结") return false;
+
+    directory.upsert(entry("622202123456789012", "张三丰", "正常"));
+    directory.lookup("622202123456789012", &found);
+    if (found.ownerName != "张三丰" || found.status != "正常") return false;
+
+    // 删除后布隆过滤器仍有该位置，由二分查找判定为不存在
+    directory.remove("622202123456789012");
+    directory.remove("622202123456789019");   // 不存在的账户号
+    return directory.lookup("622202123456789012") == AccountDirectory::Absent
+           && directory.lookup("6222021234567890123") == AccountDirectory::Present && directory.size() == 1;
+}
+
+bool irregularIds()
+{
+    // 不符合数字账户号格式的（如迁移来的旧账户号）单独存放，同样能查找、更新、删除与前缀匹配
+    AccountDirectory directory;
+    directory.upsert(entry("0622202123456789012", "王五"));
+    directory.upsert(entry("6222-0212", "赵六"));
+    directory.upsert(entry("0622202123456789012", QString(), "冻结"));
+
+    AccountDirectory::Entry found;
+    if (directory.lookup("0622202123456789012", &found) != AccountDirectory::Present) return false;
+    if (found.ownerName != "王五" || found.status != "冻结") return false;
+    if (directory.lookup("6222-0212") != AccountDirectory::Present || directory.size() != 2) return false;
+
+    const QList<AccountDirectory::Entry> matches = directory.search("6222", 10);
+    if (matches.size() != 1 || matches.first().accountId != "6222-0212") return false;
+
+    directory.remove("6222-0212");
+    return directory.lookup("6222-0212") == AccountDirectory::Absent && directory.size() == 1;
+}
+
+bool prefixSearch()
+{
+    QRandomGenerator random(47);
+    AccountDirectory directory;
+    QStringList all;
+    // 集中在少数几个前缀下，使每个前缀都有 18、19 位的多条结果
+    const QStringList heads = { "6222", "6228", "9" };
+    while (all.size() < 3000) {
+        QString id = heads.at(random.bounded(heads.size()));
+        const int length = random.bounded(2) ? 19 : 18;
+        while (id.size() < length) id += QString::number(random.bounded(10));
+        if (all.contains(id)) continue;
+        directory.upsert(entry(id, "户名"));
+        all << id;
+    }
+    all << "6222-0212";
+    directory.upsert(entry("6222-0212", "户名"));
+
+    const QStringList prefixes = { "6", "62", "6222", "62221", "622212", "9", "90", all.at(17), all.at(18).left(18),
+                                   "7", "1" };
+    for (const QString& prefix : prefixes) {
+        QStringList expected;
+        for (const QString& id : all) {
+            if (id.startsWith(prefix)) expected << id;
+        }
+        std::sort(expected.begin(), expected.end());
+
+        for (int limit : { 1, 5, 50, 5000 }) {
+            const QList<AccountDirectory::Entry> results = directory.search(prefix, limit);
+            if (results.size() != qMin(limit, expected.size())) return false;
+            for (int i = 0; i < results.size(); ++i) {
+                if (results.at(i).accountId != expected.at(i)) return false;
+            }
+        }
+    }
+    // 非数字前缀与非正的 limit 没有结果
+    return directory.search("62a", 10).isEmpty() && directory.search("6222", 0).isEmpty()
+           && directory.search(QString(), 10).isEmpty();
+}
+
+bool freshness()
+{
+    // 未成功同步过的目录查不到时不能据此判定账户不存在
+    AccountDirectory directory;
+    directory.upsert(entry("622202123456789012", "张三"));
+    return !directory.isSynced() && !directory.isFresh(60 * 60 * 1000)
+           && directory.lookup("622202123456789012") == AccountDirectory::Present;
+}
+
+} // namespace
+
+int main()
+{
+    QTextStream out(stdout);
+
+    const struct {
+        const char* name;
+        std::function<bool()> run;
+    } cases[] = {
+        { "加入的查得到、未加入的查不到", presentAndAbsent },
+        { "更新与删除", updateAndRemove },
+        { "不规则账户号", irregularIds },
+        { "前缀查找", prefixSearch },
+        { "未同步时不新鲜", freshness },
+    };
+
+    int failed = 0;
+    for (const auto& test : cases) {
+        const bool ok = test.run();
+        out << (ok ? "通过" : "失败") << "  " << test.name << "\n";
+        if (!ok) ++failed;
+    }
+
+    out.flush();
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,333 @@
+// ColumnStore 测试：在临时目录写入若干段（时间乱序、跨多日，金额跨越各个数量级），
+// 三种报表在各种筛选条件下与逐行计算的结果一致；末段读回后与写入的一致，追加后覆盖写回能被查询看到；
+// 以及追加时交易号须递增、类型最多 256 种，损坏的段文件被跳过。全部通过返回 0。
+#include "columnstore.h"
+#include <QDir>
+#include <QFile>
+#include <QMap>
+#include <QPair>
+#include <QRandomGenerator>
+#include <QSet>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <functional>
+
+namespace {
+
+const qint64 kBase = 1700000000;
+const qint64 kBucketBounds[] = { 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000 };
+
+struct Row
+{
+    qint64 id;
+    qint64 time;
+    QString type;
+    qint64 amount;
+    QString account;
+    QString target;
+};
+
+qint64 floorDiv(qint64 value, qint64 divisor)
+{
+    return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+}
+
+// 每段 4000 行，相邻段的 5 天时间窗口互相重叠；段内时间乱序
+QVector<Row> generate(quint32 seed, qint64 firstId, int segments)
+{
+    const QStringList types = { "存款", "取款", "转账", "收款", "利息" };
+    QRandomGenerator random(seed);
+    QVector<Row> rows;
+    qint64 id = firstId;
+    for (int s = 0; s < segments; ++s) {
+        const qint64 start = kBase + s * 3 * 86400;
+        for (int i = 0; i < 4000; ++i) {
+            Row row;
+            id += 1 + random.bounded(5);
+            row.id = id;
+            row.time = start + random.bounded(5 * 86400);
+            row.type = types.at(random.bounded(types.size()));
+            row.amount = 1 + qint64(random.bounded(100000)) * (qint64(1) << random.bounded(20));
+            row.account = QString("6214999%1").arg(random.bounded(40), 12, 10, QChar('0'));
+            if (row.type == "转账" || row.type == "收款") {
+                row.target = QString("6214999%1").arg(random.bounded(40), 12, 10, QChar('0'));
+            }
+            rows.append(row);
+        }
+    }
+    return rows;
+}
+
+bool writeRows(ColumnStore& store, const QVector<Row>& rows, int rowsPerSegment)
+{
+    ColumnSegmentBuilder builder;
+    for (const Row& row : rows) {
+        if (!builder.add(row.id, row.time, row.type, row.amount, row.account, row.target)) return false;
+        if (builder.rows() == rowsPerSegment) {
+            if (!store.writeSegment(builder)) return false;
+            builder.clear();
+        }
+    }
+    return store.writeSegment(builder);
+}
+
+bool matches(const Row& row, const PostingFilter& filter)
+{
+    if (filter.from.isValid() && row.time < filter.from.toSecsSinceEpoch()) return false;
+    if (filter.to.isValid() && row.time >= filter.to.toSecsSinceEpoch()) return false;
+    if (!filter.type.isEmpty() && row.type != filter.type) return false;
+    if (filter.minCents > 0 && row.amount < filter.minCents) return false;
+    if (filter.maxCents > 0 && row.amount > filter.maxCents) return false;
+    return true;
+}
+
+QList<PostingFilter> filters()
+{
+    QList<PostingFilter> list;
+    list.append(PostingFilter());
+
+    PostingFilter window;   // 三段各命中一部分，段内按时间掩码过滤
+    window.from = QDateTime::fromSecsSinceEpoch(kBase + 4 * 86400 + 3600);
+    window.to = QDateTime::fromSecsSinceEpoch(kBase + 6 * 86400 + 7 * 3600 + 17);
+    list.append(window);
+
+    PostingFilter tail;     // 第一段完全在范围之外
+    tail.from = QDateTime::fromSecsSinceEpoch(kBase + 5 * 86400);
+    list.append(tail);
+
+    PostingFilter typed;
+    typed.type = "转账";
+    list.append(typed);
+
+    PostingFilter missingType;
+    missingType.type = "不存在的类型";
+    list.append(missingType);
+
+    PostingFilter amounts;
+    amounts.minCents = 10000;
+    amounts.maxCents = 5000000;
+    list.append(amounts);
+
+    PostingFilter combined = window;
+    combined.type = "存款";
+    combined.minCents = 100000;
+    list.append(combined);
+
+    PostingFilter empty;    // 时间范围在全部数据之后
+    empty.from = QDateTime::fromSecsSinceEpoch(kBase + 100 * 86400);
+    list.append(empty);
+    return list;
+}
+
+bool dailyVolume(ColumnStore& store, const QVector<Row>& rows)
+{
+    // 与实现相同按当前时区偏移换算本地日期
+    const qint64 utcOffset = QDateTime::currentDateTime().offsetFromUtc();
+    const QDate epoch(1970, 1, 1);
+    for (const PostingFilter& filter : filters()) {
+        QMap<QPair<QDate, QString>, QPair<qint64, qint64>> expected;
+        for (const Row& row : rows) {
+            if (!matches(row, filter)) continue;
+            QPair<qint64, qint64>& total
+                = expected[qMakePair(epoch.addDays(floorDiv(row.time + utcOffset, 86400)), row.type)];
+            total.first += 1;
+            total.second += row.amount;
+        }
+
+        const QList<DailyTypeVolume> actual = store.volumeByTypePerDay(filter);
+        if (actual.size() != expected.size()) return false;
+        for (const DailyTypeVolume& volume : actual) {
+            const QPair<qint64, qint64> total = expected.value(qMakePair(volume.day, volume.type));
+            if (volume.count != total.first || volume.amountCents != total.second) return false;
+        }
+    }
+    return true;
+}
+
+bool counterparties(ColumnStore& store, const QVector<Row>& rows)
+{
+    for (const PostingFilter& filter : filters()) {
+        QHash<QString, QPair<qint64, qint64>> expected;
+        for (const Row& row : rows) {
+            if (row.target.isEmpty() || !matches(row, filter)) continue;
+            expected[row.target].first += 1;
+            expected[row.target].second += row.amount;
+        }
+
+        for (int limit : { 0, 1, 10, 1000 }) {
+            const QList<CounterpartyVolume> actual = store.topCounterparties(filter, limit);
+            if (actual.size() != qMin(limit, expected.size())) return false;
+            QSet<QString> seen;
+            for (int i = 0; i < actual.size(); ++i) {
+                const CounterpartyVolume& volume = actual.at(i);
+                const QPair<qint64, qint64> total = expected.value(volume.accountId);
+                if (volume.count != total.first || volume.amountCents != total.second) return false;
+                if (i > 0 && actual.at(i - 1).amountCents < volume.amountCents) return false;
+                seen.insert(volume.accountId);
+            }
+            // 未入选的账户金额不超过入选的最后一名
+            if (actual.isEmpty()) continue;
+            for (auto it = expected.constBegin(); it != expected.constEnd(); ++it) {
+                if (!seen.contains(it.key()) && it.value().second > actual.last().amountCents) return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool amountBuckets(ColumnStore& store, const QVector<Row>& rows)
+{
+    const int bucketCount = int(sizeof(kBucketBounds) / sizeof(kBucketBounds[0])) + 1;
+    for (const PostingFilter& filter : filters()) {
+        QVector<qint64> counts(bucketCount);
+        QVector<qint64> sums(bucketCount);
+        for (const Row& row : rows) {
+            if (!matches(row, filter)) continue;
+            int bucket = 0;
+            while (bucket + 1 < bucketCount && row.amount >= kBucketBounds[bucket]) ++bucket;
+            counts[bucket] += 1;
+            sums[bucket] += row.amount;
+        }
+
+        const QList<AmountBucket> actual = store.amountDistribution(filter);
+        if (actual.size() != bucketCount) return false;
+        for (int b = 0; b < bucketCount; ++b) {
+            if (actual.at(b).lowerCents != (b == 0 ? 0 : kBucketBounds[b - 1])) return false;
+            if (actual.at(b).count != counts.at(b) || actual.at(b).amountCents != sums.at(b)) return false;
+        }
+    }
+    return true;
+}
+
+bool reports()
+{
+    QTemporaryDir dir;
+    if (!dir.isValid()) return false;
+    const QVector<Row> rows = generate(47, 1000, 3);
+    ColumnStore store(dir.path());
+    store.setThreadCount(4);
+    if (!writeRows(store, rows, 4000)) return false;
+    if (store.postingCount() != rows.size() || store.lastTransactionId() != rows.last().id) return false;
+
+    // 第二遍走解压后的缓存，结果应相同
+    for (int pass = 0; pass < 2; ++pass) {
+        if (!dailyVolume(store, rows) || !counterparties(store, rows) || !amountBuckets(store, rows)) return false;
+    }
+
+    // 同一目录新打开的实例从文件头读取段信息
+    ColumnStore reopened(dir.path());
+    return reopened.postingCount() == rows.size() && amountBuckets(reopened, rows) && dailyVolume(reopened, rows);
+}
+
+bool tailRoundTrip()
+{
+    QTemporaryDir dir;
+    if (!dir.isValid()) return false;
+    QVector<Row> rows = generate(49, 1, 2);
+    ColumnStore store(dir.path());
+    if (!writeRows(store, rows, 6000)) return false;   // 第二段只有 2000 行，未满
+
+    // 读回末段，写入另一目录，逐行查询的结果应与原末段一致
+    ColumnSegmentBuilder tail;
+    if (!store.loadTail(tail)) return false;
+    if (tail.rows() != 2000 || tail.firstTransactionId() != rows.at(6000).id
+        || tail.lastTransactionId() != rows.last().id) return false;
+    QTemporaryDir copyDir;
+    ColumnStore copy(copyDir.path());
+    if (!copy.writeSegment(tail)) return false;
+    if (!amountBuckets(copy, rows.mid(6000)) || !counterparties(copy, rows.mid(6000))) return false;
+
+    // 追加后覆盖写回：段数不变，查询看到新增的行（含缓存中已有的旧末段）
+    if (!amountBuckets(store, rows)) return false;
+    const QVector<Row> more = generate(50, rows.last().id, 1);
+    for (const Row& row : more) {
+        if (!tail.add(row.id, row.time, row.type, row.amount, row.account, row.target)) return false;
+    }
+    if (!store.writeSegment(tail)) return false;
+    rows += more;
+    if (QDir(dir.path()).entryList({ "postings_*.bkcol" }, QDir::Files).size() != 2) return false;
+    return store.postingCount() == rows.size() && store.lastTransactionId() == rows.last().id
+           && amountBuckets(store, rows) && dailyVolume(store, rows);
+}
+
+bool builderLimits()
+{
+    ColumnSegmentBuilder builder;
+    if (!builder.add(10, kBase, "存款", 100, "621499900000000001", QString())) return false;
+    // 交易号须严格递增
+    if (builder.add(10, kBase, "存款", 100, "621499900000000001", QString())) return false;
+    if (builder.add(9, kBase, "存款", 100, "621499900000000001", QString())) return false;
+    if (builder.rows() != 1) return false;
+
+    // 类型编码为一个字节：第 256 种可以加入，第 257 种拒绝
+    for (int i = 1; i < 256; ++i) {
+        if (!builder.add(10 + i, kBase, QString("类型%1").arg(i), 100, "621499900000000001", QString())) return false;
+    }
+    if (builder.add(1000, kBase, "类型256", 100, "621499900000000001", QString())) return false;
+    // 已有的类型仍可加入
+    if (!builder.add(1001, kBase, "类型7", 100, "621499900000000001", QString())) return false;
+    builder.clear();
+    return builder.rows() == 0 && builder.firstTransactionId() == 0 && builder.lastTransactionId() == 0;
+}
+
+bool corruptSegments()
+{
+    QTemporaryDir dir;
+    if (!dir.isValid()) return false;
+    const QVector<Row> rows = generate(51, 1, 1);
+    ColumnStore store(dir.path());
+    if (!writeRows(store, rows, 4000)) return false;
+
+    // 文件头无效的段在打开目录时跳过
+    QFile garbage(QDir(dir.path()).filePath("postings_999999999999.bkcol"));
+    if (!garbage.open(QIODevice::WriteOnly) || garbage.write("not a segment") < 0) return false;
+    garbage.close();
+
+    ColumnStore reopened(dir.path());
+    return reopened.postingCount() == rows.size() && reopened.lastTransactionId() == rows.last().id
+           && amountBuckets(reopened, rows);
+}
+
+bool emptyStore()
+{
+    QTemporaryDir dir;
+    if (!dir.isValid()) return false;
+    ColumnStore store(QDir(dir.path()).filePath("analytics"));   // 目录尚不存在
+    ColumnSegmentBuilder builder;
+    if (!store.loadTail(builder) || builder.rows() != 0) return false;
+    if (!store.writeSegment(builder)) return false;   // 空段不写文件
+    if (store.lastTransactionId() != 0 || store.postingCount() != 0) return false;
+    const QList<AmountBucket> buckets = store.amountDistribution(PostingFilter());
+    for (const AmountBucket& bucket : buckets) {
+        if (bucket.count != 0) return false;
+    }
+    return store.volumeByTypePerDay(PostingFilter()).isEmpty() && store.topCounterparties(PostingFilter(), 5).isEmpty();
+}
+
+} // namespace
+
+int main()
+{
+    QTextStream out(stdout);
+
+    const struct {
+        const char* name;
+        std::function<bool()> run;
+    } cases[] = {
+        { "报表与逐行计算一致", reports },
+        { "末段读回与追加写回", tailRoundTrip },
+        { "写入缓冲的限制", builderLimits },
+        { "跳过损坏的段", corruptSegments },
+        { "空列存", emptyStore },
+    };
+
+    int failed = 0;
+    for (const auto& test : cases) {
+        const bool ok = test.run();
+        out << (ok ? "通过" : "失败") << "  " << test.name << "\n";
+        if (!ok) ++failed;
+    }
+
+    out.flush();
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,122 @@
+// DbError 测试：MySQL 错误码的分类、QSqlError 的连接错误兜底、可重试的种类，
+// 以及 backoffMs() 的等待落在 [上限/2, 上限] 内且上限按指数增长、不超过最大值。全部通过返回 0。
+#include "dberror.h"
+#include <QSqlError>
+#include <QTextStream>
+#include <functional>
+
+namespace {
+
+bool nativeCodes()
+{
+    const struct {
+        const char* code;
+        DbError::Kind kind;
+    } expected[] = {
+        { "", DbError::None },
+        { "1213", DbError::Deadlock },
+        { "1205", DbError::LockWaitTimeout },
+        { "2006", DbError::ConnectionLost },
+        { "2013", DbError::ConnectionLost },
+        { "2055", DbError::ConnectionLost },
+        { "4031", DbError::ConnectionLost },
+        { "1048", DbError::ConstraintViolation },
+        { "1062", DbError::ConstraintViolation },
+        { "1451", DbError::ConstraintViolation },
+        { "1452", DbError::ConstraintViolation },
+        { "3819", DbError::ConstraintViolation },
+        { "2030", DbError::StatementInvalidated },
+        { "2056", DbError::StatementInvalidated },
+        { "1243", DbError::StatementInvalidated },
+        { "1064", DbError::Other },
+    };
+    for (const auto& entry : expected) {
+        if (DbError::classify(QString(entry.code)) != entry.kind) return false;
+    }
+    return true;
+}
+
+bool sqlErrors()
+{
+    // 没有错误码的连接错误（驱动在连接层失败）按连接中断处理，语句错误不算
+    if (DbError::classify(QSqlError()) != DbError::None) return false;
+    if (DbError::classify(QSqlError("", "", QSqlError::ConnectionError)) != DbError::ConnectionLost) return false;
+    if (DbError::classify(QSqlError("", "", QSqlError::StatementError, "1064")) != DbError::Other) return false;
+    if (DbError::classify(QSqlError("", "", QSqlError::StatementError, "1213")) != DbError::Deadlock) return false;
+    // 错误码已能分类时不被错误类型覆盖
+    return DbError::classify(QSqlError("", "", QSqlError::ConnectionError, "1205")) == DbError::LockWaitTimeout;
+}
+
+bool retryableKinds()
+{
+    return DbError::isRetryable(DbError::Deadlock) && DbError::isRetryable(DbError::LockWaitTimeout)
+           && DbError::isRetryable(DbError::ConnectionLost) && !DbError::isRetryable(DbError::ConstraintViolation)
+           && !DbError::isRetryable(DbError::StatementInvalidated) && !DbError::isRetryable(DbError::Other)
+           && !DbError::isRetryable(DbError::None) && DbError::isLockConflict(QString("1213"))
+           && !DbError::isLockConflict(DbError::ConnectionLost);
+}
+
+bool backoffBounds()
+{
+    // 与 DatabaseManager 的写事务重试相同：5 ms 起，最长 200 ms
+    const int base = 5;
+    const int max = 200;
+    for (int attempt = 0; attempt <= 20; ++attempt) {
+        const int ceiling = qMin(max, base << qBound(0, attempt - 1, 16));
+        for (int i = 0; i < 200; ++i) {
+            const int delay = DbError::backoffMs(attempt, base, max);
+            if (delay < ceiling / 2 || delay > ceiling) return false;
+        }
+    }
+    // 上限：第 1 次 5 ms，第 3 次 20 ms，之后封顶
+    return DbError::backoffMs(1, base, max) <= 5 && DbError::backoffMs(3, base, max) >= 10
+           && DbError::backoffMs(3, base, max) <= 20 && DbError::backoffMs(10, base, max) >= 100;
+}
+
+bool backoffJitter()
+{
+    // 同一次重试的等待应分散开，互相冲突的请求不会同时醒来
+    int low = 1 << 30, high = 0;
+    for (int i = 0; i < 500; ++i) {
+        const int delay = DbError::backoffMs(6, 5, 200);
+        low = qMin(low, delay);
+        high = qMax(high, delay);
+    }
+    return high - low >= 20;
+}
+
+bool describeKinds()
+{
+    return DbError::describe(DbError::Deadlock) == DbError::describe(DbError::LockWaitTimeout)
+           && DbError::describe(DbError::ConnectionLost) != DbError::describe(DbError::Deadlock)
+           && !DbError::describe(DbError::Other).isEmpty();
+}
+
+} // namespace
+
+int main()
+{
+    QTextStream out(stdout);
+
+    const struct {
+        const char* name;
+        std::function<bool()> run;
+    } cases[] = {
+        { "错误码分类", nativeCodes },
+        { "QSqlError 分类", sqlErrors },
+        { "可重试的种类", retryableKinds },
+        { "退避范围", backoffBounds },
+        { "退避抖动", backoffJitter },
+        { "错误描述", describeKinds },
+    };
+
+    int failed = 0;
+    for (const auto& test : cases) {
+        const bool ok = test.run();
+        out << (ok ? "通过" : "失败") << "  " << test.name << "\n";
+        if (!ok) ++failed;
+    }
+
+    out.flush();
+    return failed == 0 ? 0 : 1;
+}
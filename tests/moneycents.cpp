@@ -0,0 +1,93 @@
+// Money 测试：DECIMAL 文本与浮点换算为分、分格式化为 DECIMAL 字面量，以及两者往返一致。全部通过返回 0。
+#include "money.h"
+#include <QByteArray>
+#include <QTextStream>
+#include <functional>
+
+namespace {
+
+bool decimalText()
+{
+    // 驱动按高精度返回 DECIMAL 时是字符串：逐位换算，不经过浮点数
+    const struct {
+        const char* text;
+        qint64 cents;
+    } expected[] = {
+        { "0", 0 },
+        { "0.00", 0 },
+        { "12.34", 1234 },
+        { "12.3", 1230 },
+        { "12", 1200 },
+        { ".5", 50 },
+        { "-0.50", -50 },
+        { "+3.07", 307 },
+        { " 7.01 ", 701 },
+        { "1.239", 123 },   // 超过两位的小数截断（列为 DECIMAL(15,2)，不会出现）
+        { "9999999999999.99", 999999999999999LL },
+        { "-9999999999999.99", -999999999999999LL },
+    };
+    for (const auto& entry : expected) {
+        if (Money::toCents(QVariant(QString(entry.text))) != entry.cents) return false;
+        if (Money::toCents(QVariant(QByteArray(entry.text))) != entry.cents) return false;
+    }
+    return true;
+}
+
+bool floatingPoint()
+{
+    // 浮点输入四舍五入到分
+    return Money::toCents(0.1 + 0.2) == 30 && Money::toCents(19.99) == 1999 && Money::toCents(-19.99) == -1999
+           && Money::toCents(QVariant(2.675)) == 268 && Money::toCents(QVariant(100)) == 10000
+           && Money::toCents(0.0) == 0;
+}
+
+bool decimalStrings()
+{
+    return Money::toDecimalString(0) == "0.00" && Money::toDecimalString(5) == "0.05"
+           && Money::toDecimalString(-5) == "-0.05" && Money::toDecimalString(1234) == "12.34"
+           && Money::toDecimalString(-123450) == "-1234.50"
+           && Money::toDecimalString(999999999999999LL) == "9999999999999.99";
+}
+
+bool roundTrip()
+{
+    for (qint64 cents = -100000; cents <= 100000; cents += 7) {
+        if (Money::toCents(QVariant(Money::toDecimalString(cents))) != cents) return false;
+        if (Money::toCents(Money::toYuan(cents)) != cents) return false;
+    }
+    return true;
+}
+
+bool postingSigns()
+{
+    return Money::postingSign("存款") == 1 && Money::postingSign("收款") == 1 && Money::postingSign("利息") == 1
+           && Money::postingSign("取款") == -1 && Money::postingSign("转账") == -1;
+}
+
+} // namespace
+
+int main()
+{
+    QTextStream out(stdout);
+
+    const struct {
+        const char* name;
+        std::function<bool()> run;
+    } cases[] = {
+        { "DECIMAL 文本换算为分", decimalText },
+        { "浮点换算为分", floatingPoint },
+        { "分格式化为 DECIMAL", decimalStrings },
+        { "往返一致", roundTrip },
+        { "入账与出账方向", postingSigns },
+    };
+
+    int failed = 0;
+    for (const auto& test : cases) {
+        const bool ok = test.run();
+        out << (ok ? "通过" : "失败") << "  " << test.name << "\n";
+        if (!ok) ++failed;
+    }
+
+    out.flush();
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,132 @@
+// Schema 测试：账户号与整数键的换算、类型与状态的编码、ELT 表达式，
+// 以及账户号前缀换算出的整数区间恰好覆盖以该前缀开头的 18、19 位账户号。全部通过返回 0。
+#include "schema.h"
+#include <QMetaType>
+#include <QTextStream>
+#include <functional>
+
+namespace {
+
+bool accountKeys()
+{
+    const QVariant key = Schema::accountKey("6222021234567890123");
+    if (key.userType() != QMetaType::ULongLong || key.toULongLong() != 6222021234567890123ULL) return false;
+    // 19 位的最大值与 18 位账户号都在 BIGINT UNSIGNED 范围内，换算不经过浮点数
+    if (Schema::accountKey("9999999999999999999").toULongLong() != 9999999999999999999ULL) return false;
+    if (Schema::accountKey("622202123456789012").toULongLong() != 622202123456789012ULL) return false;
+    // 空串为 NULL；非数字与超出范围为 0，不对应任何账户
+    if (!Schema::accountKey(QString()).isNull()) return false;
+    if (Schema::accountKey("62220212345678901x").toULongLong() != 0) return false;
+    return Schema::accountKey("99999999999999999999").toULongLong() == 0;
+}
+
+bool accountIdReads()
+{
+    return Schema::accountId(QVariant()).isEmpty()
+           && Schema::accountId(QVariant(qulonglong(6222021234567890123ULL))) == "6222021234567890123";
+}
+
+bool codesRoundTrip()
+{
+    for (int code = Schema::Deposit; code <= Schema::Interest; ++code) {
+        if (Schema::transactionType(Schema::transactionTypeName(code)) != code) return false;
+    }
+    for (int code = Schema::Active; code <= Schema::Closed; ++code) {
+        if (Schema::accountStatus(Schema::accountStatusName(code)) != code) return false;
+    }
+    return Schema::transactionType("收款") == Schema::Credit && Schema::accountStatus("已销户") == Schema::Closed
+           && Schema::transactionType("未知") == 0 && Schema::transactionTypeName(0).isEmpty()
+           && Schema::accountStatusName(4).isEmpty();
+}
+
+bool eltExpressions()
+{
+    return Schema::transactionTypeSql("t.transaction_type")
+               == "ELT(t.transaction_type, '存款', '取款', '转账', '收款', '利息')"
+           && Schema::accountStatusSql("a.status") == "ELT(a.status, '正常', '冻结', '已销户')";
+}
+
+bool prefixSql()
+{
+    return Schema::accountPrefixSql("a.account_id", ":search", 0) == "FALSE"
+           && Schema::accountPrefixSql("a.account_id", ":search", 2)
+                  == "(a.account_id BETWEEN :search_lo0 AND :search_hi0 OR "
+                     "a.account_id BETWEEN :search_lo1 AND :search_hi1)";
+}
+
+bool prefixBounds()
+{
+    const QVariantList shortPrefix = Schema::accountPrefixBounds("6222");
+    if (shortPrefix.size() != 4) return false;
+    if (shortPrefix.at(0).toULongLong() != 622200000000000000ULL
+        || shortPrefix.at(1).toULongLong() != 622299999999999999ULL
+        || shortPrefix.at(2).toULongLong() != 6222000000000000000ULL
+        || shortPrefix.at(3).toULongLong() != 6222999999999999999ULL) return false;
+
+    // 18 位前缀：自身，加上以它开头的 10 个 19 位账户号
+    const QVariantList full18 = Schema::accountPrefixBounds("622202123456789012");
+    if (full18.size() != 4 || full18.at(0) != full18.at(1)
+        || full18.at(2).toULongLong() != 6222021234567890120ULL
+        || full18.at(3).toULongLong() != 6222021234567890129ULL) return false;
+
+    // 19 位只剩一个区间；超过 19 位、非数字与空串没有区间
+    const QVariantList full19 = Schema::accountPrefixBounds("6222021234567890123");
+    if (full19.size() != 2 || full19.at(0).toULongLong() != 6222021234567890123ULL || full19.at(0) != full19.at(1)) {
+        return false;
+    }
+    return Schema::accountPrefixBounds("62220212345678901234").isEmpty()
+           && Schema::accountPrefixBounds("62a2").isEmpty() && Schema::accountPrefixBounds(QString()).isEmpty();
+}
+
+bool prefixBoundsMatchStartsWith()
+{
+    // 用固定的一组账户号逐个核对：落在某个区间内 ⇔ 字符串以前缀开头
+    const QStringList ids = { "622200000000000000", "622299999999999999", "6222000000000000000",
+                              "6222999999999999999", "622300000000000000", "622199999999999999",
+                              "6221999999999999999", "6223000000000000000", "622212345678901234",
+                              "6222123456789012345", "62220", "9999999999999999999" };
+    const QStringList prefixes = { "6", "62", "622", "6222", "62221", "622212345678901234", "9" };
+    for (const QString& prefix : prefixes) {
+        const QVariantList bounds = Schema::accountPrefixBounds(prefix);
+        for (const QString& id : ids) {
+            if (id.size() < 18) continue;   // 账户号为 18、19 位
+            const qulonglong key = Schema::accountKey(id).toULongLong();
+            bool inside = false;
+            for (int i = 0; i + 1 < bounds.size(); i += 2) {
+                inside = inside || (key >= bounds.at(i).toULongLong() && key <= bounds.at(i + 1).toULongLong());
+            }
+            if (inside != id.startsWith(prefix)) return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main()
+{
+    QTextStream out(stdout);
+
+    const struct {
+        const char* name;
+        std::function<bool()> run;
+    } cases[] = {
+        { "账户号换算为整数键", accountKeys },
+        { "读取账户号列", accountIdReads },
+        { "类型与状态编码", codesRoundTrip },
+        { "ELT 表达式", eltExpressions },
+        { "前缀条件", prefixSql },
+        { "前缀区间", prefixBounds },
+        { "前缀区间与字符串前缀一致", prefixBoundsMatchStartsWith },
+    };
+
+    int failed = 0;
+    for (const auto& test : cases) {
+        const bool ok = test.run();
+        out << (ok ? "通过" : "失败") << "  " << test.name << "\n";
+        if (!ok) ++failed;
+    }
+
+    out.flush();
+    return failed == 0 ? 0 : 1;
+}
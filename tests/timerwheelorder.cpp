@@ -0,0 +1,114 @@
+// TimerWheel 测试：逐秒推进时每个 id 恰好在到期的那一秒取出（覆盖 4 层与溢出表、层间下沉的边界），
+// 一次推进多秒时按到期先后返回，以及取消、重复 schedule 与已过期时间的处理。全部通过返回 0。
+#include "timerwheel.h"
+#include <QHash>
+#include <QRandomGenerator>
+#include <QTextStream>
+#include <functional>
+
+namespace {
+
+const qint64 kStart = 1700000000;   // 任意不在槽位边界上的起点
+
+bool exactSecond()
+{
+    // 每层的边界（64、4096、262144 秒）与超出 4 层的溢出表各取若干到期时间
+    QRandomGenerator random(7);
+    TimerWheel wheel(kStart);
+    QHash<qint64, qint64> due;
+    const qint64 spans[] = { 70, 5000, 300000, 20000000, 40000000 };
+    qint64 id = 0;
+    for (qint64 span : spans) {
+        for (int i = 0; i < 200; ++i) {
+            const qint64 at = kStart + 1 + qint64(random.bounded(int(span)));
+            wheel.schedule(id, at);
+            due.insert(id++, at);
+        }
+    }
+    // 正好落在各层边界上的时刻：下沉与到期发生在同一秒
+    for (qint64 boundary : { qint64(64), qint64(4096), qint64(262144), qint64(16777216) }) {
+        const qint64 at = (kStart / boundary + 1) * boundary;
+        wheel.schedule(id, at);
+        due.insert(id++, at);
+    }
+
+    const qint64 end = kStart + 40000001;
+    for (qint64 now = kStart + 1; now <= end; ++now) {
+        for (qint64 expired : wheel.advance(now)) {
+            if (due.value(expired, -1) != now) return false;
+            due.remove(expired);
+        }
+    }
+    return due.isEmpty() && wheel.size() == 0;
+}
+
+bool batchOrder()
+{
+    TimerWheel wheel(kStart);
+    const qint64 offsets[] = { 300000, 5, 4096, 64, 70000, 1, 63, 262144 };
+    qint64 id = 0;
+    for (qint64 offset : offsets) wheel.schedule(id++, kStart + offset);
+
+    const QVector<qint64> expired = wheel.advance(kStart + 400000);
+    if (expired.size() != id) return false;
+    for (int i = 1; i < expired.size(); ++i) {
+        if (offsets[expired.at(i - 1)] > offsets[expired.at(i)]) return false;
+    }
+    return wheel.currentTime() == kStart + 400000;
+}
+
+bool cancelAndReschedule()
+{
+    TimerWheel wheel(kStart);
+    wheel.schedule(1, kStart + 10);
+    wheel.schedule(2, kStart + 5000);
+    wheel.schedule(3, kStart + 20);
+    wheel.cancel(3);
+    // 重复 schedule 以最后一次为准，提前或推迟都不会取出旧的到期时间
+    wheel.schedule(1, kStart + 30);
+    wheel.schedule(2, kStart + 15);
+    if (wheel.size() != 2 || wheel.contains(3) || !wheel.contains(1)) return false;
+
+    if (!wheel.advance(kStart + 14).isEmpty()) return false;
+    if (wheel.advance(kStart + 15) != QVector<qint64>{ 2 }) return false;
+    if (!wheel.advance(kStart + 29).isEmpty()) return false;
+    if (wheel.advance(kStart + 30) != QVector<qint64>{ 1 }) return false;
+    return wheel.advance(kStart + 10000).isEmpty() && wheel.size() == 0;
+}
+
+bool pastDue()
+{
+    // 已过期或正是当前时刻的，在下一秒取出
+    TimerWheel wheel(kStart);
+    wheel.schedule(1, kStart - 3600);
+    wheel.schedule(2, kStart);
+    const QVector<qint64> expired = wheel.advance(kStart + 1);
+    return expired.size() == 2 && expired.contains(1) && expired.contains(2);
+}
+
+} // namespace
+
+int main()
+{
+    QTextStream out(stdout);
+
+    const struct {
+        const char* name;
+        std::function<bool()> run;
+    } cases[] = {
+        { "逐秒推进在到期的那一秒取出", exactSecond },
+        { "一次推进按到期先后返回", batchOrder },
+        { "取消与重复 schedule", cancelAndReschedule },
+        { "已过期的时间", pastDue },
+    };
+
+    int failed = 0;
+    for (const auto& test : cases) {
+        const bool ok = test.run();
+        out << (ok ? "通过" : "失败") << "  " << test.name << "\n";
+        if (!ok) ++failed;
+    }
+
+    out.flush();
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,182 @@
+// VelocityLimiter 窗口与预留测试：日/小时的金额与次数限额、过期的桶、reserve()/release()，
+// 以及多个线程同时 reserve() 时不会一起越过次数限额。全部通过返回 0。
+#include "velocitylimiter.h"
+#include <QDateTime>
+#include <QThread>
+#include <QAtomicInt>
+#include <QTextStream>
+#include <functional>
+#include <vector>
+
+namespace {
+
+const QString kType = "储蓄账户";
+const qint64 kHour = 3600;
+
+VelocityLimits dailyAmount(qint64 cents)
+{
+    VelocityLimits limits;
+    limits.dailyAmountCents = cents;
+    return limits;
+}
+
+VelocityLimits dailyCount(int count)
+{
+    VelocityLimits limits;
+    limits.dailyCount = count;
+    return limits;
+}
+
+bool dailyAmountLimit()
+{
+    VelocityLimiter limiter;
+    limiter.setLimits(kType, VelocityLimiter::Withdraw, dailyAmount(100000));
+
+    VelocityLimiter::Reservation first, second, third;
+    QString reason;
+    if (!limiter.reserve("1", kType, VelocityLimiter::Withdraw, 60000, first, &reason)) return false;
+    // 600 + 500 超过 1000
+    if (limiter.reserve("1", kType, VelocityLimiter::Withdraw, 50000, second, &reason)) return false;
+    if (reason.isEmpty() || !second.accountId.isEmpty()) return false;
+    // 恰好用满不算超限
+    if (!limiter.reserve("1", kType, VelocityLimiter::Withdraw, 40000, third)) return false;
+    if (limiter.check("1", kType, VelocityLimiter::Withdraw, 1)) return false;
+
+    // 退回后额度恢复
+    limiter.release(first);
+    return limiter.check("1", kType, VelocityLimiter::Withdraw, 60000)
+           && !limiter.check("1", kType, VelocityLimiter::Withdraw, 60001);
+}
+
+bool dailyCountLimit()
+{
+    VelocityLimiter limiter;
+    limiter.setLimits(kType, VelocityLimiter::Transfer, dailyCount(2));
+
+    VelocityLimiter::Reservation reservation;
+    return limiter.reserve("1", kType, VelocityLimiter::Transfer, 1, reservation)
+           && limiter.reserve("1", kType, VelocityLimiter::Transfer, 1, reservation)
+           && !limiter.reserve("1", kType, VelocityLimiter::Transfer, 1, reservation);
+}
+
+bool accountsAndOperationsIndependent()
+{
+    VelocityLimiter limiter;
+    limiter.setLimits(kType, VelocityLimiter::Withdraw, dailyCount(1));
+    limiter.setLimits(kType, VelocityLimiter::Transfer, dailyCount(1));
+
+    VelocityLimiter::Reservation reservation;
+    return limiter.reserve("1", kType, VelocityLimiter::Withdraw, 100, reservation)
+           && limiter.reserve("1", kType, VelocityLimiter::Transfer, 100, reservation)
+           && limiter.reserve("2", kType, VelocityLimiter::Withdraw, 100, reservation)
+           && !limiter.check("1", kType, VelocityLimiter::Withdraw, 100)
+           && limiter.check("1", "活期账户", VelocityLimiter::Withdraw, 100);   // 未配置的类型不限额
+}
+
+bool expiredBucketsIgnored()
+{
+    VelocityLimiter limiter;
+    limiter.setLimits(kType, VelocityLimiter::Withdraw, dailyAmount(100000));
+
+    // 24 小时前的桶已滑出窗口，23 小时前的仍计入
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    limiter.record("1", VelocityLimiter::Withdraw, 100000, now - 24 * kHour);
+    if (!limiter.check("1", kType, VelocityLimiter::Withdraw, 100000)) return false;
+    limiter.record("2", VelocityLimiter::Withdraw, 100000, now - 23 * kHour);
+    return !limiter.check("2", kType, VelocityLimiter::Withdraw, 1);
+}
+
+bool hourlyWindow()
+{
+    VelocityLimiter limiter;
+    VelocityLimits limits;
+    limits.hourlyAmountCents = 10000;
+    limits.hourlyCount = 3;
+    limiter.setLimits(kType, VelocityLimiter::Withdraw, limits);
+
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    // 两小时前的扣款不计入每小时窗口
+    limiter.record("1", VelocityLimiter::Withdraw, 10000, now - 2 * kHour);
+    if (!limiter.check("1", kType, VelocityLimiter::Withdraw, 10000)) return false;
+
+    VelocityLimiter::Reservation reservation;
+    if (!limiter.reserve("1", kType, VelocityLimiter::Withdraw, 8000, reservation)) return false;
+    if (limiter.check("1", kType, VelocityLimiter::Withdraw, 2001)) return false;
+    if (!limiter.reserve("1", kType, VelocityLimiter::Withdraw, 1000, reservation)) return false;
+    if (!limiter.reserve("1", kType, VelocityLimiter::Withdraw, 1000, reservation)) return false;
+    // 第 4 次超过每小时 3 次
+    limiter.release(reservation);
+    return limiter.check("1", kType, VelocityLimiter::Withdraw, 1)
+           && limiter.reserve("1", kType, VelocityLimiter::Withdraw, 1, reservation)
+           && !limiter.check("1", kType, VelocityLimiter::Withdraw, 1);
+}
+
+bool releaseWithoutReservation()
+{
+    VelocityLimiter limiter;
+    limiter.setLimits(kType, VelocityLimiter::Withdraw, dailyCount(1));
+
+    VelocityLimiter::Reservation none;
+    limiter.release(none);
+    VelocityLimiter::Reservation reservation;
+    return limiter.reserve("1", kType, VelocityLimiter::Withdraw, 1, reservation)
+           && !limiter.reserve("1", kType, VelocityLimiter::Withdraw, 1, none)
+           && none.accountId.isEmpty();
+}
+
+bool concurrentReservations()
+{
+    const int kLimit = 100;
+    const int kThreads = 8;
+    const int kPerThread = 50;
+
+    VelocityLimiter limiter;
+    limiter.setLimits(kType, VelocityLimiter::Withdraw, dailyCount(kLimit));
+
+    QAtomicInt granted;
+    std::vector<QThread*> threads;
+    for (int i = 0; i < kThreads; ++i) {
+        threads.push_back(QThread::create([&limiter, &granted]() {
+            for (int n = 0; n < kPerThread; ++n) {
+                VelocityLimiter::Reservation reservation;
+                if (limiter.reserve("1", kType, VelocityLimiter::Withdraw, 1, reservation)) granted.ref();
+            }
+        }));
+        threads.back()->start();
+    }
+    for (QThread* thread : threads) {
+        thread->wait();
+        delete thread;
+    }
+    return granted.loadRelaxed() == kLimit;
+}
+
+} // namespace
+
+int main()
+{
+    QTextStream out(stdout);
+
+    const struct {
+        const char* name;
+        std::function<bool()> run;
+    } cases[] = {
+        { "日累计金额", dailyAmountLimit },
+        { "日累计次数", dailyCountLimit },
+        { "账户与操作互不影响", accountsAndOperationsIndependent },
+        { "过期的小时桶", expiredBucketsIgnored },
+        { "每小时窗口", hourlyWindow },
+        { "退回空预留", releaseWithoutReservation },
+        { "并发预留", concurrentReservations },
+    };
+
+    int failed = 0;
+    for (const auto& test : cases) {
+        const bool ok = test.run();
+        out << (ok ? "通过" : "失败") << "  " << test.name << "\n";
+        if (!ok) ++failed;
+    }
+
+    out.flush();
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,257 @@
+// WorkloadTrace 测试：抓取到临时目录后读回，文件头与每条记录（操作、开始时间、耗时、结果、参数）与写入的一致，
+// 跨多个块与多个线程的记录都在且按开始时间排序，嵌套调用只记录最外层，未抓取时不记录；
+// 文件尾部的块不完整时读出完整的部分；以及查询筛选条件与时间参数的编码往返。全部通过返回 0。
+#include "workloadtrace.h"
+#include "databasemanager.h"
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QSysInfo>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QThread>
+#include <algorithm>
+#include <functional>
+
+namespace {
+
+const int kThreads = 4;
+const int kEventsPerThread = 3000;   // 合计超过一块（4096 条）
+
+bool sameEvent(const WorkloadTrace::Event& a, const WorkloadTrace::Event& b)
+{
+    return a.operation == b.operation && a.startUs == b.startUs && a.result == b.result
+           && a.arguments == b.arguments;
+}
+
+// 抓取一段负载：多个线程各自记录，另加 Scope 计时的调用与嵌套调用，返回写入的记录
+bool capture(const QString& directory, QString& path, QVector<WorkloadTrace::Event>& written)
+{
+    WorkloadTrace& trace = WorkloadTrace::instance();
+    if (WorkloadTrace::isCapturing() || trace.elapsedUs() != -1) return false;
+    trace.record(WorkloadTrace::Balance, 0, 1, { "不应记录" });   // 未抓取时忽略
+
+    if (!trace.start(directory)) return false;
+    path = trace.filePath();
+
+    QVector<QVector<WorkloadTrace::Event>> perThread(kThreads);
+    QVector<QThread*> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        QVector<WorkloadTrace::Event>* sink = &perThread[t];
+        threads.append(QThread::create([t, sink]() {
+            WorkloadTrace& trace = WorkloadTrace::instance();
+            for (int i = 0; i < kEventsPerThread; ++i) {
+                WorkloadTrace::Event event;
+                event.operation = WorkloadTrace::Operation(1 + (t + i) % (WorkloadTrace::OperationCount - 1));
+                event.startUs = trace.elapsedUs();
+                event.result = qint64(t) * 1000000 + i - 500;
+                event.arguments = QStringList{ QString("%1-%2").arg(t).arg(i), "转账 备注", QString(), "12.34" };
+                trace.record(event.operation, event.startUs, event.result, event.arguments);
+                sink->append(event);
+            }
+        }));
+        threads.last()->start();
+    }
+    for (QThread* thread : threads) {
+        thread->wait();
+        delete thread;
+    }
+    for (const auto& events : perThread) written += events;
+
+    // Scope：只有最外层被记录，参数在构造时求值
+    {
+        WorkloadTrace::Scope outer(WorkloadTrace::Withdraw, []() {
+            return QStringList{ "622202123456789012", "100.00", "key-1" };
+        });
+        {
+            WorkloadTrace::Scope inner(WorkloadTrace::Balance, []() { return QStringList{ "622202123456789012" }; });
+            inner.done(250.5);
+        }
+        outer.done(true);
+    }
+    WorkloadTrace::Event scoped;
+    scoped.operation = WorkloadTrace::Withdraw;
+    scoped.result = 1;
+    scoped.arguments = QStringList{ "622202123456789012", "100.00", "key-1" };
+    scoped.startUs = -1;   // 开始时间读回后再核对
+    written.append(scoped);
+
+    // 超过 255 个参数时只保留前 255 个；未知的操作码读取时跳过
+    QStringList many;
+    for (int i = 0; i < 300; ++i) many << QString::number(i);
+    trace.record(WorkloadTrace::Search, trace.elapsedUs(), 7, many);
+    WorkloadTrace::Event truncated;
+    truncated.operation = WorkloadTrace::Search;
+    truncated.result = 7;
+    truncated.arguments = many.mid(0, 255);
+    truncated.startUs = -1;
+    written.append(truncated);
+    trace.record(WorkloadTrace::Operation(0), trace.elapsedUs(), 0, {});
+
+    trace.stop();
+    trace.record(WorkloadTrace::Balance, 0, 1, { "不应记录" });   // 停止后忽略
+    return !WorkloadTrace::isCapturing() && QFile::exists(path);
+}
+
+bool roundTrip()
+{
+    QTemporaryDir dir;
+    if (!dir.isValid()) return false;
+    const QDateTime before = QDateTime::currentDateTime().addMSecs(-1);
+    QString path;
+    QVector<WorkloadTrace::Event> written;
+    if (!capture(dir.path(), path, written)) return false;
+    const QDateTime after = QDateTime::currentDateTime();
+    if (QFileInfo(path).absolutePath() != QDir(dir.path()).absolutePath()) return false;
+
+    WorkloadTrace::Header header;
+    QVector<WorkloadTrace::Event> events;
+    if (!WorkloadTrace::read(path, header, events)) return false;
+    if (header.host != QSysInfo::machineHostName() || header.processId != QCoreApplication::applicationPid()
+        || header.startedAt < before || header.startedAt > after) return false;
+    if (events.size() != written.size()) return false;
+
+    for (int i = 1; i < events.size(); ++i) {
+        if (events.at(i - 1).startUs > events.at(i).startUs) return false;
+    }
+
+    // 线程记录以第一个参数区分；Scope 与超长参数的两条没有预先知道的开始时间
+    QHash<QString, WorkloadTrace::Event> byKey;
+    for (const WorkloadTrace::Event& event : written) {
+        if (event.startUs >= 0) byKey.insert(event.arguments.first(), event);
+    }
+    int unkeyed = 0;
+    for (const WorkloadTrace::Event& event : events) {
+        if (event.durationUs < 0) return false;
+        const auto it = byKey.constFind(event.arguments.value(0));
+        if (it != byKey.constEnd()) {
+            if (!sameEvent(event, *it)) return false;
+            byKey.erase(it);
+            continue;
+        }
+        if (unkeyed == 2) return false;
+        WorkloadTrace::Event expected = written.at(written.size() - 2 + unkeyed++);
+        expected.startUs = event.startUs;
+        if (!sameEvent(event, expected)) return false;
+    }
+    return byKey.isEmpty() && unkeyed == 2;
+}
+
+bool truncatedTail()
+{
+    QTemporaryDir dir;
+    if (!dir.isValid()) return false;
+    QString path;
+    QVector<WorkloadTrace::Event> written;
+    if (!capture(dir.path(), path, written)) return false;
+
+    WorkloadTrace::Header header;
+    QVector<WorkloadTrace::Event> full;
+    if (!WorkloadTrace::read(path, header, full)) return false;
+
+    // 模拟抓取进程异常退出：最后一块少一个字节
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+    const QByteArray content = file.readAll();
+    file.close();
+    const QString cut = QDir(dir.path()).filePath("cut.bkwl");
+    QFile output(cut);
+    if (!output.open(QIODevice::WriteOnly) || output.write(content.left(content.size() - 1)) < 0) return false;
+    output.close();
+
+    QVector<WorkloadTrace::Event> partial;
+    if (!WorkloadTrace::read(cut, header, partial) || partial.size() >= full.size()) return false;
+    for (const WorkloadTrace::Event& event : partial) {
+        const auto same = [&event](const WorkloadTrace::Event& e) { return sameEvent(e, event); };
+        if (std::none_of(full.constBegin(), full.constEnd(), same)) return false;
+    }
+
+    // 不是抓取文件
+    const QString other = QDir(dir.path()).filePath("other.bkwl");
+    QFile garbage(other);
+    if (!garbage.open(QIODevice::WriteOnly) || garbage.write("not a trace file") < 0) return false;
+    garbage.close();
+    return !WorkloadTrace::read(other, header, partial)
+           && !WorkloadTrace::read(QDir(dir.path()).filePath("missing.bkwl"), header, partial);
+}
+
+bool filterArguments()
+{
+    TransactionFilter filter;
+    filter.from = QDateTime(QDate(2024, 3, 1), QTime(8, 30, 15, 123));
+    filter.to = QDateTime(QDate(2024, 4, 1), QTime(0, 0));
+    filter.type = "转账";
+    filter.minAmount = 12.34;
+    filter.maxAmount = 99999.99;
+    filter.targetAccount = "6222021234567890123";
+    filter.descriptionContains = "工资 收入";
+    filter.beforeTime = QDateTime(QDate(2024, 3, 15), QTime(23, 59, 59, 999));
+    filter.beforeId = 9876543210LL;
+    filter.beforeCredit = true;
+
+    const QStringList arguments = WorkloadTrace::filterArguments("622202123456789012", filter, 50);
+    QString accountId;
+    TransactionFilter parsed;
+    int limit = 0;
+    if (!WorkloadTrace::parseFilterArguments(arguments, accountId, parsed, limit)) return false;
+    if (accountId != "622202123456789012" || limit != 50 || parsed.from != filter.from || parsed.to != filter.to
+        || parsed.type != filter.type || parsed.minAmount != filter.minAmount || parsed.maxAmount != filter.maxAmount
+        || parsed.targetAccount != filter.targetAccount || parsed.descriptionContains != filter.descriptionContains
+        || parsed.beforeTime != filter.beforeTime || parsed.beforeId != filter.beforeId || !parsed.beforeCredit) {
+        return false;
+    }
+
+    // 空筛选：无效时间往返后仍无效
+    const QStringList empty = WorkloadTrace::filterArguments("1", TransactionFilter(), 10);
+    TransactionFilter parsedEmpty;
+    if (!WorkloadTrace::parseFilterArguments(empty, accountId, parsedEmpty, limit)) return false;
+    if (parsedEmpty.from.isValid() || parsedEmpty.to.isValid() || parsedEmpty.beforeTime.isValid()
+        || parsedEmpty.beforeId != 0 || parsedEmpty.beforeCredit || limit != 10) return false;
+
+    // 早期轨迹的 11 个参数没有贷方游标标记；其他个数不接受
+    TransactionFilter legacy;
+    legacy.beforeCredit = true;
+    if (!WorkloadTrace::parseFilterArguments(arguments.mid(0, 11), accountId, legacy, limit) || legacy.beforeCredit) {
+        return false;
+    }
+    return !WorkloadTrace::parseFilterArguments(arguments.mid(0, 10), accountId, legacy, limit)
+           && !WorkloadTrace::parseFilterArguments(arguments + QStringList{ "x" }, accountId, legacy, limit);
+}
+
+bool timeArguments()
+{
+    const QDateTime time(QDate(2024, 1, 2), QTime(3, 4, 5, 678));
+    return WorkloadTrace::parseTime(WorkloadTrace::timeArgument(time)) == time
+           && WorkloadTrace::timeArgument(time).endsWith(".678") && WorkloadTrace::timeArgument(QDateTime()).isEmpty()
+           && !WorkloadTrace::parseTime(QString()).isValid();
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    const struct {
+        const char* name;
+        std::function<bool()> run;
+    } cases[] = {
+        { "抓取文件读回", roundTrip },
+        { "尾部不完整的文件", truncatedTail },
+        { "筛选条件参数往返", filterArguments },
+        { "时间参数往返", timeArguments },
+    };
+
+    int failed = 0;
+    for (const auto& test : cases) {
+        const bool ok = test.run();
+        out << (ok ? "通过" : "失败") << "  " << test.name << "\n";
+        if (!ok) ++failed;
+    }
+
+    out.flush();
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,107 @@
+#include "timerwheel.h"
+
+TimerWheel::TimerWheel(qint64 nowSecs)
+    : slots(kLevels * kSlots)
+    , now(nowSecs)
+{
+}
+
+QVector<TimerWheel::Entry>& TimerWheel::slot(int level, int index)
+{
+    return slots[level * kSlots + index];
+}
+
+void TimerWheel::schedule(qint64 id, qint64 dueSecs)
+{
+    // 旧条目不立即删除，出槽时与 active 比对后丢弃
+    active.insert(id, dueSecs);
+    place(Entry{ id, dueSecs });
+}
+
+void TimerWheel::cancel(qint64 id)
+{
+    active.remove(id);
+}
+
+bool TimerWheel::contains(qint64 id) const
+{
+    return active.contains(id);
+}
+
+int TimerWheel::size() const
+{
+    return active.size();
+}
+
+qint64 TimerWheel::currentTime() const
+{
+    return now;
+}
+
+void TimerWheel::place(const Entry& entry, int earliest)
+{
+    // 已过期的放到最早还会处理的槽位
+    const qint64 due = qMax(entry.due, now + earliest);
+    const qint64 delta = due - now;
+
+    for (int level = 0; level < kLevels; ++level) {
+        if (delta < (qint64(1) << (kSlotBits * (level + 1)))) {
+            const int index = int((due >> (kSlotBits * level)) & (kSlots - 1));
+            slot(level, index).append(Entry{ entry.id, entry.due });
+            return;
+        }
+    }
+
+    overflow.append(entry);
+}
+
+void TimerWheel::cascade(int level)
+{
+    // 将上层当前槽位的条目按剩余时间重新分配到下层
+    const int index = int((now >> (kSlotBits * level)) & (kSlots - 1));
+    QVector<Entry> entries;
+    entries.swap(slot(level, index));
+    for (const Entry& entry : entries) {
+        if (active.value(entry.id, -1) == entry.due) place(entry, 0);
+    }
+}
+
+QVector<qint64> TimerWheel::advance(qint64 nowSecs)
+{
+    QVector<qint64> expired;
+
+    while (now < nowSecs) {
+        ++now;
+
+        const int index = int(now & (kSlots - 1));
+        if (index == 0) {
+            // 自上而下逐层下沉，保证上层条目先落入随后要处理的下层槽位
+            int top = 1;
+            while (top < kLevels - 1 && ((now >> (kSlotBits * top)) & (kSlots - 1)) == 0) ++top;
+
+            if (top == kLevels - 1 && ((now >> (kSlotBits * top)) & (kSlots - 1)) == 0
+                && !overflow.isEmpty()) {
+                // 最高层转满一圈，溢出表中进入覆盖范围的条目重新分配
+                QVector<Entry> pending;
+                pending.swap(overflow);
+                for (const Entry& entry : pending) {
+                    if (active.value(entry.id, -1) == entry.due) place(entry, 0);
+                }
+            }
+
+            for (int level = top; level >= 1; --level) cascade(level);
+        }
+
+        QVector<Entry> entries;
+        entries.swap(slot(0, index));
+        for (const Entry& entry : entries) {
+            auto it = active.find(entry.id);
+            if (it != active.end() && it.value() == entry.due) {
+                expired.append(entry.id);
+                active.erase(it);
+            }
+        }
+    }
+
+    return expired;
+}
@@ -0,0 +1,46 @@
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+#include <QVector>
+#include <QHash>
+
+// 分层时间轮（秒级），用于跟踪大量定时任务的到期时间
+// 4 层 × 64 槽，逐层覆盖 64 秒、约 68 分钟、约 3 天、约 194 天，更远的放入溢出表；
+// 插入、取消为 O(1)，推进时只触及到期槽位。id 由调用方保证唯一，重复 schedule 以最后一次为准。
+class TimerWheel
+{
+public:
+    explicit TimerWheel(qint64 nowSecs = 0);
+
+    void schedule(qint64 id, qint64 dueSecs);
+    void cancel(qint64 id);
+    bool contains(qint64 id) const;
+    int size() const;
+    qint64 currentTime() const;
+
+    // 推进到 nowSecs，返回期间到期的 id（按到期先后）
+    QVector<qint64> advance(qint64 nowSecs);
+
+private:
+    static const int kLevels = 4;
+    static const int kSlotBits = 6;
+    static const int kSlots = 1 << kSlotBits;
+
+    struct Entry
+    {
+        qint64 id;
+        qint64 due;
+    };
+
+    QVector<QVector<Entry>> slots;   // kLevels * kSlots
+    QVector<Entry> overflow;
+    QHash<qint64, qint64> active;    // id -> 当前有效的到期时间，过时条目在出槽时丢弃
+    qint64 now;
+
+    QVector<Entry>& slot(int level, int index);
+    // earliest 为最早可放入的时刻相对 now 的偏移：新插入的为 1（本秒已处理），下沉时为 0（本秒的槽位随后处理）
+    void place(const Entry& entry, int earliest = 1);
+    void cascade(int level);
+};
+
+#endif // TIMERWHEEL_H
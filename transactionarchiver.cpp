@@ -0,0 +1,895 @@
+#include "transactionarchiver.h"
+#include "money.h"
+#include "journal.h"
+#include "schema.h"
+#include "dberror.h"
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QTimer>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QCryptographicHash>
+#include <QStandardPaths>
+#include <QRegularExpression>
+#include <QMutexLocker>
+#include <QHash>
+#include <QDebug>
+#include <algorithm>
+#include <limits>
+
+namespace {
+const quint32 kArchiveMagic = 0x424B4152; // "BKAR"
+const quint32 kLegacyArchiveVersion = 1;  // 整个文件一次压缩，读取时须整体解压
+const quint32 kArchiveVersion = 2;        // 分块压缩 + 文件末尾的块索引
+const int kArchiveBatchRows = 10000;      // 导出分区时每页读取的行数
+const int kArchiveBlockRows = 4096;       // 每个压缩块的记录数
+const int kIndexCacheBlocks = 200000;     // 块索引缓存上限（块数）
+const int kBlockCacheRows = 64 * kArchiveBlockRows;  // 解压块缓存上限（行数）
+const qint64 kTrailerBytes = 12;          // 索引偏移（qint64）+ 魔数
+
+// 新格式文件内的顺序：账户号升序（按整数），同一账户内时间、交易号倒序，与在线索引及历史输出一致
+bool archiveOrder(const ArchivedTransaction& a, const ArchivedTransaction& b)
+{
+    const quint64 accountA = a.accountId.toULongLong();
+    const quint64 accountB = b.accountId.toULongLong();
+    if (accountA != accountB) return accountA < accountB;
+    if (a.timeMSecs != b.timeMSecs) return a.timeMSecs > b.timeMSecs;
+    return a.transactionId > b.transactionId;
+}
+
+void writeRow(QDataStream& stream, const ArchivedTransaction& row)
+{
+    stream << row.transactionId << row.accountId << row.type << row.amountCents
+           << row.targetAccount << row.description << row.timeMSecs;
+}
+
+void readRow(QDataStream& stream, ArchivedTransaction& row)
+{
+    stream >> row.transactionId >> row.accountId >> row.type >> row.amountCents
+           >> row.targetAccount >> row.description >> row.timeMSecs;
+}
+
+// 解压一个块（长度前缀的压缩数据）中的记录
+bool decodeBlock(const QByteArray& compressed, QVector<ArchivedTransaction>& rows)
+{
+    const QByteArray payload = qUncompress(compressed);
+    QDataStream stream(payload);
+    stream.setVersion(QDataStream::Qt_5_15);
+
+    quint32 count = 0;
+    stream >> count;
+    rows.clear();
+    rows.reserve(int(qMin<quint32>(count, kArchiveBlockRows * 4)));
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        ArchivedTransaction row;
+        readRow(stream, row);
+        rows.append(row);
+    }
+    return stream.status() == QDataStream::Ok && quint32(rows.size()) == count;
+}
+
+// 按 (分录账户, 时间倒序, 交易号倒序) 键集分页读取一个分区的借方或贷方分录，
+// 顺序与 idx_transactions_account_time / idx_transactions_credit_time 一致，每页都是一次索引范围扫描
+class PartitionStream
+{
+public:
+    PartitionStream(QSqlDatabase& db, const QString& partition, bool credit)
+        : query(db)
+        , partition(partition)
+        , credit(credit)
+    {
+        query.setForwardOnly(true);
+        query.setNumericalPrecisionPolicy(QSql::HighPrecision);
+    }
+
+    // 当前记录，读完或出错时返回 nullptr
+    const ArchivedTransaction* peek()
+    {
+        if (position >= page.size() && !exhausted && !error) fetch();
+        return position < page.size() ? &page.at(position) : nullptr;
+    }
+
+    ArchivedTransaction take()
+    {
+        return page.at(position++);
+    }
+
+    bool failed() const { return error; }
+
+private:
+    QSqlQuery query;
+    QString partition;
+    bool credit;
+    QVector<ArchivedTransaction> page;
+    int position = 0;
+    bool exhausted = false;
+    bool error = false;
+
+    void fetch()
+    {
+        const QString account = credit ? "credit_account" : "account_id";
+        const bool paged = !page.isEmpty();
+
+        QStringList conditions;
+        if (credit) conditions << "credit_account IS NOT NULL";
+        if (paged) {
+            conditions << QString("(%1 > :account OR (%1 = :account2 AND (transaction_time < :time "
+                                  "OR (transaction_time = :time2 AND transaction_id < :id))))").arg(account);
+        }
+
+        // 分区名来自 information_schema 且已校验格式，可安全拼接
+        QString sql = QString("SELECT transaction_id, %1, transaction_type, amount, %2, description, transaction_time "
+                              "FROM transactions PARTITION (%3) ")
+                          .arg(account, credit ? "account_id" : "target_account", partition);
+        if (!conditions.isEmpty()) sql += "WHERE " + conditions.join(" AND ") + " ";
+        sql += QString("ORDER BY %1, transaction_time DESC, transaction_id DESC LIMIT %2").arg(account).arg(kArchiveBatchRows);
+
+        query.prepare(sql);
+        if (paged) {
+            const ArchivedTransaction& last = page.last();
+            query.bindValue(":account", Schema::accountKey(last.accountId));
+            query.bindValue(":account2", Schema::accountKey(last.accountId));
+            query.bindValue(":time", QDateTime::fromMSecsSinceEpoch(last.timeMSecs));
+            query.bindValue(":time2", QDateTime::fromMSecsSinceEpoch(last.timeMSecs));
+            query.bindValue(":id", last.transactionId);
+        }
+
+        if (!query.exec()) {
+            qDebug() << "读取分区数据失败:" << query.lastError().text();
+            error = true;
+            return;
+        }
+
+        page.clear();
+        position = 0;
+        while (query.next()) {
+            ArchivedTransaction row;
+            row.transactionId = query.value(0).toLongLong();
+            row.accountId = query.value(1).toString();
+            row.amountCents = Money::toCents(query.value(3));
+            row.timeMSecs = query.value(6).toDateTime().toMSecsSinceEpoch();
+            if (credit) {
+                // 归档文件按账户存放，转账的贷方分录展开为转入方的“收款”记录
+                row.type = QStringLiteral("收款");
+                row.targetAccount = query.value(4).toString();
+                row.description = Journal::creditDescription(query.value(5).toString());
+            } else {
+                row.type = Schema::transactionTypeName(query.value(2).toInt());   // 归档文件仍存名称
+                row.targetAccount = Schema::accountId(query.value(4));
+                row.description = query.value(5).toString();
+            }
+            page.append(row);
+        }
+        query.finish();
+        exhausted = page.size() < kArchiveBatchRows;
+    }
+};
+
+// 逐块写入归档文件，同时计算整个文件的 SHA-256
+class ArchiveWriter
+{
+public:
+    explicit ArchiveWriter(const QString& filePath)
+        : file(filePath)
+        , hash(QCryptographicHash::Sha256)
+    {
+    }
+
+    bool open()
+    {
+        if (!file.open(QIODevice::WriteOnly)) {
+            qDebug() << "无法创建归档文件:" << file.fileName() << file.errorString();
+            return false;
+        }
+        QByteArray header;
+        QDataStream stream(&header, QIODevice::WriteOnly);
+        stream.setVersion(QDataStream::Qt_5_15);
+        stream << kArchiveMagic << kArchiveVersion;
+        return write(header);
+    }
+
+    // 记录须按 archiveOrder 的顺序追加
+    bool append(const ArchivedTransaction& row)
+    {
+        pending.append(row);
+        return pending.size() < kArchiveBlockRows || flushBlock();
+    }
+
+    bool finish(QString& checksum)
+    {
+        if (!flushBlock()) return false;
+
+        QByteArray index;
+        {
+            QDataStream stream(&index, QIODevice::WriteOnly);
+            stream.setVersion(QDataStream::Qt_5_15);
+            stream << quint32(blocks.size());
+            for (const ArchiveBlock& block : blocks) {
+                stream << block.offset << block.rowCount << block.firstAccount << block.firstTimeMSecs
+                       << block.lastAccount << block.lastTimeMSecs;
+            }
+            stream << offset << kArchiveMagic;   // 末尾定长：索引偏移与魔数
+        }
+        if (!write(index)) return false;
+
+        if (!file.commit()) {
+            qDebug() << "写入归档文件失败:" << file.fileName() << file.errorString();
+            return false;
+        }
+        checksum = QString::fromLatin1(hash.result().toHex());
+        return true;
+    }
+
+private:
+    QSaveFile file;
+    QCryptographicHash hash;
+    qint64 offset = 0;
+    QVector<ArchivedTransaction> pending;
+    QVector<ArchiveBlock> blocks;
+
+    bool write(const QByteArray& data)
+    {
+        if (file.write(data) != data.size()) {
+            qDebug() << "写入归档文件失败:" << file.fileName() << file.errorString();
+            return false;
+        }
+        hash.addData(data);
+        offset += data.size();
+        return true;
+    }
+
+    bool flushBlock()
+    {
+        if (pending.isEmpty()) return true;
+
+        QByteArray payload;
+        {
+            QDataStream stream(&payload, QIODevice::WriteOnly);
+            stream.setVersion(QDataStream::Qt_5_15);
+            stream << quint32(pending.size());
+            for (const ArchivedTransaction& row : pending) writeRow(stream, row);
+        }
+
+        ArchiveBlock block;
+        block.offset = offset;
+        block.rowCount = quint32(pending.size());
+        block.firstAccount = pending.first().accountId.toULongLong();
+        block.firstTimeMSecs = pending.first().timeMSecs;
+        block.lastAccount = pending.last().accountId.toULongLong();
+        block.lastTimeMSecs = pending.last().timeMSecs;
+
+        QByteArray data;
+        {
+            QDataStream stream(&data, QIODevice::WriteOnly);
+            stream.setVersion(QDataStream::Qt_5_15);
+            stream << qCompress(payload, 9);
+        }
+        if (!write(data)) return false;
+
+        blocks.append(block);
+        pending.clear();
+        return true;
+    }
+};
+
+// 读取新格式文件的块索引
+bool readBlockIndex(QFile& file, QVector<ArchiveBlock>& blocks)
+{
+    const qint64 size = file.size();
+    if (size < 8 + kTrailerBytes || !file.seek(size - kTrailerBytes)) return false;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_15);
+    qint64 indexOffset = 0;
+    quint32 magic = 0;
+    stream >> indexOffset >> magic;
+    if (magic != kArchiveMagic || indexOffset < 8 || indexOffset > size - kTrailerBytes
+        || !file.seek(indexOffset)) {
+        return false;
+    }
+
+    quint32 count = 0;
+    stream >> count;
+    blocks.clear();
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        ArchiveBlock block;
+        stream >> block.offset >> block.rowCount >> block.firstAccount >> block.firstTimeMSecs
+               >> block.lastAccount >> block.lastTimeMSecs;
+        blocks.append(block);
+    }
+    return stream.status() == QDataStream::Ok && quint32(blocks.size()) == count;
+}
+
+// 读取文件头，返回格式版本，不是归档文件时返回 0
+quint32 readArchiveVersion(QFile& file)
+{
+    if (!file.seek(0)) return 0;
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_15);
+    quint32 magic = 0;
+    quint32 version = 0;
+    stream >> magic >> version;
+    if (stream.status() != QDataStream::Ok || magic != kArchiveMagic) return 0;
+    return version;
+}
+
+bool readBlockAt(QFile& file, qint64 offset, QVector<ArchivedTransaction>& rows)
+{
+    if (!file.seek(offset)) return false;
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_15);
+    QByteArray compressed;
+    stream >> compressed;
+    return stream.status() == QDataStream::Ok && decodeBlock(compressed, rows);
+}
+}
+
+TransactionArchiver::TransactionArchiver(const QString& sourceConnectionName, QObject* parent)
+    : QObject(parent)
+    , sourceConnection(sourceConnectionName)
+    , workerConnection(sourceConnectionName + "_archiver")
+    , directory(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/archive")
+    , retention(12)
+    , timer(nullptr)
+    , indexCache(kIndexCacheBlocks)
+    , blockCache(kBlockCacheRows)
+{
+}
+
+TransactionArchiver::~TransactionArchiver()
+{
+}
+
+void TransactionArchiver::setArchiveDirectory(const QString& dir)
+{
+    directory = dir;
+}
+
+QString TransactionArchiver::archiveDirectory() const
+{
+    return directory;
+}
+
+void TransactionArchiver::setRetentionMonths(int months)
+{
+    retention = qMax(1, months);
+}
+
+int TransactionArchiver::retentionMonths() const
+{
+    return retention;
+}
+
+QString TransactionArchiver::partitionName(const QDate& month)
+{
+    return QString("p%1").arg(month.toString("yyyyMM"));
+}
+
+void TransactionArchiver::start(int intervalMs)
+{
+    if (!timer) {
+        timer = new QTimer(this);
+        connect(timer, &QTimer::timeout, this, &TransactionArchiver::runMaintenance);
+    }
+    timer->start(intervalMs);
+
+    // 启动后立即执行一次，补齐未来分区
+    runMaintenance();
+}
+
+void TransactionArchiver::stop()
+{
+    if (timer) {
+        timer->stop();
+    }
+
+    if (QSqlDatabase::contains(workerConnection)) {
+        {
+            QSqlDatabase db = QSqlDatabase::database(workerConnection, false);
+            db.close();
+        }
+        QSqlDatabase::removeDatabase(workerConnection);
+    }
+}
+
+bool TransactionArchiver::openWorkerConnection()
+{
+    if (!QSqlDatabase::contains(workerConnection)) {
+        if (!QSqlDatabase::contains(sourceConnection)) {
+            qDebug() << "归档线程：主连接不存在";
+            return false;
+        }
+        QSqlDatabase::cloneDatabase(sourceConnection, workerConnection);
+    }
+
+    QSqlDatabase db = QSqlDatabase::database(workerConnection, false);
+    if (!DbError::ensureOpen(db)) {
+        qDebug() << "归档线程连接失败:" << db.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+bool TransactionArchiver::runMaintenance()
+{
+    if (!openWorkerConnection()) {
+        emit maintenanceFinished(false);
+        return false;
+    }
+
+    QSqlDatabase db = QSqlDatabase::database(workerConnection, false);
+    QSqlQuery lockQuery(db);
+
+    // 多个客户端同时运行时只允许一个执行归档
+    if (!lockQuery.exec("SELECT GET_LOCK('banksystem_archiver', 0)") || !lockQuery.next()
+        || lockQuery.value(0).toInt() != 1) {
+        qDebug() << "归档任务已由其他实例执行，跳过";
+        emit maintenanceFinished(true);
+        return true;
+    }
+
+    bool success = ensureFuturePartitions(db, 3);
+
+    // 保留期之前的月份分区需要归档
+    const QDate currentMonth(QDate::currentDate().year(), QDate::currentDate().month(), 1);
+    const QDate cutoff = currentMonth.addMonths(-retention);
+
+    QSqlQuery query(db);
+    query.prepare("SELECT PARTITION_NAME FROM information_schema.PARTITIONS "
+                  "WHERE TABLE_SCHEMA = DATABASE() AND TABLE_NAME = 'transactions' "
+                  "AND PARTITION_NAME IS NOT NULL ORDER BY PARTITION_ORDINAL_POSITION");
+
+    QStringList expired;
+    if (query.exec()) {
+        static const QRegularExpression monthPattern("^p(\\d{6})$");
+        while (query.next()) {
+            const QString name = query.value(0).toString();
+            const QRegularExpressionMatch match = monthPattern.match(name);
+            if (!match.hasMatch()) continue;
+
+            const QDate month = QDate::fromString(match.captured(1) + "01", "yyyyMMdd");
+            if (month.isValid() && month < cutoff) {
+                expired.append(name);
+            }
+        }
+    } else {
+        qDebug() << "读取分区信息失败:" << query.lastError().text();
+        success = false;
+    }
+
+    for (const QString& name : expired) {
+        const QDate month = QDate::fromString(name.mid(1) + "01", "yyyyMMdd");
+        if (!archivePartition(db, name, month)) {
+            success = false;
+            break;
+        }
+    }
+
+    lockQuery.exec("SELECT RELEASE_LOCK('banksystem_archiver')");
+    emit maintenanceFinished(success);
+    return success;
+}
+
+// 在 pmax 前补齐未来若干个月的分区，pmax 通常为空，REORGANIZE 代价很小
+bool TransactionArchiver::ensureFuturePartitions(QSqlDatabase& db, int monthsAhead)
+{
+    QSqlQuery query(db);
+    query.prepare("SELECT PARTITION_NAME FROM information_schema.PARTITIONS "
+                  "WHERE TABLE_SCHEMA = DATABASE() AND TABLE_NAME = 'transactions' "
+                  "AND PARTITION_NAME IS NOT NULL");
+
+    if (!query.exec()) {
+        qDebug() << "读取分区信息失败:" << query.lastError().text();
+        return false;
+    }
+
+    QStringList existing;
+    while (query.next()) {
+        existing.append(query.value(0).toString());
+    }
+
+    if (!existing.contains("pmax")) {
+        qDebug() << "transactions 表尚未分区，请先执行 migrations/001_partition_transactions.sql";
+        return false;
+    }
+
+    QDate lastMonth;
+    for (const QString& name : existing) {
+        const QDate month = QDate::fromString(name.mid(1) + "01", "yyyyMMdd");
+        if (month.isValid() && (!lastMonth.isValid() || month > lastMonth)) {
+            lastMonth = month;
+        }
+    }
+
+    const QDate currentMonth(QDate::currentDate().year(), QDate::currentDate().month(), 1);
+    const QDate targetMonth = currentMonth.addMonths(monthsAhead);
+
+    QDate month = lastMonth.isValid() ? lastMonth.addMonths(1) : currentMonth;
+    if (month > targetMonth) {
+        return true;
+    }
+
+    QStringList definitions;
+    for (; month <= targetMonth; month = month.addMonths(1)) {
+        definitions.append(QString("PARTITION %1 VALUES LESS THAN (UNIX_TIMESTAMP('%2 00:00:00'))")
+                               .arg(partitionName(month))
+                               .arg(month.addMonths(1).toString("yyyy-MM-dd")));
+    }
+    definitions.append("PARTITION pmax VALUES LESS THAN MAXVALUE");
+
+    const QString sql = QString("ALTER TABLE transactions REORGANIZE PARTITION pmax INTO (%1)")
+                            .arg(definitions.join(", "));
+    if (!query.exec(sql)) {
+        qDebug() << "创建未来分区失败:" << query.lastError().text();
+        return false;
+    }
+
+    qDebug() << "已补齐交易表分区至" << targetMonth.toString("yyyy-MM");
+    return true;
+}
+
+bool TransactionArchiver::archivePartition(QSqlDatabase& db, const QString& partition,
+                                           const QDate& month)
+{
+    qDebug() << "开始归档分区:" << partition;
+
+    QDir().mkpath(directory);
+    const QString filePath = QDir(directory).filePath(QString("transactions_%1.bkar").arg(partition));
+
+    // 借方与贷方两路各按索引顺序分页读取，归并后直接写入文件，内存中只有两页记录与一个块。
+    // 分页读取放在一个只读事务中，各页读到同一快照
+    if (!db.transaction()) {
+        qDebug() << "开始事务失败";
+        return false;
+    }
+
+    PartitionStream debits(db, partition, false);
+    PartitionStream credits(db, partition, true);
+    ArchiveWriter writer(filePath);
+    QHash<QString, qint64> flows;
+    qint64 rowCount = 0;
+    QString checksum;
+    bool written = true;
+
+    for (;;) {
+        const ArchivedTransaction* debit = debits.peek();
+        const ArchivedTransaction* credit = credits.peek();
+        if (!debit && !credit) break;
+
+        const ArchivedTransaction row = (!credit || (debit && archiveOrder(*debit, *credit)))
+                                            ? debits.take() : credits.take();
+        if ((rowCount == 0 && !writer.open()) || !writer.append(row)) {
+            written = false;
+            break;
+        }
+        flows[row.accountId] += Money::postingSign(row.type) * row.amountCents;
+        ++rowCount;
+    }
+    written = written && !debits.failed() && !credits.failed() && (rowCount == 0 || writer.finish(checksum));
+    db.commit();
+    if (!written) return false;   // 未提交的文件由 QSaveFile 丢弃
+
+    QSqlQuery query(db);
+    if (rowCount > 0) {
+        // 回读校验，确认文件完整后才删除分区
+        qint64 verifiedRows = 0;
+        QString verifyChecksum;
+        if (!verifyArchiveFile(filePath, verifiedRows, verifyChecksum)
+            || verifiedRows != rowCount || verifyChecksum != checksum) {
+            qDebug() << "归档文件校验失败:" << filePath;
+            return false;
+        }
+
+        // 登记归档与结转账户净额放在同一事务中，对账时归档数据不会丢失或重复
+        if (!db.transaction()) {
+            qDebug() << "开始事务失败";
+            return false;
+        }
+
+        query.prepare("INSERT INTO transaction_archives "
+                      "(partition_name, range_start, range_end, file_path, row_count, checksum) "
+                      "VALUES (:partition, :range_start, :range_end, :file_path, :row_count, :checksum)");
+        query.bindValue(":partition", partition);
+        query.bindValue(":range_start", QDateTime(month, QTime(0, 0)));
+        query.bindValue(":range_end", QDateTime(month.addMonths(1), QTime(0, 0)));
+        query.bindValue(":file_path", filePath);
+        query.bindValue(":row_count", rowCount);
+        query.bindValue(":checksum", checksum);
+
+        if (!query.exec() || !applyArchivedFlows(db, flows, 1) || !db.commit()) {
+            qDebug() << "登记归档文件失败:" << query.lastError().text();
+            db.rollback();
+            return false;
+        }
+
+        if (!query.exec(QString("ALTER TABLE transactions DROP PARTITION %1").arg(partition))) {
+            qDebug() << "删除分区失败:" << query.lastError().text();
+
+            // 撤销登记，避免历史查询与对账同时读到分区和归档中的重复记录
+            db.transaction();
+            query.prepare("DELETE FROM transaction_archives WHERE partition_name = :partition");
+            query.bindValue(":partition", partition);
+            if (query.exec() && applyArchivedFlows(db, flows, -1)) {
+                db.commit();
+            } else {
+                db.rollback();
+            }
+            return false;
+        }
+    } else if (!query.exec(QString("ALTER TABLE transactions DROP PARTITION %1").arg(partition))) {
+        qDebug() << "删除分区失败:" << query.lastError().text();
+        return false;
+    }
+
+    qDebug() << "分区归档完成:" << partition << "记录数:" << rowCount;
+    emit partitionArchived(partition, int(rowCount));
+    return true;
+}
+
+// 将归档分区的账户净额累加到 archived_account_flows，sign 为 -1 时撤销
+bool TransactionArchiver::applyArchivedFlows(QSqlDatabase& db, const QHash<QString, qint64>& flows,
+                                             int sign)
+{
+    const int batchSize = 500;
+    QSqlQuery query(db);
+
+    auto it = flows.constBegin();
+    while (it != flows.constEnd()) {
+        QStringList placeholders;
+        QVariantList values;
+        for (int i = 0; i < batchSize && it != flows.constEnd(); ++i, ++it) {
+            placeholders << "(?, ?)";
+            values << Schema::accountKey(it.key()) << Money::toDecimalString(sign * it.value());
+        }
+
+        query.prepare("INSERT INTO archived_account_flows (account_id, net_amount) VALUES "
+                      + placeholders.join(", ")
+                      + " ON DUPLICATE KEY UPDATE net_amount = net_amount + VALUES(net_amount)");
+        for (int i = 0; i < values.size(); ++i) {
+            query.bindValue(i, values.at(i));
+        }
+
+        if (!query.exec()) {
+            qDebug() << "结转归档净额失败:" << query.lastError().text();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool TransactionArchiver::readArchiveFile(const QString& filePath,
+                                          QVector<ArchivedTransaction>& rows,
+                                          QString* checksum)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qDebug() << "无法打开归档文件:" << filePath;
+        return false;
+    }
+
+    if (checksum) {
+        QCryptographicHash hash(QCryptographicHash::Sha256);
+        hash.addData(&file);
+        *checksum = QString::fromLatin1(hash.result().toHex());
+    }
+
+    rows.clear();
+    const quint32 version = readArchiveVersion(file);
+    if (version == kLegacyArchiveVersion) {
+        // 旧格式：头部之后是整个文件的压缩数据
+        QDataStream stream(&file);
+        stream.setVersion(QDataStream::Qt_5_15);
+        QByteArray compressed;
+        stream >> compressed;
+        return stream.status() == QDataStream::Ok && decodeBlock(compressed, rows);
+    }
+
+    QVector<ArchiveBlock> blocks;
+    if (version != kArchiveVersion || !readBlockIndex(file, blocks)) {
+        qDebug() << "归档文件格式错误:" << filePath;
+        return false;
+    }
+
+    QVector<ArchivedTransaction> blockRows;
+    for (const ArchiveBlock& block : blocks) {
+        if (!readBlockAt(file, block.offset, blockRows)) return false;
+        rows += blockRows;
+    }
+    return true;
+}
+
+bool TransactionArchiver::verifyArchiveFile(const QString& filePath, qint64& rowCount, QString& checksum)
+{
+    rowCount = 0;
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qDebug() << "无法打开归档文件:" << filePath;
+        return false;
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(&file);
+    checksum = QString::fromLatin1(hash.result().toHex());
+
+    QVector<ArchiveBlock> blocks;
+    if (readArchiveVersion(file) != kArchiveVersion || !readBlockIndex(file, blocks)) {
+        qDebug() << "归档文件格式错误:" << filePath;
+        return false;
+    }
+
+    // 逐块解压，检查记录数、块内顺序以及与索引中首尾记录是否一致
+    QVector<ArchivedTransaction> rows;
+    const ArchivedTransaction* previous = nullptr;
+    ArchivedTransaction last;
+    for (const ArchiveBlock& block : blocks) {
+        if (!readBlockAt(file, block.offset, rows) || rows.isEmpty() || quint32(rows.size()) != block.rowCount
+            || rows.first().accountId.toULongLong() != block.firstAccount
+            || rows.first().timeMSecs != block.firstTimeMSecs
+            || rows.last().accountId.toULongLong() != block.lastAccount
+            || rows.last().timeMSecs != block.lastTimeMSecs) {
+            return false;
+        }
+        for (const ArchivedTransaction& row : rows) {
+            if (previous && !archiveOrder(*previous, row)) return false;
+            last = row;
+            previous = &last;
+        }
+        rowCount += rows.size();
+    }
+    return true;
+}
+
+bool TransactionArchiver::archiveIndex(const QString& filePath, QVector<ArchiveBlock>& blocks, bool& legacy)
+{
+    legacy = false;
+    {
+        QMutexLocker locker(&cacheMutex);
+        if (const QVector<ArchiveBlock>* cached = indexCache.object(filePath)) {
+            blocks = *cached;
+            return true;
+        }
+    }
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qDebug() << "无法打开归档文件:" << filePath;
+        return false;
+    }
+
+    const quint32 version = readArchiveVersion(file);
+    if (version == kLegacyArchiveVersion) {
+        legacy = true;
+        return false;
+    }
+    if (version != kArchiveVersion || !readBlockIndex(file, blocks)) {
+        qDebug() << "归档文件格式错误:" << filePath;
+        return false;
+    }
+
+    QMutexLocker locker(&cacheMutex);
+    indexCache.insert(filePath, new QVector<ArchiveBlock>(blocks), qMax(1, int(blocks.size())));
+    return true;
+}
+
+bool TransactionArchiver::archiveBlock(QFile& file, const QString& filePath, const ArchiveBlock& block,
+                                       QVector<ArchivedTransaction>& rows)
+{
+    const QString key = filePath + '#' + QString::number(block.offset);
+    {
+        QMutexLocker locker(&cacheMutex);
+        if (const QVector<ArchivedTransaction>* cached = blockCache.object(key)) {
+            rows = *cached;
+            return true;
+        }
+    }
+
+    if (!file.isOpen() && !file.open(QIODevice::ReadOnly)) {
+        qDebug() << "无法打开归档文件:" << filePath;
+        return false;
+    }
+    if (!readBlockAt(file, block.offset, rows)) {
+        qDebug() << "归档文件损坏:" << filePath << "块偏移" << block.offset;
+        return false;
+    }
+
+    QMutexLocker locker(&cacheMutex);
+    blockCache.insert(key, new QVector<ArchivedTransaction>(rows), qMax(1, int(rows.size())));
+    return true;
+}
+
+QList<QVariantMap> TransactionArchiver::readArchivedHistory(QSqlDatabase& db,
+                                                            const QString& accountId,
+                                                            const QDateTime& from,
+                                                            const QDateTime& to)
+{
+    QList<QVariantMap> history;
+
+    QSqlQuery query(db);
+    query.prepare("SELECT file_path FROM transaction_archives "
+                  "WHERE range_end > :from AND range_start < :to "
+                  "ORDER BY range_start DESC");
+    query.bindValue(":from", from.isValid() ? from : QDateTime::fromMSecsSinceEpoch(0));
+    query.bindValue(":to", to.isValid() ? to : QDateTime(QDate(2099, 12, 31), QTime(0, 0)));
+
+    if (!query.exec()) {
+        qDebug() << "读取归档索引失败:" << query.lastError().text();
+        return history;
+    }
+
+    const quint64 account = accountId.toULongLong();
+    const qint64 fromMSecs = from.isValid() ? from.toMSecsSinceEpoch() : std::numeric_limits<qint64>::min();
+    const qint64 toMSecs = to.isValid() ? to.toMSecsSinceEpoch() : std::numeric_limits<qint64>::max();
+
+    // 按文件内顺序，记录在查询范围之前（账户更小，或同一账户但时间不早于 to）/ 之后（账户更大，或早于 from）
+    auto before = [account, toMSecs](quint64 rowAccount, qint64 timeMSecs) {
+        return rowAccount < account || (rowAccount == account && timeMSecs >= toMSecs);
+    };
+    auto after = [account, fromMSecs](quint64 rowAccount, qint64 timeMSecs) {
+        return rowAccount > account || (rowAccount == account && timeMSecs < fromMSecs);
+    };
+    auto appendRecord = [&history](const ArchivedTransaction& row) {
+        QVariantMap record;
+        record["id"] = row.transactionId;
+        record["type"] = row.type;
+        record["amount"] = Money::toYuan(row.amountCents);
+        record["target"] = row.targetAccount;
+        record["description"] = row.description;
+        record["time"] = QDateTime::fromMSecsSinceEpoch(row.timeMSecs);
+        record["archived"] = true;
+        history.append(record);
+    };
+
+    while (query.next()) {
+        QString filePath = query.value(0).toString();
+        if (!QFileInfo::exists(filePath)) {
+            // 归档目录迁移后按文件名在当前目录查找
+            filePath = QDir(directory).filePath(QFileInfo(filePath).fileName());
+        }
+
+        QVector<ArchiveBlock> blocks;
+        bool legacy = false;
+        if (!archiveIndex(filePath, blocks, legacy)) {
+            if (!legacy) continue;
+
+            // 旧格式文件没有块索引，只能整体解压；按账户、时间升序存放，取出后倒序输出
+            QVector<ArchivedTransaction> rows;
+            if (!readArchiveFile(filePath, rows)) continue;
+            QVector<ArchivedTransaction> matched;
+            for (const ArchivedTransaction& row : rows) {
+                if (row.accountId == accountId && row.timeMSecs >= fromMSecs && row.timeMSecs < toMSecs) {
+                    matched.append(row);
+                }
+            }
+            std::sort(matched.begin(), matched.end(), archiveOrder);
+            for (const ArchivedTransaction& row : matched) appendRecord(row);
+            continue;
+        }
+
+        // 块按文件内顺序排列：跳过末条仍在范围之前的块，读到首条已在范围之后的块为止
+        auto it = std::partition_point(blocks.cbegin(), blocks.cend(), [&before](const ArchiveBlock& block) {
+            return before(block.lastAccount, block.lastTimeMSecs);
+        });
+
+        QFile file(filePath);
+        QVector<ArchivedTransaction> rows;
+        for (; it != blocks.cend() && !after(it->firstAccount, it->firstTimeMSecs); ++it) {
+            if (!archiveBlock(file, filePath, *it, rows)) break;
+
+            // 块内已是时间倒序，与在线查询的输出顺序一致
+            for (const ArchivedTransaction& row : rows) {
+                const quint64 rowAccount = row.accountId.toULongLong();
+                if (before(rowAccount, row.timeMSecs)) continue;
+                if (after(rowAccount, row.timeMSecs)) break;
+                appendRecord(row);
+            }
+        }
+    }
+
+    return history;
+}
@@ -0,0 +1,107 @@
+#ifndef TRANSACTIONARCHIVER_H
+#define TRANSACTIONARCHIVER_H
+
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QVariantMap>
+#include <QDateTime>
+#include <QCache>
+#include <QMutex>
+#include <QVector>
+#include <QHash>
+
+class QTimer;
+class QFile;
+class QSqlDatabase;
+
+// 归档文件中的一条交易记录
+struct ArchivedTransaction
+{
+    qint64 transactionId = 0;
+    QString accountId;
+    QString type;
+    qint64 amountCents = 0;
+    QString targetAccount;
+    QString description;
+    qint64 timeMSecs = 0;
+};
+
+// 归档文件中一个压缩块的位置与首尾记录，用于按账户与时间定位
+struct ArchiveBlock
+{
+    qint64 offset = 0;
+    quint32 rowCount = 0;
+    quint64 firstAccount = 0;
+    qint64 firstTimeMSecs = 0;
+    quint64 lastAccount = 0;
+    qint64 lastTimeMSecs = 0;
+};
+
+// 交易表冷数据归档
+// transactions 按月 RANGE 分区（pYYYYMM），超过保留期的分区被导出为压缩文件后删除，
+// 归档文件登记在 transaction_archives 表中，查询历史时透明读取。
+// 导出按 (账户, 时间倒序) 键集分页读取分区，边读边写，内存中只有一页记录与一个块。
+// 文件由若干压缩块组成，块内记录按账户升序、时间倒序排列，文件末尾是各块首尾记录的索引：
+// 查询一个账户一段时间的历史只解压与之相交的块。
+class TransactionArchiver : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit TransactionArchiver(const QString& sourceConnectionName, QObject* parent = nullptr);
+    ~TransactionArchiver();
+
+    void setArchiveDirectory(const QString& directory);
+    QString archiveDirectory() const;
+    void setRetentionMonths(int months);
+    int retentionMonths() const;
+
+    // 读取指定账户在时间范围内的归档交易（按时间倒序），可在任意线程调用
+    QList<QVariantMap> readArchivedHistory(QSqlDatabase& db,
+                                           const QString& accountId,
+                                           const QDateTime& from,
+                                           const QDateTime& to);
+
+    // 读取单个归档文件的全部记录，校验失败返回 false
+    static bool readArchiveFile(const QString& filePath, QVector<ArchivedTransaction>& rows,
+                                QString* checksum = nullptr);
+    // 逐块解压校验，不整体载入；rowCount 为记录数，checksum 为整个文件的 SHA-256
+    static bool verifyArchiveFile(const QString& filePath, qint64& rowCount, QString& checksum);
+
+    static QString partitionName(const QDate& month);
+
+public slots:
+    // 以下槽函数在归档线程中执行
+    void start(int intervalMs);
+    void stop();
+    bool runMaintenance();
+
+signals:
+    void partitionArchived(const QString& partition, int rowCount);
+    void maintenanceFinished(bool success);
+
+private:
+    QString sourceConnection;
+    QString workerConnection;
+    QString directory;
+    int retention;
+    QTimer* timer;
+
+    // 块索引常驻（每块一项），解压后的块只缓存最近用过的少量
+    QMutex cacheMutex;
+    QCache<QString, QVector<ArchiveBlock>> indexCache;
+    QCache<QString, QVector<ArchivedTransaction>> blockCache;
+
+    bool openWorkerConnection();
+    bool ensureFuturePartitions(QSqlDatabase& db, int monthsAhead);
+    bool archivePartition(QSqlDatabase& db, const QString& partition,
+                          const QDate& month);
+    bool applyArchivedFlows(QSqlDatabase& db, const QHash<QString, qint64>& flows, int sign);
+    // 文件的块索引（读一次后缓存）；旧格式（整体压缩、无索引）的文件返回 false 且 legacy 为 true
+    bool archiveIndex(const QString& filePath, QVector<ArchiveBlock>& blocks, bool& legacy);
+    bool archiveBlock(QFile& file, const QString& filePath, const ArchiveBlock& block,
+                      QVector<ArchivedTransaction>& rows);
+};
+
+#endif // TRANSACTIONARCHIVER_H
@@ -0,0 +1,359 @@
+#include "transferscheduler.h"
+#include "dberror.h"
+#include "money.h"
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QStringList>
+#include <QTimer>
+#include <QDebug>
+#include <climits>
+
+namespace {
+const int kTickIntervalMs = 1000;
+const int kBatchSize = 200;              // 每个事务最多执行的指令数
+const int kHorizonSecs = 24 * 60 * 60;   // 时间轮只跟踪未来一天内到期的指令
+const int kRefillIntervalSecs = 60;
+const int kRetryDelaySecs = 60;          // 单条指令执行失败后的重试间隔
+const int kLeaderRetryTicks = 30;
+
+const char* const kOrderColumns =
+    "SELECT order_id, from_account, to_account, amount, description, frequency, interval_count, "
+    "start_at, end_at, max_runs, runs_done, next_run_at, status FROM scheduled_transfers ";
+}
+
+TransferScheduler::TransferScheduler(const QString& sourceConnectionName, VelocityLimiter* limiter, QObject* parent)
+    : QObject(parent)
+    , sourceConnection(sourceConnectionName)
+    , workerConnection(sourceConnectionName + "_scheduler")
+    , limiter(limiter)
+    , timer(nullptr)
+    , leader(false)
+    , leaderRetryTicks(0)
+    , lastRefillSecs(0)
+{
+}
+
+TransferScheduler::~TransferScheduler()
+{
+}
+
+void TransferScheduler::start()
+{
+    if (!timer) {
+        timer = new QTimer(this);
+        connect(timer, &QTimer::timeout, this, &TransferScheduler::tick);
+    }
+
+    if (acquireLeadership()) {
+        catchUp();
+        refill();
+    }
+    timer->start(kTickIntervalMs);
+}
+
+void TransferScheduler::stop()
+{
+    if (timer) timer->stop();
+    releaseLeadership();
+
+    if (QSqlDatabase::contains(workerConnection)) {
+        {
+            QSqlDatabase db = QSqlDatabase::database(workerConnection, false);
+            db.close();
+        }
+        QSqlDatabase::removeDatabase(workerConnection);
+    }
+}
+
+bool TransferScheduler::openWorkerConnection()
+{
+    if (!QSqlDatabase::contains(workerConnection)) {
+        if (!QSqlDatabase::contains(sourceConnection)) {
+            qDebug() << "调度线程：主连接不存在";
+            return false;
+        }
+        QSqlDatabase::cloneDatabase(sourceConnection, workerConnection);
+    }
+
+    QSqlDatabase db = QSqlDatabase::database(workerConnection, false);
+    bool reopened = false;
+    if (!DbError::ensureOpen(db, connectionProbe, &reopened)) {
+        qDebug() << "调度线程连接失败:" << db.lastError().text();
+        leader = false;
+        return false;
+    }
+    // 执行锁随旧连接释放，重新竞争后再执行
+    if (reopened && leader) {
+        qDebug() << "定期转账调度连接已重建，失去执行权";
+        leader = false;
+        wheel = TimerWheel(QDateTime::currentSecsSinceEpoch());
+    }
+    return true;
+}
+
+bool TransferScheduler::acquireLeadership()
+{
+    if (!openWorkerConnection()) return false;
+
+    // 锁随连接存在，本进程退出或断线后由其他客户端接管
+    QSqlQuery query(QSqlDatabase::database(workerConnection, false));
+    if (!query.exec("SELECT GET_LOCK('banksystem_scheduler', 0)") || !query.next()
+        || query.value(0).toInt() != 1) {
+        return false;
+    }
+
+    leader = true;
+    wheel = TimerWheel(QDateTime::currentSecsSinceEpoch());
+    horizonEnd = QDateTime();
+    lastChangeScan = QDateTime();
+    qDebug() << "定期转账调度已启动";
+    return true;
+}
+
+void TransferScheduler::releaseLeadership()
+{
+    if (!leader) return;
+    leader = false;
+
+    QSqlQuery query(QSqlDatabase::database(workerConnection, false));
+    query.exec("SELECT RELEASE_LOCK('banksystem_scheduler')");
+}
+
+void TransferScheduler::tick()
+{
+    if (!leader) {
+        if (++leaderRetryTicks < kLeaderRetryTicks) return;
+        leaderRetryTicks = 0;
+        if (!acquireLeadership()) return;
+        catchUp();
+        refill();
+    }
+
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    if (now - lastRefillSecs >= kRefillIntervalSecs) {
+        refill();
+        if (!leader) return;
+    }
+
+    const QVector<qint64> due = wheel.advance(now);
+    if (due.isEmpty()) return;
+
+    int failed = 0;
+    int succeeded = 0;
+    for (int offset = 0; offset < due.size(); offset += kBatchSize) {
+        const QList<ScheduledTransfer> orders = loadDueOrders(due.mid(offset, kBatchSize));
+        if (!orders.isEmpty()) {
+            executeBatch(orders, succeeded, failed);
+        }
+    }
+
+    if (succeeded + failed > 0) {
+        emit batchExecuted(succeeded, failed);
+    }
+}
+
+// 停机期间错过的指令：按到期顺序分批补执行，每期各记一次结果
+void TransferScheduler::catchUp()
+{
+    if (!openWorkerConnection()) return;
+
+    QSqlQuery query(QSqlDatabase::database(workerConnection, false));
+    query.prepare(QString(kOrderColumns)
+                  + "WHERE status = 'active' AND next_run_at <= NOW() "
+                    "ORDER BY next_run_at, order_id LIMIT " + QString::number(kBatchSize));
+
+    int succeeded = 0;
+    int failed = 0;
+    for (;;) {
+        if (!query.exec()) {
+            qDebug() << "读取逾期定期转账失败:" << query.lastError().text();
+            break;
+        }
+        const QList<ScheduledTransfer> orders = loadOrders(query);
+        if (orders.isEmpty()) break;
+
+        const int executed = executeBatch(orders, succeeded, failed);
+        // 整批都无法执行时停止，剩余的由时间轮按重试间隔处理
+        if (executed == 0) break;
+    }
+
+    if (succeeded + failed > 0) {
+        qDebug() << "补执行逾期定期转账:" << succeeded << "成功," << failed << "失败";
+        emit batchExecuted(succeeded, failed);
+    }
+}
+
+// 补入新进入时间窗口的指令，并同步其他客户端修改过的指令
+void TransferScheduler::refill()
+{
+    lastRefillSecs = QDateTime::currentSecsSinceEpoch();
+    if (!openWorkerConnection()) return;
+
+    QSqlDatabase db = QSqlDatabase::database(workerConnection, false);
+    QSqlQuery query(db);
+
+    // 确认仍持有锁；连接曾断开时锁已释放
+    if (!query.exec("SELECT IS_USED_LOCK('banksystem_scheduler') = CONNECTION_ID()") || !query.next()
+        || query.value(0).toInt() != 1) {
+        qDebug() << "定期转账调度失去执行权";
+        leader = false;
+        wheel = TimerWheel(lastRefillSecs);
+        return;
+    }
+
+    // 先取时间点再扫描，扫描期间的修改留给下一轮
+    QDateTime scanStart;
+    if (query.exec("SELECT NOW()") && query.next()) {
+        scanStart = query.value(0).toDateTime();
+    }
+    if (lastChangeScan.isValid()) {
+        query.prepare(QString(kOrderColumns) + "WHERE updated_at >= :since ORDER BY updated_at, order_id");
+        query.bindValue(":since", lastChangeScan);
+        if (query.exec()) {
+            for (const ScheduledTransfer& order : loadOrders(query)) track(order);
+        }
+    }
+    lastChangeScan = scanStart;
+
+    // 按 (next_run_at, order_id) 键集分页，每页走 (status, next_run_at) 索引
+    const QDateTime previousHorizon = horizonEnd;
+    const QDateTime epoch = QDateTime::fromSecsSinceEpoch(0);
+    QDateTime lastDue = previousHorizon.isValid() ? previousHorizon : epoch;
+    qint64 lastId = previousHorizon.isValid() ? LLONG_MAX : 0;
+    horizonEnd = QDateTime::currentDateTime().addSecs(kHorizonSecs);
+    for (;;) {
+        query.prepare(QString(kOrderColumns)
+                      + "WHERE status = 'active' AND next_run_at <= :horizon "
+                        "AND (next_run_at > :last_due OR (next_run_at = :same_due AND order_id > :last_id)) "
+                        "ORDER BY next_run_at, order_id LIMIT 1000");
+        query.bindValue(":horizon", horizonEnd);
+        query.bindValue(":last_due", lastDue);
+        query.bindValue(":same_due", lastDue);
+        query.bindValue(":last_id", lastId);
+        if (!query.exec()) {
+            qDebug() << "读取定期转账失败:" << query.lastError().text();
+            horizonEnd = previousHorizon;
+            return;
+        }
+
+        const QList<ScheduledTransfer> orders = loadOrders(query);
+        for (const ScheduledTransfer& order : orders) track(order);
+        if (orders.size() < 1000) break;
+        lastDue = orders.last().dueAt;
+        lastId = orders.last().orderId;
+    }
+}
+
+void TransferScheduler::reloadOrder(qint64 orderId)
+{
+    if (!leader || !openWorkerConnection()) return;
+
+    QSqlQuery query(QSqlDatabase::database(workerConnection, false));
+    query.prepare(QString(kOrderColumns) + "WHERE order_id = :order_id");
+    query.bindValue(":order_id", orderId);
+    if (!query.exec()) return;
+
+    const QList<ScheduledTransfer> orders = loadOrders(query);
+    if (orders.isEmpty()) {
+        wheel.cancel(orderId);
+    } else {
+        track(orders.first());
+    }
+}
+
+// 窗口内的活动指令放入时间轮，其余移出
+void TransferScheduler::track(const ScheduledTransfer& order)
+{
+    const QDateTime limit = horizonEnd.isValid()
+                                ? horizonEnd
+                                : QDateTime::currentDateTime().addSecs(kHorizonSecs);
+    if (order.dueAt.isValid() && order.dueAt <= limit) {
+        wheel.schedule(order.orderId, order.dueAt.toSecsSinceEpoch());
+    } else {
+        wheel.cancel(order.orderId);
+    }
+}
+
+// 读取 kOrderColumns 的结果，非 active 的指令从时间轮中移除
+QList<ScheduledTransfer> TransferScheduler::loadOrders(QSqlQuery& query)
+{
+    QList<ScheduledTransfer> orders;
+    while (query.next()) {
+        ScheduledTransfer order;
+        order.orderId = query.value(0).toLongLong();
+        if (query.value(12).toString() != "active") {
+            wheel.cancel(order.orderId);
+            continue;
+        }
+        order.fromAccount = query.value(1).toString();
+        order.toAccount = query.value(2).toString();
+        order.amountCents = Money::toCents(query.value(3));
+        order.description = query.value(4).toString();
+        order.frequency = query.value(5).toString();
+        order.intervalCount = query.value(6).toInt();
+        order.startAt = query.value(7).toDateTime();
+        order.endAt = query.value(8).toDateTime();
+        order.maxRuns = query.value(9).toInt();
+        order.runsDone = query.value(10).toInt();
+        order.dueAt = query.value(11).toDateTime();
+        orders.append(order);
+    }
+    return orders;
+}
+
+QList<ScheduledTransfer> TransferScheduler::loadDueOrders(const QVector<qint64>& orderIds)
+{
+    if (orderIds.isEmpty() || !openWorkerConnection()) return {};
+
+    QStringList ids;
+    for (qint64 id : orderIds) ids.append(QString::number(id));
+
+    // 以数据库为准：时间轮中的条目可能已被其他客户端修改
+    QSqlQuery query(QSqlDatabase::database(workerConnection, false));
+    if (!query.exec(QString(kOrderColumns)
+                    + "WHERE order_id IN (" + ids.join(',') + ") AND next_run_at <= NOW() "
+                      "ORDER BY next_run_at, order_id")) {
+        qDebug() << "读取到期定期转账失败:" << query.lastError().text();
+        return {};
+    }
+    return loadOrders(query);
+}
+
+// 执行一批指令，返回已处理的指令数；整批失败时对半拆分，单条失败的稍后重试
+int TransferScheduler::executeBatch(const QList<ScheduledTransfer>& orders, int& succeeded, int& failed)
+{
+    QSqlDatabase db = QSqlDatabase::database(workerConnection, false);
+    QList<ScheduledRunResult> results;
+
+    if (!DatabaseManager::executeScheduledTransfers(db, orders, limiter, results)) {
+        if (orders.size() > 1) {
+            const int half = orders.size() / 2;
+            return executeBatch(orders.mid(0, half), succeeded, failed)
+                   + executeBatch(orders.mid(half), succeeded, failed);
+        }
+        qDebug() << "定期转账执行失败，稍后重试:" << orders.first().orderId;
+        wheel.schedule(orders.first().orderId, QDateTime::currentSecsSinceEpoch() + kRetryDelaySecs);
+        ++failed;
+        return 0;
+    }
+
+    for (const ScheduledRunResult& result : results) {
+        if (result.outcome == "success") {
+            ++succeeded;
+        } else {
+            ++failed;
+        }
+        if (result.orderStatus == "active") {
+            ScheduledTransfer next;
+            next.orderId = result.orderId;
+            next.dueAt = result.nextRunAt;
+            track(next);
+        } else {
+            wheel.cancel(result.orderId);
+        }
+        emit orderExecuted(result.orderId, result.outcome, result.message);
+    }
+
+    return results.size();
+}
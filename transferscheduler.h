@@ -0,0 +1,65 @@
+#ifndef TRANSFERSCHEDULER_H
+#define TRANSFERSCHEDULER_H
+
+#include <QObject>
+#include <QString>
+#include <QHash>
+#include <QList>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include "databasemanager.h"
+#include "timerwheel.h"
+
+class QTimer;
+class QSqlQuery;
+
+// 定期转账调度（在独立线程中运行）
+// 只有未来一天内到期的指令放入时间轮，更远的由 (status, next_run_at) 索引定期分页补入；
+// 到期指令按批次交给 DatabaseManager::executeScheduledTransfers 执行，批次失败时对半拆分重试。
+// 多个客户端同时运行时通过 GET_LOCK 选出唯一的执行者。
+class TransferScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    // limiter 为 DatabaseManager 的限额计数，定期转账与界面转账共用
+    TransferScheduler(const QString& sourceConnectionName, VelocityLimiter* limiter, QObject* parent = nullptr);
+    ~TransferScheduler();
+
+public slots:
+    // 以下槽函数在调度线程中执行
+    void start();
+    void stop();
+    void tick();
+    // 指令被创建、取消或修改后重新读取
+    void reloadOrder(qint64 orderId);
+
+signals:
+    void orderExecuted(qint64 orderId, const QString& outcome, const QString& message);
+    void batchExecuted(int succeeded, int failed);
+
+private:
+    QString sourceConnection;
+    QString workerConnection;
+    VelocityLimiter* limiter;
+    QElapsedTimer connectionProbe;
+    QTimer* timer;
+    TimerWheel wheel;
+    bool leader;
+    int leaderRetryTicks;
+    QDateTime horizonEnd;         // 时间轮已覆盖到的时间
+    QDateTime lastChangeScan;     // 已扫描到的 updated_at
+    qint64 lastRefillSecs;
+
+    bool openWorkerConnection();
+    bool acquireLeadership();
+    void releaseLeadership();
+    void catchUp();
+    void refill();
+    void track(const ScheduledTransfer& order);
+    QList<ScheduledTransfer> loadOrders(QSqlQuery& query);
+    QList<ScheduledTransfer> loadDueOrders(const QVector<qint64>& orderIds);
+    int executeBatch(const QList<ScheduledTransfer>& orders, int& succeeded, int& failed);
+};
+
+#endif // TRANSFERSCHEDULER_H
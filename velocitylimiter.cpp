@@ -0,0 +1,292 @@
+#include "velocitylimiter.h"
+#include "money.h"
+#include "schema.h"
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QDateTime>
+#include <QMutexLocker>
+#include <QDebug>
+
+namespace {
+const qint64 kSecsPerHour = 3600;
+
+VelocityLimiter::Operation operationFromType(int transactionType, bool* ok)
+{
+    *ok = true;
+    if (transactionType == Schema::Withdraw) return VelocityLimiter::Withdraw;
+    if (transactionType == Schema::Transfer) return VelocityLimiter::Transfer;
+    *ok = false;
+    return VelocityLimiter::Withdraw;
+}
+}
+
+VelocityLimiter::VelocityLimiter()
+{
+}
+
+VelocityLimiter::Shard& VelocityLimiter::shardFor(const QString& accountId)
+{
+    return shards[qHash(accountId) % kShards];
+}
+
+const VelocityLimiter::Shard& VelocityLimiter::shardFor(const QString& accountId) const
+{
+    return shards[qHash(accountId) % kShards];
+}
+
+void VelocityLimiter::setLimits(const QString& accountType, Operation operation, const VelocityLimits& limits)
+{
+    QMutexLocker locker(&limitsMutex);
+    limitTable[operation].insert(accountType, limits);
+}
+
+VelocityLimits VelocityLimiter::limits(const QString& accountType, Operation operation) const
+{
+    QMutexLocker locker(&limitsMutex);
+    return limitTable[operation].value(accountType);
+}
+
+bool VelocityLimiter::loadLimits(QSqlDatabase& db)
+{
+    QSqlQuery query(db);
+    query.setNumericalPrecisionPolicy(QSql::HighPrecision);
+    // 配置按类型编码存储，计数与检查仍按类型名称（账户查询读出的就是名称）
+    if (!query.exec("SELECT t.type_name, v.operation, v.daily_amount, v.daily_count, v.hourly_amount, v.hourly_count "
+                    "FROM velocity_limits v JOIN account_types t ON t.type_code = v.type_code")) {
+        qDebug() << "读取交易限额失败:" << query.lastError().text();
+        return false;
+    }
+
+    QHash<QString, VelocityLimits> loaded[OperationCount];
+    while (query.next()) {
+        const QString operation = query.value(1).toString();
+        const int index = operation == "withdraw" ? Withdraw : (operation == "transfer" ? Transfer : -1);
+        if (index < 0) continue;
+
+        VelocityLimits limits;
+        limits.dailyAmountCents = Money::toCents(query.value(2));
+        limits.dailyCount = query.value(3).toInt();
+        limits.hourlyAmountCents = Money::toCents(query.value(4));
+        limits.hourlyCount = query.value(5).toInt();
+        loaded[index].insert(query.value(0).toString(), limits);
+    }
+
+    QMutexLocker locker(&limitsMutex);
+    for (int i = 0; i < OperationCount; ++i) limitTable[i] = loaded[i];
+    return true;
+}
+
+bool VelocityLimiter::rebuild(QSqlDatabase& db)
+{
+    for (Shard& shard : shards) {
+        QMutexLocker locker(&shard.mutex);
+        shard.accounts.clear();
+    }
+
+    // 按小时聚合，走 idx_transactions_time，只涉及最近的分区
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    query.setNumericalPrecisionPolicy(QSql::HighPrecision);
+    if (!query.exec(QString("SELECT account_id, transaction_type, UNIX_TIMESTAMP(transaction_time) DIV 3600, "
+                            "SUM(amount), COUNT(*) FROM transactions "
+                            "WHERE transaction_time >= NOW() - INTERVAL 24 HOUR "
+                            "AND transaction_type IN (%1, %2) "
+                            "GROUP BY 1, 2, 3").arg(Schema::Withdraw).arg(Schema::Transfer))) {
+        qDebug() << "重建交易限额计数失败:" << query.lastError().text();
+        return false;
+    }
+
+    int rows = 0;
+    while (query.next()) {
+        bool ok = false;
+        const Operation operation = operationFromType(query.value(1).toInt(), &ok);
+        if (!ok) continue;
+
+        const QString accountId = query.value(0).toString();
+        const qint32 hour = query.value(2).toInt();
+        Shard& shard = shardFor(accountId);
+        QMutexLocker locker(&shard.mutex);
+        AccountWindows& entry = shard.accounts[accountId];
+        Window& window = entry.windows[operation];
+        const int slot = hour % kBuckets;
+        window.hour[slot] = hour;
+        window.amount[slot] = Money::toCents(query.value(3));
+        window.count[slot] = query.value(4).toInt();
+        entry.lastHour = qMax(entry.lastHour, hour);
+        ++rows;
+    }
+
+    qDebug() << "交易限额计数已重建，账户数:" << trackedAccounts() << "小时桶:" << rows;
+    return true;
+}
+
+bool VelocityLimiter::withinLimits(const AccountWindows* entry, const VelocityLimits& limit, Operation operation,
+                                   qint64 amountCents, qint64 now, QString* reason)
+{
+    const qint32 hour = qint32(now / kSecsPerHour);
+    const qint64 elapsed = now % kSecsPerHour;
+
+    qint64 dailyAmount = 0, hourlyAmount = 0;
+    qint64 dailyCount = 0, hourlyCount = 0;
+    if (entry) {
+        const Window& window = entry->windows[operation];
+        for (int i = 0; i < kBuckets; ++i) {
+            if (window.hour[i] > hour - kBuckets) {
+                dailyAmount += window.amount[i];
+                dailyCount += window.count[i];
+            }
+        }
+
+        // 滑动一小时：上一个桶按未过去的比例计入
+        const int current = hour % kBuckets;
+        const int previous = (hour - 1) % kBuckets;
+        if (window.hour[current] == hour) {
+            hourlyAmount += window.amount[current];
+            hourlyCount += window.count[current];
+        }
+        if (window.hour[previous] == hour - 1) {
+            hourlyAmount += window.amount[previous] * (kSecsPerHour - elapsed) / kSecsPerHour;
+            hourlyCount += window.count[previous] * (kSecsPerHour - elapsed) / kSecsPerHour;
+        }
+    }
+
+    auto reject = [reason](const QString& message) {
+        if (reason) *reason = message;
+        return false;
+    };
+
+    if (limit.dailyAmountCents > 0 && dailyAmount + amountCents > limit.dailyAmountCents) {
+        return reject(QString("超过当日限额 %1，今日已用 %2")
+                          .arg(Money::toDecimalString(limit.dailyAmountCents), Money::toDecimalString(dailyAmount)));
+    }
+    if (limit.dailyCount > 0 && dailyCount + 1 > limit.dailyCount) {
+        return reject(QString("超过当日次数限制 %1 次").arg(limit.dailyCount));
+    }
+    if (limit.hourlyAmountCents > 0 && hourlyAmount + amountCents > limit.hourlyAmountCents) {
+        return reject(QString("超过每小时限额 %1").arg(Money::toDecimalString(limit.hourlyAmountCents)));
+    }
+    if (limit.hourlyCount > 0 && hourlyCount + 1 > limit.hourlyCount) {
+        return reject(QString("操作过于频繁，每小时最多 %1 次").arg(limit.hourlyCount));
+    }
+    return true;
+}
+
+bool VelocityLimiter::check(const QString& accountId, const QString& accountType, Operation operation,
+                            qint64 amountCents, QString* reason) const
+{
+    const VelocityLimits limit = limits(accountType, operation);
+    if (limit.dailyAmountCents <= 0 && limit.dailyCount <= 0
+        && limit.hourlyAmountCents <= 0 && limit.hourlyCount <= 0) {
+        return true;
+    }
+
+    const Shard& shard = shardFor(accountId);
+    QMutexLocker locker(&shard.mutex);
+    auto it = shard.accounts.constFind(accountId);
+    return withinLimits(it != shard.accounts.constEnd() ? &*it : nullptr, limit, operation, amountCents,
+                        QDateTime::currentSecsSinceEpoch(), reason);
+}
+
+bool VelocityLimiter::reserve(const QString& accountId, const QString& accountType, Operation operation,
+                              qint64 amountCents, Reservation& reservation, QString* reason)
+{
+    reservation = Reservation();
+    const VelocityLimits limit = limits(accountType, operation);
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+
+    Shard& shard = shardFor(accountId);
+    QMutexLocker locker(&shard.mutex);
+    auto it = shard.accounts.find(accountId);
+    if (!withinLimits(it != shard.accounts.end() ? &*it : nullptr, limit, operation, amountCents, now, reason)) {
+        return false;
+    }
+
+    // 不限额的类型同样计入：限额随时可能重新加载
+    const qint32 hour = qint32(now / kSecsPerHour);
+    const int slot = hour % kBuckets;
+    AccountWindows& entry = it != shard.accounts.end() ? *it : shard.accounts[accountId];
+    Window& window = entry.windows[operation];
+    if (window.hour[slot] != hour) {
+        window.hour[slot] = hour;
+        window.amount[slot] = 0;
+        window.count[slot] = 0;
+    }
+    window.amount[slot] += amountCents;
+    window.count[slot] += 1;
+    entry.lastHour = qMax(entry.lastHour, hour);
+
+    reservation.accountId = accountId;
+    reservation.operation = operation;
+    reservation.amountCents = amountCents;
+    reservation.timeSecs = now;
+    return true;
+}
+
+void VelocityLimiter::release(const Reservation& reservation)
+{
+    if (reservation.accountId.isEmpty()) return;
+
+    const qint32 hour = qint32(reservation.timeSecs / kSecsPerHour);
+    const int slot = hour % kBuckets;
+
+    Shard& shard = shardFor(reservation.accountId);
+    QMutexLocker locker(&shard.mutex);
+    auto it = shard.accounts.find(reservation.accountId);
+    if (it == shard.accounts.end()) return;
+
+    Window& window = it->windows[reservation.operation];
+    if (window.hour[slot] != hour) return;
+    window.amount[slot] = qMax<qint64>(0, window.amount[slot] - reservation.amountCents);
+    window.count[slot] = qMax<qint32>(0, window.count[slot] - 1);
+}
+
+void VelocityLimiter::record(const QString& accountId, Operation operation, qint64 amountCents)
+{
+    record(accountId, operation, amountCents, QDateTime::currentSecsSinceEpoch());
+}
+
+void VelocityLimiter::record(const QString& accountId, Operation operation, qint64 amountCents, qint64 timeSecs)
+{
+    const qint32 hour = qint32(timeSecs / kSecsPerHour);
+    const int slot = hour % kBuckets;
+
+    Shard& shard = shardFor(accountId);
+    QMutexLocker locker(&shard.mutex);
+    AccountWindows& entry = shard.accounts[accountId];
+    Window& window = entry.windows[operation];
+    if (window.hour[slot] != hour) {
+        // 桶已过期，复用
+        window.hour[slot] = hour;
+        window.amount[slot] = 0;
+        window.count[slot] = 0;
+    }
+    window.amount[slot] += amountCents;
+    window.count[slot] += 1;
+    entry.lastHour = qMax(entry.lastHour, hour);
+}
+
+void VelocityLimiter::prune()
+{
+    const qint32 hour = qint32(QDateTime::currentSecsSinceEpoch() / kSecsPerHour);
+    for (Shard& shard : shards) {
+        QMutexLocker locker(&shard.mutex);
+        for (auto it = shard.accounts.begin(); it != shard.accounts.end();) {
+            if (it->lastHour <= hour - kBuckets) {
+                it = shard.accounts.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+int VelocityLimiter::trackedAccounts() const
+{
+    int total = 0;
+    for (const Shard& shard : shards) {
+        QMutexLocker locker(&shard.mutex);
+        total += shard.accounts.size();
+    }
+    return total;
+}
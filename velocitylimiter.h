@@ -0,0 +1,99 @@
+#ifndef VELOCITYLIMITER_H
+#define VELOCITYLIMITER_H
+
+#include <QString>
+#include <QHash>
+#include <QMutex>
+
+class QSqlDatabase;
+
+// 单个账户类型、单种操作的限额，0 表示不限
+struct VelocityLimits
+{
+    qint64 dailyAmountCents = 0;
+    int dailyCount = 0;
+    qint64 hourlyAmountCents = 0;
+    int hourlyCount = 0;
+};
+
+// 取款/转账频次与限额检查
+// 每个账户每种操作保存 24 个小时桶（环形），日累计为最近 24 个桶之和，
+// 小时累计按滑动窗口估算：当前桶 + 上一桶 × 未过去的比例。只保存最近 24 小时有过扣款的账户。
+// 启动时由 transactions 重建；扣款在事务开始前用 reserve() 检查并计入（同一把锁内完成，
+// 并发的两笔扣款不会一起越过限额），事务回滚时 release() 退回。检查与计数均为 O(1)，可在多个线程中调用。
+// 计数只反映本进程与启动时已提交的扣款，多个客户端同时运行时各自独立计数。
+class VelocityLimiter
+{
+public:
+    enum Operation { Withdraw = 0, Transfer = 1, OperationCount = 2 };
+
+    // reserve() 计入的一笔扣款；accountId 为空表示没有计入（不限额或未调用）
+    struct Reservation
+    {
+        QString accountId;
+        Operation operation = Withdraw;
+        qint64 amountCents = 0;
+        qint64 timeSecs = 0;
+    };
+
+    VelocityLimiter();
+
+    void setLimits(const QString& accountType, Operation operation, const VelocityLimits& limits);
+    VelocityLimits limits(const QString& accountType, Operation operation) const;
+
+    // 读取 velocity_limits 表
+    bool loadLimits(QSqlDatabase& db);
+    // 用最近 24 小时的 transactions 重建计数
+    bool rebuild(QSqlDatabase& db);
+
+    // 本次扣款后是否仍在限额内，超限时 reason 给出原因
+    bool check(const QString& accountId, const QString& accountType, Operation operation,
+               qint64 amountCents, QString* reason = nullptr) const;
+    // 检查并立即计入本次扣款；超限时返回 false，不计入。扣款最终没有提交时须 release()
+    bool reserve(const QString& accountId, const QString& accountType, Operation operation,
+                 qint64 amountCents, Reservation& reservation, QString* reason = nullptr);
+    // 退回 reserve() 计入的扣款（所在小时桶已过期时不再需要退回）
+    void release(const Reservation& reservation);
+    // 直接计入已提交的扣款
+    void record(const QString& accountId, Operation operation, qint64 amountCents);
+    void record(const QString& accountId, Operation operation, qint64 amountCents, qint64 timeSecs);
+
+    // 移除 24 小时内没有扣款的账户
+    void prune();
+    int trackedAccounts() const;
+
+private:
+    static const int kBuckets = 24;
+    static const int kShards = 16;
+
+    struct Window
+    {
+        qint64 amount[kBuckets] = {};
+        qint32 count[kBuckets] = {};
+        qint32 hour[kBuckets] = {};   // 桶对应的小时号（secs / 3600），与当前不符的桶视为空
+    };
+
+    struct AccountWindows
+    {
+        Window windows[OperationCount];
+        qint32 lastHour = 0;
+    };
+
+    struct Shard
+    {
+        mutable QMutex mutex;
+        QHash<QString, AccountWindows> accounts;
+    };
+
+    Shard shards[kShards];
+    mutable QMutex limitsMutex;
+    QHash<QString, VelocityLimits> limitTable[OperationCount];
+
+    Shard& shardFor(const QString& accountId);
+    const Shard& shardFor(const QString& accountId) const;
+    // 在分片锁内调用：entry 为空表示该账户近 24 小时没有扣款
+    static bool withinLimits(const AccountWindows* entry, const VelocityLimits& limit, Operation operation,
+                             qint64 amountCents, qint64 now, QString* reason);
+};
+
+#endif // VELOCITYLIMITER_H
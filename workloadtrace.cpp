@@ -0,0 +1,328 @@
+#include "workloadtrace.h"
+#include "databasemanager.h"
+#include "money.h"
+#include <QThread>
+#include <QDir>
+#include <QDataStream>
+#include <QBuffer>
+#include <QStandardPaths>
+#include <QCoreApplication>
+#include <QSysInfo>
+#include <QMutexLocker>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+const quint32 kMagic = 0x424B574C;          // "BKWL"
+const quint16 kVersion = 1;
+const int kBlockEvents = 4096;              // 攒够一块立即写出
+const int kFlushIntervalMs = 1000;          // 否则每秒写出一次，进程崩溃时最多丢失一秒
+const int kMaxPendingEvents = 200000;       // 抓取线程跟不上时丢弃新记录，不阻塞调用方
+}
+
+thread_local int WorkloadTrace::depth = 0;
+
+WorkloadTrace::Scope::~Scope()
+{
+    --depth;
+    if (startUs >= 0) {
+        instance().record(operation, startUs, result, arguments);
+    }
+}
+
+bool WorkloadTrace::Scope::done(bool ok)
+{
+    result = ok ? 1 : 0;
+    return ok;
+}
+
+double WorkloadTrace::Scope::done(double balance)
+{
+    result = Money::toCents(balance);
+    return balance;
+}
+
+WorkloadTrace& WorkloadTrace::instance()
+{
+    static WorkloadTrace instance;
+    return instance;
+}
+
+WorkloadTrace::WorkloadTrace()
+    : thread(nullptr)
+    , stopping(false)
+    , dropped(0)
+{
+}
+
+WorkloadTrace::~WorkloadTrace()
+{
+    stop();
+}
+
+bool WorkloadTrace::start(const QString& directory)
+{
+    stop();
+
+    const QString path = directory.isEmpty()
+        ? QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/trace"
+        : directory;
+    QDir().mkpath(path);
+
+    const qint64 processId = QCoreApplication::applicationPid();
+    const QDateTime startedAt = QDateTime::currentDateTime();
+
+    QMutexLocker locker(&mutex);
+    file.setFileName(QDir(path).filePath(QString("trace_%1_%2.bkwl")
+                                             .arg(processId)
+                                             .arg(startedAt.toString("yyyyMMdd_HHmmss"))));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qDebug() << "负载抓取文件创建失败:" << file.fileName() << file.errorString();
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_15);
+    out << kMagic << kVersion << startedAt.toMSecsSinceEpoch() << QSysInfo::machineHostName() << processId;
+    file.flush();
+
+    pending.clear();
+    pending.reserve(kBlockEvents);
+    dropped = 0;
+    stopping = false;
+    clock.start();
+    thread = QThread::create([this]() { run(); });
+    thread->setObjectName("workloadtrace");
+    thread->start();
+    capturing.storeRelease(1);
+
+    qDebug() << "负载抓取开始:" << file.fileName();
+    return true;
+}
+
+void WorkloadTrace::stop()
+{
+    QThread* worker = nullptr;
+    {
+        QMutexLocker locker(&mutex);
+        if (!thread) return;
+        capturing.storeRelease(0);
+        stopping = true;
+        worker = thread;
+        wake.wakeAll();
+    }
+
+    worker->wait();
+    delete worker;
+
+    QMutexLocker locker(&mutex);
+    thread = nullptr;
+    stopping = false;
+    if (dropped > 0) {
+        qDebug() << "负载抓取期间丢弃" << dropped << "条记录";
+    }
+    qDebug() << "负载抓取结束:" << file.fileName();
+    file.close();
+}
+
+QString WorkloadTrace::filePath() const
+{
+    QMutexLocker locker(&mutex);
+    return file.fileName();
+}
+
+qint64 WorkloadTrace::elapsedUs() const
+{
+    if (!capturing.loadAcquire()) return -1;
+    return clock.nsecsElapsed() / 1000;
+}
+
+void WorkloadTrace::record(Operation operation, qint64 startUs, qint64 result, const QStringList& arguments)
+{
+    if (startUs < 0 || !capturing.loadAcquire()) return;
+
+    Event event;
+    event.operation = operation;
+    event.startUs = startUs;
+    event.durationUs = clock.nsecsElapsed() / 1000 - startUs;
+    event.result = result;
+    event.arguments = arguments;
+    append(event);
+}
+
+void WorkloadTrace::append(Event& event)
+{
+    QMutexLocker locker(&mutex);
+    if (!thread || stopping) return;
+    if (pending.size() >= kMaxPendingEvents) {
+        ++dropped;
+        return;
+    }
+    pending.append(std::move(event));
+    if (pending.size() == kBlockEvents) wake.wakeOne();
+}
+
+void WorkloadTrace::run()
+{
+    QVector<Event> block;
+
+    QMutexLocker locker(&mutex);
+    for (;;) {
+        if (!stopping && pending.size() < kBlockEvents) {
+            wake.wait(&mutex, kFlushIntervalMs);
+        }
+        block.swap(pending);
+        const bool last = stopping;
+        locker.unlock();
+
+        if (!block.isEmpty() && !writeBlock(block)) {
+            qDebug() << "负载抓取写入失败:" << file.errorString();
+        }
+        block.clear();
+
+        locker.relock();
+        if (last && pending.isEmpty()) break;
+    }
+}
+
+bool WorkloadTrace::writeBlock(const QVector<Event>& events)
+{
+    QByteArray raw;
+    {
+        QBuffer buffer(&raw);
+        buffer.open(QIODevice::WriteOnly);
+        QDataStream out(&buffer);
+        out.setVersion(QDataStream::Qt_5_15);
+        for (const Event& event : events) {
+            out << quint8(event.operation) << event.startUs << quint32(qBound<qint64>(0, event.durationUs, 0xFFFFFFFF))
+                << event.result << quint8(qMin(event.arguments.size(), 255));
+            for (int i = 0; i < event.arguments.size() && i < 255; ++i) {
+                out << event.arguments.at(i).toUtf8();
+            }
+        }
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_15);
+    out << quint32(events.size()) << qCompress(raw);
+    return out.status() == QDataStream::Ok && file.flush();
+}
+
+bool WorkloadTrace::read(const QString& path, Header& header, QVector<Event>& events)
+{
+    QFile input(path);
+    if (!input.open(QIODevice::ReadOnly)) {
+        qDebug() << "负载抓取文件打开失败:" << path << input.errorString();
+        return false;
+    }
+
+    QDataStream in(&input);
+    in.setVersion(QDataStream::Qt_5_15);
+    quint32 magic = 0;
+    quint16 version = 0;
+    qint64 startedAt = 0;
+    in >> magic >> version >> startedAt >> header.host >> header.processId;
+    if (in.status() != QDataStream::Ok || magic != kMagic || version != kVersion) {
+        qDebug() << "不是负载抓取文件或版本不支持:" << path;
+        return false;
+    }
+    header.startedAt = QDateTime::fromMSecsSinceEpoch(startedAt);
+
+    events.clear();
+    while (!in.atEnd()) {
+        quint32 count = 0;
+        QByteArray compressed;
+        in >> count >> compressed;
+        if (in.status() != QDataStream::Ok) break;   // 抓取进程异常退出时最后一块可能不完整
+
+        const QByteArray raw = qUncompress(compressed);
+        QDataStream block(raw);
+        block.setVersion(QDataStream::Qt_5_15);
+        for (quint32 i = 0; i < count; ++i) {
+            quint8 operation = 0;
+            quint32 durationUs = 0;
+            quint8 argumentCount = 0;
+            Event event;
+            block >> operation >> event.startUs >> durationUs >> event.result >> argumentCount;
+            for (int j = 0; j < argumentCount; ++j) {
+                QByteArray argument;
+                block >> argument;
+                event.arguments.append(QString::fromUtf8(argument));
+            }
+            if (block.status() != QDataStream::Ok) break;
+            if (operation == 0 || operation >= OperationCount) continue;
+            event.operation = Operation(operation);
+            event.durationUs = durationUs;
+            events.append(event);
+        }
+    }
+
+    // 记录按结束先后写入，重放按开始时间
+    std::stable_sort(events.begin(), events.end(), [](const Event& a, const Event& b) {
+        return a.startUs < b.startUs;
+    });
+    return true;
+}
+
+QString WorkloadTrace::operationName(Operation operation)
+{
+    switch (operation) {
+    case Credentials: return "credentials";
+    case Balance: return "balance";
+    case BalanceAndType: return "balance-type";
+    case Deposit: return "deposit";
+    case Withdraw: return "withdraw";
+    case Transfer: return "transfer";
+    case History: return "history";
+    case Search: return "search";
+    case SearchAsync: return "search-async";
+    case UserAccounts: return "user-accounts";
+    default: return "unknown";
+    }
+}
+
+QString WorkloadTrace::timeArgument(const QDateTime& time)
+{
+    return time.isValid() ? time.toString(Qt::ISODateWithMs) : QString();
+}
+
+QDateTime WorkloadTrace::parseTime(const QString& argument)
+{
+    return argument.isEmpty() ? QDateTime() : QDateTime::fromString(argument, Qt::ISODateWithMs);
+}
+
+QStringList WorkloadTrace::filterArguments(const QString& accountId, const TransactionFilter& filter, int limit)
+{
+    return { accountId,
+             timeArgument(filter.from),
+             timeArgument(filter.to),
+             filter.type,
+             QString::number(filter.minAmount, 'f', 2),
+             QString::number(filter.maxAmount, 'f', 2),
+             filter.targetAccount,
+             filter.descriptionContains,
+             timeArgument(filter.beforeTime),
+             QString::number(filter.beforeId),
+             QString::number(limit),
+             filter.beforeCredit ? "1" : "0" };
+}
+
+bool WorkloadTrace::parseFilterArguments(const QStringList& arguments, QString& accountId,
+                                         TransactionFilter& filter, int& limit)
+{
+    // 早期的轨迹没有末尾的贷方游标标记
+    if (arguments.size() != 11 && arguments.size() != 12) return false;
+    accountId = arguments.at(0);
+    filter.from = parseTime(arguments.at(1));
+    filter.to = parseTime(arguments.at(2));
+    filter.type = arguments.at(3);
+    filter.minAmount = arguments.at(4).toDouble();
+    filter.maxAmount = arguments.at(5).toDouble();
+    filter.targetAccount = arguments.at(6);
+    filter.descriptionContains = arguments.at(7);
+    filter.beforeTime = parseTime(arguments.at(8));
+    filter.beforeId = arguments.at(9).toLongLong();
+    limit = arguments.at(10).toInt();
+    filter.beforeCredit = arguments.size() == 12 && arguments.at(11) == "1";
+    return true;
+}
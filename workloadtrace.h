@@ -0,0 +1,137 @@
+#ifndef WORKLOADTRACE_H
+#define WORKLOADTRACE_H
+
+#include <QString>
+#include <QStringList>
+#include <QDateTime>
+#include <QVector>
+#include <QFile>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QElapsedTimer>
+#include <QAtomicInt>
+
+class QThread;
+struct TransactionFilter;
+
+// 负载抓取
+// 记录 DatabaseManager 对外调用的操作、参数、开始时间、耗时与结果，写入紧凑的二进制文件，
+// 供 workloadreplay 在恢复出的数据库上按原节奏（或加速）重放。未开启时每次调用只多一次原子读；
+// 开启后调用线程只在内存中追加一条记录，编码、压缩与写盘在抓取线程中按块进行。
+// 只记录最外层调用（取款内部的查余额不单独记录）；不记录口令，登录只记录凭据查询。
+// 文件格式：头部（魔数、版本、开始时间、主机名、进程号）后接若干块，每块为记录数与 qCompress 压缩的记录。
+class WorkloadTrace
+{
+public:
+    enum Operation : quint8 {
+        Credentials = 1,   // 用户名
+        Balance,           // 账户
+        BalanceAndType,    // 账户
+        Deposit,           // 账户、金额、幂等键
+        Withdraw,          // 账户、金额、幂等键
+        Transfer,          // 转出账户、转入账户、金额、幂等键
+        History,           // 账户、起始时间、结束时间
+        Search,            // 见 filterArguments
+        SearchAsync,       // 同上，经数据库工作线程执行，不阻塞调用方
+        UserAccounts,      // 用户名
+        OperationCount
+    };
+
+    struct Event
+    {
+        Operation operation = Credentials;
+        qint64 startUs = 0;        // 相对抓取开始
+        qint64 durationUs = 0;
+        qint64 result = 0;         // 布尔结果为 0/1，余额为分，查询为返回行数
+        QStringList arguments;
+    };
+
+    struct Header
+    {
+        QDateTime startedAt;
+        QString host;
+        qint64 processId = 0;
+    };
+
+    // 作用域内计时一次调用，构造时只在抓取中且不是嵌套调用时才求值参数
+    class Scope
+    {
+    public:
+        template <typename Arguments>
+        Scope(Operation operation, Arguments arguments)
+            : operation(operation)
+            , startUs(-1)
+            , result(0)
+        {
+            if (depth++ == 0 && isCapturing()) {
+                this->arguments = arguments();
+                startUs = instance().elapsedUs();
+            }
+        }
+        ~Scope();
+
+        // 记录结果并原样返回，便于写成 return trace.done(...)
+        bool done(bool ok);
+        double done(double balance);
+        void setResult(qint64 value) { result = value; }
+
+    private:
+        Operation operation;
+        qint64 startUs;
+        qint64 result;
+        QStringList arguments;
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+    static WorkloadTrace& instance();
+    static bool isCapturing() { return instance().capturing.loadRelaxed() != 0; }
+
+    // 在目录下新建 trace_<进程号>_<时间>.bkwl 开始抓取，目录为空时使用应用数据目录下的 trace
+    bool start(const QString& directory = QString());
+    // 写完已记录的调用后关闭文件
+    void stop();
+    QString filePath() const;
+
+    // 抓取开始以来的微秒数，不在抓取中时为 -1
+    qint64 elapsedUs() const;
+    // 不能用 Scope 计时的调用（如异步查询从提交到回调）结束后直接记录
+    void record(Operation operation, qint64 startUs, qint64 result, const QStringList& arguments);
+
+    // 读取整个文件，记录按开始时间排序；文件尾部不完整的块被忽略
+    static bool read(const QString& path, Header& header, QVector<Event>& events);
+
+    static QString operationName(Operation operation);
+    static QStringList filterArguments(const QString& accountId, const TransactionFilter& filter, int limit);
+    static bool parseFilterArguments(const QStringList& arguments, QString& accountId, TransactionFilter& filter,
+                                     int& limit);
+    // 时间参数：带毫秒的 ISO 格式，无效时间为空串
+    static QString timeArgument(const QDateTime& time);
+    static QDateTime parseTime(const QString& argument);
+
+private:
+    WorkloadTrace();
+    ~WorkloadTrace();
+
+    WorkloadTrace(const WorkloadTrace&) = delete;
+    WorkloadTrace& operator=(const WorkloadTrace&) = delete;
+
+    static thread_local int depth;
+
+    QAtomicInt capturing;
+    QElapsedTimer clock;
+    mutable QMutex mutex;
+    QWaitCondition wake;
+    QVector<Event> pending;
+    QThread* thread;
+    bool stopping;
+    QFile file;
+    qint64 dropped;
+
+    void append(Event& event);
+    void run();
+    bool writeBlock(const QVector<Event>& events);
+};
+
+#endif // WORKLOADTRACE_H
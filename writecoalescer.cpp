@@ -0,0 +1,200 @@
+#include "writecoalescer.h"
+#include "dberror.h"
+#include <QThread>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QMutexLocker>
+#include <QDeadlineTimer>
+#include <QDebug>
+
+WriteCoalescer::WriteCoalescer(const QString& sourceConnectionName, VelocityLimiter* limiter)
+    : sourceConnection(sourceConnectionName)
+    , limiter(limiter)
+    , thread(nullptr)
+    , windowUs(500)
+    , maxBatch(64)
+    , stopping(false)
+{
+    thread = QThread::create([this]() { run(); });
+    thread->setObjectName("coalescer");
+    thread->start();
+}
+
+WriteCoalescer::~WriteCoalescer()
+{
+    stop();
+}
+
+void WriteCoalescer::setWindow(int microseconds)
+{
+    QMutexLocker locker(&mutex);
+    windowUs = qBound(0, microseconds, 100000);
+}
+
+void WriteCoalescer::setMaxBatch(int operations)
+{
+    QMutexLocker locker(&mutex);
+    maxBatch = qBound(1, operations, 1000);
+}
+
+QFuture<PostingResult> WriteCoalescer::submit(const PostingRequest& request)
+{
+    Pending pending;
+    pending.request = request;
+    pending.promise.reportStarted();
+    const QFuture<PostingResult> future = pending.promise.future();
+
+    QMutexLocker locker(&mutex);
+    if (stopping) {
+        PostingResult result;
+        result.message = "合并提交已停止";
+        complete(pending, result);
+        return future;
+    }
+
+    pending.queuedAt.start();
+    queue.enqueue(pending);
+    // 队列由空变为非空（开始计时窗口）或凑满一批时唤醒
+    if (queue.size() == 1 || queue.size() >= maxBatch) wake.wakeOne();
+    return future;
+}
+
+void WriteCoalescer::stop()
+{
+    {
+        QMutexLocker locker(&mutex);
+        if (stopping && !thread) return;
+        stopping = true;
+        wake.wakeAll();
+    }
+
+    if (thread) {
+        thread->wait();
+        delete thread;
+        thread = nullptr;
+    }
+}
+
+WriteCoalescer::Metrics WriteCoalescer::metrics() const
+{
+    QMutexLocker locker(&mutex);
+    return stats;
+}
+
+QString WriteCoalescer::summary() const
+{
+    const Metrics m = metrics();
+    return QString("%1 笔，%2 次提交，平均每批 %3 笔，最大 %4 笔，拆分重试 %5 次，平均等待 %6ms，最长等待 %7ms")
+        .arg(m.operations)
+        .arg(m.batches)
+        .arg(m.averageBatch(), 0, 'f', 1)
+        .arg(m.largestBatch)
+        .arg(m.splits)
+        .arg(m.averageWaitMs(), 0, 'f', 2)
+        .arg(m.maxWaitUs / 1000.0, 0, 'f', 2);
+}
+
+void WriteCoalescer::complete(Pending& pending, const PostingResult& result)
+{
+    pending.promise.reportResult(result);
+    pending.promise.reportFinished();
+}
+
+void WriteCoalescer::run()
+{
+    const QString connectionName = sourceConnection + "_coalescer";
+    {
+        QSqlDatabase db = QSqlDatabase::cloneDatabase(sourceConnection, connectionName);
+        if (!db.open()) {
+            qDebug() << "合并提交线程连接失败:" << db.lastError().text();
+        }
+
+        QElapsedTimer lastProbe;
+        lastProbe.start();
+
+        QMutexLocker locker(&mutex);
+        for (;;) {
+            while (!stopping && queue.isEmpty()) wake.wait(&mutex);
+            if (queue.isEmpty()) break;   // 停止且已执行完
+
+            // 窗口从第一笔到达时算起，保证附加延迟有上限
+            const qint64 remainingNs = qint64(windowUs) * 1000 - queue.head().queuedAt.nsecsElapsed();
+            if (!stopping && remainingNs > 0 && queue.size() < maxBatch) {
+                QDeadlineTimer deadline;
+                deadline.setPreciseRemainingTime(0, remainingNs);
+                while (!stopping && queue.size() < maxBatch && wake.wait(&mutex, deadline)) {}
+            }
+
+            QList<Pending> batch;
+            while (!queue.isEmpty() && batch.size() < maxBatch) {
+                Pending pending = queue.dequeue();
+                const qint64 waitUs = pending.queuedAt.nsecsElapsed() / 1000;
+                stats.totalWaitUs += waitUs;
+                stats.maxWaitUs = qMax(stats.maxWaitUs, waitUs);
+                batch.append(pending);
+            }
+            locker.unlock();
+
+            // 连接断开时重连一次，仍失败的批次由 execute 逐笔报告失败
+            if (!DbError::ensureOpen(db, lastProbe)) {
+                qDebug() << "合并提交线程重连失败:" << db.lastError().text();
+            }
+            execute(db, batch, 0, batch.size());
+
+            locker.relock();
+        }
+        locker.unlock();
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+}
+
+void WriteCoalescer::execute(QSqlDatabase& db, QList<Pending>& batch, int first, int count)
+{
+    QList<PostingRequest> requests;
+    for (int i = first; i < first + count; ++i) requests.append(batch.at(i).request);
+
+    QList<PostingResult> results;
+    DbError::Kind error = DbError::None;
+    bool commitSent = false;
+    if (DatabaseManager::executePostingBatch(db, requests, limiter, results, error, commitSent)) {
+        {
+            QMutexLocker locker(&mutex);
+            stats.operations += count;
+            ++stats.batches;
+            stats.largestBatch = qMax(stats.largestBatch, count);
+        }
+        for (int i = 0; i < count; ++i) complete(batch[first + i], results.at(i));
+        return;
+    }
+
+    // 只有死锁、锁等待超时时整批确定已回滚，拆成两半重试；单笔仍失败或其他错误则逐笔报告失败
+    // （调用方可用同一幂等键重试）。COMMIT 发出后连接中断时批次可能已提交，不能重做：
+    // 没有幂等键的请求结果未知，需查询余额确认
+    if (count == 1 || !DbError::isLockConflict(error)) {
+        {
+            QMutexLocker locker(&mutex);
+            stats.operations += count;
+        }
+        for (int i = first; i < first + count; ++i) {
+            PostingResult failed;
+            if (!commitSent) {
+                failed.message = "数据库错误，交易未执行";
+            } else if (batch.at(i).request.idempotencyKey.isEmpty()) {
+                failed.message = "数据库连接中断，交易结果未知，请查询余额确认";
+            } else {
+                failed.message = "数据库连接中断，请用同一幂等键重试确认结果";
+            }
+            complete(batch[i], failed);
+        }
+        return;
+    }
+
+    {
+        QMutexLocker locker(&mutex);
+        ++stats.splits;
+    }
+    const int half = count / 2;
+    execute(db, batch, first, half);
+    execute(db, batch, first + half, count - half);
+}
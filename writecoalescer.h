@@ -0,0 +1,79 @@
+#ifndef WRITECOALESCER_H
+#define WRITECOALESCER_H
+
+#include "databasemanager.h"
+#include <QString>
+#include <QQueue>
+#include <QList>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QElapsedTimer>
+#include <QFuture>
+#include <QFutureInterface>
+
+class QThread;
+class VelocityLimiter;
+
+// 存取款合并提交
+// 各线程提交的存取款进入队列，后台线程在第一笔到达后最多等待一个窗口（微秒级）或凑满一批，
+// 用一个事务执行整批（每笔一个保存点，业务失败只回滚自身），一次提交只刷一次日志。
+// 整批被回滚（死锁、锁等待超时）时拆成两半重试；其他失败不重做，提交阶段连接中断时结果未知。
+// 每笔的结果通过各自的 QFuture 返回。
+class WriteCoalescer
+{
+public:
+    struct Metrics
+    {
+        qint64 operations = 0;
+        qint64 batches = 0;       // 成功提交的事务数
+        qint64 splits = 0;        // 整批回滚后拆分的次数
+        int largestBatch = 0;
+        qint64 totalWaitUs = 0;   // 从提交到开始执行
+        qint64 maxWaitUs = 0;
+
+        double averageBatch() const { return batches ? double(operations) / batches : 0.0; }
+        double averageWaitMs() const { return operations ? totalWaitUs / 1000.0 / operations : 0.0; }
+    };
+
+    // limiter 可为空；非空时取款在锁定账户行后检查限额，提交后累加
+    WriteCoalescer(const QString& sourceConnectionName, VelocityLimiter* limiter);
+    ~WriteCoalescer();
+
+    void setWindow(int microseconds);
+    void setMaxBatch(int operations);
+
+    // 可在任意线程调用；停止后提交的请求立即以失败完成
+    QFuture<PostingResult> submit(const PostingRequest& request);
+
+    // 执行完已提交的请求后结束后台线程
+    void stop();
+
+    Metrics metrics() const;
+    QString summary() const;
+
+private:
+    struct Pending
+    {
+        PostingRequest request;
+        QFutureInterface<PostingResult> promise;
+        QElapsedTimer queuedAt;
+    };
+
+    QString sourceConnection;
+    VelocityLimiter* limiter;
+    QThread* thread;
+
+    mutable QMutex mutex;
+    QWaitCondition wake;
+    QQueue<Pending> queue;
+    int windowUs;
+    int maxBatch;
+    bool stopping;
+    Metrics stats;
+
+    void run();
+    void execute(QSqlDatabase& db, QList<Pending>& batch, int first, int count);
+    static void complete(Pending& pending, const PostingResult& result);
+};
+
+#endif // WRITECOALESCER_H